@@ -68,6 +68,14 @@
 #define DEBUG_INTERRUPTS				KDEBUG_LEVEL_1
 
 
+// scheduler
+
+// Keeps per CPU scheduler statistics (context switches, migrations, wake up
+// latencies, run queue lengths) and a ring of the last scheduling events,
+// that can be retrieved via the "scheduler statistics" generic syscall.
+#define SCHEDULER_STATISTICS			KDEBUG_LEVEL_1
+
+
 // semaphores
 
 // Enables tracking of the last threads that acquired/released a semaphore.
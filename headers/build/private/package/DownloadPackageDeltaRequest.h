@@ -0,0 +1 @@
+#include <../private/package/DownloadPackageDeltaRequest.h>
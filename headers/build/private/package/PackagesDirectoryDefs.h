@@ -0,0 +1 @@
+#include <../private/package/PackagesDirectoryDefs.h>
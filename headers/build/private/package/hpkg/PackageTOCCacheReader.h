@@ -0,0 +1 @@
+#include <../private/package/hpkg/PackageTOCCacheReader.h>
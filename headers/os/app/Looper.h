@@ -20,6 +20,7 @@ class BMessageQueue;
 namespace BPrivate {
 	class BDirectMessageTarget;
 	class BLooperList;
+	struct PortMessageBuffer;
 }
 
 // Port (Message Queue) Capacity
@@ -140,6 +141,7 @@ private:
 								port_id port, int32 capacity);
 			void			AddMessage(BMessage* msg);
 			void			_AddMessagePriv(BMessage* msg);
+			void			_DequeueMessages(bigtime_t timeout);
 	static	status_t		_task0_(void* arg);
 
 			void*			ReadRawFromPort(int32* code,
@@ -174,7 +176,12 @@ private:
 			bool			fTerminating;
 			bool			fRunCalled;
 			bool			fOwnsPort;
-			uint32			_reserved[11];
+			::BPrivate::PortMessageBuffer* fPortMessageBuffer;
+#ifdef B_HAIKU_64_BIT
+			uint32			_reserved[8];
+#else
+			uint32			_reserved[10];
+#endif
 };
 
 #endif	// _LOOPER_H
@@ -539,6 +539,9 @@ private:
 
 			status_t			_FlattenToArea(message_header** _header) const;
 			status_t			_CopyForWrite();
+			bool				_NeedsCopyForWrite() const;
+			status_t			_UnflattenInPlace(void* buffer, size_t size,
+									area_id area);
 			status_t			_Reference();
 			status_t			_Dereference();
 
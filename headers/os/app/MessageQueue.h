@@ -33,6 +33,11 @@ public:
 			bool				IsNextMessage(const BMessage* message) const;
 
 private:
+	friend class BLooper;
+
+			void				_AddMessages(BMessage** messages,
+									int32 count);
+
 			// Reserved space in the vtable for future changes to BMessageQueue
 	virtual	void				_ReservedMessageQueue1();
 	virtual	void				_ReservedMessageQueue2();
@@ -176,6 +176,32 @@ extern status_t		_get_port_message_info_etc(port_id port,
 #define get_port_message_info_etc(port, info, flags, timeout) \
 	_get_port_message_info_etc((port), (info), sizeof(*(info)), flags, timeout)
 
+/* similar to read_port_etc(), but returns the message in a new area that
+   belongs to the caller; large messages are mapped instead of copied */
+extern area_id		read_port_area_etc(port_id port, int32 *code,
+						void **_address, size_t *_size, uint32 flags,
+						bigtime_t timeout);
+
+/* read_port_multiple_etc() and write_port_multiple_etc() transfer several
+   messages at once. In the buffer, each message is preceded by a
+   port_message_header, and padded to a multiple of 8 bytes. */
+typedef struct port_message_header {
+	int32		code;
+	uint32		size;
+} port_message_header;
+
+#define PORT_MESSAGE_ALIGN(size)	(((size) + 7) & ~(size_t)7)
+#define PORT_MESSAGE_NEXT(header) \
+	((port_message_header*)((uint8*)((header) + 1) \
+		+ PORT_MESSAGE_ALIGN((header)->size)))
+
+/* returns the number of messages read, waits only for the first one */
+extern ssize_t		read_port_multiple_etc(port_id port, void *buffer,
+						size_t bufferSize, uint32 flags, bigtime_t timeout);
+/* returns the number of messages written */
+extern ssize_t		write_port_multiple_etc(port_id port, const void *buffer,
+						size_t bufferSize, uint32 flags, bigtime_t timeout);
+
 
 /* Semaphores */
 
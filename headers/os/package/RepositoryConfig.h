@@ -31,6 +31,7 @@ public:
 			const BString&		Identifier() const;
 			uint8				Priority() const;
 			bool				IsUserSpecific() const;
+			bool				ProvidesDeltas() const;
 
 			const BEntry&		Entry() const;
 
@@ -41,6 +42,7 @@ public:
 			void				SetIdentifier(const BString& url);
 			void				SetPriority(uint8 priority);
 			void				SetIsUserSpecific(bool isUserSpecific);
+			void				SetProvidesDeltas(bool providesDeltas);
 
 public:
 	static	const uint8			kUnsetPriority = 0;
@@ -57,6 +59,9 @@ private:
 				// mirrors. Usually a tag: or uuid: URI.
 			uint8				fPriority;
 			bool				fIsUserSpecific;
+			bool				fProvidesDeltas;
+				// whether the repository publishes package deltas below
+				// <packages URL>/deltas
 
 			BEntry				fEntry;
 };
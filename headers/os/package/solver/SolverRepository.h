@@ -68,8 +68,15 @@ public:
 			bool				RemovePackage(BSolverPackage* package);
 			bool				DeletePackage(BSolverPackage* package);
 
+			BString				Checksum() const;
+									// of the repository cache the packages
+									// were read from, empty otherwise
+
 			uint64				ChangeCount() const;
 
+private:
+			void				_SetChecksum(const BRepositoryCache& cache);
+
 private:
 			typedef BObjectList<BSolverPackage> PackageList;
 
@@ -78,6 +85,7 @@ private:
 			int32				fPriority;
 			bool				fIsInstalled;
 			PackageList			fPackages;
+			BString				fChecksum;
 			uint64				fChangeCount;
 };
 
@@ -32,7 +32,9 @@ enum {
 	MESSAGE_FLAG_HAS_SPECIFIERS = 0x0020,
 	MESSAGE_FLAG_WAS_DROPPED = 0x0040,
 	MESSAGE_FLAG_PASS_BY_AREA = 0x0080,
-	MESSAGE_FLAG_REPLY_AS_KMESSAGE = 0x0100
+	MESSAGE_FLAG_REPLY_AS_KMESSAGE = 0x0100,
+	MESSAGE_FLAG_IN_PLACE = 0x0200
+		// local only: the header, fields, and data are one flattened buffer
 };
 
 
@@ -176,6 +178,12 @@ class BMessage::Private {
 			return fMessage->_FlattenToArea(header);
 		}
 
+		status_t
+		UnflattenInPlace(void* buffer, size_t size, area_id area = -1)
+		{
+			return fMessage->_UnflattenInPlace(buffer, size, area);
+		}
+
 		status_t
 		SendMessage(port_id port, team_id portOwner, int32 token,
 			bigtime_t timeout, bool replyRequired, BMessenger &replyTo) const
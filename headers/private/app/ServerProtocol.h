@@ -354,6 +354,7 @@ enum {
 	// debugging helper
 	AS_DUMP_ALLOCATOR,
 	AS_DUMP_BITMAPS,
+	AS_DUMP_FRAME_STATISTICS,
 
 	// transformation in addition to origin/scale
 	AS_VIEW_SET_TRANSFORM,
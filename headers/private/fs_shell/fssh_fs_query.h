@@ -19,6 +19,8 @@
 	// Only enable this feature for non time-critical things, it might
 	// take a long time to proceed.
 	// Also, not every file system might support this feature.
+#define FSSH_B_QUERY_EXPLAIN		0x00010000
+	// Private, see <query_private.h>.
 
 
 #ifdef  __cplusplus
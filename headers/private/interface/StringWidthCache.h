@@ -0,0 +1,65 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _STRING_WIDTH_CACHE_H
+#define _STRING_WIDTH_CACHE_H
+
+
+#include <SupportDefs.h>
+
+
+namespace BPrivate {
+
+
+/*!	A bounded cache of string widths, which forgets the least recently used
+	strings first. The font is identified by a 64 bit key that the user
+	chooses, and the spacing mode.
+	The cache does not do any locking on its own.
+*/
+class StringWidthCache {
+public:
+								StringWidthCache(int32 maxCount,
+									int32 maxLength = 256);
+								~StringWidthCache();
+
+			status_t			InitCheck() const;
+
+			bool				Get(uint64 font, uint8 spacing,
+									const char* string, int32 length,
+									float& _width);
+			void				Put(uint64 font, uint8 spacing,
+									const char* string, int32 length,
+									float width);
+
+			void				MakeEmpty();
+
+private:
+			struct Entry;
+
+			Entry*				_Lookup(uint64 font, uint8 spacing,
+									const char* string, int32 length,
+									uint32 hash) const;
+			void				_Unlink(Entry* entry);
+			void				_LinkFirst(Entry* entry);
+			void				_Remove(Entry* entry);
+
+private:
+			Entry**				fTable;
+			uint32				fTableSize;
+			Entry*				fFirstUsed;
+			Entry*				fLastUsed;
+			int32				fCount;
+			int32				fMaxCount;
+			int32				fMaxLength;
+			status_t			fInitStatus;
+};
+
+
+}	// namespace BPrivate
+
+
+using BPrivate::StringWidthCache;
+
+
+#endif	// _STRING_WIDTH_CACHE_H
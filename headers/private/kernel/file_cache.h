@@ -16,6 +16,11 @@
 
 #define CACHE_CLEAR			1	// takes no parameters
 #define CACHE_SET_MODULE	2	// gets the module name as parameter
+#define CACHE_GET_READ_AHEAD_STATS	3	// fills in file_cache_read_ahead_stats
+#define CACHE_RESET_READ_AHEAD_STATS	4	// takes no parameters, root only
+#define CACHE_SET_MAX_READ_AHEAD	5	// gets the maximum window size in bytes
+										// as uint32 (0 disables read-ahead),
+										// root only
 
 #define CACHE_MODULES_NAME	"file_cache"
 
@@ -23,6 +28,17 @@
 #define FILE_CACHE_LOADED_COMPLETELY	0x02
 #define FILE_CACHE_NO_IO				0x04
 
+struct file_cache_read_ahead_stats {
+	int64		sequential_streams;	// newly detected sequential streams
+	int64		strided_streams;	// newly detected strided streams
+	int64		random_accesses;	// accesses that did not match any stream
+	int64		issued_requests;	// asynchronous read-ahead requests issued
+	int64		issued_pages;		// pages read ahead
+	int64		hit_pages;			// read-ahead pages that were actually read
+	int64		wasted_pages;		// read-ahead pages never read by the stream
+	uint32		max_window;			// current maximum window size in bytes
+};
+
 struct cache_module_info {
 	module_info	info;
 
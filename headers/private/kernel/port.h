@@ -45,6 +45,12 @@ status_t deselect_port(int32 object, struct select_info *info, bool kernel);
 status_t writev_port_etc(port_id id, int32 msgCode, const iovec *msgVecs,
 				size_t vecCount, size_t bufferSize, uint32 flags,
 				bigtime_t timeout);
+area_id read_port_area_etc(port_id id, int32 *msgCode, void **_address,
+				size_t *_size, uint32 flags, bigtime_t timeout);
+ssize_t read_port_multiple_etc(port_id id, void *buffer, size_t bufferSize,
+				uint32 flags, bigtime_t timeout);
+ssize_t write_port_multiple_etc(port_id id, const void *buffer,
+				size_t bufferSize, uint32 flags, bigtime_t timeout);
 
 // user syscalls
 port_id		_user_create_port(int32 queueLength, const char *name);
@@ -60,6 +66,13 @@ ssize_t		_user_port_count(port_id port);
 ssize_t		_user_read_port_etc(port_id port, int32 *msgCode,
 				void *msgBuffer, size_t bufferSize, uint32 flags,
 				bigtime_t timeout);
+area_id		_user_read_port_area_etc(port_id port, int32 *msgCode,
+				void **_address, size_t *_size, uint32 flags,
+				bigtime_t timeout);
+ssize_t		_user_read_port_multiple_etc(port_id port, void *buffer,
+				size_t bufferSize, uint32 flags, bigtime_t timeout);
+ssize_t		_user_write_port_multiple_etc(port_id port, const void *buffer,
+				size_t bufferSize, uint32 flags, bigtime_t timeout);
 status_t	_user_set_port_owner(port_id port, team_id team);
 status_t	_user_write_port_etc(port_id port, int32 msgCode,
 				const void *msgBuffer, size_t bufferSize,
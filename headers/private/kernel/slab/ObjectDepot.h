@@ -18,10 +18,14 @@ typedef struct object_depot {
 	spinlock				inner_lock;
 	DepotMagazine*			full;
 	DepotMagazine*			empty;
-	size_t					full_count;
-	size_t					empty_count;
-	size_t					max_count;
-	size_t					magazine_capacity;
+	int32					full_count;
+	int32					empty_count;
+	int32					max_count;
+	int32					magazine_capacity;
+	int32					min_magazine_capacity;
+	int32					max_magazine_capacity;
+	int32					exchange_count;
+	int32					contention_count;
 	struct depot_cpu_store*	stores;
 	void*					cookie;
 
@@ -40,7 +44,7 @@ status_t object_depot_init(object_depot* depot, size_t capacity,
 		uint32 flags));
 void object_depot_destroy(object_depot* depot, uint32 flags);
 
-void* object_depot_obtain(object_depot* depot);
+void* object_depot_obtain(object_depot* depot, uint32 flags);
 void object_depot_store(object_depot* depot, void* object, uint32 flags);
 
 void object_depot_make_empty(object_depot* depot, uint32 flags);
@@ -1,5 +1,5 @@
 /*
- * Copyright 2006, Haiku, Inc. All Rights Reserved.
+ * Copyright 2006-2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  */
 #ifndef NET_STAT_H
@@ -27,4 +27,28 @@ typedef struct net_stat {
 	size_t	send_queue_size;
 } net_stat;
 
+// retrieved via ioctl(socket, NET_STAT_PROTOCOL, &stat, sizeof(tcp_stat))
+// on any TCP socket; the counters cover all TCP connections of the system
+typedef struct tcp_stat {
+	uint32	time_wait_count;
+	uint32	time_wait_limit;
+	uint64	time_wait_entered;
+	uint64	time_wait_expired;
+	uint64	time_wait_evicted;
+	uint64	time_wait_recycled;
+
+	uint32	syn_cache_count;
+	uint32	syn_cache_limit;
+	uint64	syn_cache_added;
+	uint64	syn_cache_completed;
+	uint64	syn_cache_retransmits;
+	uint64	syn_cache_timed_out;
+	uint64	syn_cache_reset;
+	uint64	syn_cache_evicted;
+
+	uint64	syn_cookies_sent;
+	uint64	syn_cookies_accepted;
+	uint64	syn_cookies_rejected;
+} tcp_stat;
+
 #endif	// NET_STAT_H
@@ -0,0 +1,50 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _PACKAGE__PRIVATE__DOWNLOAD_PACKAGE_DELTA_REQUEST_H_
+#define _PACKAGE__PRIVATE__DOWNLOAD_PACKAGE_DELTA_REQUEST_H_
+
+
+#include <Entry.h>
+#include <String.h>
+
+#include <package/Context.h>
+#include <package/Request.h>
+
+
+namespace BPackageKit {
+
+namespace BPrivate {
+
+
+class DownloadPackageDeltaRequest : public BRequest {
+	typedef	BRequest				inherited;
+
+public:
+								DownloadPackageDeltaRequest(
+									const BContext& context,
+									const BString& deltaURL,
+									const BEntry& baseEntry,
+									const BEntry& deltaEntry,
+									const BEntry& targetEntry,
+									const BString& checksum = BString());
+	virtual						~DownloadPackageDeltaRequest();
+
+	virtual	status_t			CreateInitialJobs();
+
+private:
+			BString				fDeltaURL;
+			BEntry				fBaseEntry;
+			BEntry				fDeltaEntry;
+			BEntry				fTargetEntry;
+			BString				fChecksum;
+};
+
+
+}	// namespace BPrivate
+
+}	// namespace BPackageKit
+
+
+#endif // _PACKAGE__PRIVATE__DOWNLOAD_PACKAGE_DELTA_REQUEST_H_
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _PACKAGE__HPKG__PRIVATE__PACKAGE_DELTA_DEFS_H_
+#define _PACKAGE__HPKG__PRIVATE__PACKAGE_DELTA_DEFS_H_
+
+
+#include <SupportDefs.h>
+
+
+/*!	A package delta describes a package file (the target) in terms of an older
+	version of the package (the base): The target is the concatenation of the
+	results of the delta's commands, each of which either copies a range of
+	the base file or provides data of its own. Since the heap chunks of a
+	package file are compressed independently of each other, the writer
+	refers to every compressed heap chunk of the target that also exists in
+	the base, and provides everything else, i.e. the header, the changed
+	chunks, and the chunk size table, as data.
+
+	The layout is:
+		package_delta_header
+		the commands, each a package_delta_command, followed by its data
+		in case of B_PACKAGE_DELTA_COMMAND_DATA
+
+	Base and target are identified by their SHA-256 checksums, which the
+	reader verifies. All values are stored in big endian byte order, like in
+	package files.
+*/
+
+
+namespace BPackageKit {
+
+namespace BHPKG {
+
+namespace BPrivate {
+
+
+enum {
+	B_PACKAGE_DELTA_MAGIC			= 'hpkd',
+	B_PACKAGE_DELTA_VERSION			= 1,
+
+	B_PACKAGE_DELTA_CHECKSUM_SIZE	= 32
+};
+
+
+// command types
+enum {
+	B_PACKAGE_DELTA_COMMAND_COPY	= 1,
+	B_PACKAGE_DELTA_COMMAND_DATA	= 2
+};
+
+
+struct package_delta_header {
+	uint32	magic;							// "hpkd"
+	uint16	header_size;
+	uint16	version;
+	uint64	total_size;
+	uint64	base_size;
+	uint64	target_size;
+	uint32	command_count;
+	uint32	reserved1;
+	uint8	base_checksum[B_PACKAGE_DELTA_CHECKSUM_SIZE];
+	uint8	target_checksum[B_PACKAGE_DELTA_CHECKSUM_SIZE];
+};
+
+
+struct package_delta_command {
+	uint16	type;
+	uint16	reserved1;
+	uint32	reserved2;
+	uint64	offset;							// in the base, copy only
+	uint64	size;
+};
+
+
+}	// namespace BPrivate
+
+}	// namespace BHPKG
+
+}	// namespace BPackageKit
+
+
+#endif	// _PACKAGE__HPKG__PRIVATE__PACKAGE_DELTA_DEFS_H_
@@ -0,0 +1,75 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _PACKAGE__HPKG__PRIVATE__PACKAGE_DELTA_READER_H_
+#define _PACKAGE__HPKG__PRIVATE__PACKAGE_DELTA_READER_H_
+
+
+#include <package/hpkg/PackageDeltaDefs.h>
+
+
+namespace BPackageKit {
+
+namespace BHPKG {
+
+
+class BErrorOutput;
+
+
+namespace BPrivate {
+
+
+class PackageDeltaReader {
+public:
+								PackageDeltaReader(
+									BErrorOutput* errorOutput);
+								~PackageDeltaReader();
+
+			status_t			Init(int fd);
+									// the FD must remain open until Apply()
+									// has been called
+
+			uint64				BaseSize() const
+									{ return fBaseSize; }
+			uint64				TargetSize() const
+									{ return fTargetSize; }
+			const uint8*		BaseChecksum() const
+									{ return fBaseChecksum; }
+			const uint8*		TargetChecksum() const
+									{ return fTargetChecksum; }
+
+			status_t			Apply(int baseFD, int targetFD);
+									// fails with B_BAD_DATA, if the base
+									// or the resulting target don't match
+									// their checksums
+
+private:
+			status_t			_CheckBase(int baseFD);
+			status_t			_Read(int fd, off_t offset, void* buffer,
+									size_t size);
+			status_t			_Write(int fd, off_t offset, const void* data,
+									size_t size);
+
+private:
+			BErrorOutput*		fErrorOutput;
+			int					fFD;
+			uint64				fTotalSize;
+			uint64				fBaseSize;
+			uint64				fTargetSize;
+			uint32				fCommandCount;
+			uint8				fBaseChecksum[B_PACKAGE_DELTA_CHECKSUM_SIZE];
+			uint8				fTargetChecksum[
+									B_PACKAGE_DELTA_CHECKSUM_SIZE];
+			void*				fBuffer;
+};
+
+
+}	// namespace BPrivate
+
+}	// namespace BHPKG
+
+}	// namespace BPackageKit
+
+
+#endif	// _PACKAGE__HPKG__PRIVATE__PACKAGE_DELTA_READER_H_
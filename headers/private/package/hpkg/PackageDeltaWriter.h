@@ -0,0 +1,94 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _PACKAGE__HPKG__PRIVATE__PACKAGE_DELTA_WRITER_H_
+#define _PACKAGE__HPKG__PRIVATE__PACKAGE_DELTA_WRITER_H_
+
+
+#include <Array.h>
+
+#include <package/hpkg/PackageDeltaDefs.h>
+
+
+namespace BPackageKit {
+
+namespace BHPKG {
+
+
+class BErrorOutput;
+
+
+namespace BPrivate {
+
+
+class PackageFileHeapReader;
+
+
+class PackageDeltaWriter {
+public:
+								PackageDeltaWriter(
+									BErrorOutput* errorOutput);
+								~PackageDeltaWriter();
+
+			status_t			Init(int baseFD, int targetFD);
+									// the FDs must remain open until
+									// Finish() has been called
+
+			uint64				CopiedSize() const
+									{ return fCopiedSize; }
+									// target bytes copied from the base
+			uint64				DataSize() const
+									{ return fDataSize; }
+									// target bytes contained in the delta
+
+			status_t			Finish(int fd);
+
+private:
+			struct Command;
+			struct ChunkKey;
+			struct ChunkTable;
+
+private:
+			status_t			_IndexBaseChunks(
+									PackageFileHeapReader* heapReader);
+			status_t			_AddTargetChunks(
+									PackageFileHeapReader* heapReader);
+			status_t			_AddCopy(uint64 offset, uint64 size);
+			status_t			_AddData(uint64 offset, uint64 size);
+
+			status_t			_ComputeChecksum(int fd, uint64 size,
+									uint8* checksum);
+			status_t			_Read(int fd, off_t offset, void* buffer,
+									size_t size);
+			status_t			_Write(int fd, off_t offset, const void* data,
+									size_t size);
+
+	static	uint64				_Hash(const void* data, size_t size);
+
+private:
+			BErrorOutput*		fErrorOutput;
+			int					fBaseFD;
+			int					fTargetFD;
+			uint64				fBaseSize;
+			uint64				fTargetSize;
+			uint8				fBaseChecksum[B_PACKAGE_DELTA_CHECKSUM_SIZE];
+			uint8				fTargetChecksum[
+									B_PACKAGE_DELTA_CHECKSUM_SIZE];
+			ChunkTable*			fBaseChunks;
+			Array<Command>		fCommands;
+			uint64				fCopiedSize;
+			uint64				fDataSize;
+			void*				fBuffer;
+			void*				fBaseBuffer;
+};
+
+
+}	// namespace BPrivate
+
+}	// namespace BHPKG
+
+}	// namespace BPackageKit
+
+
+#endif	// _PACKAGE__HPKG__PRIVATE__PACKAGE_DELTA_WRITER_H_
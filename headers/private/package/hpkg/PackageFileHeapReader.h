@@ -23,6 +23,9 @@ namespace BPrivate {
 
 
 class PackageFileHeapReader : public PackageFileHeapAccessorBase {
+public:
+			class ChunkCache;
+
 public:
 								PackageFileHeapReader(BErrorOutput* errorOutput,
 									BPositionIO* file, off_t heapOffset,
@@ -35,6 +38,10 @@ public:
 			status_t			Init();
 
 			PackageFileHeapReader* Clone() const;
+									// doesn't copy the chunk cache
+
+			void				SetChunkCache(ChunkCache* chunkCache)
+									{ fChunkCache = chunkCache; }
 
 			const OffsetArray&	Offsets() const
 									{ return fOffsets; }
@@ -46,6 +53,24 @@ protected:
 
 private:
 			OffsetArray			fOffsets;
+			ChunkCache*			fChunkCache;
+};
+
+
+/*!	Interface for a cache of decompressed chunks the heap reader consults
+	before reading and decompressing a compressed chunk.
+*/
+class PackageFileHeapReader::ChunkCache {
+public:
+	virtual						~ChunkCache();
+
+	virtual	bool				GetChunk(size_t chunkIndex, void* buffer,
+									size_t size) = 0;
+									// copies the cached data into buffer
+	virtual	void				PutChunk(size_t chunkIndex, const void* data,
+									size_t size, bigtime_t readTime) = 0;
+									// readTime: time spent reading and
+									// decompressing the chunk
 };
 
 
@@ -42,7 +42,7 @@ public:
 										decompressionAlgorithm);
 								~PackageFileHeapWriter();
 
-			void				Init();
+			void				Init(int32 compressionThreadCount = 1);
 			void				Reinit(PackageFileHeapReader* heapReader);
 
 			status_t			AddData(BDataReader& dataReader, off_t size,
@@ -63,17 +63,29 @@ private:
 			struct Chunk;
 			struct ChunkSegment;
 			struct ChunkBuffer;
+			struct CompressionJob;
+			struct CompressionThreadPool;
 
 			friend struct ChunkBuffer;
+			friend struct CompressionThreadPool;
 
 private:
 			void				_Uninit();
 
+			status_t			_AddData(BDataReader& dataReader, off_t size,
+									bool synchronous);
+			status_t			_QueuePendingData();
 			status_t			_FlushPendingData();
+			status_t			_WriteQueuedChunks(int32 maxQueuedChunks);
 			status_t			_WriteChunk(const void* data, size_t size,
 									bool mayCompress);
-			status_t			_WriteDataCompressed(const void* data,
-									size_t size);
+			status_t			_WriteChunkData(const void* data,
+									size_t size, const void* compressedData,
+									size_t compressedSize,
+									status_t compressionStatus);
+			status_t			_CompressChunk(const void* data, size_t size,
+									void* compressedDataBuffer,
+									size_t& _compressedSize) const;
 			status_t			_WriteDataUncompressed(const void* data,
 									size_t size);
 
@@ -87,6 +99,8 @@ private:
 			size_t				fPendingDataSize;
 			Array<uint64>		fOffsets;
 			CompressionAlgorithmOwner* fCompressionAlgorithm;
+			int32				fCompressionThreadCount;
+			CompressionThreadPool* fCompressionThreads;
 };
 
 
@@ -0,0 +1,156 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _PACKAGE__HPKG__PRIVATE__PACKAGE_TOC_CACHE_DEFS_H_
+#define _PACKAGE__HPKG__PRIVATE__PACKAGE_TOC_CACHE_DEFS_H_
+
+
+#include <SupportDefs.h>
+
+#include <package/hpkg/HPKGDefs.h>
+
+
+/*!	The package TOC cache stores the content of a set of package files the way
+	packagefs consumes it: the package attributes -- except for the writable
+	file, settings file, and user infos, which packagefs ignores -- and the
+	entry tree, as a sequence of records per package. packagefs replays the
+	records instead of reading and decompressing the package's TOC and
+	attributes sections.
+
+	The file is position independent and can be mapped as is. All values are
+	stored in host byte order; a cache written on a host of different
+	endianness fails the magic check. The layout is:
+		package_toc_cache_header
+		package_toc_cache_package[package_count], sorted by file name
+		the records of all packages
+		the strings, each null-terminated
+
+	Strings are referred to by their offset in the strings section.
+*/
+
+
+namespace BPackageKit {
+
+namespace BHPKG {
+
+namespace BPrivate {
+
+
+enum {
+	B_PACKAGE_TOC_CACHE_MAGIC		= 'ptcc',
+	B_PACKAGE_TOC_CACHE_VERSION		= 1,
+
+	B_PACKAGE_TOC_CACHE_NO_STRING	= 0xffffffff,
+	B_PACKAGE_TOC_CACHE_ALIGNMENT	= 8
+};
+
+
+// record types
+enum {
+	B_PACKAGE_TOC_CACHE_RECORD_PACKAGE_ATTRIBUTE	= 1,
+	B_PACKAGE_TOC_CACHE_RECORD_ENTRY				= 2,
+	B_PACKAGE_TOC_CACHE_RECORD_ENTRY_ATTRIBUTE		= 3,
+	B_PACKAGE_TOC_CACHE_RECORD_ENTRY_DONE			= 4
+};
+
+
+// record flags
+enum {
+	B_PACKAGE_TOC_CACHE_DATA_INLINE					= 0x01,
+	B_PACKAGE_TOC_CACHE_HAVE_VERSION				= 0x02,
+	B_PACKAGE_TOC_CACHE_HAVE_COMPATIBLE_VERSION		= 0x04
+};
+
+
+struct package_toc_cache_header {
+	uint32	magic;							// "ptcc"
+	uint16	version;
+	uint16	header_size;
+	uint64	total_size;
+	uint32	package_count;
+	uint32	reserved1;
+	uint64	strings_offset;
+	uint64	strings_size;
+};
+
+
+/*!	A package is identified by its file name. The cached content is valid only
+	as long as size, modification time, and -- unless 0 -- node ID of the file
+	still match.
+*/
+struct package_toc_cache_package {
+	uint32	file_name;
+	uint32	reserved1;
+	uint64	file_size;
+	int64	modified_time;
+	uint64	node_id;
+	uint64	records_offset;
+	uint64	records_size;
+};
+
+
+struct package_toc_cache_record {
+	uint16	type;
+	uint16	flags;
+	uint32	size;							// including this header
+};
+
+
+struct package_toc_cache_data {
+	uint64	size;
+	union {
+		uint64	offset;
+		uint8	inline_data[B_HPKG_MAX_INLINE_DATA_SIZE];
+	};
+};
+
+
+struct package_toc_cache_version {
+	uint32	major;
+	uint32	minor;
+	uint32	micro;
+	uint32	pre_release;
+	uint32	revision;
+	uint32	reserved1;
+};
+
+
+struct package_toc_cache_package_attribute {
+	package_toc_cache_record	record;
+	uint32						id;
+	uint32						string;		// also the resolvable name
+	uint64						value;		// also the expression operator
+	package_toc_cache_version	version;
+	package_toc_cache_version	compatible_version;
+};
+
+
+struct package_toc_cache_entry {
+	package_toc_cache_record	record;
+	uint32						name;
+	uint32						symlink_path;
+	uint32						mode;
+	uint32						reserved1;
+	uint32						modified_time;
+	uint32						modified_time_nanos;
+	package_toc_cache_data		data;
+};
+
+
+struct package_toc_cache_entry_attribute {
+	package_toc_cache_record	record;
+	uint32						name;
+	uint32						type;
+	package_toc_cache_data		data;
+};
+
+
+}	// namespace BPrivate
+
+}	// namespace BHPKG
+
+}	// namespace BPackageKit
+
+
+#endif	// _PACKAGE__HPKG__PRIVATE__PACKAGE_TOC_CACHE_DEFS_H_
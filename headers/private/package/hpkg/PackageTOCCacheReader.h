@@ -0,0 +1,90 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _PACKAGE__HPKG__PRIVATE__PACKAGE_TOC_CACHE_READER_H_
+#define _PACKAGE__HPKG__PRIVATE__PACKAGE_TOC_CACHE_READER_H_
+
+
+#include <sys/stat.h>
+
+#include <package/hpkg/PackageTOCCacheDefs.h>
+
+
+namespace BPackageKit {
+
+namespace BHPKG {
+
+
+class BErrorOutput;
+class BPackageContentHandler;
+
+
+namespace BPrivate {
+
+
+class PackageTOCCacheReader {
+public:
+								PackageTOCCacheReader(
+									BErrorOutput* errorOutput);
+								~PackageTOCCacheReader();
+
+			status_t			Init(int fd);
+									// reads the whole file
+			status_t			Init(const void* data, size_t size);
+									// data must stay valid (e.g. mapped)
+
+			uint32				CountPackages() const;
+			const package_toc_cache_package* PackageAt(uint32 index) const;
+			const package_toc_cache_package* FindPackage(
+									const char* fileName) const;
+
+			const char*			FileName(
+									const package_toc_cache_package* package)
+									const;
+			bool				IsUpToDate(
+									const package_toc_cache_package* package,
+									const struct stat& st) const;
+
+			status_t			ParseContent(
+									const package_toc_cache_package* package,
+									uint64 heapSize,
+									BPackageContentHandler* contentHandler)
+									const;
+									// may be called by several threads;
+									// heapSize is the package's uncompressed
+									// heap size, which the data must lie in
+
+private:
+			struct Entry;
+
+private:
+			status_t			_Init();
+			const char*			_String(uint32 offset) const;
+			const char*			_OptionalString(uint32 offset,
+									bool& _valid) const;
+			status_t			_ParseRecords(const uint8* records,
+									const uint8* recordsEnd,
+									uint64 heapSize,
+									BPackageContentHandler* contentHandler,
+									Entry*& _entry) const;
+
+private:
+			BErrorOutput*		fErrorOutput;
+			const uint8*		fData;
+			size_t				fSize;
+			uint8*				fOwnedData;
+			const package_toc_cache_header* fHeader;
+			const package_toc_cache_package* fPackages;
+			const char*			fStrings;
+};
+
+
+}	// namespace BPrivate
+
+}	// namespace BHPKG
+
+}	// namespace BPackageKit
+
+
+#endif	// _PACKAGE__HPKG__PRIVATE__PACKAGE_TOC_CACHE_READER_H_
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _PACKAGE__HPKG__PRIVATE__PACKAGE_TOC_CACHE_WRITER_H_
+#define _PACKAGE__HPKG__PRIVATE__PACKAGE_TOC_CACHE_WRITER_H_
+
+
+#include <Array.h>
+
+#include <package/hpkg/PackageTOCCacheDefs.h>
+#include <package/hpkg/Strings.h>
+
+
+namespace BPackageKit {
+
+namespace BHPKG {
+
+
+class BErrorOutput;
+
+
+namespace BPrivate {
+
+
+class PackageTOCCacheReader;
+
+
+class PackageTOCCacheWriter {
+public:
+								PackageTOCCacheWriter(
+									BErrorOutput* errorOutput);
+								~PackageTOCCacheWriter();
+
+			status_t			Init(
+									const PackageTOCCacheReader* previousCache
+										= NULL);
+									// up-to-date packages are copied from the
+									// previous cache instead of being parsed
+
+			void				SetRecordNodeIDs(bool record)
+									{ fRecordNodeIDs = record; }
+									// A cache without node IDs remains valid
+									// when the packages are copied elsewhere.
+
+			status_t			AddPackage(int directoryFD,
+									const char* fileName);
+
+			int32				CountPackages() const
+									{ return fPackages.Count(); }
+			int32				CountReusedPackages() const
+									{ return fReusedPackageCount; }
+			bool				HasChanges() const;
+									// whether the cache differs from the
+									// previous one
+
+			status_t			Finish(int fd);
+
+private:
+			struct Package;
+			struct RecordingContentHandler;
+
+private:
+			status_t			_AddString(const char* string,
+									uint32& _offset);
+			status_t			_AddOptionalString(const char* string,
+									uint32& _offset);
+			status_t			_Write(int fd, off_t offset, const void* data,
+									size_t size);
+
+	static	bool				_PackageFileNameLess(const Package* a,
+									const Package* b);
+
+private:
+			BErrorOutput*		fErrorOutput;
+			const PackageTOCCacheReader* fPreviousCache;
+			bool				fRecordNodeIDs;
+			Array<Package*>		fPackages;
+			int32				fReusedPackageCount;
+			CachedStringTable	fStringTable;
+			Array<char>			fStrings;
+};
+
+
+}	// namespace BPrivate
+
+}	// namespace BHPKG
+
+}	// namespace BPackageKit
+
+
+#endif	// _PACKAGE__HPKG__PRIVATE__PACKAGE_TOC_CACHE_WRITER_H_
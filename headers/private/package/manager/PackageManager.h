@@ -110,6 +110,11 @@ public:
 	virtual	status_t			DownloadPackage(const BString& fileURL,
 									const BEntry& targetEntry,
 									const BString& checksum);
+	virtual	status_t			DownloadPackageDelta(const BString& deltaURL,
+									const BEntry& baseEntry,
+									const BEntry& deltaEntry,
+									const BEntry& targetEntry,
+									const BString& checksum);
 	virtual	status_t			RefreshRepository(
 									const BRepositoryConfig& repoConfig);
 
@@ -132,6 +137,12 @@ private:
 									InstalledRepository&
 										installationRepository);
 			void				_CommitPackageChanges(Transaction& transaction);
+			bool				_DownloadPackageDelta(
+									InstalledRepository&
+										installationRepository,
+									RemoteRepository* remoteRepository,
+									BSolverPackage* package,
+									BEntry& entry);
 
 			void				_ClonePackageFile(
 									LocalRepository* repository,
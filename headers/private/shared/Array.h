@@ -297,7 +297,7 @@ Array<Element>::_Resize(int32 index, int32 delta)
 }	// namespace BPrivate
 
 
-using BPrivate::Array;
+using ::BPrivate::Array;
 
 
 #endif	// _ARRAY_H
@@ -7,4 +7,8 @@
 // notifications if the entry stays in the query.
 #define B_ATTR_CHANGE_NOTIFICATION		0x0000F000
 
+// B_QUERY_EXPLAIN asks the file system to print how it is going to evaluate
+// the query to the syslog. Not every file system supports this.
+#define B_QUERY_EXPLAIN					0x00010000
+
 #endif
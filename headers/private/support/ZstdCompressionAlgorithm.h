@@ -18,6 +18,11 @@ enum {
 	B_ZSTD_COMPRESSION_DEFAULT	= 2,
 };
 
+// window size (log2) used with long distance matching, if none is given
+enum {
+	B_ZSTD_DEFAULT_LONG_WINDOW_LOG	= 27
+};
+
 
 class BZstdCompressionParameters : public BCompressionParameters {
 public:
@@ -32,9 +37,14 @@ public:
 			size_t				BufferSize() const;
 			void				SetBufferSize(size_t size);
 
+			int32				LongWindowLog() const;
+			void				SetLongWindowLog(int32 windowLog);
+									// 0: no long distance matching
+
 private:
 			int32				fCompressionLevel;
 			size_t				fBufferSize;
+			int32				fLongWindowLog;
 };
 
 
@@ -46,8 +56,13 @@ public:
 			size_t				BufferSize() const;
 			void				SetBufferSize(size_t size);
 
+			int32				MaxWindowLog() const;
+			void				SetMaxWindowLog(int32 windowLog);
+									// 0: zstd's default limit
+
 private:
 			size_t				fBufferSize;
+			int32				fMaxWindowLog;
 };
 
 
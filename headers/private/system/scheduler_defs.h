@@ -62,4 +62,68 @@ struct scheduling_analysis {
 };
 
 
+// generic syscall interface to the scheduler statistics
+#define SCHEDULER_STATISTICS_SYSCALLS	"scheduler statistics"
+#define GET_SCHEDULER_CPU_STATISTICS	0x01
+#define GET_SCHEDULER_TRACE				0x02
+
+// Bucket 0 counts wake up latencies below 1 us, bucket i > 0 those in
+// [2^(i - 1), 2^i) us, and the last one all longer ones.
+#define SCHEDULER_LATENCY_BUCKETS		16
+
+
+typedef struct scheduler_cpu_statistics {
+	int32		cpu;
+	int32		core;
+	int32		load;
+	int32		core_load;
+		// per mille, at the time the statistics were retrieved
+
+	uint64		context_switches;
+	uint64		migrations;
+		// threads that were moved to this CPU from another core
+
+	uint64		run_queue_samples;
+	uint64		run_queue_length_sum;
+	int32		max_run_queue_length;
+		// ready and running threads of the core, sampled at each switch
+
+	uint64		wake_ups;
+	bigtime_t	total_wake_up_latency;
+	bigtime_t	max_wake_up_latency;
+	uint64		wake_up_latencies[SCHEDULER_LATENCY_BUCKETS];
+
+	uint64		trace_entries;
+		// number of entries ever written to the trace ring of this CPU
+} scheduler_cpu_statistics;
+
+
+enum {
+	SCHEDULER_TRACE_WAKE_UP		= 0,
+	SCHEDULER_TRACE_MIGRATE,
+	SCHEDULER_TRACE_SCHEDULE
+};
+
+typedef struct scheduler_trace_entry {
+	bigtime_t	time;
+	thread_id	thread;
+	uint16		type;
+	int16		run_queue_length;
+	int16		core;
+	int16		core_load;
+	int32		value;
+		// SCHEDULER_TRACE_MIGRATE: the previous core
+		// SCHEDULER_TRACE_SCHEDULE: the wake up latency, or -1
+} scheduler_trace_entry;
+
+typedef struct scheduler_trace_request {
+	int32					cpu;
+	uint32					count;
+		// in: the size of the entries array, out: the entries retrieved
+	uint64					first;
+		// out: the sequence number of the first entry
+	scheduler_trace_entry*	entries;
+} scheduler_trace_request;
+
+
 #endif	/* _SYSTEM_SCHEDULER_DEFS_H */
@@ -465,6 +465,14 @@ extern int32		_kern_port_count(port_id port);
 extern ssize_t		_kern_read_port_etc(port_id port, int32 *msgCode,
 						void *msgBuffer, size_t bufferSize, uint32 flags,
 						bigtime_t timeout);
+extern area_id		_kern_read_port_area_etc(port_id port, int32 *msgCode,
+						void **_address, size_t *_size, uint32 flags,
+						bigtime_t timeout);
+extern ssize_t		_kern_read_port_multiple_etc(port_id port, void *buffer,
+						size_t bufferSize, uint32 flags, bigtime_t timeout);
+extern ssize_t		_kern_write_port_multiple_etc(port_id port,
+						const void *buffer, size_t bufferSize, uint32 flags,
+						bigtime_t timeout);
 extern status_t		_kern_set_port_owner(port_id port, team_id team);
 extern status_t		_kern_write_port_etc(port_id port, int32 msgCode,
 						const void *msgBuffer, size_t bufferSize, uint32 flags,
@@ -2327,6 +2327,43 @@ BPlusTree::Find(const uint8* key, uint16 keyLength, off_t* _value)
 
 
 #if !_BOOT_MODE
+/*!	Returns a rough estimate of the number of values stored in the tree,
+	without having to iterate through it. It assumes that all nodes of the
+	tree are filled about as well as its first leaf node, and ignores the
+	internal and free nodes. In \a _valuesPerNode, the number of values
+	in the first leaf is returned.
+*/
+status_t
+BPlusTree::EstimateValues(off_t* _values, uint32* _valuesPerNode)
+{
+	InodeReadLocker locker(fStream);
+
+	off_t nodeOffset = fHeader.RootNode();
+	CachedNode cached(this);
+	const bplustree_node* node;
+
+	while ((node = cached.SetTo(nodeOffset)) != NULL) {
+		if (node->OverflowLink() == BPLUSTREE_NULL) {
+			uint32 valuesPerNode = max_c(node->NumKeys(), 1);
+			off_t nodes = fStream->Size() / fNodeSize - 1;
+
+			*_values = nodes * valuesPerNode;
+			*_valuesPerNode = valuesPerNode;
+			return B_OK;
+		}
+
+		off_t nextOffset = node->NumKeys() == 0 ? node->OverflowLink()
+			: BFS_ENDIAN_TO_HOST_INT64(node->Values()[0]);
+		if (nextOffset == nodeOffset)
+			break;
+
+		nodeOffset = nextOffset;
+	}
+
+	RETURN_ERROR(B_ERROR);
+}
+
+
 status_t
 BPlusTree::_ValidateChildren(TreeCheck& check, uint32 level, off_t offset,
 	const uint8* largestKey, uint16 largestKeyLength,
@@ -308,6 +308,9 @@ public:
 									off_t* value);
 
 #if !_BOOT_MODE
+			status_t			EstimateValues(off_t* _values,
+									uint32* _valuesPerNode);
+
 	static	int32				TypeCodeToKeyType(type_code code);
 	static	int32				ModeToKeyType(mode_t mode);
 
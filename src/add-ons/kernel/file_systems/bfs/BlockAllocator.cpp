@@ -160,6 +160,13 @@ private:
 #	define T(x) ;
 #endif
 
+// Files reserve the free blocks behind their last allocation in windows
+// that start at kMinReservationWindow bytes, and double every time they
+// are used up, up to kMaxReservationWindow bytes.
+static const uint32 kMinReservationWindow = 256 * 1024;
+static const uint32 kMaxReservationWindow = 16 * 1024 * 1024;
+
+
 #ifdef DEBUG_ALLOCATION_GROUPS
 #	define CHECK_ALLOCATION_GROUP(group) _CheckGroup(group)
 #else
@@ -217,6 +224,8 @@ private:
 	int32	fLargestStart;
 	int32	fLargestLength;
 	bool	fLargestValid;
+
+	int32	fReservations;
 };
 
 
@@ -345,7 +354,8 @@ AllocationGroup::AllocationGroup()
 	:
 	fFirstFree(-1),
 	fFreeBits(0),
-	fLargestValid(false)
+	fLargestValid(false),
+	fReservations(0)
 {
 }
 
@@ -504,7 +514,8 @@ AllocationGroup::Free(Transaction& transaction, uint16 start, int32 length)
 BlockAllocator::BlockAllocator(Volume* volume)
 	:
 	fVolume(volume),
-	fGroups(NULL)
+	fGroups(NULL),
+	fReservationsEnabled(true)
 	//fCheckBitmap(NULL),
 	//fCheckCookie(NULL)
 {
@@ -713,6 +724,8 @@ BlockAllocator::Uninitialize()
 	// We only have to make sure that the initializer thread isn't running
 	// anymore.
 	recursive_lock_lock(&fLock);
+
+	_UnreserveAll();
 }
 
 
@@ -734,15 +747,278 @@ BlockAllocator::AllocateBlocks(Transaction& transaction, int32 groupIndex,
 		", maximum = %" B_PRIu16 ", minimum = %" B_PRIu16 "\n",
 		groupIndex, start, maximum, minimum));
 
-	AllocationBlock cached(fVolume);
 	RecursiveLocker lock(fLock);
 
+	int32 bestGroup;
+	int32 bestStart;
+	int32 bestLength;
+	status_t status = _FindFreeRange(groupIndex, start, maximum, minimum,
+		bestGroup, bestStart, bestLength);
+	if (status != B_OK)
+		return status;
+
+	if (bestLength > maximum)
+		bestLength = maximum;
+	else if (minimum > 1) {
+		// make sure bestLength is a multiple of minimum
+		bestLength = round_down(bestLength, minimum);
+	}
+
+	return _AllocateRun(transaction, bestGroup, bestStart, bestLength, run);
+}
+
+
+status_t
+BlockAllocator::AllocateForInode(Transaction& transaction,
+	const block_run* parent, mode_t type, block_run& run)
+{
+	// Apply some allocation policies here (AllocateBlocks() will break them
+	// if necessary) - we will start with those described in Dominic Giampaolo's
+	// "Practical File System Design", and see how good they work
+
+	// Files are going in the same allocation group as its parent,
+	// sub-directories will be inserted 8 allocation groups after
+	// the one of the parent
+	uint16 group = parent->AllocationGroup();
+	if ((type & (S_DIRECTORY | S_INDEX_DIR | S_ATTR_DIR)) == S_DIRECTORY)
+		group += 8;
+
+	return AllocateBlocks(transaction, group, 0, 1, 1, run);
+}
+
+
+/*!	Allocates up to \a numBlocks blocks for the data stream of \a inode.
+	Files get their blocks from the reservation behind their last allocation
+	first. If there is none, they look for a free range that can hold the
+	reservation window in addition to the requested blocks, and reserve the
+	rest of it, so that they can continue to grow contiguously even while
+	other files are written at the same time.
+*/
+status_t
+BlockAllocator::Allocate(Transaction& transaction, Inode* inode,
+	off_t numBlocks, block_run& run, uint16 minimum)
+{
+	if (numBlocks <= 0)
+		return B_ERROR;
+
+	// one block_run can't hold more data than there is in one allocation group
+	if (numBlocks > fGroups[0].NumBits())
+		numBlocks = fGroups[0].NumBits();
+
+	// since block_run.length is uint16, the largest number of blocks that
+	// can be covered by a block_run is 65535
+	// TODO: if we drop compatibility, couldn't we do this any better?
+	// There are basically two possibilities:
+	// a) since a length of zero doesn't have any sense, take that for 65536 -
+	//    but that could cause many problems (bugs) in other areas
+	// b) reduce the maximum amount of blocks per block_run, so that the
+	//    remaining number of free blocks can be used in a useful manner
+	//    (like 4 blocks) - but that would also reduce the maximum file size
+	// c) have BlockRun::Length() return (length + 1).
+	if (numBlocks > MAX_BLOCK_RUN_LENGTH)
+		numBlocks = MAX_BLOCK_RUN_LENGTH;
+
+	RecursiveLocker lock(fLock);
+
+	BlockReservation& reservation = inode->Reservation();
+	if (!reservation.IsEmpty()
+		&& _AllocateFromReservation(transaction, reservation, numBlocks,
+			minimum, run) == B_OK) {
+		if (reservation.IsEmpty())
+			_ExtendReservation(reservation, inode, run);
+		return B_OK;
+	}
+
+	// Apply some allocation policies here (AllocateBlocks() will break them
+	// if necessary)
+	uint16 group = inode->BlockRun().AllocationGroup();
+	uint16 start = 0;
+
+	// Are there already allocated blocks? (then just try to allocate near the
+	// last one)
+	if (inode->Size() > 0) {
+		const data_stream& data = inode->Node().data;
+		// TODO: we currently don't care for when the data stream
+		// is already grown into the indirect ranges
+		if (data.max_double_indirect_range == 0
+			&& data.max_indirect_range == 0) {
+			// Since size > 0, there must be a valid block run in this stream
+			int32 last = 0;
+			for (; last < NUM_DIRECT_BLOCKS - 1; last++)
+				if (data.direct[last + 1].IsZero())
+					break;
+
+			group = data.direct[last].AllocationGroup();
+			start = data.direct[last].Start() + data.direct[last].Length();
+		}
+	} else if (inode->IsContainer() || inode->IsSymLink()) {
+		// directory and symbolic link data will go in the same allocation
+		// group as the inode is in but after the inode data
+		start = inode->BlockRun().Start();
+	} else {
+		// file data will start in the next allocation group
+		group = inode->BlockRun().AllocationGroup() + 1;
+	}
+
+	uint32 window = _ReservationWindow(inode, reservation);
+	if (window == 0)
+		return AllocateBlocks(transaction, group, start, numBlocks, minimum, run);
+
+	// Look for a range that can hold the reservation window, too
+	int32 bestGroup;
+	int32 bestStart;
+	int32 bestLength;
+	status_t status = _FindFreeRange(group, start,
+		min_c(numBlocks + window, MAX_BLOCK_RUN_LENGTH), minimum, bestGroup,
+		bestStart, bestLength);
+	if (status != B_OK)
+		return status;
+
+	int32 length = min_c(bestLength, numBlocks);
+	if (minimum > 1)
+		length = round_down(length, minimum);
+
+	status = _AllocateRun(transaction, bestGroup, bestStart, length, run);
+	if (status != B_OK)
+		return status;
+
+	if (bestLength > length) {
+		_Reserve(reservation, bestGroup, bestStart + length,
+			min_c(bestLength - length, (int32)window), window);
+	} else
+		reservation.fWindow = window;
+
+	return B_OK;
+}
+
+
+status_t
+BlockAllocator::Free(Transaction& transaction, block_run run)
+{
+	RecursiveLocker lock(fLock);
+
+	int32 group = run.AllocationGroup();
+	uint16 start = run.Start();
+	uint16 length = run.Length();
+
+	FUNCTION_START(("group = %" B_PRId32 ", start = %" B_PRIu16
+		", length = %" B_PRIu16 "\n", group, start, length))
+	T(Free(run));
+
+	// doesn't use Volume::IsValidBlockRun() here because it can check better
+	// against the group size (the last group may have a different length)
+	if (group < 0 || group >= fNumGroups
+		|| start > fGroups[group].NumBits()
+		|| uint32(start + length) > fGroups[group].NumBits()
+		|| length == 0) {
+		FATAL(("tried to free an invalid block_run"
+			" (%" B_PRId32 ", %" B_PRIu16 ", %" B_PRIu16")\n",
+			group, start, length));
+		DEBUGGER(("tried to free invalid block_run"));
+		return B_BAD_VALUE;
+	}
+	// check if someone tries to free reserved areas at the beginning of the
+	// drive
+	if (group == 0
+		&& start < uint32(fVolume->Log().Start() + fVolume->Log().Length())) {
+		FATAL(("tried to free a reserved block_run"
+			" (%" B_PRId32 ", %" B_PRIu16 ", %" B_PRIu16")\n",
+			group, start, length));
+		DEBUGGER(("tried to free reserved block"));
+		return B_BAD_VALUE;
+	}
+#ifdef DEBUG
+	if (CheckBlockRun(run) != B_OK)
+		return B_BAD_DATA;
+#endif
+
+	CHECK_ALLOCATION_GROUP(group);
+
+	if (fGroups[group].Free(transaction, start, length) != B_OK)
+		RETURN_ERROR(B_IO_ERROR);
+
+	CHECK_ALLOCATION_GROUP(group);
+
+#ifdef DEBUG
+	if (CheckBlockRun(run, NULL, false) != B_OK) {
+		DEBUGGER(("CheckBlockRun() reports allocated blocks (which were just "
+			"freed)\n"));
+	}
+#endif
+
+	fVolume->SuperBlock().used_blocks =
+		HOST_ENDIAN_TO_BFS_INT64(fVolume->UsedBlocks() - run.Length());
+	return B_OK;
+}
+
+
+/*!	Gives back the blocks reserved by \a reservation, and resets its window.
+	Nothing has to be written back, as reserved blocks are free on disk.
+*/
+void
+BlockAllocator::ReleaseReservation(BlockReservation& reservation)
+{
+	reservation.fWindow = 0;
+
+	// Only the owner of a reservation can add it, so we don't need to lock
+	// if there is nothing to release; this is also the case for all inodes
+	// that are released after Uninitialize().
+	if (reservation.fGroup < 0)
+		return;
+
+	RecursiveLocker lock(fLock);
+
+	_Unreserve(reservation);
+}
+
+
+void
+BlockAllocator::SetReservationsEnabled(bool enabled)
+{
+	RecursiveLocker lock(fLock);
+
+	fReservationsEnabled = enabled;
+	if (!enabled)
+		_UnreserveAll();
+}
+
+
+/*!	Searches for the best free range as described in AllocateBlocks(). If
+	there is no range of at least \a minimum blocks, all reservations are
+	given up, and the search is repeated.
+*/
+status_t
+BlockAllocator::_FindFreeRange(int32 groupIndex, uint16 start, int32 maximum,
+	uint16 minimum, int32& bestGroup, int32& bestStart, int32& bestLength)
+{
+	status_t status = _SearchFreeRange(groupIndex, start, maximum, bestGroup,
+		bestStart, bestLength);
+	if (status == B_OK && bestLength < minimum && !fReservations.IsEmpty()) {
+		_UnreserveAll();
+		status = _SearchFreeRange(groupIndex, start, maximum, bestGroup,
+			bestStart, bestLength);
+	}
+	if (status != B_OK)
+		return status;
+
+	if (bestLength < minimum)
+		return B_DEVICE_FULL;
+
+	return B_OK;
+}
+
+
+//!	Finds the block_run that can fulfill the request best.
+status_t
+BlockAllocator::_SearchFreeRange(int32 groupIndex, uint16 start,
+	int32 maximum, int32& bestGroup, int32& bestStart, int32& bestLength)
+{
+	AllocationBlock cached(fVolume);
 	uint32 bitsPerFullBlock = fVolume->BlockSize() << 3;
 
-	// Find the block_run that can fulfill the request best
-	int32 bestGroup = -1;
-	int32 bestStart = -1;
-	int32 bestLength = -1;
+	bestGroup = -1;
+	bestStart = -1;
+	bestLength = -1;
 
 	for (int32 i = 0; i < fNumGroups + 1; i++, groupIndex++, start = 0) {
 		groupIndex = groupIndex % fNumGroups;
@@ -759,7 +1035,10 @@ BlockAllocator::AllocateBlocks(Transaction& transaction, int32 groupIndex,
 		if (start < group.fFirstFree)
 			start = group.fFirstFree;
 
-		if (group.fLargestValid) {
+		// The largest free range hint doesn't take reservations into account
+		bool hasReservations = group.fReservations > 0;
+
+		if (group.fLargestValid && !hasReservations) {
 			if (group.fLargestLength < bestLength)
 				continue;
 
@@ -788,7 +1067,15 @@ BlockAllocator::AllocateBlocks(Transaction& transaction, int32 groupIndex,
 		int32 groupLargestStart = -1;
 		int32 groupLargestLength = -1;
 		int32 currentBit = start;
-		bool canFindGroupLargest = start == 0;
+		bool canFindGroupLargest = start == 0 && !hasReservations;
+
+		// reserved blocks are treated like used ones
+		int32 reservedStart = INT32_MAX;
+		int32 reservedEnd = INT32_MAX;
+		if (hasReservations) {
+			_NextReservation(groupIndex, currentBit, reservedStart,
+				reservedEnd);
+		}
 
 		for (; block < group.NumBlocks(); block++) {
 			if (cached.SetTo(group, block) < B_OK)
@@ -800,7 +1087,12 @@ BlockAllocator::AllocateBlocks(Transaction& transaction, int32 groupIndex,
 			// find a block large enough to hold the allocation
 			for (uint32 bit = start % bitsPerFullBlock;
 					bit < cached.NumBlockBits(); bit++) {
-				if (!cached.IsUsed(bit)) {
+				if (currentBit >= reservedEnd) {
+					_NextReservation(groupIndex, currentBit, reservedStart,
+						reservedEnd);
+				}
+
+				if (!cached.IsUsed(bit) && currentBit < reservedStart) {
 					if (currentLength == 0) {
 						// start new range
 						currentStart = currentBit;
@@ -873,29 +1165,28 @@ BlockAllocator::AllocateBlocks(Transaction& transaction, int32 groupIndex,
 			break;
 	}
 
-	// If we found a suitable range, mark the blocks as in use, and
-	// write the updated block bitmap back to disk
-	if (bestLength < minimum)
-		return B_DEVICE_FULL;
+	return B_OK;
+}
 
-	if (bestLength > maximum)
-		bestLength = maximum;
-	else if (minimum > 1) {
-		// make sure bestLength is a multiple of minimum
-		bestLength = round_down(bestLength, minimum);
-	}
 
-	if (fGroups[bestGroup].Allocate(transaction, bestStart, bestLength) != B_OK)
+/*!	Marks the given range as in use, and updates the volume's used blocks
+	count accordingly.
+*/
+status_t
+BlockAllocator::_AllocateRun(Transaction& transaction, int32 group,
+	uint16 start, uint16 length, block_run& run)
+{
+	if (fGroups[group].Allocate(transaction, start, length) != B_OK)
 		RETURN_ERROR(B_IO_ERROR);
 
-	CHECK_ALLOCATION_GROUP(bestGroup);
+	CHECK_ALLOCATION_GROUP(group);
 
-	run.allocation_group = HOST_ENDIAN_TO_BFS_INT32(bestGroup);
-	run.start = HOST_ENDIAN_TO_BFS_INT16(bestStart);
-	run.length = HOST_ENDIAN_TO_BFS_INT16(bestLength);
+	run.allocation_group = HOST_ENDIAN_TO_BFS_INT32(group);
+	run.start = HOST_ENDIAN_TO_BFS_INT16(start);
+	run.length = HOST_ENDIAN_TO_BFS_INT16(length);
 
 	fVolume->SuperBlock().used_blocks
-		= HOST_ENDIAN_TO_BFS_INT64(fVolume->UsedBlocks() + bestLength);
+		= HOST_ENDIAN_TO_BFS_INT64(fVolume->UsedBlocks() + length);
 		// We are not writing back the disk's superblock - it's
 		// either done by the journaling code, or when the disk
 		// is unmounted.
@@ -912,141 +1203,162 @@ BlockAllocator::AllocateBlocks(Transaction& transaction, int32 groupIndex,
 }
 
 
-status_t
-BlockAllocator::AllocateForInode(Transaction& transaction,
-	const block_run* parent, mode_t type, block_run& run)
+/*!	Returns the size of the next reservation window for \a inode in blocks,
+	or zero if it shouldn't reserve any blocks.
+	Only regular files use reservations; attributes, directories, and
+	symbolic links usually don't get that big. Also, if free disk space is
+	tight, nothing is reserved.
+*/
+uint32
+BlockAllocator::_ReservationWindow(Inode* inode,
+	const BlockReservation& reservation) const
 {
-	// Apply some allocation policies here (AllocateBlocks() will break them
-	// if necessary) - we will start with those described in Dominic Giampaolo's
-	// "Practical File System Design", and see how good they work
+	if (!fReservationsEnabled || !inode->IsFile() || inode->IsAttribute())
+		return 0;
 
-	// Files are going in the same allocation group as its parent,
-	// sub-directories will be inserted 8 allocation groups after
-	// the one of the parent
-	uint16 group = parent->AllocationGroup();
-	if ((type & (S_DIRECTORY | S_INDEX_DIR | S_ATTR_DIR)) == S_DIRECTORY)
-		group += 8;
+	uint32 window = kMinReservationWindow >> fVolume->BlockShift();
+	if (reservation.fWindow != 0) {
+		window = min_c(reservation.fWindow * 2,
+			kMaxReservationWindow >> fVolume->BlockShift());
+	}
+	window = min_c(window, fGroups[0].NumBits() / 4);
 
-	return AllocateBlocks(transaction, group, 0, 1, 1, run);
+	if (fVolume->FreeBlocks() < (off_t)window * 16)
+		return 0;
+
+	return window;
 }
 
 
 status_t
-BlockAllocator::Allocate(Transaction& transaction, Inode* inode,
-	off_t numBlocks, block_run& run, uint16 minimum)
+BlockAllocator::_AllocateFromReservation(Transaction& transaction,
+	BlockReservation& reservation, off_t numBlocks, uint16 minimum,
+	block_run& run)
 {
-	if (numBlocks <= 0)
-		return B_ERROR;
+	uint16 length = min_c(numBlocks, reservation.fLength);
+	if (minimum > 1)
+		length = round_down(length, minimum);
+	if (length == 0)
+		return B_DEVICE_FULL;
 
-	// one block_run can't hold more data than there is in one allocation group
-	if (numBlocks > fGroups[0].NumBits())
-		numBlocks = fGroups[0].NumBits();
+	int32 group = reservation.fGroup;
+	uint16 start = reservation.fStart;
 
-	// since block_run.length is uint16, the largest number of blocks that
-	// can be covered by a block_run is 65535
-	// TODO: if we drop compatibility, couldn't we do this any better?
-	// There are basically two possibilities:
-	// a) since a length of zero doesn't have any sense, take that for 65536 -
-	//    but that could cause many problems (bugs) in other areas
-	// b) reduce the maximum amount of blocks per block_run, so that the
-	//    remaining number of free blocks can be used in a useful manner
-	//    (like 4 blocks) - but that would also reduce the maximum file size
-	// c) have BlockRun::Length() return (length + 1).
-	if (numBlocks > MAX_BLOCK_RUN_LENGTH)
-		numBlocks = MAX_BLOCK_RUN_LENGTH;
+	reservation.fStart += length;
+	reservation.fLength -= length;
+	if (reservation.fLength == 0)
+		_Unreserve(reservation);
 
-	// Apply some allocation policies here (AllocateBlocks() will break them
-	// if necessary)
-	uint16 group = inode->BlockRun().AllocationGroup();
-	uint16 start = 0;
+	return _AllocateRun(transaction, group, start, length, run);
+}
 
-	// Are there already allocated blocks? (then just try to allocate near the
-	// last one)
-	if (inode->Size() > 0) {
-		const data_stream& data = inode->Node().data;
-		// TODO: we currently don't care for when the data stream
-		// is already grown into the indirect ranges
-		if (data.max_double_indirect_range == 0
-			&& data.max_indirect_range == 0) {
-			// Since size > 0, there must be a valid block run in this stream
-			int32 last = 0;
-			for (; last < NUM_DIRECT_BLOCKS - 1; last++)
-				if (data.direct[last + 1].IsZero())
-					break;
 
-			group = data.direct[last].AllocationGroup();
-			start = data.direct[last].Start() + data.direct[last].Length();
-		}
-	} else if (inode->IsContainer() || inode->IsSymLink()) {
-		// directory and symbolic link data will go in the same allocation
-		// group as the inode is in but after the inode data
-		start = inode->BlockRun().Start();
-	} else {
-		// file data will start in the next allocation group
-		group = inode->BlockRun().AllocationGroup() + 1;
-	}
+/*!	Reserves the given range, which must be free and not yet reserved, and
+	sets the reservation's window to \a window.
+*/
+void
+BlockAllocator::_Reserve(BlockReservation& reservation, int32 group,
+	uint16 start, uint16 length, uint32 window)
+{
+	_Unreserve(reservation);
 
-	return AllocateBlocks(transaction, group, start, numBlocks, minimum, run);
+	reservation.fGroup = group;
+	reservation.fStart = start;
+	reservation.fLength = length;
+	reservation.fWindow = window;
+
+	fReservations.Add(&reservation);
+	fGroups[group].fReservations++;
 }
 
 
-status_t
-BlockAllocator::Free(Transaction& transaction, block_run run)
+/*!	Tries to reserve the next window for \a inode directly behind \a run,
+	so that the file can continue to grow in place.
+*/
+void
+BlockAllocator::_ExtendReservation(BlockReservation& reservation,
+	Inode* inode, const block_run& run)
 {
-	RecursiveLocker lock(fLock);
+	uint32 window = _ReservationWindow(inode, reservation);
+	if (window == 0)
+		return;
 
-	int32 group = run.AllocationGroup();
-	uint16 start = run.Start();
-	uint16 length = run.Length();
+	int32 groupIndex = run.AllocationGroup();
+	AllocationGroup& group = fGroups[groupIndex];
+	uint32 start = run.Start() + run.Length();
 
-	FUNCTION_START(("group = %" B_PRId32 ", start = %" B_PRIu16
-		", length = %" B_PRIu16 "\n", group, start, length))
-	T(Free(run));
+	int32 reservedStart;
+	int32 reservedEnd;
+	_NextReservation(groupIndex, start, reservedStart, reservedEnd);
 
-	// doesn't use Volume::IsValidBlockRun() here because it can check better
-	// against the group size (the last group may have a different length)
-	if (group < 0 || group >= fNumGroups
-		|| start > fGroups[group].NumBits()
-		|| uint32(start + length) > fGroups[group].NumBits()
-		|| length == 0) {
-		FATAL(("tried to free an invalid block_run"
-			" (%" B_PRId32 ", %" B_PRIu16 ", %" B_PRIu16")\n",
-			group, start, length));
-		DEBUGGER(("tried to free invalid block_run"));
-		return B_BAD_VALUE;
-	}
-	// check if someone tries to free reserved areas at the beginning of the
-	// drive
-	if (group == 0
-		&& start < uint32(fVolume->Log().Start() + fVolume->Log().Length())) {
-		FATAL(("tried to free a reserved block_run"
-			" (%" B_PRId32 ", %" B_PRIu16 ", %" B_PRIu16")\n",
-			group, start, length));
-		DEBUGGER(("tried to free reserved block"));
-		return B_BAD_VALUE;
+	uint32 end = min_c(start + window, group.NumBits());
+	if ((uint32)reservedStart < end)
+		end = reservedStart;
+
+	AllocationBlock cached(fVolume);
+	uint32 bitsPerFullBlock = fVolume->BlockSize() << 3;
+	uint32 length = 0;
+
+	for (uint32 bit = start; bit < end; bit++) {
+		if ((bit == start || bit % bitsPerFullBlock == 0)
+			&& cached.SetTo(group, bit / bitsPerFullBlock) != B_OK)
+			break;
+		if (cached.IsUsed(bit % bitsPerFullBlock))
+			break;
+
+		length++;
 	}
-#ifdef DEBUG
-	if (CheckBlockRun(run) != B_OK)
-		return B_BAD_DATA;
-#endif
 
-	CHECK_ALLOCATION_GROUP(group);
+	if (length > 0)
+		_Reserve(reservation, groupIndex, start, length, window);
+	else
+		reservation.fWindow = window;
+}
 
-	if (fGroups[group].Free(transaction, start, length) != B_OK)
-		RETURN_ERROR(B_IO_ERROR);
 
-	CHECK_ALLOCATION_GROUP(group);
+/*!	Returns the first reservation in \a group that ends after \a bit, or
+	INT32_MAX for both \a _start and \a _end if there is none.
+*/
+void
+BlockAllocator::_NextReservation(int32 group, int32 bit, int32& _start,
+	int32& _end) const
+{
+	_start = INT32_MAX;
+	_end = INT32_MAX;
+
+	DoublyLinkedList<BlockReservation>::ConstIterator iterator
+		= fReservations.GetIterator();
+	while (const BlockReservation* reservation = iterator.Next()) {
+		int32 end = reservation->fStart + reservation->fLength;
+		if (reservation->fGroup != group || end <= bit
+			|| reservation->fStart >= _start)
+			continue;
 
-#ifdef DEBUG
-	if (CheckBlockRun(run, NULL, false) != B_OK) {
-		DEBUGGER(("CheckBlockRun() reports allocated blocks (which were just "
-			"freed)\n"));
+		_start = reservation->fStart;
+		_end = end;
 	}
-#endif
+}
 
-	fVolume->SuperBlock().used_blocks =
-		HOST_ENDIAN_TO_BFS_INT64(fVolume->UsedBlocks() - run.Length());
-	return B_OK;
+
+void
+BlockAllocator::_Unreserve(BlockReservation& reservation)
+{
+	if (reservation.fGroup < 0)
+		return;
+
+	fReservations.Remove(&reservation);
+	fGroups[reservation.fGroup].fReservations--;
+
+	reservation.fGroup = -1;
+	reservation.fLength = 0;
+}
+
+
+void
+BlockAllocator::_UnreserveAll()
+{
+	while (BlockReservation* reservation = fReservations.Head())
+		_Unreserve(*reservation);
 }
 
 
@@ -21,6 +21,34 @@ struct block_run;
 //#define DEBUG_FRAGMENTER
 
 
+/*!	An in-memory reservation of the free blocks following the data stream of
+	an inode. The blocks stay free on disk, but are not handed out to other
+	inodes, so that files that are written concurrently can still grow
+	contiguously.
+*/
+class BlockReservation : public DoublyLinkedListLinkImpl<BlockReservation> {
+public:
+							BlockReservation()
+								:
+								fGroup(-1),
+								fStart(0),
+								fLength(0),
+								fWindow(0)
+							{
+							}
+
+			bool			IsEmpty() const { return fLength == 0; }
+
+private:
+	friend class BlockAllocator;
+
+			int32			fGroup;
+			uint16			fStart;
+			uint16			fLength;
+			uint32			fWindow;
+};
+
+
 class BlockAllocator {
 public:
 							BlockAllocator(Volume* volume);
@@ -39,6 +67,10 @@ public:
 								uint16 minimum = 1);
 			status_t		Free(Transaction& transaction, block_run run);
 
+			void			ReleaseReservation(
+								BlockReservation& reservation);
+			void			SetReservationsEnabled(bool enabled);
+
 			status_t		AllocateBlocks(Transaction& transaction,
 								int32 group, uint16 start, uint16 numBlocks,
 								uint16 minimum, block_run& run);
@@ -68,6 +100,33 @@ private:
 #ifdef DEBUG_ALLOCATION_GROUPS
 			void			_CheckGroup(int32 group) const;
 #endif
+			status_t		_FindFreeRange(int32 groupIndex, uint16 start,
+								int32 maximum, uint16 minimum,
+								int32& bestGroup, int32& bestStart,
+								int32& bestLength);
+			status_t		_SearchFreeRange(int32 groupIndex, uint16 start,
+								int32 maximum, int32& bestGroup,
+								int32& bestStart, int32& bestLength);
+			status_t		_AllocateRun(Transaction& transaction,
+								int32 group, uint16 start, uint16 length,
+								block_run& run);
+
+			uint32			_ReservationWindow(Inode* inode,
+								const BlockReservation& reservation) const;
+			status_t		_AllocateFromReservation(Transaction& transaction,
+								BlockReservation& reservation,
+								off_t numBlocks, uint16 minimum,
+								block_run& run);
+			void			_Reserve(BlockReservation& reservation,
+								int32 group, uint16 start, uint16 length,
+								uint32 window);
+			void			_ExtendReservation(BlockReservation& reservation,
+								Inode* inode, const block_run& run);
+			void			_NextReservation(int32 group, int32 bit,
+								int32& _start, int32& _end) const;
+			void			_Unreserve(BlockReservation& reservation);
+			void			_UnreserveAll();
+
 			status_t		_AddTrim(fs_trim_data& trimData, uint32 maxRanges,
 								uint64 offset, uint64 size);
 			status_t		_TrimNext(fs_trim_data& trimData, uint32 maxRanges,
@@ -83,6 +142,9 @@ private:
 			int32			fNumGroups;
 			uint32			fBlocksPerGroup;
 			uint32			fNumBlocks;
+
+			DoublyLinkedList<BlockReservation> fReservations;
+			bool			fReservationsEnabled;
 };
 
 #ifdef BFS_DEBUGGER_COMMANDS
@@ -162,6 +162,47 @@ Index::KeySize()
 }
 
 
+/*!	Fills in \a statistics for the current index. This only has to look at
+	the first and last leaf nodes of the index, so it's cheap enough to be
+	called for every query.
+*/
+status_t
+Index::GetStatistics(index_statistics& statistics)
+{
+	if (fNode == NULL)
+		return B_NO_INIT;
+
+	BPlusTree* tree = fNode->Tree();
+	if (tree == NULL)
+		return B_BAD_VALUE;
+
+	status_t status = tree->EstimateValues(&statistics.entries,
+		&statistics.entries_per_node);
+	if (status != B_OK)
+		return status;
+
+	TreeIterator iterator(tree);
+	off_t value;
+
+	iterator.Goto(BPLUSTREE_BEGIN);
+	status = iterator.GetNextEntry(statistics.minimum,
+		&statistics.minimum_length, sizeof(statistics.minimum), &value);
+	if (status == B_ENTRY_NOT_FOUND) {
+		// the index is empty
+		statistics.entries = 0;
+		statistics.minimum_length = 0;
+		statistics.maximum_length = 0;
+		return B_OK;
+	}
+	if (status != B_OK)
+		return status;
+
+	iterator.Goto(BPLUSTREE_END);
+	return iterator.GetPreviousEntry(statistics.maximum,
+		&statistics.maximum_length, sizeof(statistics.maximum), &value);
+}
+
+
 status_t
 Index::Create(Transaction& transaction, const char* name, uint32 type)
 {
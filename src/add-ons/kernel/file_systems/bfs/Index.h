@@ -8,12 +8,28 @@
 
 #include "system_dependencies.h"
 
+#include "bfs.h"
+
 
 class Transaction;
 class Volume;
 class Inode;
 
 
+/*!	Statistics about an index, as used by the query planner to estimate how
+	many entries an equation will match. The number of entries is only a
+	rough estimate, the smallest and largest keys are exact.
+*/
+struct index_statistics {
+	off_t			entries;
+	uint32			entries_per_node;
+	uint16			minimum_length;
+	uint16			maximum_length;
+	uint8			minimum[MAX_INDEX_KEY_LENGTH + 1];
+	uint8			maximum[MAX_INDEX_KEY_LENGTH + 1];
+};
+
+
 class Index {
 public:
 							Index(Volume* volume);
@@ -25,6 +41,7 @@ public:
 			Inode*			Node() const { return fNode; };
 			uint32			Type();
 			size_t			KeySize();
+			status_t		GetStatistics(index_statistics& statistics);
 
 			status_t		Create(Transaction& transaction, const char* name,
 								uint32 type);
@@ -420,6 +420,8 @@ Inode::~Inode()
 {
 	PRINT(("Inode::~Inode() @ %p\n", this));
 
+	fVolume->Allocator().ReleaseReservation(fReservation);
+
 	file_cache_delete(FileCache());
 	file_map_delete(Map());
 	delete fTree;
@@ -2360,6 +2362,8 @@ Inode::Free(Transaction& transaction)
 			return status;
 	}
 
+	fVolume->Allocator().ReleaseReservation(fReservation);
+
 	// Free all attributes, and remove their indices
 	{
 		// We have to limit the scope of AttributeIterator, so that its
@@ -192,6 +192,9 @@ public:
 			void*				Map() const { return fMap; }
 			void				SetMap(void* map) { fMap = map; }
 
+			// block allocation
+			BlockReservation&	Reservation() { return fReservation; }
+
 #if _KERNEL_MODE && KDEBUG
 			void				AssertReadLocked()
 									{ ASSERT_READ_LOCKED_RW_LOCK(&fLock); }
@@ -271,6 +274,9 @@ private:
 
 			mutable recursive_lock fSmallDataLock;
 			SinglyLinkedList<AttributeIterator> fIterators;
+
+			BlockReservation	fReservation;
+				// protected by the block allocator's lock
 };
 
 
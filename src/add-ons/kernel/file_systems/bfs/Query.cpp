@@ -23,6 +23,7 @@
 #include "Debug.h"
 #include "Index.h"
 #include "Inode.h"
+#include "QueryPlan.h"
 #include "Volume.h"
 
 
@@ -70,6 +71,16 @@ union value {
 };
 
 
+// Lacking any better information, we assume that an equality matches one in
+// 32 entries of an index, and a pattern with a fixed prefix one in 8.
+static const int32 kEqualSelectivityShift = 5;
+static const int32 kPatternSelectivityShift = 3;
+
+// The position of a value within the key range of an index is computed in
+// units of 1/kKeyPositionScale.
+static const uint64 kKeyPositionScale = 1024;
+
+
 /*!	Abstract base class for the operator/equation classes.
 */
 class Term {
@@ -91,11 +102,17 @@ public:
 	virtual	void				CalculateScore(Index& index) = 0;
 	virtual	int32				Score() const = 0;
 
+	//!	The estimated number of matching index entries, or -1 if unknown.
+	virtual	off_t				Estimate() const = 0;
+	//!	The estimated number of index nodes to read, or -1 if unknown.
+	virtual	off_t				ScanCost() const = 0;
+	virtual	status_t			CollectCandidates(Volume* volume,
+									Index& index,
+									CandidateSet& candidates) = 0;
+
 	virtual	status_t			InitCheck() = 0;
 
-#ifdef DEBUG
 	virtual	void				PrintToStream() = 0;
-#endif
 
 protected:
 			int8				fOp;
@@ -132,14 +149,19 @@ public:
 									bool queryNonIndexed);
 			status_t			GetNextMatching(Volume* volume,
 									TreeIterator* iterator,
+									const CandidateSet* candidates,
 									struct dirent* dirent, size_t bufferSize);
 
 	virtual	void				CalculateScore(Index &index);
 	virtual	int32				Score() const { return fScore; }
 
-#ifdef DEBUG
+	virtual	off_t				Estimate() const { return fEstimate; }
+	virtual	off_t				ScanCost() const { return fScanCost; }
+	virtual	status_t			CollectCandidates(Volume* volume,
+									Index& index,
+									CandidateSet& candidates);
+
 	virtual	void				PrintToStream();
-#endif
 
 private:
 								Equation(const Equation& other);
@@ -153,6 +175,12 @@ private:
 			status_t			_ConvertValue(type_code type);
 			bool				_CompareTo(const uint8* value, uint16 size);
 			uint8*				_Value() const { return (uint8*)&fValue; }
+			status_t			_GetNextIndexEntry(TreeIterator* iterator,
+									off_t* _offset);
+			void				_EstimateMatching(Index& index);
+			bool				_KeyPosition(
+									const index_statistics& statistics,
+									uint64* _position);
 
 private:
 			char*				fAttribute;
@@ -165,6 +193,8 @@ private:
 
 			int32				fScore;
 			bool				fHasIndex;
+			off_t				fEstimate;
+			off_t				fScanCost;
 };
 
 
@@ -188,11 +218,15 @@ public:
 	virtual	void				CalculateScore(Index& index);
 	virtual	int32				Score() const;
 
+	virtual	off_t				Estimate() const;
+	virtual	off_t				ScanCost() const;
+	virtual	status_t			CollectCandidates(Volume* volume,
+									Index& index,
+									CandidateSet& candidates);
+
 	virtual	status_t			InitCheck();
 
-#ifdef DEBUG
 	virtual	void				PrintToStream();
-#endif
 
 private:
 								Operator(const Operator& other);
@@ -205,6 +239,13 @@ private:
 };
 
 
+//!	A term that still has to be planned, as used by Query::Rewind().
+struct plan_entry {
+	Term*			term;
+	CandidateSet*	candidates;
+};
+
+
 //	#pragma mark -
 
 
@@ -214,7 +255,9 @@ Equation::Equation(char** _expression)
 	fAttribute(NULL),
 	fString(NULL),
 	fType(0),
-	fIsPattern(false)
+	fIsPattern(false),
+	fEstimate(-1),
+	fScanCost(-1)
 {
 	char* string = *_expression;
 	char* start = string;
@@ -576,18 +619,20 @@ Equation::PrepareQuery(Volume* /*volume*/, Index& index,
 }
 
 
+/*!	Returns the next entry from the index that matches the equation. If this
+	isn't the index of the equation (ie. fHasIndex is \c false), all entries
+	are returned.
+*/
 status_t
-Equation::GetNextMatching(Volume* volume, TreeIterator* iterator,
-	struct dirent* dirent, size_t bufferSize)
+Equation::_GetNextIndexEntry(TreeIterator* iterator, off_t* _offset)
 {
 	while (true) {
 		union value indexValue;
 		uint16 keyLength;
 		uint16 duplicate;
-		off_t offset;
 
 		status_t status = iterator->GetNextEntry(&indexValue, &keyLength,
-			(uint16)sizeof(indexValue), &offset, &duplicate);
+			(uint16)sizeof(indexValue), _offset, &duplicate);
 		if (status != B_OK)
 			return status;
 
@@ -609,6 +654,28 @@ Equation::GetNextMatching(Volume* volume, TreeIterator* iterator,
 			continue;
 		}
 
+		return B_OK;
+	}
+}
+
+
+/*!	Returns the next entry from \a iterator that matches the whole query.
+	If \a candidates is given, only entries contained in it are considered;
+	all others are skipped without loading their inodes.
+*/
+status_t
+Equation::GetNextMatching(Volume* volume, TreeIterator* iterator,
+	const CandidateSet* candidates, struct dirent* dirent, size_t bufferSize)
+{
+	while (true) {
+		off_t offset;
+		status_t status = _GetNextIndexEntry(iterator, &offset);
+		if (status != B_OK)
+			return status;
+
+		if (candidates != NULL && !candidates->Contains(offset))
+			continue;
+
 		Vnode vnode(volume, offset);
 		Inode* inode;
 		if ((status = vnode.Get(&inode)) != B_OK) {
@@ -693,6 +760,8 @@ Equation::CalculateScore(Index &index)
 	// do we have to operate on a "foreign" index?
 	if (fOp == OP_UNEQUAL || index.SetTo(fAttribute) < B_OK) {
 		fScore = 0;
+		fEstimate = -1;
+		fScanCost = -1;
 		return;
 	}
 
@@ -715,6 +784,43 @@ Equation::CalculateScore(Index &index)
 	// 2048 * 2048 == 4194304 is the maximum score (for an empty
 	// tree, since the header + 1 node are already 2048 bytes)
 	fScore = fScore * ((2048 * 1024LL) / index.Node()->Size());
+
+	_EstimateMatching(index);
+}
+
+
+/*!	Collects the IDs of all inodes whose index entries match the equation.
+	Fails if the equation has no index, or if it matches more than
+	kMaxCandidates entries.
+*/
+status_t
+Equation::CollectCandidates(Volume* volume, Index& index,
+	CandidateSet& candidates)
+{
+	if (fEstimate < 0)
+		return B_ENTRY_NOT_FOUND;
+
+	TreeIterator* iterator = NULL;
+	status_t status = PrepareQuery(volume, index, &iterator, false);
+	ObjectDeleter<TreeIterator> iteratorDeleter(iterator);
+	if (iterator == NULL)
+		return status != B_OK ? status : B_ERROR;
+	if (!fHasIndex)
+		return B_ENTRY_NOT_FOUND;
+
+	if (status == B_OK) {
+		off_t offset;
+		while ((status = _GetNextIndexEntry(iterator, &offset)) == B_OK) {
+			status = candidates.Add(offset);
+			if (status != B_OK)
+				return status;
+		}
+	}
+	if (status != B_ENTRY_NOT_FOUND)
+		return status;
+
+	candidates.Sort();
+	return B_OK;
 }
 
 
@@ -845,6 +951,125 @@ Equation::_ConvertValue(type_code type)
 }
 
 
+/*!	Estimates how many entries of \a index match the equation, and how
+	many index nodes would have to be read to find them.
+*/
+void
+Equation::_EstimateMatching(Index& index)
+{
+	fEstimate = -1;
+	fScanCost = -1;
+
+	index_statistics statistics;
+	if (index.GetStatistics(statistics) != B_OK
+		|| _ConvertValue(index.Type()) != B_OK)
+		return;
+
+	off_t entries = statistics.entries;
+	uint64 position;
+
+	if (entries == 0) {
+		// nothing to find in an empty index
+	} else if (fIsPattern) {
+		if (getFirstPatternSymbol(fString) > 0)
+			entries >>= kPatternSelectivityShift;
+	} else if (!_KeyPosition(statistics, &position)) {
+		// we don't know the key distribution of this type
+		if (fOp == OP_EQUAL)
+			entries >>= kEqualSelectivityShift;
+		else
+			entries /= 3;
+	} else if (fOp == OP_EQUAL) {
+		if (position == 0 || position > kKeyPositionScale) {
+			// the value is outside of the key range
+			entries = 0;
+		} else
+			entries >>= kEqualSelectivityShift;
+	} else if (fOp == OP_LESS_THAN || fOp == OP_LESS_THAN_OR_EQUAL) {
+		entries = entries * min_c(position, kKeyPositionScale)
+			/ kKeyPositionScale;
+	} else {
+		entries = entries * (kKeyPositionScale
+			- min_c(position, kKeyPositionScale)) / kKeyPositionScale;
+	}
+
+	if (entries == 0 && statistics.entries != 0 && fOp != OP_EQUAL)
+		entries = 1;
+
+	fEstimate = entries;
+	fScanCost = entries / statistics.entries_per_node + 1;
+}
+
+
+/*!	Computes the position of the equation's value within the key range of
+	the index as a fraction of kKeyPositionScale, plus one; 0 means that the
+	value is smaller than the smallest key, and more than kKeyPositionScale
+	that it is larger than the largest key.
+	Only works for integer types, and returns \c false for all others.
+*/
+bool
+Equation::_KeyPosition(const index_statistics& statistics, uint64* _position)
+{
+	union value minimum;
+	union value maximum;
+	memcpy(&minimum, statistics.minimum, sizeof(int64));
+	memcpy(&maximum, statistics.maximum, sizeof(int64));
+
+	uint64 value;
+	uint64 first;
+	uint64 last;
+	switch (fType) {
+		case B_INT32_TYPE:
+			value = (uint64)(int64)fValue.Int32 ^ (1ULL << 63);
+			first = (uint64)(int64)minimum.Int32 ^ (1ULL << 63);
+			last = (uint64)(int64)maximum.Int32 ^ (1ULL << 63);
+			break;
+		case B_UINT32_TYPE:
+			value = fValue.Uint32;
+			first = minimum.Uint32;
+			last = maximum.Uint32;
+			break;
+		case B_INT64_TYPE:
+			if (fIsSpecialTime) {
+				// the index contains shifted values
+				minimum.Int64 >>= INODE_TIME_SHIFT;
+				maximum.Int64 >>= INODE_TIME_SHIFT;
+			}
+			value = (uint64)fValue.Int64 ^ (1ULL << 63);
+			first = (uint64)minimum.Int64 ^ (1ULL << 63);
+			last = (uint64)maximum.Int64 ^ (1ULL << 63);
+			break;
+		case B_UINT64_TYPE:
+			value = fValue.Uint64;
+			first = minimum.Uint64;
+			last = maximum.Uint64;
+			break;
+		default:
+			return false;
+	}
+
+	if (value < first) {
+		*_position = 0;
+		return true;
+	}
+	if (value > last) {
+		*_position = kKeyPositionScale + 1;
+		return true;
+	}
+
+	uint64 range = last - first;
+	uint64 offset = value - first;
+	while (range >= (1ULL << 52)) {
+		range >>= 1;
+		offset >>= 1;
+	}
+
+	*_position = range == 0 ? kKeyPositionScale
+		: min_c(offset * kKeyPositionScale / range, kKeyPositionScale - 1) + 1;
+	return true;
+}
+
+
 /*!	Returns true when the key matches the equation. You have to
 	call ConvertValue() before this one.
 */
@@ -982,6 +1207,74 @@ Operator::Score() const
 }
 
 
+off_t
+Operator::Estimate() const
+{
+	off_t left = fLeft->Estimate();
+	off_t right = fRight->Estimate();
+
+	if (fOp == OP_AND) {
+		// the better one is an upper bound for the whole term
+		if (left < 0 || (right >= 0 && right < left))
+			return right;
+		return left;
+	}
+
+	if (left < 0 || right < 0)
+		return -1;
+	return left + right;
+}
+
+
+off_t
+Operator::ScanCost() const
+{
+	off_t left = fLeft->ScanCost();
+	off_t right = fRight->ScanCost();
+
+	if (fOp == OP_AND) {
+		if (left < 0 || (right >= 0 && right < left))
+			return right;
+		return left;
+	}
+
+	if (left < 0 || right < 0)
+		return -1;
+	return left + right;
+}
+
+
+/*!	For OP_OR, both terms need to have an index, and the candidates are the
+	union of both of them. For OP_AND, the candidates are the ones of the
+	cheaper term; they are a superset of the matching entries, which is all
+	that is needed to filter the query.
+*/
+status_t
+Operator::CollectCandidates(Volume* volume, Index& index,
+	CandidateSet& candidates)
+{
+	if (fOp == OP_AND) {
+		Term* term = fLeft;
+		if (fLeft->ScanCost() < 0 || (fRight->ScanCost() >= 0
+				&& fRight->ScanCost() < fLeft->ScanCost()))
+			term = fRight;
+
+		return term->CollectCandidates(volume, index, candidates);
+	}
+
+	status_t status = fLeft->CollectCandidates(volume, index, candidates);
+	if (status != B_OK)
+		return status;
+
+	CandidateSet right;
+	status = fRight->CollectCandidates(volume, index, right);
+	if (status != B_OK)
+		return status;
+
+	return candidates.Unite(right);
+}
+
+
 status_t
 Operator::InitCheck()
 {
@@ -1033,7 +1326,6 @@ Operator::Copy() const
 
 //	#pragma mark -
 
-#ifdef DEBUG
 
 void
 Operator::PrintToStream()
@@ -1072,7 +1364,6 @@ Equation::PrintToStream()
 	__out("[\"%s\" %s \"%s\"]", fAttribute, symbol, fString);
 }
 
-#endif	// DEBUG
 
 //	#pragma mark -
 
@@ -1233,6 +1524,7 @@ Query::Query(Volume* volume, Expression* expression, uint32 flags)
 	fVolume(volume),
 	fExpression(expression),
 	fCurrent(NULL),
+	fCandidates(NULL),
 	fIterator(NULL),
 	fIndex(volume),
 	fFlags(flags),
@@ -1259,6 +1551,8 @@ Query::~Query()
 {
 	if ((fFlags & B_LIVE_QUERY) != 0)
 		fVolume->RemoveQuery(this);
+
+	_DeleteCandidateSets();
 }
 
 
@@ -1268,35 +1562,67 @@ Query::Rewind()
 	// free previous stuff
 
 	fStack.MakeEmpty();
+	_DeleteCandidateSets();
 
 	delete fIterator;
 	fIterator = NULL;
 	fCurrent = NULL;
+	fCandidates = NULL;
+
+	if ((fFlags & B_QUERY_EXPLAIN) != 0) {
+		INFORM(("query plan for "));
+		fExpression->Root()->PrintToStream();
+		__out("\n");
+	}
 
 	// put the whole expression on the stack
 
-	Stack<Term*> stack;
-	stack.Push(fExpression->Root());
+	Stack<plan_entry> stack;
+	plan_entry entry = { fExpression->Root(), NULL };
+	stack.Push(entry);
 
-	Term* term;
-	while (stack.Pop(&term)) {
+	while (stack.Pop(&entry)) {
+		Term* term = entry.term;
 		if (term->Op() < OP_EQUATION) {
 			Operator* op = (Operator*)term;
 
 			if (op->Op() == OP_OR) {
-				stack.Push(op->Left());
-				stack.Push(op->Right());
+				plan_entry left = { op->Left(), entry.candidates };
+				plan_entry right = { op->Right(), entry.candidates };
+				stack.Push(left);
+				stack.Push(right);
 			} else {
-				// For OP_AND, we can use the scoring system to decide which
-				// path to add
-				if (op->Right()->Score() > op->Left()->Score())
-					stack.Push(op->Right());
-				else
-					stack.Push(op->Left());
+				// For OP_AND, the query planner decides which path to add,
+				// and which other indices to use to filter it
+				_PlanAnd(op, entry.term, entry.candidates);
+				stack.Push(entry);
 			}
-		} else if (term->Op() == OP_EQUATION
-			|| fStack.Push((Equation*)term) != B_OK)
-			FATAL(("Unknown term on stack or stack error"));
+		} else {
+			step step = { (Equation*)term, entry.candidates };
+			if (term->Op() == OP_EQUATION || fStack.Push(step) != B_OK)
+				FATAL(("Unknown term on stack or stack error"));
+		}
+	}
+
+	fIndex.Unset();
+
+	if ((fFlags & B_QUERY_EXPLAIN) != 0) {
+		// the steps are taken from the top of the stack
+		for (int32 i = fStack.CountItems(); i-- > 0;) {
+			const step& step = fStack.Array()[i];
+
+			INFORM(("  scan "));
+			step.equation->PrintToStream();
+			if (step.equation->Estimate() >= 0)
+				__out(", ~%" B_PRIdOFF " entries", step.equation->Estimate());
+			else
+				__out(", not indexed");
+			if (step.candidates != NULL) {
+				__out(", %" B_PRId32 " candidates",
+					step.candidates->Count());
+			}
+			__out("\n");
+		}
 	}
 
 	return B_OK;
@@ -1310,10 +1636,18 @@ Query::GetNextEntry(struct dirent* dirent, size_t size)
 	// from the stack
 	while (true) {
 		if (fIterator == NULL) {
-			if (!fStack.Pop(&fCurrent)
-				|| fCurrent == NULL)
+			step step;
+			if (!fStack.Pop(&step) || step.equation == NULL)
 				return B_ENTRY_NOT_FOUND;
 
+			fCurrent = step.equation;
+			fCandidates = step.candidates;
+
+			if (fCandidates != NULL && fCandidates->Count() == 0) {
+				// the other indices already ruled out all entries
+				continue;
+			}
+
 			status_t status = fCurrent->PrepareQuery(fVolume, fIndex,
 				&fIterator, fFlags & B_QUERY_NON_INDEXED);
 			if (status == B_ENTRY_NOT_FOUND) {
@@ -1327,12 +1661,13 @@ Query::GetNextEntry(struct dirent* dirent, size_t size)
 		if (fCurrent == NULL)
 			RETURN_ERROR(B_ERROR);
 
-		status_t status = fCurrent->GetNextMatching(fVolume, fIterator, dirent,
-			size);
+		status_t status = fCurrent->GetNextMatching(fVolume, fIterator,
+			fCandidates, dirent, size);
 		if (status != B_OK) {
 			delete fIterator;
 			fIterator = NULL;
 			fCurrent = NULL;
+			fCandidates = NULL;
 		} else {
 			// only return if we have another entry
 			return B_OK;
@@ -1445,3 +1780,127 @@ Query::LiveUpdateRenameMove(Inode* inode, ino_t oldDirectoryID,
 	notify_query_entry_created(fPort, fToken, fVolume->ID(),
 		newDirectoryID, newName, inode->ID());
 }
+
+
+/*!	Decides how to evaluate the OP_AND \a term, and all OP_AND operators
+	directly below it.
+	The term with the fewest estimated matches is chosen to drive the query,
+	and returned in \a _driver. Then, the entries of the other indices are
+	intersected with each other, cheapest first, as long as reading them is
+	cheaper than loading the inodes they are likely to rule out. Only the
+	entries of the driving index that are part of the resulting candidate
+	set have to be loaded and matched against the rest of the query.
+	\a _candidates contains the candidates of the enclosing terms, if any,
+	and is updated with the new ones.
+*/
+void
+Query::_PlanAnd(Operator* term, Term*& _driver, CandidateSet*& _candidates)
+{
+	Stack<Term*> stack;
+	Stack<Term*> terms;
+	stack.Push(term);
+
+	Term* current;
+	while (stack.Pop(&current)) {
+		if (current->Op() == OP_AND) {
+			stack.Push(((Operator*)current)->Left());
+			stack.Push(((Operator*)current)->Right());
+		} else
+			terms.Push(current);
+	}
+
+	Term** array = terms.Array();
+	int32 count = terms.CountItems();
+
+	int32 driverIndex = find_driving_term(array, count);
+	if (driverIndex < 0) {
+		// We don't know anything about the indices, so we can only use the
+		// scoring system to decide which path to add
+		if (term->Right()->Score() > term->Left()->Score())
+			_driver = term->Right();
+		else
+			_driver = term->Left();
+		return;
+	}
+
+	_driver = array[driverIndex];
+	array[driverIndex] = NULL;
+
+	off_t expected = _driver->Estimate();
+	if (_candidates != NULL && _candidates->Count() < expected)
+		expected = _candidates->Count();
+
+	bool explain = (fFlags & B_QUERY_EXPLAIN) != 0;
+	CandidateSet* candidates = NULL;
+
+	while (expected > 0) {
+		int32 next = find_cheapest_filter(array, count);
+		if (next < 0)
+			break;
+
+		Term* filter = array[next];
+		array[next] = NULL;
+
+		if (filter->ScanCost() >= expected) {
+			if (explain) {
+				INFORM(("  don't intersect "));
+				filter->PrintToStream();
+				__out(", %" B_PRIdOFF " nodes to read for %" B_PRIdOFF
+					" candidates\n", filter->ScanCost(), expected);
+			}
+			break;
+		}
+
+		CandidateSet* set = new(std::nothrow) CandidateSet;
+		if (set == NULL)
+			break;
+
+		status_t status = filter->CollectCandidates(fVolume, fIndex, *set);
+		if (status != B_OK) {
+			if (explain) {
+				INFORM(("  can't intersect "));
+				filter->PrintToStream();
+				__out(": %s\n", strerror(status));
+			}
+			delete set;
+			continue;
+		}
+
+		if (candidates != NULL) {
+			candidates->Intersect(*set);
+			delete set;
+		} else {
+			candidates = set;
+			if (_candidates != NULL)
+				candidates->Intersect(*_candidates);
+		}
+
+		if (explain) {
+			INFORM(("  intersect "));
+			filter->PrintToStream();
+			__out(", %" B_PRId32 " candidates left\n", candidates->Count());
+		}
+
+		if (candidates->Count() < expected)
+			expected = candidates->Count();
+	}
+
+	if (candidates == NULL)
+		return;
+
+	if (fCandidateSets.Push(candidates) != B_OK) {
+		delete candidates;
+		return;
+	}
+
+	_candidates = candidates;
+}
+
+
+void
+Query::_DeleteCandidateSets()
+{
+	CandidateSet* candidates;
+	while (fCandidateSets.Pop(&candidates))
+		delete candidates;
+}
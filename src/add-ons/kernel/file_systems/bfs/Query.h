@@ -13,6 +13,8 @@
 class Volume;
 class Term;
 class Equation;
+class Operator;
+class CandidateSet;
 class TreeIterator;
 class Query;
 
@@ -63,13 +65,25 @@ public:
 
 			Expression*		GetExpression() const { return fExpression; }
 
+private:
+			struct step {
+				Equation*		equation;
+				CandidateSet*	candidates;
+			};
+
+			void			_PlanAnd(Operator* term, Term*& _driver,
+								CandidateSet*& _candidates);
+			void			_DeleteCandidateSets();
+
 private:
 			Volume*			fVolume;
 			Expression*		fExpression;
 			Equation*		fCurrent;
+			CandidateSet*	fCandidates;
 			TreeIterator*	fIterator;
 			Index			fIndex;
-			Stack<Equation*> fStack;
+			Stack<step>		fStack;
+			Stack<CandidateSet*> fCandidateSets;
 
 			uint32			fFlags;
 			port_id			fPort;
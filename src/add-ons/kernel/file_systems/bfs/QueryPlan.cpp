@@ -0,0 +1,168 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * This file may be used under the terms of the MIT License.
+ */
+
+
+#include "QueryPlan.h"
+
+
+CandidateSet::CandidateSet()
+	:
+	fIDs(NULL),
+	fCount(0),
+	fSize(0)
+{
+}
+
+
+CandidateSet::~CandidateSet()
+{
+	free(fIDs);
+}
+
+
+/*!	Adds \a id to the set. You have to call Sort() after having added all
+	IDs before the set can be used.
+	Returns \c B_BUFFER_OVERFLOW if the set would grow beyond kMaxCandidates
+	entries.
+*/
+status_t
+CandidateSet::Add(off_t id)
+{
+	if (fCount == fSize) {
+		if (fSize >= kMaxCandidates)
+			return B_BUFFER_OVERFLOW;
+
+		int32 size = fSize == 0 ? 256 : min_c(fSize * 2, kMaxCandidates);
+		off_t* ids = (off_t*)realloc(fIDs, size * sizeof(off_t));
+		if (ids == NULL)
+			return B_NO_MEMORY;
+
+		fIDs = ids;
+		fSize = size;
+	}
+
+	fIDs[fCount++] = id;
+	return B_OK;
+}
+
+
+//!	Sorts the set, and removes duplicate IDs from it.
+void
+CandidateSet::Sort()
+{
+	if (fCount < 2)
+		return;
+
+	qsort(fIDs, fCount, sizeof(off_t), &_Compare);
+
+	int32 count = 1;
+	for (int32 i = 1; i < fCount; i++) {
+		if (fIDs[i] != fIDs[count - 1])
+			fIDs[count++] = fIDs[i];
+	}
+	fCount = count;
+}
+
+
+void
+CandidateSet::Intersect(const CandidateSet& other)
+{
+	int32 count = 0;
+	int32 otherIndex = 0;
+
+	for (int32 i = 0; i < fCount && otherIndex < other.fCount; i++) {
+		while (otherIndex < other.fCount && other.fIDs[otherIndex] < fIDs[i])
+			otherIndex++;
+
+		if (otherIndex < other.fCount && other.fIDs[otherIndex] == fIDs[i])
+			fIDs[count++] = fIDs[i];
+	}
+
+	fCount = count;
+}
+
+
+/*!	Adds all IDs of \a other to the set. Both sets must be sorted.
+	Returns \c B_BUFFER_OVERFLOW, and leaves the set unchanged, if the union
+	has more than kMaxCandidates entries.
+*/
+status_t
+CandidateSet::Unite(const CandidateSet& other)
+{
+	if (other.fCount == 0)
+		return B_OK;
+
+	// count the IDs of the union first
+	int32 count = 0;
+	for (int32 i = 0, otherIndex = 0;
+			i < fCount || otherIndex < other.fCount; count++) {
+		if (otherIndex == other.fCount
+			|| (i < fCount && fIDs[i] < other.fIDs[otherIndex])) {
+			i++;
+		} else {
+			if (i < fCount && fIDs[i] == other.fIDs[otherIndex])
+				i++;
+			otherIndex++;
+		}
+	}
+
+	if (count > kMaxCandidates)
+		return B_BUFFER_OVERFLOW;
+
+	off_t* ids = (off_t*)malloc(count * sizeof(off_t));
+	if (ids == NULL)
+		return B_NO_MEMORY;
+
+	// merge both sets
+	for (int32 i = 0, otherIndex = 0, index = 0; index < count; index++) {
+		if (otherIndex == other.fCount
+			|| (i < fCount && fIDs[i] < other.fIDs[otherIndex])) {
+			ids[index] = fIDs[i++];
+		} else {
+			if (i < fCount && fIDs[i] == other.fIDs[otherIndex])
+				i++;
+			ids[index] = other.fIDs[otherIndex++];
+		}
+	}
+
+	free(fIDs);
+	fIDs = ids;
+	fCount = count;
+	fSize = count;
+	return B_OK;
+}
+
+
+bool
+CandidateSet::Contains(off_t id) const
+{
+	int32 first = 0;
+	int32 last = fCount - 1;
+
+	while (first <= last) {
+		int32 middle = (first + last) / 2;
+		if (fIDs[middle] == id)
+			return true;
+
+		if (fIDs[middle] < id)
+			first = middle + 1;
+		else
+			last = middle - 1;
+	}
+
+	return false;
+}
+
+
+/*static*/ int
+CandidateSet::_Compare(const void* _a, const void* _b)
+{
+	off_t a = *(const off_t*)_a;
+	off_t b = *(const off_t*)_b;
+
+	if (a < b)
+		return -1;
+	return a > b ? 1 : 0;
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * This file may be used under the terms of the MIT License.
+ */
+#ifndef QUERY_PLAN_H
+#define QUERY_PLAN_H
+
+
+#include "system_dependencies.h"
+
+
+// The query planner only intersects indices as long as they don't match more
+// than this number of entries; the IDs of all matching entries have to be
+// kept in memory.
+static const int32 kMaxCandidates = 16384;
+
+
+/*!	A sorted set of inode IDs collected from one or more indices. It is used
+	to skip all entries of an index that cannot match the rest of a query
+	without having to load their inodes.
+*/
+class CandidateSet {
+public:
+								CandidateSet();
+								~CandidateSet();
+
+			status_t			Add(off_t id);
+			void				Sort();
+
+			void				Intersect(const CandidateSet& other);
+			status_t			Unite(const CandidateSet& other);
+
+			bool				Contains(off_t id) const;
+			int32				Count() const { return fCount; }
+
+private:
+								CandidateSet(const CandidateSet& other);
+								CandidateSet& operator=(
+									const CandidateSet& other);
+									// no implementation
+
+	static	int					_Compare(const void* _a, const void* _b);
+
+private:
+			off_t*				fIDs;
+			int32				fCount;
+			int32				fSize;
+};
+
+
+/*!	Returns the index of the term that drives a chain of && terms: the one
+	with the fewest estimated matches. Terms without an index (a negative
+	Estimate()) cannot drive the query. Returns -1 if none of them has one.
+*/
+template<typename TermType>
+int32
+find_driving_term(TermType* const* terms, int32 count)
+{
+	int32 driverIndex = -1;
+	for (int32 i = 0; i < count; i++) {
+		if (terms[i] == NULL)
+			continue;
+
+		off_t estimate = terms[i]->Estimate();
+		if (estimate >= 0 && (driverIndex < 0
+				|| estimate < terms[driverIndex]->Estimate()))
+			driverIndex = i;
+	}
+
+	return driverIndex;
+}
+
+
+/*!	Returns the index of the term whose candidates are the cheapest to
+	collect, ignoring \c NULL entries, and terms without an index (a negative
+	ScanCost()). Returns -1 if there is no such term.
+	Its candidates are only worth collecting if that is cheaper than loading
+	the inodes they could rule out.
+*/
+template<typename TermType>
+int32
+find_cheapest_filter(TermType* const* terms, int32 count)
+{
+	int32 next = -1;
+	for (int32 i = 0; i < count; i++) {
+		if (terms[i] == NULL || terms[i]->ScanCost() < 0)
+			continue;
+		if (next < 0 || terms[i]->ScanCost() < terms[next]->ScanCost())
+			next = i;
+	}
+
+	return next;
+}
+
+
+#endif	// QUERY_PLAN_H
@@ -103,5 +103,13 @@ struct check_control {
  */
 #define BFS_IOCTL_RESIZE		14205
 
+/* Enables (non-zero), or disables (zero) the reservation of contiguous
+ * blocks for files that are being written, and lets one count the number
+ * of extents a file consists of. These are primarily meant for testing,
+ * too; the parameter is a uint32 in both cases.
+ */
+#define BFS_IOCTL_ALLOCATION_RESERVATIONS	14206
+#define BFS_IOCTL_COUNT_EXTENTS				14207
+
 
 #endif	/* BFS_CONTROL_H */
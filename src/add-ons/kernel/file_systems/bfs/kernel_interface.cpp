@@ -782,6 +782,52 @@ bfs_ioctl(fs_volume* _volume, fs_vnode* _node, void* _cookie, uint32 cmd,
 			return resizer.Resize(size, -1);
 		}
 
+		case BFS_IOCTL_ALLOCATION_RESERVATIONS:
+		{
+			if (bufferLength != sizeof(uint32))
+				return B_BAD_VALUE;
+
+			uint32 enabled;
+			if (user_memcpy(&enabled, buffer, sizeof(uint32)) != B_OK)
+				return B_BAD_ADDRESS;
+
+			volume->Allocator().SetReservationsEnabled(enabled != 0);
+			return B_OK;
+		}
+
+		case BFS_IOCTL_COUNT_EXTENTS:
+		{
+			if (bufferLength != sizeof(uint32))
+				return B_BAD_VALUE;
+
+			Inode* inode = (Inode*)_node->private_node;
+			if (inode->IsSymLink() && (inode->Flags() & INODE_LONG_SYMLINK) == 0)
+				return B_BAD_VALUE;
+
+			InodeReadLocker locker(inode);
+
+			// count the physically contiguous ranges of the data stream
+			uint32 extents = 0;
+			off_t nextBlock = -1;
+			off_t pos = 0;
+			while (pos < inode->Size()) {
+				block_run run;
+				off_t offset;
+				status_t status = inode->FindBlockRun(pos, run, offset);
+				if (status != B_OK)
+					return status;
+
+				if (volume->ToBlock(run) != nextBlock)
+					extents++;
+
+				nextBlock = volume->ToBlock(run) + run.Length();
+				pos = offset + ((off_t)run.Length() << volume->BlockShift());
+			}
+
+			locker.Unlock();
+			return user_memcpy(buffer, &extents, sizeof(uint32));
+		}
+
 #ifdef DEBUG_FRAGMENTER
 		case 56741:
 		{
@@ -1552,6 +1598,10 @@ bfs_free_cookie(fs_volume* _volume, fs_vnode* _node, void* _cookie)
 	if (status == B_OK)
 		transaction.Done();
 
+	// give the blocks we have reserved for this file back to the others
+	if ((cookie->open_mode & O_RWMASK) != 0)
+		volume->Allocator().ReleaseReservation(inode->Reservation());
+
 	if ((cookie->open_mode & BFS_OPEN_MODE_CHECKING) != 0) {
 		// "chkbfs" exited abnormally, so we have to stop it here...
 		FATAL(("check process was aborted!\n"));
@@ -21,6 +21,7 @@
 #include "AttributeDirectoryCookie.h"
 #include "DebugSupport.h"
 #include "Directory.h"
+#include "HeapChunkCache.h"
 #include "Query.h"
 #include "PackageFSRoot.h"
 #include "StringConstants.h"
@@ -1084,12 +1085,23 @@ packagefs_std_ops(int32 op, ...)
 				return error;
 			}
 
+			error = HeapChunkCache::GlobalInit();
+			if (error != B_OK) {
+				ERROR("Failed to init HeapChunkCache\n");
+				PackageFSRoot::GlobalUninit();
+				StringConstants::Cleanup();
+				StringPool::Cleanup();
+				exit_debugging();
+				return error;
+			}
+
 			return B_OK;
 		}
 
 		case B_MODULE_UNINIT:
 		{
 			PRINT("package_std_ops(): B_MODULE_UNINIT\n");
+			HeapChunkCache::GlobalUninit();
 			PackageFSRoot::GlobalUninit();
 			StringConstants::Cleanup();
 			StringPool::Cleanup();
@@ -0,0 +1,319 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "HeapChunkCache.h"
+
+#include <algorithm>
+#include <new>
+
+#include <debug.h>
+#include <heap.h>
+#include <low_resource_manager.h>
+#include <util/AutoLock.h>
+#include <vm/vm_page.h>
+
+#include "DebugSupport.h"
+
+
+static const size_t kMinCacheSize = 1024 * 1024;
+static const size_t kMaxCacheSize = 32 * 1024 * 1024;
+static const size_t kMinChunkTableSize = 128;
+
+static const uint32 kLowResources
+	= B_KERNEL_RESOURCE_PAGES | B_KERNEL_RESOURCE_MEMORY;
+
+
+struct HeapChunkCache::ChunkHashDefinition {
+	struct KeyType {
+		const HeapChunkCache*	owner;
+		size_t					index;
+	};
+	typedef Chunk				ValueType;
+
+	size_t HashKey(const KeyType& key) const
+	{
+		return ((addr_t)key.owner >> 4) ^ (key.index * 0x9e3779b9);
+	}
+
+	size_t Hash(const Chunk* value) const
+	{
+		KeyType key = { value->owner, value->index };
+		return HashKey(key);
+	}
+
+	bool Compare(const KeyType& key, const Chunk* value) const
+	{
+		return value->owner == key.owner && value->index == key.index;
+	}
+
+	Chunk*& GetLink(Chunk* value) const
+	{
+		return value->hashNext;
+	}
+};
+
+
+mutex HeapChunkCache::sLock = MUTEX_INITIALIZER("packagefs heap chunk cache");
+HeapChunkCache::ChunkTable* HeapChunkCache::sChunks;
+HeapChunkCache::LRUChunkList HeapChunkCache::sLRUChunks;
+HeapChunkCache::CacheList HeapChunkCache::sCaches;
+size_t HeapChunkCache::sSize;
+size_t HeapChunkCache::sMaxSize;
+
+uint64 HeapChunkCache::sHits;
+uint64 HeapChunkCache::sMisses;
+uint64 HeapChunkCache::sEvictions;
+bigtime_t HeapChunkCache::sReadTime;
+
+
+// #pragma mark - HeapChunkCache
+
+
+HeapChunkCache::HeapChunkCache()
+	:
+	fName(),
+	fChunks(),
+	fSize(0),
+	fHits(0),
+	fMisses(0),
+	fReadTime(0)
+{
+	MutexLocker locker(sLock);
+	sCaches.Add(this);
+}
+
+
+HeapChunkCache::~HeapChunkCache()
+{
+	MutexLocker locker(sLock);
+
+	while (Chunk* chunk = fChunks.Head())
+		_RemoveChunk(chunk);
+
+	sCaches.Remove(this);
+}
+
+
+void
+HeapChunkCache::Init(const String& name)
+{
+	fName = name;
+}
+
+
+bool
+HeapChunkCache::GetChunk(size_t chunkIndex, void* buffer, size_t size)
+{
+	MutexLocker locker(sLock);
+
+	ChunkHashDefinition::KeyType key = { this, chunkIndex };
+	Chunk* chunk = sChunks->Lookup(key);
+	if (chunk == NULL || chunk->size != size) {
+		fMisses++;
+		sMisses++;
+		return false;
+	}
+
+	// Copying while holding the lock keeps the chunk from being evicted
+	// meanwhile. A chunk is small enough for that to be OK.
+	memcpy(buffer, chunk->Data(), size);
+
+	// move the chunk to the end of the LRU lists
+	sLRUChunks.Remove(chunk);
+	sLRUChunks.Add(chunk);
+	fChunks.Remove(chunk);
+	fChunks.Add(chunk);
+
+	fHits++;
+	sHits++;
+	return true;
+}
+
+
+void
+HeapChunkCache::PutChunk(size_t chunkIndex, const void* data, size_t size,
+	bigtime_t readTime)
+{
+	{
+		MutexLocker locker(sLock);
+		fReadTime += readTime;
+		sReadTime += readTime;
+	}
+
+	// don't add to the memory pressure
+	if (low_resource_state(kLowResources) != B_NO_LOW_RESOURCE)
+		return;
+
+	Chunk* chunk = (Chunk*)malloc_etc(sizeof(Chunk) + size,
+		HEAP_DONT_WAIT_FOR_MEMORY);
+	if (chunk == NULL)
+		return;
+
+	chunk->owner = this;
+	chunk->index = chunkIndex;
+	chunk->size = size;
+	memcpy(chunk->Data(), data, size);
+
+	MutexLocker locker(sLock);
+
+	// another thread may have been faster
+	ChunkHashDefinition::KeyType key = { this, chunkIndex };
+	if (sChunks->Lookup(key) != NULL) {
+		locker.Unlock();
+		free(chunk);
+		return;
+	}
+
+	sChunks->Insert(chunk);
+	sLRUChunks.Add(chunk);
+	fChunks.Add(chunk);
+	fSize += size;
+	sSize += size;
+
+	_ShrinkOwn(sMaxSize / 4);
+	_Shrink(sMaxSize);
+}
+
+
+/*static*/ status_t
+HeapChunkCache::GlobalInit()
+{
+	// Use 1/64 of the memory, but at least kMinCacheSize and at most
+	// kMaxCacheSize.
+	sMaxSize = std::min(std::max(
+			(size_t)(vm_page_num_pages() / 64 * B_PAGE_SIZE), kMinCacheSize),
+		kMaxCacheSize);
+
+	sChunks = new(std::nothrow) ChunkTable;
+	if (sChunks == NULL)
+		RETURN_ERROR(B_NO_MEMORY);
+
+	// size the table for a full cache of complete chunks, it only needs to
+	// grow if there are many smaller ones
+	size_t tableSize = kMinChunkTableSize;
+	while (tableSize * PackageFileHeapReader::kChunkSize < sMaxSize)
+		tableSize <<= 1;
+
+	status_t error = sChunks->Init(tableSize);
+	if (error != B_OK) {
+		delete sChunks;
+		sChunks = NULL;
+		RETURN_ERROR(error);
+	}
+
+	register_low_resource_handler(&_LowResourceHandler, NULL, kLowResources,
+		0);
+
+	add_debugger_command_etc("packagefs_chunk_cache", &_DumpCommand,
+		"Print the packagefs heap chunk cache statistics",
+		"\n"
+		"Prints the statistics of the cache for decompressed package heap\n"
+		"chunks, as well as the per package usage.\n", 0);
+
+	return B_OK;
+}
+
+
+/*static*/ void
+HeapChunkCache::GlobalUninit()
+{
+	remove_debugger_command("packagefs_chunk_cache", &_DumpCommand);
+	unregister_low_resource_handler(&_LowResourceHandler, NULL);
+
+	delete sChunks;
+	sChunks = NULL;
+}
+
+
+/*!	Evicts this cache's least recently used chunks until it uses no more than
+	\a maxSize bytes.
+	The global lock must be held.
+*/
+void
+HeapChunkCache::_ShrinkOwn(size_t maxSize)
+{
+	while (fSize > maxSize) {
+		_RemoveChunk(fChunks.Head());
+		sEvictions++;
+	}
+}
+
+
+/*!	Evicts the least recently used chunks until the cache uses no more than
+	\a maxSize bytes.
+	The global lock must be held.
+*/
+/*static*/ void
+HeapChunkCache::_Shrink(size_t maxSize)
+{
+	while (sSize > maxSize) {
+		_RemoveChunk(sLRUChunks.Head());
+		sEvictions++;
+	}
+}
+
+
+/*static*/ void
+HeapChunkCache::_RemoveChunk(Chunk* chunk)
+{
+	HeapChunkCache* owner = chunk->owner;
+	sChunks->RemoveUnchecked(chunk);
+	sLRUChunks.Remove(chunk);
+	owner->fChunks.Remove(chunk);
+	owner->fSize -= chunk->size;
+	sSize -= chunk->size;
+
+	free(chunk);
+}
+
+
+/*static*/ void
+HeapChunkCache::_LowResourceHandler(void* data, uint32 resources, int32 level)
+{
+	MutexLocker locker(sLock);
+
+	switch (level) {
+		case B_NO_LOW_RESOURCE:
+			return;
+		case B_LOW_RESOURCE_NOTE:
+			_Shrink(sSize / 2);
+			break;
+		case B_LOW_RESOURCE_WARNING:
+			_Shrink(sSize / 4);
+			break;
+		case B_LOW_RESOURCE_CRITICAL:
+			_Shrink(0);
+			break;
+	}
+}
+
+
+/*static*/ int
+HeapChunkCache::_DumpCommand(int argc, char** argv)
+{
+	uint64 lookups = sHits + sMisses;
+	kprintf("size:        %" B_PRIuSIZE " of %" B_PRIuSIZE " bytes\n", sSize,
+		sMaxSize);
+	kprintf("chunks:      %" B_PRIuSIZE "\n", sChunks->CountElements());
+	kprintf("hits:        %" B_PRIu64 " (%" B_PRIu64 "%%)\n", sHits,
+		lookups > 0 ? sHits * 100 / lookups : 0);
+	kprintf("misses:      %" B_PRIu64 "\n", sMisses);
+	kprintf("evictions:   %" B_PRIu64 "\n", sEvictions);
+	kprintf("read time:   %" B_PRIdBIGTIME " us (%" B_PRIdBIGTIME
+		" us per miss)\n", sReadTime,
+		sMisses > 0 ? sReadTime / (bigtime_t)sMisses : 0);
+
+	kprintf("\n%-10s %10s %10s %10s %12s  %s\n", "cache", "size", "hits",
+		"misses", "read time", "package");
+	for (CacheList::Iterator it = sCaches.GetIterator();
+			HeapChunkCache* cache = it.Next();) {
+		kprintf("%p %10" B_PRIuSIZE " %10" B_PRIu64 " %10" B_PRIu64 " %12"
+			B_PRIdBIGTIME "  %s\n", cache, cache->fSize, cache->fHits,
+			cache->fMisses, cache->fReadTime, cache->fName.Data());
+	}
+
+	return 0;
+}
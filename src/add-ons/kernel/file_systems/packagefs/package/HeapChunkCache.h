@@ -0,0 +1,102 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef HEAP_CHUNK_CACHE_H
+#define HEAP_CHUNK_CACHE_H
+
+
+#include <package/hpkg/PackageFileHeapReader.h>
+
+#include <lock.h>
+#include <util/DoublyLinkedList.h>
+#include <util/OpenHashTable.h>
+
+#include "String.h"
+
+
+using BPackageKit::BHPKG::BPrivate::PackageFileHeapReader;
+
+
+/*!	Caches the decompressed chunks of a package file's heap. The chunks of all
+	packages share one cache of limited size, from which the least recently
+	used chunks are evicted. A single package may occupy at most a quarter of
+	it. The cache shrinks when the system runs low on memory.
+*/
+class HeapChunkCache : public PackageFileHeapReader::ChunkCache,
+	public DoublyLinkedListLinkImpl<HeapChunkCache> {
+public:
+								HeapChunkCache();
+	virtual						~HeapChunkCache();
+
+			void				Init(const String& name);
+
+	virtual	bool				GetChunk(size_t chunkIndex, void* buffer,
+									size_t size);
+	virtual	void				PutChunk(size_t chunkIndex, const void* data,
+									size_t size, bigtime_t readTime);
+
+	static	status_t			GlobalInit();
+	static	void				GlobalUninit();
+
+private:
+			struct Chunk {
+				HeapChunkCache*				owner;
+				size_t						index;
+				size_t						size;
+				Chunk*						hashNext;
+				DoublyLinkedListLink<Chunk>	lruLink;
+				DoublyLinkedListLink<Chunk>	ownerLink;
+
+				void* Data()
+				{
+					return this + 1;
+				}
+			};
+
+			struct ChunkHashDefinition;
+
+			typedef DoublyLinkedList<Chunk,
+				DoublyLinkedListMemberGetLink<Chunk,
+					&Chunk::lruLink> > LRUChunkList;
+			typedef DoublyLinkedList<Chunk,
+				DoublyLinkedListMemberGetLink<Chunk,
+					&Chunk::ownerLink> > OwnerChunkList;
+			typedef BOpenHashTable<ChunkHashDefinition> ChunkTable;
+			typedef DoublyLinkedList<HeapChunkCache> CacheList;
+
+private:
+			void				_ShrinkOwn(size_t maxSize);
+	static	void				_Shrink(size_t maxSize);
+	static	void				_RemoveChunk(Chunk* chunk);
+
+	static	void				_LowResourceHandler(void* data,
+									uint32 resources, int32 level);
+	static	int					_DumpCommand(int argc, char** argv);
+
+private:
+			String				fName;
+			OwnerChunkList		fChunks;
+									// least recently used first
+			size_t				fSize;
+			uint64				fHits;
+			uint64				fMisses;
+			bigtime_t			fReadTime;
+
+	static	mutex				sLock;
+	static	ChunkTable*			sChunks;
+	static	LRUChunkList		sLRUChunks;
+									// least recently used first
+	static	CacheList			sCaches;
+	static	size_t				sSize;
+	static	size_t				sMaxSize;
+
+	// statistics
+	static	uint64				sHits;
+	static	uint64				sMisses;
+	static	uint64				sEvictions;
+	static	bigtime_t			sReadTime;
+};
+
+
+#endif	// HEAP_CHUNK_CACHE_H
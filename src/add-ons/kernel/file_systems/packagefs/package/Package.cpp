@@ -25,6 +25,7 @@
 
 #include "CachedDataReader.h"
 #include "DebugSupport.h"
+#include "HeapChunkCache.h"
 #include "PackageDirectory.h"
 #include "PackageFile.h"
 #include "PackagesDirectory.h"
@@ -406,7 +407,8 @@ public:
 		delete fHeapReader;
 	}
 
-	status_t Init(const PackageFileHeapReader* heapReader, int fd)
+	status_t Init(const PackageFileHeapReader* heapReader, int fd,
+		const String& fileName)
 	{
 		fHeapReader = heapReader->Clone();
 		if (fHeapReader == NULL)
@@ -417,6 +419,12 @@ public:
 		fHeapReader->SetErrorOutput(this);
 		fHeapReader->SetFile(this);
 
+		// Pages of the cache below may be reclaimed, while the chunk they
+		// were decompressed from is still in use (e.g. pieces of a shared
+		// library). The chunk cache saves decompressing the chunk again.
+		fChunkCache.Init(fileName);
+		fHeapReader->SetChunkCache(&fChunkCache);
+
 		status_t error = CachedDataReader::Init(fHeapReader,
 			fHeapReader->UncompressedHeapSize());
 		if (error != B_OK)
@@ -447,6 +455,7 @@ private:
 
 private:
 	PackageFileHeapReader*	fHeapReader;
+	HeapChunkCache			fChunkCache;
 };
 
 
@@ -454,11 +463,12 @@ private:
 
 
 struct Package::CachingPackageReader : public PackageReaderImpl {
-	CachingPackageReader(BErrorOutput* errorOutput)
+	CachingPackageReader(BErrorOutput* errorOutput, const String& fileName)
 		:
 		PackageReaderImpl(errorOutput),
 		fCachedHeapReader(NULL),
-		fFD(-1)
+		fFD(-1),
+		fFileName(fileName)
 	{
 	}
 
@@ -480,7 +490,8 @@ struct Package::CachingPackageReader : public PackageReaderImpl {
 		if (fCachedHeapReader == NULL)
 			RETURN_ERROR(B_NO_MEMORY);
 
-		status_t error = fCachedHeapReader->Init(rawHeapReader, fFD);
+		status_t error = fCachedHeapReader->Init(rawHeapReader, fFD,
+			fFileName);
 		if (error != B_OK)
 			RETURN_ERROR(error);
 
@@ -505,6 +516,7 @@ struct Package::CachingPackageReader : public PackageReaderImpl {
 private:
 	HeapReaderV2*	fCachedHeapReader;
 	int				fFD;
+	String			fFileName;
 };
 
 
@@ -540,16 +552,7 @@ Package::~Package()
 {
 	delete fHeapReader;
 
-	while (PackageNode* node = fNodes.RemoveHead())
-		node->ReleaseReference();
-
-	while (Resolvable* resolvable = fResolvables.RemoveHead())
-		delete resolvable;
-
-	while (Dependency* dependency = fDependencies.RemoveHead())
-		delete dependency;
-
-	delete fVersion;
+	_UnloadContent();
 
 	fPackagesDirectory->ReleaseReference();
 
@@ -567,10 +570,17 @@ Package::Init(const char* fileName)
 }
 
 
+/*!	Loads the package attributes and the node tree. If \a cachedPackage is
+	given, they are taken from the TOC cache instead of being read from the
+	package file. The caller must have checked that the cached package is still
+	up-to-date.
+*/
 status_t
-Package::Load(const PackageSettings& settings)
+Package::Load(const PackageSettings& settings,
+	const PackageTOCCacheReader* tocCache,
+	const package_toc_cache_package* cachedPackage)
 {
-	status_t error = _Load(settings);
+	status_t error = _Load(settings, tocCache, cachedPackage);
 	if (error != B_OK)
 		return error;
 
@@ -713,7 +723,9 @@ Package::CreateDataReader(const PackageData& data,
 
 
 status_t
-Package::_Load(const PackageSettings& settings)
+Package::_Load(const PackageSettings& settings,
+	const PackageTOCCacheReader* tocCache,
+	const package_toc_cache_package* cachedPackage)
 {
 	// open package file
 	int fd = Open();
@@ -726,19 +738,42 @@ Package::_Load(const PackageSettings& settings)
 
 	// try current package file format version
 	{
-		CachingPackageReader packageReader(&errorOutput);
+		CachingPackageReader packageReader(&errorOutput, fFileName);
 		status_t error = packageReader.Init(fd, false,
 			BHPKG::B_HPKG_READER_DONT_PRINT_VERSION_MISMATCH_MESSAGE);
 		if (error == B_OK) {
-			// parse content
-			LoaderContentHandler handler(this, settings);
-			error = handler.Init();
-			if (error != B_OK)
-				RETURN_ERROR(error);
+			// Replay the content from the TOC cache, if possible. Since that
+			// saves reading and parsing the TOC, the package reader is only
+			// used for the heap.
+			if (cachedPackage != NULL) {
+				LoaderContentHandler handler(this, settings);
+				error = handler.Init();
+				if (error != B_OK)
+					RETURN_ERROR(error);
+
+				error = tocCache->ParseContent(cachedPackage,
+					packageReader.HeapSize(), &handler);
+				if (error == B_NO_MEMORY)
+					RETURN_ERROR(error);
+				if (error != B_OK) {
+					ERROR("Failed to load package \"%s\" from the TOC cache: "
+						"%s\n", fFileName.Data(), strerror(error));
+					_UnloadContent();
+					cachedPackage = NULL;
+				}
+			}
 
-			error = packageReader.ParseContent(&handler);
-			if (error != B_OK)
-				RETURN_ERROR(error);
+			if (cachedPackage == NULL) {
+				// parse content
+				LoaderContentHandler handler(this, settings);
+				error = handler.Init();
+				if (error != B_OK)
+					RETURN_ERROR(error);
+
+				error = packageReader.ParseContent(&handler);
+				if (error != B_OK)
+					RETURN_ERROR(error);
+			}
 
 			// get the heap reader
 			fHeapReader = packageReader.DetachCachedHeapReader();
@@ -754,6 +789,28 @@ Package::_Load(const PackageSettings& settings)
 }
 
 
+void
+Package::_UnloadContent()
+{
+	while (PackageNode* node = fNodes.RemoveHead())
+		node->ReleaseReference();
+
+	while (Resolvable* resolvable = fResolvables.RemoveHead())
+		delete resolvable;
+
+	while (Dependency* dependency = fDependencies.RemoveHead())
+		delete dependency;
+
+	delete fVersion;
+	fVersion = NULL;
+
+	fName = String();
+	fInstallPath = String();
+	fFlags = 0;
+	fArchitecture = B_PACKAGE_ARCHITECTURE_ENUM_COUNT;
+}
+
+
 bool
 Package::_InitVersionedName()
 {
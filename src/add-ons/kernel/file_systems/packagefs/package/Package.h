@@ -7,6 +7,7 @@
 
 
 #include <package/hpkg/DataReader.h>
+#include <package/hpkg/PackageTOCCacheReader.h>
 #include <package/PackageFlags.h>
 #include <package/PackageArchitecture.h>
 
@@ -26,6 +27,8 @@
 
 using BPackageKit::BPackageArchitecture;
 using BPackageKit::BHPKG::BAbstractBufferedDataReader;
+using BPackageKit::BHPKG::BPrivate::PackageTOCCacheReader;
+using BPackageKit::BHPKG::BPrivate::package_toc_cache_package;
 
 
 class PackageLinkDirectory;
@@ -44,7 +47,11 @@ public:
 								~Package();
 
 			status_t			Init(const char* fileName);
-			status_t			Load(const PackageSettings& settings);
+			status_t			Load(const PackageSettings& settings,
+									const PackageTOCCacheReader* tocCache
+										= NULL,
+									const package_toc_cache_package*
+										cachedPackage = NULL);
 
 			::Volume*			Volume() const		{ return fVolume; }
 			const String&		FileName() const	{ return fFileName; }
@@ -117,7 +124,11 @@ private:
 			struct CachingPackageReader;
 
 private:
-			status_t			_Load(const PackageSettings& settings);
+			status_t			_Load(const PackageSettings& settings,
+									const PackageTOCCacheReader* tocCache,
+									const package_toc_cache_package*
+										cachedPackage);
+			void				_UnloadContent();
 			bool				_InitVersionedName();
 
 private:
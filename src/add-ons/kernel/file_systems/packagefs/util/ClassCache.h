@@ -7,6 +7,7 @@
 
 
 #include <slab/Slab.h>
+#include <util/atomic.h>
 
 
 #define CLASS_CACHE(CLASS) \
@@ -18,8 +19,13 @@
 		if (size != sizeof(CLASS)) \
 			panic("unexpected size passed to operator new!"); \
 		if (s##CLASS##Cache == NULL) { \
-			s##CLASS##Cache = create_object_cache("packagefs " #CLASS "s", \
+			/* packages may be loaded by several threads at once */ \
+			object_cache* cache = create_object_cache("packagefs " #CLASS "s", \
 				sizeof(CLASS), 8, NULL, NULL, NULL); \
+			if (atomic_pointer_test_and_set(&s##CLASS##Cache, cache, \
+					(object_cache*)NULL) != NULL) { \
+				delete_object_cache(cache); \
+			} \
 		} \
 	\
 		return object_cache_alloc(s##CLASS##Cache, 0); \
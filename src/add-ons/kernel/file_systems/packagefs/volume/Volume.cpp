@@ -13,12 +13,14 @@
 #include <sys/param.h>
 #include <sys/stat.h>
 
+#include <algorithm>
 #include <new>
 
 #include <AppDefs.h>
 #include <driver_settings.h>
 #include <KernelExport.h>
 #include <NodeMonitor.h>
+#include <package/hpkg/ErrorOutput.h>
 #include <package/PackageInfoAttributes.h>
 
 #include <AutoDeleter.h>
@@ -26,6 +28,7 @@
 #include <AutoDeleterDrivers.h>
 #include <PackagesDirectoryDefs.h>
 
+#include <smp.h>
 #include <vfs.h>
 
 #include "AttributeIndex.h"
@@ -70,6 +73,12 @@ static const char* const kActivationFileName
 static const char* const kActivationFilePath
 	= PACKAGES_DIRECTORY_ADMIN_DIRECTORY "/"
 		PACKAGES_DIRECTORY_ACTIVATION_FILE;
+static const char* const kTOCCacheFilePath
+	= PACKAGES_DIRECTORY_ADMIN_DIRECTORY "/"
+		PACKAGES_DIRECTORY_TOC_CACHE_FILE;
+
+// the maximum number of threads loading the initial packages
+static const int32 kMaxInitialPackageLoaderThreads = 8;
 
 
 // #pragma mark - ShineThroughDirectory
@@ -161,6 +170,42 @@ private:
 };
 
 
+// #pragma mark - TOCCache
+
+
+struct Volume::TOCCache : private BPackageKit::BHPKG::BErrorOutput,
+	public PackageTOCCacheReader {
+	TOCCache()
+		:
+		PackageTOCCacheReader(this)
+	{
+	}
+
+private:
+	virtual void PrintErrorVarArgs(const char* format, va_list args)
+	{
+		ERRORV(format, args);
+	}
+};
+
+
+// #pragma mark - InitialPackageLoader
+
+
+/*!	The state shared by the threads loading the initial packages. Each thread
+	loads the next package that hasn't been picked yet, until none are left.
+*/
+struct Volume::InitialPackageLoader {
+	Volume*				volume;
+	PackagesDirectory*	packagesDirectory;
+	const char* const*	names;
+	Package**			packages;
+	status_t*			errors;
+	int32				count;
+	int32				nextIndex;
+};
+
+
 // #pragma mark - Volume
 
 
@@ -173,6 +218,7 @@ Volume::Volume(fs_volume* fsVolume)
 	fPackagesDirectories(),
 	fPackagesDirectoriesByNodeRef(),
 	fPackageSettings(),
+	fTOCCache(NULL),
 	fNextNodeID(kRootDirectoryID + 1)
 {
 	rw_lock_init(&fLock, "packagefs volume");
@@ -424,10 +470,20 @@ Volume::Mount(const char* parameterString)
 		RETURN_ERROR(error);
 
 	// add initial packages
+	bigtime_t startTime = system_time();
+	_LoadTOCCache();
+
 	error = _AddInitialPackages();
+
+	delete fTOCCache;
+	fTOCCache = NULL;
+
 	if (error != B_OK)
 		RETURN_ERROR(error);
 
+	INFORM("Added %" B_PRIuSIZE " packages in %" B_PRIdBIGTIME " us\n",
+		fPackages.CountElements(), system_time() - startTime);
+
 	// publish the root node
 	fRootDirectory->AcquireReference();
 	error = PublishVNode(fRootDirectory);
@@ -856,8 +912,22 @@ Volume::_AddInitialPackagesFromActivationFile(
 	// null-terminate to simplify parsing
 	fileContent[st.st_size] = '\0';
 
-	// parse the file and add the respective packages
-	const char* packageName = fileContent;
+	// allocate an array for the package names -- one per line at most
+	int32 maxPackageCount = 1;
+	for (const char* c = fileContent; *c != '\0'; c++) {
+		if (*c == '\n')
+			maxPackageCount++;
+	}
+
+	const char** packageNames
+		= (const char**)malloc(sizeof(char*) * maxPackageCount);
+	if (packageNames == NULL)
+		RETURN_ERROR(B_NO_MEMORY);
+	MemoryDeleter packageNamesDeleter(packageNames);
+
+	// parse the file and collect the package names
+	int32 packageCount = 0;
+	char* packageName = fileContent;
 	char* const fileContentEnd = fileContent + st.st_size;
 	while (packageName < fileContentEnd) {
 		char* packageNameEnd = strchr(packageName, '\n');
@@ -876,15 +946,13 @@ Volume::_AddInitialPackagesFromActivationFile(
 			RETURN_ERROR(B_BAD_DATA);
 		}
 
-		status_t error = _LoadAndAddInitialPackage(packagesDirectory,
-			packageName);
-		if (error != B_OK)
-			RETURN_ERROR(error);
-
+		packageNames[packageCount++] = packageName;
 		packageName = packageNameEnd + 1;
 	}
 
-	return B_OK;
+	// load and add the packages
+	return _LoadAndAddInitialPackages(packagesDirectory, packageNames,
+		packageCount, false);
 }
 
 
@@ -906,6 +974,12 @@ Volume::_AddInitialPackagesFromDirectory()
 	}
 	DirCloser dirCloser(dir);
 
+	// collect the names of the packages
+	char** packageNames = NULL;
+	int32 packageCount = 0;
+	int32 packageNamesCapacity = 0;
+	status_t error = B_OK;
+
 	while (dirent* entry = readdir(dir)) {
 		// skip "." and ".."
 		if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
@@ -918,33 +992,160 @@ Volume::_AddInitialPackagesFromDirectory()
 			continue;
 		}
 
-		_LoadAndAddInitialPackage(fPackagesDirectory, entry->d_name);
+		if (packageCount == packageNamesCapacity) {
+			int32 newCapacity = std::max(packageNamesCapacity * 2, (int32)64);
+			char** newPackageNames = (char**)realloc(packageNames,
+				sizeof(char*) * newCapacity);
+			if (newPackageNames == NULL) {
+				error = B_NO_MEMORY;
+				break;
+			}
+			packageNames = newPackageNames;
+			packageNamesCapacity = newCapacity;
+		}
+
+		packageNames[packageCount] = strdup(entry->d_name);
+		if (packageNames[packageCount] == NULL) {
+			error = B_NO_MEMORY;
+			break;
+		}
+		packageCount++;
 	}
 
-	return B_OK;
+	// load and add the packages
+	if (error == B_OK) {
+		error = _LoadAndAddInitialPackages(fPackagesDirectory, packageNames,
+			packageCount, true);
+	}
+
+	for (int32 i = 0; i < packageCount; i++)
+		free(packageNames[i]);
+	free(packageNames);
+
+	return error;
 }
 
 
+/*!	Loads the given packages -- on several threads, since loading a package
+	that isn't in the TOC cache means reading and parsing its TOC -- and adds
+	them in the given order.
+	If \a ignoreErrors is \c false, the first package that fails to load is
+	fatal. The packages added so far remain added in this case.
+*/
 status_t
-Volume::_LoadAndAddInitialPackage(PackagesDirectory* packagesDirectory,
-	const char* name)
+Volume::_LoadAndAddInitialPackages(PackagesDirectory* packagesDirectory,
+	const char* const* names, int32 count, bool ignoreErrors)
 {
-	Package* package;
-	status_t error = _LoadPackage(packagesDirectory, name, package);
-	if (error != B_OK) {
-		ERROR("Failed to load package \"%s\": %s\n", name, strerror(error));
-		RETURN_ERROR(error);
+	if (count == 0)
+		return B_OK;
+
+	Package** packages = (Package**)calloc(count, sizeof(Package*));
+	MemoryDeleter packagesDeleter(packages);
+	status_t* errors = (status_t*)malloc(sizeof(status_t) * count);
+	MemoryDeleter errorsDeleter(errors);
+	if (packages == NULL || errors == NULL)
+		RETURN_ERROR(B_NO_MEMORY);
+
+	InitialPackageLoader loader;
+	loader.volume = this;
+	loader.packagesDirectory = packagesDirectory;
+	loader.names = names;
+	loader.packages = packages;
+	loader.errors = errors;
+	loader.count = count;
+	loader.nextIndex = 0;
+
+	int32 threadCount = std::min(std::min(smp_get_num_cpus(),
+		kMaxInitialPackageLoaderThreads), count);
+	thread_id threads[kMaxInitialPackageLoaderThreads];
+	int32 spawnedThreadCount = 0;
+	for (int32 i = 1; i < threadCount; i++) {
+		thread_id thread = spawn_kernel_thread(&_InitialPackageLoaderThread,
+			"packagefs package loader", B_NORMAL_PRIORITY, &loader);
+		if (thread < 0)
+			break;
+
+		resume_thread(thread);
+		threads[spawnedThreadCount++] = thread;
 	}
-	BReference<Package> packageReference(package, true);
 
+	// this thread helps, too
+	_InitialPackageLoaderThread(&loader);
+
+	for (int32 i = 0; i < spawnedThreadCount; i++)
+		wait_for_thread(threads[i], NULL);
+
+	// add the packages
 	VolumeWriteLocker systemVolumeLocker(_SystemVolumeIfNotSelf());
 	VolumeWriteLocker volumeLocker(this);
-	_AddPackage(package);
+
+	status_t error = B_OK;
+	for (int32 i = 0; i < count; i++) {
+		if (errors[i] != B_OK) {
+			ERROR("Failed to load package \"%s\": %s\n", names[i],
+				strerror(errors[i]));
+			if (!ignoreErrors && error == B_OK)
+				error = errors[i];
+			continue;
+		}
+
+		BReference<Package> packageReference(packages[i], true);
+		if (error == B_OK)
+			_AddPackage(packages[i]);
+	}
+
+	if (error != B_OK)
+		RETURN_ERROR(error);
 
 	return B_OK;
 }
 
 
+/*static*/ status_t
+Volume::_InitialPackageLoaderThread(void* data)
+{
+	InitialPackageLoader* loader = (InitialPackageLoader*)data;
+
+	for (;;) {
+		int32 index = atomic_add(&loader->nextIndex, 1);
+		if (index >= loader->count)
+			return B_OK;
+
+		loader->errors[index] = loader->volume->_LoadPackage(
+			loader->packagesDirectory, loader->names[index],
+			loader->packages[index]);
+	}
+}
+
+
+void
+Volume::_LoadTOCCache()
+{
+	int fd = openat(fPackagesDirectory->DirectoryFD(), kTOCCacheFilePath,
+		O_RDONLY);
+	if (fd < 0) {
+		INFORM("No package TOC cache: %s\n", strerror(errno));
+		return;
+	}
+	FileDescriptorCloser fdCloser(fd);
+
+	TOCCache* tocCache = new(std::nothrow) TOCCache;
+	if (tocCache == NULL)
+		return;
+
+	status_t error = tocCache->Init(fd);
+	if (error != B_OK) {
+		INFORM("Ignoring the package TOC cache: %s\n", strerror(error));
+		delete tocCache;
+		return;
+	}
+
+	INFORM("Package TOC cache with %" B_PRIu32 " packages\n",
+		tocCache->CountPackages());
+	fTOCCache = tocCache;
+}
+
+
 inline void
 Volume::_AddPackage(Package* package)
 {
@@ -1490,7 +1691,16 @@ Volume::_LoadPackage(PackagesDirectory* packagesDirectory, const char* name,
 	if (error != B_OK)
 		return error;
 
-	error = package->Load(fPackageSettings);
+	// While adding the initial packages, the TOC cache spares us parsing the
+	// packages that haven't changed since it was written.
+	const package_toc_cache_package* cachedPackage = NULL;
+	if (fTOCCache != NULL && packagesDirectory == fPackagesDirectory) {
+		cachedPackage = fTOCCache->FindPackage(name);
+		if (cachedPackage != NULL && !fTOCCache->IsUpToDate(cachedPackage, st))
+			cachedPackage = NULL;
+	}
+
+	error = package->Load(fPackageSettings, fTOCCache, cachedPackage);
 	if (error != B_OK)
 		return error;
 
@@ -108,6 +108,8 @@ private:
 private:
 			struct ShineThroughDirectory;
 			struct ActivationChangeRequest;
+			struct TOCCache;
+			struct InitialPackageLoader;
 
 private:
 			status_t			_LoadOldPackagesStates(
@@ -117,9 +119,12 @@ private:
 			status_t			_AddInitialPackagesFromActivationFile(
 									PackagesDirectory* packagesDirectory);
 			status_t			_AddInitialPackagesFromDirectory();
-			status_t			_LoadAndAddInitialPackage(
+			status_t			_LoadAndAddInitialPackages(
 									PackagesDirectory* packagesDirectory,
-									const char* name);
+									const char* const* names, int32 count,
+									bool ignoreErrors);
+	static	status_t			_InitialPackageLoaderThread(void* data);
+			void				_LoadTOCCache();
 
 	inline	void				_AddPackage(Package* package);
 	inline	void				_RemovePackage(Package* package);
@@ -189,6 +194,8 @@ private:
 			PackagesDirectoryList fPackagesDirectories;
 			PackagesDirectoryHashTable fPackagesDirectoriesByNodeRef;
 			PackageSettings		fPackageSettings;
+			TOCCache*			fTOCCache;
+									// only while adding the initial packages
 
 			struct {
 				dev_t			deviceID;
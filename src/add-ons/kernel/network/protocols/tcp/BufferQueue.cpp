@@ -34,7 +34,8 @@ BufferQueue::BufferQueue(size_t maxBytes)
 	fContiguousBytes(0),
 	fFirstSequence(0),
 	fLastSequence(0),
-	fPushPointer(0)
+	fPushPointer(0),
+	fLastAddedSequence(0)
 {
 }
 
@@ -63,7 +64,7 @@ BufferQueue::SetInitialSequence(tcp_sequence sequence)
 	TRACE(("BufferQueue@%p::SetInitialSequence(%" B_PRIu32 ")\n", this,
 		sequence.Number()));
 
-	fFirstSequence = fLastSequence = sequence;
+	fFirstSequence = fLastSequence = fLastAddedSequence = sequence;
 }
 
 
@@ -85,6 +86,8 @@ BufferQueue::Add(net_buffer *buffer, tcp_sequence sequence)
 		fContiguousBytes));
 	VERIFY();
 
+	fLastAddedSequence = sequence;
+
 	if (tcp_sequence(sequence + buffer->size) <= fFirstSequence
 		|| buffer->size == 0) {
 		// This buffer does not contain any data of interest
@@ -438,38 +441,80 @@ BufferQueue::SetPushPointer()
 }
 
 
+/*!	Fills \a sacks with the blocks of data beyond \a sequence that are in
+	the queue, in network byte order. As required by RFC 2018, the first block
+	is the one that contains the most recently added data, the others follow
+	in descending order.
+	Returns the number of blocks.
+*/
 int
 BufferQueue::PopulateSackInfo(tcp_sequence sequence, int maxSackCount,
 	tcp_sack* sacks)
 {
-	SegmentList::ReverseIterator iterator = fList.GetReverseIterator();
-	net_buffer* buffer = iterator.Next();
-
-	int sackCount = 0;
 	TRACE(("BufferQueue::PopulateSackInfo() %" B_PRIu32 "\n",
 		sequence.Number()));
-	while (buffer != NULL && buffer->sequence > sequence) {
-		if (buffer->sequence + buffer->size < sacks[sackCount].left_edge) {
-			if (sackCount + 1 == maxSackCount)
-				break;
-			++sackCount;
-			sacks[sackCount].left_edge = buffer->sequence;
-			sacks[sackCount].right_edge = buffer->sequence + buffer->size;
-		} else {
-			sacks[sackCount].left_edge = buffer->sequence;
-			if (sacks[sackCount].right_edge == 0)
-				sacks[sackCount].right_edge = buffer->sequence + buffer->size;
+
+	if (maxSackCount <= 0)
+		return 0;
+	if (maxSackCount > MAX_SACK_BLKS)
+		maxSackCount = MAX_SACK_BLKS;
+
+	tcp_sack others[MAX_SACK_BLKS];
+	int otherCount = 0;
+	bool haveRecent = false;
+	tcp_sequence recentLeft;
+	tcp_sequence recentRight;
+
+	SegmentList::ReverseIterator iterator = fList.GetReverseIterator();
+	bool haveBlock = false;
+	tcp_sequence left;
+	tcp_sequence right;
+
+	while (true) {
+		net_buffer* buffer = iterator.Next();
+		if (buffer != NULL && tcp_sequence(buffer->sequence) <= sequence)
+			buffer = NULL;
+
+		if (buffer != NULL && haveBlock
+			&& tcp_sequence(buffer->sequence + buffer->size) == left) {
+			// extend the current block
+			left = buffer->sequence;
+			continue;
+		}
+
+		if (haveBlock) {
+			if (!haveRecent && fLastAddedSequence >= left
+				&& fLastAddedSequence < right) {
+				recentLeft = left;
+				recentRight = right;
+				haveRecent = true;
+			} else if (otherCount < maxSackCount) {
+				others[otherCount].left_edge = left.Number();
+				others[otherCount].right_edge = right.Number();
+				otherCount++;
+			}
 		}
 
-		buffer = iterator.Next();
+		if (buffer == NULL
+			|| (haveRecent && otherCount >= maxSackCount - 1))
+			break;
+
+		left = buffer->sequence;
+		right = left + buffer->size;
+		haveBlock = true;
 	}
 
-	if (sacks[0].left_edge != 0) {
-		for (int i = 0; i <= sackCount; ++i) {
-			sacks[i].left_edge = htonl(sacks[i].left_edge);
-			sacks[i].right_edge = htonl(sacks[i].right_edge);
-		}
-		++sackCount;
+	int sackCount = 0;
+	if (haveRecent) {
+		sacks[0].left_edge = htonl(recentLeft.Number());
+		sacks[0].right_edge = htonl(recentRight.Number());
+		sackCount++;
+	}
+
+	for (int i = 0; i < otherCount && sackCount < maxSackCount; i++) {
+		sacks[sackCount].left_edge = htonl(others[i].left_edge);
+		sacks[sackCount].right_edge = htonl(others[i].right_edge);
+		sackCount++;
 	}
 
 	return sackCount;
@@ -38,7 +38,8 @@ public:
 
 	inline	size_t				PushedData() const;
 			void				SetPushPointer();
-			int				PopulateSackInfo(tcp_sequence sequence, int maxSackCount, tcp_sack* sacks);
+			int					PopulateSackInfo(tcp_sequence sequence,
+									int maxSackCount, tcp_sack* sacks);
 
 			size_t				Used() const { return fNumBytes; }
 	inline	size_t				Free() const;
@@ -65,6 +66,7 @@ private:
 			tcp_sequence		fFirstSequence;
 			tcp_sequence		fLastSequence;
 			tcp_sequence		fPushPointer;
+			tcp_sequence		fLastAddedSequence;
 };
 
 
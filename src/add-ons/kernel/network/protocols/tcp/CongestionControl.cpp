@@ -0,0 +1,521 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	TCP congestion control algorithms.
+
+	NewReno is the classic AIMD algorithm of RFC 5681. CUBIC (RFC 9438) grows
+	the window as a cubic function of the time since the last loss, which
+	lets it reach large windows on paths with a high bandwidth-delay product
+	much faster, and reduces the window less on a loss. It uses HyStart
+	(Ha and Rhee, "Taming the elephants", 2011) to leave slow start before
+	the first loss when the ACK spacing or the RTT indicate that the path is
+	saturated.
+
+	The kernel must not use floating point, so everything is computed in
+	fixed point: windows are kept in bytes, and CUBIC time in milliseconds.
+*/
+
+
+#include "CongestionControl.h"
+
+#include <new>
+#include <string.h>
+
+#include <KernelExport.h>
+
+
+//#define TRACE_CONGESTION_CONTROL
+#ifdef TRACE_CONGESTION_CONTROL
+#	define TRACE(x) dprintf x
+#else
+#	define TRACE(x)
+#endif
+
+
+class NewRenoCongestionControl : public CongestionControl {
+public:
+	virtual	const char*			Name() const { return "newreno"; }
+
+	virtual	void				Reset();
+	virtual	void				Acknowledged(uint32& congestionWindow,
+									uint32& slowStartThreshold,
+									uint32 bytesAcknowledged,
+									uint32 maxSegmentSize,
+									tcp_sequence acknowledge,
+									tcp_sequence sendNext,
+									bigtime_t roundTripTime);
+	virtual	uint32				LossDetected(uint32 congestionWindow,
+									uint32 flightSize,
+									uint32 maxSegmentSize,
+									bool timeout);
+};
+
+
+/*!	Detects the point at which slow start should be left, either because
+	the ACKs of a round arrive as a closely spaced train for at least half
+	the minimum RTT, or because the RTT rises noticeably above its minimum.
+*/
+class HyStart {
+public:
+								HyStart();
+
+			void				Reset();
+			bool				ShouldExit(uint32 congestionWindow,
+									uint32 maxSegmentSize,
+									tcp_sequence acknowledge,
+									tcp_sequence sendNext,
+									bigtime_t roundTripTime,
+									bigtime_t minRoundTripTime);
+
+			void				Dump() const;
+
+private:
+			bool				fStarted;
+			tcp_sequence		fRoundEnd;
+			bigtime_t			fRoundStart;
+			bigtime_t			fLastAcknowledge;
+			bigtime_t			fRoundMinRoundTripTime;
+			int32				fSampleCount;
+};
+
+
+class CubicCongestionControl : public CongestionControl {
+public:
+								CubicCongestionControl();
+
+	virtual	const char*			Name() const { return "cubic"; }
+
+	virtual	void				Reset();
+	virtual	void				Acknowledged(uint32& congestionWindow,
+									uint32& slowStartThreshold,
+									uint32 bytesAcknowledged,
+									uint32 maxSegmentSize,
+									tcp_sequence acknowledge,
+									tcp_sequence sendNext,
+									bigtime_t roundTripTime);
+	virtual	uint32				LossDetected(uint32 congestionWindow,
+									uint32 flightSize,
+									uint32 maxSegmentSize,
+									bool timeout);
+
+	virtual	void				Dump() const;
+
+private:
+			void				_StartEpoch(uint32 congestionWindow,
+									uint32 maxSegmentSize);
+
+private:
+			HyStart				fHyStart;
+			uint32				fMaxWindow;
+			uint32				fLastMaxWindow;
+			uint32				fOriginWindow;
+			uint32				fFriendlyWindow;
+			bigtime_t			fEpochStart;
+			int32				fK;
+			uint64				fIncrementRemainder;
+			bigtime_t			fMinRoundTripTime;
+};
+
+
+struct congestion_algorithm {
+	const char*			name;
+	CongestionControl*	(*create)();
+};
+
+
+static CongestionControl*
+create_newreno()
+{
+	return new(std::nothrow) NewRenoCongestionControl;
+}
+
+
+static CongestionControl*
+create_cubic()
+{
+	return new(std::nothrow) CubicCongestionControl;
+}
+
+
+static const congestion_algorithm kAlgorithms[] = {
+	{ "cubic", create_cubic },
+	{ "newreno", create_newreno },
+};
+static const int32 kAlgorithmCount
+	= sizeof(kAlgorithms) / sizeof(kAlgorithms[0]);
+
+static int32 sDefaultAlgorithm = 0;
+
+// CUBIC constants: C = 0.4, beta = 0.7, alpha = 3 * (1 - beta) / (1 + beta)
+static const uint32 kCubicBetaPercent = 70;
+static const uint32 kCubicFastConvergencePercent = 85;
+	// (1 + beta) / 2
+static const uint32 kCubicAlphaPermille = 529;
+static const int64 kCubicMaxTime = 100000;
+	// in ms, to avoid overflows
+
+// HyStart constants
+static const uint32 kHyStartLowWindow = 16;
+	// in segments
+static const bigtime_t kHyStartAckDelta = 2000;
+static const bigtime_t kHyStartMinDelayThreshold = 4000;
+static const bigtime_t kHyStartMaxDelayThreshold = 16000;
+static const int32 kHyStartMinSamples = 8;
+
+
+static uint32
+cube_root(uint64 value)
+{
+	if (value == 0)
+		return 0;
+
+	// start above the result, then use Newton's method, which decreases
+	// monotonically from there
+	if (value > (1ULL << 63))
+		value = 1ULL << 63;
+
+	uint64 root = 1;
+	while (root * root * root < value && root < (1 << 21))
+		root <<= 1;
+
+	while (true) {
+		uint64 next = (2 * root + value / (root * root)) / 3;
+		if (next >= root)
+			break;
+		root = next;
+	}
+
+	return (uint32)root;
+}
+
+
+//	#pragma mark - CongestionControl
+
+
+CongestionControl::~CongestionControl()
+{
+}
+
+
+void
+CongestionControl::Dump() const
+{
+	kprintf("  congestion control: %s\n", Name());
+}
+
+
+/*static*/ CongestionControl*
+CongestionControl::Create(const char* name)
+{
+	if (name == NULL)
+		return kAlgorithms[sDefaultAlgorithm].create();
+
+	for (int32 i = 0; i < kAlgorithmCount; i++) {
+		if (strcmp(kAlgorithms[i].name, name) == 0)
+			return kAlgorithms[i].create();
+	}
+
+	return NULL;
+}
+
+
+/*static*/ const char*
+CongestionControl::NameAt(int32 index)
+{
+	if (index < 0 || index >= kAlgorithmCount)
+		return NULL;
+
+	return kAlgorithms[index].name;
+}
+
+
+/*static*/ status_t
+CongestionControl::SetDefault(const char* name)
+{
+	for (int32 i = 0; i < kAlgorithmCount; i++) {
+		if (strcmp(kAlgorithms[i].name, name) == 0) {
+			sDefaultAlgorithm = i;
+			return B_OK;
+		}
+	}
+
+	return B_NAME_NOT_FOUND;
+}
+
+
+/*static*/ const char*
+CongestionControl::Default()
+{
+	return kAlgorithms[sDefaultAlgorithm].name;
+}
+
+
+//	#pragma mark - NewReno
+
+
+void
+NewRenoCongestionControl::Reset()
+{
+}
+
+
+void
+NewRenoCongestionControl::Acknowledged(uint32& congestionWindow,
+	uint32& slowStartThreshold, uint32 bytesAcknowledged,
+	uint32 maxSegmentSize, tcp_sequence acknowledge, tcp_sequence sendNext,
+	bigtime_t roundTripTime)
+{
+	if (congestionWindow < slowStartThreshold) {
+		congestionWindow += min_c(bytesAcknowledged, maxSegmentSize);
+		return;
+	}
+
+	uint32 increment = maxSegmentSize * maxSegmentSize;
+
+	if (increment < congestionWindow)
+		increment = 1;
+	else
+		increment /= congestionWindow;
+
+	congestionWindow += increment;
+}
+
+
+uint32
+NewRenoCongestionControl::LossDetected(uint32 congestionWindow,
+	uint32 flightSize, uint32 maxSegmentSize, bool timeout)
+{
+	return max_c(flightSize / 2, 2 * maxSegmentSize);
+}
+
+
+//	#pragma mark - HyStart
+
+
+HyStart::HyStart()
+{
+	Reset();
+}
+
+
+void
+HyStart::Reset()
+{
+	fStarted = false;
+	fRoundEnd = 0;
+	fRoundStart = 0;
+	fLastAcknowledge = 0;
+	fRoundMinRoundTripTime = B_INFINITE_TIMEOUT;
+	fSampleCount = 0;
+}
+
+
+bool
+HyStart::ShouldExit(uint32 congestionWindow, uint32 maxSegmentSize,
+	tcp_sequence acknowledge, tcp_sequence sendNext, bigtime_t roundTripTime,
+	bigtime_t minRoundTripTime)
+{
+	bigtime_t now = system_time();
+
+	if (!fStarted || acknowledge > fRoundEnd) {
+		// a new round begins: it ends once everything sent so far has been
+		// acknowledged
+		fStarted = true;
+		fRoundEnd = sendNext;
+		fRoundStart = now;
+		fLastAcknowledge = now;
+		fRoundMinRoundTripTime = B_INFINITE_TIMEOUT;
+		fSampleCount = 0;
+	}
+
+	if (congestionWindow < kHyStartLowWindow * maxSegmentSize
+		|| minRoundTripTime <= 0)
+		return false;
+
+	// ACK train: the ACKs of this round kept coming back to back for half
+	// the minimum RTT, so the pipe is full
+	if (now - fLastAcknowledge <= kHyStartAckDelta) {
+		fLastAcknowledge = now;
+		if (now - fRoundStart > minRoundTripTime / 2) {
+			TRACE(("HyStart: ACK train after %" B_PRIdBIGTIME " us\n",
+				now - fRoundStart));
+			return true;
+		}
+	}
+
+	// delay increase: the queues along the path start to fill up
+	if (roundTripTime >= 0 && fSampleCount < kHyStartMinSamples) {
+		if (roundTripTime < fRoundMinRoundTripTime)
+			fRoundMinRoundTripTime = roundTripTime;
+		fSampleCount++;
+	}
+
+	if (fSampleCount >= kHyStartMinSamples) {
+		bigtime_t threshold = minRoundTripTime / 8;
+		if (threshold < kHyStartMinDelayThreshold)
+			threshold = kHyStartMinDelayThreshold;
+		else if (threshold > kHyStartMaxDelayThreshold)
+			threshold = kHyStartMaxDelayThreshold;
+
+		if (fRoundMinRoundTripTime >= minRoundTripTime + threshold) {
+			TRACE(("HyStart: RTT increased to %" B_PRIdBIGTIME " us\n",
+				fRoundMinRoundTripTime));
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+void
+HyStart::Dump() const
+{
+	kprintf("  hystart: round end %" B_PRIu32 ", %" B_PRId32 " samples, "
+		"round min RTT %" B_PRIdBIGTIME "\n", fRoundEnd.Number(),
+		fSampleCount, fRoundMinRoundTripTime);
+}
+
+
+//	#pragma mark - CUBIC
+
+
+CubicCongestionControl::CubicCongestionControl()
+{
+	Reset();
+}
+
+
+void
+CubicCongestionControl::Reset()
+{
+	fHyStart.Reset();
+	fMaxWindow = 0;
+	fLastMaxWindow = 0;
+	fOriginWindow = 0;
+	fFriendlyWindow = 0;
+	fEpochStart = 0;
+	fK = 0;
+	fIncrementRemainder = 0;
+	fMinRoundTripTime = 0;
+}
+
+
+void
+CubicCongestionControl::Acknowledged(uint32& congestionWindow,
+	uint32& slowStartThreshold, uint32 bytesAcknowledged,
+	uint32 maxSegmentSize, tcp_sequence acknowledge, tcp_sequence sendNext,
+	bigtime_t roundTripTime)
+{
+	if (congestionWindow == 0)
+		return;
+
+	if (roundTripTime > 0
+		&& (fMinRoundTripTime == 0 || roundTripTime < fMinRoundTripTime))
+		fMinRoundTripTime = roundTripTime;
+
+	if (congestionWindow < slowStartThreshold) {
+		if (fHyStart.ShouldExit(congestionWindow, maxSegmentSize,
+				acknowledge, sendNext, roundTripTime, fMinRoundTripTime)) {
+			slowStartThreshold = congestionWindow;
+			return;
+		}
+
+		congestionWindow += min_c(bytesAcknowledged, maxSegmentSize);
+		return;
+	}
+
+	if (fEpochStart == 0)
+		_StartEpoch(congestionWindow, maxSegmentSize);
+
+	// W_cubic(t + RTT) = C * (t + RTT - K)^3 + W_max
+	int64 time = (system_time() - fEpochStart + fMinRoundTripTime) / 1000;
+	int64 offset = time - fK;
+	if (offset > kCubicMaxTime)
+		offset = kCubicMaxTime;
+	else if (offset < -kCubicMaxTime)
+		offset = -kCubicMaxTime;
+
+	// C = 0.4 segments/s^3, and the time is in ms
+	int64 delta = offset * offset * offset / 1000 * 2 * maxSegmentSize
+		/ 5000000;
+	int64 target = (int64)fOriginWindow + delta;
+
+	// the window standard TCP would have reached (the TCP friendly region)
+	fFriendlyWindow += (uint64)kCubicAlphaPermille * bytesAcknowledged
+		* maxSegmentSize / (1000ULL * congestionWindow);
+	if (target < (int64)fFriendlyWindow)
+		target = fFriendlyWindow;
+
+	if (target > congestionWindow + congestionWindow / 2)
+		target = congestionWindow + congestionWindow / 2;
+	if (target <= (int64)congestionWindow)
+		return;
+
+	// grow by (target - cwnd) / cwnd for each acknowledged byte
+	fIncrementRemainder += (uint64)(target - congestionWindow)
+		* bytesAcknowledged;
+	congestionWindow += fIncrementRemainder / congestionWindow;
+	fIncrementRemainder %= congestionWindow;
+}
+
+
+uint32
+CubicCongestionControl::LossDetected(uint32 congestionWindow,
+	uint32 flightSize, uint32 maxSegmentSize, bool timeout)
+{
+	// after a timeout, the window has usually been collapsed already
+	uint32 window = timeout ? max_c(congestionWindow, flightSize)
+		: congestionWindow;
+
+	// fast convergence: release bandwidth to new flows
+	if (window < fLastMaxWindow)
+		fMaxWindow = (uint64)window * kCubicFastConvergencePercent / 100;
+	else
+		fMaxWindow = window;
+	fLastMaxWindow = window;
+
+	fEpochStart = 0;
+	fHyStart.Reset();
+
+	return max_c((uint64)window * kCubicBetaPercent / 100,
+		2 * maxSegmentSize);
+}
+
+
+void
+CubicCongestionControl::Dump() const
+{
+	CongestionControl::Dump();
+	kprintf("  cubic: W_max %" B_PRIu32 ", origin %" B_PRIu32 ", K %" B_PRId32
+		" ms, epoch %" B_PRIdBIGTIME ", W_est %" B_PRIu32 ", min RTT %"
+		B_PRIdBIGTIME " us\n", fMaxWindow, fOriginWindow, fK, fEpochStart,
+		fFriendlyWindow, fMinRoundTripTime);
+	fHyStart.Dump();
+}
+
+
+void
+CubicCongestionControl::_StartEpoch(uint32 congestionWindow,
+	uint32 maxSegmentSize)
+{
+	fEpochStart = system_time();
+	fIncrementRemainder = 0;
+	fFriendlyWindow = congestionWindow;
+
+	if (congestionWindow < fMaxWindow) {
+		// K = cbrt((W_max - cwnd) / C), in ms
+		fK = cube_root((uint64)(fMaxWindow - congestionWindow) * 2500000000ULL
+			/ maxSegmentSize);
+		fOriginWindow = fMaxWindow;
+	} else {
+		fK = 0;
+		fOriginWindow = congestionWindow;
+	}
+
+	TRACE(("CUBIC: new epoch, cwnd %" B_PRIu32 ", W_max %" B_PRIu32 ", K %"
+		B_PRId32 " ms\n", congestionWindow, fMaxWindow, fK));
+}
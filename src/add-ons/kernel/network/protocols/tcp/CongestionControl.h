@@ -0,0 +1,59 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef CONGESTION_CONTROL_H
+#define CONGESTION_CONTROL_H
+
+
+#include "tcp.h"
+
+
+/*!	Interface of a TCP congestion control algorithm.
+
+	The endpoint owns the congestion window and the slow start threshold, and
+	still takes care of the loss recovery mechanics (fast retransmit, window
+	inflation, SACK recovery). The algorithm only decides how the window grows
+	when new data is acknowledged, and how far it is reduced on a loss.
+	All hooks are called with the endpoint lock held.
+*/
+class CongestionControl {
+public:
+	virtual						~CongestionControl();
+
+	virtual	const char*			Name() const = 0;
+
+	//!	Forgets all state, as on a new connection.
+	virtual	void				Reset() = 0;
+
+	/*!	Called for every ACK that acknowledges new data outside of loss
+		recovery. \a roundTripTime is the RTT sample taken from this ACK in
+		microseconds, or \c -1 if there is none.
+	*/
+	virtual	void				Acknowledged(uint32& congestionWindow,
+									uint32& slowStartThreshold,
+									uint32 bytesAcknowledged,
+									uint32 maxSegmentSize,
+									tcp_sequence acknowledge,
+									tcp_sequence sendNext,
+									bigtime_t roundTripTime) = 0;
+
+	/*!	Called when a loss has been detected, either by duplicate ACKs or by
+		the retransmission timer. Returns the new slow start threshold.
+	*/
+	virtual	uint32				LossDetected(uint32 congestionWindow,
+									uint32 flightSize,
+									uint32 maxSegmentSize,
+									bool timeout) = 0;
+
+	virtual	void				Dump() const;
+
+	static	CongestionControl*	Create(const char* name);
+	static	const char*			NameAt(int32 index);
+
+	static	status_t			SetDefault(const char* name);
+	static	const char*			Default();
+};
+
+
+#endif	// CONGESTION_CONTROL_H
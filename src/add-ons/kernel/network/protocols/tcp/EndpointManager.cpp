@@ -1,5 +1,5 @@
 /*
- * Copyright 2006-2009, Haiku, Inc. All Rights Reserved.
+ * Copyright 2006-2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -10,13 +10,17 @@
 
 #include "EndpointManager.h"
 
+#include <netinet/tcp.h>
 #include <new>
+#include <string.h>
 #include <unistd.h>
 
 #include <KernelExport.h>
 
 #include <NetUtilities.h>
 #include <tracing.h>
+#include <util/list.h>
+#include <util/Random.h>
 
 #include "TCPEndpoint.h"
 
@@ -133,6 +137,92 @@ protected:
 static const uint16 kLastReservedPort = 1023;
 static const uint16 kFirstEphemeralPort = 40000;
 
+static const uint8 kSynCacheMaxRetransmits = 3;
+
+// SYN cookies carry the index of the peer's maximum segment size in their
+// lowest bits, followed by the parity of the period they were created in,
+// and a keyed hash of the connection.
+static const bigtime_t kSynCookiePeriod = 64000000LL;	// 64 secs
+static const uint32 kSynCookieDataMask = 0x3;
+static const uint32 kSynCookieParityShift = 2;
+static const uint32 kSynCookieHashMask = ~0x7U;
+static const uint16 kSynCookieSegmentSizes[] = {536, 1220, 1440, 1460};
+
+static uint32 sMaxTimeWaitEntries = 4096;
+static uint32 sMaxSynCacheEntries = 1024;
+static bool sSynCookies = true;
+
+
+static inline uint64
+rotate_left(uint64 value, int bits)
+{
+	return (value << bits) | (value >> (64 - bits));
+}
+
+
+static inline void
+sip_round(uint64& v0, uint64& v1, uint64& v2, uint64& v3)
+{
+	v0 += v1;
+	v1 = rotate_left(v1, 13) ^ v0;
+	v0 = rotate_left(v0, 32);
+	v2 += v3;
+	v3 = rotate_left(v3, 16) ^ v2;
+	v0 += v3;
+	v3 = rotate_left(v3, 21) ^ v0;
+	v2 += v1;
+	v1 = rotate_left(v1, 17) ^ v2;
+	v2 = rotate_left(v2, 32);
+}
+
+
+/*!	SipHash-2-4 of \a count 64 bit words, keyed with \a key. */
+static uint64
+sip_hash(const uint64* key, const uint64* words, int count)
+{
+	uint64 v0 = key[0] ^ 0x736f6d6570736575ULL;
+	uint64 v1 = key[1] ^ 0x646f72616e646f6dULL;
+	uint64 v2 = key[0] ^ 0x6c7967656e657261ULL;
+	uint64 v3 = key[1] ^ 0x7465646279746573ULL;
+
+	for (int i = 0; i < count; i++) {
+		v3 ^= words[i];
+		sip_round(v0, v1, v2, v3);
+		sip_round(v0, v1, v2, v3);
+		v0 ^= words[i];
+	}
+
+	uint64 last = (uint64)(count * 8) << 56;
+	v3 ^= last;
+	sip_round(v0, v1, v2, v3);
+	sip_round(v0, v1, v2, v3);
+	v0 ^= last;
+
+	v2 ^= 0xff;
+	for (int i = 0; i < 4; i++)
+		sip_round(v0, v1, v2, v3);
+
+	return v0 ^ v1 ^ v2 ^ v3;
+}
+
+
+static inline uint32
+syn_cookie_period()
+{
+	return system_time() / kSynCookiePeriod;
+}
+
+
+static inline bool
+copy_address(compact_address& target, const sockaddr* address)
+{
+	if (address->sa_len > sizeof(compact_address))
+		return false;
+
+	memcpy(&target, address, address->sa_len);
+	return true;
+}
+
 
 ConnectionHashDefinition::ConnectionHashDefinition(EndpointManager* manager)
 	:
@@ -214,18 +304,78 @@ EndpointHashDefinition::GetLink(TCPEndpoint* endpoint) const
 //	#pragma mark -
 
 
+template<typename Entry>
+size_t
+CachedConnectionHashDefinition<Entry>::HashKey(const KeyType& key) const
+{
+	return ConstSocketAddress(fManager->AddressModule(),
+		key.first).HashPair(key.second);
+}
+
+
+template<typename Entry>
+size_t
+CachedConnectionHashDefinition<Entry>::Hash(Entry* entry) const
+{
+	return HashKey(std::make_pair(&entry->local.address,
+		&entry->peer.address));
+}
+
+
+template<typename Entry>
+bool
+CachedConnectionHashDefinition<Entry>::Compare(const KeyType& key,
+	Entry* entry) const
+{
+	return ConstSocketAddress(fManager->AddressModule(),
+			&entry->local.address).EqualTo(key.first, true)
+		&& ConstSocketAddress(fManager->AddressModule(),
+			&entry->peer.address).EqualTo(key.second, true);
+}
+
+
+//	#pragma mark -
+
+
 EndpointManager::EndpointManager(net_domain* domain)
 	:
 	fDomain(domain),
 	fConnectionHash(this),
-	fLastPort(kFirstEphemeralPort)
+	fLastPort(kFirstEphemeralPort),
+	fTimeWaitHash(this),
+	fSynCacheHash(this)
 {
 	rw_lock_init(&fLock, "TCP endpoint manager");
+	mutex_init(&fCacheLock, "TCP connection caches");
+
+	gStackModule->init_timer(&fTimeWaitTimer, &_TimeWaitTimer, this);
+	gStackModule->init_timer(&fSynCacheTimer, &_SynCacheTimer, this);
+
+	fSynCookieSecret[0] = secure_get_random<uint64>();
+	fSynCookieSecret[1] = secure_get_random<uint64>();
+
+	memset(&fStatistics, 0, sizeof(fStatistics));
 }
 
 
 EndpointManager::~EndpointManager()
 {
+	mutex_lock(&fCacheLock);
+
+	// once the lists are empty, the timers won't reschedule themselves
+	while (time_wait_entry* entry = fTimeWaitList.Head())
+		_RemoveTimeWait(entry);
+	while (syn_cache_entry* entry = fSynCacheList.Head())
+		_RemoveSynCacheEntry(entry);
+
+	mutex_unlock(&fCacheLock);
+
+	gStackModule->cancel_timer(&fTimeWaitTimer);
+	gStackModule->cancel_timer(&fSynCacheTimer);
+	gStackModule->wait_for_timer(&fTimeWaitTimer);
+	gStackModule->wait_for_timer(&fSynCacheTimer);
+
+	mutex_destroy(&fCacheLock);
 	rw_lock_destroy(&fLock);
 }
 
@@ -236,11 +386,29 @@ EndpointManager::Init()
 	status_t status = fConnectionHash.Init();
 	if (status == B_OK)
 		status = fEndpointHash.Init();
+	if (status == B_OK)
+		status = fTimeWaitHash.Init();
+	if (status == B_OK)
+		status = fSynCacheHash.Init();
 
 	return status;
 }
 
 
+/*!	Sets the maximum number of entries of the TIME_WAIT table and the SYN
+	cache, per domain, and whether or not SYN cookies are used when the SYN
+	cache is full.
+*/
+/*static*/ void
+EndpointManager::SetCacheLimits(uint32 timeWaitEntries,
+	uint32 synCacheEntries, bool synCookies)
+{
+	sMaxTimeWaitEntries = timeWaitEntries;
+	sMaxSynCacheEntries = max_c(synCacheEntries, 1);
+	sSynCookies = synCookies;
+}
+
+
 //	#pragma mark - connections
 
 
@@ -277,6 +445,11 @@ EndpointManager::SetConnection(TCPEndpoint* endpoint, const sockaddr* _local,
 	if (_LookupConnection(*local, peer) != NULL)
 		return EADDRINUSE;
 
+	// A connection in TIME_WAIT is superseded by the new one, as our initial
+	// sequence number is always larger than what the old one used. A pending
+	// connection request has been answered by the endpoint being created.
+	_RemoveCachedConnections(*local, peer);
+
 	endpoint->LocalAddress().SetTo(*local);
 	endpoint->PeerAddress().SetTo(peer);
 	T(Connect(endpoint));
@@ -457,6 +630,10 @@ EndpointManager::_BindToAddress(WriteLocker& locker, TCPEndpoint* endpoint,
 		}
 	} while (retry-- > 0);
 
+	if ((endpoint->socket->options & SO_REUSEADDR) == 0
+		&& _IsInTimeWait(*address))
+		return EADDRINUSE;
+
 	return _Bind(endpoint, *address);
 }
 
@@ -550,13 +727,6 @@ EndpointManager::ReplyWithReset(tcp_segment_header& segment, net_buffer* buffer)
 {
 	TRACE(("TCP: Sending RST...\n"));
 
-	net_buffer* reply = gBufferModule->create(512);
-	if (reply == NULL)
-		return B_NO_MEMORY;
-
-	AddressModule()->set_to(reply->source, buffer->destination);
-	AddressModule()->set_to(reply->destination, buffer->source);
-
 	tcp_segment_header outSegment(TCP_FLAG_RESET);
 	outSegment.sequence = 0;
 	outSegment.acknowledge = 0;
@@ -572,10 +742,42 @@ EndpointManager::ReplyWithReset(tcp_segment_header& segment, net_buffer* buffer)
 	} else
 		outSegment.sequence = segment.acknowledge;
 
-	status_t status = add_tcp_header(AddressModule(), outSegment, reply);
-	if (status == B_OK)
-		status = Domain()->module->send_data(NULL, reply);
+	net_buffer* reply = _CreateReply(buffer->destination, buffer->source,
+		outSegment);
+	if (reply == NULL)
+		return B_NO_MEMORY;
+
+	return _SendReply(reply);
+}
+
+
+/*!	Creates a segment without any data from \a local to \a peer that does
+	not belong to any endpoint.
+*/
+net_buffer*
+EndpointManager::_CreateReply(const sockaddr* local, const sockaddr* peer,
+	tcp_segment_header& segment)
+{
+	net_buffer* reply = gBufferModule->create(512);
+	if (reply == NULL)
+		return NULL;
+
+	AddressModule()->set_to(reply->source, local);
+	AddressModule()->set_to(reply->destination, peer);
+
+	if (add_tcp_header(AddressModule(), segment, reply) != B_OK) {
+		gBufferModule->free(reply);
+		return NULL;
+	}
 
+	return reply;
+}
+
+
+status_t
+EndpointManager::_SendReply(net_buffer* reply)
+{
+	status_t status = Domain()->module->send_data(NULL, reply);
 	if (status != B_OK)
 		gBufferModule->free(reply);
 
@@ -583,6 +785,571 @@ EndpointManager::ReplyWithReset(tcp_segment_header& segment, net_buffer* buffer)
 }
 
 
+/*!	Removes the TIME_WAIT and SYN cache entries of the connection, if any.
+	You must have fLock write locked when calling this method.
+*/
+void
+EndpointManager::_RemoveCachedConnections(const sockaddr* local,
+	const sockaddr* peer)
+{
+	MutexLocker _(fCacheLock);
+
+	time_wait_entry* timeWait = fTimeWaitHash.Lookup(
+		std::make_pair(local, peer));
+	if (timeWait != NULL) {
+		_RemoveTimeWait(timeWait);
+		fStatistics.time_wait_recycled++;
+	}
+
+	syn_cache_entry* synCache = fSynCacheHash.Lookup(
+		std::make_pair(local, peer));
+	if (synCache != NULL) {
+		_RemoveSynCacheEntry(synCache);
+		fStatistics.syn_cache_completed++;
+	}
+}
+
+
+//	#pragma mark - TIME_WAIT
+
+
+/*!	Takes over a connection in TIME_WAIT state from its endpoint, so that the
+	endpoint can go away before the 2MSL timeout has passed. If the table is
+	full, the connection that would have expired next is forgotten about.
+*/
+status_t
+EndpointManager::EnterTimeWait(const sockaddr* local, const sockaddr* peer,
+	tcp_sequence sendNext, tcp_sequence receiveNext, uint16 advertisedWindow,
+	bool timestamps, uint32 timestampRecent)
+{
+	if (sMaxTimeWaitEntries == 0)
+		return B_NOT_ALLOWED;
+
+	time_wait_entry* entry = new(std::nothrow) time_wait_entry;
+	if (entry == NULL)
+		return B_NO_MEMORY;
+
+	if (!copy_address(entry->local, local)
+		|| !copy_address(entry->peer, peer)) {
+		delete entry;
+		return B_BAD_VALUE;
+	}
+
+	entry->expires = system_time() + (TCP_MAX_SEGMENT_LIFETIME << 1);
+	entry->send_next = sendNext.Number();
+	entry->receive_next = receiveNext.Number();
+	entry->timestamp_recent = timestampRecent;
+	entry->advertised_window = advertisedWindow;
+	entry->timestamps = timestamps;
+
+	MutexLocker _(fCacheLock);
+
+	time_wait_entry* previous = fTimeWaitHash.Lookup(
+		std::make_pair(local, peer));
+	if (previous != NULL)
+		_RemoveTimeWait(previous);
+	else if (fTimeWaitHash.CountElements() >= sMaxTimeWaitEntries) {
+		_RemoveTimeWait(fTimeWaitList.Head());
+		fStatistics.time_wait_evicted++;
+	}
+
+	status_t status = fTimeWaitHash.Insert(entry);
+	if (status != B_OK) {
+		delete entry;
+		return status;
+	}
+
+	if (fTimeWaitList.IsEmpty()) {
+		gStackModule->set_timer(&fTimeWaitTimer,
+			TCP_MAX_SEGMENT_LIFETIME << 1);
+	}
+	fTimeWaitList.Add(entry);
+	fStatistics.time_wait_entered++;
+
+	return B_OK;
+}
+
+
+/*!	Handles a segment for a connection in the TIME_WAIT table, if there is
+	one. Returns \c false if the segment has to be looked at by a listening
+	endpoint instead; that is the case for unknown connections, and for new
+	connection requests that may reuse the connection.
+*/
+bool
+EndpointManager::TimeWaitSegmentReceived(tcp_segment_header& segment,
+	net_buffer* buffer, int32& _action)
+{
+	MutexLocker locker(fCacheLock);
+
+	time_wait_entry* entry = fTimeWaitHash.Lookup(
+		std::make_pair(buffer->destination, buffer->source));
+	if (entry == NULL)
+		return false;
+
+	_action = DROP;
+
+	// We generally ignore resets in time wait state (see RFC 1337)
+	if ((segment.flags & TCP_FLAG_RESET) != 0)
+		return true;
+
+	bool hasTimestamp = entry->timestamps
+		&& (segment.options & TCP_HAS_TIMESTAMPS) != 0;
+
+	if ((segment.flags & TCP_FLAG_SYNCHRONIZE) != 0) {
+		// A new connection may be accepted if its segments cannot be confused
+		// with those of the old one (RFC 1122, 4.2.2.13, and RFC 6191)
+		bool newer = hasTimestamp
+			? (int32)(segment.timestamp_value - entry->timestamp_recent) > 0
+			: tcp_sequence(segment.sequence) > tcp_sequence(entry->receive_next);
+		if (newer && (segment.flags & TCP_FLAG_ACKNOWLEDGE) == 0) {
+			_RemoveTimeWait(entry);
+			fStatistics.time_wait_recycled++;
+			return false;
+		}
+	} else if (buffer->size == 0 && (segment.flags & TCP_FLAG_FINISH) == 0) {
+		// nothing to acknowledge
+		return true;
+	}
+
+	if ((segment.flags & TCP_FLAG_FINISH) != 0) {
+		// our last acknowledgement got lost, restart the 2MSL timeout
+		entry->expires = system_time() + (TCP_MAX_SEGMENT_LIFETIME << 1);
+		fTimeWaitList.Remove(entry);
+		fTimeWaitList.Add(entry);
+	}
+
+	if (hasTimestamp
+		&& (int32)(segment.timestamp_value - entry->timestamp_recent) > 0)
+		entry->timestamp_recent = segment.timestamp_value;
+
+	tcp_segment_header acknowledge(TCP_FLAG_ACKNOWLEDGE);
+	acknowledge.sequence = entry->send_next;
+	acknowledge.acknowledge = entry->receive_next;
+	acknowledge.advertised_window = entry->advertised_window;
+	acknowledge.urgent_offset = 0;
+	if (entry->timestamps) {
+		acknowledge.options |= TCP_HAS_TIMESTAMPS;
+		acknowledge.timestamp_value = tcp_now();
+		acknowledge.timestamp_reply = entry->timestamp_recent;
+	}
+
+	net_buffer* reply = _CreateReply(&entry->local.address,
+		&entry->peer.address, acknowledge);
+
+	locker.Unlock();
+
+	if (reply != NULL)
+		_SendReply(reply);
+
+	return true;
+}
+
+
+/*!	Returns whether or not a connection in the TIME_WAIT table uses the
+	local \a address.
+	This has to walk the whole table, but is only needed when binding to a
+	specific port without SO_REUSEADDR.
+*/
+bool
+EndpointManager::_IsInTimeWait(const sockaddr* _address)
+{
+	ConstSocketAddress address(AddressModule(), _address);
+	uint16 port = address.Port();
+
+	MutexLocker _(fCacheLock);
+
+	TimeWaitList::Iterator iterator = fTimeWaitList.GetIterator();
+	while (time_wait_entry* entry = iterator.Next()) {
+		if (AddressModule()->get_port(&entry->local.address) == port
+			&& (address.IsEmpty(false)
+				|| address.EqualTo(&entry->local.address, false)))
+			return true;
+	}
+
+	return false;
+}
+
+
+void
+EndpointManager::_RemoveTimeWait(time_wait_entry* entry)
+{
+	fTimeWaitHash.RemoveUnchecked(entry);
+	fTimeWaitList.Remove(entry);
+	delete entry;
+}
+
+
+/*static*/ void
+EndpointManager::_TimeWaitTimer(net_timer* timer, void* _manager)
+{
+	EndpointManager* manager = (EndpointManager*)_manager;
+	MutexLocker _(manager->fCacheLock);
+
+	bigtime_t now = system_time();
+
+	while (time_wait_entry* entry = manager->fTimeWaitList.Head()) {
+		if (entry->expires > now) {
+			gStackModule->set_timer(timer, entry->expires - now);
+			break;
+		}
+
+		manager->_RemoveTimeWait(entry);
+		manager->fStatistics.time_wait_expired++;
+	}
+}
+
+
+//	#pragma mark - SYN cache
+
+
+/*!	Answers the connection request of \a segment in place of the
+	\a listener, without creating an endpoint for it yet. If the SYN cache is
+	full, the state of the connection is encoded in the initial sequence
+	number of the reply instead (a SYN cookie), if allowed.
+	You must hold the \a listener's lock when calling this method.
+*/
+int32
+EndpointManager::SynReceived(TCPEndpoint* listener,
+	tcp_segment_header& segment, net_buffer* buffer)
+{
+	const sockaddr* local = buffer->destination;
+	const sockaddr* peer = buffer->source;
+
+	uint16 receiveMaxSegmentSize = listener->_MaxSegmentSize(peer);
+	uint16 receiveWindow = min_c(listener->socket->receive.buffer_size,
+		TCP_MAX_WINDOW);
+
+	MutexLocker locker(fCacheLock);
+
+	syn_cache_entry* entry = fSynCacheHash.Lookup(std::make_pair(local, peer));
+	if (entry == NULL) {
+		if (fSynCacheHash.CountElements() >= sMaxSynCacheEntries) {
+			if (sSynCookies) {
+				net_buffer* reply = _CreateSynCookie(segment, buffer,
+					receiveMaxSegmentSize, receiveWindow);
+				locker.Unlock();
+
+				if (reply != NULL)
+					_SendReply(reply);
+				return DROP;
+			}
+
+			_RemoveSynCacheEntry(fSynCacheList.Head());
+			fStatistics.syn_cache_evicted++;
+		}
+
+		entry = new(std::nothrow) syn_cache_entry;
+		if (entry == NULL)
+			return DROP;
+
+		if (!copy_address(entry->local, local)
+			|| !copy_address(entry->peer, peer)
+			|| fSynCacheHash.Insert(entry) != B_OK) {
+			delete entry;
+			return DROP;
+		}
+
+		entry->initial_receive_sequence = segment.sequence + 1;
+			// makes sure the entry is initialized below
+		fStatistics.syn_cache_added++;
+	} else
+		fSynCacheList.Remove(entry);
+
+	if (entry->initial_receive_sequence != segment.sequence) {
+		// this is not just a retransmission of the SYN we already know about
+		entry->initial_send_sequence = system_time() >> 4;
+		entry->initial_receive_sequence = segment.sequence;
+		entry->retransmits = 0;
+
+		entry->options = 0;
+		if ((listener->fOptions & TCP_NOOPT) == 0) {
+			entry->options = segment.options & (TCP_HAS_WINDOW_SCALE
+				| TCP_HAS_TIMESTAMPS | TCP_SACK_PERMITTED);
+		}
+
+		entry->send_window_shift = segment.window_shift;
+		entry->receive_window_shift = 0;
+		if ((entry->options & TCP_HAS_WINDOW_SCALE) != 0) {
+			while (entry->receive_window_shift < TCP_MAX_WINDOW_SHIFT
+				&& (0xffffUL << entry->receive_window_shift)
+					< listener->socket->receive.buffer_size) {
+				entry->receive_window_shift++;
+			}
+		}
+
+		entry->advertised_window = segment.advertised_window;
+		entry->max_segment_size = segment.max_segment_size;
+		entry->receive_max_segment_size = receiveMaxSegmentSize;
+		entry->receive_window = receiveWindow;
+	}
+
+	entry->timestamp_recent = segment.timestamp_value;
+	entry->due = system_time() + (TCP_INITIAL_RTT << entry->retransmits);
+	_InsertSynCacheEntry(entry);
+
+	net_buffer* reply = _CreateSynAcknowledge(entry);
+
+	locker.Unlock();
+
+	if (reply != NULL)
+		_SendReply(reply);
+
+	return DROP;
+}
+
+
+/*!	Looks up the pending connection that the acknowledgement in \a segment
+	completes, and copies its state to \a _entry. The entry is removed once the
+	connection has been established.
+	You must hold the listener's lock when calling this method.
+*/
+bool
+EndpointManager::LookupSynCache(tcp_segment_header& segment,
+	net_buffer* buffer, syn_cache_entry& _entry)
+{
+	MutexLocker _(fCacheLock);
+
+	syn_cache_entry* entry = fSynCacheHash.Lookup(
+		std::make_pair(buffer->destination, buffer->source));
+	if (entry == NULL)
+		return sSynCookies && _CheckSynCookie(segment, buffer, _entry);
+
+	tcp_sequence receiveNext = entry->initial_receive_sequence + 1;
+	if (segment.acknowledge != entry->initial_send_sequence + 1
+		|| tcp_sequence(segment.sequence) < receiveNext
+		|| tcp_sequence(segment.sequence)
+			>= receiveNext + ((uint32)entry->receive_window
+				<< entry->receive_window_shift)) {
+		return false;
+	}
+
+	_entry = *entry;
+	return true;
+}
+
+
+/*!	Forgets about a pending connection if \a segment is a valid reset for it.
+*/
+void
+EndpointManager::SynCacheReset(tcp_segment_header& segment,
+	net_buffer* buffer)
+{
+	MutexLocker _(fCacheLock);
+
+	syn_cache_entry* entry = fSynCacheHash.Lookup(
+		std::make_pair(buffer->destination, buffer->source));
+	if (entry != NULL
+		&& segment.sequence == entry->initial_receive_sequence + 1) {
+		_RemoveSynCacheEntry(entry);
+		fStatistics.syn_cache_reset++;
+	}
+}
+
+
+void
+EndpointManager::_InsertSynCacheEntry(syn_cache_entry* entry)
+{
+	syn_cache_entry* previous = fSynCacheList.Tail();
+	while (previous != NULL && previous->due > entry->due)
+		previous = fSynCacheList.GetPrevious(previous);
+
+	fSynCacheList.InsertAfter(previous, entry);
+
+	if (fSynCacheList.Head() == entry) {
+		gStackModule->set_timer(&fSynCacheTimer,
+			max_c(entry->due - system_time(), 0));
+	}
+}
+
+
+void
+EndpointManager::_RemoveSynCacheEntry(syn_cache_entry* entry)
+{
+	fSynCacheHash.RemoveUnchecked(entry);
+	fSynCacheList.Remove(entry);
+	delete entry;
+}
+
+
+net_buffer*
+EndpointManager::_CreateSynAcknowledge(syn_cache_entry* entry)
+{
+	tcp_segment_header segment(TCP_FLAG_SYNCHRONIZE | TCP_FLAG_ACKNOWLEDGE);
+	segment.sequence = entry->initial_send_sequence;
+	segment.acknowledge = entry->initial_receive_sequence + 1;
+	segment.advertised_window = entry->receive_window;
+	segment.urgent_offset = 0;
+	segment.max_segment_size = entry->receive_max_segment_size;
+
+	if ((entry->options & TCP_HAS_WINDOW_SCALE) != 0) {
+		segment.options |= TCP_HAS_WINDOW_SCALE;
+		segment.window_shift = entry->receive_window_shift;
+	}
+	if ((entry->options & TCP_HAS_TIMESTAMPS) != 0) {
+		segment.options |= TCP_HAS_TIMESTAMPS;
+		segment.timestamp_value = tcp_now();
+		segment.timestamp_reply = entry->timestamp_recent;
+	}
+	if ((entry->options & TCP_SACK_PERMITTED) != 0)
+		segment.options |= TCP_SACK_PERMITTED;
+
+	return _CreateReply(&entry->local.address, &entry->peer.address, segment);
+}
+
+
+uint32
+EndpointManager::_SynCookie(const sockaddr* local, const sockaddr* peer,
+	uint32 sequence, uint32 period, uint32 data) const
+{
+	uint64 words[5];
+	int count;
+
+	words[0] = ((uint64)AddressModule()->get_port(local) << 48)
+		| ((uint64)AddressModule()->get_port(peer) << 32) | period;
+
+	if (local->sa_family == AF_INET6) {
+		memcpy(&words[1], &((const sockaddr_in6*)local)->sin6_addr, 16);
+		memcpy(&words[3], &((const sockaddr_in6*)peer)->sin6_addr, 16);
+		count = 5;
+	} else {
+		words[1] = ((uint64)((const sockaddr_in*)local)->sin_addr.s_addr << 32)
+			| ((const sockaddr_in*)peer)->sin_addr.s_addr;
+		count = 2;
+	}
+
+	// the sequence number and the data are covered by the hash, too, so that
+	// neither can be forged
+	words[count - 1] ^= ((uint64)data << 32) | sequence;
+
+	uint32 hash = (uint32)sip_hash(fSynCookieSecret, words, count);
+	return (hash & kSynCookieHashMask)
+		| ((period & 1) << kSynCookieParityShift) | data;
+}
+
+
+/*!	Creates a SYN+ACK that keeps the state of the connection in its sequence
+	number. Only the peer's maximum segment size can be remembered that way,
+	so the reply offers no other options.
+*/
+net_buffer*
+EndpointManager::_CreateSynCookie(tcp_segment_header& segment,
+	net_buffer* buffer, uint16 receiveMaxSegmentSize, uint16 receiveWindow)
+{
+	uint16 maxSegmentSize = segment.max_segment_size > 0
+		? segment.max_segment_size : TCP_DEFAULT_MAX_SEGMENT_SIZE;
+
+	uint32 data = 0;
+	while (data + 1 < B_COUNT_OF(kSynCookieSegmentSizes)
+		&& kSynCookieSegmentSizes[data + 1] <= maxSegmentSize)
+		data++;
+
+	tcp_segment_header reply(TCP_FLAG_SYNCHRONIZE | TCP_FLAG_ACKNOWLEDGE);
+	reply.sequence = _SynCookie(buffer->destination, buffer->source,
+		segment.sequence, syn_cookie_period(), data);
+	reply.acknowledge = segment.sequence + 1;
+	reply.advertised_window = receiveWindow;
+	reply.urgent_offset = 0;
+	reply.max_segment_size = receiveMaxSegmentSize;
+
+	fStatistics.syn_cookies_sent++;
+
+	return _CreateReply(buffer->destination, buffer->source, reply);
+}
+
+
+/*!	Checks if \a segment acknowledges a SYN cookie from the current or the
+	previous period, and reconstructs the pending connection from it.
+*/
+bool
+EndpointManager::_CheckSynCookie(tcp_segment_header& segment,
+	net_buffer* buffer, syn_cache_entry& _entry)
+{
+	uint32 cookie = segment.acknowledge - 1;
+	uint32 sequence = segment.sequence - 1;
+	uint32 data = cookie & kSynCookieDataMask;
+
+	uint32 period = syn_cookie_period();
+	if (((cookie >> kSynCookieParityShift) & 1) != (period & 1))
+		period--;
+
+	if (data >= B_COUNT_OF(kSynCookieSegmentSizes)
+		|| _SynCookie(buffer->destination, buffer->source, sequence, period,
+			data) != cookie) {
+		fStatistics.syn_cookies_rejected++;
+		return false;
+	}
+
+	// a cookie only encodes some of what the SYN cache keeps
+	_entry = syn_cache_entry();
+	_entry.initial_send_sequence = cookie;
+	_entry.initial_receive_sequence = sequence;
+	_entry.advertised_window = segment.advertised_window;
+	_entry.max_segment_size = kSynCookieSegmentSizes[data];
+
+	fStatistics.syn_cookies_accepted++;
+	return true;
+}
+
+
+/*static*/ void
+EndpointManager::_SynCacheTimer(net_timer* timer, void* _manager)
+{
+	EndpointManager* manager = (EndpointManager*)_manager;
+
+	struct list replies;
+	list_init_etc(&replies, offsetof(net_buffer, link));
+
+	MutexLocker locker(manager->fCacheLock);
+
+	bigtime_t now = system_time();
+
+	while (syn_cache_entry* entry = manager->fSynCacheList.Head()) {
+		if (entry->due > now) {
+			gStackModule->set_timer(timer, entry->due - now);
+			break;
+		}
+
+		if (entry->retransmits >= kSynCacheMaxRetransmits) {
+			manager->_RemoveSynCacheEntry(entry);
+			manager->fStatistics.syn_cache_timed_out++;
+			continue;
+		}
+
+		// the peer did not get our SYN+ACK, send it again
+		entry->retransmits++;
+		entry->due = now + (TCP_INITIAL_RTT << entry->retransmits);
+		manager->fSynCacheList.Remove(entry);
+		manager->_InsertSynCacheEntry(entry);
+		manager->fStatistics.syn_cache_retransmits++;
+
+		net_buffer* reply = manager->_CreateSynAcknowledge(entry);
+		if (reply != NULL)
+			list_add_item(&replies, reply);
+	}
+
+	locker.Unlock();
+
+	while (net_buffer* reply = (net_buffer*)list_remove_head_item(&replies))
+		manager->_SendReply(reply);
+}
+
+
+//	#pragma mark -
+
+
+void
+EndpointManager::GetStatistics(tcp_stat& stat)
+{
+	MutexLocker _(fCacheLock);
+
+	stat = fStatistics;
+	stat.time_wait_count = fTimeWaitHash.CountElements();
+	stat.time_wait_limit = sMaxTimeWaitEntries;
+	stat.syn_cache_count = fSynCacheHash.CountElements();
+	stat.syn_cache_limit = sMaxSynCacheEntries;
+}
+
+
 void
 EndpointManager::Dump() const
 {
@@ -603,5 +1370,33 @@ EndpointManager::Dump() const
 			endpoint->fReceiveQueue.Available(), endpoint->fSendQueue.Used(),
 			name_for_state(endpoint->State()));
 	}
+
+	TimeWaitList::ConstIterator timeWaitIterator
+		= fTimeWaitList.GetIterator();
+	while (time_wait_entry* entry = timeWaitIterator.Next()) {
+		char localBuf[64], peerBuf[64];
+		ConstSocketAddress(AddressModule(), &entry->local.address).AsString(
+			localBuf, sizeof(localBuf), true);
+		ConstSocketAddress(AddressModule(), &entry->peer.address).AsString(
+			peerBuf, sizeof(peerBuf), true);
+
+		kprintf("%p %21s %21s %8s %8s %12s\n", entry, localBuf, peerBuf, "-",
+			"-", "time-wait*");
+	}
+
+	SynCacheList::ConstIterator synCacheIterator
+		= fSynCacheList.GetIterator();
+	while (syn_cache_entry* entry = synCacheIterator.Next()) {
+		char localBuf[64], peerBuf[64];
+		ConstSocketAddress(AddressModule(), &entry->local.address).AsString(
+			localBuf, sizeof(localBuf), true);
+		ConstSocketAddress(AddressModule(), &entry->peer.address).AsString(
+			peerBuf, sizeof(peerBuf), true);
+
+		kprintf("%p %21s %21s %8s %8s %12s\n", entry, localBuf, peerBuf, "-",
+			"-", "syn-cache*");
+	}
+
+	kprintf("(* connections without an endpoint)\n");
 }
 
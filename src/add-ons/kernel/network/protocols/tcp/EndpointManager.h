@@ -1,5 +1,5 @@
 /*
- * Copyright 2006-2009, Haiku, Inc. All Rights Reserved.
+ * Copyright 2006-2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -13,6 +13,9 @@
 #include "tcp.h"
 
 #include <AddressUtilities.h>
+#include <net_stat.h>
+
+#include <netinet/in.h>
 
 #include <lock.h>
 #include <util/AutoLock.h>
@@ -29,6 +32,54 @@ class EndpointManager;
 class TCPEndpoint;
 
 
+/*!	A socket address of one of the TCP domains, stored in place. */
+union compact_address {
+	sockaddr		address;
+	sockaddr_in		ipv4;
+	sockaddr_in6	ipv6;
+};
+
+
+/*!	What remains of a connection in TIME_WAIT state once its endpoint is
+	gone: just enough to acknowledge a retransmitted FIN, and to tell a new
+	incarnation of the connection from old duplicates.
+*/
+struct time_wait_entry : DoublyLinkedListLinkImpl<time_wait_entry> {
+	time_wait_entry*	hash_link;
+	compact_address		local;
+	compact_address		peer;
+	bigtime_t			expires;
+	uint32				send_next;
+	uint32				receive_next;
+	uint32				timestamp_recent;
+	uint16				advertised_window;
+	bool				timestamps;
+};
+
+
+/*!	A connection request that has been answered with a SYN+ACK, but that has
+	not been acknowledged by the peer yet. Only when it has, the listening
+	endpoint spawns a socket for it.
+*/
+struct syn_cache_entry : DoublyLinkedListLinkImpl<syn_cache_entry> {
+	syn_cache_entry*	hash_link;
+	compact_address		local;
+	compact_address		peer;
+	bigtime_t			due;
+	uint32				initial_send_sequence;
+	uint32				initial_receive_sequence;
+	uint32				timestamp_recent;
+	uint32				options;
+	uint16				advertised_window;
+	uint16				max_segment_size;
+	uint16				receive_max_segment_size;
+	uint16				receive_window;
+	uint8				send_window_shift;
+	uint8				receive_window_shift;
+	uint8				retransmits;
+};
+
+
 struct ConnectionHashDefinition {
 public:
 	typedef std::pair<const sockaddr*, const sockaddr*> KeyType;
@@ -52,6 +103,35 @@ private:
 };
 
 
+template<typename Entry>
+struct CachedConnectionHashDefinition {
+public:
+	typedef std::pair<const sockaddr*, const sockaddr*> KeyType;
+	typedef Entry ValueType;
+
+							CachedConnectionHashDefinition(
+								EndpointManager* manager)
+								: fManager(manager)
+							{
+							}
+							CachedConnectionHashDefinition(
+									const CachedConnectionHashDefinition&
+										definition)
+								: fManager(definition.fManager)
+							{
+							}
+
+			size_t			HashKey(const KeyType& key) const;
+			size_t			Hash(Entry* entry) const;
+			bool			Compare(const KeyType& key, Entry* entry) const;
+			Entry*&			GetLink(Entry* entry) const
+								{ return entry->hash_link; }
+
+private:
+	EndpointManager*		fManager;
+};
+
+
 class EndpointHashDefinition {
 public:
 	typedef uint16 KeyType;
@@ -88,12 +168,34 @@ public:
 			status_t		ReplyWithReset(tcp_segment_header& segment,
 								net_buffer* buffer);
 
+			status_t		EnterTimeWait(const sockaddr* local,
+								const sockaddr* peer, tcp_sequence sendNext,
+								tcp_sequence receiveNext,
+								uint16 advertisedWindow, bool timestamps,
+								uint32 timestampRecent);
+			bool			TimeWaitSegmentReceived(
+								tcp_segment_header& segment,
+								net_buffer* buffer, int32& _action);
+
+			int32			SynReceived(TCPEndpoint* listener,
+								tcp_segment_header& segment,
+								net_buffer* buffer);
+			bool			LookupSynCache(tcp_segment_header& segment,
+								net_buffer* buffer, syn_cache_entry& _entry);
+			void			SynCacheReset(tcp_segment_header& segment,
+								net_buffer* buffer);
+
+			void			GetStatistics(tcp_stat& stat);
+
 			net_domain*		Domain() const { return fDomain; }
 			net_address_module_info* AddressModule() const
 								{ return Domain()->address_module; }
 
 			void			Dump() const;
 
+	static	void			SetCacheLimits(uint32 timeWaitEntries,
+								uint32 synCacheEntries, bool synCookies);
+
 private:
 			TCPEndpoint*	_LookupConnection(const sockaddr* local,
 								const sockaddr* peer);
@@ -103,15 +205,61 @@ private:
 								TCPEndpoint* endpoint, const sockaddr* address);
 			status_t		_BindToEphemeral(TCPEndpoint* endpoint,
 								const sockaddr* address);
+			bool			_IsInTimeWait(const sockaddr* address);
+			void			_RemoveCachedConnections(const sockaddr* local,
+								const sockaddr* peer);
+
+			net_buffer*		_CreateReply(const sockaddr* local,
+								const sockaddr* peer,
+								tcp_segment_header& segment);
+			status_t		_SendReply(net_buffer* reply);
+
+			void			_RemoveTimeWait(time_wait_entry* entry);
+			void			_InsertSynCacheEntry(syn_cache_entry* entry);
+			void			_RemoveSynCacheEntry(syn_cache_entry* entry);
+			net_buffer*		_CreateSynAcknowledge(syn_cache_entry* entry);
+
+			uint32			_SynCookie(const sockaddr* local,
+								const sockaddr* peer, uint32 sequence,
+								uint32 period, uint32 data) const;
+			net_buffer*		_CreateSynCookie(tcp_segment_header& segment,
+								net_buffer* buffer,
+								uint16 receiveMaxSegmentSize,
+								uint16 receiveWindow);
+			bool			_CheckSynCookie(tcp_segment_header& segment,
+								net_buffer* buffer, syn_cache_entry& _entry);
+
+	static	void			_TimeWaitTimer(net_timer* timer, void* _manager);
+	static	void			_SynCacheTimer(net_timer* timer, void* _manager);
 
 	typedef BOpenHashTable<ConnectionHashDefinition> ConnectionTable;
 	typedef MultiHashTable<EndpointHashDefinition> EndpointTable;
+	typedef BOpenHashTable<CachedConnectionHashDefinition<time_wait_entry> >
+		TimeWaitTable;
+	typedef DoublyLinkedList<time_wait_entry> TimeWaitList;
+	typedef BOpenHashTable<CachedConnectionHashDefinition<syn_cache_entry> >
+		SynCacheTable;
+	typedef DoublyLinkedList<syn_cache_entry> SynCacheList;
 
 	rw_lock					fLock;
 	net_domain*				fDomain;
 	ConnectionTable			fConnectionHash;
 	EndpointTable			fEndpointHash;
 	uint16					fLastPort;
+
+	// The TIME_WAIT table and the SYN cache are protected by their own lock,
+	// which nests inside of fLock and the endpoint locks
+	mutex					fCacheLock;
+	TimeWaitTable			fTimeWaitHash;
+	TimeWaitList			fTimeWaitList;
+		// ordered by expiration time
+	net_timer				fTimeWaitTimer;
+	SynCacheTable			fSynCacheHash;
+	SynCacheList			fSynCacheList;
+		// ordered by the time the next SYN+ACK is due
+	net_timer				fSynCacheTimer;
+	uint64					fSynCookieSecret[2];
+	tcp_stat				fStatistics;
 };
 
 #endif	// ENDPOINT_MANAGER_H
@@ -0,0 +1,275 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "SackScoreboard.h"
+
+#include <string.h>
+
+#include <KernelExport.h>
+
+
+//#define TRACE_SACK_SCOREBOARD
+#ifdef TRACE_SACK_SCOREBOARD
+#	define TRACE(x) dprintf x
+#else
+#	define TRACE(x)
+#endif
+
+
+// The number of SACKed segments beyond a hole after which the data in the
+// hole is considered lost (DupThresh in RFC 6675).
+static const int kDuplicateThreshold = 3;
+
+
+SackScoreboard::SackScoreboard()
+	:
+	fCount(0),
+	fSackedBytes(0)
+{
+}
+
+
+void
+SackScoreboard::Reset()
+{
+	fCount = 0;
+	fSackedBytes = 0;
+}
+
+
+/*!	Adds the SACK blocks of an incoming segment to the scoreboard. Blocks that
+	lie below \a acknowledge (D-SACKs, RFC 2883) or beyond what we have sent
+	are ignored.
+*/
+void
+SackScoreboard::Update(tcp_sequence acknowledge, tcp_sequence sendMax,
+	const tcp_sack* sacks, int sackCount)
+{
+	RemoveUntil(acknowledge);
+
+	for (int i = 0; i < sackCount; i++) {
+		tcp_sequence left = sacks[i].left_edge;
+		tcp_sequence right = sacks[i].right_edge;
+
+		if (right <= left || right <= acknowledge || right > sendMax)
+			continue;
+		if (left < acknowledge)
+			left = acknowledge;
+
+		TRACE(("SackScoreboard::Update(): add %" B_PRIu32 " - %" B_PRIu32 "\n",
+			left.Number(), right.Number()));
+		_Add(left, right);
+	}
+}
+
+
+/*!	Forgets about all data up to \a sequence, as it has been cumulatively
+	acknowledged.
+*/
+void
+SackScoreboard::RemoveUntil(tcp_sequence sequence)
+{
+	int removed = 0;
+	while (removed < fCount && fBlocks[removed].right <= sequence) {
+		fSackedBytes -= (fBlocks[removed].right - fBlocks[removed].left)
+			.Number();
+		removed++;
+	}
+
+	if (removed > 0) {
+		fCount -= removed;
+		memmove(&fBlocks[0], &fBlocks[removed], fCount * sizeof(block));
+	}
+
+	if (fCount > 0 && fBlocks[0].left < sequence) {
+		fSackedBytes -= (sequence - fBlocks[0].left).Number();
+		fBlocks[0].left = sequence;
+	}
+}
+
+
+/*!	Returns whether or not the data at \a sequence has to be considered lost,
+	that is, if enough data beyond it has been SACKed (IsLost() in RFC 6675).
+*/
+bool
+SackScoreboard::IsLost(tcp_sequence sequence, uint32 maxSegmentSize) const
+{
+	int blocksAbove = 0;
+	uint32 bytesAbove = 0;
+
+	for (int i = fCount; i-- > 0;) {
+		if (fBlocks[i].right <= sequence)
+			break;
+		if (fBlocks[i].left <= sequence)
+			return false;
+
+		blocksAbove++;
+		bytesAbove += (fBlocks[i].right - fBlocks[i].left).Number();
+	}
+
+	return _IsLost(blocksAbove, bytesAbove, maxSegmentSize);
+}
+
+
+/*!	Finds the first data that is considered lost, and has not yet been
+	retransmitted, ie. that lies at or beyond \a retransmitHigh (rule (1) of
+	NextSeg() in RFC 6675).
+*/
+bool
+SackScoreboard::NextLost(tcp_sequence unacknowledged,
+	tcp_sequence retransmitHigh, uint32 maxSegmentSize,
+	tcp_sequence& _sequence) const
+{
+	uint32 bytesAbove = fSackedBytes;
+	tcp_sequence holeStart = unacknowledged;
+
+	for (int i = 0; i < fCount; i++) {
+		tcp_sequence start = holeStart;
+		if (start < retransmitHigh)
+			start = retransmitHigh;
+
+		if (start < fBlocks[i].left
+			&& _IsLost(fCount - i, bytesAbove, maxSegmentSize)) {
+			_sequence = start;
+			return true;
+		}
+
+		bytesAbove -= (fBlocks[i].right - fBlocks[i].left).Number();
+		holeStart = fBlocks[i].right;
+	}
+
+	return false;
+}
+
+
+/*!	Returns the number of bytes starting at \a sequence that the peer has not
+	SACKed yet, up to \a end.
+*/
+uint32
+SackScoreboard::UnsackedLength(tcp_sequence sequence, tcp_sequence end) const
+{
+	for (int i = 0; i < fCount; i++) {
+		if (fBlocks[i].right <= sequence)
+			continue;
+		if (fBlocks[i].left <= sequence)
+			return 0;
+		if (fBlocks[i].left < end)
+			end = fBlocks[i].left;
+		break;
+	}
+
+	return end > sequence ? (end - sequence).Number() : 0;
+}
+
+
+/*!	Estimates the number of bytes that are still in the network (SetPipe()
+	in RFC 6675): everything that has been sent, but has been neither
+	acknowledged, SACKed, nor considered lost -- unless it was lost and then
+	retransmitted.
+*/
+uint32
+SackScoreboard::Pipe(tcp_sequence unacknowledged, tcp_sequence sendMax,
+	tcp_sequence retransmitHigh, uint32 maxSegmentSize) const
+{
+	if (fCount == 0)
+		return (sendMax - unacknowledged).Number();
+
+	// data beyond the last SACK block is never considered lost
+	uint32 pipe = (sendMax - fBlocks[fCount - 1].right).Number();
+
+	uint32 bytesAbove = 0;
+	for (int i = fCount; i-- > 0;) {
+		bytesAbove += (fBlocks[i].right - fBlocks[i].left).Number();
+
+		tcp_sequence holeStart = i > 0 ? fBlocks[i - 1].right : unacknowledged;
+		tcp_sequence holeEnd = fBlocks[i].left;
+		if (holeEnd <= holeStart)
+			continue;
+
+		if (!_IsLost(fCount - i, bytesAbove, maxSegmentSize)) {
+			pipe += (holeEnd - holeStart).Number();
+			continue;
+		}
+
+		// only the retransmitted part of a lost hole is in the network
+		if (retransmitHigh > holeStart) {
+			if (retransmitHigh < holeEnd)
+				holeEnd = retransmitHigh;
+			pipe += (holeEnd - holeStart).Number();
+		}
+	}
+
+	return pipe;
+}
+
+
+void
+SackScoreboard::Dump() const
+{
+	kprintf("  SACK scoreboard: %" B_PRIu32 " bytes in %d blocks\n",
+		fSackedBytes, fCount);
+	for (int i = 0; i < fCount; i++) {
+		kprintf("    %" B_PRIu32 " - %" B_PRIu32 "\n", fBlocks[i].left.Number(),
+			fBlocks[i].right.Number());
+	}
+}
+
+
+void
+SackScoreboard::_Add(tcp_sequence left, tcp_sequence right)
+{
+	// find the first block that doesn't end before the new one
+	int index = 0;
+	while (index < fCount && fBlocks[index].right < left)
+		index++;
+
+	// merge all blocks that overlap or touch the new one
+	int end = index;
+	while (end < fCount && fBlocks[end].left <= right) {
+		if (fBlocks[end].left < left)
+			left = fBlocks[end].left;
+		if (fBlocks[end].right > right)
+			right = fBlocks[end].right;
+
+		fSackedBytes -= (fBlocks[end].right - fBlocks[end].left).Number();
+		end++;
+	}
+
+	int merged = end - index;
+	if (merged == 0) {
+		if (fCount == kMaxBlocks) {
+			// We're out of space: forget about the highest block. This will
+			// only cause an unnecessary retransmission later on.
+			if (index == fCount)
+				return;
+
+			fCount--;
+			fSackedBytes -= (fBlocks[fCount].right - fBlocks[fCount].left)
+				.Number();
+		}
+
+		memmove(&fBlocks[index + 1], &fBlocks[index],
+			(fCount - index) * sizeof(block));
+		fCount++;
+	} else if (merged > 1) {
+		memmove(&fBlocks[index + 1], &fBlocks[end],
+			(fCount - end) * sizeof(block));
+		fCount -= merged - 1;
+	}
+
+	fBlocks[index].left = left;
+	fBlocks[index].right = right;
+	fSackedBytes += (right - left).Number();
+}
+
+
+/*static*/ bool
+SackScoreboard::_IsLost(int blocksAbove, uint32 bytesAbove,
+	uint32 maxSegmentSize)
+{
+	return blocksAbove >= kDuplicateThreshold
+		|| bytesAbove > (kDuplicateThreshold - 1) * maxSegmentSize;
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef SACK_SCOREBOARD_H
+#define SACK_SCOREBOARD_H
+
+
+#include "tcp.h"
+
+
+/*!	Keeps track of the data beyond the cumulative acknowledgement that the
+	peer reported to have received via SACK blocks (RFC 2018), and implements
+	the loss detection and pipe estimation of the conservative SACK based loss
+	recovery algorithm (RFC 6675).
+	All sequence numbers are in host byte order.
+*/
+class SackScoreboard {
+public:
+								SackScoreboard();
+
+			void				Reset();
+			bool				IsEmpty() const { return fCount == 0; }
+
+			void				Update(tcp_sequence acknowledge,
+									tcp_sequence sendMax,
+									const tcp_sack* sacks, int sackCount);
+			void				RemoveUntil(tcp_sequence sequence);
+
+			uint32				SackedBytes() const { return fSackedBytes; }
+
+			bool				IsLost(tcp_sequence sequence,
+									uint32 maxSegmentSize) const;
+			bool				NextLost(tcp_sequence unacknowledged,
+									tcp_sequence retransmitHigh,
+									uint32 maxSegmentSize,
+									tcp_sequence& _sequence) const;
+			uint32				UnsackedLength(tcp_sequence sequence,
+									tcp_sequence end) const;
+			uint32				Pipe(tcp_sequence unacknowledged,
+									tcp_sequence sendMax,
+									tcp_sequence retransmitHigh,
+									uint32 maxSegmentSize) const;
+
+			void				Dump() const;
+
+private:
+			struct block {
+				tcp_sequence	left;
+				tcp_sequence	right;
+			};
+
+			void				_Add(tcp_sequence left, tcp_sequence right);
+	static	bool				_IsLost(int blocksAbove, uint32 bytesAbove,
+									uint32 maxSegmentSize);
+
+	static	const int			kMaxBlocks = 32;
+
+			block				fBlocks[kMaxBlocks];
+			int					fCount;
+			uint32				fSackedBytes;
+};
+
+
+#endif	// SACK_SCOREBOARD_H
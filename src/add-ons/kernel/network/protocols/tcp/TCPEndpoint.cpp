@@ -41,16 +41,19 @@
 //	- RFC 793 - Transmission Control Protocol
 //	- RFC 813 - Window and Acknowledgement Strategy in TCP
 //	- RFC 1337 - TIME_WAIT Assassination Hazards in TCP
+//	- RFC 2018 - TCP Selective Acknowledgment Options
+//	- RFC 4987 - TCP SYN Flooding Attacks and Common Mitigations
+//	- RFC 6191 - Reducing the TIME-WAIT State Using TCP Timestamps
+//	- RFC 6675 - A Conservative Loss Recovery Algorithm Based on Selective
+//	  Acknowledgment (SACK) for TCP
 //
 // Things this implementation currently doesn't implement:
 //	- TCP Slow Start, Congestion Avoidance, Fast Retransmit, and Fast Recovery,
 //	  RFC 2001, RFC 2581, RFC 3042
 //	- NewReno Modification to TCP's Fast Recovery, RFC 2582
 //	- Explicit Congestion Notification (ECN), RFC 3168
-//	- SYN-Cache
-//	- SACK, Selective Acknowledgment - RFC 2018, RFC 2883, RFC 3517
+//	- D-SACK, Duplicate Selective Acknowledgment - RFC 2883
 //	- Forward RTO-Recovery, RFC 4138
-//	- Time-Wait hash instead of keeping sockets alive
 //
 // Things incomplete in this implementation:
 //	- TCP Extensions for High Performance, RFC 1323 - RTTM, PAWS
@@ -321,13 +324,10 @@ enum {
 	FLAG_LOCAL					= 0x20,
 	FLAG_RECOVERY				= 0x40,
 	FLAG_OPTION_SACK_PERMITTED	= 0x80,
+	FLAG_SACK_RECOVERY			= 0x100,
 };
 
 
-static const int kTimestampFactor = 1000;
-	// conversion factor between usec system time and msec tcp time
-
-
 static inline bigtime_t
 absolute_timeout(bigtime_t timeout)
 {
@@ -388,12 +388,6 @@ is_establishing(tcp_state state)
 }
 
 
-static inline uint32 tcp_now()
-{
-	return system_time() / kTimestampFactor;
-}
-
-
 static inline uint32 tcp_diff_timestamp(uint32 base)
 {
 	uint32 now = tcp_now();
@@ -437,6 +431,7 @@ TCPEndpoint::TCPEndpoint(net_socket* socket)
 	fDuplicateAcknowledgeCount(0),
 	fPreviousFlightSize(0),
 	fRecover(0),
+	fRetransmitHigh(0),
 	fRoute(NULL),
 	fReceiveNext(0),
 	fReceiveMaxAdvertised(0),
@@ -451,6 +446,7 @@ TCPEndpoint::TCPEndpoint(net_socket* socket)
 	fReceivedTimestamp(0),
 	fCongestionWindow(0),
 	fSlowStartThreshold(0),
+	fCongestionControl(CongestionControl::Create(NULL)),
 	fState(CLOSED),
 	fFlags(FLAG_OPTION_WINDOW_SCALE | FLAG_OPTION_TIMESTAMP | FLAG_OPTION_SACK_PERMITTED)
 {
@@ -496,12 +492,16 @@ TCPEndpoint::~TCPEndpoint()
 	gStackModule->wait_for_timer(&fTimeWaitTimer);
 
 	gDatalinkModule->put_route(Domain(), fRoute);
+	delete fCongestionControl;
 }
 
 
 status_t
 TCPEndpoint::InitCheck() const
 {
+	if (fCongestionControl == NULL)
+		return B_NO_MEMORY;
+
 	return B_OK;
 }
 
@@ -580,6 +580,15 @@ TCPEndpoint::Free()
 	if (fState <= SYNCHRONIZE_SENT)
 		return;
 
+	if (fState == TIME_WAIT && (fFlags & FLAG_DELETE_ON_CLOSE) == 0
+		&& _HandOverTimeWait()) {
+		// the endpoint manager will take care of the rest of the 2MSL
+		// timeout, there is no need to keep us around
+		_CancelConnectionTimers();
+		gStackModule->cancel_timer(&fTimeWaitTimer);
+		return;
+	}
+
 	// we are only interested in the timer, not in changing state
 	_EnterTimeWait();
 
@@ -1052,6 +1061,19 @@ TCPEndpoint::SetReceiveBufferSize(size_t length)
 status_t
 TCPEndpoint::GetOption(int option, void* _value, int* _length)
 {
+	if (option == TCP_CONGESTION) {
+		MutexLocker _(fLock);
+
+		const char* name = fCongestionControl->Name();
+		size_t length = strlen(name) + 1;
+		if (*_length < 0 || (size_t)*_length < length)
+			return B_BAD_VALUE;
+
+		memcpy(_value, name, length);
+		*_length = length;
+		return B_OK;
+	}
+
 	if (*_length != sizeof(int))
 		return B_BAD_VALUE;
 
@@ -1078,6 +1100,25 @@ TCPEndpoint::GetOption(int option, void* _value, int* _length)
 status_t
 TCPEndpoint::SetOption(int option, const void* _value, int length)
 {
+	if (option == TCP_CONGESTION) {
+		if (length <= 0)
+			return B_BAD_VALUE;
+
+		// the name doesn't need to be null terminated; never read more than
+		// the given length from the buffer
+		char name[TCP_CA_NAME_MAX];
+		size_t nameLength = strnlen((const char*)_value,
+			min_c((size_t)length, sizeof(name) - 1));
+		memcpy(name, _value, nameLength);
+		name[nameLength] = '\0';
+
+		MutexLocker _(fLock);
+		if (strcmp(name, fCongestionControl->Name()) == 0)
+			return B_OK;
+
+		return _SetCongestionControl(name);
+	}
+
 	if (option != TCP_NODELAY)
 		return B_BAD_VALUE;
 
@@ -1158,6 +1199,22 @@ TCPEndpoint::_EnterTimeWait()
 }
 
 
+/*!	Passes the connection on to the TIME_WAIT table of the endpoint manager,
+	which only keeps a small record of it. Returns \c true if the endpoint is
+	no longer needed then.
+*/
+bool
+TCPEndpoint::_HandOverTimeWait()
+{
+	uint16 advertisedWindow = min_c(fReceiveWindow >> fReceiveWindowShift,
+		TCP_MAX_WINDOW);
+
+	return fManager->EnterTimeWait(*LocalAddress(), *PeerAddress(), fSendMax,
+		fReceiveNext, advertisedWindow,
+		(fFlags & FLAG_OPTION_TIMESTAMP) != 0, fReceivedTimestamp) == B_OK;
+}
+
+
 void
 TCPEndpoint::_UpdateTimeWait()
 {
@@ -1280,6 +1337,13 @@ TCPEndpoint::_DuplicateAcknowledge(tcp_segment_header &segment)
 	if (fDuplicateAcknowledgeCount == 0)
 		fPreviousFlightSize = (fSendMax - fSendUnacknowledged).Number();
 
+	if ((fFlags & FLAG_SACK_RECOVERY) != 0) {
+		// the segment may have SACKed more data, or left the network
+		fDuplicateAcknowledgeCount++;
+		_SendSackRecovery();
+		return;
+	}
+
 	if (++fDuplicateAcknowledgeCount < 3) {
 		if (fSendQueue.Available(fSendMax) != 0  && fSendWindow != 0) {
 			fSendNext = fSendMax;
@@ -1290,12 +1354,27 @@ TCPEndpoint::_DuplicateAcknowledge(tcp_segment_header &segment)
 		}
 	}
 
+	if (_UseSack()) {
+		// With SACK, we don't have to wait for three duplicate
+		// acknowledgements if the peer already told us about enough data
+		// beyond the first hole
+		if ((fDuplicateAcknowledgeCount >= 3
+				|| fSackScoreboard.IsLost(fSendUnacknowledged,
+					fSendMaxSegmentSize))
+			&& tcp_sequence(segment.acknowledge - 1) > tcp_sequence(fRecover)) {
+			_EnterSackRecovery();
+		}
+		return;
+	}
+
 	if (fDuplicateAcknowledgeCount == 3) {
 		if ((segment.acknowledge - 1) > fRecover || (fCongestionWindow > fSendMaxSegmentSize &&
 			(fSendUnacknowledged - fPreviousHighestAcknowledge) <= 4 * fSendMaxSegmentSize)) {
 			fFlags |= FLAG_RECOVERY;
 			fRecover = fSendMax.Number() - 1;
-			fSlowStartThreshold = max_c(fPreviousFlightSize / 2, 2 * fSendMaxSegmentSize);
+			fSlowStartThreshold = fCongestionControl->LossDetected(
+				fCongestionWindow, fPreviousFlightSize, fSendMaxSegmentSize,
+				false);
 			fCongestionWindow = fSlowStartThreshold + 3 * fSendMaxSegmentSize;
 			fSendNext = segment.acknowledge;
 			_SendQueued();
@@ -1313,6 +1392,84 @@ TCPEndpoint::_DuplicateAcknowledge(tcp_segment_header &segment)
 }
 
 
+bool
+TCPEndpoint::_UseSack() const
+{
+	return (fFlags & FLAG_OPTION_SACK_PERMITTED) != 0
+		&& !fSackScoreboard.IsEmpty();
+}
+
+
+/*!	Starts SACK based loss recovery as described in RFC 6675, section 5.
+*/
+void
+TCPEndpoint::_EnterSackRecovery()
+{
+	TRACE("_EnterSackRecovery(): %" B_PRIu32 " bytes SACKed",
+		fSackScoreboard.SackedBytes());
+
+	fRecover = fSendMax.Number() - 1;
+	fSlowStartThreshold = fCongestionControl->LossDetected(fCongestionWindow,
+		fPreviousFlightSize, fSendMaxSegmentSize, false);
+	fCongestionWindow = fSlowStartThreshold;
+
+	// The first hole is retransmitted regardless of the pipe
+	fSendNext = fSendUnacknowledged;
+	_SendQueued();
+	fRetransmitHigh = fSendNext;
+	fSendNext = fSendMax;
+
+	fFlags |= FLAG_SACK_RECOVERY;
+	_SendSackRecovery();
+}
+
+
+/*!	Sends as much as the congestion window allows during SACK based loss
+	recovery: first the data considered lost, then new data (NextSeg() in
+	RFC 6675). Data that is neither SACKed nor lost is only retransmitted
+	by the retransmit timer.
+*/
+void
+TCPEndpoint::_SendSackRecovery()
+{
+	while (true) {
+		uint32 pipe = _Pipe();
+		if (pipe >= fCongestionWindow
+			|| fCongestionWindow - pipe < fSendMaxSegmentSize)
+			break;
+
+		tcp_sequence sequence;
+		bool retransmit = fSackScoreboard.NextLost(fSendUnacknowledged,
+			fRetransmitHigh, fSendMaxSegmentSize, sequence);
+		if (retransmit)
+			fSendNext = sequence;
+		else if (fSendQueue.Available(fSendMax) > 0)
+			fSendNext = fSendMax;
+		else
+			break;
+
+		tcp_sequence previous = fSendNext;
+		if (_SendQueued() != B_OK || fSendNext == previous)
+			break;
+
+		if (retransmit && fSendNext > fRetransmitHigh)
+			fRetransmitHigh = fSendNext;
+	}
+
+	fSendNext = fSendMax;
+}
+
+
+/*!	Returns the amount of data that is currently in the network.
+*/
+uint32
+TCPEndpoint::_Pipe() const
+{
+	return fSackScoreboard.Pipe(fSendUnacknowledged, fSendMax,
+		fRetransmitHigh, fSendMaxSegmentSize);
+}
+
+
 void
 TCPEndpoint::_UpdateTimestamps(tcp_segment_header& segment,
 	size_t segmentLength)
@@ -1442,12 +1599,12 @@ TCPEndpoint::_ShouldReceive() const
 }
 
 
-int32
-TCPEndpoint::_Spawn(TCPEndpoint* parent, tcp_segment_header& segment,
-	net_buffer* buffer)
+/*!	Sets up this endpoint for the connection \a buffer belongs to, on behalf
+	of the listening endpoint \a parent.
+*/
+status_t
+TCPEndpoint::_PrepareSpawn(TCPEndpoint* parent, net_buffer* buffer)
 {
-	MutexLocker _(fLock);
-
 	// TODO error checking
 	ProtocolSocket::Open();
 
@@ -1462,30 +1619,73 @@ TCPEndpoint::_Spawn(TCPEndpoint* parent, tcp_segment_header& segment,
 	TRACE("Spawn()");
 
 	// TODO: proper error handling!
-	if (fManager->BindChild(this) != B_OK) {
+	status_t status = fManager->BindChild(this);
+	if (status != B_OK) {
 		T(Error(this, "binding failed", __LINE__));
-		return DROP;
+		return status;
 	}
-	if (_PrepareSendPath(*PeerAddress()) != B_OK) {
+	status = _PrepareSendPath(*PeerAddress());
+	if (status != B_OK) {
 		T(Error(this, "prepare send faild", __LINE__));
-		return DROP;
+		return status;
 	}
 
 	fOptions = parent->fOptions;
 	fAcceptSemaphore = parent->fAcceptSemaphore;
 
-	_PrepareReceivePath(segment);
+	if (strcmp(fCongestionControl->Name(),
+			parent->fCongestionControl->Name()) != 0)
+		_SetCongestionControl(parent->fCongestionControl->Name());
+
+	return B_OK;
+}
+
+
+/*!	Spawns the endpoint for a connection request that the SYN cache has
+	answered, and that the peer has now acknowledged with \a segment.
+*/
+int32
+TCPEndpoint::_Spawn(TCPEndpoint* parent, const syn_cache_entry& entry,
+	tcp_segment_header& segment, net_buffer* buffer)
+{
+	MutexLocker _(fLock);
 
-	// send SYN+ACK
-	if (_SendQueued() != B_OK) {
-		T(Error(this, "sending failed", __LINE__));
+	if (_PrepareSpawn(parent, buffer) != B_OK)
 		return DROP;
-	}
 
-	segment.flags &= ~TCP_FLAG_SYNCHRONIZE;
-		// we handled this flag now, it must not be set for further processing
+	// our SYN+ACK has already been sent
+	fInitialSendSequence = entry.initial_send_sequence;
+	fSendUnacknowledged = fInitialSendSequence;
+	fSendNext = fInitialSendSequence + 1;
+	fSendMax = fSendNext;
+	fSendUrgentOffset = fInitialSendSequence;
+	fRecover = fInitialSendSequence.Number();
+	fSendQueue.SetInitialSequence(fSendNext);
+	fReceiveWindowShift = entry.receive_window_shift;
+
+	// restore what we learned from the peer's SYN
+	tcp_segment_header synchronize(TCP_FLAG_SYNCHRONIZE);
+	synchronize.sequence = entry.initial_receive_sequence;
+	synchronize.advertised_window = entry.advertised_window;
+	synchronize.window_shift = entry.send_window_shift;
+	synchronize.max_segment_size = entry.max_segment_size;
+	synchronize.timestamp_value = entry.timestamp_recent;
+	synchronize.options = entry.options;
+	_PrepareReceivePath(synchronize);
+
+	fLastAcknowledgeSent = fReceiveNext;
+	fReceiveMaxAdvertised = fReceiveNext + min_c(fReceiveWindow,
+		TCP_MAX_WINDOW);
+
+	// The segment might carry data already; as our parent is the one the
+	// segment was delivered to, we need to acknowledge it ourselves.
+	int32 action = _Receive(segment, buffer);
+	if ((action & IMMEDIATE_ACKNOWLEDGE) != 0)
+		SendAcknowledge(true);
+	else if ((action & ACKNOWLEDGE) != 0)
+		DelayedAcknowledge();
 
-	return _Receive(segment, buffer);
+	return action & ~(IMMEDIATE_ACKNOWLEDGE | ACKNOWLEDGE);
 }
 
 
@@ -1496,24 +1696,34 @@ TCPEndpoint::_ListenReceive(tcp_segment_header& segment, net_buffer* buffer)
 
 	// Essentially, we accept only TCP_FLAG_SYNCHRONIZE in this state,
 	// but the error behaviour differs
-	if (segment.flags & TCP_FLAG_RESET)
+	if (segment.flags & TCP_FLAG_RESET) {
+		fManager->SynCacheReset(segment, buffer);
 		return DROP;
-	if (segment.flags & TCP_FLAG_ACKNOWLEDGE)
-		return DROP | RESET;
+	}
+	if (segment.flags & TCP_FLAG_ACKNOWLEDGE) {
+		// this may complete a connection request answered by the SYN cache
+		syn_cache_entry entry;
+		if ((segment.flags & TCP_FLAG_SYNCHRONIZE) != 0
+			|| !fManager->LookupSynCache(segment, buffer, entry))
+			return DROP | RESET;
+
+		// spawn new endpoint for accept()
+		net_socket* newSocket;
+		if (gSocketModule->spawn_pending_socket(socket, &newSocket) < B_OK) {
+			T(Error(this, "spawning failed", __LINE__));
+			return DROP;
+		}
+
+		return ((TCPEndpoint *)newSocket->first_protocol)->_Spawn(this,
+			entry, segment, buffer);
+	}
 	if ((segment.flags & TCP_FLAG_SYNCHRONIZE) == 0)
 		return DROP;
 
 	// TODO: drop broadcast/multicast
 
-	// spawn new endpoint for accept()
-	net_socket* newSocket;
-	if (gSocketModule->spawn_pending_socket(socket, &newSocket) < B_OK) {
-		T(Error(this, "spawning failed", __LINE__));
-		return DROP;
-	}
-
-	return ((TCPEndpoint *)newSocket->first_protocol)->_Spawn(this,
-		segment, buffer);
+	// the endpoint is only spawned once the peer acknowledged our SYN+ACK
+	return fManager->SynReceived(this, segment, buffer);
 }
 
 
@@ -1576,6 +1786,7 @@ TCPEndpoint::_Receive(tcp_segment_header& segment, net_buffer* buffer)
 
 	if (fState == ESTABLISHED
 		&& segment.AcknowledgeOnly()
+		&& (segment.options & TCP_HAS_SACK) == 0
 		&& fReceiveNext == segment.sequence
 		&& advertisedWindow > 0 && advertisedWindow == fSendWindow
 		&& fSendNext == fSendMax) {
@@ -1726,6 +1937,13 @@ TCPEndpoint::_Receive(tcp_segment_header& segment, net_buffer* buffer)
 		if (fSendMax < segment.acknowledge)
 			return DROP | IMMEDIATE_ACKNOWLEDGE;
 
+		if ((segment.options & TCP_HAS_SACK) != 0
+			&& (fFlags & FLAG_OPTION_SACK_PERMITTED) != 0
+			&& segment.acknowledge >= fSendUnacknowledged) {
+			fSackScoreboard.Update(segment.acknowledge, fSendMax,
+				segment.sacks, segment.sackCount);
+		}
+
 		if (segment.acknowledge == fSendUnacknowledged) {
 			if (buffer->size == 0 && advertisedWindow == fSendWindow
 				&& (segment.flags & TCP_FLAG_FINISH) == 0 && fSendUnacknowledged != fSendMax) {
@@ -1737,7 +1955,8 @@ TCPEndpoint::_Receive(tcp_segment_header& segment, net_buffer* buffer)
 		} else {
 			// this segment acknowledges in flight data
 
-			if (fDuplicateAcknowledgeCount >= 3) {
+			if (fDuplicateAcknowledgeCount >= 3
+				&& (fFlags & FLAG_SACK_RECOVERY) == 0) {
 				// deflate the window.
 				if (segment.acknowledge > fRecover) {
 					uint32 flightSize = (fSendMax - fSendUnacknowledged).Number();
@@ -1906,6 +2125,17 @@ TCPEndpoint::SegmentReceived(tcp_segment_header& segment, net_buffer* buffer)
 	else if (segmentAction & ACKNOWLEDGE)
 		DelayedAcknowledge();
 
+	if (fState == TIME_WAIT
+		&& (fFlags & (FLAG_CLOSED | FLAG_DELETE_ON_CLOSE)) == FLAG_CLOSED
+		&& _HandOverTimeWait()) {
+		// We have been closed already, and are only kept around for TIME_WAIT
+		// which the endpoint manager can do just as well. If the 2MSL timer
+		// is already running, it will release the socket on its own.
+		_CancelConnectionTimers();
+		if (gStackModule->cancel_timer(&fTimeWaitTimer))
+			fFlags |= FLAG_DELETE_ON_CLOSE;
+	}
+
 	if ((fFlags & (FLAG_CLOSED | FLAG_DELETE_ON_CLOSE))
 			== (FLAG_CLOSED | FLAG_DELETE_ON_CLOSE)) {
 
@@ -2076,7 +2306,8 @@ TCPEndpoint::_SendQueued(bool force, uint32 sendWindow)
 		segment.urgent_offset = 0;
 	}
 
-	if (fCongestionWindow > 0 && fCongestionWindow < sendWindow)
+	if ((fFlags & FLAG_SACK_RECOVERY) == 0
+		&& fCongestionWindow > 0 && fCongestionWindow < sendWindow)
 		sendWindow = fCongestionWindow;
 
 	// fSendUnacknowledged
@@ -2096,6 +2327,15 @@ TCPEndpoint::_SendQueued(bool force, uint32 sendWindow)
 	uint32 flightSize = (fSendMax - fSendUnacknowledged).Number();
 	uint32 consumedWindow = (fSendNext - fSendUnacknowledged).Number();
 
+	if ((fFlags & FLAG_SACK_RECOVERY) != 0) {
+		// During SACK based recovery, the congestion window limits the data
+		// in the network rather than all unacknowledged data (RFC 6675)
+		uint32 pipe = _Pipe();
+		uint32 congestionWindow = fCongestionWindow > pipe
+			? fCongestionWindow - pipe : 0;
+		sendWindow = min_c(sendWindow, consumedWindow + congestionWindow);
+	}
+
 	if (consumedWindow > sendWindow) {
 		sendWindow = 0;
 		// TODO: enter persist state? try to get a window update.
@@ -2106,6 +2346,12 @@ TCPEndpoint::_SendQueued(bool force, uint32 sendWindow)
 	bool shouldStartRetransmitTimer = fSendNext == fSendUnacknowledged;
 	bool retransmit = fSendNext < fSendMax;
 
+	if (retransmit && (fFlags & FLAG_SACK_RECOVERY) != 0) {
+		// don't resend what the peer already has
+		length = min_c(length, fSackScoreboard.UnsackedLength(fSendNext,
+			fSendMax));
+	}
+
 	if (fDuplicateAcknowledgeCount != 0) {
 		// send at most 1 SMSS of data when under limited transmit, fast transmit/recovery
 		length = min_c(length, fSendMaxSegmentSize);
@@ -2298,6 +2544,7 @@ TCPEndpoint::_Acknowledged(tcp_segment_header& segment)
 
 	if (fSendUnacknowledged < segment.acknowledge) {
 		fSendQueue.RemoveUntil(segment.acknowledge);
+		fSackScoreboard.RemoveUntil(segment.acknowledge);
 
 		uint32 bytesAcknowledged = segment.acknowledge - fSendUnacknowledged.Number();
 		fPreviousHighestAcknowledge = fSendUnacknowledged;
@@ -2310,25 +2557,43 @@ TCPEndpoint::_Acknowledged(tcp_segment_header& segment)
 			fRecover = segment.acknowledge - 1;
 		}
 
+		if ((fFlags & FLAG_SACK_RECOVERY) != 0
+			&& fSendUnacknowledged > tcp_sequence(fRecover)) {
+			// all data that was outstanding when we entered recovery has been
+			// acknowledged
+			TRACE("_Acknowledged(): leaving SACK recovery");
+			fFlags &= ~FLAG_SACK_RECOVERY;
+			fCongestionWindow = fSlowStartThreshold;
+		}
+
+		int32 roundTripTime = -1;
+		if (fFlags & FLAG_OPTION_TIMESTAMP) {
+			roundTripTime = tcp_diff_timestamp(segment.timestamp_reply);
+			_UpdateRoundTripTime(roundTripTime,
+				expectedSamples > 0 ? expectedSamples : 1);
+		} else if (fSendTime != 0 && fRoundTripStartSequence < segment.acknowledge) {
+			roundTripTime = tcp_diff_timestamp(fSendTime);
+			_UpdateRoundTripTime(roundTripTime, 1);
+			fSendTime = 0;
+		}
+
 		// the acknowledgment of the SYN/ACK MUST NOT increase the size of the congestion window
-		if (fSendUnacknowledged != fInitialSendSequence) {
-			if (fCongestionWindow < fSlowStartThreshold)
-				fCongestionWindow += min_c(bytesAcknowledged, fSendMaxSegmentSize);
-			else {
-				uint32 increment = fSendMaxSegmentSize * fSendMaxSegmentSize;
-
-				if (increment < fCongestionWindow)
-					increment = 1;
-				else
-					increment /= fCongestionWindow;
-
-				fCongestionWindow += increment;
-			}
+		if (fSendUnacknowledged != fInitialSendSequence
+			&& (fFlags & FLAG_SACK_RECOVERY) == 0) {
+			fCongestionControl->Acknowledged(fCongestionWindow,
+				fSlowStartThreshold, bytesAcknowledged, fSendMaxSegmentSize,
+				fSendUnacknowledged, fSendNext, roundTripTime >= 0
+					? (bigtime_t)roundTripTime * kTimestampFactor : -1);
 
 			fSendMaxSegments = UINT32_MAX;
 		}
 
-		if ((fFlags & FLAG_RECOVERY) != 0) {
+		if ((fFlags & FLAG_SACK_RECOVERY) != 0) {
+			// a partial acknowledgement - keep filling the holes
+			if (fRetransmitHigh < fSendUnacknowledged)
+				fRetransmitHigh = fSendUnacknowledged;
+			_SendSackRecovery();
+		} else if ((fFlags & FLAG_RECOVERY) != 0) {
 			fSendNext = fSendUnacknowledged;
 			_SendQueued();
 			fCongestionWindow -= bytesAcknowledged;
@@ -2343,14 +2608,6 @@ TCPEndpoint::_Acknowledged(tcp_segment_header& segment)
 		if (fSendNext < fSendUnacknowledged)
 			fSendNext = fSendUnacknowledged;
 
-		if (fFlags & FLAG_OPTION_TIMESTAMP) {
-			_UpdateRoundTripTime(tcp_diff_timestamp(segment.timestamp_reply),
-				expectedSamples > 0 ? expectedSamples : 1);
-		} else if (fSendTime != 0 && fRoundTripStartSequence < segment.acknowledge) {
-			_UpdateRoundTripTime(tcp_diff_timestamp(fSendTime), 1);
-			fSendTime = 0;
-		}
-
 		if (fSendUnacknowledged == fSendMax) {
 			TRACE("all acknowledged, cancelling retransmission timer.");
 			gStackModule->cancel_timer(&fRetransmitTimer);
@@ -2392,6 +2649,11 @@ TCPEndpoint::_Retransmit()
 			fRetransmitTimeout = TCP_MAX_RETRANSMIT_TIMEOUT;
 	}
 
+	// After a timeout, the SACK information cannot be trusted anymore, as the
+	// peer is allowed to discard SACKed data (RFC 2018, section 8)
+	fFlags &= ~FLAG_SACK_RECOVERY;
+	fSackScoreboard.Reset();
+
 	fSendNext = fSendUnacknowledged;
 	_SendQueued();
 
@@ -2433,12 +2695,36 @@ TCPEndpoint::_UpdateRoundTripTime(int32 roundTripTime, int32 expectedSamples)
 void
 TCPEndpoint::_ResetSlowStart()
 {
-	fSlowStartThreshold = max_c((fSendMax - fSendUnacknowledged).Number() / 2,
-		2 * fSendMaxSegmentSize);
+	fSlowStartThreshold = fCongestionControl->LossDetected(fCongestionWindow,
+		(fSendMax - fSendUnacknowledged).Number(), fSendMaxSegmentSize, true);
 	fCongestionWindow = fSendMaxSegmentSize;
 }
 
 
+/*!	Replaces the congestion control algorithm of this endpoint. The new
+	algorithm starts from scratch, so unless the connection has not been
+	established yet, this restarts slow start.
+*/
+status_t
+TCPEndpoint::_SetCongestionControl(const char* name)
+{
+	CongestionControl* congestionControl = CongestionControl::Create(name);
+	if (congestionControl == NULL)
+		return name != NULL ? B_NAME_NOT_FOUND : B_NO_MEMORY;
+
+	delete fCongestionControl;
+	fCongestionControl = congestionControl;
+
+	if (fState >= ESTABLISHED && fSendMaxSegmentSize != 0) {
+		fCongestionWindow = min_c(fCongestionWindow,
+			4 * fSendMaxSegmentSize);
+		fSlowStartThreshold = max_c(fSlowStartThreshold, fSendMaxWindow);
+	}
+
+	return B_OK;
+}
+
+
 //	#pragma mark - timer
 
 
@@ -2559,6 +2845,8 @@ TCPEndpoint::Dump() const
 #endif
 	kprintf("    last acknowledge sent: %" B_PRIu32 "\n",
 		fLastAcknowledgeSent.Number());
+	kprintf("    retransmit high: %" B_PRIu32 "\n", fRetransmitHigh.Number());
+	fSackScoreboard.Dump();
 	kprintf("    initial sequence: %" B_PRIu32 "\n",
 		fInitialSendSequence.Number());
 	kprintf("  receive\n");
@@ -2582,5 +2870,6 @@ TCPEndpoint::Dump() const
 	kprintf("  retransmit timeout: %" B_PRId64 "\n", fRetransmitTimeout);
 	kprintf("  congestion window: %" B_PRIu32 "\n", fCongestionWindow);
 	kprintf("  slow start threshold: %" B_PRIu32 "\n", fSlowStartThreshold);
+	fCongestionControl->Dump();
 }
 
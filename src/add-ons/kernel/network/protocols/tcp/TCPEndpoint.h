@@ -1,5 +1,5 @@
 /*
- * Copyright 2006-2010, Haiku, Inc. All Rights Reserved.
+ * Copyright 2006-2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -12,7 +12,9 @@
 
 
 #include "BufferQueue.h"
+#include "CongestionControl.h"
 #include "EndpointManager.h"
+#include "SackScoreboard.h"
 #include "tcp.h"
 
 #include <ProtocolUtilities.h>
@@ -70,6 +72,7 @@ public:
 private:
 			void		_StartPersistTimer();
 			void		_EnterTimeWait();
+			bool		_HandOverTimeWait();
 			void		_UpdateTimeWait();
 			void		_Close();
 			void		_CancelConnectionTimers();
@@ -85,8 +88,11 @@ private:
 			void		_NotifyReader();
 			bool		_ShouldReceive() const;
 			void		_HandleReset(status_t error);
-			int32		_Spawn(TCPEndpoint* parent, tcp_segment_header& segment,
+			status_t	_PrepareSpawn(TCPEndpoint* parent,
 							net_buffer* buffer);
+			int32		_Spawn(TCPEndpoint* parent,
+							const syn_cache_entry& entry,
+							tcp_segment_header& segment, net_buffer* buffer);
 			int32		_ListenReceive(tcp_segment_header& segment,
 							net_buffer* buffer);
 			int32		_SynchronizeSentReceive(tcp_segment_header& segment,
@@ -108,7 +114,12 @@ private:
 			void		_Retransmit();
 			void		_UpdateRoundTripTime(int32 roundTripTime, int32 expectedSamples);
 			void		_ResetSlowStart();
+			status_t	_SetCongestionControl(const char* name);
 			void		_DuplicateAcknowledge(tcp_segment_header& segment);
+			bool		_UseSack() const;
+			void		_EnterSackRecovery();
+			void		_SendSackRecovery();
+			uint32		_Pipe() const;
 
 	static	void		_TimeWaitTimer(net_timer* timer, void* _endpoint);
 	static	void		_RetransmitTimer(net_timer* timer, void* _endpoint);
@@ -153,6 +164,8 @@ private:
 	uint32			fDuplicateAcknowledgeCount;
 	uint32			fPreviousFlightSize;
 	uint32			fRecover;
+	SackScoreboard	fSackScoreboard;
+	tcp_sequence	fRetransmitHigh;
 
 	net_route		*fRoute;
 		// TODO: don't use a net_route, but a net_route_info!!!
@@ -178,6 +191,7 @@ private:
 
 	uint32			fCongestionWindow;
 	uint32			fSlowStartThreshold;
+	CongestionControl* fCongestionControl;
 
 	tcp_state		fState;
 	uint32			fFlags;
@@ -1,5 +1,5 @@
 /*
- * Copyright 2006-2009, Haiku, Inc. All Rights Reserved.
+ * Copyright 2006-2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -16,6 +16,7 @@
 #include <net_protocol.h>
 #include <net_stat.h>
 
+#include <driver_settings.h>
 #include <KernelExport.h>
 #include <util/list.h>
 
@@ -25,6 +26,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <kernel.h>
 #include <lock.h>
 #include <util/AutoLock.h>
 
@@ -292,6 +294,60 @@ dump_endpoint(int argc, char** argv)
 }
 
 
+/*!	Collects the statistics of all endpoint managers, and copies them to
+	\a _stat, which is a userland buffer when called from a syscall.
+*/
+static status_t
+get_statistics(void* _stat, size_t length)
+{
+	if (_stat == NULL || length < sizeof(tcp_stat))
+		return B_BAD_VALUE;
+
+	tcp_stat stat;
+	memset(&stat, 0, sizeof(tcp_stat));
+
+	ReadLocker locker(sEndpointManagersLock);
+
+	for (int i = 0; i < AF_MAX; i++) {
+		EndpointManager* manager = sEndpointManagers[i];
+		if (manager == NULL)
+			continue;
+
+		tcp_stat managerStat;
+		manager->GetStatistics(managerStat);
+
+		stat.time_wait_count += managerStat.time_wait_count;
+		stat.time_wait_limit += managerStat.time_wait_limit;
+		stat.time_wait_entered += managerStat.time_wait_entered;
+		stat.time_wait_expired += managerStat.time_wait_expired;
+		stat.time_wait_evicted += managerStat.time_wait_evicted;
+		stat.time_wait_recycled += managerStat.time_wait_recycled;
+		stat.syn_cache_count += managerStat.syn_cache_count;
+		stat.syn_cache_limit += managerStat.syn_cache_limit;
+		stat.syn_cache_added += managerStat.syn_cache_added;
+		stat.syn_cache_completed += managerStat.syn_cache_completed;
+		stat.syn_cache_retransmits += managerStat.syn_cache_retransmits;
+		stat.syn_cache_timed_out += managerStat.syn_cache_timed_out;
+		stat.syn_cache_reset += managerStat.syn_cache_reset;
+		stat.syn_cache_evicted += managerStat.syn_cache_evicted;
+		stat.syn_cookies_sent += managerStat.syn_cookies_sent;
+		stat.syn_cookies_accepted += managerStat.syn_cookies_accepted;
+		stat.syn_cookies_rejected += managerStat.syn_cookies_rejected;
+	}
+
+	locker.Unlock();
+
+	if (gStackModule->is_syscall()) {
+		if (!IS_USER_ADDRESS(_stat)
+			|| user_memcpy(_stat, &stat, sizeof(tcp_stat)) != B_OK)
+			return B_BAD_ADDRESS;
+	} else
+		memcpy(_stat, &stat, sizeof(tcp_stat));
+
+	return B_OK;
+}
+
+
 //	#pragma mark - internal API
 
 
@@ -537,6 +593,8 @@ tcp_control(net_protocol* _protocol, int level, int option, void* value,
 		if (option == NET_STAT_SOCKET)
 			return protocol->FillStat((net_stat*)value);
 	}
+	if (level == LEVEL_DRIVER_IOCTL && option == NET_STAT_PROTOCOL)
+		return get_statistics(value, *_length);
 
 	return protocol->next->module->control(protocol->next, level, option,
 		value, _length);
@@ -722,7 +780,13 @@ tcp_receive_data(net_buffer* buffer)
 
 	TCPEndpoint* endpoint = endpointManager->FindConnection(
 		buffer->destination, buffer->source);
-	if (endpoint != NULL) {
+	if ((endpoint == NULL || endpoint->State() == LISTEN)
+		&& endpointManager->TimeWaitSegmentReceived(segment, buffer,
+			segmentAction)) {
+		// the connection is in TIME_WAIT, and no longer has an endpoint
+		if (endpoint != NULL)
+			gSocketModule->release_socket(endpoint->socket);
+	} else if (endpoint != NULL) {
 		segmentAction = endpoint->SegmentReceived(segment, buffer);
 
 		// There are some states in which the socket could have been deleted
@@ -764,11 +828,47 @@ tcp_error_reply(net_protocol* protocol, net_buffer* cause, net_error error,
 //	#pragma mark -
 
 
+/*!	Reads the system wide defaults from the "tcp" driver settings file, ie.
+	~/config/settings/kernel/drivers/tcp, for example:
+		congestion_control newreno
+		time_wait_entries 16384
+		syn_cache_entries 2048
+		syn_cookies off
+	The table sizes are per address family.
+*/
+static void
+load_settings()
+{
+	void* handle = load_driver_settings("tcp");
+	if (handle == NULL)
+		return;
+
+	const char* name = get_driver_parameter(handle, "congestion_control",
+		NULL, NULL);
+	if (name != NULL && CongestionControl::SetDefault(name) != B_OK) {
+		dprintf("tcp: unknown congestion control algorithm \"%s\"\n",
+			name);
+	}
+
+	const char* timeWaitEntries = get_driver_parameter(handle,
+		"time_wait_entries", "4096", "4096");
+	const char* synCacheEntries = get_driver_parameter(handle,
+		"syn_cache_entries", "1024", "1024");
+	EndpointManager::SetCacheLimits(strtoul(timeWaitEntries, NULL, 0),
+		strtoul(synCacheEntries, NULL, 0),
+		get_driver_boolean_parameter(handle, "syn_cookies", true, true));
+
+	unload_driver_settings(handle);
+}
+
+
 static status_t
 tcp_init()
 {
 	rw_lock_init(&sEndpointManagersLock, "endpoint managers");
 
+	load_settings();
+
 	status_t status = gStackModule->register_domain_protocols(AF_INET,
 		SOCK_STREAM, 0,
 		"network/protocols/tcp/v1",
@@ -278,6 +278,17 @@ enum tcp_segment_action {
 };
 
 
+static const int kTimestampFactor = 1000;
+	// conversion factor between usec system time and msec tcp time
+
+
+static inline uint32
+tcp_now()
+{
+	return system_time() / kTimestampFactor;
+}
+
+
 extern net_buffer_module_info* gBufferModule;
 extern net_datalink_module_info* gDatalinkModule;
 extern net_socket_module_info* gSocketModule;
@@ -7,6 +7,7 @@
  */
 
 #include <Application.h>
+#include <File.h>
 #include <FindDirectory.h>
 #include <Path.h>
 #include <Screen.h>
@@ -25,9 +26,10 @@
 void
 print_usage(const char *app)
 {
-	printf("usage:\t%s <host> [-p <port>] [-w <width>] [-h <height>]\n", app);
+	printf("usage:\t%s <host> [-p <port>] [-w <width>] [-h <height>]"
+		" [-r <file>]\n", app);
 	printf("usage:\t%s <user@host> -s [<sshPort>] [-p <port>] [-w <width>]"
-		" [-h <height>] [-c <command>]\n", app);
+		" [-h <height>] [-c <command>] [-r <file>]\n", app);
 	printf("\t%s --help\n\n", app);
 
 	printf("Connect to & run applications from a different computer\n\n");
@@ -37,6 +39,7 @@ print_usage(const char *app)
 	printf("\t-s\t\tuse SSH, optionally specify the SSH port to use (22)\n");
 	printf("\t-w\t\tmake the virtual desktop use the specified width\n");
 	printf("\t-h\t\tmake the virtual desktop use the specified height\n");
+	printf("\t-r\t\trecord the drawing commands received to a file\n");
 	printf("\nIf no width and height are specified, the window is opened with"
 		" the size of the the local screen.\n");
 }
@@ -56,6 +59,7 @@ main(int argc, char *argv[])
 	int32 height = -1;
 	bool useSSH = false;
 	const char *command = NULL;
+	const char *recordPath = NULL;
 	const char *host = argv[1];
 
 	for (int32 i = 2; i < argc; i++) {
@@ -113,6 +117,17 @@ main(int argc, char *argv[])
 			continue;
 		}
 
+		if (strcmp(argv[i], "-r") == 0) {
+			if (argc < i + 1) {
+				print_usage(argv[0]);
+				return 2;
+			}
+
+			i++;
+			recordPath = argv[i];
+			continue;
+		}
+
 		print_usage(argv[0]);
 		return 2;
 	}
@@ -191,6 +206,17 @@ main(int argc, char *argv[])
 		}
 	}
 
+	BFile recordFile;
+	if (recordPath != NULL) {
+		status_t result = recordFile.SetTo(recordPath,
+			B_WRITE_ONLY | B_CREATE_FILE | B_ERASE_FILE);
+		if (result != B_OK) {
+			printf("failed to open record file %s: %s\n", recordPath,
+				strerror(result));
+			return 3;
+		}
+	}
+
 	BApplication app("application/x-vnd.Haiku-RemoteDesktop");
 	BRect windowFrame = BRect(0, 0, width - 1, height - 1);
 	if (!windowFrame.IsValid()) {
@@ -207,7 +233,7 @@ main(int argc, char *argv[])
 	}
 
 	RemoteView *view = new(std::nothrow) RemoteView(window->Bounds(), host,
-		port);
+		port, recordPath != NULL ? &recordFile : NULL);
 	if (view == NULL) {
 		printf("no memory to allocate remote view\n");
 		return 4;
@@ -54,7 +54,8 @@ typedef struct engine_state {
 } engine_state;
 
 
-RemoteView::RemoteView(BRect frame, const char *remoteHost, uint16 remotePort)
+RemoteView::RemoteView(BRect frame, const char *remoteHost, uint16 remotePort,
+	BDataIO *recordTarget)
 	:
 	BView(frame, "RemoteView", B_FOLLOW_NONE, B_WILL_DRAW),
 	fInitStatus(B_NO_INIT),
@@ -67,6 +68,7 @@ RemoteView::RemoteView(BRect frame, const char *remoteHost, uint16 remotePort)
 	fStopThread(false),
 	fOffscreenBitmap(NULL),
 	fOffscreen(NULL),
+	fBitmapTiles(NULL),
 	fViewCursor(kCursorData),
 	fCursorBitmap(NULL),
 	fCursorVisible(false)
@@ -114,7 +116,8 @@ RemoteView::RemoteView(BRect frame, const char *remoteHost, uint16 remotePort)
 		return;
 	}
 
-	fReceiver = new(std::nothrow) NetReceiver(fEndpoint, fReceiveBuffer);
+	fReceiver = new(std::nothrow) NetReceiver(fEndpoint, fReceiveBuffer, NULL,
+		NULL, recordTarget);
 	if (fReceiver == NULL) {
 		fInitStatus = B_NO_MEMORY;
 		TRACE_ERROR("no memory available\n");
@@ -141,6 +144,15 @@ RemoteView::RemoteView(BRect frame, const char *remoteHost, uint16 remotePort)
 	fOffscreenBitmap->AddChild(fOffscreen);
 	fOffscreen->SetDrawingMode(B_OP_COPY);
 
+	fBitmapTiles = new(std::nothrow) BBitmap *[kRemoteBitmapCacheSlots];
+	if (fBitmapTiles == NULL) {
+		fInitStatus = B_NO_MEMORY;
+		TRACE_ERROR("no memory available\n");
+		return;
+	}
+
+	memset(fBitmapTiles, 0, kRemoteBitmapCacheSlots * sizeof(BBitmap *));
+
 	fDrawThread = spawn_thread(&_DrawEntry, "draw thread", B_NORMAL_PRIORITY,
 		this);
 	if (fDrawThread < 0) {
@@ -173,6 +185,12 @@ RemoteView::~RemoteView()
 
 	int32 result;
 	wait_for_thread(fDrawThread, &result);
+
+	if (fBitmapTiles != NULL) {
+		for (uint32 i = 0; i < kRemoteBitmapCacheSlots; i++)
+			delete fBitmapTiles[i];
+		delete[] fBitmapTiles;
+	}
 }
 
 
@@ -442,7 +460,12 @@ RemoteView::_DrawThread()
 	// cursor
 	BPoint cursorHotSpot(0, 0);
 
+	uint32 capabilities = RP_CAPABILITY_BITMAP_CACHE;
+	if (NetReceiver::SupportsCompression())
+		capabilities |= RP_CAPABILITY_COMPRESSION;
+
 	reply.Start(RP_INIT_CONNECTION);
+	reply.Add(capabilities);
 	reply.Flush();
 
 	while (!fStopThread) {
@@ -484,6 +507,10 @@ RemoteView::_DrawThread()
 				continue;
 			}
 
+			case RP_ENABLE_COMPRESSION:
+				// already handled by the receiver
+				continue;
+
 			case RP_CREATE_STATE:
 			case RP_DELETE_STATE:
 			{
@@ -803,6 +830,60 @@ RemoteView::_DrawThread()
 				break;
 			}
 
+			case RP_DRAW_BITMAP_TILES:
+			{
+				color_space colorSpace;
+				int32 tileCount;
+				uint32 flags, options;
+
+				message.Read(options);
+				message.Read(colorSpace);
+				message.Read(flags);
+				message.Read(tileCount);
+				for (int32 i = 0; i < tileCount; i++) {
+					BRect viewRect;
+					int32 slot;
+					bool cached;
+
+					message.Read(viewRect);
+					message.Read(slot);
+					if (message.Read(cached) != B_OK)
+						break;
+
+					bool keep = slot >= 0
+						&& (uint32)slot < kRemoteBitmapCacheSlots;
+					BBitmap *bitmap = NULL;
+					if (cached) {
+						if (keep)
+							bitmap = fBitmapTiles[slot];
+					} else {
+						if (message.ReadBitmap(&bitmap, true, colorSpace,
+								flags) != B_OK) {
+							break;
+						}
+
+						if (keep) {
+							delete fBitmapTiles[slot];
+							fBitmapTiles[slot] = bitmap;
+						}
+					}
+
+					if (bitmap == NULL) {
+						TRACE_ERROR("missing bitmap tile %" B_PRId32 "\n",
+							slot);
+						continue;
+					}
+
+					offscreen->DrawBitmap(bitmap, bitmap->Bounds(), viewRect,
+						options);
+					invalidRegion.Include(viewRect);
+					if (!keep)
+						delete bitmap;
+				}
+
+				break;
+			}
+
 			case RP_STROKE_ARC:
 			case RP_FILL_ARC:
 			case RP_FILL_ARC_GRADIENT:
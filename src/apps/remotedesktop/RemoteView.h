@@ -14,6 +14,7 @@
 #include <View.h>
 
 class BBitmap;
+class BDataIO;
 class NetReceiver;
 class NetSender;
 class StreamingRingBuffer;
@@ -24,7 +25,8 @@ class RemoteView : public BView {
 public:
 									RemoteView(BRect frame,
 										const char *remoteHost,
-										uint16 remotePort);
+										uint16 remotePort,
+										BDataIO *recordTarget = NULL);
 virtual								~RemoteView();
 
 		status_t					InitCheck();
@@ -76,6 +78,8 @@ static	int32						_DrawEntry(void *data);
 		BBitmap *					fOffscreenBitmap;
 		BView *						fOffscreen;
 
+		BBitmap **					fBitmapTiles;
+
 		BCursor						fViewCursor;
 		BBitmap *					fCursorBitmap;
 		BRect						fCursorFrame;
@@ -1,5 +1,5 @@
 /*
- * Copyright 2006-2019, Haiku, Inc. All Rights Reserved.
+ * Copyright 2006-2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -17,6 +17,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
 #include <unistd.h>
 
 #include <SupportDefs.h>
@@ -112,15 +114,61 @@ inet_print_address(sockaddr* _address)
 }
 
 
+static int
+print_tcp_statistics()
+{
+	int socket = ::socket(AF_INET, SOCK_STREAM, 0);
+	if (socket < 0) {
+		fprintf(stderr, "%s: could not create TCP socket: %s\n", kProgramName,
+			strerror(errno));
+		return 1;
+	}
+
+	tcp_stat stat;
+	int result = ioctl(socket, NET_STAT_PROTOCOL, &stat, sizeof(tcp_stat));
+	close(socket);
+
+	if (result != 0) {
+		fprintf(stderr, "%s: could not retrieve TCP statistics: %s\n",
+			kProgramName, strerror(errno));
+		return 1;
+	}
+
+	printf("tcp:\n");
+	printf("	%" B_PRIu32 " connections in TIME_WAIT table (limit %" B_PRIu32
+		")\n", stat.time_wait_count, stat.time_wait_limit);
+	printf("		%" B_PRIu64 " entered\n", stat.time_wait_entered);
+	printf("		%" B_PRIu64 " expired\n", stat.time_wait_expired);
+	printf("		%" B_PRIu64 " evicted when full\n", stat.time_wait_evicted);
+	printf("		%" B_PRIu64 " reused by new connections\n",
+		stat.time_wait_recycled);
+	printf("	%" B_PRIu32 " connection requests in SYN cache (limit %"
+		B_PRIu32 ")\n", stat.syn_cache_count, stat.syn_cache_limit);
+	printf("		%" B_PRIu64 " added\n", stat.syn_cache_added);
+	printf("		%" B_PRIu64 " completed\n", stat.syn_cache_completed);
+	printf("		%" B_PRIu64 " SYN+ACK retransmits\n",
+		stat.syn_cache_retransmits);
+	printf("		%" B_PRIu64 " timed out\n", stat.syn_cache_timed_out);
+	printf("		%" B_PRIu64 " reset by peer\n", stat.syn_cache_reset);
+	printf("		%" B_PRIu64 " evicted when full\n", stat.syn_cache_evicted);
+	printf("	%" B_PRIu64 " SYN cookies sent\n", stat.syn_cookies_sent);
+	printf("		%" B_PRIu64 " accepted\n", stat.syn_cookies_accepted);
+	printf("		%" B_PRIu64 " rejected\n", stat.syn_cookies_rejected);
+
+	return 0;
+}
+
+
 //	#pragma mark -
 
 
 void
 usage(int status)
 {
-	printf("Usage: %s [-nh]\n", kProgramName);
+	printf("Usage: %s [-nhs]\n", kProgramName);
 	printf("Options:\n");
 	printf("	-n	don't resolve names\n");
+	printf("	-s	show protocol statistics\n");
 	printf("	-h	this help\n");
 	printf("Filter options:\n");
 	printf("	-4	IPv4\n");
@@ -166,6 +214,7 @@ main(int argc, char** argv)
 	const static struct option kLongOptions[] = {
 		{"help", no_argument, 0, 'h'},
 		{"numeric", no_argument, 0, 'n'},
+		{"statistics", no_argument, 0, 's'},
 
 		{"inet", no_argument, 0, '4'},
 		{"inet6", no_argument, 0, '6'},
@@ -180,7 +229,7 @@ main(int argc, char** argv)
 	};
 
 	do {
-		opt = getopt_long(argc, argv, "hn46xtul", kLongOptions,
+		opt = getopt_long(argc, argv, "hns46xtul", kLongOptions,
 			&optionIndex);
 		switch (opt) {
 			case -1:
@@ -190,6 +239,8 @@ main(int argc, char** argv)
 			case 'n':
 				sResolveNames = 0;
 				break;
+			case 's':
+				return print_tcp_statistics();
 
 			// Family filter
 			case '4':
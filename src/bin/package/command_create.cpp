@@ -20,6 +20,8 @@
 #include <package/hpkg/HPKGDefs.h>
 #include <package/hpkg/PackageWriter.h>
 
+#include <ZstdCompressionAlgorithm.h>
+
 #include "package.h"
 #include "PackageWriterListener.h"
 #include "PackageWritingUtils.h"
@@ -41,17 +43,19 @@ command_create(int argc, const char* const* argv)
 	bool verbose = false;
 	int32 compressionLevel = BPackageKit::BHPKG::B_HPKG_COMPRESSION_LEVEL_BEST;
 	int32 compression = BPackageKit::BHPKG::B_HPKG_COMPRESSION_ZLIB;
+	int32 threadCount = 0;
 
 	while (true) {
 		static struct option sLongOptions[] = {
 			{ "help", no_argument, 0, 'h' },
+			{ "level", required_argument, 0, 'l' },
 			{ "quiet", no_argument, 0, 'q' },
 			{ "verbose", no_argument, 0, 'v' },
 			{ 0, 0, 0, 0 }
 		};
 
 		opterr = 0; // don't print errors
-		int c = getopt_long(argc, (char**)argv, "+b0123456789C:hi:I:qvz",
+		int c = getopt_long(argc, (char**)argv, "+b0123456789C:hi:I:j:qvz",
 			sLongOptions, NULL);
 		if (c == -1)
 			break;
@@ -90,6 +94,19 @@ command_create(int argc, const char* const* argv)
 				installPath = optarg;
 				break;
 
+			case 'j':
+				threadCount = atoi(optarg);
+				if (threadCount < 1) {
+					fprintf(stderr, "Error: Invalid thread count \"%s\".\n",
+						optarg);
+					return 1;
+				}
+				break;
+
+			case 'l':
+				compressionLevel = atoi(optarg);
+				break;
+
 			case 'q':
 				quiet = true;
 				break;
@@ -114,6 +131,17 @@ command_create(int argc, const char* const* argv)
 
 	const char* packageFileName = argv[optind++];
 
+	// zstd has more compression levels than zlib
+	int32 maxCompressionLevel
+		= compression == BPackageKit::BHPKG::B_HPKG_COMPRESSION_ZSTD
+			? B_ZSTD_COMPRESSION_BEST
+			: BPackageKit::BHPKG::B_HPKG_COMPRESSION_LEVEL_BEST;
+	if (compressionLevel < 0 || compressionLevel > maxCompressionLevel) {
+		fprintf(stderr, "Error: The compression level must be between 0 and "
+			"%" B_PRId32 ".\n", maxCompressionLevel);
+		return 1;
+	}
+
 	// -I is only allowed when -b is given
 	if (installPath != NULL && !isBuildPackage) {
 		fprintf(stderr, "Error: \"-I\" is only allowed when \"-b\" is "
@@ -144,6 +172,7 @@ command_create(int argc, const char* const* argv)
 	if (compressionLevel == 0)
 		compression = BPackageKit::BHPKG::B_HPKG_COMPRESSION_NONE;
 	writerParameters.SetCompression(compression);
+	writerParameters.SetThreadCount(threadCount);
 
 	PackageWriterListener listener(verbose, quiet);
 	BPackageWriter packageWriter(&listener);
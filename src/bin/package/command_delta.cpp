@@ -0,0 +1,124 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <package/hpkg/PackageDeltaWriter.h>
+#include <package/hpkg/StandardErrorOutput.h>
+
+#include <AutoDeleter.h>
+
+#include "package.h"
+
+
+using BPackageKit::BHPKG::BStandardErrorOutput;
+using BPackageKit::BHPKG::BPrivate::PackageDeltaWriter;
+
+
+static int
+open_file(const char* path, int openMode)
+{
+	int fd = open(path, openMode, 0644);
+	if (fd < 0) {
+		fprintf(stderr, "Error: Failed to open \"%s\": %s\n", path,
+			strerror(errno));
+		exit(1);
+	}
+
+	return fd;
+}
+
+
+int
+command_delta(int argc, const char* const* argv)
+{
+	bool quiet = false;
+	bool verbose = false;
+
+	while (true) {
+		static struct option sLongOptions[] = {
+			{ "help", no_argument, 0, 'h' },
+			{ "quiet", no_argument, 0, 'q' },
+			{ "verbose", no_argument, 0, 'v' },
+			{ 0, 0, 0, 0 }
+		};
+
+		opterr = 0; // don't print errors
+		int c = getopt_long(argc, (char**)argv, "+hqv", sLongOptions, NULL);
+		if (c == -1)
+			break;
+
+		switch (c) {
+			case 'h':
+				print_usage_and_exit(false);
+				break;
+
+			case 'q':
+				quiet = true;
+				break;
+
+			case 'v':
+				verbose = true;
+				break;
+
+			default:
+				print_usage_and_exit(true);
+				break;
+		}
+	}
+
+	// The remaining arguments are the base and target package and the delta.
+	if (optind + 3 != argc)
+		print_usage_and_exit(true);
+
+	const char* basePath = argv[optind++];
+	const char* targetPath = argv[optind++];
+	const char* deltaPath = argv[optind++];
+
+	int baseFD = open_file(basePath, O_RDONLY);
+	FileDescriptorCloser baseFDCloser(baseFD);
+	int targetFD = open_file(targetPath, O_RDONLY);
+	FileDescriptorCloser targetFDCloser(targetFD);
+
+	BStandardErrorOutput errorOutput;
+	PackageDeltaWriter deltaWriter(&errorOutput);
+	status_t error = deltaWriter.Init(baseFD, targetFD);
+	if (error != B_OK) {
+		fprintf(stderr, "Error: Failed to compare \"%s\" and \"%s\": %s\n",
+			basePath, targetPath, strerror(error));
+		return 1;
+	}
+
+	int deltaFD = open_file(deltaPath, O_WRONLY | O_CREAT | O_TRUNC);
+	FileDescriptorCloser deltaFDCloser(deltaFD);
+
+	error = deltaWriter.Finish(deltaFD);
+	if (error != B_OK) {
+		fprintf(stderr, "Error: Failed to write delta \"%s\": %s\n",
+			deltaPath, strerror(error));
+		deltaFDCloser.Unset();
+		unlink(deltaPath);
+		return 1;
+	}
+
+	if (verbose) {
+		printf("copied from the base: %10" B_PRIu64 " bytes\n",
+			deltaWriter.CopiedSize());
+		printf("contained in delta:   %10" B_PRIu64 " bytes\n",
+			deltaWriter.DataSize());
+	}
+
+	if (!quiet)
+		printf("Delta \"%s\" created.\n", deltaPath);
+
+	return 0;
+}
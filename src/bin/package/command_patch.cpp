@@ -0,0 +1,112 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <package/hpkg/PackageDeltaReader.h>
+#include <package/hpkg/StandardErrorOutput.h>
+
+#include <AutoDeleter.h>
+
+#include "package.h"
+
+
+using BPackageKit::BHPKG::BStandardErrorOutput;
+using BPackageKit::BHPKG::BPrivate::PackageDeltaReader;
+
+
+static int
+open_file(const char* path, int openMode)
+{
+	int fd = open(path, openMode, 0644);
+	if (fd < 0) {
+		fprintf(stderr, "Error: Failed to open \"%s\": %s\n", path,
+			strerror(errno));
+		exit(1);
+	}
+
+	return fd;
+}
+
+
+int
+command_patch(int argc, const char* const* argv)
+{
+	bool quiet = false;
+
+	while (true) {
+		static struct option sLongOptions[] = {
+			{ "help", no_argument, 0, 'h' },
+			{ "quiet", no_argument, 0, 'q' },
+			{ 0, 0, 0, 0 }
+		};
+
+		opterr = 0; // don't print errors
+		int c = getopt_long(argc, (char**)argv, "+hq", sLongOptions, NULL);
+		if (c == -1)
+			break;
+
+		switch (c) {
+			case 'h':
+				print_usage_and_exit(false);
+				break;
+
+			case 'q':
+				quiet = true;
+				break;
+
+			default:
+				print_usage_and_exit(true);
+				break;
+		}
+	}
+
+	// The remaining arguments are the base package, the delta, and the target
+	// package.
+	if (optind + 3 != argc)
+		print_usage_and_exit(true);
+
+	const char* basePath = argv[optind++];
+	const char* deltaPath = argv[optind++];
+	const char* targetPath = argv[optind++];
+
+	int deltaFD = open_file(deltaPath, O_RDONLY);
+	FileDescriptorCloser deltaFDCloser(deltaFD);
+
+	BStandardErrorOutput errorOutput;
+	PackageDeltaReader deltaReader(&errorOutput);
+	status_t error = deltaReader.Init(deltaFD);
+	if (error != B_OK) {
+		fprintf(stderr, "Error: Failed to read delta \"%s\": %s\n", deltaPath,
+			strerror(error));
+		return 1;
+	}
+
+	int baseFD = open_file(basePath, O_RDONLY);
+	FileDescriptorCloser baseFDCloser(baseFD);
+	int targetFD = open_file(targetPath, O_WRONLY | O_CREAT | O_TRUNC);
+	FileDescriptorCloser targetFDCloser(targetFD);
+
+	error = deltaReader.Apply(baseFD, targetFD);
+	if (error != B_OK) {
+		fprintf(stderr, "Error: Failed to apply delta \"%s\" to \"%s\": %s\n",
+			deltaPath, basePath, strerror(error));
+		targetFDCloser.Unset();
+		unlink(targetPath);
+		return 1;
+	}
+
+	if (!quiet)
+		printf("Package \"%s\" created.\n", targetPath);
+
+	return 0;
+}
@@ -71,8 +71,26 @@ static const char* kUsage =
 	"                 the package .self link to point to <path>, which is "
 		"useful\n"
 	"                 to redirect a \"make install\". Only allowed with -b.\n"
+	"    -j <count> - Compress with <count> threads. Defaults to one per "
+		"CPU. The\n"
+	"                 package is the same with any number of threads.\n"
+	"    --level <level>\n"
+	"               - Use compression level <level>. Like -0 ... -9, but "
+		"with -z\n"
+	"                 levels up to 19 can be used.\n"
 	"    -q         - Be quiet (don't show any output except for errors).\n"
 	"    -v         - Be verbose (show more info about created package).\n"
+	"    -z         - Use Zstd compression.\n"
+	"\n"
+	"  delta [ <options> ] <base package> <target package> <delta>\n"
+	"    Creates the delta file <delta>, which allows to reconstruct package\n"
+	"    file <target package> from <base package>, an older version of the\n"
+	"    package. Compressed data the packages have in common are referenced\n"
+	"    instead of being included in the delta.\n"
+	"\n"
+	"    -q         - Be quiet (don't show any output except for errors).\n"
+	"    -v         - Be verbose (show how much of the target is contained in\n"
+	"                 the delta).\n"
 	"\n"
 	"  dump [ <options> ] <package>\n"
 	"    Dumps the TOC section of package file <package>. For debugging only.\n"
@@ -107,6 +125,14 @@ static const char* kUsage =
 	"    -i         - Only print the meta information, not the files.\n"
 	"    -p         - Only print a list of file paths.\n"
 	"\n"
+	"  patch [ <options> ] <base package> <delta> <target package>\n"
+	"    Applies the delta file <delta> created by the \"delta\" command to\n"
+	"    <base package> and writes the result to <target package>. Fails, if\n"
+	"    <base package> isn't the package the delta was created for, or if the\n"
+	"    result doesn't match the checksum recorded in the delta.\n"
+	"\n"
+	"    -q         - Be quiet (don't show any output except for errors).\n"
+	"\n"
 	"  recompress [ <options> ] <input package> <output package>\n"
 	"    Reads the package file <input package> and writes it to new package\n"
 	"    <output package> using the specified compression options. If the\n"
@@ -152,6 +178,9 @@ main(int argc, const char* const* argv)
 	if (strcmp(command, "create") == 0)
 		return command_create(argc - 1, argv + 1);
 
+	if (strcmp(command, "delta") == 0)
+		return command_delta(argc - 1, argv + 1);
+
 	if (strcmp(command, "dump") == 0)
 		return command_dump(argc - 1, argv + 1);
 
@@ -164,6 +193,9 @@ main(int argc, const char* const* argv)
 	if (strcmp(command, "info") == 0)
 		return command_info(argc - 1, argv + 1);
 
+	if (strcmp(command, "patch") == 0)
+		return command_patch(argc - 1, argv + 1);
+
 	if (strcmp(command, "recompress") == 0)
 		return command_recompress(argc - 1, argv + 1);
 
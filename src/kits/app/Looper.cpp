@@ -55,6 +55,24 @@ static BLocker sDebugPrintLocker("BLooper debug print");
 #define FILTER_LIST_BLOCK_SIZE	5
 #define DATA_BLOCK_SIZE			5
 
+// The size of the buffer used to read several messages from the port at
+// once, and the number of messages that are added to the queue at once.
+static const size_t kPortReadBufferSize = 8192;
+static const int32 kMessageBatchSize = 32;
+
+// Messages of at least this size are passed through an area by the kernel,
+// and are best read with read_port_area_etc().
+static const size_t kAreaMessageSize = 64 * 1024;
+
+
+// A message buffer read by ReadMessageFromPort(), that ConvertToMessage()
+// may hand over to the message it creates.
+struct BPrivate::PortMessageBuffer {
+	void*	buffer;
+	size_t	size;
+	area_id	area;
+};
+
 
 using BPrivate::gDefaultTokens;
 using BPrivate::gLooperList;
@@ -1018,6 +1036,7 @@ BLooper::_InitData(const char* name, int32 priority, port_id port,
 	fThread = B_ERROR;
 	fTerminating = false;
 	fOwnsPort = true;
+	fPortMessageBuffer = NULL;
 	fMsgPort = -1;
 	fAtomicCount = 0;
 
@@ -1074,6 +1093,67 @@ BLooper::_AddMessagePriv(BMessage* message)
 }
 
 
+/*!	Reads the messages that are waiting in the port (after waiting up to
+	\a timeout for the first one), and adds them to the message queue.
+	Messages are read in batches with as few syscalls as possible; only
+	messages that don't fit into the batch buffer are read one by one.
+*/
+void
+BLooper::_DequeueMessages(bigtime_t timeout)
+{
+	uint64 buffer[kPortReadBufferSize / sizeof(uint64)];
+	BMessage* messages[kMessageBatchSize];
+
+	while (true) {
+		ssize_t count;
+		do {
+			count = read_port_multiple_etc(fMsgPort, buffer, sizeof(buffer),
+				B_RELATIVE_TIMEOUT, timeout);
+		} while (count == B_INTERRUPTED);
+
+		if (count == B_BUFFER_OVERFLOW) {
+			// the next message is too large for our buffer
+			BMessage* message = ReadMessageFromPort(0);
+			if (message != NULL)
+				_AddMessagePriv(message);
+
+			timeout = 0;
+			continue;
+		}
+		if (count <= 0)
+			return;
+
+		port_message_header* header = (port_message_header*)buffer;
+		int32 messageCount = 0;
+
+		for (int32 i = 0; i < count; i++) {
+			// empty messages are only used to wake up the looper
+			BMessage* message = header->size > 0
+				? ConvertToMessage(header + 1, header->code) : NULL;
+			if (message != NULL) {
+				messages[messageCount++] = message;
+				if (messageCount == kMessageBatchSize) {
+					fDirectTarget->Queue()->_AddMessages(messages,
+						messageCount);
+					messageCount = 0;
+				}
+			}
+
+			header = PORT_MESSAGE_NEXT(header);
+		}
+
+		fDirectTarget->Queue()->_AddMessages(messages, messageCount);
+
+		// If the buffer is less than half full, the port was empty; we
+		// don't want to try again in this case, and waste another syscall.
+		if ((uint8*)header - (uint8*)buffer < (ssize_t)sizeof(buffer) / 2)
+			return;
+
+		timeout = 0;
+	}
+}
+
+
 status_t
 BLooper::_task0_(void* arg)
 {
@@ -1131,19 +1211,68 @@ BLooper::ReadRawFromPort(int32* msgCode, bigtime_t timeout)
 }
 
 
+/*!	Reads the next message from the port, and converts it with
+	ConvertToMessage(). Unless that has been overridden, the message is
+	unflattened in place: it keeps the buffer (or area) it was read into, and
+	only copies its contents when it is changed.
+*/
 BMessage*
 BLooper::ReadMessageFromPort(bigtime_t timeout)
 {
 	PRINT(("BLooper::ReadMessageFromPort()\n"));
-	int32 msgCode;
-	BMessage* message = NULL;
+	ssize_t bufferSize;
 
-	void* buffer = ReadRawFromPort(&msgCode, timeout);
-	if (buffer == NULL)
+	do {
+		bufferSize = port_buffer_size_etc(fMsgPort, B_RELATIVE_TIMEOUT, timeout);
+	} while (bufferSize == B_INTERRUPTED);
+
+	if (bufferSize < B_OK) {
+		PRINT(("BLooper::ReadMessageFromPort(): failed: %ld\n", bufferSize));
+		return NULL;
+	}
+
+	int32 code;
+	if (bufferSize == 0) {
+		// empty messages are only used to wake up the looper
+		read_port_etc(fMsgPort, &code, NULL, 0, B_RELATIVE_TIMEOUT, 0);
 		return NULL;
+	}
+
+	// we don't want to wait again below, since that can only mean that
+	// someone else has read our message and our bufferSize is now wrong
+	BPrivate::PortMessageBuffer portBuffer = { NULL, (size_t)bufferSize, -1 };
+
+	if ((size_t)bufferSize >= kAreaMessageSize) {
+		portBuffer.area = read_port_area_etc(fMsgPort, &code,
+			&portBuffer.buffer, &portBuffer.size, B_RELATIVE_TIMEOUT, 0);
+		if (portBuffer.area < 0)
+			return NULL;
+	} else {
+		portBuffer.buffer = malloc(bufferSize);
+		if (portBuffer.buffer == NULL)
+			return NULL;
+
+		bufferSize = read_port_etc(fMsgPort, &code, portBuffer.buffer,
+			bufferSize, B_RELATIVE_TIMEOUT, 0);
+		if (bufferSize < B_OK) {
+			free(portBuffer.buffer);
+			return NULL;
+		}
+		portBuffer.size = bufferSize;
+	}
 
-	message = ConvertToMessage(buffer, msgCode);
-	free(buffer);
+	void* buffer = portBuffer.buffer;
+	fPortMessageBuffer = &portBuffer;
+	BMessage* message = ConvertToMessage(buffer, code);
+	fPortMessageBuffer = NULL;
+
+	// free the buffer, if the message didn't take it over
+	if (portBuffer.buffer != NULL) {
+		if (portBuffer.area >= 0)
+			delete_area(portBuffer.area);
+		else
+			free(portBuffer.buffer);
+	}
 
 	PRINT(("BLooper::ReadMessageFromPort() done: %p\n", message));
 	return message;
@@ -1158,7 +1287,18 @@ BLooper::ConvertToMessage(void* buffer, int32 code)
 		return NULL;
 
 	BMessage* message = new BMessage();
-	if (message->Unflatten((const char*)buffer) != B_OK) {
+
+	status_t error;
+	if (fPortMessageBuffer != NULL && fPortMessageBuffer->buffer == buffer) {
+		// the buffer has been read by ReadMessageFromPort() and is ours to
+		// keep; the message takes it over
+		fPortMessageBuffer->buffer = NULL;
+		error = BMessage::Private(message).UnflattenInPlace(buffer,
+			fPortMessageBuffer->size, fPortMessageBuffer->area);
+	} else
+		error = message->Unflatten((const char*)buffer);
+
+	if (error != B_OK) {
 		PRINT(("BLooper::ConvertToMessage(): unflattening message failed\n"));
 		delete message;
 		message = NULL;
@@ -1186,24 +1326,10 @@ BLooper::task_looper()
 		PRINT(("LOOPER: outer loop\n"));
 		// TODO: timeout determination algo
 		//	Read from message port (how do we determine what the timeout is?)
-		PRINT(("LOOPER: MessageFromPort()...\n"));
-		BMessage* msg = MessageFromPort();
+		PRINT(("LOOPER: _DequeueMessages()...\n"));
+		_DequeueMessages(B_INFINITE_TIMEOUT);
 		PRINT(("LOOPER: ...done\n"));
 
-		//	Did we get a message?
-		if (msg)
-			_AddMessagePriv(msg);
-
-		// Get message count from port
-		int32 msgCount = port_count(fMsgPort);
-		for (int32 i = 0; i < msgCount; ++i) {
-			// Read 'count' messages from port (so we will not block)
-			// We use zero as our timeout since we know there is stuff there
-			msg = MessageFromPort(0);
-			if (msg)
-				_AddMessagePriv(msg);
-		}
-
 		// loop: As long as there are messages in the queue and the port is
 		//		 empty... and we are not terminating, of course.
 		bool dispatchNextMessage = true;
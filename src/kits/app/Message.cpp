@@ -207,7 +207,7 @@ BMessage::operator=(const BMessage& other)
 	// apply to the clone.
 	fHeader->flags &= ~(MESSAGE_FLAG_REPLY_REQUIRED | MESSAGE_FLAG_REPLY_DONE
 		| MESSAGE_FLAG_IS_REPLY | MESSAGE_FLAG_WAS_DELIVERED
-		| MESSAGE_FLAG_PASS_BY_AREA);
+		| MESSAGE_FLAG_PASS_BY_AREA | MESSAGE_FLAG_IN_PLACE);
 	// Note, that BeOS R5 seems to keep the reply info.
 
 	if (fHeader->field_count > 0) {
@@ -410,6 +410,12 @@ BMessage::_Clear()
 		if (fHeader->message_area >= 0)
 			_Dereference();
 
+		if ((fHeader->flags & MESSAGE_FLAG_IN_PLACE) != 0) {
+			// the fields and data are freed with the header
+			fFields = NULL;
+			fData = NULL;
+		}
+
 		free(fHeader);
 		fHeader = NULL;
 	}
@@ -778,7 +784,7 @@ BMessage::Rename(const char* oldEntry, const char* newEntry)
 		return B_NO_INIT;
 
 	status_t result;
-	if (fHeader->message_area >= 0) {
+	if (_NeedsCopyForWrite()) {
 		result = _CopyForWrite();
 		if (result != B_OK)
 			return result;
@@ -1049,7 +1055,11 @@ BMessage::Flatten(char* buffer, ssize_t size) const
 	/* we have to sync the what code as it is a public member */
 	fHeader->what = what;
 
-	memcpy(buffer, fHeader, sizeof(message_header));
+	// the in place flag only describes the local storage of the message
+	message_header header = *fHeader;
+	header.flags &= ~MESSAGE_FLAG_IN_PLACE;
+
+	memcpy(buffer, &header, sizeof(message_header));
 	buffer += sizeof(message_header);
 
 	size_t fieldsSize = fHeader->field_count * sizeof(field_header);
@@ -1075,7 +1085,10 @@ BMessage::Flatten(BDataIO* stream, ssize_t* size) const
 	/* we have to sync the what code as it is a public member */
 	fHeader->what = what;
 
-	ssize_t result1 = stream->Write(fHeader, sizeof(message_header));
+	message_header header = *fHeader;
+	header.flags &= ~MESSAGE_FLAG_IN_PLACE;
+
+	ssize_t result1 = stream->Write(&header, sizeof(message_header));
 	if (result1 != sizeof(message_header))
 		return result1 < 0 ? result1 : B_ERROR;
 
@@ -1144,6 +1157,7 @@ BMessage::_FlattenToArea(message_header** _header) const
 	memcpy(header, fHeader, sizeof(message_header));
 
 	header->what = what;
+	header->flags &= ~MESSAGE_FLAG_IN_PLACE;
 	header->message_area = -1;
 	*_header = header;
 
@@ -1224,14 +1238,23 @@ BMessage::_CopyForWrite()
 	if (fHeader == NULL)
 		return B_NO_INIT;
 
+	message_header* newHeader = NULL;
 	field_header* newFields = NULL;
 	uint8* newData = NULL;
 
+	if ((fHeader->flags & MESSAGE_FLAG_IN_PLACE) != 0) {
+		newHeader = (message_header*)malloc(sizeof(message_header));
+		if (newHeader == NULL)
+			return B_NO_MEMORY;
+	}
+
 	if (fHeader->field_count > 0) {
 		size_t fieldsSize = fHeader->field_count * sizeof(field_header);
 		newFields = (field_header*)malloc(fieldsSize);
-		if (newFields == NULL)
+		if (newFields == NULL) {
+			free(newHeader);
 			return B_NO_MEMORY;
+		}
 
 		memcpy(newFields, fFields, fieldsSize);
 	}
@@ -1239,6 +1262,7 @@ BMessage::_CopyForWrite()
 	if (fHeader->data_size > 0) {
 		newData = (uint8*)malloc(fHeader->data_size);
 		if (newData == NULL) {
+			free(newHeader);
 			free(newFields);
 			return B_NO_MEMORY;
 		}
@@ -1246,7 +1270,14 @@ BMessage::_CopyForWrite()
 		memcpy(newData, fData, fHeader->data_size);
 	}
 
-	_Dereference();
+	if (newHeader != NULL) {
+		// the old header is the buffer the fields and data were part of
+		memcpy(newHeader, fHeader, sizeof(message_header));
+		newHeader->flags &= ~MESSAGE_FLAG_IN_PLACE;
+		free(fHeader);
+		fHeader = newHeader;
+	} else
+		_Dereference();
 
 	fFieldsAvailable = 0;
 	fDataAvailable = 0;
@@ -1257,6 +1288,90 @@ BMessage::_CopyForWrite()
 }
 
 
+/*!	Returns whether the fields and data of this message are not owned by it,
+	but are shared with an area or a flattened buffer, and therefore have to
+	be copied before the message can be changed.
+*/
+bool
+BMessage::_NeedsCopyForWrite() const
+{
+	return fHeader->message_area >= 0
+		|| (fHeader->flags & MESSAGE_FLAG_IN_PLACE) != 0;
+}
+
+
+/*!	Unflattens the message from \a buffer without copying its fields and
+	data: they are accessed right where they are, and are only copied when
+	the message is changed (see _CopyForWrite()).
+
+	If \a area is valid, \a buffer lies in that area, and the message takes
+	over the area. Otherwise, \a buffer must have been allocated with malloc(),
+	and the message takes it over, using it as its header.
+	In either case, the message owns the buffer afterwards, even if an error
+	is returned. Buffers in foreign formats are unflattened the usual way.
+*/
+status_t
+BMessage::_UnflattenInPlace(void* buffer, size_t size, area_id area)
+{
+	DEBUG_FUNCTION_ENTER;
+	message_header* header = (message_header*)buffer;
+	status_t result = B_OK;
+	bool inPlace = true;
+
+	if (size < sizeof(message_header) || header->format != MESSAGE_FORMAT_HAIKU
+		|| (header->flags & MESSAGE_FLAG_PASS_BY_AREA) != 0) {
+		// there is nothing to gain from keeping the buffer
+		BMemoryIO io(buffer, size);
+		result = Unflatten(&io);
+		inPlace = false;
+	} else {
+		size_t available = size - sizeof(message_header);
+		if ((header->flags & MESSAGE_FLAG_VALID) == 0
+			|| header->field_count > available / sizeof(field_header)
+			|| header->data_size
+				> available - header->field_count * sizeof(field_header)) {
+			result = B_BAD_VALUE;
+		}
+	}
+
+	if (result != B_OK || !inPlace) {
+		if (area >= 0)
+			delete_area(area);
+		else
+			free(buffer);
+		return result;
+	}
+
+	_Clear();
+
+	if (area >= 0) {
+		fHeader = (message_header*)malloc(sizeof(message_header));
+		if (fHeader == NULL) {
+			delete_area(area);
+			return B_NO_MEMORY;
+		}
+
+		memcpy(fHeader, header, sizeof(message_header));
+		fHeader->flags &= ~MESSAGE_FLAG_IN_PLACE;
+		fHeader->message_area = area;
+	} else {
+		fHeader = header;
+		fHeader->flags |= MESSAGE_FLAG_IN_PLACE;
+		fHeader->message_area = -1;
+	}
+
+	what = fHeader->what;
+
+	uint8* fields = (uint8*)buffer + sizeof(message_header);
+	if (fHeader->field_count > 0)
+		fFields = (field_header*)fields;
+	if (fHeader->data_size > 0)
+		fData = fields + fHeader->field_count * sizeof(field_header);
+
+	return _ValidateMessage();
+}
+
+
 status_t
 BMessage::_ValidateMessage()
 {
@@ -1332,6 +1447,7 @@ BMessage::Unflatten(BDataIO* stream)
 		return result < 0 ? result : B_BAD_VALUE;
 	}
 
+	fHeader->flags &= ~MESSAGE_FLAG_IN_PLACE;
 	what = fHeader->what;
 
 	if ((fHeader->flags & MESSAGE_FLAG_PASS_BY_AREA) != 0
@@ -1797,7 +1913,7 @@ BMessage::AddData(const char* name, type_code type, const void* data,
 		return B_NO_INIT;
 
 	status_t result;
-	if (fHeader->message_area >= 0) {
+	if (_NeedsCopyForWrite()) {
 		result = _CopyForWrite();
 		if (result != B_OK)
 			return result;
@@ -1862,7 +1978,7 @@ BMessage::RemoveData(const char* name, int32 index)
 		return B_NO_INIT;
 
 	status_t result;
-	if (fHeader->message_area >= 0) {
+	if (_NeedsCopyForWrite()) {
 		result = _CopyForWrite();
 		if (result != B_OK)
 			return result;
@@ -1915,7 +2031,7 @@ BMessage::RemoveName(const char* name)
 		return B_NO_INIT;
 
 	status_t result;
-	if (fHeader->message_area >= 0) {
+	if (_NeedsCopyForWrite()) {
 		result = _CopyForWrite();
 		if (result != B_OK)
 			return result;
@@ -1984,7 +2100,7 @@ BMessage::ReplaceData(const char* name, type_code type, int32 index,
 		return B_BAD_VALUE;
 
 	status_t result;
-	if (fHeader->message_area >= 0) {
+	if (_NeedsCopyForWrite()) {
 		result = _CopyForWrite();
 		if (result != B_OK)
 			return result;
@@ -2144,7 +2260,7 @@ BMessage::_SendMessage(port_id port, team_id portOwner, int32 token,
 		copy = new BMessage(*this);
 		if (copy != NULL) {
 			header = copy->fHeader;
-			header->flags = fHeader->flags;
+			header->flags = fHeader->flags & ~MESSAGE_FLAG_IN_PLACE;
 		} else {
 			direct->Release();
 			return B_NO_MEMORY;
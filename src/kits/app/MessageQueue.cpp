@@ -68,6 +68,34 @@ BMessageQueue::AddMessage(BMessage* message)
 }
 
 
+/*!	Adds \a count messages at once, so that the queue only has to be locked
+	once for all of them.
+*/
+void
+BMessageQueue::_AddMessages(BMessage** messages, int32 count)
+{
+	if (count <= 0)
+		return;
+
+	BAutolock _(fLock);
+	if (!IsLocked())
+		return;
+
+	for (int32 i = 0; i < count; i++) {
+		BMessage* message = messages[i];
+		message->fQueueLink = NULL;
+
+		if (fTail == NULL)
+			fHead = message;
+		else
+			fTail->fQueueLink = message;
+		fTail = message;
+	}
+
+	fMessageCount += count;
+}
+
+
 void
 BMessageQueue::RemoveMessage(BMessage* message)
 {
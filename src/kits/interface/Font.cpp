@@ -15,6 +15,8 @@
 #include <FontPrivate.h>
 #include <ObjectList.h>
 #include <ServerProtocol.h>
+#include <StackOrHeapArray.h>
+#include <StringWidthCache.h>
 #include <truncate_string.h>
 #include <utf8_functions.h>
 
@@ -100,6 +102,45 @@ private:
 pthread_once_t FontList::sDefaultInitOnce = PTHREAD_ONCE_INIT;
 FontList* FontList::sDefaultInstance = NULL;
 
+
+/*!	Remembers the widths of the strings measured before, as the same labels
+	are measured over and over again. The widths depend on the installed
+	fonts, and on the hinting and anti-aliasing settings, so the cache is
+	emptied whenever the app_server reports a change of either. Like the font
+	list, this is checked at most once per second.
+*/
+class StringWidths : public BLocker {
+public:
+								StringWidths();
+
+	static	StringWidths*		Default();
+
+			bool				Get(const BFont& font, const char* string,
+									int32 length, float& _width);
+			void				Put(const BFont& font, const char* string,
+									int32 length, float width);
+
+private:
+	static	uint64				_FontKey(const BFont& font);
+			void				_ValidateIfNecessary();
+	static	void				_InitSingleton();
+
+private:
+			StringWidthCache	fCache;
+			bigtime_t			fLastValidation;
+			int32				fRevision;
+			uint32				fRenderingSettings;
+
+	static	pthread_once_t		sDefaultInitOnce;
+	static	StringWidths*		sDefaultInstance;
+};
+
+static const int32 kMaxCachedStringWidths = 1024;
+static const int32 kMaxCachedStringLength = 128;
+
+pthread_once_t StringWidths::sDefaultInitOnce = PTHREAD_ONCE_INIT;
+StringWidths* StringWidths::sDefaultInstance = NULL;
+
 }	// unnamed namespace
 
 
@@ -330,6 +371,98 @@ FontList::_InitSingleton()
 	sDefaultInstance = new FontList;
 }
 
+
+//	#pragma mark -
+
+
+StringWidths::StringWidths()
+	: BLocker("string widths"),
+	fCache(kMaxCachedStringWidths, kMaxCachedStringLength),
+	fLastValidation(0),
+	fRevision(B_ERROR),
+	fRenderingSettings(0)
+{
+}
+
+
+/*static*/ StringWidths*
+StringWidths::Default()
+{
+	if (sDefaultInstance == NULL)
+		pthread_once(&sDefaultInitOnce, &_InitSingleton);
+
+	return sDefaultInstance;
+}
+
+
+bool
+StringWidths::Get(const BFont& font, const char* string, int32 length,
+	float& _width)
+{
+	BAutolock locker(this);
+
+	_ValidateIfNecessary();
+	return fCache.Get(_FontKey(font), font.Spacing(), string, length, _width);
+}
+
+
+void
+StringWidths::Put(const BFont& font, const char* string, int32 length,
+	float width)
+{
+	BAutolock locker(this);
+
+	fCache.Put(_FontKey(font), font.Spacing(), string, length, width);
+}
+
+
+/*!	The app_server only uses the family, style, size, and spacing of the
+	font to measure strings, so only these make up the key.
+*/
+/*static*/ uint64
+StringWidths::_FontKey(const BFont& font)
+{
+	float size = font.Size();
+	uint32 sizeBits;
+	memcpy(&sizeBits, &size, sizeof(uint32));
+
+	return ((uint64)font.FamilyAndStyle() << 32) | sizeBits;
+}
+
+
+void
+StringWidths::_ValidateIfNecessary()
+{
+	if (fLastValidation > system_time() - 1000000)
+		return;
+
+	BPrivate::AppServerLink link;
+	link.StartMessage(AS_GET_FONT_LIST_REVISION);
+
+	int32 code;
+	int32 revision = B_ERROR;
+	uint32 renderingSettings = 0;
+	if (link.FlushWithReply(code) == B_OK && code == B_OK) {
+		link.Read<int32>(&revision);
+		link.Read<uint32>(&renderingSettings);
+	}
+
+	fLastValidation = system_time();
+	if (revision == B_ERROR || revision != fRevision
+		|| renderingSettings != fRenderingSettings) {
+		fCache.MakeEmpty();
+		fRevision = revision;
+		fRenderingSettings = renderingSettings;
+	}
+}
+
+
+/*static*/ void
+StringWidths::_InitSingleton()
+{
+	sDefaultInstance = new StringWidths;
+}
+
 }	// unnamed namespace
 
 
@@ -1035,25 +1168,53 @@ BFont::GetStringWidths(const char* stringArray[], const int32 lengthArray[],
 		return;
 	}
 
+	// Only ask the app_server for the strings we do not know yet
+	BStackOrHeapArray<int32, 64> missing(numStrings);
+	if (!missing.IsValid())
+		return;
+
+	StringWidths* cache = StringWidths::Default();
+	int32 missingCount = 0;
+	for (int32 i = 0; i < numStrings; i++) {
+		if (!cache->Get(*this, stringArray[i], lengthArray[i],
+				widthArray[i])) {
+			missing[missingCount++] = i;
+		}
+	}
+
+	if (missingCount == 0)
+		return;
+
+	BStackOrHeapArray<float, 64> missingWidths(missingCount);
+	if (!missingWidths.IsValid())
+		return;
+
 	BPrivate::AppServerLink link;
 	link.StartMessage(AS_GET_STRING_WIDTHS);
 	link.Attach<uint16>(fFamilyID);
 	link.Attach<uint16>(fStyleID);
 	link.Attach<float>(fSize);
 	link.Attach<uint8>(fSpacing);
-	link.Attach<int32>(numStrings);
+	link.Attach<int32>(missingCount);
 
 	// TODO: all strings into a single array???
 	// we do have a maximum message length, and it could be easily touched
 	// here...
-	for (int32 i = 0; i < numStrings; i++)
-		link.AttachString(stringArray[i], lengthArray[i]);
+	for (int32 i = 0; i < missingCount; i++)
+		link.AttachString(stringArray[missing[i]], lengthArray[missing[i]]);
 
 	status_t status;
 	if (link.FlushWithReply(status) != B_OK || status != B_OK)
 		return;
 
-	link.Read(widthArray, sizeof(float) * numStrings);
+	link.Read(missingWidths, sizeof(float) * missingCount);
+
+	for (int32 i = 0; i < missingCount; i++) {
+		int32 index = missing[i];
+		widthArray[index] = missingWidths[i];
+		cache->Put(*this, stringArray[index], lengthArray[index],
+			missingWidths[i]);
+	}
 }
 
 
@@ -0,0 +1,213 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include <StringWidthCache.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <new>
+
+
+namespace BPrivate {
+
+
+static uint32
+hash_string(uint64 font, uint8 spacing, const char* string, int32 length)
+{
+	// FNV-1a
+	uint32 hash = 2166136261UL;
+	for (int32 i = 0; i < length; i++)
+		hash = (hash ^ (uint8)string[i]) * 16777619UL;
+
+	return hash ^ (uint32)(font >> 32) ^ (uint32)font ^ spacing;
+}
+
+
+struct StringWidthCache::Entry {
+	Entry*		hashNext;
+	Entry*		previous;
+	Entry*		next;
+
+	uint64		font;
+	uint32		hash;
+	int32		length;
+	float		width;
+	uint8		spacing;
+	char		string[1];
+};
+
+
+StringWidthCache::StringWidthCache(int32 maxCount, int32 maxLength)
+	:
+	fTable(NULL),
+	fTableSize(1),
+	fFirstUsed(NULL),
+	fLastUsed(NULL),
+	fCount(0),
+	fMaxCount(maxCount),
+	fMaxLength(maxLength)
+{
+	// The cache never grows beyond maxCount, so the table does not need to be
+	// resized.
+	while (fTableSize < (uint32)maxCount)
+		fTableSize <<= 1;
+
+	fTable = new(std::nothrow) Entry*[fTableSize];
+	if (fTable != NULL)
+		memset(fTable, 0, sizeof(Entry*) * fTableSize);
+
+	fInitStatus = fTable != NULL ? B_OK : B_NO_MEMORY;
+}
+
+
+StringWidthCache::~StringWidthCache()
+{
+	MakeEmpty();
+	delete[] fTable;
+}
+
+
+status_t
+StringWidthCache::InitCheck() const
+{
+	return fInitStatus;
+}
+
+
+bool
+StringWidthCache::Get(uint64 font, uint8 spacing, const char* string,
+	int32 length, float& _width)
+{
+	if (fInitStatus != B_OK || string == NULL || length < 0
+		|| length > fMaxLength) {
+		return false;
+	}
+
+	Entry* entry = _Lookup(font, spacing, string, length,
+		hash_string(font, spacing, string, length));
+	if (entry == NULL)
+		return false;
+
+	if (entry != fFirstUsed) {
+		_Unlink(entry);
+		_LinkFirst(entry);
+	}
+
+	_width = entry->width;
+	return true;
+}
+
+
+void
+StringWidthCache::Put(uint64 font, uint8 spacing, const char* string,
+	int32 length, float width)
+{
+	if (fInitStatus != B_OK || string == NULL || length < 0
+		|| length > fMaxLength) {
+		return;
+	}
+
+	uint32 hash = hash_string(font, spacing, string, length);
+	Entry* entry = _Lookup(font, spacing, string, length, hash);
+	if (entry != NULL) {
+		entry->width = width;
+		return;
+	}
+
+	while (fCount >= fMaxCount && fLastUsed != NULL)
+		_Remove(fLastUsed);
+
+	entry = (Entry*)malloc(sizeof(Entry) + length);
+	if (entry == NULL)
+		return;
+
+	entry->font = font;
+	entry->hash = hash;
+	entry->length = length;
+	entry->width = width;
+	entry->spacing = spacing;
+	memcpy(entry->string, string, length);
+
+	Entry*& bucket = fTable[hash & (fTableSize - 1)];
+	entry->hashNext = bucket;
+	bucket = entry;
+
+	_LinkFirst(entry);
+	fCount++;
+}
+
+
+void
+StringWidthCache::MakeEmpty()
+{
+	while (fLastUsed != NULL)
+		_Remove(fLastUsed);
+}
+
+
+StringWidthCache::Entry*
+StringWidthCache::_Lookup(uint64 font, uint8 spacing, const char* string,
+	int32 length, uint32 hash) const
+{
+	Entry* entry = fTable[hash & (fTableSize - 1)];
+	for (; entry != NULL; entry = entry->hashNext) {
+		if (entry->hash == hash && entry->font == font
+			&& entry->spacing == spacing && entry->length == length
+			&& memcmp(entry->string, string, length) == 0) {
+			return entry;
+		}
+	}
+
+	return NULL;
+}
+
+
+void
+StringWidthCache::_Unlink(Entry* entry)
+{
+	if (entry->previous != NULL)
+		entry->previous->next = entry->next;
+	else
+		fFirstUsed = entry->next;
+
+	if (entry->next != NULL)
+		entry->next->previous = entry->previous;
+	else
+		fLastUsed = entry->previous;
+}
+
+
+void
+StringWidthCache::_LinkFirst(Entry* entry)
+{
+	entry->previous = NULL;
+	entry->next = fFirstUsed;
+	if (fFirstUsed != NULL)
+		fFirstUsed->previous = entry;
+	else
+		fLastUsed = entry;
+
+	fFirstUsed = entry;
+}
+
+
+void
+StringWidthCache::_Remove(Entry* entry)
+{
+	_Unlink(entry);
+
+	Entry** link = &fTable[entry->hash & (fTableSize - 1)];
+	while (*link != entry)
+		link = &(*link)->hashNext;
+	*link = entry->hashNext;
+
+	free(entry);
+	fCount--;
+}
+
+
+}	// namespace BPrivate
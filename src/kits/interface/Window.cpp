@@ -2921,14 +2921,7 @@ BWindow::_SetName(const char* title)
 void
 BWindow::_DequeueAll()
 {
-	//	Get message count from port
-	int32 count = port_count(fMsgPort);
-
-	for (int32 i = 0; i < count; i++) {
-		BMessage* message = MessageFromPort(0);
-		if (message != NULL)
-			fDirectTarget->Queue()->AddMessage(message);
-	}
+	_DequeueMessages(0);
 }
 
 
@@ -2957,21 +2950,8 @@ BWindow::task_looper()
 		debugger("window must not be locked!");
 
 	while (!fTerminating) {
-		// Did we get a message?
-		BMessage* msg = MessageFromPort();
-		if (msg)
-			_AddMessagePriv(msg);
-
-		//	Get message count from port
-		int32 msgCount = port_count(fMsgPort);
-		for (int32 i = 0; i < msgCount; ++i) {
-			// Read 'count' messages from port (so we will not block)
-			// We use zero as our timeout since we know there is stuff there
-			msg = MessageFromPort(0);
-			// Add messages to queue
-			if (msg)
-				_AddMessagePriv(msg);
-		}
+		// Wait for messages, and add all of them to the queue
+		_DequeueMessages(B_INFINITE_TIMEOUT);
 
 		bool dispatchNextMessage = true;
 		while (!fTerminating && dispatchNextMessage) {
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include <package/ApplyPackageDeltaJob.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include <Path.h>
+
+#include <AutoDeleter.h>
+#include <package/hpkg/ErrorOutput.h>
+#include <package/hpkg/PackageDeltaReader.h>
+
+
+namespace BPackageKit {
+
+namespace BPrivate {
+
+
+using BHPKG::BPrivate::PackageDeltaReader;
+
+
+struct ApplyPackageDeltaJob::ErrorOutput : BHPKG::BErrorOutput {
+	virtual void PrintErrorVarArgs(const char* format, va_list args)
+	{
+		char buffer[256];
+		vsnprintf(buffer, sizeof(buffer), format, args);
+		fError << buffer;
+	}
+
+	const BString& Error() const
+	{
+		return fError;
+	}
+
+private:
+	BString	fError;
+};
+
+
+ApplyPackageDeltaJob::ApplyPackageDeltaJob(const BContext& context,
+	const BString& title, const BEntry& baseEntry, const BEntry& deltaEntry,
+	const BEntry& targetEntry)
+	:
+	inherited(context, title),
+	fBaseEntry(baseEntry),
+	fDeltaEntry(deltaEntry),
+	fTargetEntry(targetEntry)
+{
+}
+
+
+ApplyPackageDeltaJob::~ApplyPackageDeltaJob()
+{
+}
+
+
+status_t
+ApplyPackageDeltaJob::Execute()
+{
+	BPath basePath;
+	BPath deltaPath;
+	BPath targetPath;
+	status_t error = fBaseEntry.GetPath(&basePath);
+	if (error == B_OK)
+		error = fDeltaEntry.GetPath(&deltaPath);
+	if (error == B_OK)
+		error = fTargetEntry.GetPath(&targetPath);
+	if (error != B_OK)
+		return error;
+
+	int deltaFD = open(deltaPath.Path(), O_RDONLY);
+	if (deltaFD < 0)
+		return errno;
+	FileDescriptorCloser deltaFDCloser(deltaFD);
+
+	int baseFD = open(basePath.Path(), O_RDONLY);
+	if (baseFD < 0)
+		return errno;
+	FileDescriptorCloser baseFDCloser(baseFD);
+
+	int targetFD = open(targetPath.Path(), O_WRONLY | O_CREAT | O_TRUNC,
+		0644);
+	if (targetFD < 0)
+		return errno;
+	FileDescriptorCloser targetFDCloser(targetFD);
+
+	ErrorOutput errorOutput;
+	PackageDeltaReader deltaReader(&errorOutput);
+	error = deltaReader.Init(deltaFD);
+	if (error == B_OK)
+		error = deltaReader.Apply(baseFD, targetFD);
+	if (error != B_OK && !errorOutput.Error().IsEmpty())
+		SetErrorString(errorOutput.Error());
+
+	return error;
+}
+
+
+void
+ApplyPackageDeltaJob::Cleanup(status_t jobResult)
+{
+	if (jobResult != B_OK)
+		fTargetEntry.Remove();
+}
+
+
+}	// namespace BPrivate
+
+}	// namespace BPackageKit
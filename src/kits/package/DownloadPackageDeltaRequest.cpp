@@ -0,0 +1,103 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include <package/DownloadPackageDeltaRequest.h>
+
+#include <package/ApplyPackageDeltaJob.h>
+#include <package/ValidateChecksumJob.h>
+
+#include "FetchFileJob.h"
+
+
+namespace BPackageKit {
+
+namespace BPrivate {
+
+
+DownloadPackageDeltaRequest::DownloadPackageDeltaRequest(
+	const BContext& context, const BString& deltaURL, const BEntry& baseEntry,
+	const BEntry& deltaEntry, const BEntry& targetEntry,
+	const BString& checksum)
+	:
+	inherited(context),
+	fDeltaURL(deltaURL),
+	fBaseEntry(baseEntry),
+	fDeltaEntry(deltaEntry),
+	fTargetEntry(targetEntry),
+	fChecksum(checksum)
+{
+	if (fInitStatus == B_OK) {
+		if (fDeltaURL.IsEmpty())
+			fInitStatus = B_BAD_VALUE;
+		else if ((fInitStatus = baseEntry.InitCheck()) == B_OK
+			&& (fInitStatus = deltaEntry.InitCheck()) == B_OK) {
+			fInitStatus = targetEntry.InitCheck();
+		}
+	}
+}
+
+
+DownloadPackageDeltaRequest::~DownloadPackageDeltaRequest()
+{
+}
+
+
+status_t
+DownloadPackageDeltaRequest::CreateInitialJobs()
+{
+	status_t error = InitCheck();
+	if (error != B_OK)
+		return B_NO_INIT;
+
+	// create the download job
+	FetchFileJob* fetchJob = new (std::nothrow) FetchFileJob(fContext,
+		BString("Downloading ") << fDeltaURL, fDeltaURL, fDeltaEntry);
+	if (fetchJob == NULL)
+		return B_NO_MEMORY;
+
+	if ((error = QueueJob(fetchJob)) != B_OK) {
+		delete fetchJob;
+		return error;
+	}
+
+	// create the job reconstructing the package from the base and the delta
+	ApplyPackageDeltaJob* applyJob = new (std::nothrow) ApplyPackageDeltaJob(
+		fContext, BString("Applying delta ") << fDeltaURL, fBaseEntry,
+		fDeltaEntry, fTargetEntry);
+	if (applyJob == NULL)
+		return B_NO_MEMORY;
+
+	if ((error = QueueJob(applyJob)) != B_OK) {
+		delete applyJob;
+		return error;
+	}
+
+	// create the checksum validation job -- the delta verifies the result
+	// against its own record, but only the repository's checksum tells us that
+	// it is the package we asked for
+	if (fChecksum.IsEmpty())
+		return B_OK;
+
+	ValidateChecksumJob* validateJob = new (std::nothrow) ValidateChecksumJob(
+		fContext, BString("Validating checksum for ") << fTargetEntry.Name(),
+		new (std::nothrow) StringChecksumAccessor(fChecksum),
+		new (std::nothrow) GeneralFileChecksumAccessor(fTargetEntry, true));
+
+	if (validateJob == NULL)
+		return B_NO_MEMORY;
+
+	if ((error = QueueJob(validateJob)) != B_OK) {
+		delete validateJob;
+		return error;
+	}
+
+	return B_OK;
+}
+
+
+}	// namespace BPrivate
+
+}	// namespace BPackageKit
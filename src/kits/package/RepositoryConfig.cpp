@@ -34,6 +34,7 @@
 	// should not be used any more in favour of 'identifier'
 
 #define KEY_PRIORITY "priority"
+#define KEY_DELTAS "deltas"
 #define KEY_CONFIG_VERSION "cfgversion"
 
 namespace BPackageKit {
@@ -58,7 +59,8 @@ BRepositoryConfig::BRepositoryConfig()
 	:
 	fInitStatus(B_NO_INIT),
 	fPriority(kUnsetPriority),
-	fIsUserSpecific(false)
+	fIsUserSpecific(false),
+	fProvidesDeltas(false)
 {
 }
 
@@ -76,7 +78,8 @@ BRepositoryConfig::BRepositoryConfig(const BString& name,
 	fName(name),
 	fBaseURL(baseURL),
 	fPriority(priority),
-	fIsUserSpecific(false)
+	fIsUserSpecific(false),
+	fProvidesDeltas(false)
 {
 }
 
@@ -120,6 +123,13 @@ BRepositoryConfig::Store(const BEntry& entry) const
 
 	configString << KEY_PRIORITY << "=" << fPriority << "\n";
 
+	if (fProvidesDeltas) {
+		configString << "\n";
+		configString << "# the repository provides deltas between package "
+			"versions\n";
+		configString << KEY_DELTAS << "=yes\n";
+	}
+
 	int32 size = configString.Length();
 	if ((result = file.Write(configString.String(), size)) < size)
 		return (result >= 0) ? B_ERROR : result;
@@ -201,6 +211,8 @@ BRepositoryConfig::SetTo(const BEntry& entry)
 	fPriority = priorityString == NULL
 		? kUnsetPriority : atoi(priorityString);
 	fIdentifier = identifier;
+	fProvidesDeltas = driverSettings.GetBoolParameterValue(KEY_DELTAS, false,
+		true);
 
 	BPath userSettingsPath;
 	if (find_directory(B_USER_SETTINGS_DIRECTORY, &userSettingsPath) == B_OK) {
@@ -250,6 +262,13 @@ BRepositoryConfig::IsUserSpecific() const
 }
 
 
+bool
+BRepositoryConfig::ProvidesDeltas() const
+{
+	return fProvidesDeltas;
+}
+
+
 const BEntry&
 BRepositoryConfig::Entry() const
 {
@@ -301,4 +320,11 @@ BRepositoryConfig::SetIsUserSpecific(bool isUserSpecific)
 }
 
 
+void
+BRepositoryConfig::SetProvidesDeltas(bool providesDeltas)
+{
+	fProvidesDeltas = providesDeltas;
+}
+
+
 }	// namespace BPackageKit
@@ -0,0 +1,284 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include <package/hpkg/PackageDeltaReader.h>
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include <ByteOrder.h>
+
+#include <package/hpkg/ErrorOutput.h>
+
+#include <SHA256.h>
+
+
+namespace BPackageKit {
+
+namespace BHPKG {
+
+namespace BPrivate {
+
+
+static const size_t kBufferSize = 64 * 1024;
+
+
+PackageDeltaReader::PackageDeltaReader(BErrorOutput* errorOutput)
+	:
+	fErrorOutput(errorOutput),
+	fFD(-1),
+	fTotalSize(0),
+	fBaseSize(0),
+	fTargetSize(0),
+	fCommandCount(0),
+	fBuffer(NULL)
+{
+}
+
+
+PackageDeltaReader::~PackageDeltaReader()
+{
+	free(fBuffer);
+}
+
+
+status_t
+PackageDeltaReader::Init(int fd)
+{
+	fFD = fd;
+
+	fBuffer = malloc(kBufferSize);
+	if (fBuffer == NULL)
+		return B_NO_MEMORY;
+
+	struct stat st;
+	if (fstat(fFD, &st) != 0)
+		return errno;
+
+	package_delta_header header;
+	if ((uint64)st.st_size < sizeof(header)) {
+		fErrorOutput->PrintError("Invalid package delta: too small\n");
+		return B_BAD_DATA;
+	}
+
+	status_t error = _Read(fFD, 0, &header, sizeof(header));
+	if (error != B_OK)
+		return error;
+
+	if (B_BENDIAN_TO_HOST_INT32(header.magic) != B_PACKAGE_DELTA_MAGIC) {
+		fErrorOutput->PrintError("Invalid package delta: invalid magic\n");
+		return B_BAD_DATA;
+	}
+
+	if (B_BENDIAN_TO_HOST_INT16(header.version) != B_PACKAGE_DELTA_VERSION) {
+		fErrorOutput->PrintError("Invalid package delta: unsupported version "
+			"%d\n", B_BENDIAN_TO_HOST_INT16(header.version));
+		return B_MISMATCHED_VALUES;
+	}
+
+	if (B_BENDIAN_TO_HOST_INT16(header.header_size) != sizeof(header)) {
+		fErrorOutput->PrintError("Invalid package delta: invalid header "
+			"size\n");
+		return B_BAD_DATA;
+	}
+
+	fTotalSize = B_BENDIAN_TO_HOST_INT64(header.total_size);
+	if (fTotalSize != (uint64)st.st_size) {
+		fErrorOutput->PrintError("Invalid package delta: total size %"
+			B_PRIu64 " doesn't match file size %" B_PRIdOFF "\n", fTotalSize,
+			st.st_size);
+		return B_BAD_DATA;
+	}
+
+	fBaseSize = B_BENDIAN_TO_HOST_INT64(header.base_size);
+	fTargetSize = B_BENDIAN_TO_HOST_INT64(header.target_size);
+	fCommandCount = B_BENDIAN_TO_HOST_INT32(header.command_count);
+	memcpy(fBaseChecksum, header.base_checksum, sizeof(fBaseChecksum));
+	memcpy(fTargetChecksum, header.target_checksum, sizeof(fTargetChecksum));
+
+	return B_OK;
+}
+
+
+status_t
+PackageDeltaReader::Apply(int baseFD, int targetFD)
+{
+	status_t error = _CheckBase(baseFD);
+	if (error != B_OK)
+		return error;
+
+	SHA256 sha;
+	off_t offset = sizeof(package_delta_header);
+	uint64 targetOffset = 0;
+
+	for (uint32 i = 0; i < fCommandCount; i++) {
+		package_delta_command command;
+		if (fTotalSize - offset < sizeof(command)) {
+			fErrorOutput->PrintError("Invalid package delta: truncated\n");
+			return B_BAD_DATA;
+		}
+
+		error = _Read(fFD, offset, &command, sizeof(command));
+		if (error != B_OK)
+			return error;
+		offset += sizeof(command);
+
+		uint16 type = B_BENDIAN_TO_HOST_INT16(command.type);
+		uint64 sourceOffset = B_BENDIAN_TO_HOST_INT64(command.offset);
+		uint64 size = B_BENDIAN_TO_HOST_INT64(command.size);
+
+		int sourceFD;
+		switch (type) {
+			case B_PACKAGE_DELTA_COMMAND_COPY:
+				if (sourceOffset > fBaseSize
+					|| size > fBaseSize - sourceOffset) {
+					fErrorOutput->PrintError("Invalid package delta: copy "
+						"command exceeds the base\n");
+					return B_BAD_DATA;
+				}
+				sourceFD = baseFD;
+				break;
+
+			case B_PACKAGE_DELTA_COMMAND_DATA:
+				if (size > fTotalSize - offset) {
+					fErrorOutput->PrintError("Invalid package delta: "
+						"truncated\n");
+					return B_BAD_DATA;
+				}
+				sourceFD = fFD;
+				sourceOffset = offset;
+				offset += size;
+				break;
+
+			default:
+				fErrorOutput->PrintError("Invalid package delta: unknown "
+					"command %d\n", type);
+				return B_BAD_DATA;
+		}
+
+		if (size > fTargetSize - targetOffset) {
+			fErrorOutput->PrintError("Invalid package delta: commands exceed "
+				"the target size\n");
+			return B_BAD_DATA;
+		}
+
+		while (size > 0) {
+			size_t toCopy = std::min(size, (uint64)kBufferSize);
+			error = _Read(sourceFD, sourceOffset, fBuffer, toCopy);
+			if (error == B_OK)
+				error = _Write(targetFD, targetOffset, fBuffer, toCopy);
+			if (error != B_OK)
+				return error;
+
+			sha.Update(fBuffer, toCopy);
+			size -= toCopy;
+			sourceOffset += toCopy;
+			targetOffset += toCopy;
+		}
+	}
+
+	if ((uint64)offset != fTotalSize || targetOffset != fTargetSize) {
+		fErrorOutput->PrintError("Invalid package delta: the commands don't "
+			"match the sizes\n");
+		return B_BAD_DATA;
+	}
+
+	if (ftruncate(targetFD, fTargetSize) != 0)
+		return errno;
+
+	if (memcmp(sha.Digest(), fTargetChecksum, sizeof(fTargetChecksum)) != 0) {
+		fErrorOutput->PrintError("The resulting package doesn't match the "
+			"delta's checksum\n");
+		return B_BAD_DATA;
+	}
+
+	return B_OK;
+}
+
+
+status_t
+PackageDeltaReader::_CheckBase(int baseFD)
+{
+	struct stat st;
+	if (fstat(baseFD, &st) != 0)
+		return errno;
+
+	bool matches = (uint64)st.st_size == fBaseSize;
+	if (matches) {
+		SHA256 sha;
+		for (uint64 offset = 0; offset < fBaseSize;) {
+			size_t toRead = std::min(fBaseSize - offset, (uint64)kBufferSize);
+			status_t error = _Read(baseFD, offset, fBuffer, toRead);
+			if (error != B_OK)
+				return error;
+
+			sha.Update(fBuffer, toRead);
+			offset += toRead;
+		}
+
+		matches = memcmp(sha.Digest(), fBaseChecksum, sizeof(fBaseChecksum))
+			== 0;
+	}
+
+	if (!matches) {
+		fErrorOutput->PrintError("The base package doesn't match the one the "
+			"delta was created for\n");
+		return B_BAD_DATA;
+	}
+
+	return B_OK;
+}
+
+
+status_t
+PackageDeltaReader::_Read(int fd, off_t offset, void* buffer, size_t size)
+{
+	while (size > 0) {
+		ssize_t bytesRead = pread(fd, buffer, size, offset);
+		if (bytesRead < 0)
+			return errno;
+		if (bytesRead == 0)
+			return B_BAD_DATA;
+
+		buffer = (uint8*)buffer + bytesRead;
+		size -= bytesRead;
+		offset += bytesRead;
+	}
+
+	return B_OK;
+}
+
+
+status_t
+PackageDeltaReader::_Write(int fd, off_t offset, const void* data,
+	size_t size)
+{
+	while (size > 0) {
+		ssize_t bytesWritten = pwrite(fd, data, size, offset);
+		if (bytesWritten < 0)
+			return errno;
+		if (bytesWritten == 0)
+			return B_ERROR;
+
+		data = (const uint8*)data + bytesWritten;
+		size -= bytesWritten;
+		offset += bytesWritten;
+	}
+
+	return B_OK;
+}
+
+
+}	// namespace BPrivate
+
+}	// namespace BHPKG
+
+}	// namespace BPackageKit
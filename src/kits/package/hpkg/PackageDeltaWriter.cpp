@@ -0,0 +1,413 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include <package/hpkg/PackageDeltaWriter.h>
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <map>
+#include <new>
+
+#include <ByteOrder.h>
+
+#include <package/hpkg/ErrorOutput.h>
+
+#include <package/hpkg/PackageFileHeapReader.h>
+#include <package/hpkg/PackageReaderImpl.h>
+#include <SHA256.h>
+
+
+namespace BPackageKit {
+
+namespace BHPKG {
+
+namespace BPrivate {
+
+
+static const size_t kBufferSize = 64 * 1024;
+
+
+struct PackageDeltaWriter::Command {
+	uint16	type;
+	uint64	offset;
+		// in the base for copy, in the target for data commands
+	uint64	size;
+};
+
+
+struct PackageDeltaWriter::ChunkKey {
+	uint64	hash;
+	uint64	size;
+
+	bool operator<(const ChunkKey& other) const
+	{
+		return hash < other.hash
+			|| (hash == other.hash && size < other.size);
+	}
+};
+
+
+struct PackageDeltaWriter::ChunkTable : std::map<ChunkKey, uint64> {
+		// maps to the chunk's offset in the base file
+};
+
+
+PackageDeltaWriter::PackageDeltaWriter(BErrorOutput* errorOutput)
+	:
+	fErrorOutput(errorOutput),
+	fBaseFD(-1),
+	fTargetFD(-1),
+	fBaseSize(0),
+	fTargetSize(0),
+	fBaseChunks(NULL),
+	fCommands(),
+	fCopiedSize(0),
+	fDataSize(0),
+	fBuffer(NULL),
+	fBaseBuffer(NULL)
+{
+}
+
+
+PackageDeltaWriter::~PackageDeltaWriter()
+{
+	delete fBaseChunks;
+	free(fBuffer);
+	free(fBaseBuffer);
+}
+
+
+status_t
+PackageDeltaWriter::Init(int baseFD, int targetFD)
+{
+	fBaseFD = baseFD;
+	fTargetFD = targetFD;
+
+	struct stat st;
+	if (fstat(fBaseFD, &st) != 0)
+		return errno;
+	fBaseSize = st.st_size;
+	if (fstat(fTargetFD, &st) != 0)
+		return errno;
+	fTargetSize = st.st_size;
+
+	fBaseChunks = new(std::nothrow) ChunkTable;
+	fBuffer = malloc(kBufferSize);
+	fBaseBuffer = malloc(kBufferSize);
+	if (fBaseChunks == NULL || fBuffer == NULL || fBaseBuffer == NULL)
+		return B_NO_MEMORY;
+
+	status_t error = _ComputeChecksum(fBaseFD, fBaseSize, fBaseChecksum);
+	if (error == B_OK)
+		error = _ComputeChecksum(fTargetFD, fTargetSize, fTargetChecksum);
+	if (error != B_OK)
+		return error;
+
+	// open both packages and index the heap chunks of the base
+	PackageReaderImpl baseReader(fErrorOutput);
+	error = baseReader.Init(fBaseFD, false, 0);
+	if (error != B_OK) {
+		fErrorOutput->PrintError("Failed to read the base package\n");
+		return error;
+	}
+
+	PackageReaderImpl targetReader(fErrorOutput);
+	error = targetReader.Init(fTargetFD, false, 0);
+	if (error != B_OK) {
+		fErrorOutput->PrintError("Failed to read the target package\n");
+		return error;
+	}
+
+	try {
+		error = _IndexBaseChunks(baseReader.RawHeapReader());
+		if (error != B_OK)
+			return error;
+
+		// Everything up to the heap, i.e. the header, is new. So is
+		// everything after the heap chunks, i.e. the chunk size table.
+		PackageFileHeapReader* heapReader = targetReader.RawHeapReader();
+		uint64 chunksEnd = heapReader->HeapOffset()
+			+ heapReader->CompressedHeapSize();
+
+		error = _AddData(0, heapReader->HeapOffset());
+		if (error == B_OK)
+			error = _AddTargetChunks(heapReader);
+		if (error == B_OK)
+			error = _AddData(chunksEnd, fTargetSize - chunksEnd);
+	} catch (std::bad_alloc&) {
+		return B_NO_MEMORY;
+	}
+
+	return error;
+}
+
+
+status_t
+PackageDeltaWriter::Finish(int fd)
+{
+	off_t offset = sizeof(package_delta_header);
+
+	for (int32 i = 0; i < fCommands.Count(); i++) {
+		const Command& command = fCommands[i];
+
+		package_delta_command commandHeader;
+		memset(&commandHeader, 0, sizeof(commandHeader));
+		commandHeader.type = B_HOST_TO_BENDIAN_INT16(command.type);
+		commandHeader.offset = B_HOST_TO_BENDIAN_INT64(
+			command.type == B_PACKAGE_DELTA_COMMAND_COPY ? command.offset : 0);
+		commandHeader.size = B_HOST_TO_BENDIAN_INT64(command.size);
+
+		status_t error = _Write(fd, offset, &commandHeader,
+			sizeof(commandHeader));
+		if (error != B_OK)
+			return error;
+		offset += sizeof(commandHeader);
+
+		if (command.type != B_PACKAGE_DELTA_COMMAND_DATA)
+			continue;
+
+		// copy the data from the target
+		uint64 remaining = command.size;
+		uint64 targetOffset = command.offset;
+		while (remaining > 0) {
+			size_t toCopy = std::min(remaining, (uint64)kBufferSize);
+			error = _Read(fTargetFD, targetOffset, fBuffer, toCopy);
+			if (error == B_OK)
+				error = _Write(fd, offset, fBuffer, toCopy);
+			if (error != B_OK)
+				return error;
+
+			remaining -= toCopy;
+			targetOffset += toCopy;
+			offset += toCopy;
+		}
+	}
+
+	// write the header
+	package_delta_header header;
+	memset(&header, 0, sizeof(header));
+	header.magic = B_HOST_TO_BENDIAN_INT32(B_PACKAGE_DELTA_MAGIC);
+	header.header_size = B_HOST_TO_BENDIAN_INT16(sizeof(header));
+	header.version = B_HOST_TO_BENDIAN_INT16(B_PACKAGE_DELTA_VERSION);
+	header.total_size = B_HOST_TO_BENDIAN_INT64(offset);
+	header.base_size = B_HOST_TO_BENDIAN_INT64(fBaseSize);
+	header.target_size = B_HOST_TO_BENDIAN_INT64(fTargetSize);
+	header.command_count = B_HOST_TO_BENDIAN_INT32(fCommands.Count());
+	memcpy(header.base_checksum, fBaseChecksum, sizeof(fBaseChecksum));
+	memcpy(header.target_checksum, fTargetChecksum, sizeof(fTargetChecksum));
+
+	status_t error = _Write(fd, 0, &header, sizeof(header));
+	if (error != B_OK)
+		return error;
+
+	if (ftruncate(fd, offset) != 0)
+		return errno;
+
+	return B_OK;
+}
+
+
+status_t
+PackageDeltaWriter::_IndexBaseChunks(PackageFileHeapReader* heapReader)
+{
+	uint64 heapOffset = heapReader->HeapOffset();
+	uint64 compressedHeapSize = heapReader->CompressedHeapSize();
+	uint64 uncompressedHeapSize = heapReader->UncompressedHeapSize();
+	size_t chunkSize = heapReader->ChunkSize();
+	size_t chunkCount = (uncompressedHeapSize + chunkSize - 1) / chunkSize;
+
+	for (size_t i = 0; i < chunkCount; i++) {
+		uint64 offset = heapReader->Offsets()[i];
+		uint64 size = i + 1 < chunkCount
+			? heapReader->Offsets()[i + 1] - offset
+			: compressedHeapSize - offset;
+
+		status_t error = _Read(fBaseFD, heapOffset + offset, fBaseBuffer,
+			size);
+		if (error != B_OK)
+			return error;
+
+		ChunkKey key = { _Hash(fBaseBuffer, size), size };
+		fBaseChunks->insert(std::make_pair(key, heapOffset + offset));
+			// keeps the first of several identical chunks
+	}
+
+	return B_OK;
+}
+
+
+status_t
+PackageDeltaWriter::_AddTargetChunks(PackageFileHeapReader* heapReader)
+{
+	uint64 heapOffset = heapReader->HeapOffset();
+	uint64 compressedHeapSize = heapReader->CompressedHeapSize();
+	uint64 uncompressedHeapSize = heapReader->UncompressedHeapSize();
+	size_t chunkSize = heapReader->ChunkSize();
+	size_t chunkCount = (uncompressedHeapSize + chunkSize - 1) / chunkSize;
+
+	for (size_t i = 0; i < chunkCount; i++) {
+		uint64 offset = heapReader->Offsets()[i];
+		uint64 size = i + 1 < chunkCount
+			? heapReader->Offsets()[i + 1] - offset
+			: compressedHeapSize - offset;
+
+		status_t error = _Read(fTargetFD, heapOffset + offset, fBuffer, size);
+		if (error != B_OK)
+			return error;
+
+		// look for an identical chunk in the base
+		ChunkKey key = { _Hash(fBuffer, size), size };
+		ChunkTable::const_iterator it = fBaseChunks->find(key);
+		if (it != fBaseChunks->end()) {
+			error = _Read(fBaseFD, it->second, fBaseBuffer, size);
+			if (error != B_OK)
+				return error;
+
+			if (memcmp(fBuffer, fBaseBuffer, size) == 0) {
+				error = _AddCopy(it->second, size);
+				if (error != B_OK)
+					return error;
+				continue;
+			}
+		}
+
+		error = _AddData(heapOffset + offset, size);
+		if (error != B_OK)
+			return error;
+	}
+
+	return B_OK;
+}
+
+
+status_t
+PackageDeltaWriter::_AddCopy(uint64 offset, uint64 size)
+{
+	fCopiedSize += size;
+
+	// join with the previous command, if possible
+	if (fCommands.Count() > 0) {
+		Command& previous = fCommands[fCommands.Count() - 1];
+		if (previous.type == B_PACKAGE_DELTA_COMMAND_COPY
+			&& previous.offset + previous.size == offset) {
+			previous.size += size;
+			return B_OK;
+		}
+	}
+
+	Command command = { B_PACKAGE_DELTA_COMMAND_COPY, offset, size };
+	return fCommands.Add(command) ? B_OK : B_NO_MEMORY;
+}
+
+
+status_t
+PackageDeltaWriter::_AddData(uint64 offset, uint64 size)
+{
+	if (size == 0)
+		return B_OK;
+
+	fDataSize += size;
+
+	// The data are added in target order, so we can always join with a
+	// previous data command.
+	if (fCommands.Count() > 0) {
+		Command& previous = fCommands[fCommands.Count() - 1];
+		if (previous.type == B_PACKAGE_DELTA_COMMAND_DATA) {
+			previous.size += size;
+			return B_OK;
+		}
+	}
+
+	Command command = { B_PACKAGE_DELTA_COMMAND_DATA, offset, size };
+	return fCommands.Add(command) ? B_OK : B_NO_MEMORY;
+}
+
+
+status_t
+PackageDeltaWriter::_ComputeChecksum(int fd, uint64 size, uint8* checksum)
+{
+	SHA256 sha;
+
+	uint64 offset = 0;
+	while (offset < size) {
+		size_t toRead = std::min(size - offset, (uint64)kBufferSize);
+		status_t error = _Read(fd, offset, fBuffer, toRead);
+		if (error != B_OK)
+			return error;
+
+		sha.Update(fBuffer, toRead);
+		offset += toRead;
+	}
+
+	memcpy(checksum, sha.Digest(), B_PACKAGE_DELTA_CHECKSUM_SIZE);
+	return B_OK;
+}
+
+
+status_t
+PackageDeltaWriter::_Read(int fd, off_t offset, void* buffer, size_t size)
+{
+	while (size > 0) {
+		ssize_t bytesRead = pread(fd, buffer, size, offset);
+		if (bytesRead < 0)
+			return errno;
+		if (bytesRead == 0)
+			return B_BAD_DATA;
+
+		buffer = (uint8*)buffer + bytesRead;
+		size -= bytesRead;
+		offset += bytesRead;
+	}
+
+	return B_OK;
+}
+
+
+status_t
+PackageDeltaWriter::_Write(int fd, off_t offset, const void* data,
+	size_t size)
+{
+	while (size > 0) {
+		ssize_t bytesWritten = pwrite(fd, data, size, offset);
+		if (bytesWritten < 0)
+			return errno;
+		if (bytesWritten == 0)
+			return B_ERROR;
+
+		data = (const uint8*)data + bytesWritten;
+		size -= bytesWritten;
+		offset += bytesWritten;
+	}
+
+	return B_OK;
+}
+
+
+/*static*/ uint64
+PackageDeltaWriter::_Hash(const void* data, size_t size)
+{
+	// FNV-1a -- matches are verified anyway
+	const uint8* bytes = (const uint8*)data;
+	uint64 hash = 0xcbf29ce484222325ULL;
+	for (size_t i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= 0x100000001b3ULL;
+	}
+
+	return hash;
+}
+
+
+}	// namespace BPrivate
+
+}	// namespace BHPKG
+
+}	// namespace BPackageKit
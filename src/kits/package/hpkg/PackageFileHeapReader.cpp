@@ -9,6 +9,8 @@
 #include <algorithm>
 #include <new>
 
+#include <OS.h>
+
 #include <package/hpkg/ErrorOutput.h>
 #include <package/hpkg/HPKGDefs.h>
 
@@ -30,7 +32,8 @@ PackageFileHeapReader::PackageFileHeapReader(BErrorOutput* errorOutput,
 	:
 	PackageFileHeapAccessorBase(errorOutput, file, heapOffset,
 		decompressionAlgorithm),
-	fOffsets()
+	fOffsets(),
+	fChunkCache(NULL)
 {
 	fCompressedHeapSize = compressedHeapSize;
 	fUncompressedHeapSize = uncompressedHeapSize;
@@ -165,8 +168,35 @@ PackageFileHeapReader::ReadAndDecompressChunk(size_t chunkIndex,
 		? fUncompressedHeapSize - (uint64)chunkIndex * kChunkSize
 		: kChunkSize;
 
-	return ReadAndDecompressChunkData(offset, compressedSize, uncompressedSize,
-		compressedDataBuffer, uncompressedDataBuffer);
+	// Uncompressed chunks are read directly from the file, which is cached
+	// anyway.
+	if (fChunkCache == NULL || compressedSize == uncompressedSize) {
+		return ReadAndDecompressChunkData(offset, compressedSize,
+			uncompressedSize, compressedDataBuffer, uncompressedDataBuffer);
+	}
+
+	if (fChunkCache->GetChunk(chunkIndex, uncompressedDataBuffer,
+			uncompressedSize)) {
+		return B_OK;
+	}
+
+	bigtime_t startTime = system_time();
+	status_t error = ReadAndDecompressChunkData(offset, compressedSize,
+		uncompressedSize, compressedDataBuffer, uncompressedDataBuffer);
+	if (error != B_OK)
+		return error;
+
+	fChunkCache->PutChunk(chunkIndex, uncompressedDataBuffer, uncompressedSize,
+		system_time() - startTime);
+	return B_OK;
+}
+
+
+// #pragma mark - ChunkCache
+
+
+PackageFileHeapReader::ChunkCache::~ChunkCache()
+{
 }
 
 
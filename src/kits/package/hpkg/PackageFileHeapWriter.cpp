@@ -6,6 +6,9 @@
 
 #include <package/hpkg/PackageFileHeapWriter.h>
 
+#include <pthread.h>
+#include <unistd.h>
+
 #include <algorithm>
 #include <new>
 
@@ -24,6 +27,9 @@
 // minimum length of data we require before trying to compress them
 static const size_t kCompressionSizeThreshold = 64;
 
+// upper limit for the number of compression threads
+static const int32 kMaxCompressionThreads = 64;
+
 
 namespace BPackageKit {
 
@@ -194,6 +200,210 @@ private:
 };
 
 
+struct PackageFileHeapWriter::CompressionJob {
+	void*		uncompressedData;
+	void*		compressedData;
+	size_t		uncompressedSize;
+	size_t		compressedSize;
+	status_t	status;
+		// of the compression, B_BUFFER_OVERFLOW, if the data shall be
+		// written uncompressed
+	bool		done;
+};
+
+
+/*!	Compresses chunks on a set of worker threads.
+	The jobs form a ring. The writer fills and queues them in heap order, the
+	workers pick them up in the same order, and the writer writes them once
+	they are done, again in order. So the heap looks exactly as if it had been
+	compressed on the writer's thread.
+*/
+struct PackageFileHeapWriter::CompressionThreadPool {
+	CompressionThreadPool(PackageFileHeapWriter* writer)
+		:
+		fWriter(writer),
+		fThreads(NULL),
+		fThreadCount(0),
+		fJobs(NULL),
+		fJobCount(0),
+		fQueuedJobs(0),
+		fStartedJobs(0),
+		fWrittenJobs(0),
+		fQuit(false),
+		fLockInitialized(false)
+	{
+	}
+
+	~CompressionThreadPool()
+	{
+		if (fLockInitialized) {
+			pthread_mutex_lock(&fLock);
+			fQuit = true;
+			pthread_cond_broadcast(&fJobQueuedCondition);
+			pthread_mutex_unlock(&fLock);
+
+			for (int32 i = 0; i < fThreadCount; i++)
+				pthread_join(fThreads[i], NULL);
+
+			pthread_cond_destroy(&fJobDoneCondition);
+			pthread_cond_destroy(&fJobQueuedCondition);
+			pthread_mutex_destroy(&fLock);
+		}
+
+		delete[] fThreads;
+
+		if (fJobs != NULL) {
+			for (int32 i = 0; i < fJobCount; i++) {
+				free(fJobs[i].uncompressedData);
+				free(fJobs[i].compressedData);
+			}
+			delete[] fJobs;
+		}
+	}
+
+	status_t Init(int32 threadCount)
+	{
+		// Two jobs per thread, so the writer can fill and write jobs while
+		// all threads are busy.
+		fJobCount = threadCount * 2;
+		fJobs = new(std::nothrow) CompressionJob[fJobCount];
+		fThreads = new(std::nothrow) pthread_t[threadCount];
+		if (fJobs == NULL || fThreads == NULL)
+			return B_NO_MEMORY;
+
+		for (int32 i = 0; i < fJobCount; i++) {
+			fJobs[i].uncompressedData = NULL;
+			fJobs[i].compressedData = NULL;
+		}
+
+		for (int32 i = 0; i < fJobCount; i++) {
+			fJobs[i].uncompressedData = malloc(kChunkSize);
+			fJobs[i].compressedData = malloc(kChunkSize);
+			if (fJobs[i].uncompressedData == NULL
+				|| fJobs[i].compressedData == NULL) {
+				return B_NO_MEMORY;
+			}
+		}
+
+		if (pthread_mutex_init(&fLock, NULL) != 0)
+			return B_NO_MEMORY;
+		if (pthread_cond_init(&fJobQueuedCondition, NULL) != 0) {
+			pthread_mutex_destroy(&fLock);
+			return B_NO_MEMORY;
+		}
+		if (pthread_cond_init(&fJobDoneCondition, NULL) != 0) {
+			pthread_cond_destroy(&fJobQueuedCondition);
+			pthread_mutex_destroy(&fLock);
+			return B_NO_MEMORY;
+		}
+		fLockInitialized = true;
+
+		for (; fThreadCount < threadCount; fThreadCount++) {
+			if (pthread_create(&fThreads[fThreadCount], NULL, &_ThreadEntry,
+					this) != 0) {
+				break;
+			}
+		}
+
+		return fThreadCount > 0 ? B_OK : B_NO_MORE_THREADS;
+	}
+
+	int32 JobCount() const
+	{
+		return fJobCount;
+	}
+
+	int32 QueuedJobCount() const
+	{
+		// only changed by the writer, so no locking needed
+		return int32(fQueuedJobs - fWrittenJobs);
+	}
+
+	CompressionJob& NextJob()
+	{
+		// The caller must make sure that the job has been written before.
+		return fJobs[fQueuedJobs % fJobCount];
+	}
+
+	void QueueNextJob()
+	{
+		CompressionJob& job = NextJob();
+		job.done = false;
+
+		pthread_mutex_lock(&fLock);
+		fQueuedJobs++;
+		pthread_cond_signal(&fJobQueuedCondition);
+		pthread_mutex_unlock(&fLock);
+	}
+
+	CompressionJob& WaitForFirstJob()
+	{
+		CompressionJob& job = fJobs[fWrittenJobs % fJobCount];
+
+		pthread_mutex_lock(&fLock);
+		while (!job.done)
+			pthread_cond_wait(&fJobDoneCondition, &fLock);
+		pthread_mutex_unlock(&fLock);
+
+		return job;
+	}
+
+	void FirstJobWritten()
+	{
+		fWrittenJobs++;
+	}
+
+private:
+	static void* _ThreadEntry(void* data)
+	{
+		((CompressionThreadPool*)data)->_Run();
+		return NULL;
+	}
+
+	void _Run()
+	{
+		pthread_mutex_lock(&fLock);
+
+		while (true) {
+			while (!fQuit && fStartedJobs == fQueuedJobs)
+				pthread_cond_wait(&fJobQueuedCondition, &fLock);
+			if (fQuit)
+				break;
+
+			CompressionJob& job = fJobs[fStartedJobs++ % fJobCount];
+			pthread_mutex_unlock(&fLock);
+
+			job.status = fWriter->_CompressChunk(job.uncompressedData,
+				job.uncompressedSize, job.compressedData, job.compressedSize);
+
+			pthread_mutex_lock(&fLock);
+			job.done = true;
+			pthread_cond_broadcast(&fJobDoneCondition);
+		}
+
+		pthread_mutex_unlock(&fLock);
+	}
+
+private:
+	PackageFileHeapWriter*	fWriter;
+
+	pthread_t*				fThreads;
+	int32					fThreadCount;
+
+	CompressionJob*			fJobs;
+	int32					fJobCount;
+	uint64					fQueuedJobs;
+	uint64					fStartedJobs;
+	uint64					fWrittenJobs;
+	bool					fQuit;
+
+	pthread_mutex_t			fLock;
+	pthread_cond_t			fJobQueuedCondition;
+	pthread_cond_t			fJobDoneCondition;
+	bool					fLockInitialized;
+};
+
+
 PackageFileHeapWriter::PackageFileHeapWriter(BErrorOutput* errorOutput,
 	BPositionIO* file, off_t heapOffset,
 	CompressionAlgorithmOwner* compressionAlgorithm,
@@ -205,7 +415,9 @@ PackageFileHeapWriter::PackageFileHeapWriter(BErrorOutput* errorOutput,
 	fCompressedDataBuffer(NULL),
 	fPendingDataSize(0),
 	fOffsets(),
-	fCompressionAlgorithm(compressionAlgorithm)
+	fCompressionAlgorithm(compressionAlgorithm),
+	fCompressionThreadCount(1),
+	fCompressionThreads(NULL)
 {
 	if (fCompressionAlgorithm != NULL)
 		fCompressionAlgorithm->AcquireReference();
@@ -221,14 +433,27 @@ PackageFileHeapWriter::~PackageFileHeapWriter()
 }
 
 
+/*!	Allocates the data buffers.
+	With a \a compressionThreadCount other than 1, the chunks are compressed
+	on that many threads while the data of the following chunks are added. A
+	count <= 0 means one thread per CPU. The heap will be the same in either
+	case.
+*/
 void
-PackageFileHeapWriter::Init()
+PackageFileHeapWriter::Init(int32 compressionThreadCount)
 {
 	// allocate data buffers
 	fPendingDataBuffer = malloc(kChunkSize);
 	fCompressedDataBuffer = malloc(kChunkSize);
 	if (fPendingDataBuffer == NULL || fCompressedDataBuffer == NULL)
 		throw std::bad_alloc();
+
+	if (compressionThreadCount <= 0) {
+		long cpuCount = sysconf(_SC_NPROCESSORS_ONLN);
+		compressionThreadCount = cpuCount > 0 ? (int32)cpuCount : 1;
+	}
+	fCompressionThreadCount = std::min(compressionThreadCount,
+		kMaxCompressionThreads);
 }
 
 
@@ -260,34 +485,7 @@ PackageFileHeapWriter::AddData(BDataReader& dataReader, off_t size,
 {
 	_offset = fUncompressedHeapSize;
 
-	// copy the data to the heap
-	off_t readOffset = 0;
-	off_t remainingSize = size;
-	while (remainingSize > 0) {
-		// read data into pending data buffer
-		size_t toCopy = std::min(remainingSize,
-			off_t(kChunkSize - fPendingDataSize));
-		status_t error = dataReader.ReadData(readOffset,
-			(uint8*)fPendingDataBuffer + fPendingDataSize, toCopy);
-		if (error != B_OK) {
-			fErrorOutput->PrintError("Failed to read data: %s\n",
-				strerror(error));
-			return error;
-		}
-
-		fPendingDataSize += toCopy;
-		fUncompressedHeapSize += toCopy;
-		remainingSize -= toCopy;
-		readOffset += toCopy;
-
-		if (fPendingDataSize == kChunkSize) {
-			error = _FlushPendingData();
-			if (error != B_OK)
-				return error;
-		}
-	}
-
-	return B_OK;
+	return _AddData(dataReader, size, false);
 }
 
 
@@ -419,9 +617,13 @@ PackageFileHeapWriter::RemoveDataRanges(
 			uncompressedData = decompressionBuffer;
 		}
 
-		// add chunk data
-		AddDataThrows((uint8*)uncompressedData + segment.toKeepOffset,
-			segment.toKeepSize);
+		// add chunk data -- synchronously, since the chunk must be written
+		// before we read the chunks it might overwrite
+		BBufferDataReader reader((uint8*)uncompressedData
+			+ segment.toKeepOffset, segment.toKeepSize);
+		status_t error = _AddData(reader, segment.toKeepSize, true);
+		if (error != B_OK)
+			throw error;
 
 		chunkBuffer.CurrentSegmentDone();
 	}
@@ -481,6 +683,14 @@ status_t
 PackageFileHeapWriter::ReadAndDecompressChunk(size_t chunkIndex,
 	void* compressedDataBuffer, void* uncompressedDataBuffer)
 {
+	if ((ssize_t)chunkIndex >= fOffsets.Count()) {
+		// The chunk might still be queued for compression. Write all queued
+		// chunks, so it is either on disk or in the pending data buffer.
+		status_t error = _WriteQueuedChunks(0);
+		if (error != B_OK)
+			return error;
+	}
+
 	if (uint64(chunkIndex + 1) * kChunkSize > fUncompressedHeapSize) {
 		// The chunk has not been written to disk yet. Its data are still in the
 		// pending data buffer.
@@ -503,6 +713,9 @@ PackageFileHeapWriter::ReadAndDecompressChunk(size_t chunkIndex,
 void
 PackageFileHeapWriter::_Uninit()
 {
+	delete fCompressionThreads;
+	fCompressionThreads = NULL;
+
 	free(fPendingDataBuffer);
 	free(fCompressedDataBuffer);
 	fPendingDataBuffer = NULL;
@@ -510,13 +723,92 @@ PackageFileHeapWriter::_Uninit()
 }
 
 
+status_t
+PackageFileHeapWriter::_AddData(BDataReader& dataReader, off_t size,
+	bool synchronous)
+{
+	// copy the data to the heap
+	off_t readOffset = 0;
+	off_t remainingSize = size;
+	while (remainingSize > 0) {
+		// read data into pending data buffer
+		size_t toCopy = std::min(remainingSize,
+			off_t(kChunkSize - fPendingDataSize));
+		status_t error = dataReader.ReadData(readOffset,
+			(uint8*)fPendingDataBuffer + fPendingDataSize, toCopy);
+		if (error != B_OK) {
+			fErrorOutput->PrintError("Failed to read data: %s\n",
+				strerror(error));
+			return error;
+		}
+
+		fPendingDataSize += toCopy;
+		fUncompressedHeapSize += toCopy;
+		remainingSize -= toCopy;
+		readOffset += toCopy;
+
+		if (fPendingDataSize == kChunkSize) {
+			error = synchronous ? _FlushPendingData() : _QueuePendingData();
+			if (error != B_OK)
+				return error;
+		}
+	}
+
+	return B_OK;
+}
+
+
+/*!	Hands the full pending data buffer to the compression threads, if there
+	are any, or writes it right away.
+*/
+status_t
+PackageFileHeapWriter::_QueuePendingData()
+{
+	if (fCompressionThreads == NULL) {
+		// Only start the threads once they are needed, most heaps are too
+		// small to be worth it.
+		if (fCompressionThreadCount <= 1 || fCompressionAlgorithm == NULL)
+			return _FlushPendingData();
+
+		fCompressionThreads = new(std::nothrow) CompressionThreadPool(this);
+		status_t error = fCompressionThreads != NULL
+			? fCompressionThreads->Init(fCompressionThreadCount) : B_NO_MEMORY;
+		if (error != B_OK) {
+			// fall back to compressing the chunks ourselves
+			delete fCompressionThreads;
+			fCompressionThreads = NULL;
+			fCompressionThreadCount = 1;
+			return _FlushPendingData();
+		}
+	}
+
+	// make sure the next job is free
+	status_t error = _WriteQueuedChunks(fCompressionThreads->JobCount() - 1);
+	if (error != B_OK)
+		return error;
+
+	// swap buffers with the job instead of copying the data
+	CompressionJob& job = fCompressionThreads->NextJob();
+	std::swap(job.uncompressedData, fPendingDataBuffer);
+	job.uncompressedSize = fPendingDataSize;
+	fCompressionThreads->QueueNextJob();
+
+	fPendingDataSize = 0;
+	return B_OK;
+}
+
+
 status_t
 PackageFileHeapWriter::_FlushPendingData()
 {
+	status_t error = _WriteQueuedChunks(0);
+	if (error != B_OK)
+		return error;
+
 	if (fPendingDataSize == 0)
 		return B_OK;
 
-	status_t error = _WriteChunk(fPendingDataBuffer, fPendingDataSize, true);
+	error = _WriteChunk(fPendingDataBuffer, fPendingDataSize, true);
 	if (error == B_OK)
 		fPendingDataSize = 0;
 
@@ -524,9 +816,51 @@ PackageFileHeapWriter::_FlushPendingData()
 }
 
 
+/*!	Writes the oldest chunks queued for compression, until at most
+	\a maxQueuedChunks are left.
+*/
+status_t
+PackageFileHeapWriter::_WriteQueuedChunks(int32 maxQueuedChunks)
+{
+	if (fCompressionThreads == NULL)
+		return B_OK;
+
+	while (fCompressionThreads->QueuedJobCount() > maxQueuedChunks) {
+		CompressionJob& job = fCompressionThreads->WaitForFirstJob();
+		status_t error = _WriteChunkData(job.uncompressedData,
+			job.uncompressedSize, job.compressedData, job.compressedSize,
+			job.status);
+		fCompressionThreads->FirstJobWritten();
+		if (error != B_OK)
+			return error;
+	}
+
+	return B_OK;
+}
+
+
 status_t
 PackageFileHeapWriter::_WriteChunk(const void* data, size_t size,
 	bool mayCompress)
+{
+	size_t compressedSize = 0;
+	status_t compressionStatus = mayCompress
+		? _CompressChunk(data, size, fCompressedDataBuffer, compressedSize)
+		: B_BUFFER_OVERFLOW;
+
+	return _WriteChunkData(data, size, fCompressedDataBuffer, compressedSize,
+		compressionStatus);
+}
+
+
+/*!	Writes a chunk, compressed if \a compressionStatus is \c B_OK and
+	uncompressed if it is \c B_BUFFER_OVERFLOW. Any other status is the error
+	compressing the chunk failed with.
+*/
+status_t
+PackageFileHeapWriter::_WriteChunkData(const void* data, size_t size,
+	const void* compressedData, size_t compressedSize,
+	status_t compressionStatus)
 {
 	// add offset
 	if (!fOffsets.Add(fCompressedHeapSize)) {
@@ -534,51 +868,44 @@ PackageFileHeapWriter::_WriteChunk(const void* data, size_t size,
 		return B_NO_MEMORY;
 	}
 
-	// Try to use compression only for data large enough.
-	bool compress = mayCompress && size >= (off_t)kCompressionSizeThreshold;
-	if (compress) {
-		status_t error = _WriteDataCompressed(data, size);
-		if (error != B_OK) {
-			if (error != B_BUFFER_OVERFLOW)
-				return error;
-			compress = false;
-		}
-	}
+	if (compressionStatus == B_OK)
+		return _WriteDataUncompressed(compressedData, compressedSize);
 
-	// Write uncompressed, if necessary.
-	if (!compress) {
-		status_t error = _WriteDataUncompressed(data, size);
-		if (error != B_OK)
-			return error;
+	if (compressionStatus != B_BUFFER_OVERFLOW) {
+		fErrorOutput->PrintError("Failed to compress chunk data: %s\n",
+			strerror(compressionStatus));
+		return compressionStatus;
 	}
 
-	return B_OK;
+	return _WriteDataUncompressed(data, size);
 }
 
 
+/*!	Compresses a chunk into \a compressedDataBuffer. Returns
+	\c B_BUFFER_OVERFLOW, if the chunk shall rather be written uncompressed.
+	Called by the compression threads, too.
+*/
 status_t
-PackageFileHeapWriter::_WriteDataCompressed(const void* data, size_t size)
+PackageFileHeapWriter::_CompressChunk(const void* data, size_t size,
+	void* compressedDataBuffer, size_t& _compressedSize) const
 {
-	if (fCompressionAlgorithm == NULL)
+	// Try to use compression only for data large enough.
+	if (fCompressionAlgorithm == NULL || size < kCompressionSizeThreshold)
 		return B_BUFFER_OVERFLOW;
 
 	size_t compressedSize;
 	status_t error = fCompressionAlgorithm->algorithm->CompressBuffer(data,
-		size, fCompressedDataBuffer, size, compressedSize,
+		size, compressedDataBuffer, size, compressedSize,
 		fCompressionAlgorithm->parameters);
-	if (error != B_OK) {
-		if (error != B_BUFFER_OVERFLOW) {
-			fErrorOutput->PrintError("Failed to compress chunk data: %s\n",
-				strerror(error));
-		}
+	if (error != B_OK)
 		return error;
-	}
 
 	// only use compressed data when we've actually saved space
 	if (compressedSize == size)
 		return B_BUFFER_OVERFLOW;
 
-	return _WriteDataUncompressed(fCompressedDataBuffer, compressedSize);
+	_compressedSize = compressedSize;
+	return B_OK;
 }
 
 
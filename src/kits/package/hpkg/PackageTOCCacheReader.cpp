@@ -0,0 +1,503 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include <package/hpkg/PackageTOCCacheReader.h>
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <new>
+
+#include <package/hpkg/ErrorOutput.h>
+#include <package/hpkg/PackageContentHandler.h>
+#include <package/hpkg/PackageEntry.h>
+#include <package/hpkg/PackageEntryAttribute.h>
+#include <package/hpkg/PackageInfoAttributeValue.h>
+
+
+namespace BPackageKit {
+
+namespace BHPKG {
+
+namespace BPrivate {
+
+
+static const size_t kMaxTOCCacheSize = 256 * 1024 * 1024;
+
+
+struct PackageTOCCacheReader::Entry : BPackageEntry {
+	Entry(Entry* parent, const char* name)
+		:
+		BPackageEntry(parent, name),
+		parentEntry(parent)
+	{
+	}
+
+	Entry*	parentEntry;
+};
+
+
+/*!	Applies the same check as the package reader does: packagefs relies on
+	entry names never being empty, "." or "..", or containing a '/'.
+*/
+static bool
+is_valid_entry_name(const char* name)
+{
+	return name[0] != '\0' && strcmp(name, ".") != 0
+		&& strcmp(name, "..") != 0 && strchr(name, '/') == NULL;
+}
+
+
+static bool
+set_package_data(BPackageData& data, const package_toc_cache_data& cacheData,
+	uint16 flags, uint64 heapSize)
+{
+	if ((flags & B_PACKAGE_TOC_CACHE_DATA_INLINE) != 0) {
+		if (cacheData.size > B_HPKG_MAX_INLINE_DATA_SIZE)
+			return false;
+		data.SetData((uint8)cacheData.size, cacheData.inline_data);
+	} else {
+		if (cacheData.offset > heapSize
+			|| cacheData.size > heapSize - cacheData.offset) {
+			return false;
+		}
+		data.SetData(cacheData.size, cacheData.offset);
+	}
+
+	return true;
+}
+
+
+// #pragma mark - PackageTOCCacheReader
+
+
+PackageTOCCacheReader::PackageTOCCacheReader(BErrorOutput* errorOutput)
+	:
+	fErrorOutput(errorOutput),
+	fData(NULL),
+	fSize(0),
+	fOwnedData(NULL),
+	fHeader(NULL),
+	fPackages(NULL),
+	fStrings(NULL)
+{
+}
+
+
+PackageTOCCacheReader::~PackageTOCCacheReader()
+{
+	free(fOwnedData);
+}
+
+
+status_t
+PackageTOCCacheReader::Init(int fd)
+{
+	struct stat st;
+	if (fstat(fd, &st) != 0)
+		return errno;
+
+	if (st.st_size < (off_t)sizeof(package_toc_cache_header)
+		|| st.st_size > (off_t)kMaxTOCCacheSize) {
+		fErrorOutput->PrintError("Error: Invalid TOC cache size: %lld\n",
+			(long long)st.st_size);
+		return B_BAD_DATA;
+	}
+
+	fOwnedData = (uint8*)malloc(st.st_size);
+	if (fOwnedData == NULL)
+		return B_NO_MEMORY;
+
+	ssize_t bytesRead = pread(fd, fOwnedData, st.st_size, 0);
+	if (bytesRead < 0)
+		return errno;
+	if (bytesRead != st.st_size)
+		return B_BAD_DATA;
+
+	fData = fOwnedData;
+	fSize = st.st_size;
+	return _Init();
+}
+
+
+status_t
+PackageTOCCacheReader::Init(const void* data, size_t size)
+{
+	fData = (const uint8*)data;
+	fSize = size;
+	return _Init();
+}
+
+
+uint32
+PackageTOCCacheReader::CountPackages() const
+{
+	return fHeader != NULL ? fHeader->package_count : 0;
+}
+
+
+const package_toc_cache_package*
+PackageTOCCacheReader::PackageAt(uint32 index) const
+{
+	return index < CountPackages() ? fPackages + index : NULL;
+}
+
+
+const package_toc_cache_package*
+PackageTOCCacheReader::FindPackage(const char* fileName) const
+{
+	// the packages are sorted by file name
+	uint32 lower = 0;
+	uint32 upper = CountPackages();
+	while (lower < upper) {
+		uint32 mid = (lower + upper) / 2;
+		int compare = strcmp(FileName(fPackages + mid), fileName);
+		if (compare == 0)
+			return fPackages + mid;
+		if (compare < 0)
+			lower = mid + 1;
+		else
+			upper = mid;
+	}
+
+	return NULL;
+}
+
+
+const char*
+PackageTOCCacheReader::FileName(const package_toc_cache_package* package) const
+{
+	return _String(package->file_name);
+}
+
+
+bool
+PackageTOCCacheReader::IsUpToDate(const package_toc_cache_package* package,
+	const struct stat& st) const
+{
+	return (uint64)st.st_size == package->file_size
+		&& (int64)st.st_mtime == package->modified_time
+		&& (package->node_id == 0 || (uint64)st.st_ino == package->node_id);
+}
+
+
+status_t
+PackageTOCCacheReader::ParseContent(const package_toc_cache_package* package,
+	uint64 heapSize, BPackageContentHandler* contentHandler) const
+{
+	const uint8* records = fData + package->records_offset;
+	Entry* entry = NULL;
+	status_t error = _ParseRecords(records, records + package->records_size,
+		heapSize, contentHandler, entry);
+
+	// Clean up the entries that were not done -- that's only the case, if
+	// something went wrong.
+	if (entry != NULL && error == B_OK) {
+		fErrorOutput->PrintError("Error: Unterminated entry in TOC cache\n");
+		error = B_BAD_DATA;
+	}
+
+	while (entry != NULL) {
+		Entry* parent = entry->parentEntry;
+		delete entry;
+		entry = parent;
+	}
+
+	if (error != B_OK)
+		contentHandler->HandleErrorOccurred();
+
+	return error;
+}
+
+
+status_t
+PackageTOCCacheReader::_Init()
+{
+	if (fSize < sizeof(package_toc_cache_header)
+		|| (addr_t)fData % B_PACKAGE_TOC_CACHE_ALIGNMENT != 0) {
+		return B_BAD_DATA;
+	}
+
+	const package_toc_cache_header* header
+		= (const package_toc_cache_header*)fData;
+	if (header->magic != B_PACKAGE_TOC_CACHE_MAGIC
+		|| header->version != B_PACKAGE_TOC_CACHE_VERSION) {
+		// not an error -- the cache is just outdated
+		return B_MISMATCHED_VALUES;
+	}
+
+	if (header->header_size != sizeof(package_toc_cache_header)
+		|| header->total_size != fSize) {
+		fErrorOutput->PrintError("Error: Invalid TOC cache header\n");
+		return B_BAD_DATA;
+	}
+
+	// check the packages and the strings sections
+	uint64 packagesEnd = header->header_size
+		+ (uint64)header->package_count * sizeof(package_toc_cache_package);
+	if (packagesEnd > fSize || header->strings_offset < packagesEnd
+		|| header->strings_offset > fSize
+		|| header->strings_size != fSize - header->strings_offset
+		|| (header->strings_size > 0
+			&& fData[fSize - 1] != '\0')) {
+		fErrorOutput->PrintError("Error: Invalid TOC cache section sizes\n");
+		return B_BAD_DATA;
+	}
+
+	fHeader = header;
+	fPackages = (const package_toc_cache_package*)(fData + header->header_size);
+	fStrings = (const char*)fData + header->strings_offset;
+
+	// check the package records ranges
+	for (uint32 i = 0; i < header->package_count; i++) {
+		const package_toc_cache_package& package = fPackages[i];
+		if (_String(package.file_name) == NULL
+			|| package.records_offset < packagesEnd
+			|| package.records_offset % B_PACKAGE_TOC_CACHE_ALIGNMENT != 0
+			|| package.records_offset > header->strings_offset
+			|| package.records_size
+				> header->strings_offset - package.records_offset) {
+			fErrorOutput->PrintError("Error: Invalid TOC cache package %"
+				B_PRIu32 "\n", i);
+			fHeader = NULL;
+			return B_BAD_DATA;
+		}
+	}
+
+	return B_OK;
+}
+
+
+const char*
+PackageTOCCacheReader::_String(uint32 offset) const
+{
+	if (offset >= fHeader->strings_size)
+		return NULL;
+
+	return fStrings + offset;
+}
+
+
+const char*
+PackageTOCCacheReader::_OptionalString(uint32 offset, bool& _valid) const
+{
+	if (offset == B_PACKAGE_TOC_CACHE_NO_STRING)
+		return NULL;
+
+	const char* string = _String(offset);
+	if (string == NULL)
+		_valid = false;
+	return string;
+}
+
+
+status_t
+PackageTOCCacheReader::_ParseRecords(const uint8* records,
+	const uint8* recordsEnd, uint64 heapSize,
+	BPackageContentHandler* contentHandler, Entry*& _entry) const
+{
+	while (records < recordsEnd) {
+		const package_toc_cache_record* record
+			= (const package_toc_cache_record*)records;
+		if ((size_t)(recordsEnd - records) < sizeof(package_toc_cache_record)
+			|| record->size < sizeof(package_toc_cache_record)
+			|| record->size > (size_t)(recordsEnd - records)
+			|| record->size % B_PACKAGE_TOC_CACHE_ALIGNMENT != 0) {
+			fErrorOutput->PrintError("Error: Invalid TOC cache record\n");
+			return B_BAD_DATA;
+		}
+		records += record->size;
+
+		bool valid = true;
+		status_t error = B_OK;
+
+		switch (record->type) {
+			case B_PACKAGE_TOC_CACHE_RECORD_PACKAGE_ATTRIBUTE:
+			{
+				if (record->size
+						< sizeof(package_toc_cache_package_attribute)) {
+					valid = false;
+					break;
+				}
+
+				const package_toc_cache_package_attribute* attribute
+					= (const package_toc_cache_package_attribute*)record;
+
+				BPackageVersionData versions[2];
+				const package_toc_cache_version* cacheVersions[2] = {
+					&attribute->version, &attribute->compatible_version
+				};
+				for (int32 i = 0; i < 2; i++) {
+					versions[i].major = _OptionalString(
+						cacheVersions[i]->major, valid);
+					versions[i].minor = _OptionalString(
+						cacheVersions[i]->minor, valid);
+					versions[i].micro = _OptionalString(
+						cacheVersions[i]->micro, valid);
+					versions[i].preRelease = _OptionalString(
+						cacheVersions[i]->pre_release, valid);
+					versions[i].revision = cacheVersions[i]->revision;
+				}
+
+				const char* string = _OptionalString(attribute->string, valid);
+				if (!valid)
+					break;
+
+				bool haveVersion
+					= (record->flags & B_PACKAGE_TOC_CACHE_HAVE_VERSION) != 0;
+
+				BPackageInfoAttributeValue value;
+				value.attributeID = (BPackageInfoAttributeID)attribute->id;
+
+				switch (attribute->id) {
+					case B_PACKAGE_INFO_VERSION:
+						value.version = versions[0];
+						break;
+
+					case B_PACKAGE_INFO_PROVIDES:
+						value.resolvable.name = string;
+						value.resolvable.haveVersion = haveVersion;
+						value.resolvable.haveCompatibleVersion
+							= (record->flags
+								& B_PACKAGE_TOC_CACHE_HAVE_COMPATIBLE_VERSION)
+									!= 0;
+						value.resolvable.version = versions[0];
+						value.resolvable.compatibleVersion = versions[1];
+						break;
+
+					case B_PACKAGE_INFO_REQUIRES:
+					case B_PACKAGE_INFO_SUPPLEMENTS:
+					case B_PACKAGE_INFO_CONFLICTS:
+					case B_PACKAGE_INFO_FRESHENS:
+						value.resolvableExpression.name = string;
+						value.resolvableExpression.haveOpAndVersion
+							= haveVersion;
+						value.resolvableExpression.op
+							= (BPackageResolvableOperator)attribute->value;
+						value.resolvableExpression.version = versions[0];
+						break;
+
+					case B_PACKAGE_INFO_ARCHITECTURE:
+					case B_PACKAGE_INFO_FLAGS:
+						value.unsignedInt = attribute->value;
+						break;
+
+					default:
+						value.string = string;
+						break;
+				}
+
+				error = contentHandler->HandlePackageAttribute(value);
+				break;
+			}
+
+			case B_PACKAGE_TOC_CACHE_RECORD_ENTRY:
+			{
+				if (record->size < sizeof(package_toc_cache_entry)) {
+					valid = false;
+					break;
+				}
+
+				const package_toc_cache_entry* cacheEntry
+					= (const package_toc_cache_entry*)record;
+				const char* name = _String(cacheEntry->name);
+				const char* symlinkPath = _OptionalString(
+					cacheEntry->symlink_path, valid);
+				if (name == NULL || !valid || !is_valid_entry_name(name)) {
+					valid = false;
+					break;
+				}
+
+				Entry* entry = new(std::nothrow) Entry(_entry, name);
+				if (entry == NULL)
+					return B_NO_MEMORY;
+				_entry = entry;
+
+				entry->SetType(cacheEntry->mode);
+				entry->SetPermissions(cacheEntry->mode);
+				entry->SetModifiedTime(cacheEntry->modified_time);
+				entry->SetModifiedTimeNanos(cacheEntry->modified_time_nanos);
+				entry->SetSymlinkPath(symlinkPath);
+				if (!set_package_data(entry->Data(), cacheEntry->data,
+						record->flags, heapSize)) {
+					valid = false;
+					break;
+				}
+
+				error = contentHandler->HandleEntry(entry);
+				break;
+			}
+
+			case B_PACKAGE_TOC_CACHE_RECORD_ENTRY_ATTRIBUTE:
+			{
+				if (record->size < sizeof(package_toc_cache_entry_attribute)
+					|| _entry == NULL) {
+					valid = false;
+					break;
+				}
+
+				const package_toc_cache_entry_attribute* cacheAttribute
+					= (const package_toc_cache_entry_attribute*)record;
+				const char* name = _String(cacheAttribute->name);
+				if (name == NULL) {
+					valid = false;
+					break;
+				}
+
+				BPackageEntryAttribute attribute(name);
+				attribute.SetType(cacheAttribute->type);
+				if (!set_package_data(attribute.Data(), cacheAttribute->data,
+						record->flags, heapSize)) {
+					valid = false;
+					break;
+				}
+
+				error = contentHandler->HandleEntryAttribute(_entry,
+					&attribute);
+				break;
+			}
+
+			case B_PACKAGE_TOC_CACHE_RECORD_ENTRY_DONE:
+			{
+				if (_entry == NULL) {
+					valid = false;
+					break;
+				}
+
+				error = contentHandler->HandleEntryDone(_entry);
+
+				Entry* parent = _entry->parentEntry;
+				delete _entry;
+				_entry = parent;
+				break;
+			}
+
+			default:
+				valid = false;
+				break;
+		}
+
+		if (!valid) {
+			fErrorOutput->PrintError("Error: Invalid TOC cache record of type "
+				"%u\n", record->type);
+			return B_BAD_DATA;
+		}
+
+		if (error != B_OK)
+			return error;
+	}
+
+	return B_OK;
+}
+
+
+}	// namespace BPrivate
+
+}	// namespace BHPKG
+
+}	// namespace BPackageKit
@@ -0,0 +1,524 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include <package/hpkg/PackageTOCCacheWriter.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <new>
+
+#include <package/hpkg/ErrorOutput.h>
+#include <package/hpkg/PackageContentHandler.h>
+#include <package/hpkg/PackageEntry.h>
+#include <package/hpkg/PackageEntryAttribute.h>
+#include <package/hpkg/PackageInfoAttributeValue.h>
+
+#include <AutoDeleter.h>
+#include <package/hpkg/PackageReaderImpl.h>
+#include <package/hpkg/PackageTOCCacheReader.h>
+
+
+namespace BPackageKit {
+
+namespace BHPKG {
+
+namespace BPrivate {
+
+
+struct PackageTOCCacheWriter::Package {
+	package_toc_cache_package	key;
+	const char*					fileName;
+	Array<uint8>				records;
+};
+
+
+// #pragma mark - RecordingContentHandler
+
+
+struct PackageTOCCacheWriter::RecordingContentHandler
+	: BPackageContentHandler {
+	RecordingContentHandler(PackageTOCCacheWriter* writer,
+		Array<uint8>& records)
+		:
+		fWriter(writer),
+		fRecords(records)
+	{
+	}
+
+	virtual status_t HandleEntry(BPackageEntry* entry)
+	{
+		package_toc_cache_entry* record;
+		status_t error = _AddRecord(B_PACKAGE_TOC_CACHE_RECORD_ENTRY, record);
+		if (error != B_OK)
+			return error;
+
+		uint32 name;
+		uint32 symlinkPath;
+		error = fWriter->_AddString(entry->Name(), name);
+		if (error == B_OK)
+			error = fWriter->_AddOptionalString(entry->SymlinkPath(),
+				symlinkPath);
+		if (error != B_OK)
+			return error;
+
+		record->name = name;
+		record->symlink_path = symlinkPath;
+		record->mode = entry->Mode();
+		record->modified_time = entry->ModifiedTime().tv_sec;
+		record->modified_time_nanos = entry->ModifiedTime().tv_nsec;
+		_SetData(record->record, record->data, entry->Data());
+		return B_OK;
+	}
+
+	virtual status_t HandleEntryAttribute(BPackageEntry* entry,
+		BPackageEntryAttribute* attribute)
+	{
+		package_toc_cache_entry_attribute* record;
+		status_t error = _AddRecord(B_PACKAGE_TOC_CACHE_RECORD_ENTRY_ATTRIBUTE,
+			record);
+		if (error != B_OK)
+			return error;
+
+		uint32 name;
+		error = fWriter->_AddString(attribute->Name(), name);
+		if (error != B_OK)
+			return error;
+
+		record->name = name;
+		record->type = attribute->Type();
+		_SetData(record->record, record->data, attribute->Data());
+		return B_OK;
+	}
+
+	virtual status_t HandleEntryDone(BPackageEntry* entry)
+	{
+		package_toc_cache_record* record;
+		return _AddRecord(B_PACKAGE_TOC_CACHE_RECORD_ENTRY_DONE, record);
+	}
+
+	virtual status_t HandlePackageAttribute(
+		const BPackageInfoAttributeValue& value)
+	{
+		const char* string = NULL;
+		uint64 unsignedValue = 0;
+		uint16 flags = 0;
+		const BPackageVersionData* version = NULL;
+		const BPackageVersionData* compatibleVersion = NULL;
+
+		switch (value.attributeID) {
+			case B_PACKAGE_INFO_NAME:
+			case B_PACKAGE_INFO_SUMMARY:
+			case B_PACKAGE_INFO_DESCRIPTION:
+			case B_PACKAGE_INFO_VENDOR:
+			case B_PACKAGE_INFO_PACKAGER:
+			case B_PACKAGE_INFO_COPYRIGHTS:
+			case B_PACKAGE_INFO_LICENSES:
+			case B_PACKAGE_INFO_REPLACES:
+			case B_PACKAGE_INFO_URLS:
+			case B_PACKAGE_INFO_SOURCE_URLS:
+			case B_PACKAGE_INFO_CHECKSUM:
+			case B_PACKAGE_INFO_INSTALL_PATH:
+			case B_PACKAGE_INFO_BASE_PACKAGE:
+			case B_PACKAGE_INFO_GROUPS:
+			case B_PACKAGE_INFO_POST_INSTALL_SCRIPTS:
+			case B_PACKAGE_INFO_PRE_UNINSTALL_SCRIPTS:
+				string = value.string;
+				break;
+
+			case B_PACKAGE_INFO_ARCHITECTURE:
+			case B_PACKAGE_INFO_FLAGS:
+				unsignedValue = value.unsignedInt;
+				break;
+
+			case B_PACKAGE_INFO_VERSION:
+				version = &value.version;
+				break;
+
+			case B_PACKAGE_INFO_PROVIDES:
+				string = value.resolvable.name;
+				if (value.resolvable.haveVersion) {
+					flags |= B_PACKAGE_TOC_CACHE_HAVE_VERSION;
+					version = &value.resolvable.version;
+				}
+				if (value.resolvable.haveCompatibleVersion) {
+					flags |= B_PACKAGE_TOC_CACHE_HAVE_COMPATIBLE_VERSION;
+					compatibleVersion = &value.resolvable.compatibleVersion;
+				}
+				break;
+
+			case B_PACKAGE_INFO_REQUIRES:
+			case B_PACKAGE_INFO_SUPPLEMENTS:
+			case B_PACKAGE_INFO_CONFLICTS:
+			case B_PACKAGE_INFO_FRESHENS:
+				string = value.resolvableExpression.name;
+				if (value.resolvableExpression.haveOpAndVersion) {
+					flags |= B_PACKAGE_TOC_CACHE_HAVE_VERSION;
+					unsignedValue = value.resolvableExpression.op;
+					version = &value.resolvableExpression.version;
+				}
+				break;
+
+			default:
+				// not needed by packagefs
+				return B_OK;
+		}
+
+		package_toc_cache_package_attribute* record;
+		status_t error = _AddRecord(
+			B_PACKAGE_TOC_CACHE_RECORD_PACKAGE_ATTRIBUTE, record);
+		if (error != B_OK)
+			return error;
+
+		package_toc_cache_version versions[2];
+		error = _AddVersion(version, versions[0]);
+		if (error == B_OK)
+			error = _AddVersion(compatibleVersion, versions[1]);
+		uint32 stringOffset;
+		if (error == B_OK)
+			error = fWriter->_AddOptionalString(string, stringOffset);
+		if (error != B_OK)
+			return error;
+
+		record->record.flags = flags;
+		record->id = value.attributeID;
+		record->string = stringOffset;
+		record->value = unsignedValue;
+		record->version = versions[0];
+		record->compatible_version = versions[1];
+		return B_OK;
+	}
+
+	virtual void HandleErrorOccurred()
+	{
+	}
+
+private:
+	template<typename Record>
+	status_t _AddRecord(uint16 type, Record*& _record)
+	{
+		int32 offset = fRecords.Count();
+		if (!fRecords.AddUninitialized(sizeof(Record)))
+			return B_NO_MEMORY;
+
+		Record* record = (Record*)(fRecords.Elements() + offset);
+		memset(record, 0, sizeof(Record));
+
+		package_toc_cache_record* header = (package_toc_cache_record*)record;
+		header->type = type;
+		header->size = sizeof(Record);
+
+		_record = record;
+		return B_OK;
+	}
+
+	status_t _AddVersion(const BPackageVersionData* version,
+		package_toc_cache_version& _version)
+	{
+		memset(&_version, 0, sizeof(_version));
+		if (version == NULL) {
+			_version.major = B_PACKAGE_TOC_CACHE_NO_STRING;
+			_version.minor = B_PACKAGE_TOC_CACHE_NO_STRING;
+			_version.micro = B_PACKAGE_TOC_CACHE_NO_STRING;
+			_version.pre_release = B_PACKAGE_TOC_CACHE_NO_STRING;
+			return B_OK;
+		}
+
+		status_t error = fWriter->_AddOptionalString(version->major,
+			_version.major);
+		if (error == B_OK)
+			error = fWriter->_AddOptionalString(version->minor, _version.minor);
+		if (error == B_OK)
+			error = fWriter->_AddOptionalString(version->micro, _version.micro);
+		if (error == B_OK) {
+			error = fWriter->_AddOptionalString(version->preRelease,
+				_version.pre_release);
+		}
+		_version.revision = version->revision;
+		return error;
+	}
+
+	static void _SetData(package_toc_cache_record& record,
+		package_toc_cache_data& cacheData, const BPackageData& data)
+	{
+		cacheData.size = data.Size();
+		if (data.IsEncodedInline()) {
+			record.flags |= B_PACKAGE_TOC_CACHE_DATA_INLINE;
+			memcpy(cacheData.inline_data, data.InlineData(), data.Size());
+		} else
+			cacheData.offset = data.Offset();
+	}
+
+private:
+	PackageTOCCacheWriter*	fWriter;
+	Array<uint8>&			fRecords;
+};
+
+
+// #pragma mark - PackageTOCCacheWriter
+
+
+PackageTOCCacheWriter::PackageTOCCacheWriter(BErrorOutput* errorOutput)
+	:
+	fErrorOutput(errorOutput),
+	fPreviousCache(NULL),
+	fRecordNodeIDs(true),
+	fReusedPackageCount(0)
+{
+}
+
+
+PackageTOCCacheWriter::~PackageTOCCacheWriter()
+{
+	for (int32 i = 0; i < fPackages.Count(); i++)
+		delete fPackages[i];
+
+	CachedString* cachedString = fStringTable.Clear(true);
+	while (cachedString != NULL) {
+		CachedString* next = cachedString->next;
+		delete cachedString;
+		cachedString = next;
+	}
+}
+
+
+status_t
+PackageTOCCacheWriter::Init(const PackageTOCCacheReader* previousCache)
+{
+	fPreviousCache = previousCache;
+	return fStringTable.Init();
+}
+
+
+status_t
+PackageTOCCacheWriter::AddPackage(int directoryFD, const char* fileName)
+{
+	struct stat st;
+	if (fstatat(directoryFD, fileName, &st, 0) != 0) {
+		fErrorOutput->PrintError("Error: Failed to stat package \"%s\": %s\n",
+			fileName, strerror(errno));
+		return errno;
+	}
+
+	if (!S_ISREG(st.st_mode))
+		return B_BAD_VALUE;
+
+	Package* package = new(std::nothrow) Package;
+	if (package == NULL)
+		return B_NO_MEMORY;
+	ObjectDeleter<Package> packageDeleter(package);
+
+	memset(&package->key, 0, sizeof(package->key));
+	package->key.file_size = st.st_size;
+	package->key.modified_time = st.st_mtime;
+	package->key.node_id = fRecordNodeIDs ? st.st_ino : 0;
+
+	status_t error = _AddString(fileName, package->key.file_name);
+	if (error != B_OK)
+		return error;
+	package->fileName = fStringTable.Lookup(fileName)->string;
+
+	RecordingContentHandler handler(this, package->records);
+
+	// try to copy the package from the previous cache
+	if (fPreviousCache != NULL) {
+		const package_toc_cache_package* cachedPackage
+			= fPreviousCache->FindPackage(fileName);
+		if (cachedPackage != NULL
+			&& fPreviousCache->IsUpToDate(cachedPackage, st)) {
+			error = fPreviousCache->ParseContent(cachedPackage, &handler);
+			if (error == B_OK) {
+				fReusedPackageCount++;
+				if (!fPackages.Add(package))
+					return B_NO_MEMORY;
+				packageDeleter.Detach();
+				return B_OK;
+			}
+
+			if (error == B_NO_MEMORY)
+				return error;
+			package->records.Clear();
+		}
+	}
+
+	// parse the package file
+	int fd = openat(directoryFD, fileName, O_RDONLY);
+	if (fd < 0) {
+		fErrorOutput->PrintError("Error: Failed to open package \"%s\": %s\n",
+			fileName, strerror(errno));
+		return errno;
+	}
+
+	PackageReaderImpl packageReader(fErrorOutput);
+	error = packageReader.Init(fd, true, 0);
+	if (error == B_OK)
+		error = packageReader.ParseContent(&handler);
+	if (error != B_OK) {
+		fErrorOutput->PrintError("Error: Failed to read package \"%s\": %s\n",
+			fileName, strerror(error));
+		return error;
+	}
+
+	if (!fPackages.Add(package))
+		return B_NO_MEMORY;
+	packageDeleter.Detach();
+	return B_OK;
+}
+
+
+bool
+PackageTOCCacheWriter::HasChanges() const
+{
+	return fPreviousCache == NULL
+		|| fReusedPackageCount != fPackages.Count()
+		|| fPreviousCache->CountPackages() != (uint32)fPackages.Count();
+}
+
+
+status_t
+PackageTOCCacheWriter::Finish(int fd)
+{
+	// sort the packages, so that they can be looked up quickly
+	std::sort(fPackages.Elements(), fPackages.Elements() + fPackages.Count(),
+		&_PackageFileNameLess);
+
+	for (int32 i = 1; i < fPackages.Count(); i++) {
+		if (strcmp(fPackages[i - 1]->fileName, fPackages[i]->fileName) == 0) {
+			fErrorOutput->PrintError("Error: Package \"%s\" added twice\n",
+				fPackages[i]->fileName);
+			return B_BAD_VALUE;
+		}
+	}
+
+	// compute the layout
+	package_toc_cache_header header;
+	memset(&header, 0, sizeof(header));
+	header.magic = B_PACKAGE_TOC_CACHE_MAGIC;
+	header.version = B_PACKAGE_TOC_CACHE_VERSION;
+	header.header_size = sizeof(header);
+	header.package_count = fPackages.Count();
+
+	uint64 offset = sizeof(header)
+		+ (uint64)fPackages.Count() * sizeof(package_toc_cache_package);
+	for (int32 i = 0; i < fPackages.Count(); i++) {
+		Package* package = fPackages[i];
+		package->key.records_offset = offset;
+		package->key.records_size = package->records.Count();
+		offset += package->key.records_size;
+	}
+
+	header.strings_offset = offset;
+	header.strings_size = fStrings.Count();
+	header.total_size = offset + header.strings_size;
+
+	// write everything
+	status_t error = _Write(fd, 0, &header, sizeof(header));
+	offset = sizeof(header);
+	for (int32 i = 0; error == B_OK && i < fPackages.Count(); i++) {
+		error = _Write(fd, offset, &fPackages[i]->key,
+			sizeof(package_toc_cache_package));
+		offset += sizeof(package_toc_cache_package);
+	}
+
+	for (int32 i = 0; error == B_OK && i < fPackages.Count(); i++) {
+		Package* package = fPackages[i];
+		error = _Write(fd, package->key.records_offset,
+			package->records.Elements(), package->records.Count());
+	}
+
+	if (error == B_OK) {
+		error = _Write(fd, header.strings_offset, fStrings.Elements(),
+			fStrings.Count());
+	}
+
+	if (error == B_OK && ftruncate(fd, header.total_size) != 0)
+		error = errno;
+
+	if (error != B_OK) {
+		fErrorOutput->PrintError("Error: Failed to write TOC cache: %s\n",
+			strerror(error));
+	}
+
+	return error;
+}
+
+
+status_t
+PackageTOCCacheWriter::_AddString(const char* string, uint32& _offset)
+{
+	CachedString* cachedString = fStringTable.Lookup(string);
+	if (cachedString == NULL) {
+		size_t size = strlen(string) + 1;
+		int32 offset = fStrings.Count();
+		if ((uint64)offset + size >= B_PACKAGE_TOC_CACHE_NO_STRING)
+			return B_BUFFER_OVERFLOW;
+
+		cachedString = new(std::nothrow) CachedString;
+		if (cachedString == NULL || !cachedString->Init(string)
+			|| !fStrings.AddUninitialized(size)) {
+			delete cachedString;
+			return B_NO_MEMORY;
+		}
+
+		memcpy(fStrings.Elements() + offset, string, size);
+		cachedString->index = offset;
+		fStringTable.Insert(cachedString);
+	}
+
+	_offset = cachedString->index;
+	return B_OK;
+}
+
+
+status_t
+PackageTOCCacheWriter::_AddOptionalString(const char* string, uint32& _offset)
+{
+	if (string == NULL) {
+		_offset = B_PACKAGE_TOC_CACHE_NO_STRING;
+		return B_OK;
+	}
+
+	return _AddString(string, _offset);
+}
+
+
+/*static*/ bool
+PackageTOCCacheWriter::_PackageFileNameLess(const Package* a, const Package* b)
+{
+	return strcmp(a->fileName, b->fileName) < 0;
+}
+
+
+status_t
+PackageTOCCacheWriter::_Write(int fd, off_t offset, const void* data,
+	size_t size)
+{
+	while (size > 0) {
+		ssize_t bytesWritten = pwrite(fd, data, size, offset);
+		if (bytesWritten < 0)
+			return errno;
+		if (bytesWritten == 0)
+			return B_ERROR;
+
+		data = (const uint8*)data + bytesWritten;
+		size -= bytesWritten;
+		offset += bytesWritten;
+	}
+
+	return B_OK;
+}
+
+
+}	// namespace BPrivate
+
+}	// namespace BHPKG
+
+}	// namespace BPackageKit
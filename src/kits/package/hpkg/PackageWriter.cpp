@@ -23,7 +23,8 @@ BPackageWriterParameters::BPackageWriterParameters()
 	:
 	fFlags(0),
 	fCompression(B_HPKG_COMPRESSION_ZLIB),
-	fCompressionLevel(B_HPKG_COMPRESSION_LEVEL_BEST)
+	fCompressionLevel(B_HPKG_COMPRESSION_LEVEL_BEST),
+	fThreadCount(0)
 {
 }
 
@@ -75,6 +76,20 @@ BPackageWriterParameters::SetCompressionLevel(int32 compressionLevel)
 }
 
 
+int32
+BPackageWriterParameters::ThreadCount() const
+{
+	return fThreadCount;
+}
+
+
+void
+BPackageWriterParameters::SetThreadCount(int32 threadCount)
+{
+	fThreadCount = threadCount;
+}
+
+
 // #pragma mark - BPackageWriter
 
 
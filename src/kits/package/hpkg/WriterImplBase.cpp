@@ -360,7 +360,7 @@ WriterImplBase::InitHeapReader(size_t headerSize)
 	// create heap writer
 	fHeapWriter = new PackageFileHeapWriter(fErrorOutput, fFile, headerSize,
 		compressionAlgorithm, decompressionAlgorithm);
-	fHeapWriter->Init();
+	fHeapWriter->Init(fParameters.ThreadCount());
 
 	return B_OK;
 }
@@ -11,6 +11,7 @@
 #include <package/manager/PackageManager.h>
 
 #include <glob.h>
+#include <string.h>
 
 #include <Catalog.h>
 #include <Directory.h>
@@ -29,6 +30,7 @@
 #include <CopyEngine.h>
 #include <package/ActivationTransaction.h>
 #include <package/DaemonClient.h>
+#include <package/DownloadPackageDeltaRequest.h>
 #include <package/manager/RepositoryBuilder.h>
 #include <package/ValidateChecksumJob.h>
 
@@ -40,6 +42,7 @@
 #define B_TRANSLATION_CONTEXT "PackageManagerKit"
 
 
+using BPackageKit::BPrivate::DownloadPackageDeltaRequest;
 using BPackageKit::BPrivate::FetchFileJob;
 using BPackageKit::BPrivate::FetchUtils;
 using BPackageKit::BPrivate::ValidateChecksumJob;
@@ -603,6 +606,13 @@ BPackageManager::_PreparePackageChanges(
 				}
 			}
 
+			// try a delta, unless there's a partial download to resume
+			if (!alreadyDownloaded && !entry.Exists()
+				&& _DownloadPackageDelta(installationRepository,
+					remoteRepository, package, entry)) {
+				alreadyDownloaded = true;
+			}
+
 			if (!alreadyDownloaded) {
 				// download the package (this will resume the download if the
 				// file already exists)
@@ -683,6 +693,79 @@ BPackageManager::_CommitPackageChanges(Transaction& transaction)
 }
 
 
+bool
+BPackageManager::_DownloadPackageDelta(
+	InstalledRepository& installationRepository,
+	RemoteRepository* remoteRepository, BSolverPackage* package,
+	BEntry& entry)
+{
+	// An update replaces an installed version of the package. If the
+	// repository provides a delta against that version, download it and
+	// reconstruct the package from the installed file.
+	// Only repositories that are configured to publish deltas are asked for
+	// one, everywhere else the lookup would just fail.
+	if (!remoteRepository->Config().ProvidesDeltas())
+		return false;
+
+	PackageList& packagesToDeactivate
+		= installationRepository.PackagesToDeactivate();
+	BSolverPackage* basePackage = NULL;
+	for (int32 i = 0; BSolverPackage* oldPackage
+			= packagesToDeactivate.ItemAt(i); i++) {
+		if (oldPackage->Info().Name() == package->Info().Name()) {
+			basePackage = oldPackage;
+			break;
+		}
+	}
+
+	if (basePackage == NULL)
+		return false;
+
+	BPath basePath;
+	installationRepository.GetPackagePath(basePackage, basePath);
+	BEntry baseEntry(basePath.Path());
+	if (!baseEntry.Exists())
+		return false;
+
+	BString fileName(package->Info().FileName());
+	BString deltaFileName(basePackage->Info().FileName());
+	deltaFileName << "--" << fileName << ".delta";
+
+	BEntry deltaEntry;
+	BDirectory directory;
+	if (entry.GetParent(&directory) != B_OK
+		|| deltaEntry.SetTo(&directory, deltaFileName) != B_OK) {
+		return false;
+	}
+
+	BString url = remoteRepository->Config().PackagesURL();
+	url << "/deltas/" << deltaFileName;
+
+	status_t error = DownloadPackageDelta(url, baseEntry, deltaEntry, entry,
+		package->Info().Checksum());
+	deltaEntry.Remove();
+
+	if (error != B_OK) {
+		// Most repositories don't provide deltas for all updates. Start over
+		// with the complete package.
+		entry.Remove();
+		if (fDebugLevel > 0) {
+			printf("Failed to update package %s from delta: %s\n",
+				package->Info().Name().String(), strerror(error));
+		}
+		return false;
+	}
+
+	// The package has been validated against the repository's checksum.
+	// Mark it complete like a regular download, so that a later transaction
+	// reuses it instead of trying to resume its download.
+	BNode node(&entry);
+	FetchUtils::MarkDownloadComplete(node);
+
+	return true;
+}
+
+
 void
 BPackageManager::_ClonePackageFile(LocalRepository* repository,
 	BSolverPackage* package, const BEntry& entry)
@@ -875,6 +958,18 @@ BPackageManager::DownloadPackage(const BString& fileURL,
 }
 
 
+status_t
+BPackageManager::DownloadPackageDelta(const BString& deltaURL,
+	const BEntry& baseEntry, const BEntry& deltaEntry,
+	const BEntry& targetEntry, const BString& checksum)
+{
+	BDecisionProvider provider;
+	BContext context(provider, *this);
+	return DownloadPackageDeltaRequest(context, deltaURL, baseEntry,
+		deltaEntry, targetEntry, checksum).Process();
+}
+
+
 status_t
 BPackageManager::RefreshRepository(const BRepositoryConfig& repoConfig)
 {
@@ -15,6 +15,8 @@
 #include <package/RepositoryConfig.h>
 #include <package/solver/SolverPackage.h>
 
+#include <package/ChecksumAccessors.h>
+
 
 static const int32 kInitialPackageListSize = 40;
 
@@ -28,6 +30,7 @@ BSolverRepository::BSolverRepository()
 	fPriority(0),
 	fIsInstalled(false),
 	fPackages(kInitialPackageListSize, true),
+	fChecksum(),
 	fChangeCount(0)
 {
 }
@@ -39,6 +42,7 @@ BSolverRepository::BSolverRepository(const BString& name)
 	fPriority(0),
 	fIsInstalled(false),
 	fPackages(kInitialPackageListSize, true),
+	fChecksum(),
 	fChangeCount(0)
 {
 	SetTo(name);
@@ -51,6 +55,7 @@ BSolverRepository::BSolverRepository(BPackageInstallationLocation location)
 	fPriority(0),
 	fIsInstalled(false),
 	fPackages(kInitialPackageListSize, true),
+	fChecksum(),
 	fChangeCount(0)
 {
 	SetTo(location);
@@ -63,6 +68,7 @@ BSolverRepository::BSolverRepository(BAllInstallationLocations)
 	fPriority(0),
 	fIsInstalled(false),
 	fPackages(kInitialPackageListSize, true),
+	fChecksum(),
 	fChangeCount(0)
 {
 	SetTo(B_ALL_INSTALLATION_LOCATIONS);
@@ -75,6 +81,7 @@ BSolverRepository::BSolverRepository(const BRepositoryConfig& config)
 	fPriority(0),
 	fIsInstalled(false),
 	fPackages(kInitialPackageListSize, true),
+	fChecksum(),
 	fChangeCount(0)
 {
 	SetTo(config);
@@ -159,6 +166,7 @@ BSolverRepository::SetTo(const BRepositoryConfig& config)
 		}
 	}
 
+	_SetChecksum(cache);
 	return B_OK;
 }
 
@@ -184,6 +192,7 @@ BSolverRepository::SetTo(const BRepositoryCache& cache)
 		}
 	}
 
+	_SetChecksum(cache);
 	return B_OK;
 }
 
@@ -195,6 +204,7 @@ BSolverRepository::Unset()
 	fPriority = 0;
 	fIsInstalled = false;
 	fPackages.MakeEmpty();
+	fChecksum.Truncate(0);
 	fChangeCount++;
 }
 
@@ -274,6 +284,7 @@ BSolverRepository::AddPackage(const BPackageInfo& info,
 		return B_NO_MEMORY;
 	}
 
+	fChecksum.Truncate(0);
 	fChangeCount++;
 
 	if (_package != NULL)
@@ -309,6 +320,7 @@ BSolverRepository::RemovePackage(BSolverPackage* package)
 	if (!fPackages.RemoveItem(package, false))
 		return false;
 
+	fChecksum.Truncate(0);
 	fChangeCount++;
 	return true;
 }
@@ -325,6 +337,13 @@ BSolverRepository::DeletePackage(BSolverPackage* package)
 }
 
 
+BString
+BSolverRepository::Checksum() const
+{
+	return fChecksum;
+}
+
+
 uint64
 BSolverRepository::ChangeCount() const
 {
@@ -332,4 +351,19 @@ BSolverRepository::ChangeCount() const
 }
 
 
+/*!	Sets the checksum to the one of the given repository cache file. Must be
+	called after all of its packages have been added, since changing the
+	packages resets the checksum.
+	The checksum only serves to identify the repository's content, so failing
+	to compute it is not an error.
+*/
+void
+BSolverRepository::_SetChecksum(const BRepositoryCache& cache)
+{
+	BPrivate::GeneralFileChecksumAccessor checksumAccessor(cache.Entry());
+	if (checksumAccessor.GetChecksum(fChecksum) != B_OK)
+		fChecksum.Truncate(0);
+}
+
+
 }	// namespace BPackageKit
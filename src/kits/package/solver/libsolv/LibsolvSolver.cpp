@@ -10,7 +10,10 @@
 #include "LibsolvSolver.h"
 
 #include <errno.h>
+#include <stdio.h>
+#include <sys/stat.h>
 #include <sys/utsname.h>
+#include <unistd.h>
 
 #include <new>
 
@@ -18,9 +21,14 @@
 #include <solv/poolarch.h>
 #include <solv/repo.h>
 #include <solv/repo_haiku.h>
+#include <solv/repo_solv.h>
+#include <solv/repo_write.h>
 #include <solv/selection.h>
 #include <solv/solverdebug.h>
 
+#include <FindDirectory.h>
+#include <OS.h>
+
 #include <package/PackageResolvableExpression.h>
 #include <package/RepositoryCache.h>
 #include <package/solver/SolverPackage.h>
@@ -38,6 +46,11 @@
 // abort()s. Obviously that isn't good behavior for a library.
 
 
+static const char* const kCacheDirectoryName = "package-solver";
+static const char* const kCacheFileMagic = "haiku-solver-repository-cache";
+static const int kCacheFileVersion = 1;
+
+
 BSolver*
 BPackageKit::create_solver()
 {
@@ -731,23 +744,74 @@ LibsolvSolver::_AddRepositories()
 	if (fPool != NULL && !_HaveRepositoriesChanged())
 		return B_OK;
 
-	// something has changed -- re-create the pool
-	status_t error = _InitPool();
-	if (error != B_OK)
-		return error;
+	// Something has changed. If we don't have a pool yet, create it.
+	// Otherwise only the changed repositories need to be re-added, which
+	// usually is just the one with the installed packages.
+	if (fPool == NULL) {
+		status_t error = _InitPool();
+		if (error != B_OK)
+			return error;
 
-	fInstalledRepository = NULL;
+		fInstalledRepository = NULL;
+	} else
+		_CleanupJobQueue();
+
+	bigtime_t startTime = system_time();
 
 	int32 repositoryCount = fRepositoryInfos.CountItems();
 	for (int32 i = 0; i < repositoryCount; i++) {
 		RepositoryInfo* repositoryInfo = fRepositoryInfos.ItemAt(i);
-		BSolverRepository* repository = repositoryInfo->Repository();
-		Repo* repo = repo_create(fPool, repository->Name());
-		repositoryInfo->SetSolvRepo(repo);
+		if (!repositoryInfo->HasChanged())
+			continue;
 
-		repo->priority = -1 - repository->Priority();
-		repo->appdata = (void*)repositoryInfo;
+		_RemoveRepository(repositoryInfo);
 
+		status_t error = _AddRepository(repositoryInfo);
+		if (error != B_OK) {
+			_CleanupPool();
+			return error;
+		}
+	}
+
+	// create "provides" lookup
+	pool_createwhatprovides(fPool);
+
+	pool_debug(fPool, SOLV_DEBUG_STATS,
+		"building the pool took %" B_PRIdBIGTIME " us\n",
+		system_time() - startTime);
+
+	return B_OK;
+}
+
+
+status_t
+LibsolvSolver::_AddRepository(RepositoryInfo* repositoryInfo)
+{
+	bigtime_t startTime = system_time();
+
+	BSolverRepository* repository = repositoryInfo->Repository();
+	Repo* repo = repo_create(fPool, repository->Name());
+	repositoryInfo->SetSolvRepo(repo);
+
+	repo->priority = -1 - repository->Priority();
+	repo->appdata = (void*)repositoryInfo;
+
+	bool cached = _LoadCachedRepository(repositoryInfo);
+	if (cached) {
+		// The solvables are in the order of the repository's packages.
+		int32 index = 0;
+		Solvable* solvable;
+		Id solvableId;
+		FOR_REPO_SOLVABLES(repo, solvableId, solvable) {
+			BSolverPackage* package = repository->PackageAt(index++);
+			try {
+				fSolvablePackages[solvableId] = package;
+				fPackageSolvables[package] = solvableId;
+			} catch (std::bad_alloc&) {
+				return B_NO_MEMORY;
+			}
+		}
+	} else {
 		int32 packageCount = repository->CountPackages();
 		for (int32 k = 0; k < packageCount; k++) {
 			BSolverPackage* package = repository->PackageAt(k);
@@ -764,16 +828,179 @@ LibsolvSolver::_AddRepositories()
 
 		repo_internalize(repo);
 
-		if (repository->IsInstalled()) {
-			fInstalledRepository = repositoryInfo;
-			pool_set_installed(fPool, repo);
+		_StoreCachedRepository(repositoryInfo);
+	}
+
+	if (repository->IsInstalled()) {
+		fInstalledRepository = repositoryInfo;
+		pool_set_installed(fPool, repo);
+	}
+
+	repositoryInfo->SetUnchanged();
+
+	pool_debug(fPool, SOLV_DEBUG_STATS,
+		"repository \"%s\": %" B_PRId32 " packages %s in %" B_PRIdBIGTIME
+		" us\n", repository->Name().String(), repository->CountPackages(),
+		cached ? "loaded from cache" : "added", system_time() - startTime);
+
+	return B_OK;
+}
+
+
+/*!	Removes the repository's solvables from the pool, if it had been added.
+	The job queue must have been cleaned up.
+*/
+void
+LibsolvSolver::_RemoveRepository(RepositoryInfo* repositoryInfo)
+{
+	Repo* repo = repositoryInfo->SolvRepo();
+	if (repo == NULL)
+		return;
+
+	// The packages may already have been deleted, so we must not access them.
+	Solvable* solvable;
+	Id solvableId;
+	FOR_REPO_SOLVABLES(repo, solvableId, solvable) {
+		SolvableMap::iterator it = fSolvablePackages.find(solvableId);
+		if (it != fSolvablePackages.end()) {
+			fPackageSolvables.erase(it->second);
+			fSolvablePackages.erase(it);
 		}
+	}
 
-		repositoryInfo->SetUnchanged();
+	if (fInstalledRepository == repositoryInfo) {
+		pool_set_installed(fPool, NULL);
+		fInstalledRepository = NULL;
 	}
 
-	// create "provides" lookup
-	pool_createwhatprovides(fPool);
+	repo_free(repo, 1);
+	repositoryInfo->SetSolvRepo(NULL);
+}
+
+
+/*!	Fills the repository's empty solv repo from the cache file written by
+	_StoreCachedRepository(), if that was written for the repository's
+	current content, as identified by its checksum.
+	Returns whether the cache file could be used.
+*/
+bool
+LibsolvSolver::_LoadCachedRepository(RepositoryInfo* repositoryInfo)
+{
+	BSolverRepository* repository = repositoryInfo->Repository();
+	BString checksum = repository->Checksum();
+	if (repository->IsInstalled() || checksum.IsEmpty())
+		return false;
+
+	BString path;
+	if (_GetCacheFilePath(repository, false, path) != B_OK)
+		return false;
+
+	FILE* file = fopen(path.String(), "r");
+	if (file == NULL)
+		return false;
+	CObjectDeleter<FILE, int, fclose> fileCloser(file);
+
+	// check the header
+	char header[256];
+	if (fgets(header, sizeof(header), file) == NULL)
+		return false;
+
+	char magic[64];
+	char fileChecksum[128];
+	int version;
+	int32 packageCount;
+	if (sscanf(header, "%63s %d %127s %" B_SCNd32, magic, &version,
+			fileChecksum, &packageCount) != 4
+		|| strcmp(magic, kCacheFileMagic) != 0
+		|| version != kCacheFileVersion
+		|| checksum != fileChecksum
+		|| packageCount != repository->CountPackages()) {
+		return false;
+	}
+
+	// read the solv data and check whether the solvables still match the
+	// packages
+	Repo* repo = repositoryInfo->SolvRepo();
+	if (repo_add_solv(repo, file, 0) != 0) {
+		repo_empty(repo, 1);
+		return false;
+	}
+
+	int32 index = 0;
+	Solvable* solvable;
+	Id solvableId;
+	FOR_REPO_SOLVABLES(repo, solvableId, solvable) {
+		BSolverPackage* package = repository->PackageAt(index++);
+		if (package == NULL
+			|| package->Name() != pool_id2str(fPool, solvable->name)) {
+			index = -1;
+			break;
+		}
+	}
+
+	if (index != packageCount) {
+		repo_empty(repo, 1);
+		return false;
+	}
+
+	return true;
+}
+
+
+/*!	Writes the repository's solv repo to its cache file, so that it can be
+	loaded by _LoadCachedRepository() next time. Failing to do so is not an
+	error.
+*/
+void
+LibsolvSolver::_StoreCachedRepository(RepositoryInfo* repositoryInfo)
+{
+	BSolverRepository* repository = repositoryInfo->Repository();
+	BString checksum = repository->Checksum();
+	if (repository->IsInstalled() || checksum.IsEmpty())
+		return;
+
+	BString path;
+	if (_GetCacheFilePath(repository, true, path) != B_OK)
+		return;
+
+	// write to a temporary file first, so no one reads a partial file
+	BString tempPath(path);
+	tempPath << '.' << getpid();
+
+	FILE* file = fopen(tempPath.String(), "w");
+	if (file == NULL)
+		return;
+
+	bool success = fprintf(file, "%s %d %s %" B_PRId32 "\n", kCacheFileMagic,
+			kCacheFileVersion, checksum.String(), repository->CountPackages())
+			> 0
+		&& repo_write(repositoryInfo->SolvRepo(), file) == 0;
+	success = fclose(file) == 0 && success;
+
+	if (!success || rename(tempPath.String(), path.String()) != 0)
+		unlink(tempPath.String());
+}
+
+
+status_t
+LibsolvSolver::_GetCacheFilePath(BSolverRepository* repository, bool create,
+	BString& _path) const
+{
+	char directory[B_PATH_NAME_LENGTH];
+	status_t error = find_directory(B_USER_CACHE_DIRECTORY, -1, create,
+		directory, sizeof(directory));
+	if (error != B_OK)
+		return error;
+
+	_path = directory;
+	_path << '/' << kCacheDirectoryName;
+
+	if (create && mkdir(_path.String(), 0755) != 0 && errno != EEXIST)
+		return errno;
+
+	BString fileName(repository->Name());
+	fileName.ReplaceAll('/', '_');
+	_path << '/' << fileName << ".solv";
 
 	return B_OK;
 }
@@ -1317,6 +1544,7 @@ LibsolvSolver::_Solve()
 	if (fJobs == NULL || fSolver == NULL)
 		return B_BAD_VALUE;
 
+	bigtime_t startTime = system_time();
 	int problemCount = solver_solve(fSolver, fJobs);
 
 	// get the problems (if any)
@@ -1328,6 +1556,9 @@ LibsolvSolver::_Solve()
 			return error;
 	}
 
+	pool_debug(fPool, SOLV_DEBUG_STATS, "solving took %" B_PRIdBIGTIME " us\n",
+		system_time() - startTime);
+
 	return B_OK;
 }
 
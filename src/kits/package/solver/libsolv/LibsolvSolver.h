@@ -9,6 +9,7 @@
 #include <map>
 
 #include <ObjectList.h>
+#include <String.h>
 #include <package/solver/Solver.h>
 #include <package/solver/SolverProblemSolution.h>
 
@@ -95,6 +96,17 @@ private:
 
 			bool				_HaveRepositoriesChanged() const;
 			status_t			_AddRepositories();
+			status_t			_AddRepository(
+									RepositoryInfo* repositoryInfo);
+			void				_RemoveRepository(
+									RepositoryInfo* repositoryInfo);
+			bool				_LoadCachedRepository(
+									RepositoryInfo* repositoryInfo);
+			void				_StoreCachedRepository(
+									RepositoryInfo* repositoryInfo);
+			status_t			_GetCacheFilePath(
+									BSolverRepository* repository,
+									bool create, BString& _path) const;
 			RepositoryInfo*		_InstalledRepository() const;
 			RepositoryInfo*		_GetRepositoryInfo(
 									BSolverRepository* repository) const;
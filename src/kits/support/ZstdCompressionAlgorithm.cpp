@@ -49,7 +49,8 @@ BZstdCompressionParameters::BZstdCompressionParameters(
 	:
 	BCompressionParameters(),
 	fCompressionLevel(compressionLevel),
-	fBufferSize(kDefaultBufferSize)
+	fBufferSize(kDefaultBufferSize),
+	fLongWindowLog(0)
 {
 }
 
@@ -87,13 +88,33 @@ BZstdCompressionParameters::SetBufferSize(size_t size)
 }
 
 
+int32
+BZstdCompressionParameters::LongWindowLog() const
+{
+	return fLongWindowLog;
+}
+
+
+/*!	Enables long distance matching with a window of 2^\a windowLog bytes.
+	Data compressed with a window larger than 2^27 bytes can only be
+	decompressed with a BZstdDecompressionParameters::MaxWindowLog() at least
+	as large.
+*/
+void
+BZstdCompressionParameters::SetLongWindowLog(int32 windowLog)
+{
+	fLongWindowLog = std::max(windowLog, (int32)0);
+}
+
+
 // #pragma mark - BZstdDecompressionParameters
 
 
 BZstdDecompressionParameters::BZstdDecompressionParameters()
 	:
 	BDecompressionParameters(),
-	fBufferSize(kDefaultBufferSize)
+	fBufferSize(kDefaultBufferSize),
+	fMaxWindowLog(0)
 {
 }
 
@@ -117,6 +138,68 @@ BZstdDecompressionParameters::SetBufferSize(size_t size)
 }
 
 
+int32
+BZstdDecompressionParameters::MaxWindowLog() const
+{
+	return fMaxWindowLog;
+}
+
+
+void
+BZstdDecompressionParameters::SetMaxWindowLog(int32 windowLog)
+{
+	fMaxWindowLog = std::max(windowLog, (int32)0);
+}
+
+
+// #pragma mark - parameter helpers
+
+
+#ifdef B_ZSTD_COMPRESSION_SUPPORT
+
+
+static size_t
+set_compression_parameters(ZSTD_CCtx* context, int32 compressionLevel,
+	const BZstdCompressionParameters* parameters)
+{
+	size_t zstdError = ZSTD_CCtx_setParameter(context,
+		ZSTD_c_compressionLevel, compressionLevel);
+	if (ZSTD_isError(zstdError) || parameters == NULL
+		|| parameters->LongWindowLog() == 0) {
+		return zstdError;
+	}
+
+	zstdError = ZSTD_CCtx_setParameter(context,
+		ZSTD_c_enableLongDistanceMatching, 1);
+	if (ZSTD_isError(zstdError))
+		return zstdError;
+
+	return ZSTD_CCtx_setParameter(context, ZSTD_c_windowLog,
+		parameters->LongWindowLog());
+}
+
+
+#endif	// B_ZSTD_COMPRESSION_SUPPORT
+
+
+#ifdef ZSTD_ENABLED
+
+
+static size_t
+set_decompression_parameters(ZSTD_DCtx* context,
+	const BZstdDecompressionParameters* parameters)
+{
+	if (parameters == NULL || parameters->MaxWindowLog() == 0)
+		return 0;
+
+	return ZSTD_DCtx_setParameter(context, ZSTD_d_windowLogMax,
+		parameters->MaxWindowLog());
+}
+
+
+#endif	// ZSTD_ENABLED
+
+
 // #pragma mark - CompressionStrategy
 
 
@@ -137,7 +220,10 @@ struct BZstdCompressionAlgorithm::CompressionStrategy {
 		}
 
 		*stream = ZSTD_createCStream();
-		return ZSTD_initCStream(*stream, compressionLevel);
+		if (*stream == NULL)
+			return (size_t)-ZSTD_error_memory_allocation;
+		return set_compression_parameters(*stream, compressionLevel,
+			parameters);
 	}
 
 	static void Uninit(ZSTD_CStream *stream)
@@ -171,10 +257,13 @@ struct BZstdCompressionAlgorithm::DecompressionStrategy {
 	static const bool kNeedsFinalFlush = false;
 
 	static size_t Init(ZSTD_DStream **stream,
-		const BZstdDecompressionParameters* /*parameters*/)
+		const BZstdDecompressionParameters* parameters)
 	{
 		*stream = ZSTD_createDStream();
-		return ZSTD_initDStream(*stream);
+		size_t zstdError = ZSTD_initDStream(*stream);
+		if (ZSTD_isError(zstdError))
+			return zstdError;
+		return set_decompression_parameters(*stream, parameters);
 	}
 
 	static void Uninit(ZSTD_DStream *stream)
@@ -378,8 +467,23 @@ BZstdCompressionAlgorithm::CompressBuffer(const void* input,
 		? zstdParameters->CompressionLevel()
 		: B_ZSTD_COMPRESSION_DEFAULT;
 
-	size_t zstdError = ZSTD_compress(output, outputSize, input,
-		inputSize, compressionLevel);
+	size_t zstdError;
+	if (zstdParameters != NULL && zstdParameters->LongWindowLog() != 0) {
+		ZSTD_CCtx* context = ZSTD_createCCtx();
+		if (context == NULL)
+			return B_NO_MEMORY;
+
+		zstdError = set_compression_parameters(context, compressionLevel,
+			zstdParameters);
+		if (!ZSTD_isError(zstdError)) {
+			zstdError = ZSTD_compress2(context, output, outputSize, input,
+				inputSize);
+		}
+		ZSTD_freeCCtx(context);
+	} else {
+		zstdError = ZSTD_compress(output, outputSize, input, inputSize,
+			compressionLevel);
+	}
 	if (ZSTD_isError(zstdError))
 		return _TranslateZstdError(zstdError);
 
@@ -397,8 +501,27 @@ BZstdCompressionAlgorithm::DecompressBuffer(const void* input,
 	size_t& _uncompressedSize, const BDecompressionParameters* parameters)
 {
 #ifdef ZSTD_ENABLED
-	size_t zstdError = ZSTD_decompress(output, outputSize, input,
-		inputSize);
+	const BZstdDecompressionParameters* zstdParameters
+#ifdef _BOOT_MODE
+		= static_cast<const BZstdDecompressionParameters*>(parameters);
+#else
+		= dynamic_cast<const BZstdDecompressionParameters*>(parameters);
+#endif
+
+	size_t zstdError;
+	if (zstdParameters != NULL && zstdParameters->MaxWindowLog() != 0) {
+		ZSTD_DCtx* context = ZSTD_createDCtx();
+		if (context == NULL)
+			return B_NO_MEMORY;
+
+		zstdError = set_decompression_parameters(context, zstdParameters);
+		if (!ZSTD_isError(zstdError)) {
+			zstdError = ZSTD_decompressDCtx(context, output, outputSize,
+				input, inputSize);
+		}
+		ZSTD_freeDCtx(context);
+	} else
+		zstdError = ZSTD_decompress(output, outputSize, input, inputSize);
 	if (ZSTD_isError(zstdError))
 		return _TranslateZstdError(zstdError);
 
@@ -2696,6 +2696,28 @@ Desktop::_DispatchMessage(int32 code, BPrivate::LinkReceiver& link)
 			break;
 		}
 
+		case AS_DUMP_FRAME_STATISTICS:
+		{
+			frame_statistics statistics;
+			if (HWInterface()->GetFrameStatistics(statistics) != B_OK) {
+				debug_printf("No asynchronous screen updates.\n");
+				break;
+			}
+
+			debug_printf("Screen updates, %.2f Hz (%s retrace):\n",
+				statistics.refresh_rate,
+				statistics.hardware_retrace ? "hardware" : "software");
+			debug_printf("  %" B_PRIu64 " frames, %" B_PRIu64 " dropped\n",
+				statistics.frames, statistics.dropped_frames);
+			if (statistics.frames > 0) {
+				debug_printf("  latency %" B_PRId64 " us average, %" B_PRId64
+					" us at most\n",
+					statistics.total_latency / (bigtime_t)statistics.frames,
+					statistics.max_latency);
+			}
+			break;
+		}
+
 		case AS_EVENT_STREAM_CLOSED:
 			_LaunchInputServer();
 			break;
@@ -1710,9 +1710,18 @@ ServerApp::_DispatchMessage(int32 code, BPrivate::LinkReceiver& link)
 		{
 			STRACE(("ServerApp %s: AS_GET_FONT_LIST_REVISION\n", Signature()));
 
+			// Returns:
+			// 1) int32 - revision of the font list
+			// 2) uint32 - the settings that string widths depend on
+
+			DesktopSettings settings(fDesktop);
+			uint32 renderingSettings = settings.Hinting()
+				| (settings.SubpixelAntialiasing() ? 0x100 : 0);
+
 			fLink.StartMessage(B_OK);
 			fLink.Attach<int32>(
 				gFontManager->CheckRevision(fDesktop->UserID()));
+			fLink.Attach<uint32>(renderingSettings);
 			fLink.Flush();
 			break;
 		}
@@ -1054,12 +1054,30 @@ ServerFont::StringWidth(const char *string, int32 numBytes,
 	if (!string || numBytes <= 0)
 		return 0.0;
 
+	// The same strings are measured over and over again, so the widths are
+	// remembered in the font cache, unless there are deltas to apply.
+	FontCacheReference cacheReference;
+	FontCacheEntry* entry = NULL;
+	if (deltaArray == NULL) {
+		entry = GlyphLayoutEngine::FontCacheEntryFor(*this, false);
+		if (entry == NULL || !cacheReference.SetTo(entry, false))
+			return 0.0;
+
+		float width;
+		if (entry->CachedStringWidth(string, numBytes, fSpacing, width))
+			return width;
+	}
+
 	StringWidthConsumer consumer;
 	if (!GlyphLayoutEngine::LayoutGlyphs(consumer, *this, string, numBytes,
-			INT32_MAX, deltaArray, fSpacing)) {
+			INT32_MAX, deltaArray, fSpacing, NULL,
+			entry != NULL ? &cacheReference : NULL)) {
 		return 0.0;
 	}
 
+	if (entry != NULL && cacheReference.Entry() == entry)
+		entry->CacheStringWidth(string, numBytes, fSpacing, consumer.width);
+
 	return consumer.width;
 }
 
@@ -1946,8 +1946,10 @@ Window::BeginUpdate(BPrivate::PortLink& link)
 	link.Attach<int32>(B_NULL_TOKEN);
 	link.Flush();
 
-	// supress back to front buffer copies in the drawing engine
+	// supress back to front buffer copies in the drawing engine, and keep
+	// pending asynchronous ones from showing the region half drawn
 	fDrawingEngine->SetCopyToFrontEnabled(false);
+	fDrawingEngine->HoldUpdates(*dirty);
 
 	if (fDrawingEngine->LockParallelAccess()) {
 		fDrawingEngine->SuspendAutoSync();
@@ -1980,6 +1982,7 @@ Window::EndUpdate()
 			fDrawingEngine->CopyToFront(*dirty);
 			fRegionPool.Recycle(dirty);
 		}
+		fDrawingEngine->ReleaseUpdates();
 
 		fCurrentUpdateSession->SetUsed(false);
 
@@ -21,6 +21,7 @@
 #include "DrawState.h"
 #include "GlyphLayoutEngine.h"
 #include "Painter.h"
+#include "ParallelRenderer.h"
 #include "ServerBitmap.h"
 #include "ServerCursor.h"
 #include "RenderingBuffer.h"
@@ -64,6 +65,17 @@ extend_by_stroke_width(BRect& rect, float penSize)
 }
 
 
+/*!	Renders \a job in bands using \a renderer, if the area is large enough.
+	Returns \c false if the caller has to render the primitive itself.
+*/
+static inline bool
+render_parallel(ParallelRenderer* renderer, const Painter* painter,
+	const BRect& area, ParallelRenderer::Job& job)
+{
+	return renderer != NULL && renderer->Render(*painter, area, job);
+}
+
+
 class AutoFloatingOverlaysHider {
 	public:
 		AutoFloatingOverlaysHider(HWInterface* interface, const BRect& area)
@@ -97,6 +109,89 @@ class AutoFloatingOverlaysHider {
 
 };
 
+class FillRectJob : public ParallelRenderer::Job {
+public:
+	FillRectJob(const BRect& rect)
+		:
+		fRect(rect)
+	{
+	}
+
+	virtual void Render(Painter* painter)
+	{
+		painter->FillRect(fRect);
+	}
+
+private:
+	BRect fRect;
+};
+
+
+class FillRectColorJob : public ParallelRenderer::Job {
+public:
+	FillRectColorJob(const BRect& rect, const rgb_color& color)
+		:
+		fRect(rect),
+		fColor(color)
+	{
+	}
+
+	virtual void Render(Painter* painter)
+	{
+		painter->FillRect(fRect, fColor);
+	}
+
+private:
+	BRect fRect;
+	rgb_color fColor;
+};
+
+
+class FillRectGradientJob : public ParallelRenderer::Job {
+public:
+	FillRectGradientJob(const BRect& rect, const BGradient& gradient)
+		:
+		fRect(rect),
+		fGradient(gradient)
+	{
+	}
+
+	virtual void Render(Painter* painter)
+	{
+		painter->FillRect(fRect, fGradient);
+	}
+
+private:
+	BRect fRect;
+	const BGradient& fGradient;
+};
+
+
+class DrawBitmapJob : public ParallelRenderer::Job {
+public:
+	DrawBitmapJob(const ServerBitmap* bitmap, const BRect& bitmapRect,
+			const BRect& viewRect, uint32 options)
+		:
+		fBitmap(bitmap),
+		fBitmapRect(bitmapRect),
+		fViewRect(viewRect),
+		fOptions(options)
+	{
+	}
+
+	virtual void Render(Painter* painter)
+	{
+		painter->DrawBitmap(fBitmap, fBitmapRect, fViewRect, fOptions);
+	}
+
+private:
+	const ServerBitmap* fBitmap;
+	BRect fBitmapRect;
+	BRect fViewRect;
+	uint32 fOptions;
+};
+
+
 class DrawTransaction {
 public:
 	DrawTransaction(DrawingEngine *engine, const BRect &bounds)
@@ -179,6 +274,7 @@ private:
 DrawingEngine::DrawingEngine(HWInterface* interface)
 	:
 	fPainter(new Painter()),
+	fParallelRenderer(ParallelRenderer::Default()),
 	fGraphicsCard(NULL),
 	fAvailableHWAccleration(0),
 	fSuspendSyncLevel(0),
@@ -270,8 +366,10 @@ DrawingEngine::SetHWInterface(HWInterface* interface)
 	if (fGraphicsCard == interface)
 		return;
 
-	if (fGraphicsCard)
+	if (fGraphicsCard) {
+		fGraphicsCard->ReleaseUpdates(this);
 		fGraphicsCard->RemoveListener(this);
+	}
 
 	fGraphicsCard = interface;
 
@@ -296,6 +394,30 @@ DrawingEngine::CopyToFront(/*const*/ BRegion& region)
 }
 
 
+/*!	Keeps the region from being transferred to the front buffer by an
+	asynchronous update until ReleaseUpdates() is called.
+*/
+void
+DrawingEngine::HoldUpdates(const BRegion& region)
+{
+	fGraphicsCard->HoldUpdates(this, region);
+}
+
+
+void
+DrawingEngine::ReleaseUpdates()
+{
+	fGraphicsCard->ReleaseUpdates(this);
+}
+
+
+void
+DrawingEngine::SetParallelRenderer(ParallelRenderer* renderer)
+{
+	fParallelRenderer = renderer;
+}
+
+
 // #pragma mark -
 
 
@@ -702,7 +824,12 @@ DrawingEngine::DrawBitmap(ServerBitmap* bitmap, const BRect& bitmapRect,
 	ASSERT_PARALLEL_LOCKED();
 
 	DrawTransaction transaction(this, fPainter->TransformAndClipRect(viewRect));
-	if (transaction.IsDirty())
+	if (!transaction.IsDirty())
+		return;
+
+	DrawBitmapJob job(bitmap, bitmapRect, viewRect, options);
+	if (!render_parallel(fParallelRenderer, fPainter.Get(),
+			transaction.DirtyRegion().Frame(), job))
 		fPainter->DrawBitmap(bitmap, bitmapRect, viewRect, options);
 }
 
@@ -933,7 +1060,10 @@ DrawingEngine::FillRect(BRect r, const rgb_color& color)
 		fGraphicsCard->FillRegion(region, color,
 			fSuspendSyncLevel == 0 || transaction.WasOverlaysHidden());
 	} else {
-		fPainter->FillRect(r, color);
+		FillRectColorJob job(r, color);
+		if (!render_parallel(fParallelRenderer, fPainter.Get(),
+				transaction.DirtyRegion().Frame(), job))
+			fPainter->FillRect(r, color);
 	}
 }
 
@@ -1047,7 +1177,10 @@ DrawingEngine::FillRect(BRect r)
 		}
 	}
 
-	fPainter->FillRect(r);
+	FillRectJob job(r);
+	if (!render_parallel(fParallelRenderer, fPainter.Get(),
+			transaction.DirtyRegion().Frame(), job))
+		fPainter->FillRect(r);
 }
 
 
@@ -1063,7 +1196,10 @@ DrawingEngine::FillRect(BRect r, const BGradient& gradient)
 	if (!transaction.IsDirty())
 		return;
 
-	fPainter->FillRect(r, gradient);
+	FillRectGradientJob job(r, gradient);
+	if (!render_parallel(fParallelRenderer, fPainter.Get(),
+			transaction.DirtyRegion().Frame(), job))
+		fPainter->FillRect(r, gradient);
 }
 
 
@@ -29,6 +29,7 @@ class BRegion;
 
 class DrawState;
 class Painter;
+class ParallelRenderer;
 class ServerBitmap;
 class ServerCursor;
 class ServerFont;
@@ -48,7 +49,15 @@ public:
 	virtual	void			SetCopyToFrontEnabled(bool enable);
 			bool			CopyToFrontEnabled() const
 								{ return fCopyToFront; }
+
+	// large primitives are split up and rendered by multiple threads,
+	// unless this is set to NULL
+			void			SetParallelRenderer(ParallelRenderer* renderer);
+			ParallelRenderer* GetParallelRenderer() const
+								{ return fParallelRenderer; }
 	virtual	void			CopyToFront(/*const*/ BRegion& region);
+			void			HoldUpdates(const BRegion& region);
+			void			ReleaseUpdates();
 
 	// locking
 			bool			LockParallelAccess();
@@ -209,6 +218,7 @@ private:
 
 			ObjectDeleter<Painter>
 							fPainter;
+			ParallelRenderer* fParallelRenderer;
 			HWInterface*	fGraphicsCard;
 			uint32			fAvailableHWAccleration;
 			int32			fSuspendSyncLevel;
@@ -336,26 +336,46 @@ status_t
 HWInterface::Invalidate(const BRect& frame)
 {
 	if (IsDoubleBuffered()) {
-#if 0
-// NOTE: The UpdateQueue works perfectly fine, but it screws the
-// flicker-free-ness of the double buffered rendering. The problem being the
-// asynchronous nature. The UpdateQueue will transfer regions of the screen
-// which have been clean at the time we are in this function, but which have
-// been damaged meanwhile by drawing into them again. All in all, the
-// UpdateQueue is good for reducing the number of times that the transfer
-// is performed, and makes it happen during refresh only, but until there
-// is a smarter way to synchronize this all better, I've disabled it.
-		if (fUpdateExecutor != NULL) {
-			fUpdateExecutor->AddRect(frame);
+		// The UpdateQueue coalesces the invalidated rects and transfers them
+		// with the next retrace. Windows hold back the region they are
+		// redrawing (see HoldUpdates()), so that it does not show up half
+		// drawn.
+		if (fUpdateExecutor.IsSet() && fUpdateExecutor->AddRect(frame) == B_OK)
 			return B_OK;
-		}
-#endif
+
 		return CopyBackToFront(frame);
 	}
 	return B_OK;
 }
 
 
+void
+HWInterface::HoldUpdates(const void* owner, const BRegion& region)
+{
+	if (fUpdateExecutor.IsSet())
+		fUpdateExecutor->Hold(owner, region);
+}
+
+
+void
+HWInterface::ReleaseUpdates(const void* owner)
+{
+	if (fUpdateExecutor.IsSet())
+		fUpdateExecutor->Release(owner);
+}
+
+
+status_t
+HWInterface::GetFrameStatistics(frame_statistics& statistics)
+{
+	if (!fUpdateExecutor.IsSet())
+		return B_NOT_SUPPORTED;
+
+	fUpdateExecutor->GetStatistics(statistics);
+	return B_OK;
+}
+
+
 /*! The object must already be locked!
 */
 status_t
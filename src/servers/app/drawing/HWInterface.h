@@ -42,6 +42,19 @@ enum {
 };
 
 
+struct frame_statistics {
+	float		refresh_rate;
+	bool		hardware_retrace;
+	uint64		frames;
+		// number of frames that transferred something to the front buffer
+	uint64		dropped_frames;
+		// number of retraces that passed while something was waiting
+	bigtime_t	total_latency;
+	bigtime_t	max_latency;
+		// from the first invalidation to the end of the transfer
+};
+
+
 class HWInterfaceListener {
 public:
 								HWInterfaceListener();
@@ -174,6 +187,14 @@ public:
 	// either directly or asynchronously by the UpdateQueue thread
 	virtual	status_t			CopyBackToFront(const BRect& frame);
 
+	// keeps the UpdateQueue from transferring a region that is being redrawn
+	// by its owner until it is released again
+			void				HoldUpdates(const void* owner,
+									const BRegion& region);
+			void				ReleaseUpdates(const void* owner);
+			status_t			GetFrameStatistics(
+									frame_statistics& statistics);
+
 protected:
 	virtual	void				_CopyBackToFront(/*const*/ BRegion& region);
 
@@ -61,6 +61,7 @@
 #include "RenderingBuffer.h"
 #include "ServerBitmap.h"
 #include "ServerFont.h"
+#include "SpanBlend.h"
 #include "SystemPalette.h"
 
 #include "AppServer.h"
@@ -107,9 +108,39 @@ using std::nothrow;
 #define fCurve					fInternal.fCurve
 
 
-static uint32 detect_simd();
+static uint32 init_simd();
 
-uint32 gSIMDFlags = detect_simd();
+uint32 gSIMDFlags = init_simd();
+
+
+#if __i386__ || __x86_64__
+/*!	Returns whether the given CPU supports AVX2, and whether the AVX state is
+	saved by the kernel, so that the YMM registers can actually be used.
+*/
+static bool
+cpu_supports_avx2(uint32 cpu)
+{
+	cpuid_info cpuInfo;
+	get_cpuid(&cpuInfo, 0, cpu);
+	if (cpuInfo.regs.eax < 7)
+		return false;
+
+	// OSXSAVE and AVX
+	get_cpuid(&cpuInfo, 1, cpu);
+	const uint32 kNeededFlags = (1 << 27) | (1 << 28);
+	if ((cpuInfo.regs.ecx & kNeededFlags) != kNeededFlags)
+		return false;
+
+	// xgetbv: the SSE and AVX state must be enabled in XCR0
+	uint32 low, high;
+	asm volatile(".byte 0x0f, 0x01, 0xd0" : "=a" (low), "=d" (high) : "c" (0));
+	if ((low & 0x6) != 0x6)
+		return false;
+
+	get_cpuid(&cpuInfo, 7, cpu);
+	return (cpuInfo.regs.ebx & (1 << 5)) != 0;
+}
+#endif
 
 
 /*!	Detect SIMD flags for use in AppServer. Checks all CPUs in the system
@@ -163,6 +194,10 @@ detect_simd()
 				cpuSIMD |= APPSERVER_SIMD_MMX;
 			if (edx & (1 << 25))
 				cpuSIMD |= APPSERVER_SIMD_SSE;
+			if (edx & (1 << 26))
+				cpuSIMD |= APPSERVER_SIMD_SSE2;
+			if (cpu_supports_avx2(cpu))
+				cpuSIMD |= APPSERVER_SIMD_AVX2;
 		} else {
 			// no flags can be identified
 			cpuSIMD = 0;
@@ -170,12 +205,49 @@ detect_simd()
 		systemSIMD &= cpuSIMD;
 	}
 	return systemSIMD;
-#else	// !__i386__
+#elif __x86_64__
+	system_info systemInfo;
+	if (get_system_info(&systemInfo) != B_OK)
+		return 0;
+
+	// SSE2 is part of the architecture, AVX2 must be supported by all CPUs
+	uint32 systemSIMD = APPSERVER_SIMD_SSE2 | APPSERVER_SIMD_AVX2;
+	for (uint32 cpu = 0; cpu < systemInfo.cpu_count; cpu++) {
+		if (!cpu_supports_avx2(cpu))
+			systemSIMD &= ~APPSERVER_SIMD_AVX2;
+	}
+	return systemSIMD;
+#elif __aarch64__
+	// NEON is part of the architecture
+	return APPSERVER_SIMD_NEON;
+#else
 	return 0;
 #endif
 }
 
 
+/*!	Detects the SIMD flags, and chooses the span blenders that fit them best.
+*/
+static uint32
+init_simd()
+{
+	uint32 simdFlags = detect_simd();
+
+#ifdef SPAN_BLEND_X86_SIMD
+	if ((simdFlags & APPSERVER_SIMD_AVX2) != 0)
+		gSpanBlenders = kAVX2SpanBlenders;
+	else if ((simdFlags & APPSERVER_SIMD_SSE2) != 0)
+		gSpanBlenders = kSSE2SpanBlenders;
+#endif
+#ifdef SPAN_BLEND_NEON
+	if ((simdFlags & APPSERVER_SIMD_NEON) != 0)
+		gSpanBlenders = kNEONSpanBlenders;
+#endif
+
+	return simdFlags;
+}
+
+
 // #pragma mark -
 
 
@@ -195,6 +267,7 @@ Painter::Painter()
 	fLineCapMode(B_BUTT_CAP),
 	fLineJoinMode(B_MITER_JOIN),
 	fMiterLimit(B_DEFAULT_MITER_LIMIT),
+	fFillRule(B_NONZERO),
 
 	fPatternHandler(),
 	fTextRenderer(fSubpixRenderer, fRenderer, fRendererBin, fUnpackedScanline,
@@ -327,6 +400,51 @@ Painter::SetDrawState(const DrawState* state, int32 xOffset, int32 yOffset)
 }
 
 
+/*!	Makes this painter draw into the same buffer as \a other, in the same
+	way. The clipping is not adopted, and needs to be set separately, as
+	ParallelRenderer does to restrict the painter to a band of the buffer.
+	Neither are the font nor the alpha mask, so this painter is only fit
+	for drawing primitives that are not text, and only if \a other does
+	not use an alpha mask.
+*/
+void
+Painter::AdoptState(const Painter& other)
+{
+	fBuffer.attach(other.fBuffer.buf(), other.fBuffer.width(),
+		other.fBuffer.height(), other.fBuffer.stride());
+	fAttached = other.fAttached;
+	fValidClipping = fAttached && fClippingRegion != NULL
+		&& fClippingRegion->Frame().IsValid();
+
+	fBaseRenderer.set_offset(other.fBaseRenderer.translate_from_base_ren_x(0),
+		other.fBaseRenderer.translate_from_base_ren_y(0));
+
+	fSubpixelPrecise = other.fSubpixelPrecise;
+	fIdentityTransform = other.fIdentityTransform;
+	fTransform = other.fTransform;
+	fPenSize = other.fPenSize;
+	fLineCapMode = other.fLineCapMode;
+	fLineJoinMode = other.fLineJoinMode;
+	fMiterLimit = other.fMiterLimit;
+	SetFillRule(other.fFillRule);
+
+	fMaskedUnpackedScanline = NULL;
+	fClippedAlphaMask = NULL;
+
+	fPatternHandler = other.fPatternHandler;
+	fDrawingMode = other.fDrawingMode;
+	fAlphaSrcMode = other.fAlphaSrcMode;
+	fAlphaFncMode = other.fAlphaFncMode;
+	fDrawingText = other.fDrawingText;
+	_UpdateDrawingMode(fDrawingText);
+
+	if (fPatternHandler.IsSolidLow())
+		_SetRendererColor(fPatternHandler.LowColor());
+	else
+		_SetRendererColor(fPatternHandler.HighColor());
+}
+
+
 // #pragma mark - state
 
 
@@ -428,6 +546,8 @@ Painter::SetStrokeMode(cap_mode lineCap, join_mode joinMode, float miterLimit)
 void
 Painter::SetFillRule(int32 fillRule)
 {
+	fFillRule = fillRule;
+
 	agg::filling_rule_e aggFillRule = fillRule == B_EVEN_ODD
 		? agg::fill_even_odd : agg::fill_non_zero;
 
@@ -46,6 +46,9 @@ class ServerFont;
 // Defines for SIMD support.
 #define APPSERVER_SIMD_MMX	(1 << 0)
 #define APPSERVER_SIMD_SSE	(1 << 1)
+#define APPSERVER_SIMD_SSE2	(1 << 2)
+#define APPSERVER_SIMD_AVX2	(1 << 3)
+#define APPSERVER_SIMD_NEON	(1 << 4)
 
 
 class Painter {
@@ -66,6 +69,13 @@ public:
 			const BRegion*		ClippingRegion() const
 									{ return fClippingRegion; }
 
+			// adopts the buffer and the drawing state of another painter,
+			// except for its clipping, font, and alpha mask
+			void				AdoptState(const Painter& other);
+	inline	bool				HasAlphaMask() const
+									{ return fInternal.fClippedAlphaMask
+										!= NULL; }
+
 								// object settings
 			void				SetTransform(BAffineTransform transform,
 									int32 xOffset, int32 yOffset);
@@ -350,6 +360,7 @@ private:
 			cap_mode			fLineCapMode;
 			join_mode			fLineJoinMode;
 			float				fMiterLimit;
+			int32				fFillRule;
 
 			PatternHandler		fPatternHandler;
 
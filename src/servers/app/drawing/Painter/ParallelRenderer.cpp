@@ -0,0 +1,263 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Renders large primitives with more than one thread. The area touched by
+	a primitive is split into horizontal bands, and each band is rendered by
+	a Painter of its own, whose clipping is the original clipping restricted
+	to that band. Since the bands do not overlap, the result is the same as
+	if the primitive had been rendered by a single painter. Render() only
+	returns after all bands are done, so the drawing order is preserved.
+*/
+
+
+#include "ParallelRenderer.h"
+
+#include <new>
+
+#include <pthread.h>
+
+#include "Painter.h"
+
+
+// primitives touching fewer pixels are not worth splitting
+static const int32 kMinPixels = 256 * 256;
+static const int32 kMinBandHeight = 32;
+
+
+ParallelRenderer* ParallelRenderer::sDefault = NULL;
+
+
+ParallelRenderer::Job::~Job()
+{
+}
+
+
+// #pragma mark -
+
+
+ParallelRenderer::ParallelRenderer(int32 threadCount)
+	:
+	fLock("parallel renderer"),
+	fThreads(NULL),
+	fThreadCount(0),
+	fStartSemaphore(-1),
+	fDoneSemaphore(-1),
+	fQuitting(false),
+	fJob(NULL),
+	fBandCount(0),
+	fNextBand(0)
+{
+	for (int32 i = 0; i < kMaxBands; i++)
+		fPainters[i] = NULL;
+
+	if (threadCount > kMaxBands - 1)
+		threadCount = kMaxBands - 1;
+	if (threadCount <= 0)
+		return;
+
+	fStartSemaphore = create_sem(0, "parallel renderer start");
+	fDoneSemaphore = create_sem(0, "parallel renderer done");
+	fThreads = new(std::nothrow) thread_id[threadCount];
+	if (fStartSemaphore < 0 || fDoneSemaphore < 0 || fThreads == NULL)
+		return;
+
+	for (int32 i = 0; i < threadCount; i++) {
+		thread_id thread = spawn_thread(&_WorkerEntry, "parallel renderer",
+			B_DISPLAY_PRIORITY, this);
+		if (thread < 0)
+			break;
+
+		fThreads[fThreadCount++] = thread;
+		resume_thread(thread);
+	}
+}
+
+
+ParallelRenderer::~ParallelRenderer()
+{
+	fQuitting = true;
+	if (fThreadCount > 0)
+		release_sem_etc(fStartSemaphore, fThreadCount, 0);
+
+	for (int32 i = 0; i < fThreadCount; i++) {
+		status_t result;
+		wait_for_thread(fThreads[i], &result);
+	}
+	delete[] fThreads;
+
+	delete_sem(fStartSemaphore);
+	delete_sem(fDoneSemaphore);
+
+	for (int32 i = 0; i < kMaxBands; i++)
+		delete fPainters[i];
+}
+
+
+status_t
+ParallelRenderer::InitCheck() const
+{
+	if (fStartSemaphore < 0)
+		return fStartSemaphore;
+	if (fDoneSemaphore < 0)
+		return fDoneSemaphore;
+	if (fThreads == NULL)
+		return B_NO_MEMORY;
+
+	return fThreadCount > 0 ? B_OK : B_ERROR;
+}
+
+
+/*!	Renders \a job in bands, with the drawing state and clipping of
+	\a painter. \a area is the part of the buffer the primitive is expected
+	to touch; it is only used to decide how to split it up, the bands
+	themselves cover the whole clipping region.
+	Returns \c false if the primitive has not been rendered at all, because
+	it is too small to be worth it, or because the renderer is busy with
+	another one. The caller needs to render it on its own then.
+*/
+bool
+ParallelRenderer::Render(const Painter& painter, const BRect& area, Job& job)
+{
+	const BRegion* clipping = painter.ClippingRegion();
+	if (fThreadCount == 0 || clipping == NULL || painter.HasAlphaMask())
+		return false;
+
+	BRect clippingFrame = clipping->Frame();
+	BRect frame = area & clippingFrame;
+	if (!frame.IsValid())
+		return false;
+
+	int32 width = frame.IntegerWidth() + 1;
+	int32 height = frame.IntegerHeight() + 1;
+	if (width * height < kMinPixels)
+		return false;
+
+	int32 bandCount = min_c(CountThreads(), height / kMinBandHeight);
+	if (bandCount < 2)
+		return false;
+
+	// Only one primitive can be split up at a time. If another thread is
+	// using the renderer already, the caller is faster on its own.
+	if (fLock.LockWithTimeout(0) != B_OK)
+		return false;
+
+	for (int32 i = 0; i < bandCount; i++) {
+		if (fPainters[i] == NULL) {
+			fPainters[i] = new(std::nothrow) Painter();
+			if (fPainters[i] == NULL) {
+				bandCount = i;
+				break;
+			}
+		}
+	}
+	if (bandCount < 2) {
+		fLock.Unlock();
+		return false;
+	}
+
+	// The bands split the area evenly, but the first and the last one
+	// extend to the clipping frame, so that nothing is lost should the
+	// primitive touch pixels outside of the area.
+	float top = clippingFrame.top;
+	for (int32 i = 0; i < bandCount; i++) {
+		float bottom = clippingFrame.bottom;
+		if (i < bandCount - 1)
+			bottom = frame.top + (int64)height * (i + 1) / bandCount - 1;
+
+		fClipping[i].Set(BRect(clippingFrame.left, top, clippingFrame.right,
+			bottom));
+		fClipping[i].IntersectWith(clipping);
+
+		fPainters[i]->AdoptState(painter);
+		fPainters[i]->ConstrainClipping(&fClipping[i]);
+
+		top = bottom + 1;
+	}
+
+	fJob = &job;
+	fBandCount = bandCount;
+	fNextBand = 0;
+
+	int32 helperCount = min_c(fThreadCount, bandCount - 1);
+	release_sem_etc(fStartSemaphore, helperCount, 0);
+
+	_RenderBands();
+
+	while (acquire_sem_etc(fDoneSemaphore, helperCount, 0, 0)
+			== B_INTERRUPTED) {
+	}
+
+	fJob = NULL;
+	fLock.Unlock();
+	return true;
+}
+
+
+/*static*/ ParallelRenderer*
+ParallelRenderer::Default()
+{
+	static pthread_once_t sInitOnce = PTHREAD_ONCE_INIT;
+	pthread_once(&sInitOnce, &_InitDefault);
+	return sDefault;
+}
+
+
+// #pragma mark - private
+
+
+/*static*/ status_t
+ParallelRenderer::_WorkerEntry(void* data)
+{
+	((ParallelRenderer*)data)->_Worker();
+	return B_OK;
+}
+
+
+void
+ParallelRenderer::_Worker()
+{
+	while (true) {
+		status_t status = acquire_sem(fStartSemaphore);
+		if (status == B_INTERRUPTED)
+			continue;
+		if (status != B_OK || fQuitting)
+			break;
+
+		_RenderBands();
+		release_sem_etc(fDoneSemaphore, 1, B_DO_NOT_RESCHEDULE);
+	}
+}
+
+
+void
+ParallelRenderer::_RenderBands()
+{
+	while (true) {
+		int32 band = atomic_add(&fNextBand, 1);
+		if (band >= fBandCount)
+			break;
+
+		fJob->Render(fPainters[band]);
+	}
+}
+
+
+/*static*/ void
+ParallelRenderer::_InitDefault()
+{
+	system_info info;
+	if (get_system_info(&info) != B_OK || info.cpu_count < 2)
+		return;
+
+	ParallelRenderer* renderer
+		= new(std::nothrow) ParallelRenderer(info.cpu_count - 1);
+	if (renderer != NULL && renderer->InitCheck() != B_OK) {
+		delete renderer;
+		renderer = NULL;
+	}
+
+	sDefault = renderer;
+}
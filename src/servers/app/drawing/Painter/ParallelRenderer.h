@@ -0,0 +1,72 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef PARALLEL_RENDERER_H
+#define PARALLEL_RENDERER_H
+
+
+#include <Locker.h>
+#include <OS.h>
+#include <Rect.h>
+#include <Region.h>
+
+
+class Painter;
+
+
+class ParallelRenderer {
+public:
+	class Job {
+	public:
+		virtual					~Job();
+
+		// called once for every band, from any of the worker threads
+		virtual	void			Render(Painter* painter) = 0;
+	};
+
+								ParallelRenderer(int32 threadCount);
+								~ParallelRenderer();
+
+			status_t			InitCheck() const;
+
+			// the number of threads rendering, including the caller
+			int32				CountThreads() const
+									{ return fThreadCount + 1; }
+
+			bool				Render(const Painter& painter,
+									const BRect& area, Job& job);
+
+	static	ParallelRenderer*	Default();
+
+private:
+			enum {
+				kMaxBands		= 16
+			};
+
+	static	status_t			_WorkerEntry(void* data);
+			void				_Worker();
+			void				_RenderBands();
+
+	static	void				_InitDefault();
+
+private:
+			BLocker				fLock;
+			thread_id*			fThreads;
+			int32				fThreadCount;
+			sem_id				fStartSemaphore;
+			sem_id				fDoneSemaphore;
+			bool				fQuitting;
+
+			Job*				fJob;
+			int32				fBandCount;
+			int32				fNextBand;
+
+			Painter*			fPainters[kMaxBands];
+			BRegion				fClipping[kMaxBands];
+
+	static	ParallelRenderer*	sDefault;
+};
+
+
+#endif	// PARALLEL_RENDERER_H
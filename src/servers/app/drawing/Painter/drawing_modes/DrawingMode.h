@@ -14,6 +14,7 @@
 
 #include "PatternHandler.h"
 #include "PixelFormat.h"
+#include "SpanBlend.h"
 
 class PatternHandler;
 
@@ -122,19 +122,7 @@ blend_color_hspan_alpha_po(int x, int y, unsigned len,
 	uint8* p = buffer->row_ptr(y) + (x << 2);
 	if (covers) {
 		// non-solid opacity
-		do {
-			uint16 alpha = colors->a * *covers;
-			if (alpha) {
-				if (alpha == 255 * 255) {
-					ASSIGN_ALPHA_PO(p, colors->r, colors->g, colors->b);
-				} else {
-					BLEND_ALPHA_PO(p, colors->r, colors->g, colors->b, alpha);
-				}
-			}
-			covers++;
-			p += 4;
-			++colors;
-		} while(--len);
+		gSpanBlenders.color_alpha(p, len, colors, covers);
 	} else {
 		// solid full opcacity
 		uint16 alpha = colors->a * cover;
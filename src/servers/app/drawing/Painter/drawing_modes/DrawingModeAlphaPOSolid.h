@@ -68,20 +68,8 @@ blend_solid_hspan_alpha_po_solid(int x, int y, unsigned len,
 								 const color_type& c, const uint8* covers,
 						 		 agg_buffer* buffer, const PatternHandler* pattern)
 {
-	uint8* p = buffer->row_ptr(y) + (x << 2);
-	do {
-		uint16 alpha = c.a * *covers;
-		if (alpha) {
-			if(alpha == 255 * 255) {
-				ASSIGN_ALPHA_PO(p, c.r, c.g, c.b);
-			} else {
-				BLEND_ALPHA_PO(p, c.r, c.g, c.b, alpha);
-			}
-		}
-		covers++;
-		p += 4;
-		x++;
-	} while(--len);
+	gSpanBlenders.solid_alpha(buffer->row_ptr(y) + (x << 2), len, c, c.a,
+		covers);
 }
 
 
@@ -60,19 +60,7 @@ blend_solid_hspan_copy_solid(int x, int y, unsigned len,
 							 agg_buffer* buffer,
 							 const PatternHandler* pattern)
 {
-	uint8* p = buffer->row_ptr(y) + (x << 2);
-	do {
-		if (*covers) {
-			if (*covers == 255) {
-				ASSIGN_OVER(p, c.r, c.g, c.b);
-			} else {
-				BLEND_OVER(p, c.r, c.g, c.b, *covers);
-			}
-		}
-		covers++;
-		p += 4;
-		x++;
-	} while(--len);
+	gSpanBlenders.solid(buffer->row_ptr(y) + (x << 2), len, c, covers);
 }
 
 
@@ -111,18 +99,7 @@ blend_color_hspan_copy_solid(int x, int y, unsigned len,
 	uint8* p = buffer->row_ptr(y) + (x << 2);
 	if (covers) {
 		// non-solid opacity
-		do {
-				if (*covers) {
-				if (*covers == 255) {
-					ASSIGN_OVER(p, colors->r, colors->g, colors->b);
-				} else {
-					BLEND_OVER(p, colors->r, colors->g, colors->b, *covers);
-				}
-			}
-			covers++;
-			p += 4;
-			++colors;
-		} while(--len);
+		gSpanBlenders.color(p, len, colors, covers);
 	} else {
 		// solid full opcacity
 		if (cover == 255) {
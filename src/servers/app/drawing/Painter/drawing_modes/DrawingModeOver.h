@@ -137,18 +137,7 @@ blend_color_hspan_over(int x, int y, unsigned len,
 	uint8* p = buffer->row_ptr(y) + (x << 2);
 	if (covers) {
 		// non-solid opacity
-		do {
-			if (*covers && colors->a > 0) {
-				if (*covers == 255) {
-					ASSIGN_OVER(p, colors->r, colors->g, colors->b);
-				} else {
-					BLEND_OVER(p, colors->r, colors->g, colors->b, *covers);
-				}
-			}
-			covers++;
-			p += 4;
-			++colors;
-		} while(--len);
+		gSpanBlenders.color_over(p, len, colors, covers);
 	} else {
 		// solid full opcacity
 		if (cover == 255) {
@@ -0,0 +1,135 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ *
+ * Portable span blenders, see SpanBlend.h.
+ *
+ */
+
+#include "SpanBlend.h"
+
+#include "DrawingMode.h"
+
+
+void
+blend_solid_span_portable(uint8* p, unsigned len, const agg::rgba8& c,
+	const uint8* covers)
+{
+	while (len-- > 0) {
+		if (*covers) {
+			if (*covers == 255) {
+				p[0] = c.b;
+				p[1] = c.g;
+				p[2] = c.r;
+				p[3] = 255;
+			} else
+				BLEND(p, c.r, c.g, c.b, *covers);
+		}
+		covers++;
+		p += 4;
+	}
+}
+
+
+void
+blend_solid_alpha_span_portable(uint8* p, unsigned len, const agg::rgba8& c,
+	uint8 alpha, const uint8* covers)
+{
+	while (len-- > 0) {
+		uint16 a = alpha * *covers;
+		if (a) {
+			if (a == 255 * 255) {
+				p[0] = c.b;
+				p[1] = c.g;
+				p[2] = c.r;
+				p[3] = 255;
+			} else
+				BLEND16(p, c.r, c.g, c.b, a);
+		}
+		covers++;
+		p += 4;
+	}
+}
+
+
+void
+blend_color_span_portable(uint8* p, unsigned len, const agg::rgba8* colors,
+	const uint8* covers)
+{
+	while (len-- > 0) {
+		if (*covers) {
+			if (*covers == 255) {
+				p[0] = colors->b;
+				p[1] = colors->g;
+				p[2] = colors->r;
+				p[3] = 255;
+			} else
+				BLEND(p, colors->r, colors->g, colors->b, *covers);
+		}
+		covers++;
+		colors++;
+		p += 4;
+	}
+}
+
+
+void
+blend_color_over_span_portable(uint8* p, unsigned len,
+	const agg::rgba8* colors, const uint8* covers)
+{
+	while (len-- > 0) {
+		if (*covers && colors->a > 0) {
+			if (*covers == 255) {
+				p[0] = colors->b;
+				p[1] = colors->g;
+				p[2] = colors->r;
+				p[3] = 255;
+			} else
+				BLEND(p, colors->r, colors->g, colors->b, *covers);
+		}
+		covers++;
+		colors++;
+		p += 4;
+	}
+}
+
+
+void
+blend_color_alpha_span_portable(uint8* p, unsigned len,
+	const agg::rgba8* colors, const uint8* covers)
+{
+	while (len-- > 0) {
+		uint16 a = colors->a * *covers;
+		if (a) {
+			if (a == 255 * 255) {
+				p[0] = colors->b;
+				p[1] = colors->g;
+				p[2] = colors->r;
+				p[3] = 255;
+			} else
+				BLEND16(p, colors->r, colors->g, colors->b, a);
+		}
+		covers++;
+		colors++;
+		p += 4;
+	}
+}
+
+
+const span_blenders kPortableSpanBlenders = {
+	"portable",
+	blend_solid_span_portable,
+	blend_solid_alpha_span_portable,
+	blend_color_span_portable,
+	blend_color_over_span_portable,
+	blend_color_alpha_span_portable
+};
+
+span_blenders gSpanBlenders = {
+	"portable",
+	blend_solid_span_portable,
+	blend_solid_alpha_span_portable,
+	blend_color_span_portable,
+	blend_color_over_span_portable,
+	blend_color_alpha_span_portable
+};
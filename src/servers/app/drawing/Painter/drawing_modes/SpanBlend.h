@@ -0,0 +1,89 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ *
+ * Span blenders for the most frequently used drawing modes on B_RGBA32.
+ * Besides the portable implementation, there are versions using the SIMD
+ * instructions of the CPU (SSE2, AVX2, NEON), which are chosen at run time.
+ * All of them produce exactly the same pixels as the BLEND and BLEND16
+ * macros in DrawingMode.h.
+ *
+ */
+
+#ifndef SPAN_BLEND_H
+#define SPAN_BLEND_H
+
+#include <agg_color_rgba.h>
+
+#include <SupportDefs.h>
+
+
+#if (defined(__i386__) || defined(__x86_64__)) && __GNUC__ >= 4
+#	define SPAN_BLEND_X86_SIMD 1
+#endif
+#if defined(__aarch64__)
+#	define SPAN_BLEND_NEON 1
+#endif
+
+
+// Blends the solid color \a c into the \a len pixels at \a p, using the
+// coverage values as alpha (as BLEND does). Pixels with full coverage are
+// assigned, pixels without any coverage are left alone.
+typedef void (*blend_solid_span_func)(uint8* p, unsigned len,
+	const agg::rgba8& c, const uint8* covers);
+
+// Like blend_solid_span_func, but uses \a alpha times the coverage as
+// alpha (as BLEND16 does).
+typedef void (*blend_solid_alpha_span_func)(uint8* p, unsigned len,
+	const agg::rgba8& c, uint8 alpha, const uint8* covers);
+
+// Blends the \a colors into the \a len pixels at \a p, using the coverage
+// values as alpha (as BLEND does), or the alpha of each color times its
+// coverage (as BLEND16 does) for the "alpha" variant.
+typedef void (*blend_color_span_func)(uint8* p, unsigned len,
+	const agg::rgba8* colors, const uint8* covers);
+
+struct span_blenders {
+	const char*					name;
+
+	// B_OP_COPY and B_OP_OVER with a solid pattern
+	blend_solid_span_func		solid;
+	// B_OP_ALPHA with a solid pattern
+	blend_solid_alpha_span_func	solid_alpha;
+
+	// B_OP_COPY, B_OP_OVER (skips transparent colors), and B_OP_ALPHA
+	blend_color_span_func		color;
+	blend_color_span_func		color_over;
+	blend_color_span_func		color_alpha;
+};
+
+
+// the blenders in use, chosen by Painter depending on the CPU
+extern span_blenders gSpanBlenders;
+
+extern const span_blenders kPortableSpanBlenders;
+#ifdef SPAN_BLEND_X86_SIMD
+extern const span_blenders kSSE2SpanBlenders;
+extern const span_blenders kAVX2SpanBlenders;
+#endif
+#ifdef SPAN_BLEND_NEON
+extern const span_blenders kNEONSpanBlenders;
+#endif
+
+
+// portable implementations, also used for the remainder of a span by the
+// SIMD implementations
+
+void blend_solid_span_portable(uint8* p, unsigned len, const agg::rgba8& c,
+	const uint8* covers);
+void blend_solid_alpha_span_portable(uint8* p, unsigned len,
+	const agg::rgba8& c, uint8 alpha, const uint8* covers);
+void blend_color_span_portable(uint8* p, unsigned len,
+	const agg::rgba8* colors, const uint8* covers);
+void blend_color_over_span_portable(uint8* p, unsigned len,
+	const agg::rgba8* colors, const uint8* covers);
+void blend_color_alpha_span_portable(uint8* p, unsigned len,
+	const agg::rgba8* colors, const uint8* covers);
+
+
+#endif // SPAN_BLEND_H
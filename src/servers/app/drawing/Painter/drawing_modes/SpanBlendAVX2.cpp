@@ -0,0 +1,163 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ *
+ * Span blenders using AVX2, working on eight pixels at a time. This file is
+ * compiled with -mavx2, and must only be used when the CPU supports it.
+ *
+ */
+
+#include "SpanBlendSIMD.h"
+
+#include <immintrin.h>
+
+
+struct AVX2Vector {
+	typedef __m256i type;
+
+	enum {
+		kPixels = 8
+	};
+
+	static inline __m256i
+	Load(const uint8* p)
+	{
+		return _mm256_loadu_si256((const __m256i*)p);
+	}
+
+	static inline void
+	Store(uint8* p, __m256i pixels)
+	{
+		_mm256_storeu_si256((__m256i*)p, pixels);
+	}
+
+	static inline __m256i
+	LoadCovers(const uint8* covers)
+	{
+		return _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)covers));
+	}
+
+	static inline __m256i
+	LoadColors(const agg::rgba8* colors)
+	{
+		// swap red and blue
+		const __m256i kShuffle = _mm256_setr_epi8(
+			2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+			2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+		return _mm256_shuffle_epi8(
+			_mm256_loadu_si256((const __m256i*)colors), kShuffle);
+	}
+
+	static inline __m256i
+	ColorAlpha(__m256i pixels)
+	{
+		return _mm256_srli_epi32(pixels, 24);
+	}
+
+	static inline __m256i
+	Set32(uint32 value)
+	{
+		return _mm256_set1_epi32((int)value);
+	}
+
+	static inline __m256i
+	Multiply32(__m256i a, __m256i b)
+	{
+		// the upper 16 bits of each lane are zero
+		return _mm256_mullo_epi16(a, b);
+	}
+
+	static inline __m256i
+	Equal32(__m256i a, __m256i b)
+	{
+		return _mm256_cmpeq_epi32(a, b);
+	}
+
+	static inline __m256i
+	Or(__m256i a, __m256i b)
+	{
+		return _mm256_or_si256(a, b);
+	}
+
+	static inline __m256i
+	Select(__m256i mask, __m256i a, __m256i b)
+	{
+		return _mm256_blendv_epi8(b, a, mask);
+	}
+
+	static inline bool
+	All(__m256i mask)
+	{
+		return _mm256_movemask_epi8(mask) == -1;
+	}
+
+	static inline __m256i
+	Blend(__m256i source, __m256i dest, __m256i alpha)
+	{
+		// the unpack and pack instructions work within each 128 bit lane,
+		// and so does _ExpandAlpha(), so the pixels stay in order
+		__m256i zero = _mm256_setzero_si256();
+		__m256i alphaLow, alphaHigh;
+		_ExpandAlpha(alpha, alphaLow, alphaHigh);
+
+		__m256i low = _Blend(_mm256_unpacklo_epi8(source, zero),
+			_mm256_unpacklo_epi8(dest, zero), alphaLow);
+		__m256i high = _Blend(_mm256_unpackhi_epi8(source, zero),
+			_mm256_unpackhi_epi8(dest, zero), alphaHigh);
+		return _mm256_packus_epi16(low, high);
+	}
+
+	static inline __m256i
+	Blend16(__m256i source, __m256i dest, __m256i alpha)
+	{
+		__m256i zero = _mm256_setzero_si256();
+		__m256i alphaLow, alphaHigh;
+		_ExpandAlpha(alpha, alphaLow, alphaHigh);
+
+		__m256i low = _Blend16(_mm256_unpacklo_epi8(source, zero),
+			_mm256_unpacklo_epi8(dest, zero), alphaLow);
+		__m256i high = _Blend16(_mm256_unpackhi_epi8(source, zero),
+			_mm256_unpackhi_epi8(dest, zero), alphaHigh);
+		return _mm256_packus_epi16(low, high);
+	}
+
+private:
+	static inline void
+	_ExpandAlpha(__m256i alpha, __m256i& low, __m256i& high)
+	{
+		__m256i pairs = _mm256_or_si256(alpha, _mm256_slli_epi32(alpha, 16));
+		low = _mm256_unpacklo_epi32(pairs, pairs);
+		high = _mm256_unpackhi_epi32(pairs, pairs);
+	}
+
+	static inline __m256i
+	_Blend(__m256i source, __m256i dest, __m256i alpha)
+	{
+		// see SSE2Vector::_Blend()
+		__m256i inverse = _mm256_sub_epi16(_mm256_set1_epi16(256), alpha);
+		return _mm256_srli_epi16(_mm256_add_epi16(
+			_mm256_mullo_epi16(source, alpha),
+			_mm256_mullo_epi16(dest, inverse)), 8);
+	}
+
+	static inline __m256i
+	_Blend16(__m256i source, __m256i dest, __m256i alpha)
+	{
+		// see SSE2Vector::_Blend16(); AVX2 has an unsigned maximum, though
+		__m256i inverse = _mm256_sub_epi16(_mm256_setzero_si256(), alpha);
+		__m256i sourceLow = _mm256_mullo_epi16(source, alpha);
+		__m256i sourceHigh = _mm256_mulhi_epu16(source, alpha);
+		__m256i destLow = _mm256_mullo_epi16(dest, inverse);
+		__m256i destHigh = _mm256_mulhi_epu16(dest, inverse);
+
+		__m256i low = _mm256_add_epi16(sourceLow, destLow);
+		__m256i noCarry = _mm256_cmpeq_epi16(
+			_mm256_max_epu16(low, sourceLow), low);
+
+		return _mm256_add_epi16(_mm256_add_epi16(sourceHigh, destHigh),
+			_mm256_andnot_si256(noCarry, _mm256_set1_epi16(1)));
+	}
+};
+
+
+const span_blenders kAVX2SpanBlenders = SPAN_BLENDERS_FOR("AVX2", AVX2Vector);
@@ -0,0 +1,176 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ *
+ * Span blenders using NEON (AArch64), working on four pixels at a time.
+ *
+ */
+
+#include "SpanBlendSIMD.h"
+
+#include <string.h>
+
+#include <arm_neon.h>
+
+
+struct NEONVector {
+	typedef uint32x4_t type;
+
+	enum {
+		kPixels = 4
+	};
+
+	static inline uint32x4_t
+	Load(const uint8* p)
+	{
+		return vreinterpretq_u32_u8(vld1q_u8(p));
+	}
+
+	static inline void
+	Store(uint8* p, uint32x4_t pixels)
+	{
+		vst1q_u8(p, vreinterpretq_u8_u32(pixels));
+	}
+
+	static inline uint32x4_t
+	LoadCovers(const uint8* covers)
+	{
+		uint32 value;
+		memcpy(&value, covers, sizeof(value));
+
+		uint16x8_t words = vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(value)));
+		return vmovl_u16(vget_low_u16(words));
+	}
+
+	static inline uint32x4_t
+	LoadColors(const agg::rgba8* colors)
+	{
+		// swap red and blue
+		static const uint8 kShuffle[16] = {
+			2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15
+		};
+		return vreinterpretq_u32_u8(vqtbl1q_u8(vld1q_u8((const uint8*)colors),
+			vld1q_u8(kShuffle)));
+	}
+
+	static inline uint32x4_t
+	ColorAlpha(uint32x4_t pixels)
+	{
+		return vshrq_n_u32(pixels, 24);
+	}
+
+	static inline uint32x4_t
+	Set32(uint32 value)
+	{
+		return vdupq_n_u32(value);
+	}
+
+	static inline uint32x4_t
+	Multiply32(uint32x4_t a, uint32x4_t b)
+	{
+		return vmulq_u32(a, b);
+	}
+
+	static inline uint32x4_t
+	Equal32(uint32x4_t a, uint32x4_t b)
+	{
+		return vceqq_u32(a, b);
+	}
+
+	static inline uint32x4_t
+	Or(uint32x4_t a, uint32x4_t b)
+	{
+		return vorrq_u32(a, b);
+	}
+
+	static inline uint32x4_t
+	Select(uint32x4_t mask, uint32x4_t a, uint32x4_t b)
+	{
+		return vbslq_u32(mask, a, b);
+	}
+
+	static inline bool
+	All(uint32x4_t mask)
+	{
+		return vminvq_u32(mask) == 0xffffffff;
+	}
+
+	static inline uint32x4_t
+	Blend(uint32x4_t source, uint32x4_t dest, uint32x4_t alpha)
+	{
+		// BLEND: (s * a + d * (256 - a)) >> 8, computed as
+		// s * a - d * a + (d << 8), which may wrap in between, but not in
+		// the end. The alpha is replicated into every byte of its pixel.
+		uint8x16_t a = vreinterpretq_u8_u32(vmulq_n_u32(alpha, 0x01010101));
+		uint8x16_t s = vreinterpretq_u8_u32(source);
+		uint8x16_t d = vreinterpretq_u8_u32(dest);
+
+		uint16x8_t low = vmull_u8(vget_low_u8(s), vget_low_u8(a));
+		low = vmlsl_u8(low, vget_low_u8(d), vget_low_u8(a));
+		low = vaddq_u16(low, vshll_n_u8(vget_low_u8(d), 8));
+
+		uint16x8_t high = vmull_high_u8(s, a);
+		high = vmlsl_high_u8(high, d, a);
+		high = vaddq_u16(high, vshll_high_n_u8(d, 8));
+
+		return vreinterpretq_u32_u8(vcombine_u8(vshrn_n_u16(low, 8),
+			vshrn_n_u16(high, 8)));
+	}
+
+	static inline uint32x4_t
+	Blend16(uint32x4_t source, uint32x4_t dest, uint32x4_t alpha)
+	{
+		// BLEND16: (s * a + d * (65536 - a)) >> 16 in 32 bits. As in the
+		// SSE2 version, (65536 - a) overflows for a == 0, which is never
+		// blended, though. The alpha is replicated into every 16 bit
+		// channel of its pixel.
+		static const uint8 kSpreadLow[16] = {
+			0, 1, 0, 1, 0, 1, 0, 1, 4, 5, 4, 5, 4, 5, 4, 5
+		};
+		static const uint8 kSpreadHigh[16] = {
+			8, 9, 8, 9, 8, 9, 8, 9, 12, 13, 12, 13, 12, 13, 12, 13
+		};
+		uint8x16_t alphaBytes = vreinterpretq_u8_u32(alpha);
+		uint16x8_t alphaLow = vreinterpretq_u16_u8(vqtbl1q_u8(alphaBytes,
+			vld1q_u8(kSpreadLow)));
+		uint16x8_t alphaHigh = vreinterpretq_u16_u8(vqtbl1q_u8(alphaBytes,
+			vld1q_u8(kSpreadHigh)));
+
+		uint8x16_t s = vreinterpretq_u8_u32(source);
+		uint8x16_t d = vreinterpretq_u8_u32(dest);
+
+		uint16x8_t low = vcombine_u16(
+			_Blend16(vmovl_u8(vget_low_u8(s)), vmovl_u8(vget_low_u8(d)),
+				alphaLow, false),
+			_Blend16(vmovl_u8(vget_low_u8(s)), vmovl_u8(vget_low_u8(d)),
+				alphaLow, true));
+		uint16x8_t high = vcombine_u16(
+			_Blend16(vmovl_high_u8(s), vmovl_high_u8(d), alphaHigh, false),
+			_Blend16(vmovl_high_u8(s), vmovl_high_u8(d), alphaHigh, true));
+
+		return vreinterpretq_u32_u8(vcombine_u8(vmovn_u16(low),
+			vmovn_u16(high)));
+	}
+
+private:
+	//!	Blends either the first or the second pixel of the given two.
+	static inline uint16x4_t
+	_Blend16(uint16x8_t source, uint16x8_t dest, uint16x8_t alpha,
+		bool second)
+	{
+		uint16x8_t inverse = vsubq_u16(vdupq_n_u16(0), alpha);
+		uint32x4_t result;
+		if (second) {
+			result = vmull_high_u16(source, alpha);
+			result = vmlal_high_u16(result, dest, inverse);
+		} else {
+			result = vmull_u16(vget_low_u16(source), vget_low_u16(alpha));
+			result = vmlal_u16(result, vget_low_u16(dest),
+				vget_low_u16(inverse));
+		}
+		return vshrn_n_u32(result, 16);
+	}
+};
+
+
+const span_blenders kNEONSpanBlenders = SPAN_BLENDERS_FOR("NEON", NEONVector);
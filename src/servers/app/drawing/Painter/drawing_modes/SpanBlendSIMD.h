@@ -0,0 +1,202 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ *
+ * The span blenders of SpanBlend.h, written in terms of a vector of pixels.
+ * Every SIMD implementation provides such a vector class, and instantiates
+ * the template with it.
+ *
+ * The vector class works on Vector::kPixels B_RGBA32 pixels at a time, and
+ * needs to provide the following static functions:
+ *   Load(), Store()		unaligned access to the pixels
+ *   LoadCovers()		the coverage values, one 32 bit lane per pixel
+ *   LoadColors()		agg::rgba8 colors, converted to B_RGBA32
+ *   ColorAlpha()		the alpha channel, one 32 bit lane per pixel
+ *   Set32()				the same 32 bit value in every lane
+ *   Multiply32()		multiplies two 32 bit lanes holding values < 256
+ *   Equal32(), Or(), Select(), All()
+ *   Blend(), Blend16()	the pixels as computed by BLEND and BLEND16, with
+ *						the alpha given in one 32 bit lane per pixel
+ *
+ */
+
+#ifndef SPAN_BLEND_SIMD_H
+#define SPAN_BLEND_SIMD_H
+
+#include "SpanBlend.h"
+
+
+template<typename Vector>
+class SpanBlendSIMD {
+public:
+	typedef typename Vector::type vector;
+
+	static void
+	BlendSolidSpan(uint8* p, unsigned len, const agg::rgba8& c,
+		const uint8* covers)
+	{
+		vector source = _SolidSource(c);
+		vector zero = Vector::Set32(0);
+		vector full = Vector::Set32(255);
+
+		for (; len >= Vector::kPixels; len -= Vector::kPixels) {
+			vector alpha = Vector::LoadCovers(covers);
+			_BlendPixels<false>(p, source, alpha, Vector::Equal32(alpha, zero),
+				Vector::Equal32(alpha, full));
+
+			p += 4 * Vector::kPixels;
+			covers += Vector::kPixels;
+		}
+
+		if (len > 0)
+			blend_solid_span_portable(p, len, c, covers);
+	}
+
+	static void
+	BlendSolidAlphaSpan(uint8* p, unsigned len, const agg::rgba8& c,
+		uint8 alpha, const uint8* covers)
+	{
+		vector source = _SolidSource(c);
+		vector sourceAlpha = Vector::Set32(alpha);
+		vector zero = Vector::Set32(0);
+		vector full = Vector::Set32(255 * 255);
+
+		for (; len >= Vector::kPixels; len -= Vector::kPixels) {
+			vector pixelAlpha = Vector::Multiply32(sourceAlpha,
+				Vector::LoadCovers(covers));
+			_BlendPixels<true>(p, source, pixelAlpha,
+				Vector::Equal32(pixelAlpha, zero),
+				Vector::Equal32(pixelAlpha, full));
+
+			p += 4 * Vector::kPixels;
+			covers += Vector::kPixels;
+		}
+
+		if (len > 0)
+			blend_solid_alpha_span_portable(p, len, c, alpha, covers);
+	}
+
+	static void
+	BlendColorSpan(uint8* p, unsigned len, const agg::rgba8* colors,
+		const uint8* covers)
+	{
+		vector opaque = Vector::Set32(0xff000000);
+		vector zero = Vector::Set32(0);
+		vector full = Vector::Set32(255);
+
+		for (; len >= Vector::kPixels; len -= Vector::kPixels) {
+			vector source = Vector::Or(Vector::LoadColors(colors), opaque);
+			vector alpha = Vector::LoadCovers(covers);
+			_BlendPixels<false>(p, source, alpha, Vector::Equal32(alpha, zero),
+				Vector::Equal32(alpha, full));
+
+			p += 4 * Vector::kPixels;
+			colors += Vector::kPixels;
+			covers += Vector::kPixels;
+		}
+
+		if (len > 0)
+			blend_color_span_portable(p, len, colors, covers);
+	}
+
+	static void
+	BlendColorOverSpan(uint8* p, unsigned len, const agg::rgba8* colors,
+		const uint8* covers)
+	{
+		vector opaque = Vector::Set32(0xff000000);
+		vector zero = Vector::Set32(0);
+		vector full = Vector::Set32(255);
+
+		for (; len >= Vector::kPixels; len -= Vector::kPixels) {
+			vector source = Vector::LoadColors(colors);
+			vector alpha = Vector::LoadCovers(covers);
+
+			// transparent colors are not drawn at all
+			alpha = Vector::Select(
+				Vector::Equal32(Vector::ColorAlpha(source), zero), zero, alpha);
+			_BlendPixels<false>(p, Vector::Or(source, opaque), alpha,
+				Vector::Equal32(alpha, zero), Vector::Equal32(alpha, full));
+
+			p += 4 * Vector::kPixels;
+			colors += Vector::kPixels;
+			covers += Vector::kPixels;
+		}
+
+		if (len > 0)
+			blend_color_over_span_portable(p, len, colors, covers);
+	}
+
+	static void
+	BlendColorAlphaSpan(uint8* p, unsigned len, const agg::rgba8* colors,
+		const uint8* covers)
+	{
+		vector opaque = Vector::Set32(0xff000000);
+		vector zero = Vector::Set32(0);
+		vector full = Vector::Set32(255 * 255);
+
+		for (; len >= Vector::kPixels; len -= Vector::kPixels) {
+			vector source = Vector::LoadColors(colors);
+			vector alpha = Vector::Multiply32(Vector::ColorAlpha(source),
+				Vector::LoadCovers(covers));
+			_BlendPixels<true>(p, Vector::Or(source, opaque), alpha,
+				Vector::Equal32(alpha, zero), Vector::Equal32(alpha, full));
+
+			p += 4 * Vector::kPixels;
+			colors += Vector::kPixels;
+			covers += Vector::kPixels;
+		}
+
+		if (len > 0)
+			blend_color_alpha_span_portable(p, len, colors, covers);
+	}
+
+private:
+	static inline vector
+	_SolidSource(const agg::rgba8& c)
+	{
+		return Vector::Set32(0xff000000 | (c.r << 16) | (c.g << 8) | c.b);
+	}
+
+	/*!	Blends \a source into the pixels at \a p. The \a source must be
+		opaque already, and is assigned where \a full is set. The pixels
+		where \a none is set are left alone; \a none and \a full must not
+		be set for the same pixel.
+	*/
+	template<bool kAlpha16>
+	static inline void
+	_BlendPixels(uint8* p, vector source, vector alpha, vector none,
+		vector full)
+	{
+		if (Vector::All(none))
+			return;
+
+		if (Vector::All(full)) {
+			Vector::Store(p, source);
+			return;
+		}
+
+		vector dest = Vector::Load(p);
+		vector result = kAlpha16 ? Vector::Blend16(source, dest, alpha)
+			: Vector::Blend(source, dest, alpha);
+
+		result = Vector::Or(result, Vector::Set32(0xff000000));
+		result = Vector::Select(full, source, result);
+		result = Vector::Select(none, dest, result);
+
+		Vector::Store(p, result);
+	}
+};
+
+
+#define SPAN_BLENDERS_FOR(name, vectorClass) \
+	{ \
+		name, \
+		SpanBlendSIMD<vectorClass>::BlendSolidSpan, \
+		SpanBlendSIMD<vectorClass>::BlendSolidAlphaSpan, \
+		SpanBlendSIMD<vectorClass>::BlendColorSpan, \
+		SpanBlendSIMD<vectorClass>::BlendColorOverSpan, \
+		SpanBlendSIMD<vectorClass>::BlendColorAlphaSpan \
+	}
+
+
+#endif // SPAN_BLEND_SIMD_H
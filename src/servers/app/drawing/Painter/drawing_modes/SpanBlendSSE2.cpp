@@ -0,0 +1,174 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ *
+ * Span blenders using SSE2, working on four pixels at a time.
+ *
+ */
+
+#include "SpanBlendSIMD.h"
+
+#include <string.h>
+
+#include <emmintrin.h>
+
+
+struct SSE2Vector {
+	typedef __m128i type;
+
+	enum {
+		kPixels = 4
+	};
+
+	static inline __m128i
+	Load(const uint8* p)
+	{
+		return _mm_loadu_si128((const __m128i*)p);
+	}
+
+	static inline void
+	Store(uint8* p, __m128i pixels)
+	{
+		_mm_storeu_si128((__m128i*)p, pixels);
+	}
+
+	static inline __m128i
+	LoadCovers(const uint8* covers)
+	{
+		uint32 value;
+		memcpy(&value, covers, sizeof(value));
+
+		__m128i zero = _mm_setzero_si128();
+		__m128i words = _mm_unpacklo_epi8(_mm_cvtsi32_si128(value), zero);
+		return _mm_unpacklo_epi16(words, zero);
+	}
+
+	static inline __m128i
+	LoadColors(const agg::rgba8* colors)
+	{
+		// swap red and blue
+		__m128i rgba = _mm_loadu_si128((const __m128i*)colors);
+		__m128i redBlue = _mm_and_si128(rgba, _mm_set1_epi32(0x00ff00ff));
+		__m128i greenAlpha = _mm_andnot_si128(_mm_set1_epi32(0x00ff00ff),
+			rgba);
+		return _mm_or_si128(greenAlpha, _mm_or_si128(
+			_mm_slli_epi32(redBlue, 16), _mm_srli_epi32(redBlue, 16)));
+	}
+
+	static inline __m128i
+	ColorAlpha(__m128i pixels)
+	{
+		return _mm_srli_epi32(pixels, 24);
+	}
+
+	static inline __m128i
+	Set32(uint32 value)
+	{
+		return _mm_set1_epi32((int)value);
+	}
+
+	static inline __m128i
+	Multiply32(__m128i a, __m128i b)
+	{
+		// the upper 16 bits of each lane are zero
+		return _mm_mullo_epi16(a, b);
+	}
+
+	static inline __m128i
+	Equal32(__m128i a, __m128i b)
+	{
+		return _mm_cmpeq_epi32(a, b);
+	}
+
+	static inline __m128i
+	Or(__m128i a, __m128i b)
+	{
+		return _mm_or_si128(a, b);
+	}
+
+	static inline __m128i
+	Select(__m128i mask, __m128i a, __m128i b)
+	{
+		return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+	}
+
+	static inline bool
+	All(__m128i mask)
+	{
+		return _mm_movemask_epi8(mask) == 0xffff;
+	}
+
+	static inline __m128i
+	Blend(__m128i source, __m128i dest, __m128i alpha)
+	{
+		__m128i zero = _mm_setzero_si128();
+		__m128i alphaLow, alphaHigh;
+		_ExpandAlpha(alpha, alphaLow, alphaHigh);
+
+		__m128i low = _Blend(_mm_unpacklo_epi8(source, zero),
+			_mm_unpacklo_epi8(dest, zero), alphaLow);
+		__m128i high = _Blend(_mm_unpackhi_epi8(source, zero),
+			_mm_unpackhi_epi8(dest, zero), alphaHigh);
+		return _mm_packus_epi16(low, high);
+	}
+
+	static inline __m128i
+	Blend16(__m128i source, __m128i dest, __m128i alpha)
+	{
+		__m128i zero = _mm_setzero_si128();
+		__m128i alphaLow, alphaHigh;
+		_ExpandAlpha(alpha, alphaLow, alphaHigh);
+
+		__m128i low = _Blend16(_mm_unpacklo_epi8(source, zero),
+			_mm_unpacklo_epi8(dest, zero), alphaLow);
+		__m128i high = _Blend16(_mm_unpackhi_epi8(source, zero),
+			_mm_unpackhi_epi8(dest, zero), alphaHigh);
+		return _mm_packus_epi16(low, high);
+	}
+
+private:
+	/*!	Spreads the alpha of each pixel to one 16 bit lane per channel, for
+		the first and the last two pixels.
+	*/
+	static inline void
+	_ExpandAlpha(__m128i alpha, __m128i& low, __m128i& high)
+	{
+		__m128i pairs = _mm_or_si128(alpha, _mm_slli_epi32(alpha, 16));
+		low = _mm_unpacklo_epi32(pairs, pairs);
+		high = _mm_unpackhi_epi32(pairs, pairs);
+	}
+
+	static inline __m128i
+	_Blend(__m128i source, __m128i dest, __m128i alpha)
+	{
+		// BLEND: (s * a + d * (256 - a)) >> 8, which fits into 16 bits
+		__m128i inverse = _mm_sub_epi16(_mm_set1_epi16(256), alpha);
+		return _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(source, alpha),
+			_mm_mullo_epi16(dest, inverse)), 8);
+	}
+
+	static inline __m128i
+	_Blend16(__m128i source, __m128i dest, __m128i alpha)
+	{
+		// BLEND16: (s * a + d * (65536 - a)) >> 16. The products are split
+		// into their upper and lower 16 bits, and the carry of the lower
+		// halves is added separately. (65536 - a) does not fit into 16 bits
+		// for a == 0, but those pixels are never blended.
+		__m128i inverse = _mm_sub_epi16(_mm_setzero_si128(), alpha);
+		__m128i sourceLow = _mm_mullo_epi16(source, alpha);
+		__m128i sourceHigh = _mm_mulhi_epu16(source, alpha);
+		__m128i destLow = _mm_mullo_epi16(dest, inverse);
+		__m128i destHigh = _mm_mulhi_epu16(dest, inverse);
+
+		// there is no unsigned compare, so we need to flip the sign bits
+		__m128i sign = _mm_set1_epi16((short)0x8000);
+		__m128i low = _mm_add_epi16(sourceLow, destLow);
+		__m128i carry = _mm_cmplt_epi16(_mm_xor_si128(low, sign),
+			_mm_xor_si128(sourceLow, sign));
+
+		return _mm_sub_epi16(_mm_add_epi16(sourceHigh, destHigh), carry);
+	}
+};
+
+
+const span_blenders kSSE2SpanBlenders = SPAN_BLENDERS_FOR("SSE2", SSE2Vector);
@@ -8,6 +8,8 @@
 #include <stdio.h>
 #include <string.h>
 
+#include <Autolock.h>
+
 
 //#define TRACE_UPDATE_QUEUE
 #ifdef TRACE_UPDATE_QUEUE
@@ -26,6 +28,19 @@
 #endif
 
 
+static const float kDefaultRefreshRate = 60.0f;
+static const bigtime_t kMaxHoldTime = 100000;
+	// a region is not held back longer than that, in case its owner never
+	// finishes drawing it
+
+
+struct UpdateQueue::HeldRegion {
+	const void*	owner;
+	BRegion		region;
+	bigtime_t	since;
+};
+
+
 // constructor
 UpdateQueue::UpdateQueue(HWInterface* interface)
 	:
@@ -33,13 +48,21 @@ UpdateQueue::UpdateQueue(HWInterface* interface)
 	fQuitting(false),
  	fInterface(interface),
 	fUpdateRegion(),
+	fPendingSince(-1),
+	fHeldRegions(),
 	fUpdateExecutor(B_BAD_THREAD_ID),
+	fPendingSem(B_BAD_SEM_ID),
 	fRetraceSem(B_BAD_SEM_ID),
-	fRefreshDuration(1000000 / 60)
+	fRefreshRate(kDefaultRefreshRate),
+	fRefreshDuration((bigtime_t)(1000000 / kDefaultRefreshRate)),
+	fNextRetrace(0)
 {
 	CALLED();
 	TRACE("this: %p\n", this);
 	TRACE("fInterface: %p\n", fInterface);
+
+	memset(&fStatistics, 0, sizeof(fStatistics));
+	fStatistics.refresh_rate = fRefreshRate;
 }
 
 // destructor
@@ -48,6 +71,9 @@ UpdateQueue::~UpdateQueue()
 	CALLED();
 
 	Shutdown();
+
+	for (int32 i = 0; i < fHeldRegions.CountItems(); i++)
+		delete (HeldRegion*)fHeldRegions.ItemAtFast(i);
 }
 
 // FrameBufferChanged
@@ -56,29 +82,46 @@ UpdateQueue::FrameBufferChanged()
 {
 	CALLED();
 
+	// whatever was pending belongs to the old frame buffer, and will be
+	// redrawn completely anyway
+	if (Lock()) {
+		fUpdateRegion.MakeEmpty();
+		fPendingSince = -1;
+		Unlock();
+	}
+
 	Init();
 }
 
-// Init
+/*!	Starts the thread that transfers the invalidated regions, unless it is
+	already running, and adopts the refresh rate and retrace semaphore of the
+	current mode.
+	This is called with the HWInterface write locked during a mode change, so
+	it must not wait for the thread, which might wait for the HWInterface.
+*/
 status_t
 UpdateQueue::Init()
 {
 	CALLED();
 
-	Shutdown();
+	_UpdateRefreshRate();
 
-	fRetraceSem = fInterface->RetraceSemaphore();
-//	fRefreshDuration = fInterface->...
+	if (fUpdateExecutor >= B_OK)
+		return B_OK;
 
-	TRACE("fRetraceSem: %ld, fRefreshDuration: %lld\n",
-		fRetraceSem, fRefreshDuration);
+	fPendingSem = create_sem(0, "update queue pending");
+	if (fPendingSem < B_OK)
+		return fPendingSem;
 
 	fQuitting = false;
 	fUpdateExecutor = spawn_thread(_ExecuteUpdatesEntry, "update queue runner",
 		B_REAL_TIME_PRIORITY, this);
-	if (fUpdateExecutor < B_OK)
+	if (fUpdateExecutor < B_OK) {
+		delete_sem(fPendingSem);
+		fPendingSem = B_BAD_SEM_ID;
 		return fUpdateExecutor;
-		
+	}
+
 	return resume_thread(fUpdateExecutor);
 }
 
@@ -91,26 +134,100 @@ UpdateQueue::Shutdown()
 	if (fUpdateExecutor < B_OK)
 		return;
 	fQuitting = true;
+	release_sem(fPendingSem);
 	status_t exitValue;
 	wait_for_thread(fUpdateExecutor, &exitValue);
 	fUpdateExecutor = B_BAD_THREAD_ID;
+
+	delete_sem(fPendingSem);
+	fPendingSem = B_BAD_SEM_ID;
 }
 
-// AddRect
-void
+/*!	Adds the rect to the region that is transferred with the next retrace.
+	Returns an error when the queue is not running, in which case the caller
+	has to transfer the rect itself.
+*/
+status_t
 UpdateQueue::AddRect(const BRect& rect)
 {
 	if (!rect.IsValid())
-		return;
+		return B_OK;
 
 	CALLED();
 
-	if (Lock()) {
-		fUpdateRegion.Include(rect);
-		Unlock();
+	if (fUpdateExecutor < B_OK)
+		return B_NO_INIT;
+
+	if (!Lock())
+		return B_ERROR;
+
+	fUpdateRegion.Include(rect);
+	if (fPendingSince < 0) {
+		fPendingSince = system_time();
+		release_sem_etc(fPendingSem, 1, B_DO_NOT_RESCHEDULE);
+	}
+
+	Unlock();
+	return B_OK;
+}
+
+/*!	Keeps the region from being transferred until Release() is called for the
+	same \a owner, or kMaxHoldTime passed. Holding again replaces the region
+	held before.
+*/
+void
+UpdateQueue::Hold(const void* owner, const BRegion& region)
+{
+	BAutolock _(this);
+
+	HeldRegion* held = NULL;
+	for (int32 i = 0; i < fHeldRegions.CountItems(); i++) {
+		HeldRegion* item = (HeldRegion*)fHeldRegions.ItemAtFast(i);
+		if (item->owner == owner) {
+			held = item;
+			break;
+		}
+	}
+
+	if (held == NULL) {
+		held = new(std::nothrow) HeldRegion;
+		if (held == NULL)
+			return;
+		if (!fHeldRegions.AddItem(held)) {
+			delete held;
+			return;
+		}
+		held->owner = owner;
+	}
+
+	held->region = region;
+	held->since = system_time();
+}
+
+// Release
+void
+UpdateQueue::Release(const void* owner)
+{
+	BAutolock _(this);
+
+	for (int32 i = 0; i < fHeldRegions.CountItems(); i++) {
+		HeldRegion* held = (HeldRegion*)fHeldRegions.ItemAtFast(i);
+		if (held->owner == owner) {
+			fHeldRegions.RemoveItem(i);
+			delete held;
+			return;
+		}
 	}
 }
 
+// GetStatistics
+void
+UpdateQueue::GetStatistics(frame_statistics& statistics)
+{
+	BAutolock _(this);
+	statistics = fStatistics;
+}
+
 // _ExecuteUpdatesEntry
 int32
 UpdateQueue::_ExecuteUpdatesEntry(void* cookie)
@@ -124,49 +241,172 @@ int32
 UpdateQueue::_ExecuteUpdates()
 {
 	while (!fQuitting) {
-		status_t err;
-		if (fRetraceSem >= 0) {
-			bigtime_t timeout = system_time() + fRefreshDuration * 2;
-//			TRACE("acquire_sem_etc(%lld)\n", timeout);
-			do {
-				err = acquire_sem_etc(fRetraceSem, 1,
-					B_ABSOLUTE_TIMEOUT | B_CAN_INTERRUPT, timeout);
-			} while (err == B_INTERRUPTED && !fQuitting);
-		} else {
-			bigtime_t timeout = system_time() + fRefreshDuration;
-//			TRACE("snooze_until(%lld)\n", timeout);
+		bool idle = true;
+		if (Lock()) {
+			idle = fPendingSince < 0;
+			Unlock();
+		}
+
+		if (idle) {
+			// nothing to do until the next AddRect()
+			status_t status;
 			do {
-				err = snooze_until(timeout, B_SYSTEM_TIMEBASE);
-			} while (err == B_INTERRUPTED && !fQuitting);
+				status = acquire_sem(fPendingSem);
+			} while (status == B_INTERRUPTED && !fQuitting);
+			if (status != B_OK)
+				return status;
+			continue;
 		}
+
+		_WaitForRetrace();
 		if (fQuitting)
-			return B_OK;
-		switch (err) {
-			case B_OK:
-			case B_TIMED_OUT:
-				// execute updates
-				if (fInterface->LockParallelAccess()) {
-					if (Lock()) {
-						int32 count = fUpdateRegion.CountRects();
-						if (count > 0) {
-							TRACE("CopyBackToFront() - rects: %ld\n", count);
-							// NOTE: not using the BRegion version, since that
-							// doesn't take care of leaving out and compositing
-							// the cursor.
-							for (int32 i = 0; i < count; i++)
-								fInterface->CopyBackToFront(
-									fUpdateRegion.RectAt(i));
-							fUpdateRegion.MakeEmpty();
-						}
-						Unlock();
-					}
-					fInterface->UnlockParallelAccess();
-				}
-				break;
-			default:
-				return err;
-		}
+			break;
+
+		_Present();
 	}
 	return B_OK;
 }
 
+/*!	Figures out the refresh rate from the timing of the current mode. Without
+	a retrace semaphore, the thread uses it to emulate the retrace.
+*/
+void
+UpdateQueue::_UpdateRefreshRate()
+{
+	// the HWInterface must not be locked with our lock held
+	display_mode mode;
+	memset(&mode, 0, sizeof(mode));
+	fInterface->GetMode(&mode);
+	sem_id retraceSem = fInterface->RetraceSemaphore();
+
+	float rate = kDefaultRefreshRate;
+	uint32 pixels = (uint32)mode.timing.h_total * mode.timing.v_total;
+	if (mode.timing.pixel_clock > 0 && pixels > 0) {
+		rate = mode.timing.pixel_clock * 1000.0f / pixels;
+		if (rate < 10.0f || rate > 1000.0f)
+			rate = kDefaultRefreshRate;
+	}
+
+	BAutolock _(this);
+
+	fRetraceSem = retraceSem;
+	fRefreshRate = rate;
+	fRefreshDuration = (bigtime_t)(1000000 / rate);
+
+	fStatistics.refresh_rate = rate;
+	fStatistics.hardware_retrace = retraceSem >= 0;
+
+	TRACE("fRetraceSem: %ld, fRefreshDuration: %lld\n",
+		fRetraceSem, fRefreshDuration);
+}
+
+/*!	Waits for the next retrace, or for when it would happen, if there is no
+	retrace semaphore, or it does not seem to be released anymore.
+*/
+status_t
+UpdateQueue::_WaitForRetrace()
+{
+	sem_id retraceSem;
+	bigtime_t refreshDuration;
+	if (!Lock())
+		return B_ERROR;
+	retraceSem = fRetraceSem;
+	refreshDuration = fRefreshDuration;
+	Unlock();
+
+	status_t status;
+	if (retraceSem >= 0) {
+		do {
+			status = acquire_sem_etc(retraceSem, 1,
+				B_RELATIVE_TIMEOUT | B_CAN_INTERRUPT, refreshDuration * 2);
+		} while (status == B_INTERRUPTED && !fQuitting);
+		if (status == B_OK || status == B_TIMED_OUT)
+			return status;
+	}
+
+	// Software retrace: the frames are aligned to the refresh duration, so
+	// that the updates are evenly spaced, no matter when they come in.
+	bigtime_t now = system_time();
+	if (fNextRetrace <= now) {
+		fNextRetrace += ((now - fNextRetrace) / refreshDuration + 1)
+			* refreshDuration;
+	}
+
+	do {
+		status = snooze_until(fNextRetrace, B_SYSTEM_TIMEBASE);
+	} while (status == B_INTERRUPTED && !fQuitting);
+
+	return status;
+}
+
+/*!	Transfers everything that is pending and not held back to the front
+	buffer, and updates the statistics.
+*/
+void
+UpdateQueue::_Present()
+{
+	if (!fInterface->LockParallelAccess())
+		return;
+
+	if (!Lock()) {
+		fInterface->UnlockParallelAccess();
+		return;
+	}
+
+	bigtime_t start = system_time();
+	bigtime_t pendingSince = fPendingSince;
+	bigtime_t refreshDuration = fRefreshDuration;
+
+	BRegion region(fUpdateRegion);
+	_ExcludeHeldRegions(region, start);
+
+	// Take the region out before transferring it, so that rects which are
+	// invalidated again in the mean time are transferred once more.
+	fUpdateRegion.Exclude(&region);
+	if (fUpdateRegion.CountRects() == 0)
+		fPendingSince = -1;
+
+	Unlock();
+
+	int32 count = region.CountRects();
+	if (count > 0) {
+		TRACE("CopyBackToFront() - rects: %ld\n", count);
+		// NOTE: not using the BRegion version, since that
+		// doesn't take care of leaving out and compositing
+		// the cursor.
+		for (int32 i = 0; i < count; i++)
+			fInterface->CopyBackToFront(region.RectAt(i));
+	}
+
+	fInterface->UnlockParallelAccess();
+
+	if (count == 0 || pendingSince < 0)
+		return;
+
+	bigtime_t latency = system_time() - pendingSince;
+
+	if (Lock()) {
+		fStatistics.frames++;
+		fStatistics.dropped_frames += (start - pendingSince) / refreshDuration;
+		fStatistics.total_latency += latency;
+		if (latency > fStatistics.max_latency)
+			fStatistics.max_latency = latency;
+		Unlock();
+	}
+}
+
+//!	The queue must be locked.
+void
+UpdateQueue::_ExcludeHeldRegions(BRegion& region, bigtime_t now)
+{
+	for (int32 i = fHeldRegions.CountItems() - 1; i >= 0; i--) {
+		HeldRegion* held = (HeldRegion*)fHeldRegions.ItemAtFast(i);
+		if (now - held->since > kMaxHoldTime) {
+			fHeldRegions.RemoveItem(i);
+			delete held;
+			continue;
+		}
+
+		region.Exclude(&held->region);
+	}
+}
@@ -23,19 +23,40 @@ class UpdateQueue : public BLocker, public HWInterfaceListener {
 			status_t			Init();
 			void				Shutdown();
 
-			void				AddRect(const BRect& rect);
+			status_t			AddRect(const BRect& rect);
+
+			void				Hold(const void* owner, const BRegion& region);
+			void				Release(const void* owner);
+
+			void				GetStatistics(frame_statistics& statistics);
 
  private:
+			struct HeldRegion;
+
 	static	int32				_ExecuteUpdatesEntry(void *cookie);
 			int32				_ExecuteUpdates();
 
+			void				_UpdateRefreshRate();
+			status_t			_WaitForRetrace();
+			void				_Present();
+			void				_ExcludeHeldRegions(BRegion& region,
+									bigtime_t now);
+
 	volatile bool				fQuitting;
 			HWInterface*		fInterface;
 
 			BRegion				fUpdateRegion;
+			bigtime_t			fPendingSince;
+			BList				fHeldRegions;
+
 			thread_id			fUpdateExecutor;
+			sem_id				fPendingSem;
 			sem_id				fRetraceSem;
+			float				fRefreshRate;
 			bigtime_t			fRefreshDuration;
+			bigtime_t			fNextRetrace;
+
+			frame_statistics	fStatistics;
 };
 
 #endif	// UPDATE_QUEUE_H
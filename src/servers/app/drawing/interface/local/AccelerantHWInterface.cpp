@@ -723,11 +723,11 @@ AccelerantHWInterface::SetMode(const display_mode& mode)
 			// clear out backbuffer, alpha is 255 this way
 			memset(fBackBuffer->Bits(), 255, fBackBuffer->BitsLength());
 		}
-#if 0
-// NOTE: Currently disabled, because it make the double buffered mode flicker
-// again. See HWInterface::Invalidate() for more information.
-		SetAsyncDoubleBuffered(doubleBuffered);
-#endif
+		// NOTE: The UpdateQueue is kept when we lose the back buffer; it is
+		// bypassed then, and stopping it here could deadlock, since we are
+		// write locked.
+		if (doubleBuffered)
+			SetAsyncDoubleBuffered(true);
 	}
 
 	// update color palette configuration if necessary
@@ -12,6 +12,7 @@
 #include "StreamingRingBuffer.h"
 
 #include <NetEndpoint.h>
+#include <ZstdCompressionAlgorithm.h>
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -22,7 +23,8 @@
 
 
 NetReceiver::NetReceiver(BNetEndpoint *listener, StreamingRingBuffer *target,
-	NewConnectionCallback newConnectionCallback, void *newConnectionCookie)
+	NewConnectionCallback newConnectionCallback, void *newConnectionCookie,
+	BDataIO *recordTarget)
 	:
 	fListener(listener),
 	fTarget(target),
@@ -30,7 +32,8 @@ NetReceiver::NetReceiver(BNetEndpoint *listener, StreamingRingBuffer *target,
 	fStopThread(false),
 	fNewConnectionCallback(newConnectionCallback),
 	fNewConnectionCookie(newConnectionCookie),
-	fEndpoint(newConnectionCallback == NULL ? listener : NULL)
+	fEndpoint(newConnectionCallback == NULL ? listener : NULL),
+	fRecordTarget(recordTarget)
 {
 	fReceiverThread = spawn_thread(_NetworkReceiverEntry, "network receiver",
 		B_NORMAL_PRIORITY, this);
@@ -48,6 +51,22 @@ NetReceiver::~NetReceiver()
 }
 
 
+/*static*/ bool
+NetReceiver::SupportsCompression()
+{
+	BMallocIO output;
+	BDataIO* stream;
+	BZstdCompressionAlgorithm algorithm;
+	if (algorithm.CreateDecompressingOutputStream(&output, NULL, stream)
+			!= B_OK) {
+		return false;
+	}
+
+	delete stream;
+	return true;
+}
+
+
 int32
 NetReceiver::_NetworkReceiverEntry(void *data)
 {
@@ -77,6 +96,9 @@ NetReceiver::_Listen()
 
 		TRACE("new endpoint connection: %p\n", fEndpoint);
 
+		fScanner = RemoteMessageScanner();
+		fDecompressor.Unset();
+
 		if (fNewConnectionCallback != NULL
 			&& fNewConnectionCallback(
 				fNewConnectionCookie, *fEndpoint.Get()) != B_OK)
@@ -119,11 +141,89 @@ NetReceiver::_Transfer()
 		}
 
 		errorCount = 0;
-		status_t result = fTarget->Write(buffer, readSize);
-		if (result != B_OK) {
-			TRACE_ERROR("writing to ring buffer failed: %s\n",
-				strerror(result));
+		status_t result;
+		if (fDecompressor.IsSet())
+			result = _Decompress(buffer, readSize);
+		else
+			result = _Receive(buffer, readSize);
+		if (result != B_OK)
 			return result;
+	}
+
+	return B_OK;
+}
+
+
+/*!	Passes on uncompressed data, until the sender tells that everything
+	following is compressed.
+*/
+status_t
+NetReceiver::_Receive(const uint8 *buffer, size_t size)
+{
+	bool startCompression = false;
+	size_t used = 0;
+	while (used < size && !startCompression) {
+		used += fScanner.Scan(buffer + used, size - used);
+		startCompression = fScanner.AtBoundary()
+			&& fScanner.LastCode() == RP_ENABLE_COMPRESSION;
+	}
+
+	status_t result = _Write(buffer, used);
+	if (result != B_OK || !startCompression)
+		return result;
+
+	BDataIO *decompressor;
+	BZstdCompressionAlgorithm algorithm;
+	result = algorithm.CreateDecompressingOutputStream(&fDecompressed, NULL,
+		decompressor);
+	if (result != B_OK) {
+		TRACE_ERROR("failed to create decompressor: %s\n", strerror(result));
+		return result;
+	}
+
+	fDecompressor.SetTo(decompressor);
+	if (used == size)
+		return B_OK;
+
+	return _Decompress(buffer + used, size - used);
+}
+
+
+status_t
+NetReceiver::_Decompress(const uint8 *buffer, size_t size)
+{
+	ssize_t written = fDecompressor->Write(buffer, size);
+	status_t result = written < 0 ? (status_t)written : fDecompressor->Flush();
+	if (result != B_OK) {
+		TRACE_ERROR("decompressing failed: %s\n", strerror(result));
+		return result;
+	}
+
+	result = _Write(fDecompressed.Buffer(), fDecompressed.BufferLength());
+
+	fDecompressed.Seek(0, SEEK_SET);
+	fDecompressed.SetSize(0);
+	return result;
+}
+
+
+status_t
+NetReceiver::_Write(const void *buffer, size_t size)
+{
+	if (size == 0)
+		return B_OK;
+
+	status_t result = fTarget->Write(buffer, size);
+	if (result != B_OK) {
+		TRACE_ERROR("writing to ring buffer failed: %s\n", strerror(result));
+		return result;
+	}
+
+	if (fRecordTarget != NULL) {
+		result = fRecordTarget->WriteExactly(buffer, size);
+		if (result != B_OK) {
+			TRACE_ERROR("recording failed: %s\n", strerror(result));
+			fRecordTarget = NULL;
 		}
 	}
 
@@ -9,9 +9,12 @@
 #define NET_RECEIVER_H
 
 #include <AutoDeleter.h>
+#include <DataIO.h>
 #include <OS.h>
 #include <SupportDefs.h>
 
+#include "RemoteMessage.h"
+
 class BNetEndpoint;
 class StreamingRingBuffer;
 
@@ -23,16 +26,23 @@ public:
 								NetReceiver(BNetEndpoint *endpoint,
 									StreamingRingBuffer *target,
 									NewConnectionCallback callback = NULL,
-									void *newConnectionCookie = NULL);
+									void *newConnectionCookie = NULL,
+									BDataIO *recordTarget = NULL);
 								~NetReceiver();
 
 		BNetEndpoint *			Endpoint() { return fEndpoint.Get(); }
 
+static	bool					SupportsCompression();
+
 private:
 static	int32					_NetworkReceiverEntry(void *data);
 		status_t				_Listen();
 		status_t				_Transfer();
 
+		status_t				_Receive(const uint8 *buffer, size_t size);
+		status_t				_Decompress(const uint8 *buffer, size_t size);
+		status_t				_Write(const void *buffer, size_t size);
+
 		BNetEndpoint *			fListener;
 		StreamingRingBuffer *	fTarget;
 
@@ -44,6 +54,11 @@ static	int32					_NetworkReceiverEntry(void *data);
 
 		ObjectDeleter<BNetEndpoint>
 								fEndpoint;
+
+		RemoteMessageScanner	fScanner;
+		ObjectDeleter<BDataIO>	fDecompressor;
+		BMallocIO				fDecompressed;
+		BDataIO *				fRecordTarget;
 };
 
 #endif // NET_RECEIVER_H
@@ -11,6 +11,7 @@
 #include "StreamingRingBuffer.h"
 
 #include <NetEndpoint.h>
+#include <ZstdCompressionAlgorithm.h>
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -20,12 +21,30 @@
 #define TRACE_ERROR(x...)	debug_printf("NetSender: " x)
 
 
+// Once compressed, the data read from the source is collected for a while
+// before it is sent, so that it compresses better and fewer packets are
+// needed. How long depends on how fast the connection takes the data.
+static const bigtime_t kMinBatchDelay = 2000;
+static const bigtime_t kMaxBatchDelay = 20000;
+static const size_t kMinBatchSize = 16 * 1024;
+static const size_t kMaxBatchSize = 1024 * 1024;
+
+
 NetSender::NetSender(BNetEndpoint *endpoint, StreamingRingBuffer *source)
 	:
 	fEndpoint(endpoint),
 	fSource(source),
 	fSenderThread(-1),
-	fStopThread(false)
+	fStopThread(false),
+	fCompressionRequested(false),
+	fCompressor(NULL),
+	fPendingSize(0),
+	fBatchStart(0),
+	fBatchSize(kMinBatchSize),
+	fBatchDelay(kMinBatchDelay),
+	fBandwidth(0),
+	fBytesRead(0),
+	fBytesSent(0)
 {
 	fSenderThread = spawn_thread(_NetworkSenderEntry, "network sender",
 		B_NORMAL_PRIORITY, this);
@@ -39,6 +58,32 @@ NetSender::~NetSender()
 
 	suspend_thread(fSenderThread);
 	resume_thread(fSenderThread);
+
+	delete fCompressor;
+}
+
+
+/*static*/ bool
+NetSender::SupportsCompression()
+{
+	BMallocIO output;
+	BDataIO* stream;
+	BZstdCompressionAlgorithm algorithm;
+	if (algorithm.CreateCompressingOutputStream(&output, NULL, stream) != B_OK)
+		return false;
+
+	delete stream;
+	return true;
+}
+
+
+/*!	Compresses everything that is sent from the next message boundary on.
+	The receiver has to be known to support RP_ENABLE_COMPRESSION.
+*/
+void
+NetSender::EnableCompression()
+{
+	fCompressionRequested = true;
 }
 
 
@@ -53,23 +98,163 @@ status_t
 NetSender::_NetworkSender()
 {
 	while (!fStopThread) {
+		bigtime_t timeout = B_INFINITE_TIMEOUT;
+		if (fPendingSize > 0) {
+			timeout = fBatchStart + fBatchDelay - system_time();
+			if (fPendingSize >= fBatchSize || timeout <= 0) {
+				status_t result = _FlushCompressed();
+				if (result != B_OK)
+					return result;
+				continue;
+			}
+		}
+
 		uint8 buffer[4096];
-		int32 readSize = fSource->Read(buffer, sizeof(buffer), true);
+		int32 readSize = fSource->Read(buffer, sizeof(buffer), true, timeout);
+		if (readSize == B_TIMED_OUT)
+			continue;
 		if (readSize < 0) {
 			TRACE_ERROR("read failed, stopping sender thread: %s\n",
 				strerror(readSize));
 			return readSize;
 		}
 
-		while (readSize > 0) {
-			int32 sendSize = fEndpoint->Send(buffer, readSize);
-			if (sendSize < 0) {
-				TRACE_ERROR("sending data failed: %s\n", strerror(sendSize));
-				return sendSize;
-			}
+		fBytesRead += readSize;
+
+		status_t result;
+		if (fCompressor != NULL)
+			result = _Compress(buffer, readSize);
+		else
+			result = _SendRaw(buffer, readSize);
+		if (result != B_OK)
+			return result;
+	}
+
+	return B_OK;
+}
+
+
+status_t
+NetSender::_SendRaw(const uint8 *buffer, size_t size)
+{
+	// Compression may only start in between two messages, so the raw stream
+	// needs to be followed message by message.
+	size_t used = 0;
+	while (used < size) {
+		if (fCompressionRequested && fScanner.AtBoundary())
+			break;
+
+		used += fScanner.Scan(buffer + used, size - used);
+	}
+
+	status_t result = _Send(buffer, used);
+	if (result != B_OK || !fCompressionRequested || !fScanner.AtBoundary())
+		return result;
+
+	result = _StartCompression();
+	if (result != B_OK || used == size)
+		return result;
+
+	return _Compress(buffer + used, size - used);
+}
+
+
+status_t
+NetSender::_StartCompression()
+{
+	fCompressionRequested = false;
+
+	BZstdCompressionAlgorithm algorithm;
+	status_t result = algorithm.CreateCompressingOutputStream(&fCompressed,
+		NULL, fCompressor);
+	if (result != B_OK) {
+		TRACE_ERROR("failed to create compressor: %s\n", strerror(result));
+		fCompressor = NULL;
+		return result;
+	}
+
+	// the last uncompressed message tells the receiver about the switch
+	uint8 header[sizeof(uint16) + sizeof(uint32)];
+	uint16 code = RP_ENABLE_COMPRESSION;
+	uint32 length = sizeof(header);
+	memcpy(header, &code, sizeof(uint16));
+	memcpy(header + sizeof(uint16), &length, sizeof(uint32));
+
+	TRACE("starting compression after %" B_PRIu64 " bytes\n", fBytesSent);
+	return _Send(header, sizeof(header));
+}
+
+
+status_t
+NetSender::_Compress(const uint8 *buffer, size_t size)
+{
+	if (fPendingSize == 0)
+		fBatchStart = system_time();
+
+	ssize_t written = fCompressor->Write(buffer, size);
+	if (written < 0) {
+		TRACE_ERROR("compressing data failed: %s\n", strerror(written));
+		return written;
+	}
+
+	fPendingSize += size;
+	return B_OK;
+}
+
 
-			readSize -= sendSize;
+status_t
+NetSender::_FlushCompressed()
+{
+	status_t result = fCompressor->Flush();
+	if (result != B_OK) {
+		TRACE_ERROR("flushing compressor failed: %s\n", strerror(result));
+		return result;
+	}
+
+	bigtime_t sendStart = system_time();
+	result = _Send(fCompressed.Buffer(), fCompressed.BufferLength());
+	bigtime_t sendTime = system_time() - sendStart;
+	if (result != B_OK)
+		return result;
+
+	TRACE("sent %" B_PRIuSIZE " bytes as %" B_PRIuSIZE " in %" B_PRIdBIGTIME
+		" us\n", fPendingSize, fCompressed.BufferLength(), sendTime);
+
+	// Sending only blocks once the connection cannot keep up. The longer
+	// it takes, the more is collected for the next batch, which keeps the
+	// connection busy and gives the compressor more to work with, while a
+	// fast connection gets the data with little delay.
+	if (sendTime > 0) {
+		uint64 bandwidth = fPendingSize * 1000000LL / sendTime;
+		fBandwidth = fBandwidth == 0 ? bandwidth
+			: (fBandwidth * 7 + bandwidth) / 8;
+	}
+
+	bigtime_t delay = max_c(kMinBatchDelay, min_c(kMaxBatchDelay, sendTime));
+	fBatchDelay = (fBatchDelay * 3 + delay) / 4;
+	fBatchSize = (size_t)min_c((uint64)kMaxBatchSize,
+		max_c((uint64)kMinBatchSize, fBandwidth * fBatchDelay / 1000000));
+
+	fCompressed.Seek(0, SEEK_SET);
+	fCompressed.SetSize(0);
+	fPendingSize = 0;
+	return B_OK;
+}
+
+
+status_t
+NetSender::_Send(const void *buffer, size_t size)
+{
+	while (size > 0) {
+		int32 sendSize = fEndpoint->Send(buffer, size);
+		if (sendSize < 0) {
+			TRACE_ERROR("sending data failed: %s\n", strerror(sendSize));
+			return sendSize;
 		}
+
+		buffer = (const uint8 *)buffer + sendSize;
+		size -= sendSize;
+		fBytesSent += sendSize;
 	}
 
 	return B_OK;
@@ -8,9 +8,12 @@
 #ifndef NET_SENDER_H
 #define NET_SENDER_H
 
+#include <DataIO.h>
 #include <OS.h>
 #include <SupportDefs.h>
 
+#include "RemoteMessage.h"
+
 class BNetEndpoint;
 class StreamingRingBuffer;
 
@@ -20,15 +23,41 @@ public:
 									StreamingRingBuffer *source);
 								~NetSender();
 
+static	bool					SupportsCompression();
+		void					EnableCompression();
+
+		uint64					BytesRead() const { return fBytesRead; }
+		uint64					BytesSent() const { return fBytesSent; }
+
 private:
 static	int32					_NetworkSenderEntry(void *data);
 		status_t				_NetworkSender();
 
+		status_t				_SendRaw(const uint8 *buffer, size_t size);
+		status_t				_StartCompression();
+		status_t				_Compress(const uint8 *buffer, size_t size);
+		status_t				_FlushCompressed();
+		status_t				_Send(const void *buffer, size_t size);
+
 		BNetEndpoint *			fEndpoint;
 		StreamingRingBuffer *	fSource;
 
 		thread_id				fSenderThread;
 		bool					fStopThread;
+
+		RemoteMessageScanner	fScanner;
+		bool					fCompressionRequested;
+		BDataIO *				fCompressor;
+		BMallocIO				fCompressed;
+		size_t					fPendingSize;
+
+		bigtime_t				fBatchStart;
+		size_t					fBatchSize;
+		bigtime_t				fBatchDelay;
+		uint64					fBandwidth;
+
+		uint64					fBytesRead;
+		uint64					fBytesSent;
 };
 
 #endif // NET_SENDER_H
@@ -0,0 +1,155 @@
+/*
+ * Copyright 2026, Haiku, Inc.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "RemoteBitmapCache.h"
+
+#include <new>
+
+
+RemoteBitmapCache::RemoteBitmapCache(uint32 slotCount, size_t maxSize)
+	:
+	fLock("remote bitmap cache"),
+	fEnabled(false),
+	fSlots(new(std::nothrow) slot[slotCount]),
+	fSlotCount(slotCount),
+	fMaxSize(maxSize)
+{
+	_MakeEmpty();
+}
+
+
+RemoteBitmapCache::~RemoteBitmapCache()
+{
+	delete[] fSlots;
+}
+
+
+status_t
+RemoteBitmapCache::InitCheck() const
+{
+	if (fSlots == NULL)
+		return B_NO_MEMORY;
+
+	return fSlotMap.InitCheck();
+}
+
+
+/*!	Enabling or disabling the cache forgets about all tiles, as it is done
+	whenever a client connects.
+*/
+void
+RemoteBitmapCache::SetEnabled(bool enabled)
+{
+	fEnabled = enabled && InitCheck() == B_OK;
+	_MakeEmpty();
+}
+
+
+/*!	Returns the slot of the tile with the given \a hash. If the client
+	does not have it yet, \a _cached is set to \c false, and the tile has to
+	be sent along; it will replace whatever was in the slot before.
+	Returns -1 if the tile should not be cached at all.
+*/
+int32
+RemoteBitmapCache::Lookup(uint64 hash, size_t size, bool& _cached)
+{
+	_cached = false;
+	if (!fEnabled || size > fMaxSize / 4)
+		return -1;
+
+	int32 index;
+	int32* existing;
+	if (fSlotMap.Get(HashKey64<uint64>(hash), existing)) {
+		index = *existing;
+		if (fSlots[index].size == size) {
+			_Unlink(index);
+			_LinkFirst(index);
+			_cached = true;
+			return index;
+		}
+
+		// a hash collision of differently sized tiles
+		_Evict(index);
+	}
+
+	while (fSize + size > fMaxSize || fFreeSlot < 0)
+		_Evict(fLastUsed);
+
+	index = fFreeSlot;
+	if (fSlotMap.Put(HashKey64<uint64>(hash), index) != B_OK)
+		return -1;
+
+	fFreeSlot = fSlots[index].next;
+	fSlots[index].hash = hash;
+	fSlots[index].size = size;
+	_LinkFirst(index);
+	fSize += size;
+
+	return index;
+}
+
+
+void
+RemoteBitmapCache::_MakeEmpty()
+{
+	fSlotMap.Clear();
+	fFirstUsed = fLastUsed = -1;
+	fSize = 0;
+	fFreeSlot = -1;
+
+	if (fSlots == NULL)
+		return;
+
+	for (int32 i = fSlotCount - 1; i >= 0; i--) {
+		fSlots[i].size = 0;
+		fSlots[i].next = fFreeSlot;
+		fFreeSlot = i;
+	}
+}
+
+
+void
+RemoteBitmapCache::_Unlink(int32 index)
+{
+	slot& entry = fSlots[index];
+	if (entry.previous >= 0)
+		fSlots[entry.previous].next = entry.next;
+	else
+		fFirstUsed = entry.next;
+
+	if (entry.next >= 0)
+		fSlots[entry.next].previous = entry.previous;
+	else
+		fLastUsed = entry.previous;
+}
+
+
+void
+RemoteBitmapCache::_LinkFirst(int32 index)
+{
+	slot& entry = fSlots[index];
+	entry.previous = -1;
+	entry.next = fFirstUsed;
+	if (fFirstUsed >= 0)
+		fSlots[fFirstUsed].previous = index;
+	else
+		fLastUsed = index;
+
+	fFirstUsed = index;
+}
+
+
+void
+RemoteBitmapCache::_Evict(int32 index)
+{
+	_Unlink(index);
+	fSlotMap.Remove(HashKey64<uint64>(fSlots[index].hash));
+	fSize -= fSlots[index].size;
+
+	fSlots[index].size = 0;
+	fSlots[index].next = fFreeSlot;
+	fFreeSlot = index;
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2026, Haiku, Inc.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef REMOTE_BITMAP_CACHE_H
+#define REMOTE_BITMAP_CACHE_H
+
+
+#include <HashMap.h>
+#include <Locker.h>
+
+
+/*!	Mirrors the bitmap tiles the client keeps around, so that a tile that
+	has been sent before only needs to be referred to. The server decides
+	which slot a tile goes into, the client simply replaces the contents of
+	that slot when it receives a tile.
+	The cache must stay locked until the message referring to the slots has
+	been written, so that the client sees the slots in the same order.
+*/
+class RemoteBitmapCache {
+public:
+								RemoteBitmapCache(uint32 slotCount,
+									size_t maxSize);
+								~RemoteBitmapCache();
+
+			status_t			InitCheck() const;
+
+			bool				Lock() { return fLock.Lock(); }
+			void				Unlock() { fLock.Unlock(); }
+
+			bool				IsEnabled() const { return fEnabled; }
+			void				SetEnabled(bool enabled);
+
+			int32				Lookup(uint64 hash, size_t size,
+									bool& _cached);
+
+private:
+			struct slot {
+				uint64			hash;
+				size_t			size;
+				int32			previous;
+				int32			next;
+			};
+
+			void				_MakeEmpty();
+			void				_Unlink(int32 index);
+			void				_LinkFirst(int32 index);
+			void				_Evict(int32 index);
+
+private:
+			BLocker				fLock;
+			bool				fEnabled;
+
+			slot*				fSlots;
+			uint32				fSlotCount;
+			HashMap<HashKey64<uint64>, int32>
+								fSlotMap;
+			int32				fFreeSlot;
+			int32				fFirstUsed;
+			int32				fLastUsed;
+
+			size_t				fSize;
+			size_t				fMaxSize;
+};
+
+
+#endif	// REMOTE_BITMAP_CACHE_H
@@ -7,6 +7,7 @@
  */
 
 #include "RemoteDrawingEngine.h"
+#include "RemoteBitmapCache.h"
 #include "RemoteMessage.h"
 
 #include "BitmapDrawingEngine.h"
@@ -16,6 +17,7 @@
 #include <Bitmap.h>
 #include <utf8_functions.h>
 
+#include <math.h>
 #include <new>
 
 
@@ -24,6 +26,72 @@
 #define TRACE_ERROR(x...)		debug_printf("RemoteDrawingEngine: " x)
 
 
+static const int32 kBitmapTileSize = 64;
+
+
+static uint64
+hash_bitmap_rect(const ServerBitmap& bitmap, const BRect& rect)
+{
+	int32 width = rect.IntegerWidth() + 1;
+	int32 height = rect.IntegerHeight() + 1;
+	const uint8* row = bitmap.Bits() + (int32)rect.top * bitmap.BytesPerRow()
+		+ (int32)rect.left * 4;
+
+	// FNV-1a, but on whole pixels
+	uint64 hash = 0xcbf29ce484222325ULL ^ ((uint64)width << 32 | height);
+	for (int32 y = 0; y < height; y++) {
+		const uint32* pixel = (const uint32*)row;
+		for (int32 x = 0; x < width; x++)
+			hash = (hash ^ pixel[x]) * 0x100000001b3ULL;
+
+		row += bitmap.BytesPerRow();
+	}
+
+	return hash;
+}
+
+
+//! Splits \a region into the parts of the tiles of a grid at \a offset.
+static int32
+split_into_tiles(const BRegion& region, const BPoint& offset, BRect*& _tiles)
+{
+	int32 rectCount = region.CountRects();
+	int32 tileCount = 0;
+	for (int32 i = 0; i < rectCount; i++) {
+		clipping_rect rect = region.RectAtInt(i);
+		int32 columns = (rect.right + (int32)offset.x) / kBitmapTileSize
+			- (rect.left + (int32)offset.x) / kBitmapTileSize + 1;
+		int32 rows = (rect.bottom + (int32)offset.y) / kBitmapTileSize
+			- (rect.top + (int32)offset.y) / kBitmapTileSize + 1;
+		tileCount += columns * rows;
+	}
+
+	_tiles = new(std::nothrow) BRect[tileCount];
+	if (_tiles == NULL)
+		return -1;
+
+	int32 index = 0;
+	for (int32 i = 0; i < rectCount; i++) {
+		clipping_rect rect = region.RectAtInt(i);
+		int32 top = rect.top;
+		while (top <= rect.bottom) {
+			int32 bottom = min_c(rect.bottom, top - (top + (int32)offset.y)
+				% kBitmapTileSize + kBitmapTileSize - 1);
+			int32 left = rect.left;
+			while (left <= rect.right) {
+				int32 right = min_c(rect.right, left - (left + (int32)offset.x)
+					% kBitmapTileSize + kBitmapTileSize - 1);
+				_tiles[index++].Set(left, top, right, bottom);
+				left = right + 1;
+			}
+			top = bottom + 1;
+		}
+	}
+
+	return index;
+}
+
+
 RemoteDrawingEngine::RemoteDrawingEngine(RemoteHWInterface* interface)
 	:
 	DrawingEngine(interface),
@@ -353,6 +421,12 @@ RemoteDrawingEngine::DrawBitmap(ServerBitmap* bitmap, const BRect& _bitmapRect,
 	if (rectCount == 0)
 		return;
 
+	if (xScale == 1.0 && yScale == 1.0
+		&& _DrawBitmapTiles(*bitmap, options, bitmapRect, viewRect,
+			clippedRegion)) {
+		return;
+	}
+
 	if (rectCount > 1 || (rectCount == 1 && clippedRegion.RectAt(0) != viewRect)
 		|| viewRect.Width() < bitmapRect.Width()
 		|| viewRect.Height() < bitmapRect.Height()) {
@@ -1069,6 +1143,77 @@ RemoteDrawingEngine::_BuildBounds(BPoint* points, int32 pointCount)
 }
 
 
+/*!	Sends the visible part of an unscaled \a bitmap in tiles, aligned to
+	the bitmap, so that a tile the client still has from before, because the
+	bitmap has been drawn already or only changed partially, does not need
+	to be sent again.
+	Returns \c false if the bitmap cannot be sent that way.
+*/
+bool
+RemoteDrawingEngine::_DrawBitmapTiles(const ServerBitmap& bitmap,
+	uint32 options, const BRect& bitmapRect, const BRect& viewRect,
+	const BRegion& region)
+{
+	RemoteBitmapCache* cache = fHWInterface->BitmapCache();
+	if (cache == NULL || !cache->IsEnabled())
+		return false;
+
+	if (bitmap.ColorSpace() != B_RGB32 && bitmap.ColorSpace() != B_RGBA32)
+		return false;
+
+	BPoint offset = bitmapRect.LeftTop() - viewRect.LeftTop();
+	if (offset.x != floorf(offset.x) || offset.y != floorf(offset.y))
+		return false;
+
+	BRect* tiles;
+	int32 tileCount = split_into_tiles(region, offset, tiles);
+	if (tileCount < 0)
+		return false;
+
+	// the slots need to be used in the same order as the client sees them
+	if (!cache->Lock()) {
+		delete[] tiles;
+		return false;
+	}
+
+	if (!cache->IsEnabled()) {
+		cache->Unlock();
+		delete[] tiles;
+		return false;
+	}
+
+	RemoteMessage message(NULL, fHWInterface->SendBuffer());
+	message.Start(RP_DRAW_BITMAP_TILES);
+	message.Add(fToken);
+	message.Add(options);
+	message.Add(bitmap.ColorSpace());
+	message.Add(bitmap.Flags());
+	message.Add(tileCount);
+
+	for (int32 i = 0; i < tileCount; i++) {
+		BRect sourceRect = tiles[i].OffsetByCopy(offset);
+		size_t size = (sourceRect.IntegerWidth() + 1)
+			* (sourceRect.IntegerHeight() + 1) * 4;
+
+		bool cached;
+		int32 slot = cache->Lookup(hash_bitmap_rect(bitmap, sourceRect), size,
+			cached);
+
+		message.Add(tiles[i]);
+		message.Add(slot);
+		message.Add(cached);
+		if (!cached)
+			message.AddBitmapRect(bitmap, sourceRect);
+	}
+
+	message.Flush();
+	cache->Unlock();
+
+	delete[] tiles;
+	return true;
+}
+
+
 status_t
 RemoteDrawingEngine::_ExtractBitmapRegions(ServerBitmap& bitmap, uint32 options,
 	const BRect& bitmapRect, const BRect& viewRect, double xScale,
@@ -158,6 +158,10 @@ private:
 									RemoteMessage& message);
 
 			BRect				_BuildBounds(BPoint* points, int32 pointCount);
+			bool				_DrawBitmapTiles(const ServerBitmap& bitmap,
+									uint32 options, const BRect& bitmapRect,
+									const BRect& viewRect,
+									const BRegion& region);
 			status_t			_ExtractBitmapRegions(ServerBitmap& bitmap,
 									uint32 options, const BRect& bitmapRect,
 									const BRect& viewRect, double xScale,
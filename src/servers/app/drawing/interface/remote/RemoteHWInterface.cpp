@@ -7,6 +7,7 @@
  */
 
 #include "RemoteHWInterface.h"
+#include "RemoteBitmapCache.h"
 #include "RemoteDrawingEngine.h"
 #include "RemoteEventStream.h"
 #include "RemoteMessage.h"
@@ -29,6 +30,10 @@
 #define TRACE_ERROR(x...)		debug_printf("RemoteHWInterface: " x)
 
 
+// what the client may keep in bitmap tiles for us
+static const size_t kBitmapCacheSize = 32 * 1024 * 1024;
+
+
 struct callback_info {
 	uint32				token;
 	RemoteHWInterface::CallbackFunction	callback;
@@ -43,12 +48,14 @@ RemoteHWInterface::RemoteHWInterface(const char* target)
 	fIsConnected(false),
 	fProtocolVersion(100),
 	fConnectionSpeed(0),
+	fCapabilities(0),
 	fListenPort(10901),
 	fListenEndpoint(NULL),
 	fSendBuffer(NULL),
 	fReceiveBuffer(NULL),
 	fSender(NULL),
 	fReceiver(NULL),
+	fBitmapCache(NULL),
 	fEventThread(-1),
 	fEventStream(NULL),
 	fCallbackLocker("callback locker")
@@ -103,6 +110,14 @@ RemoteHWInterface::RemoteHWInterface(const char* target)
 		return;
 	}
 
+	if (NetSender::SupportsCompression())
+		fCapabilities |= RP_CAPABILITY_COMPRESSION;
+
+	fBitmapCache.SetTo(new(std::nothrow) RemoteBitmapCache(
+		kRemoteBitmapCacheSlots, kBitmapCacheSize));
+	if (fBitmapCache.IsSet() && fBitmapCache->InitCheck() == B_OK)
+		fCapabilities |= RP_CAPABILITY_BITMAP_CACHE;
+
 	fEventStream.SetTo(new(std::nothrow) RemoteEventStream());
 	if (!fEventStream.IsSet()) {
 		fInitStatus = B_NO_MEMORY;
@@ -253,11 +268,22 @@ RemoteHWInterface::_EventThread()
 		switch (code) {
 			case RP_INIT_CONNECTION:
 			{
+				// newer clients tell what they support, older ones don't
+				// expect anything in the reply
+				uint32 capabilities;
+				bool hasCapabilities = message.Read(capabilities) == B_OK;
+				if (!hasCapabilities)
+					capabilities = 0;
+				capabilities &= fCapabilities;
+
 				RemoteMessage reply(NULL, fSendBuffer.Get());
 				reply.Start(RP_INIT_CONNECTION);
+				if (hasCapabilities)
+					reply.Add(capabilities);
 				status_t result = reply.Flush();
-				(void)result;
 				TRACE("init connection result: %s\n", strerror(result));
+				if (result == B_OK)
+					_EnableCapabilities(capabilities);
 				break;
 			}
 
@@ -326,6 +352,8 @@ RemoteHWInterface::_NewConnectionCallback(void *cookie, BNetEndpoint &endpoint)
 status_t
 RemoteHWInterface::_NewConnection(BNetEndpoint &endpoint)
 {
+	_EnableCapabilities(0);
+
 	fSender.Unset();
 
 	fSendBuffer->MakeEmpty();
@@ -359,6 +387,22 @@ RemoteHWInterface::_Disconnect()
 }
 
 
+void
+RemoteHWInterface::_EnableCapabilities(uint32 capabilities)
+{
+	TRACE("enabling capabilities %#" B_PRIx32 "\n", capabilities);
+
+	if ((capabilities & RP_CAPABILITY_COMPRESSION) != 0 && fSender.IsSet())
+		fSender->EnableCompression();
+
+	if (fBitmapCache.IsSet() && fBitmapCache->Lock()) {
+		fBitmapCache->SetEnabled(
+			(capabilities & RP_CAPABILITY_BITMAP_CACHE) != 0);
+		fBitmapCache->Unlock();
+	}
+}
+
+
 status_t
 RemoteHWInterface::SetMode(const display_mode& mode)
 {
@@ -18,6 +18,7 @@ class BNetEndpoint;
 class StreamingRingBuffer;
 class NetSender;
 class NetReceiver;
+class RemoteBitmapCache;
 class RemoteEventStream;
 class RemoteMessage;
 
@@ -84,6 +85,8 @@ virtual	status_t					CopyBackToFront(const BRect& frame);
 		StreamingRingBuffer*		ReceiveBuffer()
 										{ return fReceiveBuffer.Get(); }
 		StreamingRingBuffer*		SendBuffer() { return fSendBuffer.Get(); }
+		RemoteBitmapCache*			BitmapCache()
+										{ return fBitmapCache.Get(); }
 
 typedef bool (*CallbackFunction)(void* cookie, RemoteMessage& message);
 
@@ -105,6 +108,7 @@ static	status_t					_NewConnectionCallback(void *cookie,
 		status_t					_NewConnection(BNetEndpoint &endpoint);
 
 		void						_Disconnect();
+		void						_EnableCapabilities(uint32 capabilities);
 
 		void						_FillDisplayModeTiming(display_mode &mode);
 
@@ -113,6 +117,7 @@ static	status_t					_NewConnectionCallback(void *cookie,
 		bool						fIsConnected;
 		uint32						fProtocolVersion;
 		uint32						fConnectionSpeed;
+		uint32						fCapabilities;
 		display_mode				fFallbackMode;
 		display_mode				fCurrentMode;
 		display_mode				fClientMode;
@@ -127,6 +132,9 @@ static	status_t					_NewConnectionCallback(void *cookie,
 		ObjectDeleter<NetSender>	fSender;
 		ObjectDeleter<NetReceiver>	fReceiver;
 
+		ObjectDeleter<RemoteBitmapCache>
+									fBitmapCache;
+
 		thread_id					fEventThread;
 		ObjectDeleter<RemoteEventStream>
 									fEventStream;
@@ -111,6 +111,38 @@ RemoteMessage::AddBitmap(const ServerBitmap& bitmap, bool minimal)
 }
 
 
+/*!	Adds the part \a rect of a 32 bit \a bitmap, in the same format as
+	AddBitmap() does with \a minimal set.
+*/
+void
+RemoteMessage::AddBitmapRect(const ServerBitmap& bitmap, const BRect& rect)
+{
+	int32 width = rect.IntegerWidth() + 1;
+	int32 height = rect.IntegerHeight() + 1;
+	int32 bytesPerRow = width * 4;
+
+	Add(width);
+	Add(height);
+	Add(bytesPerRow);
+
+	uint32 bitsLength = bytesPerRow * height;
+	Add(bitsLength);
+
+	if (!_MakeSpace(bitsLength))
+		return;
+
+	const uint8* source = bitmap.Bits() + (int32)rect.top * bitmap.BytesPerRow()
+		+ (int32)rect.left * 4;
+	for (int32 y = 0; y < height; y++) {
+		memcpy(fBuffer + fWriteIndex, source, bytesPerRow);
+		source += bitmap.BytesPerRow();
+		fWriteIndex += bytesPerRow;
+	}
+
+	fAvailable -= bitsLength;
+}
+
+
 void
 RemoteMessage::AddFont(const ServerFont& font)
 {
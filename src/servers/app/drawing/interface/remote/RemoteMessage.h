@@ -41,6 +41,7 @@ enum {
 	RP_CLOSE_CONNECTION,
 	RP_GET_SYSTEM_PALETTE,
 	RP_GET_SYSTEM_PALETTE_RESULT,
+	RP_ENABLE_COMPRESSION,
 
 	RP_CREATE_STATE = 20,
 	RP_DELETE_STATE,
@@ -65,6 +66,7 @@ enum {
 	RP_INVERT_RECT,
 	RP_DRAW_BITMAP,
 	RP_DRAW_BITMAP_RECTS,
+	RP_DRAW_BITMAP_TILES,
 
 	RP_STROKE_ARC = 80,
 	RP_STROKE_BEZIER,
@@ -129,6 +131,20 @@ enum {
 };
 
 
+// capabilities the client announces with RP_INIT_CONNECTION, the reply
+// contains the ones the server is going to use
+enum {
+	RP_CAPABILITY_COMPRESSION	= 0x01,
+		// everything after RP_ENABLE_COMPRESSION is a zstd stream
+	RP_CAPABILITY_BITMAP_CACHE	= 0x02
+		// RP_DRAW_BITMAP_TILES may refer to tiles sent before
+};
+
+
+// the number of bitmap tiles the client needs to be able to keep around
+static const uint32 kRemoteBitmapCacheSlots = 4096;
+
+
 class RemoteMessage {
 public:
 								RemoteMessage(StreamingRingBuffer* source,
@@ -154,6 +170,8 @@ public:
 #ifndef CLIENT_COMPILE
 		void					AddBitmap(const ServerBitmap& bitmap,
 									bool minimal = false);
+		void					AddBitmapRect(const ServerBitmap& bitmap,
+									const BRect& rect);
 		void					AddFont(const ServerFont& font);
 		void					AddPattern(const Pattern& pattern);
 		void					AddDrawState(const DrawState& drawState);
@@ -202,6 +220,28 @@ private:
 };
 
 
+/*!	Follows the message boundaries of a raw message stream, without needing
+	to look at more than the message headers.
+*/
+class RemoteMessageScanner {
+public:
+								RemoteMessageScanner();
+
+		size_t					Scan(const uint8* data, size_t size);
+
+		bool					AtBoundary() const
+									{ return fHeaderSize == 0
+										&& fDataLeft == 0; }
+		uint16					LastCode() const { return fLastCode; }
+
+private:
+		uint8					fHeader[sizeof(uint16) + sizeof(uint32)];
+		size_t					fHeaderSize;
+		uint32					fDataLeft;
+		uint16					fLastCode;
+};
+
+
 inline
 RemoteMessage::RemoteMessage(StreamingRingBuffer* source,
 	StreamingRingBuffer* target)
@@ -372,4 +412,57 @@ RemoteMessage::_MakeSpace(size_t size)
 	return true;
 }
 
+
+
+// #pragma mark - RemoteMessageScanner
+
+
+inline
+RemoteMessageScanner::RemoteMessageScanner()
+	:
+	fHeaderSize(0),
+	fDataLeft(0),
+	fLastCode(0)
+{
+}
+
+
+/*!	Consumes \a data until the end of the current message. Returns the number
+	of bytes used, if that is less than \a size, the scanner is at a message
+	boundary, and the rest belongs to the next message.
+*/
+inline size_t
+RemoteMessageScanner::Scan(const uint8* data, size_t size)
+{
+	size_t used = 0;
+	while (used < size) {
+		if (fHeaderSize < sizeof(fHeader)) {
+			size_t copySize = min_c(size - used, sizeof(fHeader) - fHeaderSize);
+			memcpy(fHeader + fHeaderSize, data + used, copySize);
+			fHeaderSize += copySize;
+			used += copySize;
+
+			if (fHeaderSize < sizeof(fHeader))
+				break;
+
+			uint32 length;
+			memcpy(&fLastCode, fHeader, sizeof(uint16));
+			memcpy(&length, fHeader + sizeof(uint16), sizeof(uint32));
+			fDataLeft = length > sizeof(fHeader) ? length - sizeof(fHeader) : 0;
+		} else {
+			size_t skipSize = min_c(size - used, fDataLeft);
+			fDataLeft -= skipSize;
+			used += skipSize;
+		}
+
+		if (fDataLeft == 0) {
+			fHeaderSize = 0;
+			break;
+		}
+	}
+
+	return used;
+}
+
+
 #endif // REMOTE_MESSAGE_H
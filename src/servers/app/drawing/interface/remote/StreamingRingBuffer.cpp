@@ -73,8 +73,14 @@ StreamingRingBuffer::InitCheck()
 }
 
 
+/*!	Reads \a length bytes, waiting for them as needed. With
+	\a onlyBlockOnNoData set, it returns as soon as anything could be read.
+	If \a timeout passes without any new data, the number of bytes read so
+	far is returned, or \c B_TIMED_OUT if there were none.
+*/
 int32
-StreamingRingBuffer::Read(void *buffer, size_t length, bool onlyBlockOnNoData)
+StreamingRingBuffer::Read(void *buffer, size_t length, bool onlyBlockOnNoData,
+	bigtime_t timeout)
 {
 	BAutolock readerLock(fReaderLocker);
 	if (!readerLock.IsLocked())
@@ -99,11 +105,20 @@ StreamingRingBuffer::Read(void *buffer, size_t length, bool onlyBlockOnNoData)
 			status_t result;
 			do {
 				TRACE("waiting in reader\n");
-				result = acquire_sem(fReaderNotifier);
+				result = acquire_sem_etc(fReaderNotifier, 1, B_RELATIVE_TIMEOUT,
+					timeout);
 				TRACE("done waiting in reader with status: %#" B_PRIx32 "\n",
 					result);
 			} while (result == B_INTERRUPTED);
 
+			if (result == B_TIMED_OUT) {
+				// a writer might release the semaphore anyway, the next
+				// reader will then just check once more
+				if (dataLock.Lock())
+					fReaderWaiting = false;
+				return readSize > 0 ? readSize : B_TIMED_OUT;
+			}
+
 			if (result != B_OK)
 				return result;
 
@@ -26,103 +26,175 @@
 
 #include "FontCacheEntry.h"
 
+#include <limits.h>
 #include <string.h>
 
 #include <new>
 
-#include <Autolock.h>
-
 #include <agg_array.h>
 #include <utf8_functions.h>
-#include <util/OpenHashTable.h>
 
 #include "GlobalSubpixelSettings.h"
 
 
-BLocker FontCacheEntry::sUsageUpdateLock("FontCacheEntry usage lock");
+static const int32 kMaxCachedStringWidths = 256;
+
+
+// The glyphs that are created all at once when the first glyph of an entry
+// is needed: printable ASCII, which makes up most of the text on screen.
+static const uint32 kFirstCommonGlyph = 0x20;
+static const uint32 kLastCommonGlyph = 0x7e;
+
+
+// The kerning of a glyph pair is cached in a single 64 bit value, so that it
+// can be read and written atomically: both glyph codes, the horizontal
+// kerning in 26.6 fixed point, and whether the font has kerning for the pair
+// at all.
+static const uint32 kKerningCodeBits = 21;
+static const uint32 kKerningDeltaBits = 20;
+static const uint32 kKerningDeltaShift = 2;
+static const uint64 kKerningKnown = 0x1;
+static const uint64 kKerningPresent = 0x2;
+
+
+static inline uint64
+kerning_key(uint32 glyphCode1, uint32 glyphCode2)
+{
+	return ((uint64)glyphCode1 << kKerningCodeBits) | glyphCode2;
+}
+
+
+template<typename Type> static inline Type*
+atomic_pointer_get(Type* const* pointer)
+{
+#if LONG_MAX == INT_MAX
+	return (Type*)atomic_get((int32*)pointer);
+#else
+	return (Type*)atomic_get64((int64*)pointer);
+#endif
+}
+
+
+template<typename Type> static inline void
+atomic_pointer_set(Type** pointer, Type* value)
+{
+#if LONG_MAX == INT_MAX
+	atomic_set((int32*)pointer, (int32)value);
+#else
+	atomic_set64((int64*)pointer, (int64)value);
+#endif
+}
 
 
+/*!	Stores the glyphs by their code in a table of three levels: 32 planes of
+	256 blocks of 256 glyphs each, which covers every code UTF8ToCharCode()
+	can return. Blocks and planes are only allocated when the first glyph in
+	them is inserted.
+	Neither glyphs nor the tables are removed before the pool is deleted, and
+	all pointers are published only after what they point to is complete.
+	This allows to look up glyphs without holding any lock, while another
+	thread, holding the write lock of the entry, inserts new ones.
+*/
 class FontCacheEntry::GlyphCachePool {
 	// This class needs to be defined before any inline functions, as otherwise
 	// gcc2 will barf in debug mode.
-	struct GlyphHashTableDefinition {
-		typedef uint32		KeyType;
-		typedef	GlyphCache	ValueType;
-
-		size_t HashKey(uint32 key) const
-		{
-			return key;
-		}
-
-		size_t Hash(GlyphCache* value) const
-		{
-			return value->glyph_index;
-		}
+	enum {
+		kPlaneCount	= 32,
+		kBlockSize	= 256
+	};
 
-		bool Compare(uint32 key, GlyphCache* value) const
-		{
-			return value->glyph_index == key;
-		}
+	struct GlyphBlock {
+		GlyphCache*	glyphs[kBlockSize];
+	};
 
-		GlyphCache*& GetLink(GlyphCache* value) const
-		{
-			return value->hash_link;
-		}
+	struct GlyphPlane {
+		GlyphBlock*	blocks[kBlockSize];
 	};
+
 public:
 	GlyphCachePool()
 	{
+		memset(fPlanes, 0, sizeof(fPlanes));
 	}
 
 	~GlyphCachePool()
 	{
-		GlyphCache* glyph = fGlyphTable.Clear(true);
-		while (glyph != NULL) {
-			GlyphCache* next = glyph->hash_link;
-			delete glyph;
-			glyph = next;
+		for (int32 i = 0; i < kPlaneCount; i++) {
+			GlyphPlane* plane = fPlanes[i];
+			if (plane == NULL)
+				continue;
+
+			for (int32 j = 0; j < kBlockSize; j++) {
+				GlyphBlock* block = plane->blocks[j];
+				if (block == NULL)
+					continue;
+
+				for (int32 k = 0; k < kBlockSize; k++)
+					delete block->glyphs[k];
+				delete block;
+			}
+			delete plane;
 		}
 	}
 
-	status_t Init()
+	const GlyphCache* FindGlyph(uint32 glyphCode) const
 	{
-		return fGlyphTable.Init();
-	}
+		if (glyphCode >= kPlaneCount * kBlockSize * kBlockSize)
+			return NULL;
 
-	const GlyphCache* FindGlyph(uint32 glyphIndex) const
-	{
-		return fGlyphTable.Lookup(glyphIndex);
+		GlyphPlane* plane = atomic_pointer_get(&fPlanes[glyphCode >> 16]);
+		if (plane == NULL)
+			return NULL;
+
+		GlyphBlock* block = atomic_pointer_get(
+			&plane->blocks[(glyphCode >> 8) % kBlockSize]);
+		if (block == NULL)
+			return NULL;
+
+		return atomic_pointer_get(&block->glyphs[glyphCode % kBlockSize]);
 	}
 
-	GlyphCache* CacheGlyph(uint32 glyphIndex,
-		uint32 dataSize, glyph_data_type dataType, const agg::rect_i& bounds,
-		float advanceX, float advanceY, float preciseAdvanceX,
-		float preciseAdvanceY, float insetLeft, float insetRight)
+	/*!	Makes the \a glyph visible to all threads. The pool takes over
+		ownership of it, unless \c false is returned.
+	*/
+	bool InsertGlyph(uint32 glyphCode, GlyphCache* glyph)
 	{
-		GlyphCache* glyph = fGlyphTable.Lookup(glyphIndex);
-		if (glyph != NULL)
-			return NULL;
+		if (glyphCode >= kPlaneCount * kBlockSize * kBlockSize)
+			return false;
 
-		glyph = new(std::nothrow) GlyphCache(glyphIndex, dataSize, dataType,
-			bounds, advanceX, advanceY, preciseAdvanceX, preciseAdvanceY,
-			insetLeft, insetRight);
-		if (glyph == NULL || glyph->data == NULL) {
-			delete glyph;
-			return NULL;
+		// TODO: The pool grows without bounds. We should cleanup
+		// older entries from time to time.
+
+		GlyphPlane*& plane = fPlanes[glyphCode >> 16];
+		if (plane == NULL) {
+			GlyphPlane* newPlane = new(std::nothrow) GlyphPlane;
+			if (newPlane == NULL)
+				return false;
+
+			memset(newPlane, 0, sizeof(GlyphPlane));
+			atomic_pointer_set(&plane, newPlane);
 		}
 
-		// TODO: The HashTable grows without bounds. We should cleanup
-		// older entries from time to time.
+		GlyphBlock*& block = plane->blocks[(glyphCode >> 8) % kBlockSize];
+		if (block == NULL) {
+			GlyphBlock* newBlock = new(std::nothrow) GlyphBlock;
+			if (newBlock == NULL)
+				return false;
 
-		fGlyphTable.Insert(glyph);
+			memset(newBlock, 0, sizeof(GlyphBlock));
+			atomic_pointer_set(&block, newBlock);
+		}
 
-		return glyph;
+		GlyphCache*& slot = block->glyphs[glyphCode % kBlockSize];
+		if (slot != NULL)
+			return false;
+
+		atomic_pointer_set(&slot, glyph);
+		return true;
 	}
 
 private:
-	typedef BOpenHashTable<GlyphHashTableDefinition> GlyphTable;
-
-	GlyphTable	fGlyphTable;
+	GlyphPlane*	fPlanes[kPlaneCount];
 };
 
 
@@ -134,15 +206,20 @@ FontCacheEntry::FontCacheEntry()
 	MultiLocker("FontCacheEntry lock"),
 	fGlyphCache(new(std::nothrow) GlyphCachePool()),
 	fEngine(),
+	fCommonGlyphsCreated(false),
+	fStringWidths(kMaxCachedStringWidths),
 	fLastUsedTime(LONGLONG_MIN),
 	fUseCounter(0)
 {
+	memset(fKerningCache, 0, sizeof(fKerningCache));
+	mutex_init(&fStringWidthLock, "FontCacheEntry string widths");
 }
 
 
 FontCacheEntry::~FontCacheEntry()
 {
 //printf("~FontCacheEntry()\n");
+	mutex_destroy(&fStringWidthLock);
 }
 
 
@@ -164,11 +241,6 @@ FontCacheEntry::Init(const ServerFont& font, bool forceVector)
 			"file %s\n", font.Path());
 		return false;
 	}
-	if (fGlyphCache->Init() != B_OK) {
-		fprintf(stderr, "FontCacheEntry::Init() - failed to allocate "
-			"GlyphCache table for font file %s\n", font.Path());
-		return false;
-	}
 
 	return true;
 }
@@ -260,7 +332,7 @@ render_as_zero_width(uint32 glyphCode)
 const GlyphCache*
 FontCacheEntry::CachedGlyph(uint32 glyphCode)
 {
-	// Only requires a read lock.
+	// Does not require any lock.
 	return fGlyphCache->FindGlyph(glyphCode);
 }
 
@@ -287,6 +359,20 @@ FontCacheEntry::CreateGlyph(uint32 glyphCode, FontCacheEntry* fallbackEntry)
 	// NOTE: Both this and the fallback FontCacheEntry are expected to be
 	// write-locked!
 
+	if (!fCommonGlyphsCreated) {
+		// Create the glyphs most text is made of up front, so that the write
+		// lock does not have to be taken again for each of them.
+		fCommonGlyphsCreated = true;
+		_CreateCommonGlyphs();
+	}
+
+	return _CreateGlyph(glyphCode, fallbackEntry);
+}
+
+
+const GlyphCache*
+FontCacheEntry::_CreateGlyph(uint32 glyphCode, FontCacheEntry* fallbackEntry)
+{
 	const GlyphCache* glyph = fGlyphCache->FindGlyph(glyphCode);
 	if (glyph != NULL)
 		return glyph;
@@ -303,8 +389,15 @@ FontCacheEntry::CreateGlyph(uint32 glyphCode, FontCacheEntry* fallbackEntry)
 	if (glyphIndex == 0) {
 		if (render_as_zero_width(glyphCode)) {
 			// cache and return a zero width glyph
-			return fGlyphCache->CacheGlyph(glyphCode, 0, glyph_data_invalid,
-				agg::rect_i(0, 0, -1, -1), 0, 0, 0, 0, 0, 0);
+			GlyphCache* emptyGlyph = new(std::nothrow) GlyphCache(glyphCode,
+				0, glyph_data_invalid, agg::rect_i(0, 0, -1, -1), 0, 0, 0, 0,
+				0, 0);
+			if (emptyGlyph == NULL
+				|| !fGlyphCache->InsertGlyph(glyphCode, emptyGlyph)) {
+				delete emptyGlyph;
+				return NULL;
+			}
+			return emptyGlyph;
 		}
 
 		// reset to our engine
@@ -318,18 +411,40 @@ FontCacheEntry::CreateGlyph(uint32 glyphCode, FontCacheEntry* fallbackEntry)
 		}
 	}
 
-	if (engine->PrepareGlyph(glyphIndex)) {
-		glyph = fGlyphCache->CacheGlyph(glyphCode,
-			engine->DataSize(), engine->DataType(), engine->Bounds(),
-			engine->AdvanceX(), engine->AdvanceY(),
-			engine->PreciseAdvanceX(), engine->PreciseAdvanceY(),
-			engine->InsetLeft(), engine->InsetRight());
+	if (!engine->PrepareGlyph(glyphIndex))
+		return NULL;
+
+	GlyphCache* newGlyph = new(std::nothrow) GlyphCache(glyphCode,
+		engine->DataSize(), engine->DataType(), engine->Bounds(),
+		engine->AdvanceX(), engine->AdvanceY(),
+		engine->PreciseAdvanceX(), engine->PreciseAdvanceY(),
+		engine->InsetLeft(), engine->InsetRight());
+	if (newGlyph == NULL || newGlyph->data == NULL) {
+		delete newGlyph;
+		return NULL;
+	}
+
+	// The glyph must be complete before it is inserted, as it can be used
+	// by other threads right away.
+	engine->WriteGlyphTo(newGlyph->data);
 
-		if (glyph != NULL)
-			engine->WriteGlyphTo(glyph->data);
+	if (!fGlyphCache->InsertGlyph(glyphCode, newGlyph)) {
+		delete newGlyph;
+		return NULL;
 	}
 
-	return glyph;
+	return newGlyph;
+}
+
+
+void
+FontCacheEntry::_CreateCommonGlyphs()
+{
+	for (uint32 glyphCode = kFirstCommonGlyph; glyphCode <= kLastCommonGlyph;
+			glyphCode++) {
+		if (fEngine.GlyphIndexForGlyphCode(glyphCode) != 0)
+			_CreateGlyph(glyphCode, NULL);
+	}
 }
 
 
@@ -365,11 +480,83 @@ FontCacheEntry::InitAdaptors(const GlyphCache* glyph,
 }
 
 
+/*!	Adds the kerning of the glyph pair to \a x and \a y. Pairs that were
+	looked up before are found in a small cache that does not require any
+	lock, as this is called for every glyph of a string; only the engine
+	must not be used while another thread creates glyphs.
+*/
 bool
 FontCacheEntry::GetKerning(uint32 glyphCode1, uint32 glyphCode2,
 	double* x, double* y)
 {
-	return fEngine.GetKerning(glyphCode1, glyphCode2, x, y);
+	int64* slot = NULL;
+	if (glyphCode1 < (1UL << kKerningCodeBits)
+		&& glyphCode2 < (1UL << kKerningCodeBits)) {
+		slot = &fKerningCache[(glyphCode1 * 31 + glyphCode2)
+			% kKerningCacheSize];
+
+		uint64 value = (uint64)atomic_get64(slot);
+		if ((value & kKerningKnown) != 0 && value >> (kKerningDeltaBits
+				+ kKerningDeltaShift) == kerning_key(glyphCode1, glyphCode2)) {
+			if ((value & kKerningPresent) == 0)
+				return false;
+
+			// sign extend the delta
+			int32 delta = (int32)(value << (64 - kKerningDeltaBits
+				- kKerningDeltaShift) >> 32) >> (32 - kKerningDeltaBits);
+			*x += delta / 64.0;
+			return true;
+		}
+	}
+
+	double deltaX = 0.0;
+	double deltaY = 0.0;
+	bool hasKerning;
+	{
+		AutoReadLocker _(this);
+		hasKerning = fEngine.GetKerning(glyphCode1, glyphCode2, &deltaX,
+			&deltaY);
+	}
+
+	*x += deltaX;
+	*y += deltaY;
+
+	// Only horizontal kerning is cached, which is all that fonts usually have
+	int32 delta = (int32)(deltaX * 64);
+	if (slot != NULL && deltaY == 0.0 && delta == deltaX * 64
+		&& delta >= -(1L << (kKerningDeltaBits - 1))
+		&& delta < (1L << (kKerningDeltaBits - 1))) {
+		uint64 value = kerning_key(glyphCode1, glyphCode2)
+				<< (kKerningDeltaBits + kKerningDeltaShift)
+			| ((uint64)delta & ((1ULL << kKerningDeltaBits) - 1))
+				<< kKerningDeltaShift
+			| (hasKerning ? kKerningPresent : 0) | kKerningKnown;
+		atomic_set64(slot, (int64)value);
+	}
+
+	return hasKerning;
+}
+
+
+/*!	Returns the width of the string as it was measured before. The widths
+	are only valid for this entry, which determines the font, size, and the
+	rendering settings, and they do not include any escapement deltas.
+*/
+bool
+FontCacheEntry::CachedStringWidth(const char* string, int32 length,
+	uint8 spacing, float& _width)
+{
+	MutexLocker _(&fStringWidthLock);
+	return fStringWidths.Get(0, spacing, string, length, _width);
+}
+
+
+void
+FontCacheEntry::CacheStringWidth(const char* string, int32 length,
+	uint8 spacing, float width)
+{
+	MutexLocker _(&fStringWidthLock);
+	fStringWidths.Put(0, spacing, string, length, width);
 }
 
 
@@ -393,15 +580,23 @@ FontCacheEntry::GenerateSignature(char* signature, size_t signatureSize,
 void
 FontCacheEntry::UpdateUsage()
 {
-	// this is a static lock to prevent usage of too many semaphores,
-	// but on the other hand, it is not so nice to be using a lock
-	// here at all
-	// the hope is that the time is so short to hold this lock, that
-	// there is not much contention
-	BAutolock _(sUsageUpdateLock);
-
-	fLastUsedTime = system_time();
-	fUseCounter++;
+	// This is called whenever a string was drawn, so it does not use a lock.
+	atomic_set64(&fLastUsedTime, system_time());
+	atomic_add64((int64*)&fUseCounter, 1);
+}
+
+
+bigtime_t
+FontCacheEntry::LastUsed() const
+{
+	return atomic_get64((int64*)&fLastUsedTime);
+}
+
+
+uint64
+FontCacheEntry::UsedCount() const
+{
+	return atomic_get64((int64*)&fUseCounter);
 }
 
 
@@ -28,7 +28,7 @@
 
 
 #include <AutoDeleter.h>
-#include <Locker.h>
+#include <StringWidthCache.h>
 
 #include <agg_conv_curve.h>
 #include <agg_conv_contour.h>
@@ -57,8 +57,7 @@ struct GlyphCache {
 		precise_advance_x(preciseAdvanceX),
 		precise_advance_y(preciseAdvanceY),
 		inset_left(insetLeft),
-		inset_right(insetRight),
-		hash_link(NULL)
+		inset_right(insetRight)
 	{
 	}
 
@@ -78,8 +77,6 @@ struct GlyphCache {
 	float			precise_advance_y;
 	float			inset_left;
 	float			inset_right;
-
-	GlyphCache*		hash_link;
 };
 
 class FontCache;
@@ -125,16 +122,20 @@ class FontCacheEntry : public MultiLocker, public BReferenceable {
 			bool				GetKerning(uint32 glyphCode1,
 									uint32 glyphCode2, double* x, double* y);
 
+			bool				CachedStringWidth(const char* string,
+									int32 length, uint8 spacing,
+									float& _width);
+			void				CacheStringWidth(const char* string,
+									int32 length, uint8 spacing, float width);
+
 	static	void				GenerateSignature(char* signature,
 									size_t signatureSize,
 									const ServerFont& font, bool forceVector);
 
 	// private to FontCache class:
 			void				UpdateUsage();
-			bigtime_t			LastUsed() const
-									{ return fLastUsedTime; }
-			uint64				UsedCount() const
-									{ return fUseCounter; }
+			bigtime_t			LastUsed() const;
+			uint64				UsedCount() const;
 
  private:
 								FontCacheEntry(const FontCacheEntry&);
@@ -143,13 +144,28 @@ class FontCacheEntry : public MultiLocker, public BReferenceable {
 	static	glyph_rendering		_RenderTypeFor(const ServerFont& font,
 									bool forceVector);
 
+			const GlyphCache*	_CreateGlyph(uint32 glyphCode,
+									FontCacheEntry* fallbackEntry);
+			void				_CreateCommonGlyphs();
+
 			class GlyphCachePool;
 
+			enum {
+				kKerningCacheSize = 512
+			};
+
 			ObjectDeleter<GlyphCachePool>
 								fGlyphCache;
 			FontEngine			fEngine;
+			bool				fCommonGlyphsCreated;
+
+			int64				fKerningCache[kKerningCacheSize];
+				// recently used glyph pairs and their kerning, see
+				// GetKerning()
+
+			mutex				fStringWidthLock;
+			StringWidthCache	fStringWidths;
 
-	static	BLocker				sUsageUpdateLock;
 			bigtime_t			fLastUsedTime;
 			uint64				fUseCounter;
 };
@@ -23,6 +23,10 @@
 
 #include <ctype.h>
 
+/*!	Keeps a FontCacheEntry in use. Glyphs can be looked up without holding
+	any lock, so only creating new glyphs requires the entry to be locked, for
+	writing.
+*/
 class FontCacheReference {
 public:
 	FontCacheReference()
@@ -48,12 +52,7 @@ public:
 		} else if (fCacheEntry != NULL)
 			Unset();
 
-		if (writeLock) {
-			if (!entry->WriteLock()) {
-				FontCache::Default()->Recycle(entry);
-				return false;
-			}
-		} else if (!entry->ReadLock()) {
+		if (writeLock && !entry->WriteLock()) {
 			FontCache::Default()->Recycle(entry);
 			return false;
 		}
@@ -70,8 +69,6 @@ public:
 
 		if (fWriteLocked)
 			fCacheEntry->WriteUnlock();
-		else
-			fCacheEntry->ReadUnlock();
 
 		FontCacheEntry* entry = fCacheEntry;
 		fCacheEntry = NULL;
@@ -199,7 +196,7 @@ GlyphLayoutEngine::LayoutGlyphs(GlyphConsumer& consumer,
 			return false;
 		if (!pCacheReference->SetTo(entry, false))
 			return false;
-	} // else the entry was already used and is still locked
+	} // else the entry was already used and is still referenced
 
 	consumer.Start();
 
@@ -291,12 +288,18 @@ GlyphLayoutEngine::_CreateGlyph(FontCacheReference& cacheReference,
 {
 	FontCacheEntry* entry = cacheReference.Entry();
 
-	// Avoid loading and locking the fallbacks if our font can create the glyph.
-	if (entry->CanCreateGlyph(charCode)) {
-		if (cacheReference.SetTo(entry, true))
-			return entry->CreateGlyph(charCode);
+	if (!cacheReference.SetTo(entry, true))
 		return NULL;
-	}
+
+	// Another thread might have created the glyph while we were waiting for
+	// the lock.
+	const GlyphCache* glyph = entry->CachedGlyph(charCode);
+	if (glyph != NULL)
+		return glyph;
+
+	// Avoid loading and locking the fallbacks if our font can create the glyph.
+	if (entry->CanCreateGlyph(charCode))
+		return entry->CreateGlyph(charCode);
 
 	if (fallbacks.IsEmpty()) {
 		// We need to create new glyphs with the engine of the fallback font
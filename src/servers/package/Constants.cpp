@@ -14,6 +14,9 @@ const char* const kAdminDirectoryName = PACKAGES_DIRECTORY_ADMIN_DIRECTORY;
 const char* const kActivationFileName = PACKAGES_DIRECTORY_ACTIVATION_FILE;
 const char* const kTemporaryActivationFileName
 	= PACKAGES_DIRECTORY_ACTIVATION_FILE ".tmp";
+const char* const kTOCCacheFileName = PACKAGES_DIRECTORY_TOC_CACHE_FILE;
+const char* const kTemporaryTOCCacheFileName
+	= PACKAGES_DIRECTORY_TOC_CACHE_FILE ".tmp";
 const char* const kFirstBootProcessingNeededFileName
 	= "FirstBootProcessingNeeded";
 const char* const kWritableFilesDirectoryName = "writable-files";
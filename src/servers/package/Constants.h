@@ -13,6 +13,8 @@ extern const char* const kPackageFileNameExtension;
 extern const char* const kAdminDirectoryName;
 extern const char* const kActivationFileName;
 extern const char* const kTemporaryActivationFileName;
+extern const char* const kTOCCacheFileName;
+extern const char* const kTemporaryTOCCacheFileName;
 extern const char* const kFirstBootProcessingNeededFileName;
 extern const char* const kWritableFilesDirectoryName;
 extern const char* const kPackageFileAttribute;
@@ -11,6 +11,7 @@
 #include "Volume.h"
 
 #include <errno.h>
+#include <fcntl.h>
 #include <stdlib.h>
 #include <sys/stat.h>
 #include <time.h>
@@ -28,6 +29,7 @@
 
 #include <package/CommitTransactionResult.h>
 #include <package/PackageRoster.h>
+#include <package/hpkg/StandardErrorOutput.h>
 #include <package/solver/Solver.h>
 #include <package/solver/SolverPackage.h>
 #include <package/solver/SolverProblem.h>
@@ -39,6 +41,8 @@
 #include <AutoLocker.h>
 #include <NotOwningEntryRef.h>
 #include <package/DaemonDefs.h>
+#include <package/hpkg/PackageTOCCacheReader.h>
+#include <package/hpkg/PackageTOCCacheWriter.h>
 #include <RosterPrivate.h>
 
 #include "CommitTransactionHandler.h"
@@ -52,6 +56,10 @@
 
 using namespace BPackageKit::BPrivate;
 
+using BPackageKit::BHPKG::BStandardErrorOutput;
+using BPackageKit::BHPKG::BPrivate::PackageTOCCacheReader;
+using BPackageKit::BHPKG::BPrivate::PackageTOCCacheWriter;
+
 
 // #pragma mark - Listener
 
@@ -345,6 +353,8 @@ Volume::InitPackages(Listener* listener)
 	if (error != B_OK)
 		RETURN_ERROR(error);
 
+	_UpdateTOCCache();
+
 	// First boot processing requested by a magic file left by the OS installer?
 	BEntry flagFileEntry(&adminDirectory, kFirstBootProcessingNeededFileName);
 	if (createdAdminDirectory || flagFileEntry.Exists()) {
@@ -1503,6 +1513,101 @@ Volume::_CommitTransaction(BMessage* message,
 	_result.SetError(error);
 
 	// revert on error
-	if (error != B_TRANSACTION_OK)
+	if (error != B_TRANSACTION_OK) {
 		handler.Revert();
+		return;
+	}
+
+	_UpdateTOCCache();
+}
+
+
+/*!	Brings the package TOC cache packagefs uses at mount time up to date with
+	the latest state. Failing to do so is not fatal; packagefs falls back to
+	reading the package files.
+*/
+void
+Volume::_UpdateTOCCache()
+{
+	BDirectory packagesDirectory;
+	status_t error = packagesDirectory.SetTo(&PackagesDirectoryRef());
+	BDirectory adminDirectory;
+	if (error == B_OK) {
+		error = _OpenPackagesSubDirectory(RelativePath(kAdminDirectoryName),
+			false, adminDirectory);
+	}
+	if (error != B_OK) {
+		ERROR("Volume::_UpdateTOCCache(): failed to open packages "
+			"directory: %s\n", strerror(error));
+		return;
+	}
+
+	int packagesDirectoryFD = packagesDirectory.Dup();
+	int adminDirectoryFD = adminDirectory.Dup();
+	FileDescriptorCloser packagesDirectoryFDCloser(packagesDirectoryFD);
+	FileDescriptorCloser adminDirectoryFDCloser(adminDirectoryFD);
+	if (packagesDirectoryFD < 0 || adminDirectoryFD < 0)
+		return;
+
+	BStandardErrorOutput errorOutput;
+
+	// read the current cache, so we only need to parse the new packages
+	PackageTOCCacheReader previousCache(&errorOutput);
+	bool havePreviousCache = false;
+	int fd = openat(adminDirectoryFD, kTOCCacheFileName, O_RDONLY);
+	if (fd >= 0) {
+		havePreviousCache = previousCache.Init(fd) == B_OK;
+		close(fd);
+	}
+
+	PackageTOCCacheWriter writer(&errorOutput);
+	error = writer.Init(havePreviousCache ? &previousCache : NULL);
+	if (error != B_OK)
+		return;
+
+	for (PackageFileNameHashTable::Iterator it
+			= fLatestState->ByFileNameIterator();
+		Package* package = it.Next();) {
+		if (!package->IsActive())
+			continue;
+
+		error = writer.AddPackage(packagesDirectoryFD,
+			package->FileName().String());
+		if (error != B_OK) {
+			ERROR("Volume::_UpdateTOCCache(): failed to add package \"%s\": "
+				"%s\n", package->FileName().String(), strerror(error));
+			return;
+		}
+	}
+
+	if (havePreviousCache && !writer.HasChanges())
+		return;
+
+	// write the new cache and replace the old one
+	fd = openat(adminDirectoryFD, kTemporaryTOCCacheFileName,
+		O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		ERROR("Volume::_UpdateTOCCache(): failed to create \"%s\": %s\n",
+			kTemporaryTOCCacheFileName, strerror(errno));
+		return;
+	}
+
+	error = writer.Finish(fd);
+	close(fd);
+	if (error == B_OK
+		&& renameat(adminDirectoryFD, kTemporaryTOCCacheFileName,
+			adminDirectoryFD, kTOCCacheFileName) != 0) {
+		error = errno;
+	}
+
+	if (error != B_OK) {
+		ERROR("Volume::_UpdateTOCCache(): failed to write \"%s\": %s\n",
+			kTOCCacheFileName, strerror(error));
+		unlinkat(adminDirectoryFD, kTemporaryTOCCacheFileName, 0);
+		return;
+	}
+
+	INFORM("Volume::_UpdateTOCCache(): wrote the cache for %" B_PRId32
+		" packages (%" B_PRId32 " reused)\n", writer.CountPackages(),
+		writer.CountReusedPackages());
 }
@@ -182,6 +182,8 @@ private:
 									const PackageSet& packagesAlreadyRemoved,
 									BCommitTransactionResult& _result);
 
+			void				_UpdateTOCCache();
+
 	static	void				_CollectPackageNamesAdded(
 									const VolumeState* oldState,
 									const VolumeState* newState,
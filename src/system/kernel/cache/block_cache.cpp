@@ -10,6 +10,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <sys/uio.h>
 
 #include <KernelExport.h>
 #include <fs_cache.h>
@@ -24,12 +25,18 @@
 #include <util/AutoLock.h>
 #include <vm/vm_page.h>
 
+#ifdef _KERNEL_MODE
+#	include <vfs.h>
+
+#	include "IORequest.h"
+#endif
+
 #include "kernel_debug_config.h"
 
 
 // TODO: this is a naive but growing implementation to test the API:
-//	block reading/writing is not at all optimized for speed, it will
-//	just read and write single blocks.
+//	block reading is not at all optimized for speed, it will just read
+//	single blocks.
 // TODO: the retrieval/copy of the original data could be delayed until the
 //		new data must be written, ie. in low memory situations.
 
@@ -53,6 +60,10 @@
 
 static const bigtime_t kTransactionIdleTime = 2000000LL;
 	// a transaction is considered idle after 2 seconds of inactivity
+static const size_t kMaxRunBlocks = 64;
+	// the maximum number of contiguous blocks combined into a single write
+static const int32 kMaxPendingRuns = 8;
+	// the maximum number of writes a BlockWriter has in flight at once
 
 
 namespace {
@@ -192,6 +203,59 @@ struct BlockHash {
 typedef BOpenHashTable<BlockHash> BlockTable;
 
 
+/*!	The block hash of a cache, split into independently locked shards.
+	Changing the table requires both the cache lock, and the write lock of the
+	affected shard. Everyone holding the cache lock may therefore look up and
+	iterate blocks without further locking, while block_cache_get_etc() and
+	block_cache_put() can look up blocks with just a shard read lock, see
+	try_get_referenced_block().
+*/
+class BlockShardTable {
+public:
+								BlockShardTable();
+								~BlockShardTable();
+
+			status_t			Init(size_t initialSize);
+
+			cached_block*		Lookup(off_t blockNumber);
+			void				Insert(cached_block* block);
+			void				Remove(cached_block* block);
+			cached_block*		Clear();
+
+			rw_lock&			ShardLock(off_t blockNumber)
+									{ return _ShardFor(blockNumber).lock; }
+
+	class Iterator {
+	public:
+								Iterator(BlockShardTable* table);
+
+			bool				HasNext() const
+									{ return fIterator.HasNext(); }
+			cached_block*		Next();
+
+	private:
+			void				_SkipEmptyShards();
+
+			BlockShardTable*	fTable;
+			uint32				fShard;
+			BlockTable::Iterator fIterator;
+	};
+
+private:
+	struct block_shard {
+		rw_lock			lock;
+		BlockTable		table;
+	};
+
+	static	const uint32		kShardShift = 4;
+	static	const uint32		kShardCount = 1 << kShardShift;
+
+			block_shard&		_ShardFor(off_t blockNumber);
+
+			block_shard			fShards[kShardCount];
+};
+
+
 struct TransactionHash {
 	typedef int32				KeyType;
 	typedef	cache_transaction	ValueType;
@@ -210,7 +274,7 @@ typedef BOpenHashTable<TransactionHash> TransactionTable;
 
 
 struct block_cache : DoublyLinkedListLinkImpl<block_cache> {
-	BlockTable*		hash;
+	BlockShardTable	hash;
 	mutex			lock;
 	int				fd;
 	off_t			max_blocks;
@@ -302,6 +366,10 @@ public:
 
 private:
 			void*				_Data(cached_block* block) const;
+			size_t				_RunLength(size_t first) const;
+			status_t			_WriteRun(size_t first, size_t count);
+			void				_RunFailed(size_t first, size_t count,
+									status_t status);
 			status_t			_WriteBlock(cached_block* block);
 			void				_BlockDone(cached_block* block,
 									cache_transaction* transaction);
@@ -310,6 +378,30 @@ private:
 	static	int					_CompareBlocks(const void* _blockA,
 									const void* _blockB);
 
+#ifdef _KERNEL_MODE
+			class PendingRun;
+
+			void				_ScheduleRun(size_t first, size_t count);
+			PendingRun*			_FreeRun();
+			void				_WaitForRuns(int32 maxPending);
+			void				_FinishRuns();
+			void				_RunFinished(PendingRun* run,
+									status_t status);
+
+			class PendingRun : public AsyncIOCallback {
+			public:
+				virtual	void	IOFinished(status_t status,
+									bool partialTransfer,
+									generic_size_t bytesTransferred);
+
+				BlockWriter*	writer;
+				size_t			first;
+				size_t			count;
+				status_t		status;
+				bool			busy;
+			};
+#endif
+
 private:
 	static	const size_t		kBufferSize = 64;
 
@@ -322,6 +414,13 @@ private:
 			size_t				fMax;
 			status_t			fStatus;
 			bool				fDeletedTransaction;
+
+#ifdef _KERNEL_MODE
+			PendingRun			fRuns[kMaxPendingRuns];
+			int32				fPendingRuns;
+			spinlock			fRunLock;
+			ConditionVariable	fRunCondition;
+#endif
 };
 
 
@@ -1089,6 +1188,124 @@ cached_block::CanBeWritten() const
 }
 
 
+//	#pragma mark - BlockShardTable
+
+
+BlockShardTable::BlockShardTable()
+{
+	for (uint32 i = 0; i < kShardCount; i++)
+		rw_lock_init(&fShards[i].lock, "block cache shard");
+}
+
+
+BlockShardTable::~BlockShardTable()
+{
+	for (uint32 i = 0; i < kShardCount; i++)
+		rw_lock_destroy(&fShards[i].lock);
+}
+
+
+status_t
+BlockShardTable::Init(size_t initialSize)
+{
+	for (uint32 i = 0; i < kShardCount; i++) {
+		status_t status = fShards[i].table.Init(initialSize / kShardCount);
+		if (status != B_OK)
+			return status;
+	}
+
+	return B_OK;
+}
+
+
+cached_block*
+BlockShardTable::Lookup(off_t blockNumber)
+{
+	return _ShardFor(blockNumber).table.Lookup(blockNumber);
+}
+
+
+void
+BlockShardTable::Insert(cached_block* block)
+{
+	block_shard& shard = _ShardFor(block->block_number);
+	WriteLocker locker(shard.lock);
+	shard.table.Insert(block);
+}
+
+
+void
+BlockShardTable::Remove(cached_block* block)
+{
+	block_shard& shard = _ShardFor(block->block_number);
+	WriteLocker locker(shard.lock);
+	shard.table.Remove(block);
+}
+
+
+/*!	Removes all blocks from the table, and returns them as a list linked
+	via cached_block::next.
+*/
+cached_block*
+BlockShardTable::Clear()
+{
+	cached_block* first = NULL;
+
+	for (uint32 i = 0; i < kShardCount; i++) {
+		WriteLocker locker(fShards[i].lock);
+
+		cached_block* block = fShards[i].table.Clear(true);
+		while (block != NULL) {
+			cached_block* next = block->next;
+			block->next = first;
+			first = block;
+			block = next;
+		}
+	}
+
+	return first;
+}
+
+
+BlockShardTable::block_shard&
+BlockShardTable::_ShardFor(off_t blockNumber)
+{
+	// The tables themselves use the lower bits of the block number, so we
+	// need to use different ones to choose the shard.
+	uint32 hash = (uint32)(blockNumber ^ (blockNumber >> 32)) * 2654435761U;
+	return fShards[hash >> (32 - kShardShift)];
+}
+
+
+BlockShardTable::Iterator::Iterator(BlockShardTable* table)
+	:
+	fTable(table),
+	fShard(0),
+	fIterator(&table->fShards[0].table)
+{
+	_SkipEmptyShards();
+}
+
+
+cached_block*
+BlockShardTable::Iterator::Next()
+{
+	cached_block* block = fIterator.Next();
+	_SkipEmptyShards();
+	return block;
+}
+
+
+void
+BlockShardTable::Iterator::_SkipEmptyShards()
+{
+	while (!fIterator.HasNext() && fShard + 1 < kShardCount) {
+		fShard++;
+		fIterator = BlockTable::Iterator(&fTable->fShards[fShard].table);
+	}
+}
+
+
 //	#pragma mark - BlockWriter
 
 
@@ -1103,6 +1320,16 @@ BlockWriter::BlockWriter(block_cache* cache, size_t max)
 	fStatus(B_OK),
 	fDeletedTransaction(false)
 {
+#ifdef _KERNEL_MODE
+	for (int32 i = 0; i < kMaxPendingRuns; i++) {
+		fRuns[i].writer = this;
+		fRuns[i].count = 0;
+		fRuns[i].busy = false;
+	}
+	fPendingRuns = 0;
+	B_INITIALIZE_SPINLOCK(&fRunLock);
+	fRunCondition.Init(this, "block writer");
+#endif
 }
 
 
@@ -1205,27 +1432,37 @@ BlockWriter::Write(cache_transaction* transaction, bool canUnlock)
 	if (canUnlock)
 		mutex_unlock(&fCache->lock);
 
-	// Sort blocks in their on-disk order
-	// TODO: ideally, this should be handled by the I/O scheduler
+	// Sort blocks in their on-disk order, so that contiguous blocks can be
+	// combined into a single write. When there is more than one such run, the
+	// runs are issued asynchronously, and are left to the I/O scheduler.
 
 	qsort(fBlocks, fCount, sizeof(void*), &_CompareBlocks);
 	fDeletedTransaction = false;
 
 	bigtime_t start = system_time();
 
-	for (uint32 i = 0; i < fCount; i++) {
-		status_t status = _WriteBlock(fBlocks[i]);
-		if (status != B_OK) {
-			// propagate to global error handling
-			if (fStatus == B_OK)
-				fStatus = status;
+	for (size_t first = 0; first < fCount;) {
+		size_t count = _RunLength(first);
 
-			_UnmarkWriting(fBlocks[i]);
-			fBlocks[i] = NULL;
-				// This block will not be marked clean
+#ifdef _KERNEL_MODE
+		if (count < fCount) {
+			_ScheduleRun(first, count);
+			first += count;
+			continue;
 		}
+#endif
+
+		status_t status = _WriteRun(first, count);
+		if (status != B_OK)
+			_RunFailed(first, count, status);
+
+		first += count;
 	}
 
+#ifdef _KERNEL_MODE
+	_FinishRuns();
+#endif
+
 	bigtime_t finish = system_time();
 
 	if (canUnlock)
@@ -1270,6 +1507,83 @@ BlockWriter::_Data(cached_block* block) const
 }
 
 
+/*!	Returns the number of blocks starting at index \a first that are
+	contiguous on disk, and can therefore be written back at once.
+*/
+size_t
+BlockWriter::_RunLength(size_t first) const
+{
+	size_t count = 1;
+	while (first + count < fCount && count < kMaxRunBlocks
+		&& fBlocks[first + count]->block_number
+			== fBlocks[first + count - 1]->block_number + 1) {
+		count++;
+	}
+
+	return count;
+}
+
+
+/*!	Synchronously writes back the \a count contiguous blocks starting at index
+	\a first with a single request.
+*/
+status_t
+BlockWriter::_WriteRun(size_t first, size_t count)
+{
+	if (count == 1)
+		return _WriteBlock(fBlocks[first]);
+
+	size_t blockSize = fCache->block_size;
+	iovec vecs[kMaxRunBlocks];
+
+	for (size_t i = 0; i < count; i++) {
+		cached_block* block = fBlocks[first + i];
+		ASSERT(block->busy_writing);
+
+		TB(Write(fCache, block));
+		TB2(BlockData(fCache, block, "before write"));
+
+		vecs[i].iov_base = _Data(block);
+		vecs[i].iov_len = blockSize;
+	}
+
+	TRACE(("BlockWriter::_WriteRun(blocks %" B_PRIdOFF " - %" B_PRIdOFF ")\n",
+		fBlocks[first]->block_number,
+		fBlocks[first + count - 1]->block_number));
+
+	ssize_t written = writev_pos(fCache->fd,
+		fBlocks[first]->block_number * blockSize, vecs, count);
+	if (written != (ssize_t)(count * blockSize))
+		return written < 0 ? errno : B_IO_ERROR;
+
+	return B_OK;
+}
+
+
+/*!	Writing back the \a count blocks starting at index \a first failed with
+	\a status. Writes the blocks back one by one, so that only those blocks
+	that actually could not be written stay dirty.
+*/
+void
+BlockWriter::_RunFailed(size_t first, size_t count, status_t status)
+{
+	for (size_t i = first; i < first + count; i++) {
+		if (count > 1)
+			status = _WriteBlock(fBlocks[i]);
+		if (status == B_OK)
+			continue;
+
+		// propagate to global error handling
+		if (fStatus == B_OK)
+			fStatus = status;
+
+		_UnmarkWriting(fBlocks[i]);
+		fBlocks[i] = NULL;
+			// This block will not be marked clean
+	}
+}
+
+
 status_t
 BlockWriter::_WriteBlock(cached_block* block)
 {
@@ -1391,13 +1705,158 @@ BlockWriter::_CompareBlocks(const void* _blockA, const void* _blockB)
 }
 
 
+#ifdef _KERNEL_MODE
+
+
+/*!	Issues an asynchronous write of the \a count contiguous blocks starting at
+	index \a first. If there are already kMaxPendingRuns writes in flight, this
+	waits until one of them has finished.
+*/
+void
+BlockWriter::_ScheduleRun(size_t first, size_t count)
+{
+	PendingRun* run = _FreeRun();
+
+	size_t blockSize = fCache->block_size;
+	generic_io_vec vecs[kMaxRunBlocks];
+
+	for (size_t i = 0; i < count; i++) {
+		cached_block* block = fBlocks[first + i];
+		ASSERT(block->busy_writing);
+
+		TB(Write(fCache, block));
+		TB2(BlockData(fCache, block, "before write"));
+
+		vecs[i].base = (addr_t)_Data(block);
+		vecs[i].length = blockSize;
+	}
+
+	IORequest* request = IORequest::Create(false);
+	status_t status = request != NULL
+		? request->Init(fBlocks[first]->block_number * blockSize, vecs, count,
+			count * blockSize, true, B_DELETE_IO_REQUEST)
+		: B_NO_MEMORY;
+	if (status != B_OK) {
+		delete request;
+
+		// fall back to writing the blocks synchronously
+		status = _WriteRun(first, count);
+		if (status != B_OK)
+			_RunFailed(first, count, status);
+		return;
+	}
+
+	run->first = first;
+	run->count = count;
+	run->status = B_OK;
+
+	InterruptsSpinLocker locker(fRunLock);
+	run->busy = true;
+	fPendingRuns++;
+	locker.Unlock();
+
+	request->SetFinishedCallback(&AsyncIOCallback::IORequestCallback, run);
+	do_fd_io(fCache->fd, request);
+		// the request always notifies its callback, even on failure
+}
+
+
+/*!	Returns an unused run slot, waiting for a pending write to finish if
+	necessary.
+*/
+BlockWriter::PendingRun*
+BlockWriter::_FreeRun()
+{
+	_WaitForRuns(kMaxPendingRuns - 1);
+
+	InterruptsSpinLocker locker(fRunLock);
+	for (int32 i = 0; i < kMaxPendingRuns; i++) {
+		PendingRun& run = fRuns[i];
+		if (run.busy)
+			continue;
+
+		locker.Unlock();
+
+		if (run.count != 0 && run.status != B_OK)
+			_RunFailed(run.first, run.count, run.status);
+		run.count = 0;
+		return &run;
+	}
+
+	panic("BlockWriter: no free run slot");
+	return NULL;
+}
+
+
+void
+BlockWriter::_WaitForRuns(int32 maxPending)
+{
+	InterruptsSpinLocker locker(fRunLock);
+
+	while (fPendingRuns > maxPending) {
+		ConditionVariableEntry entry;
+		fRunCondition.Add(&entry);
+
+		locker.Unlock();
+		entry.Wait();
+		locker.Lock();
+	}
+}
+
+
+/*!	Waits for all pending writes to finish, and retries the failed ones block
+	by block.
+*/
+void
+BlockWriter::_FinishRuns()
+{
+	_WaitForRuns(0);
+
+	for (int32 i = 0; i < kMaxPendingRuns; i++) {
+		PendingRun& run = fRuns[i];
+		if (run.count != 0 && run.status != B_OK)
+			_RunFailed(run.first, run.count, run.status);
+		run.count = 0;
+	}
+}
+
+
+void
+BlockWriter::_RunFinished(PendingRun* run, status_t status)
+{
+	InterruptsSpinLocker locker(fRunLock);
+
+	run->status = status;
+	run->busy = false;
+	fPendingRuns--;
+
+	fRunCondition.NotifyAll();
+}
+
+
+void
+BlockWriter::PendingRun::IOFinished(status_t status, bool partialTransfer,
+	generic_size_t bytesTransferred)
+{
+	if (status == B_OK && partialTransfer)
+		status = B_IO_ERROR;
+
+	TRACE(("BlockWriter::PendingRun::IOFinished(blocks %" B_PRIuSIZE
+		", status %" B_PRId32 ")\n", count, status));
+
+	writer->_RunFinished(this, status);
+}
+
+
+#endif	// _KERNEL_MODE
+
+
 //	#pragma mark - block_cache
 
 
 block_cache::block_cache(int _fd, off_t numBlocks, size_t blockSize,
 		bool readOnly)
 	:
-	hash(NULL),
 	fd(_fd),
 	max_blocks(numBlocks),
 	block_size(blockSize),
@@ -1424,7 +1883,6 @@ block_cache::~block_cache()
 	unregister_low_resource_handler(&_LowMemoryHandler, this);
 
 	delete transaction_hash;
-	delete hash;
 
 	delete_object_cache(buffer_cache);
 
@@ -1445,8 +1903,7 @@ block_cache::Init()
 	if (buffer_cache == NULL)
 		return B_NO_MEMORY;
 
-	hash = new BlockTable();
-	if (hash == NULL || hash->Init(1024) != B_OK)
+	if (hash.Init(1024) != B_OK)
 		return B_NO_MEMORY;
 
 	transaction_hash = new(std::nothrow) TransactionTable();
@@ -1606,7 +2063,7 @@ block_cache::RemoveUnusedBlocks(int32 count, int32 minSecondsOld)
 void
 block_cache::RemoveBlock(cached_block* block)
 {
-	hash->Remove(block);
+	hash.Remove(block);
 	FreeBlock(block);
 }
 
@@ -1698,7 +2155,7 @@ block_cache::_GetUnusedBlock()
 		// remove block from lists
 		iterator.Remove();
 		unused_block_count--;
-		hash->Remove(block);
+		hash.Remove(block);
 
 		ASSERT(block->original_data == NULL && block->parent_data == NULL);
 		block->unused = false;
@@ -1854,7 +2311,7 @@ put_cached_block(block_cache* cache, cached_block* block)
 		return;
 	}
 
-	if (--block->ref_count == 0
+	if (atomic_add(&block->ref_count, -1) == 1
 		&& block->transaction == NULL && block->previous_transaction == NULL) {
 		// This block is not used anymore, and not part of any transaction
 		block->is_writing = false;
@@ -1882,7 +2339,7 @@ put_cached_block(block_cache* cache, off_t blockNumber)
 			blockNumber, cache->max_blocks - 1);
 	}
 
-	cached_block* block = cache->hash->Lookup(blockNumber);
+	cached_block* block = cache->hash.Lookup(blockNumber);
 	if (block != NULL)
 		put_cached_block(cache, block);
 	else {
@@ -1891,6 +2348,67 @@ put_cached_block(block_cache* cache, off_t blockNumber)
 }
 
 
+/*!	Acquires another reference to the block \a blockNumber without holding the
+	cache lock. This only succeeds if someone else is already holding a
+	reference to the block, as taking a block out of the unused list, or
+	reading it in requires the cache lock.
+	Since a block can neither get its first nor lose its last reference
+	without the cache lock, the rest of the block state is not affected.
+*/
+static cached_block*
+try_get_referenced_block(block_cache* cache, off_t blockNumber)
+{
+	ReadLocker locker(cache->hash.ShardLock(blockNumber));
+
+	cached_block* block = cache->hash.Lookup(blockNumber);
+	if (block == NULL || block->busy_reading)
+		return NULL;
+
+	int32 refCount = atomic_get(&block->ref_count);
+	while (refCount > 0) {
+		int32 previous = atomic_test_and_set(&block->ref_count, refCount + 1,
+			refCount);
+		if (previous == refCount) {
+			block->last_accessed = system_time() / 1000000L;
+			return block;
+		}
+
+		refCount = previous;
+	}
+
+	return NULL;
+}
+
+
+/*!	Releases a reference to the block \a blockNumber without holding the cache
+	lock, if it is not the last one. Returns \c false if the cache lock is
+	needed to put the block, see try_get_referenced_block().
+*/
+static bool
+try_put_referenced_block(block_cache* cache, off_t blockNumber)
+{
+	ReadLocker locker(cache->hash.ShardLock(blockNumber));
+
+	cached_block* block = cache->hash.Lookup(blockNumber);
+	if (block == NULL)
+		return false;
+
+	int32 refCount = atomic_get(&block->ref_count);
+	while (refCount > 1) {
+		int32 previous = atomic_test_and_set(&block->ref_count, refCount - 1,
+			refCount);
+		if (previous == refCount) {
+			TB(Put(cache, block));
+			return true;
+		}
+
+		refCount = previous;
+	}
+
+	return false;
+}
+
+
 /*!	Retrieves the block \a blockNumber from the hash table, if it's already
 	there, or reads it from the disk.
 	You need to have the cache locked when calling this function.
@@ -1915,7 +2433,7 @@ get_cached_block(block_cache* cache, off_t blockNumber, bool* _allocated,
 	}
 
 retry:
-	cached_block* block = cache->hash->Lookup(blockNumber);
+	cached_block* block = cache->hash.Lookup(blockNumber);
 	*_allocated = false;
 
 	if (block == NULL) {
@@ -1924,7 +2442,7 @@ retry:
 		if (block == NULL)
 			return B_NO_MEMORY;
 
-		cache->hash->Insert(block);
+		cache->hash.Insert(block);
 		*_allocated = true;
 	} else if (block->busy_reading) {
 		// The block is currently busy_reading - wait and try again later
@@ -1963,7 +2481,7 @@ retry:
 		mark_block_unbusy_reading(cache, block);
 	}
 
-	block->ref_count++;
+	atomic_add(&block->ref_count, 1);
 	block->last_accessed = system_time() / 1000000L;
 
 	*_block = block;
@@ -2243,7 +2761,7 @@ dump_cache(int argc, char** argv)
 	off_t blockNumber = -1;
 	if (i + 1 < argc) {
 		blockNumber = parse_expression(argv[i + 1]);
-		cached_block* block = cache->hash->Lookup(blockNumber);
+		cached_block* block = cache->hash.Lookup(blockNumber);
 		if (block != NULL)
 			dump_block_long(block);
 		else
@@ -2303,7 +2821,7 @@ dump_cache(int argc, char** argv)
 	uint32 count = 0;
 	uint32 dirty = 0;
 	uint32 discarded = 0;
-	BlockTable::Iterator iterator(cache->hash);
+	BlockShardTable::Iterator iterator(&cache->hash);
 	while (iterator.HasNext()) {
 		cached_block* block = iterator.Next();
 		if (showBlocks)
@@ -2611,7 +3129,7 @@ block_notifier_and_writer(void* /*data*/)
 			if (cache->num_dirty_blocks) {
 				// This cache is not using transactions, we'll scan the blocks
 				// directly
-				BlockTable::Iterator iterator(cache->hash);
+				BlockShardTable::Iterator iterator(&cache->hash);
 
 				while (iterator.HasNext()) {
 					cached_block* block = iterator.Next();
@@ -3392,7 +3910,7 @@ cache_has_block_in_transaction(void* _cache, int32 id, off_t blockNumber)
 	block_cache* cache = (block_cache*)_cache;
 	TransactionLocker locker(cache);
 
-	cached_block* block = cache->hash->Lookup(blockNumber);
+	cached_block* block = cache->hash.Lookup(blockNumber);
 
 	return (block != NULL && block->transaction != NULL
 		&& block->transaction->id == id);
@@ -3422,7 +3940,7 @@ block_cache_delete(void* _cache, bool allowWrites)
 
 	// free all blocks
 
-	cached_block* block = cache->hash->Clear(true);
+	cached_block* block = cache->hash.Clear();
 	while (block != NULL) {
 		cached_block* next = block->next;
 		cache->FreeBlock(block);
@@ -3473,7 +3991,7 @@ block_cache_sync(void* _cache)
 	MutexLocker locker(&cache->lock);
 
 	BlockWriter writer(cache);
-	BlockTable::Iterator iterator(cache->hash);
+	BlockShardTable::Iterator iterator(&cache->hash);
 
 	while (iterator.HasNext()) {
 		cached_block* block = iterator.Next();
@@ -3511,7 +4029,7 @@ block_cache_sync_etc(void* _cache, off_t blockNumber, size_t numBlocks)
 	BlockWriter writer(cache);
 
 	for (; numBlocks > 0; numBlocks--, blockNumber++) {
-		cached_block* block = cache->hash->Lookup(blockNumber);
+		cached_block* block = cache->hash.Lookup(blockNumber);
 		if (block == NULL)
 			continue;
 
@@ -3545,7 +4063,7 @@ block_cache_discard(void* _cache, off_t blockNumber, size_t numBlocks)
 	BlockWriter writer(cache);
 
 	for (size_t i = 0; i < numBlocks; i++, blockNumber++) {
-		cached_block* block = cache->hash->Lookup(blockNumber);
+		cached_block* block = cache->hash.Lookup(blockNumber);
 		if (block != NULL && block->previous_transaction != NULL)
 			writer.Add(block);
 	}
@@ -3557,7 +4075,7 @@ block_cache_discard(void* _cache, off_t blockNumber, size_t numBlocks)
 		// reset blockNumber to its original value
 
 	for (size_t i = 0; i < numBlocks; i++, blockNumber++) {
-		cached_block* block = cache->hash->Lookup(blockNumber);
+		cached_block* block = cache->hash.Lookup(blockNumber);
 		if (block == NULL)
 			continue;
 
@@ -3659,10 +4177,21 @@ block_cache_get_etc(void* _cache, off_t blockNumber, off_t base, off_t length,
 	const void** _block)
 {
 	block_cache* cache = (block_cache*)_cache;
+	cached_block* block;
+
+#if !BLOCK_CACHE_DEBUG_CHANGED
+	block = try_get_referenced_block(cache, blockNumber);
+	if (block != NULL) {
+		TB(Get(cache, block));
+
+		*_block = block->current_data;
+		return B_OK;
+	}
+#endif
+
 	MutexLocker locker(&cache->lock);
 	bool allocated;
 
-	cached_block* block;
 	status_t status = get_cached_block(cache, blockNumber, &allocated, true,
 		&block);
 	if (status != B_OK)
@@ -3707,7 +4236,7 @@ block_cache_set_dirty(void* _cache, off_t blockNumber, bool dirty,
 	block_cache* cache = (block_cache*)_cache;
 	MutexLocker locker(&cache->lock);
 
-	cached_block* block = cache->hash->Lookup(blockNumber);
+	cached_block* block = cache->hash.Lookup(blockNumber);
 	if (block == NULL)
 		return B_BAD_VALUE;
 	if (block->is_dirty == dirty) {
@@ -3727,6 +4256,12 @@ void
 block_cache_put(void* _cache, off_t blockNumber)
 {
 	block_cache* cache = (block_cache*)_cache;
+
+#if !BLOCK_CACHE_DEBUG_CHANGED
+	if (try_put_referenced_block(cache, blockNumber))
+		return;
+#endif
+
 	MutexLocker locker(&cache->lock);
 
 	put_cached_block(cache, blockNumber);
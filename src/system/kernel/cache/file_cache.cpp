@@ -41,6 +41,27 @@
 #define BYPASS_IO_SIZE		65536
 #define LAST_ACCESSES		3
 
+// number of independent streams tracked per file for read-ahead
+#define READ_AHEAD_STREAMS	2
+
+struct read_ahead_stream {
+	off_t			last_offset;
+		// start of the last access belonging to this stream
+	off_t			next_offset;
+		// where the next sequential access is expected to start
+	off_t			stride;
+		// distance between the starts of two accesses, 0 if sequential
+	off_t			window_start;
+	off_t			window_end;
+		// range that has been read ahead, but not yet been read
+	uint32			window_pages;
+	uint32			pending_pages;
+		// pages that have been read ahead, but not yet been read
+	uint32			last_used;
+	bool			confirmed;
+		// the stream has been accessed sequentially or strided at least once
+};
+
 struct file_cache_ref {
 	VMCache			*cache;
 	struct vnode	*vnode;
@@ -50,6 +71,8 @@ struct file_cache_ref {
 		//	write vs. read)
 	int32			last_access_index;
 	uint16			disabled_count;
+	uint32			stream_usage;
+	read_ahead_stream streams[READ_AHEAD_STREAMS];
 
 	inline void SetLastAccess(int32 index, off_t access, bool isWrite)
 	{
@@ -106,6 +129,11 @@ static void add_to_iovec(generic_io_vec* vecs, uint32 &index, uint32 max,
 
 static struct cache_module_info* sCacheModule;
 
+static const uint32 kMinReadAheadPages = 4;
+static const off_t kMaxReadAheadStride = 16 * 1024 * 1024;
+static uint32 sMaxReadAheadPages = 256;	// 1 MB with 4 kB pages
+static file_cache_read_ahead_stats sReadAheadStats;
+
 
 static const uint32 kZeroVecCount = 32;
 static const size_t kZeroVecSize = kZeroVecCount * B_PAGE_SIZE;
@@ -897,6 +925,331 @@ cache_io(void* _cacheRef, void* cookie, off_t offset, addr_t buffer,
 }
 
 
+//	#pragma mark - read-ahead
+
+
+/*!	Starts asynchronous reads for all pages in the given page aligned range
+	that are not yet in the cache. The pages are taken from \a reservation.
+	The cache must not be locked when calling this function.
+	Returns the number of pages that are being read.
+*/
+static uint32
+prefetch_range(file_cache_ref* ref, off_t offset, size_t size,
+	vm_page_reservation* reservation)
+{
+	VMCache* cache = ref->cache;
+	uint32 pagesRead = 0;
+	size_t bytesToRead = 0;
+	off_t lastOffset = offset;
+
+	cache->Lock();
+
+	while (true) {
+		// check if this page is already in memory
+		if (size > 0) {
+			vm_page* page = cache->LookupPage(offset);
+
+			offset += B_PAGE_SIZE;
+			size -= B_PAGE_SIZE;
+
+			if (page == NULL) {
+				bytesToRead += B_PAGE_SIZE;
+				continue;
+			}
+		}
+		if (bytesToRead != 0) {
+			// read the part before the current page (or the end of the request)
+			PrecacheIO* io = new(std::nothrow) PrecacheIO(ref, lastOffset,
+				bytesToRead);
+			if (io == NULL || io->Prepare(reservation) != B_OK) {
+				delete io;
+				break;
+			}
+
+			// we must not have the cache locked during I/O
+			cache->Unlock();
+			io->ReadAsync();
+			cache->Lock();
+
+			pagesRead += bytesToRead / B_PAGE_SIZE;
+			bytesToRead = 0;
+		}
+
+		if (size == 0) {
+			// we have reached the end of the request
+			break;
+		}
+
+		lastOffset = offset;
+	}
+
+	cache->Unlock();
+	return pagesRead;
+}
+
+
+static inline void
+reset_read_ahead_stream(read_ahead_stream* stream)
+{
+	if (stream->pending_pages > 0) {
+		atomic_add64(&sReadAheadStats.wasted_pages, stream->pending_pages);
+		stream->pending_pages = 0;
+	}
+
+	stream->window_start = 0;
+	stream->window_end = 0;
+	stream->confirmed = false;
+}
+
+
+/*!	Finds the stream the access at \a offset belongs to. If there is none,
+	the access is considered random, and a stream is (re)started with it.
+	The cache must be locked.
+	Returns \c NULL when the access did not continue an existing stream.
+*/
+static read_ahead_stream*
+find_read_ahead_stream(file_cache_ref* ref, off_t offset, off_t end)
+{
+	read_ahead_stream* nearest = NULL;
+	read_ahead_stream* oldest = NULL;
+
+	for (int32 i = 0; i < READ_AHEAD_STREAMS; i++) {
+		read_ahead_stream* stream = &ref->streams[i];
+		if (stream->window_pages != 0) {
+			if (offset == stream->next_offset) {
+				stream->stride = 0;
+				return stream;
+			}
+			if (stream->stride != 0
+				&& offset == stream->last_offset + stream->stride) {
+				return stream;
+			}
+
+			// this access might be the second one of a strided stream
+			off_t distance = offset - stream->last_offset;
+			if (distance > 0 && distance <= kMaxReadAheadStride
+				&& (nearest == NULL
+					|| distance < offset - nearest->last_offset)) {
+				nearest = stream;
+			}
+		}
+
+		if (oldest == NULL || stream->window_pages == 0
+			|| (oldest->window_pages != 0
+				&& (int32)(stream->last_used - oldest->last_used) < 0)) {
+			oldest = stream;
+		}
+	}
+
+	atomic_add64(&sReadAheadStats.random_accesses, 1);
+
+	read_ahead_stream* stream = nearest;
+	if (stream != NULL) {
+		// remember the stride, but shrink the window until it's confirmed
+		stream->stride = offset - stream->last_offset;
+		stream->window_pages = max_c(stream->window_pages / 2,
+			kMinReadAheadPages);
+	} else {
+		stream = oldest;
+		stream->stride = 0;
+		stream->window_pages = kMinReadAheadPages;
+	}
+
+	reset_read_ahead_stream(stream);
+	stream->last_offset = offset;
+	stream->next_offset = end;
+	stream->last_used = ++ref->stream_usage;
+	return NULL;
+}
+
+
+/*!	Detects sequential and strided read accesses to the file, and reads ahead
+	of them asynchronously. The read-ahead window grows with every access that
+	continues a stream, and shrinks whenever a random access is detected.
+	The cache must not be locked.
+*/
+static void
+read_ahead(file_cache_ref* ref, off_t offset, size_t size)
+{
+	const uint32 maxPages = sMaxReadAheadPages;
+	if (maxPages == 0 || size == 0)
+		return;
+
+	VMCache* cache = ref->cache;
+	const off_t end = offset + size;
+
+	AutoLocker<VMCache> locker(cache);
+
+	read_ahead_stream* stream = find_read_ahead_stream(ref, offset, end);
+	if (stream == NULL)
+		return;
+
+	// account for the pages of this access that we have read ahead
+	off_t hitStart = max_c(offset, stream->window_start);
+	off_t hitEnd = min_c(end, stream->window_end);
+	if (hitEnd > hitStart) {
+		uint32 hits = min_c(stream->pending_pages,
+			(uint32)((ROUNDUP(hitEnd, B_PAGE_SIZE)
+				- ROUNDDOWN(hitStart, B_PAGE_SIZE)) / B_PAGE_SIZE));
+		stream->pending_pages -= hits;
+		atomic_add64(&sReadAheadStats.hit_pages, hits);
+	}
+	if (stream->stride == 0 && end > stream->window_start)
+		stream->window_start = min_c(end, stream->window_end);
+
+	if (!stream->confirmed) {
+		stream->confirmed = true;
+		atomic_add64(stream->stride != 0 ? &sReadAheadStats.strided_streams
+			: &sReadAheadStats.sequential_streams, 1);
+	}
+
+	const uint32 accessPages = (ROUNDUP(end, B_PAGE_SIZE)
+		- ROUNDDOWN(offset, B_PAGE_SIZE)) / B_PAGE_SIZE;
+	stream->window_pages = min_c(max_c(stream->window_pages * 2, accessPages),
+		maxPages);
+	stream->last_offset = offset;
+	stream->next_offset = end;
+	stream->last_used = ++ref->stream_usage;
+
+	if (low_resource_state(B_KERNEL_RESOURCE_PAGES) != B_NO_LOW_RESOURCE)
+		return;
+
+	// Collect the ranges to read: sequential streams get a single range that
+	// keeps the window filled, strided streams get one range per upcoming
+	// access that fits into the window.
+	const uint32 kMaxRanges = 8;
+	off_t rangeOffsets[kMaxRanges];
+	off_t rangeEnds[kMaxRanges];
+	uint32 rangeCount = 0;
+	uint32 rangePages = 0;
+
+	const off_t fileSize = cache->virtual_end;
+	const off_t windowSize = (off_t)stream->window_pages * B_PAGE_SIZE;
+
+	if (stream->stride == 0) {
+		// only refill the window once half of it has been consumed
+		if (stream->window_end - end >= windowSize / 2)
+			return;
+
+		off_t rangeOffset = max_c(stream->window_end,
+			ROUNDUP(end, B_PAGE_SIZE));
+		off_t rangeEnd = min_c(ROUNDUP(end, B_PAGE_SIZE) + windowSize,
+			ROUNDUP(fileSize, B_PAGE_SIZE));
+		if (rangeOffset < rangeEnd) {
+			rangeOffsets[0] = rangeOffset;
+			rangeEnds[0] = rangeEnd;
+			rangePages = (rangeEnd - rangeOffset) / B_PAGE_SIZE;
+			rangeCount = 1;
+		}
+	} else {
+		off_t next = offset + stream->stride;
+		while (rangeCount < kMaxRanges && rangePages < stream->window_pages
+			&& next >= 0 && next < fileSize) {
+			off_t rangeOffset = ROUNDDOWN(next, B_PAGE_SIZE);
+			off_t rangeEnd = min_c(ROUNDUP(next + (off_t)size, B_PAGE_SIZE),
+				ROUNDUP(fileSize, B_PAGE_SIZE));
+			if (rangeOffset >= stream->window_end) {
+				rangeOffsets[rangeCount] = rangeOffset;
+				rangeEnds[rangeCount] = rangeEnd;
+				rangePages += (rangeEnd - rangeOffset) / B_PAGE_SIZE;
+				rangeCount++;
+			}
+			next += stream->stride;
+		}
+		if (stream->stride < 0) {
+			// we don't track the window of backwards streams
+			stream->window_start = 0;
+			stream->window_end = 0;
+		}
+	}
+
+	if (rangeCount == 0)
+		return;
+
+	if (stream->stride >= 0) {
+		if (stream->window_start >= stream->window_end
+			|| stream->stride != 0) {
+			stream->window_start = rangeOffsets[0];
+		}
+		stream->window_end = rangeEnds[rangeCount - 1];
+	}
+
+	locker.Unlock();
+
+	// Do not wait for pages: read-ahead is only worth it if memory is plenty
+	vm_page_reservation reservation;
+	if (!vm_page_try_reserve_pages(&reservation, rangePages, VM_PRIORITY_USER))
+		return;
+
+	uint32 pagesRead = 0;
+	for (uint32 i = 0; i < rangeCount; i++) {
+		pagesRead += prefetch_range(ref, rangeOffsets[i],
+			rangeEnds[i] - rangeOffsets[i], &reservation);
+	}
+
+	vm_page_unreserve_pages(&reservation);
+
+	if (pagesRead == 0)
+		return;
+
+	atomic_add64(&sReadAheadStats.issued_requests, rangeCount);
+	atomic_add64(&sReadAheadStats.issued_pages, pagesRead);
+
+	locker.Lock();
+	stream->pending_pages += pagesRead;
+}
+
+
+static int
+dump_read_ahead(int argc, char** argv)
+{
+	if (argc > 2 || (argc == 2 && !strcmp(argv[1], "--help"))) {
+		kprintf("usage: %s [file-cache-ref]\n", argv[0]);
+		return 0;
+	}
+
+	kprintf("maximum window:     %" B_PRIu32 " pages\n", sMaxReadAheadPages);
+	kprintf("sequential streams: %" B_PRId64 "\n",
+		sReadAheadStats.sequential_streams);
+	kprintf("strided streams:    %" B_PRId64 "\n",
+		sReadAheadStats.strided_streams);
+	kprintf("random accesses:    %" B_PRId64 "\n",
+		sReadAheadStats.random_accesses);
+	kprintf("requests issued:    %" B_PRId64 "\n",
+		sReadAheadStats.issued_requests);
+	kprintf("pages issued:       %" B_PRId64 "\n",
+		sReadAheadStats.issued_pages);
+	kprintf("pages hit:          %" B_PRId64 "\n", sReadAheadStats.hit_pages);
+	kprintf("pages wasted:       %" B_PRId64 "\n",
+		sReadAheadStats.wasted_pages);
+
+	if (argc < 2)
+		return 0;
+
+	file_cache_ref* ref = (file_cache_ref*)parse_expression(argv[1]);
+	kprintf("\nfile cache ref %p, vnode %p, cache %p\n", ref, ref->vnode,
+		ref->cache);
+
+	for (int32 i = 0; i < READ_AHEAD_STREAMS; i++) {
+		read_ahead_stream& stream = ref->streams[i];
+		if (stream.window_pages == 0)
+			continue;
+
+		kprintf("  stream %" B_PRId32 ": last %" B_PRIdOFF ", next %"
+			B_PRIdOFF ", stride %" B_PRIdOFF ", window %" B_PRIdOFF " - %"
+			B_PRIdOFF " (%" B_PRIu32 " pages, %" B_PRIu32 " pending)%s\n", i,
+			stream.last_offset, stream.next_offset, stream.stride,
+			stream.window_start, stream.window_end, stream.window_pages,
+			stream.pending_pages, stream.confirmed ? "" : ", unconfirmed");
+	}
+
+	return 0;
+}
+
+
+//	#pragma mark -
+
+
 static status_t
 file_cache_control(const char* subsystem, uint32 function, void* buffer,
 	size_t bufferSize)
@@ -941,6 +1294,49 @@ file_cache_control(const char* subsystem, uint32 function, void* buffer,
 
 			return status;
 		}
+
+		case CACHE_GET_READ_AHEAD_STATS:
+		{
+			if (buffer == NULL || !IS_USER_ADDRESS(buffer)
+				|| bufferSize < sizeof(file_cache_read_ahead_stats))
+				return B_BAD_ADDRESS;
+
+			file_cache_read_ahead_stats stats = sReadAheadStats;
+			stats.max_window = sMaxReadAheadPages * B_PAGE_SIZE;
+
+			return user_memcpy(buffer, &stats, sizeof(stats));
+		}
+
+		case CACHE_RESET_READ_AHEAD_STATS:
+			if (geteuid() != 0)
+				return B_NOT_ALLOWED;
+
+			memset(&sReadAheadStats, 0, sizeof(sReadAheadStats));
+			return B_OK;
+
+		case CACHE_SET_MAX_READ_AHEAD:
+		{
+			if (geteuid() != 0)
+				return B_NOT_ALLOWED;
+
+			uint32 maxWindow;
+			if (buffer == NULL || !IS_USER_ADDRESS(buffer)
+				|| bufferSize < sizeof(maxWindow)
+				|| user_memcpy(&maxWindow, buffer, sizeof(maxWindow)) != B_OK)
+				return B_BAD_ADDRESS;
+
+			if (maxWindow > 16 * 1024 * 1024)
+				return B_BAD_VALUE;
+
+			uint32 pages = maxWindow / B_PAGE_SIZE;
+			if (pages != 0 && pages < kMinReadAheadPages)
+				pages = kMinReadAheadPages;
+
+			dprintf("cache_control: maximum read-ahead %" B_PRIu32 " pages\n",
+				pages);
+			sMaxReadAheadPages = pages;
+			return B_OK;
+		}
 	}
 
 	return B_BAD_HANDLER;
@@ -982,53 +1378,12 @@ cache_prefetch_vnode(struct vnode* vnode, off_t offset, size_t size)
 		return;
 	}
 
-	size_t bytesToRead = 0;
-	off_t lastOffset = offset;
-
 	vm_page_reservation reservation;
 	vm_page_reserve_pages(&reservation, reservePages, VM_PRIORITY_USER);
 
-	cache->Lock();
+	prefetch_range(ref, offset, size, &reservation);
 
-	while (true) {
-		// check if this page is already in memory
-		if (size > 0) {
-			vm_page* page = cache->LookupPage(offset);
-
-			offset += B_PAGE_SIZE;
-			size -= B_PAGE_SIZE;
-
-			if (page == NULL) {
-				bytesToRead += B_PAGE_SIZE;
-				continue;
-			}
-		}
-		if (bytesToRead != 0) {
-			// read the part before the current page (or the end of the request)
-			PrecacheIO* io = new(std::nothrow) PrecacheIO(ref, lastOffset,
-				bytesToRead);
-			if (io == NULL || io->Prepare(&reservation) != B_OK) {
-				delete io;
-				break;
-			}
-
-			// we must not have the cache locked during I/O
-			cache->Unlock();
-			io->ReadAsync();
-			cache->Lock();
-
-			bytesToRead = 0;
-		}
-
-		if (size == 0) {
-			// we have reached the end of the request
-			break;
-		}
-
-		lastOffset = offset;
-	}
-
-	cache->ReleaseRefAndUnlock();
+	cache->ReleaseRef();
 	vm_page_unreserve_pages(&reservation);
 }
 
@@ -1126,6 +1481,12 @@ file_cache_init(void)
 	}
 
 	register_generic_syscall(CACHE_SYSCALLS, file_cache_control, 1, 0);
+
+	add_debugger_command_etc("read_ahead", &dump_read_ahead,
+		"Dumps read-ahead statistics",
+		"[file-cache-ref]\n"
+		"Dumps the file cache read-ahead statistics, and the read-ahead\n"
+		"streams of the specified file cache ref, if any.\n", 0);
 	return B_OK;
 }
 
@@ -1146,6 +1507,8 @@ file_cache_create(dev_t mountID, ino_t vnodeID, off_t size)
 	memset(ref->last_access, 0, sizeof(ref->last_access));
 	ref->last_access_index = 0;
 	ref->disabled_count = 0;
+	ref->stream_usage = 0;
+	memset(ref->streams, 0, sizeof(ref->streams));
 
 	// TODO: delay VMCache creation until data is
 	//	requested/written for the first time? Listing lots of
@@ -1186,6 +1549,9 @@ file_cache_delete(void* _cacheRef)
 
 	TRACE(("file_cache_delete(ref = %p)\n", ref));
 
+	for (int32 i = 0; i < READ_AHEAD_STREAMS; i++)
+		reset_read_ahead_stream(&ref->streams[i]);
+
 	ref->cache->ReleaseRef();
 	delete ref;
 }
@@ -1323,6 +1689,10 @@ file_cache_read(void* _cacheRef, void* cookie, off_t offset, void* buffer,
 		return error;
 	}
 
+	// Start reading ahead before we block on the actual request, so that
+	// the device can work on both at the same time
+	read_ahead(ref, offset, *_size);
+
 	return cache_io(ref, cookie, offset, (addr_t)buffer, _size, false);
 }
 
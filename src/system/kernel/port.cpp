@@ -22,6 +22,7 @@
 #include <OS.h>
 
 #include <AutoDeleter.h>
+#include <AutoDeleterOS.h>
 
 #include <arch/int.h>
 #include <heap.h>
@@ -34,6 +35,7 @@
 #include <util/AutoLock.h>
 #include <util/list.h>
 #include <vm/vm.h>
+#include <vm/VMAddressSpace.h>
 #include <wait_for_objects.h>
 
 
@@ -94,7 +96,16 @@ struct port_message : DoublyLinkedListLinkImpl<port_message> {
 	uid_t				sender;
 	gid_t				sender_group;
 	team_id				sender_team;
+	area_id				area;
+		// large messages are kept in an area of their own, which can be
+		// handed over to the reader as is
+	void*				area_address;
 	char				buffer[0];
+
+	void* Data()
+	{
+		return area >= 0 ? area_address : buffer;
+	}
 };
 
 typedef DoublyLinkedList<port_message> MessageList;
@@ -442,6 +453,13 @@ static const size_t kBufferGrowRate = kInitialPortBufferSize;
 
 #define MAX_QUEUE_LENGTH 4096
 #define PORT_MAX_MESSAGE_SIZE (256 * 1024)
+#define PORT_MAX_AREA_MESSAGE_SIZE (16 * 1024 * 1024)
+	// area messages are charged against kTotalSpaceLimit, too, so this must
+	// remain well below it
+
+// Messages of at least this size are not copied into the port heap, but
+// into an area (or shared copy-on-write with the sender, if possible).
+static const size_t kAreaMessageThreshold = 64 * 1024;
 
 static int32 sMaxPorts = 4096;
 static int32 sUsedPorts;
@@ -664,24 +682,54 @@ is_port_closed(Port* port)
 }
 
 
-static void
-put_port_message(port_message* message)
+/*!	Returns the space a message with \a bufferSize bytes of content is
+	charged against kTotalSpaceLimit. The pages of an area message count,
+	even though they are not allocated from the port heap.
+*/
+static inline size_t
+port_message_space(size_t bufferSize, bool isArea)
 {
-	const size_t size = sizeof(port_message) + message->size;
-	free(message);
+	return sizeof(port_message)
+		+ (isArea ? PAGE_ALIGN(bufferSize) : bufferSize);
+}
 
+
+static void
+release_port_message_space(size_t size)
+{
 	atomic_add(&sTotalSpaceCommited, -size);
 	if (sWaitingForSpace > 0)
 		sNoSpaceCondition.NotifyAll();
 }
 
 
-/*! Port must be locked. */
+static void
+put_port_message(port_message* message)
+{
+	size_t size = port_message_space(message->size, message->area >= 0);
+	if (message->area >= 0)
+		delete_area(message->area);
+
+	free(message);
+
+	release_port_message_space(size);
+}
+
+
+/*!	Port must be locked.
+	If \a area is valid, the message's contents are kept in that area, and
+	only the message header is allocated from the port heap. The area's pages
+	are still charged against the space limit. The message takes over
+	ownership of the area in this case.
+*/
 static status_t
-get_port_message(int32 code, size_t bufferSize, uint32 flags, bigtime_t timeout,
+get_port_message(int32 code, size_t bufferSize, area_id area,
+	void* areaAddress, uint32 flags, bigtime_t timeout,
 	port_message** _message, Port& port)
 {
-	const size_t size = sizeof(port_message) + bufferSize;
+	const size_t size = port_message_space(bufferSize, area >= 0);
+	const size_t allocationSize
+		= sizeof(port_message) + (area >= 0 ? 0 : bufferSize);
 
 	while (true) {
 		int32 previouslyCommited = atomic_add(&sTotalSpaceCommited, size);
@@ -731,10 +779,12 @@ get_port_message(int32 code, size_t bufferSize, uint32 flags, bigtime_t timeout,
 		}
 
 		// Quota is fulfilled, try to allocate the buffer
-		port_message* message = (port_message*)malloc(size);
+		port_message* message = (port_message*)malloc(allocationSize);
 		if (message != NULL) {
 			message->code = code;
 			message->size = bufferSize;
+			message->area = area;
+			message->area_address = areaAddress;
 
 			*_message = message;
 			return B_OK;
@@ -779,17 +829,133 @@ copy_port_message(port_message* message, int32* _code, void* buffer,
 
 	if (size > 0) {
 		if (userCopy) {
-			status_t status = user_memcpy(buffer, message->buffer, size);
+			status_t status = user_memcpy(buffer, message->Data(), size);
 			if (status != B_OK)
 				return status;
 		} else
-			memcpy(buffer, message->buffer, size);
+			memcpy(buffer, message->Data(), size);
 	}
 
 	return size;
 }
 
 
+/*!	Creates the kernel area that holds the contents of a large message.
+	If the message consists of a single user buffer that spans a complete
+	(private) area, that area is shared copy-on-write, instead of being
+	copied.
+*/
+static status_t
+create_port_message_area(const iovec* vecs, size_t vecCount,
+	size_t bufferSize, bool userCopy, area_id& _area, void*& _address)
+{
+	size_t areaSize = PAGE_ALIGN(bufferSize);
+
+	if (userCopy && vecCount == 1 && vecs[0].iov_len >= bufferSize
+		&& ((addr_t)vecs[0].iov_base % B_PAGE_SIZE) == 0) {
+		area_id source = area_for(vecs[0].iov_base);
+		area_info info;
+		if (source >= 0 && get_area_info(source, &info) == B_OK
+			&& info.address == vecs[0].iov_base && info.size == areaSize
+			&& (info.protection & (B_READ_AREA | B_SHARED_AREA))
+				== B_READ_AREA) {
+			// shared areas would not be copied, but still be shared with
+			// the sender
+			void* address;
+			area_id area = vm_copy_area(VMAddressSpace::KernelID(),
+				"port message", &address, B_ANY_KERNEL_ADDRESS, source);
+			if (area >= 0) {
+				// the kernel copy must not be accessible from userland
+				if (vm_set_area_protection(VMAddressSpace::KernelID(), area,
+						B_KERNEL_READ_AREA | B_KERNEL_WRITE_AREA, true)
+							== B_OK) {
+					_area = area;
+					_address = address;
+					return B_OK;
+				}
+
+				delete_area(area);
+			}
+		}
+	}
+
+	void* address;
+	area_id area = create_area("port message", &address, B_ANY_KERNEL_ADDRESS,
+		areaSize, B_NO_LOCK, B_KERNEL_READ_AREA | B_KERNEL_WRITE_AREA);
+	if (area < 0)
+		return area;
+
+	size_t offset = 0;
+	for (uint32 i = 0; i < vecCount && offset < bufferSize; i++) {
+		size_t bytes = std::min(vecs[i].iov_len, bufferSize - offset);
+
+		if (userCopy) {
+			status_t status = user_memcpy((uint8*)address + offset,
+				vecs[i].iov_base, bytes);
+			if (status != B_OK) {
+				delete_area(area);
+				return status;
+			}
+		} else
+			memcpy((uint8*)address + offset, vecs[i].iov_base, bytes);
+
+		offset += bytes;
+	}
+
+	_area = area;
+	_address = address;
+	return B_OK;
+}
+
+
+/*!	Moves the contents of \a message into an area of \a team, and returns
+	its ID. Area messages are just handed over, all others are copied.
+*/
+static area_id
+transfer_port_message(port_message* message, team_id team, bool kernel,
+	void** _address)
+{
+	uint32 protection = B_KERNEL_READ_AREA | B_KERNEL_WRITE_AREA;
+	if (!kernel)
+		protection |= B_READ_AREA | B_WRITE_AREA;
+
+	if (message->area >= 0) {
+		area_id area = vm_clone_area(team, "port message", _address,
+			B_ANY_ADDRESS, protection, REGION_NO_PRIVATE_MAP, message->area,
+			true);
+		if (area < 0)
+			return area;
+
+		// the cache now belongs to the new area alone, so its pages are no
+		// longer charged to the ports
+		delete_area(message->area);
+		release_port_message_space(PAGE_ALIGN(message->size));
+		message->area = -1;
+		message->size = 0;
+		return area;
+	}
+
+	virtual_address_restrictions virtualRestrictions = {};
+	virtualRestrictions.address_specification
+		= kernel ? B_ANY_KERNEL_ADDRESS : B_ANY_ADDRESS;
+	physical_address_restrictions physicalRestrictions = {};
+	area_id area = create_area_etc(team, "port message",
+		PAGE_ALIGN(std::max(message->size, (size_t)1)), B_NO_LOCK, protection,
+		0, 0, &virtualRestrictions, &physicalRestrictions, _address);
+	if (area < 0)
+		return area;
+
+	if (kernel)
+		memcpy(*_address, message->buffer, message->size);
+	else if (user_memcpy(*_address, message->buffer, message->size) != B_OK) {
+		vm_delete_area(team, area, true);
+		return B_BAD_ADDRESS;
+	}
+
+	return area;
+}
+
+
 static void
 uninit_port(Port* port)
 {
@@ -1430,27 +1596,18 @@ read_port(port_id port, int32* msgCode, void* buffer, size_t bufferSize)
 }
 
 
-ssize_t
-read_port_etc(port_id id, int32* _code, void* buffer, size_t bufferSize,
-	uint32 flags, bigtime_t timeout)
+/*!	Waits until there is a message in the port, and returns with the port
+	locked, or fails.
+*/
+static status_t
+lock_port_for_reading(port_id id, uint32 flags, bigtime_t timeout,
+	BReference<Port>& portRef, MutexLocker& locker)
 {
-	if (!sPortsActive || id < 0)
-		return B_BAD_PORT_ID;
-	if ((buffer == NULL && bufferSize > 0) || timeout < 0)
-		return B_BAD_VALUE;
-
-	bool userCopy = (flags & PORT_FLAG_USE_USER_MEMCPY) != 0;
-	bool peekOnly = !userCopy && (flags & B_PEEK_PORT_MESSAGE) != 0;
-		// TODO: we could allow peeking for user apps now
-
-	flags &= B_CAN_INTERRUPT | B_KILL_CAN_INTERRUPT | B_RELATIVE_TIMEOUT
-		| B_ABSOLUTE_TIMEOUT;
-
 	// get the port
-	BReference<Port> portRef = get_locked_port(id);
+	portRef = get_locked_port(id);
 	if (portRef == NULL)
 		return B_BAD_PORT_ID;
-	MutexLocker locker(portRef->lock, true);
+	locker.SetTo(portRef->lock, true);
 
 	if (is_port_closed(portRef) && portRef->messages.IsEmpty()) {
 		T(Read(portRef, 0, B_BAD_PORT_ID));
@@ -1492,13 +1649,59 @@ read_port_etc(port_id id, int32* _code, void* buffer, size_t bufferSize,
 		}
 	}
 
-	// determine tail & get the length of the message
-	port_message* message = portRef->messages.Head();
-	if (message == NULL) {
+	if (portRef->messages.IsEmpty()) {
 		panic("port %" B_PRId32 ": no messages found\n", portRef->id);
 		return B_ERROR;
 	}
 
+	return B_OK;
+}
+
+
+/*!	Removes the first message from the locked \a port, and makes its spot
+	in the queue available to writers again.
+*/
+static port_message*
+remove_port_message(Port* port)
+{
+	port_message* message = port->messages.RemoveHead();
+	port->total_count++;
+	port->write_count++;
+	port->read_count--;
+
+	notify_port_select_events(port, B_EVENT_WRITE);
+	port->write_condition.NotifyOne();
+		// make one spot in queue available again for write
+
+	return message;
+}
+
+
+ssize_t
+read_port_etc(port_id id, int32* _code, void* buffer, size_t bufferSize,
+	uint32 flags, bigtime_t timeout)
+{
+	if (!sPortsActive || id < 0)
+		return B_BAD_PORT_ID;
+	if ((buffer == NULL && bufferSize > 0) || timeout < 0)
+		return B_BAD_VALUE;
+
+	bool userCopy = (flags & PORT_FLAG_USE_USER_MEMCPY) != 0;
+	bool peekOnly = !userCopy && (flags & B_PEEK_PORT_MESSAGE) != 0;
+		// TODO: we could allow peeking for user apps now
+
+	flags &= B_CAN_INTERRUPT | B_KILL_CAN_INTERRUPT | B_RELATIVE_TIMEOUT
+		| B_ABSOLUTE_TIMEOUT;
+
+	BReference<Port> portRef;
+	MutexLocker locker;
+	status_t status = lock_port_for_reading(id, flags, timeout, portRef,
+		locker);
+	if (status != B_OK)
+		return status;
+
+	port_message* message = portRef->messages.Head();
+
 	if (peekOnly) {
 		size_t size = copy_port_message(message, _code, buffer, bufferSize,
 			userCopy);
@@ -1510,14 +1713,7 @@ read_port_etc(port_id id, int32* _code, void* buffer, size_t bufferSize,
 		return size;
 	}
 
-	portRef->messages.RemoveHead();
-	portRef->total_count++;
-	portRef->write_count++;
-	portRef->read_count--;
-
-	notify_port_select_events(portRef, B_EVENT_WRITE);
-	portRef->write_condition.NotifyOne();
-		// make one spot in queue available again for write
+	remove_port_message(portRef);
 
 	T(Read(portRef, message->code, std::min(bufferSize, message->size)));
 
@@ -1531,6 +1727,141 @@ read_port_etc(port_id id, int32* _code, void* buffer, size_t bufferSize,
 }
 
 
+/*!	Reads the next message from the port into an area of its own that is
+	created in the caller's team, and returns its ID.
+	For large messages, this avoids copying the data altogether, as the area
+	the message is kept in is simply handed over to the caller.
+	The caller is responsible for deleting the area.
+*/
+area_id
+read_port_area_etc(port_id id, int32* _code, void** _address, size_t* _size,
+	uint32 flags, bigtime_t timeout)
+{
+	if (!sPortsActive || id < 0)
+		return B_BAD_PORT_ID;
+	if (_address == NULL || _size == NULL || timeout < 0
+		|| (flags & B_PEEK_PORT_MESSAGE) != 0)
+		return B_BAD_VALUE;
+
+	bool kernel = (flags & PORT_FLAG_USE_USER_MEMCPY) == 0;
+
+	flags &= B_CAN_INTERRUPT | B_KILL_CAN_INTERRUPT | B_RELATIVE_TIMEOUT
+		| B_ABSOLUTE_TIMEOUT;
+
+	BReference<Port> portRef;
+	MutexLocker locker;
+	status_t status = lock_port_for_reading(id, flags, timeout, portRef,
+		locker);
+	if (status != B_OK)
+		return status;
+
+	port_message* message = remove_port_message(portRef);
+
+	T(Read(portRef, message->code, message->size));
+
+	locker.Unlock();
+
+	int32 code = message->code;
+	size_t size = message->size;
+
+	area_id area = transfer_port_message(message, kernel
+			? VMAddressSpace::KernelID() : VMAddressSpace::CurrentID(),
+		kernel, _address);
+
+	put_port_message(message);
+
+	if (area < 0)
+		return area;
+
+	if (_code != NULL)
+		*_code = code;
+	*_size = size;
+	return area;
+}
+
+
+/*!	Reads as many messages from the port as fit into \a buffer, but waits
+	only for the first one. The messages are stored one after the other,
+	each preceded by a port_message_header. Returns the number of messages
+	read, or \c B_BUFFER_OVERFLOW if not even the first one fits.
+*/
+ssize_t
+read_port_multiple_etc(port_id id, void* buffer, size_t bufferSize,
+	uint32 flags, bigtime_t timeout)
+{
+	if (!sPortsActive || id < 0)
+		return B_BAD_PORT_ID;
+	if (buffer == NULL || timeout < 0)
+		return B_BAD_VALUE;
+
+	bool userCopy = (flags & PORT_FLAG_USE_USER_MEMCPY) != 0;
+
+	flags &= B_CAN_INTERRUPT | B_KILL_CAN_INTERRUPT | B_RELATIVE_TIMEOUT
+		| B_ABSOLUTE_TIMEOUT;
+
+	BReference<Port> portRef;
+	MutexLocker locker;
+	status_t status = lock_port_for_reading(id, flags, timeout, portRef,
+		locker);
+	if (status != B_OK)
+		return status;
+
+	// dequeue all messages that fit into the buffer
+	MessageList messages;
+	size_t bytesNeeded = 0;
+	int32 count = 0;
+
+	while (portRef->read_count > 0) {
+		port_message* message = portRef->messages.Head();
+		size_t size = sizeof(port_message_header)
+			+ PORT_MESSAGE_ALIGN(message->size);
+		if (bytesNeeded + size > bufferSize)
+			break;
+
+		remove_port_message(portRef);
+		T(Read(portRef, message->code, message->size));
+
+		messages.Add(message);
+		bytesNeeded += size;
+		count++;
+	}
+
+	if (count == 0) {
+		// let another reader have the message
+		portRef->read_condition.NotifyOne();
+		return B_BUFFER_OVERFLOW;
+	}
+
+	locker.Unlock();
+
+	uint8* target = (uint8*)buffer;
+	while (port_message* message = messages.RemoveHead()) {
+		if (status == B_OK) {
+			port_message_header header;
+			header.code = message->code;
+			header.size = message->size;
+
+			if (userCopy) {
+				if (user_memcpy(target, &header, sizeof(header)) != B_OK
+					|| user_memcpy(target + sizeof(header), message->Data(),
+						message->size) != B_OK)
+					status = B_BAD_ADDRESS;
+			} else {
+				memcpy(target, &header, sizeof(header));
+				memcpy(target + sizeof(header), message->Data(),
+					message->size);
+			}
+
+			target += sizeof(header) + PORT_MESSAGE_ALIGN(message->size);
+		}
+
+		put_port_message(message);
+	}
+
+	return status != B_OK ? status : count;
+}
+
+
 status_t
 write_port(port_id id, int32 msgCode, const void* buffer, size_t bufferSize)
 {
@@ -1556,11 +1887,35 @@ writev_port_etc(port_id id, int32 msgCode, const iovec* msgVecs,
 {
 	if (!sPortsActive || id < 0)
 		return B_BAD_PORT_ID;
-	if (bufferSize > PORT_MAX_MESSAGE_SIZE)
+	if (bufferSize > PORT_MAX_AREA_MESSAGE_SIZE)
 		return B_BAD_VALUE;
 
 	bool userCopy = (flags & PORT_FLAG_USE_USER_MEMCPY) != 0;
 
+	if (bufferSize >= kAreaMessageThreshold) {
+		// check the port first, so that writing to an invalid port doesn't
+		// create and fill a large area in vain
+		BReference<Port> portRef = get_locked_port(id);
+		if (portRef == NULL)
+			return B_BAD_PORT_ID;
+		MutexLocker locker(portRef->lock, true);
+		if (is_port_closed(portRef))
+			return B_BAD_PORT_ID;
+	}
+
+	// Large messages get an area of their own; since creating it might
+	// involve copying a lot of data, this is done before locking the port.
+	area_id area = -1;
+	void* areaAddress = NULL;
+	if (bufferSize >= kAreaMessageThreshold) {
+		status_t status = create_port_message_area(msgVecs, vecCount,
+			bufferSize, userCopy, area, areaAddress);
+		if (status != B_OK)
+			return status;
+	} else if (bufferSize > PORT_MAX_MESSAGE_SIZE)
+		return B_BAD_VALUE;
+	AreaDeleter areaDeleter(area);
+
 	// mask irrelevant flags (for acquire_sem() usage)
 	flags &= B_CAN_INTERRUPT | B_KILL_CAN_INTERRUPT | B_RELATIVE_TIMEOUT
 		| B_ABSOLUTE_TIMEOUT;
@@ -1621,8 +1976,8 @@ writev_port_etc(port_id id, int32 msgCode, const iovec* msgVecs,
 	} else
 		portRef->write_count--;
 
-	status = get_port_message(msgCode, bufferSize, flags, timeout,
-		&message, *portRef);
+	status = get_port_message(msgCode, bufferSize, area, areaAddress, flags,
+		timeout, &message, *portRef);
 	if (status != B_OK) {
 		if (status == B_BAD_PORT_ID) {
 			// the port had to be unlocked and is now no longer there
@@ -1633,12 +1988,15 @@ writev_port_etc(port_id id, int32 msgCode, const iovec* msgVecs,
 		goto error;
 	}
 
+	// the message owns the area now
+	areaDeleter.Detach();
+
 	// sender credentials
 	message->sender = geteuid();
 	message->sender_group = getegid();
 	message->sender_team = team_get_current_team_id();
 
-	if (bufferSize > 0) {
+	if (area < 0 && bufferSize > 0) {
 		size_t offset = 0;
 		for (uint32 i = 0; i < vecCount; i++) {
 			size_t bytes = msgVecs[i].iov_len;
@@ -1685,6 +2043,59 @@ error:
 }
 
 
+/*!	Writes all messages in \a buffer to the port; they must be stored the
+	same way read_port_multiple_etc() returns them. Returns the number of
+	messages written, which is only less than the number of messages in the
+	buffer, if an error occurred after the first one was written.
+*/
+ssize_t
+write_port_multiple_etc(port_id id, const void* buffer, size_t bufferSize,
+	uint32 flags, bigtime_t timeout)
+{
+	if (!sPortsActive || id < 0)
+		return B_BAD_PORT_ID;
+	if (buffer == NULL && bufferSize != 0)
+		return B_BAD_VALUE;
+
+	bool userCopy = (flags & PORT_FLAG_USE_USER_MEMCPY) != 0;
+
+	if ((flags & B_RELATIVE_TIMEOUT) != 0
+		&& timeout != B_INFINITE_TIMEOUT && timeout > 0) {
+		// the timeout is meant for the whole batch
+		flags = (flags & ~B_RELATIVE_TIMEOUT) | B_ABSOLUTE_TIMEOUT;
+		timeout += system_time();
+	}
+
+	const uint8* source = (const uint8*)buffer;
+	size_t offset = 0;
+	int32 count = 0;
+
+	while (offset + sizeof(port_message_header) <= bufferSize) {
+		port_message_header header;
+		if (userCopy) {
+			if (user_memcpy(&header, source + offset, sizeof(header)) != B_OK)
+				return count > 0 ? count : B_BAD_ADDRESS;
+		} else
+			memcpy(&header, source + offset, sizeof(header));
+
+		offset += sizeof(header);
+		if (header.size > bufferSize - offset)
+			return count > 0 ? count : B_BAD_VALUE;
+
+		iovec vec = { (void*)(source + offset), header.size };
+		status_t status = writev_port_etc(id, header.code, &vec, 1,
+			header.size, flags, timeout);
+		if (status != B_OK)
+			return count > 0 ? count : status;
+
+		offset += PORT_MESSAGE_ALIGN(header.size);
+		count++;
+	}
+
+	return count;
+}
+
+
 status_t
 set_port_owner(port_id id, team_id newTeamID)
 {
@@ -1865,6 +2276,37 @@ _user_set_port_owner(port_id port, team_id team)
 }
 
 
+area_id
+_user_read_port_area_etc(port_id port, int32* userCode, void** userAddress,
+	size_t* userSize, uint32 flags, bigtime_t timeout)
+{
+	syscall_restart_handle_timeout_pre(flags, timeout);
+
+	if (userAddress == NULL || userSize == NULL)
+		return B_BAD_VALUE;
+	if ((userCode != NULL && !IS_USER_ADDRESS(userCode))
+		|| !IS_USER_ADDRESS(userAddress) || !IS_USER_ADDRESS(userSize))
+		return B_BAD_ADDRESS;
+
+	int32 messageCode;
+	void* address;
+	size_t size;
+	area_id area = read_port_area_etc(port, &messageCode, &address, &size,
+		flags | PORT_FLAG_USE_USER_MEMCPY | B_CAN_INTERRUPT, timeout);
+
+	if (area >= 0
+		&& ((userCode != NULL
+				&& user_memcpy(userCode, &messageCode, sizeof(int32)) != B_OK)
+			|| user_memcpy(userAddress, &address, sizeof(void*)) != B_OK
+			|| user_memcpy(userSize, &size, sizeof(size_t)) != B_OK)) {
+		vm_delete_area(VMAddressSpace::CurrentID(), area, true);
+		return B_BAD_ADDRESS;
+	}
+
+	return syscall_restart_handle_timeout_post(area, timeout);
+}
+
+
 ssize_t
 _user_read_port_etc(port_id port, int32 *userCode, void *userBuffer,
 	size_t bufferSize, uint32 flags, bigtime_t timeout)
@@ -1891,6 +2333,42 @@ _user_read_port_etc(port_id port, int32 *userCode, void *userBuffer,
 }
 
 
+ssize_t
+_user_read_port_multiple_etc(port_id port, void* userBuffer,
+	size_t bufferSize, uint32 flags, bigtime_t timeout)
+{
+	syscall_restart_handle_timeout_pre(flags, timeout);
+
+	if (userBuffer == NULL)
+		return B_BAD_VALUE;
+	if (!IS_USER_ADDRESS(userBuffer))
+		return B_BAD_ADDRESS;
+
+	ssize_t count = read_port_multiple_etc(port, userBuffer, bufferSize,
+		flags | PORT_FLAG_USE_USER_MEMCPY | B_CAN_INTERRUPT, timeout);
+
+	return syscall_restart_handle_timeout_post(count, timeout);
+}
+
+
+ssize_t
+_user_write_port_multiple_etc(port_id port, const void* userBuffer,
+	size_t bufferSize, uint32 flags, bigtime_t timeout)
+{
+	syscall_restart_handle_timeout_pre(flags, timeout);
+
+	if (userBuffer == NULL && bufferSize != 0)
+		return B_BAD_VALUE;
+	if (userBuffer != NULL && !IS_USER_ADDRESS(userBuffer))
+		return B_BAD_ADDRESS;
+
+	ssize_t count = write_port_multiple_etc(port, userBuffer, bufferSize,
+		flags | PORT_FLAG_USE_USER_MEMCPY | B_CAN_INTERRUPT, timeout);
+
+	return syscall_restart_handle_timeout_post(count, timeout);
+}
+
+
 status_t
 _user_write_port_etc(port_id port, int32 messageCode, const void *userBuffer,
 	size_t bufferSize, uint32 flags, bigtime_t timeout)
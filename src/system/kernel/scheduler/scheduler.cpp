@@ -34,6 +34,7 @@
 #include "scheduler_locking.h"
 #include "scheduler_modes.h"
 #include "scheduler_profiler.h"
+#include "scheduler_statistics.h"
 #include "scheduler_thread.h"
 #include "scheduler_tracing.h"
 
@@ -102,6 +103,7 @@ enqueue(Thread* thread, bool newOne)
 	int32 threadPriority = threadData->GetEffectivePriority();
 	T(EnqueueThread(thread, threadPriority));
 
+	CoreEntry* previousCore = threadData->Core();
 	CPUEntry* targetCPU = NULL;
 	CoreEntry* targetCore = NULL;
 	if (thread->pinned_to_cpu > 0) {
@@ -120,6 +122,11 @@ enqueue(Thread* thread, bool newOne)
 	TRACE("enqueueing thread %ld with priority %ld on CPU %ld (core %ld)\n",
 		thread->id, threadPriority, targetCPU->fCPUNumber, targetCore->fCoreID);
 
+	if (previousCore != NULL && previousCore != targetCore)
+		Statistics::ThreadMigrated(threadData, previousCore, targetCPU);
+	if (newOne)
+		Statistics::ThreadWokenUp(threadData, targetCPU);
+
 	threadData->Enqueue();
 
 	// notify listeners
@@ -400,6 +407,8 @@ reschedule(int32 nextState)
 	ASSERT(!gCPU[thisCPU].disabled || nextThreadData->IsIdle());
 
 	if (nextThread != oldThread) {
+		Statistics::ThreadScheduled(nextThreadData, cpu);
+
 		if (enqueueOldThread) {
 			if (putOldThreadAtBack)
 				enqueue(oldThread, false);
@@ -718,6 +727,9 @@ scheduler_init()
 
 	init_debug_commands();
 
+	if (Statistics::Init() != B_OK)
+		dprintf("scheduler_init: failed to initialize statistics\n");
+
 #if SCHEDULER_TRACING
 	add_debugger_command_etc("scheduler", &cmd_scheduler,
 		"Analyze scheduler tracing information",
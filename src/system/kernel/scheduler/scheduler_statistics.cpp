@@ -0,0 +1,301 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "scheduler_statistics.h"
+
+#if SCHEDULER_STATISTICS
+
+#include <stdint.h>
+#include <string.h>
+
+#include <new>
+
+#include <AutoDeleter.h>
+#include <generic_syscall.h>
+#include <kernel.h>
+#include <smp.h>
+#include <util/AutoLock.h>
+
+#include "scheduler_cpu.h"
+#include "scheduler_thread.h"
+
+
+using namespace Scheduler;
+
+
+// must be a power of two
+static const uint32 kTraceEntryCount = 512;
+
+
+struct CPUStatistics {
+	spinlock					lock;
+	scheduler_cpu_statistics	statistics;
+	scheduler_trace_entry		entries[kTraceEntryCount];
+};
+
+static CPUStatistics* sCPUStatistics;
+static int32 sCPUCount;
+
+
+static inline int32
+latency_bucket(bigtime_t latency)
+{
+	int32 bucket = 0;
+	while (latency > 0 && bucket < SCHEDULER_LATENCY_BUCKETS - 1) {
+		latency >>= 1;
+		bucket++;
+	}
+	return bucket;
+}
+
+
+/*!	Appends an entry to the trace ring of the CPU. The statistics of the CPU
+	must be locked.
+*/
+static inline void
+add_trace_entry(CPUStatistics& cpuStatistics, Thread* thread, uint16 type,
+	CoreEntry* core, int32 value)
+{
+	scheduler_cpu_statistics& statistics = cpuStatistics.statistics;
+	scheduler_trace_entry& entry = cpuStatistics.entries[
+		statistics.trace_entries++ & (kTraceEntryCount - 1)];
+
+	entry.time = system_time();
+	entry.thread = thread->id;
+	entry.type = type;
+	entry.run_queue_length = core->ThreadCount();
+	entry.core = core->ID();
+	entry.core_load = gTrackCoreLoad ? core->GetLoad() : 0;
+	entry.value = value;
+}
+
+
+static status_t
+scheduler_statistics_syscall(const char* subsystem, uint32 function,
+	void* buffer, size_t bufferSize)
+{
+	switch (function) {
+		case GET_SCHEDULER_CPU_STATISTICS:
+		{
+			// fills an array with the statistics of all CPUs
+			if (bufferSize < sizeof(scheduler_cpu_statistics) * sCPUCount)
+				return B_BUFFER_OVERFLOW;
+			if (!IS_USER_ADDRESS(buffer))
+				return B_BAD_ADDRESS;
+
+			scheduler_cpu_statistics* userStatistics
+				= (scheduler_cpu_statistics*)buffer;
+			for (int32 i = 0; i < sCPUCount; i++) {
+				scheduler_cpu_statistics statistics;
+				status_t status = Statistics::GetCPUStatistics(i, statistics);
+				if (status != B_OK)
+					return status;
+
+				if (user_memcpy(&userStatistics[i], &statistics,
+						sizeof(statistics)) != B_OK) {
+					return B_BAD_ADDRESS;
+				}
+			}
+			return B_OK;
+		}
+
+		case GET_SCHEDULER_TRACE:
+		{
+			scheduler_trace_request request;
+			if (bufferSize < sizeof(request))
+				return B_BAD_VALUE;
+			if (!IS_USER_ADDRESS(buffer)
+				|| user_memcpy(&request, buffer, sizeof(request)) != B_OK) {
+				return B_BAD_ADDRESS;
+			}
+
+			uint32 count = std::min(request.count, kTraceEntryCount);
+			if (count > 0 && !IS_USER_ADDRESS(request.entries))
+				return B_BAD_ADDRESS;
+
+			scheduler_trace_entry* entries
+				= new(std::nothrow) scheduler_trace_entry[kTraceEntryCount];
+			if (entries == NULL)
+				return B_NO_MEMORY;
+			ArrayDeleter<scheduler_trace_entry> entriesDeleter(entries);
+
+			status_t status = Statistics::GetTrace(request.cpu, entries,
+				count, request.first);
+			if (status != B_OK)
+				return status;
+
+			request.count = count;
+			if (user_memcpy(request.entries, entries,
+					sizeof(scheduler_trace_entry) * count) != B_OK
+				|| user_memcpy(buffer, &request, sizeof(request)) != B_OK) {
+				return B_BAD_ADDRESS;
+			}
+			return B_OK;
+		}
+	}
+
+	return B_BAD_HANDLER;
+}
+
+
+//	#pragma mark -
+
+
+status_t
+Statistics::Init()
+{
+	sCPUCount = smp_get_num_cpus();
+	sCPUStatistics = new(std::nothrow) CPUStatistics[sCPUCount];
+	if (sCPUStatistics == NULL)
+		return B_NO_MEMORY;
+
+	for (int32 i = 0; i < sCPUCount; i++) {
+		B_INITIALIZE_SPINLOCK(&sCPUStatistics[i].lock);
+		memset(&sCPUStatistics[i].statistics, 0,
+			sizeof(scheduler_cpu_statistics));
+		sCPUStatistics[i].statistics.cpu = i;
+	}
+
+	return register_generic_syscall(SCHEDULER_STATISTICS_SYSCALLS,
+		&scheduler_statistics_syscall, 1, 0);
+}
+
+
+/*!	Called when \a thread becomes ready after sleeping, or for the first time,
+	and has been assigned to \a cpu.
+*/
+void
+Statistics::ThreadWokenUp(ThreadData* thread, CPUEntry* cpu)
+{
+	if (sCPUStatistics == NULL || thread->IsIdle())
+		return;
+
+	thread->SetWokenUp(system_time());
+
+	CPUStatistics& cpuStatistics = sCPUStatistics[cpu->ID()];
+	SpinLocker _(cpuStatistics.lock);
+
+	cpuStatistics.statistics.wake_ups++;
+	add_trace_entry(cpuStatistics, thread->GetThread(),
+		SCHEDULER_TRACE_WAKE_UP, cpu->Core(), 0);
+}
+
+
+void
+Statistics::ThreadMigrated(ThreadData* thread, CoreEntry* previousCore,
+	CPUEntry* cpu)
+{
+	if (sCPUStatistics == NULL)
+		return;
+
+	CPUStatistics& cpuStatistics = sCPUStatistics[cpu->ID()];
+	SpinLocker _(cpuStatistics.lock);
+
+	cpuStatistics.statistics.migrations++;
+	add_trace_entry(cpuStatistics, thread->GetThread(),
+		SCHEDULER_TRACE_MIGRATE, cpu->Core(), previousCore->ID());
+}
+
+
+/*!	Called when \a thread gets to run on \a cpu, instead of another thread.
+*/
+void
+Statistics::ThreadScheduled(ThreadData* thread, CPUEntry* cpu)
+{
+	if (sCPUStatistics == NULL)
+		return;
+
+	CPUStatistics& cpuStatistics = sCPUStatistics[cpu->ID()];
+	scheduler_cpu_statistics& statistics = cpuStatistics.statistics;
+	CoreEntry* core = cpu->Core();
+
+	bigtime_t latency = -1;
+	if (thread->WokenUp() != 0) {
+		latency = system_time() - thread->WokenUp();
+		thread->SetWokenUp(0);
+	}
+
+	SpinLocker _(cpuStatistics.lock);
+
+	statistics.context_switches++;
+
+	int32 runQueueLength = core->ThreadCount();
+	statistics.run_queue_samples++;
+	statistics.run_queue_length_sum += runQueueLength;
+	statistics.max_run_queue_length
+		= std::max(statistics.max_run_queue_length, runQueueLength);
+
+	if (latency >= 0) {
+		statistics.total_wake_up_latency += latency;
+		statistics.max_wake_up_latency
+			= std::max(statistics.max_wake_up_latency, latency);
+		statistics.wake_up_latencies[latency_bucket(latency)]++;
+	}
+
+	if (thread->IsIdle())
+		return;
+
+	add_trace_entry(cpuStatistics, thread->GetThread(),
+		SCHEDULER_TRACE_SCHEDULE, core,
+		(int32)std::min(latency, (bigtime_t)INT32_MAX));
+}
+
+
+status_t
+Statistics::GetCPUStatistics(int32 cpu, scheduler_cpu_statistics& statistics)
+{
+	if (sCPUStatistics == NULL)
+		return B_NO_INIT;
+	if (cpu < 0 || cpu >= sCPUCount)
+		return B_BAD_VALUE;
+
+	CPUStatistics& cpuStatistics = sCPUStatistics[cpu];
+
+	InterruptsSpinLocker locker(cpuStatistics.lock);
+	statistics = cpuStatistics.statistics;
+	locker.Unlock();
+
+	CPUEntry* entry = CPUEntry::GetCPU(cpu);
+	CoreEntry* core = entry->Core();
+	statistics.core = core->ID();
+	statistics.load = gTrackCPULoad ? entry->GetLoad() : 0;
+	statistics.core_load
+		= gTrackCoreLoad && core->CPUCount() > 0 ? core->GetLoad() : 0;
+
+	return B_OK;
+}
+
+
+/*!	Copies the last \a count entries of the trace ring of \a cpu, the oldest
+	first. \a entries must have room for the whole ring.
+*/
+status_t
+Statistics::GetTrace(int32 cpu, scheduler_trace_entry* entries, uint32& count,
+	uint64& first)
+{
+	if (sCPUStatistics == NULL)
+		return B_NO_INIT;
+	if (cpu < 0 || cpu >= sCPUCount)
+		return B_BAD_VALUE;
+
+	CPUStatistics& cpuStatistics = sCPUStatistics[cpu];
+
+	InterruptsSpinLocker _(cpuStatistics.lock);
+
+	uint64 total = cpuStatistics.statistics.trace_entries;
+	count = (uint32)std::min((uint64)std::min(count, kTraceEntryCount), total);
+	first = total - count;
+
+	for (uint32 i = 0; i < count; i++) {
+		entries[i] = cpuStatistics.entries[
+			(first + i) & (kTraceEntryCount - 1)];
+	}
+
+	return B_OK;
+}
+
+
+#endif	// SCHEDULER_STATISTICS
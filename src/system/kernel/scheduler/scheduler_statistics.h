@@ -0,0 +1,75 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef KERNEL_SCHEDULER_STATISTICS_H
+#define KERNEL_SCHEDULER_STATISTICS_H
+
+
+#include <debug.h>
+#include <scheduler_defs.h>
+
+
+namespace Scheduler {
+
+
+class CPUEntry;
+class CoreEntry;
+struct ThreadData;
+
+
+namespace Statistics {
+
+
+#if SCHEDULER_STATISTICS
+
+
+status_t	Init();
+
+void		ThreadWokenUp(ThreadData* thread, CPUEntry* cpu);
+void		ThreadMigrated(ThreadData* thread, CoreEntry* previousCore,
+				CPUEntry* cpu);
+void		ThreadScheduled(ThreadData* thread, CPUEntry* cpu);
+
+status_t	GetCPUStatistics(int32 cpu, scheduler_cpu_statistics& statistics);
+status_t	GetTrace(int32 cpu, scheduler_trace_entry* entries,
+				uint32& count, uint64& first);
+
+
+#else	// SCHEDULER_STATISTICS
+
+
+static inline status_t
+Init()
+{
+	return B_OK;
+}
+
+
+static inline void
+ThreadWokenUp(ThreadData* thread, CPUEntry* cpu)
+{
+}
+
+
+static inline void
+ThreadMigrated(ThreadData* thread, CoreEntry* previousCore, CPUEntry* cpu)
+{
+}
+
+
+static inline void
+ThreadScheduled(ThreadData* thread, CPUEntry* cpu)
+{
+}
+
+
+#endif	// !SCHEDULER_STATISTICS
+
+
+}	// namespace Statistics
+
+}	// namespace Scheduler
+
+
+#endif	// KERNEL_SCHEDULER_STATISTICS_H
@@ -24,6 +24,7 @@ ThreadData::_InitBase()
 
 	fWentSleep = 0;
 	fWentSleepActive = 0;
+	fWokenUp = 0;
 
 	fEnqueued = false;
 	fReady = false;
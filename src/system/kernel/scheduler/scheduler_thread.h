@@ -73,6 +73,9 @@ public:
 	inline	bigtime_t	WentSleep() const	{ return fWentSleep; }
 	inline	bigtime_t	WentSleepActive() const	{ return fWentSleepActive; }
 
+	inline	void		SetWokenUp(bigtime_t time)	{ fWokenUp = time; }
+	inline	bigtime_t	WokenUp() const	{ return fWokenUp; }
+
 	inline	void		PutBack();
 	inline	void		Enqueue();
 	inline	bool		Dequeue();
@@ -107,6 +110,7 @@ private:
 
 			bigtime_t	fWentSleep;
 			bigtime_t	fWentSleepActive;
+			bigtime_t	fWokenUp;
 
 			bool		fEnqueued;
 			bool		fReady;
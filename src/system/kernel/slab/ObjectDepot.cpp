@@ -15,6 +15,7 @@
 #include <slab/Slab.h>
 #include <smp.h>
 #include <util/AutoLock.h>
+#include <util/atomic.h>
 
 #include "slab_debug.h"
 #include "slab_private.h"
@@ -45,6 +46,22 @@ struct depot_cpu_store {
 };
 
 
+struct depot_store_collector {
+	object_depot*	depot;
+	DepotMagazine*	magazines;
+	void*			object;
+	bool			found;
+};
+
+
+// The magazine capacity of a depot is doubled (up to kMaxMagazineGrowth
+// times its initial value) when at least one in kContentionRatio of the last
+// kContentionWindow exchanges with the depot lists was contended.
+static const int32 kContentionWindow = 256;
+static const int32 kContentionRatio = 16;
+static const int32 kMaxMagazineGrowth = 4;
+
+
 RANGE_MARKER_FUNCTION_BEGIN(SlabObjectDepot)
 
 
@@ -102,13 +119,13 @@ DepotMagazine::ContainsObject(void* object) const
 static DepotMagazine*
 alloc_magazine(object_depot* depot, uint32 flags)
 {
+	int32 capacity = atomic_get(&depot->magazine_capacity);
 	DepotMagazine* magazine = (DepotMagazine*)slab_internal_alloc(
-		sizeof(DepotMagazine) + depot->magazine_capacity * sizeof(void*),
-		flags);
+		sizeof(DepotMagazine) + capacity * sizeof(void*), flags);
 	if (magazine) {
 		magazine->next = NULL;
 		magazine->current_round = 0;
-		magazine->round_count = depot->magazine_capacity;
+		magazine->round_count = capacity;
 	}
 
 	return magazine;
@@ -131,21 +148,109 @@ empty_magazine(object_depot* depot, DepotMagazine* magazine, uint32 flags)
 }
 
 
+/*!	Pushes \a magazine onto \a list without any locking. Returns whether or
+	not another CPU changed the list while we were trying to.
+*/
+static bool
+push_magazine(DepotMagazine** list, DepotMagazine* magazine)
+{
+	bool contended = false;
+
+	while (true) {
+		DepotMagazine* head = atomic_pointer_get(list);
+		magazine->next = head;
+		if (atomic_pointer_test_and_set(list, magazine, head) == head)
+			return contended;
+
+		contended = true;
+	}
+}
+
+
+/*!	Pops the first magazine off \a list.
+	Pushing is lock-free, but only one CPU at a time may pop from the depot
+	lists, or a magazine could be popped and pushed again between our reading
+	its \c next field and swapping the list head. The lock is only held for
+	the length of the swap, and never on the allocation fast path.
+	Must be called with interrupts disabled.
+*/
+static DepotMagazine*
+pop_magazine(object_depot* depot, DepotMagazine** list, bool& contended)
+{
+	contended = !try_acquire_spinlock(&depot->inner_lock);
+	if (contended)
+		acquire_spinlock(&depot->inner_lock);
+
+	DepotMagazine* magazine;
+	while (true) {
+		magazine = atomic_pointer_get(list);
+		if (magazine == NULL
+			|| atomic_pointer_test_and_set(list, magazine->next, magazine)
+				== magazine) {
+			break;
+		}
+
+		contended = true;
+	}
+
+	release_spinlock(&depot->inner_lock);
+	return magazine;
+}
+
+
+/*!	Accounts for an exchange of magazines with the depot lists, and grows the
+	magazine capacity if too many of them had to wait for other CPUs. Larger
+	magazines make the CPUs return to the depot less often; the magazines
+	that are already in use are replaced as they come back empty.
+*/
+static void
+update_magazine_capacity(object_depot* depot, bool contended)
+{
+	if (contended)
+		atomic_add(&depot->contention_count, 1);
+
+	if ((uint32)(atomic_add(&depot->exchange_count, 1) + 1)
+			% kContentionWindow != 0) {
+		return;
+	}
+
+	int32 contention = atomic_get_and_set(&depot->contention_count, 0);
+	int32 capacity = atomic_get(&depot->magazine_capacity);
+	if (contention * kContentionRatio < kContentionWindow
+		|| capacity >= depot->max_magazine_capacity) {
+		return;
+	}
+
+	atomic_test_and_set(&depot->magazine_capacity,
+		std::min(capacity * 2, depot->max_magazine_capacity), capacity);
+}
+
+
 static bool
-exchange_with_full(object_depot* depot, DepotMagazine*& magazine)
+exchange_with_full(object_depot* depot, DepotMagazine*& magazine,
+	DepotMagazine*& freeMagazine)
 {
 	ASSERT(magazine->IsEmpty());
 
-	SpinLocker _(depot->inner_lock);
+	bool contended;
+	DepotMagazine* full = pop_magazine(depot, &depot->full, contended);
+	update_magazine_capacity(depot, contended);
 
-	if (depot->full == NULL)
+	if (full == NULL)
 		return false;
 
-	depot->full_count--;
-	depot->empty_count++;
+	atomic_add(&depot->full_count, -1);
 
-	_push(depot->empty, magazine);
-	magazine = _pop(depot->full);
+	if (magazine->round_count < atomic_get(&depot->magazine_capacity)) {
+		// the magazine is smaller than what we use now, retire it
+		freeMagazine = magazine;
+	} else {
+		if (push_magazine(&depot->empty, magazine))
+			atomic_add(&depot->contention_count, 1);
+		atomic_add(&depot->empty_count, 1);
+	}
+
+	magazine = full;
 	return true;
 }
 
@@ -156,23 +261,26 @@ exchange_with_empty(object_depot* depot, DepotMagazine*& magazine,
 {
 	ASSERT(magazine == NULL || magazine->IsFull());
 
-	SpinLocker _(depot->inner_lock);
+	bool contended;
+	DepotMagazine* empty = pop_magazine(depot, &depot->empty, contended);
+	update_magazine_capacity(depot, contended);
 
-	if (depot->empty == NULL)
+	if (empty == NULL)
 		return false;
 
-	depot->empty_count--;
+	atomic_add(&depot->empty_count, -1);
 
 	if (magazine != NULL) {
-		if (depot->full_count < depot->max_count) {
-			_push(depot->full, magazine);
-			depot->full_count++;
+		if (atomic_get(&depot->full_count) < depot->max_count) {
+			if (push_magazine(&depot->full, magazine))
+				atomic_add(&depot->contention_count, 1);
+			atomic_add(&depot->full_count, 1);
 			freeMagazine = NULL;
 		} else
 			freeMagazine = magazine;
 	}
 
-	magazine = _pop(depot->empty);
+	magazine = empty;
 	return true;
 }
 
@@ -180,10 +288,9 @@ exchange_with_empty(object_depot* depot, DepotMagazine*& magazine,
 static void
 push_empty_magazine(object_depot* depot, DepotMagazine* magazine)
 {
-	SpinLocker _(depot->inner_lock);
-
-	_push(depot->empty, magazine);
-	depot->empty_count++;
+	if (push_magazine(&depot->empty, magazine))
+		atomic_add(&depot->contention_count, 1);
+	atomic_add(&depot->empty_count, 1);
 }
 
 
@@ -194,6 +301,28 @@ object_depot_cpu(object_depot* depot)
 }
 
 
+/*!	Called on every CPU via call_all_cpus_sync(): since the CPU stores are
+	used without any locking, only their own CPU may take their magazines
+	away.
+*/
+static void
+collect_store_magazines(void* _collector, int cpu)
+{
+	depot_store_collector* collector = (depot_store_collector*)_collector;
+	depot_cpu_store& store = collector->depot->stores[cpu];
+
+	if (store.loaded != NULL) {
+		push_magazine(&collector->magazines, store.loaded);
+		store.loaded = NULL;
+	}
+
+	if (store.previous != NULL) {
+		push_magazine(&collector->magazines, store.previous);
+		store.previous = NULL;
+	}
+}
+
+
 // #pragma mark - public API
 
 
@@ -207,6 +336,12 @@ object_depot_init(object_depot* depot, size_t capacity, size_t maxCount,
 	depot->full_count = depot->empty_count = 0;
 	depot->max_count = maxCount;
 	depot->magazine_capacity = capacity;
+	depot->min_magazine_capacity = capacity;
+	depot->max_magazine_capacity = std::min(capacity * kMaxMagazineGrowth,
+		(size_t)0xffff);
+		// DepotMagazine::round_count is an uint16
+	depot->exchange_count = 0;
+	depot->contention_count = 0;
 
 	rw_lock_init(&depot->outer_lock, "object depot");
 	B_INITIALIZE_SPINLOCK(&depot->inner_lock);
@@ -243,9 +378,8 @@ object_depot_destroy(object_depot* depot, uint32 flags)
 
 
 void*
-object_depot_obtain(object_depot* depot)
+object_depot_obtain(object_depot* depot, uint32 flags)
 {
-	ReadLocker readLocker(depot->outer_lock);
 	InterruptsLocker interruptsLocker;
 
 	depot_cpu_store* store = object_depot_cpu(depot);
@@ -257,27 +391,42 @@ object_depot_obtain(object_depot* depot)
 	// if it's not empty, or from the previous magazine if it's full
 	// and finally from the Slab if the magazine depot has no full magazines.
 
+	// With interrupts disabled, nobody else can touch the CPU store, so the
+	// common case doesn't need any lock at all.
+
 	if (store->loaded == NULL)
 		return NULL;
 
+	void* object = NULL;
+	DepotMagazine* freeMagazine = NULL;
+
 	while (true) {
-		if (!store->loaded->IsEmpty())
-			return store->loaded->Pop();
+		if (!store->loaded->IsEmpty()) {
+			object = store->loaded->Pop();
+			break;
+		}
 
 		if (store->previous
 			&& (store->previous->IsFull()
-				|| exchange_with_full(depot, store->previous))) {
+				|| exchange_with_full(depot, store->previous,
+					freeMagazine))) {
 			std::swap(store->previous, store->loaded);
 		} else
-			return NULL;
+			break;
 	}
+
+	interruptsLocker.Unlock();
+
+	if (freeMagazine != NULL)
+		free_magazine(freeMagazine, flags);
+
+	return object;
 }
 
 
 void
 object_depot_store(object_depot* depot, void* object, uint32 flags)
 {
-	ReadLocker readLocker(depot->outer_lock);
 	InterruptsLocker interruptsLocker;
 
 	depot_cpu_store* store = object_depot_cpu(depot);
@@ -299,11 +448,9 @@ object_depot_store(object_depot* depot, void* object, uint32 flags)
 			if (freeMagazine != NULL) {
 				// Free the magazine that didn't have space in the list
 				interruptsLocker.Unlock();
-				readLocker.Unlock();
 
 				empty_magazine(depot, freeMagazine, flags);
 
-				readLocker.Lock();
 				interruptsLocker.Lock();
 
 				store = object_depot_cpu(depot);
@@ -311,7 +458,6 @@ object_depot_store(object_depot* depot, void* object, uint32 flags)
 		} else {
 			// allocate a new empty magazine
 			interruptsLocker.Unlock();
-			readLocker.Unlock();
 
 			DepotMagazine* magazine = alloc_magazine(depot, flags);
 			if (magazine == NULL) {
@@ -319,7 +465,6 @@ object_depot_store(object_depot* depot, void* object, uint32 flags)
 				return;
 			}
 
-			readLocker.Lock();
 			interruptsLocker.Lock();
 
 			push_empty_magazine(depot, magazine);
@@ -336,31 +481,29 @@ object_depot_make_empty(object_depot* depot, uint32 flags)
 
 	// collect the store magazines
 
-	DepotMagazine* storeMagazines = NULL;
-
-	int cpuCount = smp_get_num_cpus();
-	for (int i = 0; i < cpuCount; i++) {
-		depot_cpu_store& store = depot->stores[i];
-
-		if (store.loaded) {
-			_push(storeMagazines, store.loaded);
-			store.loaded = NULL;
-		}
+	depot_store_collector collector;
+	collector.depot = depot;
+	collector.magazines = NULL;
+	call_all_cpus_sync(&collect_store_magazines, &collector);
 
-		if (store.previous) {
-			_push(storeMagazines, store.previous);
-			store.previous = NULL;
-		}
-	}
+	DepotMagazine* storeMagazines = collector.magazines;
 
 	// detach the depot's full and empty magazines
 
-	DepotMagazine* fullMagazines = depot->full;
-	depot->full = NULL;
+	InterruptsSpinLocker locker(depot->inner_lock);
 
-	DepotMagazine* emptyMagazines = depot->empty;
-	depot->empty = NULL;
+	DepotMagazine* fullMagazines = atomic_pointer_get_and_set(&depot->full,
+		(DepotMagazine*)NULL);
+	DepotMagazine* emptyMagazines = atomic_pointer_get_and_set(&depot->empty,
+		(DepotMagazine*)NULL);
+	atomic_set(&depot->full_count, 0);
+	atomic_set(&depot->empty_count, 0);
+
+	// we are short on memory, start over with small magazines
+	atomic_set(&depot->magazine_capacity, depot->min_magazine_capacity);
+	atomic_set(&depot->contention_count, 0);
 
+	locker.Unlock();
 	writeLocker.Unlock();
 
 	// free all magazines
@@ -378,25 +521,38 @@ object_depot_make_empty(object_depot* depot, uint32 flags)
 
 #if PARANOID_KERNEL_FREE
 
+static void
+find_store_object(void* _collector, int cpu)
+{
+	depot_store_collector* collector = (depot_store_collector*)_collector;
+	depot_cpu_store& store = collector->depot->stores[cpu];
+
+	if (store.loaded != NULL && !store.loaded->IsEmpty()
+		&& store.loaded->ContainsObject(collector->object)) {
+		collector->found = true;
+	}
+
+	if (store.previous != NULL && !store.previous->IsEmpty()
+		&& store.previous->ContainsObject(collector->object)) {
+		collector->found = true;
+	}
+}
+
+
 bool
 object_depot_contains_object(object_depot* depot, void* object)
 {
 	WriteLocker writeLocker(depot->outer_lock);
 
-	int cpuCount = smp_get_num_cpus();
-	for (int i = 0; i < cpuCount; i++) {
-		depot_cpu_store& store = depot->stores[i];
-
-		if (store.loaded != NULL && !store.loaded->IsEmpty()) {
-			if (store.loaded->ContainsObject(object))
-				return true;
-		}
+	depot_store_collector collector;
+	collector.depot = depot;
+	collector.object = object;
+	collector.found = false;
+	call_all_cpus_sync(&find_store_object, &collector);
+	if (collector.found)
+		return true;
 
-		if (store.previous != NULL && !store.previous->IsEmpty()) {
-			if (store.previous->ContainsObject(object))
-				return true;
-		}
-	}
+	InterruptsSpinLocker locker(depot->inner_lock);
 
 	for (DepotMagazine* magazine = depot->full; magazine != NULL;
 			magazine = magazine->next) {
@@ -416,10 +572,16 @@ object_depot_contains_object(object_depot* depot, void* object)
 void
 dump_object_depot(object_depot* depot)
 {
-	kprintf("  full:     %p, count %lu\n", depot->full, depot->full_count);
-	kprintf("  empty:    %p, count %lu\n", depot->empty, depot->empty_count);
-	kprintf("  max full: %lu\n", depot->max_count);
-	kprintf("  capacity: %lu\n", depot->magazine_capacity);
+	kprintf("  full:     %p, count %" B_PRId32 "\n", depot->full,
+		depot->full_count);
+	kprintf("  empty:    %p, count %" B_PRId32 "\n", depot->empty,
+		depot->empty_count);
+	kprintf("  max full: %" B_PRId32 "\n", depot->max_count);
+	kprintf("  capacity: %" B_PRId32 " (%" B_PRId32 " - %" B_PRId32 ")\n",
+		depot->magazine_capacity, depot->min_magazine_capacity,
+		depot->max_magazine_capacity);
+	kprintf("  exchanges: %" B_PRId32 ", %" B_PRId32 " contended\n",
+		depot->exchange_count, depot->contention_count);
 	kprintf("  stores:\n");
 
 	int cpuCount = smp_get_num_cpus();
@@ -1219,7 +1219,7 @@ void*
 object_cache_alloc(object_cache* cache, uint32 flags)
 {
 	if (!(cache->flags & CACHE_NO_DEPOT)) {
-		void* object = object_depot_obtain(&cache->depot);
+		void* object = object_depot_obtain(&cache->depot, flags);
 		if (object) {
 			add_alloc_tracing_entry(cache, flags, object);
 			return fill_allocated_block(object, cache->object_size);
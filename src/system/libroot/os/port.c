@@ -52,6 +52,33 @@ read_port_etc(port_id port, int32 *code, void *buffer, size_t bufferSize,
 }
 
 
+area_id
+read_port_area_etc(port_id port, int32 *code, void **_address, size_t *_size,
+	uint32 flags, bigtime_t timeout)
+{
+	return _kern_read_port_area_etc(port, code, _address, _size, flags,
+		timeout);
+}
+
+
+ssize_t
+read_port_multiple_etc(port_id port, void *buffer, size_t bufferSize,
+	uint32 flags, bigtime_t timeout)
+{
+	return _kern_read_port_multiple_etc(port, buffer, bufferSize, flags,
+		timeout);
+}
+
+
+ssize_t
+write_port_multiple_etc(port_id port, const void *buffer, size_t bufferSize,
+	uint32 flags, bigtime_t timeout)
+{
+	return _kern_write_port_multiple_etc(port, buffer, bufferSize, flags,
+		timeout);
+}
+
+
 ssize_t
 port_buffer_size(port_id port)
 {
@@ -0,0 +1,1287 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	A scalable allocator built from size class slabs and per-thread caches.
+
+	All memory is taken in 64 kB chunks from arena areas. The address range of
+	the first arena is reserved up front; the area itself is aligned to, and
+	grown in steps of 2 MB, so that it can be backed by large pages. When an
+	arena cannot grow any further, another, smaller one is reserved, or, if
+	even that fails, a plain area just large enough for the request is
+	created, like the Hoard allocator does.
+
+	Small allocations (up to 8 kB) are served from slabs of one chunk each,
+	that only contain objects of a single size class. The slab header lives at
+	the start of the chunk, and is found by masking the object address. Larger
+	allocations get a run of chunks with a header in front of the returned
+	address, such that the same mask finds it.
+
+	Every thread caches free objects per size class, so that neither malloc()
+	nor free() need any locks in the common case. When a thread cache
+	overflows, it returns a batch of objects to the central list of the size
+	class with a lock-free push; objects can therefore be freed by any thread
+	without contention on the thread that allocated them. Thread caches are
+	refilled by popping a batch, or by carving new objects from the slabs
+	under the size class lock.
+*/
+
+
+#include "heap.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <OS.h>
+#include <TLS.h>
+
+#include <libroot_private.h>
+#include <locks.h>
+#include <syscalls.h>
+
+
+//#define TRACE_SLAB_HEAP
+#ifdef TRACE_SLAB_HEAP
+#	define TRACE(x...) debug_printf("slab heap: " x)
+#else
+#	define TRACE(x...) do {} while (false)
+#endif
+
+
+namespace BPrivate {
+
+
+static const size_t kChunkShift = 16;
+static const size_t kChunkSize = (size_t)1 << kChunkShift;
+static const addr_t kChunkMask = ~(addr_t)(kChunkSize - 1);
+
+static const size_t kArenaIncrement = 2 * 1024 * 1024;
+	// the arena is aligned to and grown in steps of this size, so that it can
+	// be mapped with large pages
+#if B_HAIKU_64_BIT
+static const size_t kArenaReservationSize = (size_t)64 * 1024 * 1024 * 1024;
+static const size_t kMoreArenaReservationSize = 1024 * 1024 * 1024;
+#else
+static const size_t kArenaReservationSize = 128 * 1024 * 1024;
+static const size_t kMoreArenaReservationSize = 32 * 1024 * 1024;
+#endif
+	// the size of the first arena, and of any further ones
+static const size_t kMinArenaReservationSize = 8 * 1024 * 1024;
+static const int32 kMaxArenas = 64;
+
+static const size_t kHeaderSize = 64;
+	// size of the slab and large allocation headers, this is also the
+	// largest alignment guaranteed for small allocations
+static const size_t kMaxSmallSize = 8192;
+static const size_t kMaxBatchBytes = 32 * 1024;
+static const uint32 kMaxBatchSize = 64;
+static const uint32 kMinBatchSize = 2;
+static const int32 kMaxCentralBatches = 32;
+	// when more batches are queued, they are returned to their slabs
+static const size_t kMaxThreadCacheSize = 4 * 1024 * 1024;
+
+static const uint32 kSlabMagic = 'slab';
+static const uint32 kLargeMagic = 'larg';
+
+#define SIZE_CLASS_COUNT	32
+
+static const uint32 kSizeClasses[SIZE_CLASS_COUNT] = {
+	16, 32, 48, 64, 80, 96, 112, 128,
+	160, 192, 224, 256, 320, 384, 448, 512,
+	640, 768, 896, 1024, 1280, 1536, 1792, 2048,
+	2560, 3072, 3584, 4096, 5120, 6144, 7168, 8192
+};
+
+
+struct free_object {
+	free_object*	next;
+};
+
+// A full batch of free objects, as pushed to the central list of a size class.
+// The first object of the batch doubles as its list link.
+struct object_batch {
+	object_batch*	next_batch;
+	free_object*	objects;
+};
+
+struct slab {
+	uint32			magic;
+	uint32			size_class;
+	uint32			object_size;
+	uint32			object_count;
+	uint32			used_count;
+	bool			in_list;
+	free_object*	free_list;
+	addr_t			next_unused;
+	addr_t			end;
+	slab*			next;
+	slab*			previous;
+};
+
+struct large_allocation {
+	uint32			magic;
+	uint32			chunk_offset;
+		// number of chunks in front of the header
+	size_t			chunk_count;
+	size_t			size;
+};
+
+struct free_run {
+	free_run*		next;
+	size_t			chunk_count;
+};
+
+struct slab_arena {
+	area_id			area;
+	addr_t			base;
+	addr_t			top;
+		// end of the chunks handed out so far
+	addr_t			end;
+		// end of the arena area
+	addr_t			limit;
+		// end of the reserved address range
+	free_run*		free_runs;
+		// sorted by address
+	size_t			free_chunk_count;
+};
+
+struct central_cache {
+	mutex			lock;
+	slab*			partial_slabs;
+		// slabs that have free objects left
+	slab*			empty_slab;
+		// a completely unused slab kept to avoid trashing the arena
+	object_batch*	batches;
+	int32			batch_count;
+	uint32			batch_size;
+	uint32			object_size;
+	size_t			slab_count;
+} __attribute__((aligned(64)));
+
+struct thread_cache {
+	free_object*	lists[SIZE_CLASS_COUNT];
+	uint32			counts[SIZE_CLASS_COUNT];
+	uint32			limits[SIZE_CLASS_COUNT];
+	size_t			cached_bytes;
+	thread_cache*	next;
+	thread_cache*	previous;
+};
+
+
+static bool sInitialized;
+static int32 sThreadCacheSlot = -1;
+static uint8 sClassForSize[kMaxSmallSize / 16 + 1];
+
+static mutex sArenaLock = MUTEX_INITIALIZER("slab heap arena");
+static slab_arena sArenas[kMaxArenas];
+static int32 sArenaCount;
+static size_t sLargeCount;
+static size_t sLargeSize;
+
+static central_cache sCentralCaches[SIZE_CLASS_COUNT];
+
+static mutex sThreadCacheLock = MUTEX_INITIALIZER("slab heap thread caches");
+static thread_cache* sThreadCaches;
+static size_t sThreadCacheCount;
+
+static int64 sBatchesPushed;
+static int64 sBatchesPopped;
+static int64 sSlabRefills;
+
+
+static inline object_batch*
+atomic_get_batch(object_batch** pointer)
+{
+#if B_HAIKU_64_BIT
+	return (object_batch*)atomic_get64((int64*)pointer);
+#else
+	return (object_batch*)atomic_get((int32*)pointer);
+#endif
+}
+
+
+static inline object_batch*
+atomic_test_and_set_batch(object_batch** pointer, object_batch* set,
+	object_batch* test)
+{
+#if B_HAIKU_64_BIT
+	return (object_batch*)atomic_test_and_set64((int64*)pointer, (int64)set,
+		(int64)test);
+#else
+	return (object_batch*)atomic_test_and_set((int32*)pointer, (int32)set,
+		(int32)test);
+#endif
+}
+
+
+static inline object_batch*
+atomic_get_and_set_batch(object_batch** pointer, object_batch* set)
+{
+#if B_HAIKU_64_BIT
+	return (object_batch*)atomic_get_and_set64((int64*)pointer, (int64)set);
+#else
+	return (object_batch*)atomic_get_and_set((int32*)pointer, (int32)set);
+#endif
+}
+
+
+static inline addr_t
+header_for(const void* address)
+{
+	// The returned address of any allocation lies within the first chunk
+	// after its header, but never directly at the header itself.
+	return ((addr_t)address - 1) & kChunkMask;
+}
+
+
+//	#pragma mark - arena
+
+
+/*!	Creates a new arena that can hold at least \a minSize bytes, and whose
+	address range spans \a reservationSize bytes, if possible. If no range
+	of at least kMinArenaReservationSize can be reserved, a plain area of
+	just \a minSize bytes is created instead.
+	The arena lock must be held, unless the heap is being initialized.
+*/
+static slab_arena*
+arena_create(size_t reservationSize, size_t minSize)
+{
+	if (sArenaCount == kMaxArenas)
+		return NULL;
+
+	minSize = (minSize + kArenaIncrement - 1) & ~(addr_t)(kArenaIncrement - 1);
+	if (reservationSize < minSize)
+		reservationSize = minSize;
+
+	uint32 protection = B_READ_AREA | B_WRITE_AREA;
+	if (__gABIVersion < B_HAIKU_ABI_GCC_2_HAIKU)
+		protection |= B_EXECUTE_AREA;
+
+	slab_arena& newArena = sArenas[sArenaCount];
+	bool reserved = false;
+
+	while (reservationSize >= minSize
+		&& reservationSize >= kMinArenaReservationSize) {
+		addr_t reservationBase = 0;
+		status_t status = _kern_reserve_address_range(&reservationBase,
+			B_RANDOMIZED_ANY_ADDRESS, reservationSize + kArenaIncrement);
+		if (status != B_OK) {
+			reservationSize /= 2;
+			continue;
+		}
+
+		addr_t base = (reservationBase + kArenaIncrement - 1)
+			& ~(addr_t)(kArenaIncrement - 1);
+
+		void* address = (void*)base;
+		area_id area = create_area("slab heap", &address, B_EXACT_ADDRESS,
+			minSize, B_NO_LOCK, protection);
+		if (area < 0) {
+			_kern_unreserve_address_range(reservationBase,
+				reservationSize + kArenaIncrement);
+			return NULL;
+		}
+
+		newArena.area = area;
+		newArena.base = base;
+		newArena.end = base + minSize;
+		newArena.limit = base + reservationSize;
+		reserved = true;
+		break;
+	}
+
+	if (!reserved) {
+		// The address space is too fragmented for a reservation, just create
+		// an area for this request. It needs to be aligned to the chunk size.
+		void* address;
+		area_id area = create_area("slab heap", &address, B_ANY_ADDRESS,
+			minSize + kChunkSize, B_NO_LOCK, protection);
+		if (area < 0)
+			return NULL;
+
+		newArena.area = area;
+		newArena.base = ((addr_t)address + kChunkSize - 1) & kChunkMask;
+		newArena.end = newArena.base + minSize;
+		newArena.limit = newArena.end;
+	}
+
+	newArena.top = newArena.base;
+	newArena.free_runs = NULL;
+	newArena.free_chunk_count = 0;
+
+	TRACE("created arena %" B_PRId32 " at %p, %zu of %zu bytes\n",
+		sArenaCount, (void*)newArena.base, newArena.end - newArena.base,
+		newArena.limit - newArena.base);
+
+	sArenaCount++;
+	return &newArena;
+}
+
+
+static status_t
+arena_init()
+{
+	if (arena_create(kArenaReservationSize, kArenaIncrement) == NULL)
+		return B_NO_MEMORY;
+
+	return B_OK;
+}
+
+
+/*!	Returns the arena that contains \a address. The arena lock must be held.
+*/
+static slab_arena*
+arena_for(addr_t address)
+{
+	for (int32 i = 0; i < sArenaCount; i++) {
+		if (address >= sArenas[i].base && address < sArenas[i].end)
+			return &sArenas[i];
+	}
+
+	return NULL;
+}
+
+
+/*!	Makes sure the arena area reaches up to \a end.
+	The arena lock must be held.
+*/
+static bool
+arena_grow(slab_arena& arena, addr_t end)
+{
+	if (end <= arena.end)
+		return true;
+	if (end > arena.limit || end < arena.base)
+		return false;
+
+	addr_t newEnd = (end + kArenaIncrement - 1)
+		& ~(addr_t)(kArenaIncrement - 1);
+	if (newEnd > arena.limit)
+		newEnd = arena.limit;
+
+	status_t status = resize_area(arena.area, newEnd - arena.base);
+	if (status != B_OK) {
+		// don't try again, allocate from other arenas instead
+		TRACE("could not grow arena to %p: %s\n", (void*)newEnd,
+			strerror(status));
+		arena.limit = arena.end;
+		return false;
+	}
+
+	arena.end = newEnd;
+	return true;
+}
+
+
+/*!	Allocates \a count contiguous chunks from \a arena. The arena lock must
+	be held. Returns 0 if the arena has no room for them.
+*/
+static addr_t
+arena_allocate_chunks(slab_arena& arena, size_t count)
+{
+	// first fit in the free runs
+	free_run** link = &arena.free_runs;
+	for (free_run* run = arena.free_runs; run != NULL; run = run->next) {
+		if (run->chunk_count >= count) {
+			if (run->chunk_count > count) {
+				free_run* rest = (free_run*)((addr_t)run + count * kChunkSize);
+				rest->next = run->next;
+				rest->chunk_count = run->chunk_count - count;
+				*link = rest;
+			} else
+				*link = run->next;
+
+			arena.free_chunk_count -= count;
+			return (addr_t)run;
+		}
+
+		link = &run->next;
+	}
+
+	// there is no free run large enough, take it from the top
+	if (count > (arena.limit - arena.top) / kChunkSize
+		|| !arena_grow(arena, arena.top + count * kChunkSize)) {
+		return 0;
+	}
+
+	addr_t address = arena.top;
+	arena.top += count * kChunkSize;
+	return address;
+}
+
+
+/*!	Allocates \a count contiguous chunks. The arena lock must be held.
+	Returns 0 if no memory is available.
+*/
+static addr_t
+arena_allocate_chunks(size_t count)
+{
+	for (int32 i = 0; i < sArenaCount; i++) {
+		addr_t address = arena_allocate_chunks(sArenas[i], count);
+		if (address != 0)
+			return address;
+	}
+
+	// all arenas are exhausted, or could not be grown
+	slab_arena* newArena = arena_create(kMoreArenaReservationSize,
+		count * kChunkSize);
+	if (newArena == NULL)
+		return 0;
+
+	return arena_allocate_chunks(*newArena, count);
+}
+
+
+/*!	Returns the chunks to their arena, and merges them with adjacent free
+	runs. The arena lock must be held.
+*/
+static void
+arena_free_chunks(addr_t address, size_t count)
+{
+	slab_arena* arena = arena_for(address);
+	if (arena == NULL) {
+		debugger("slab heap: chunks don't belong to an arena");
+		return;
+	}
+
+	free_run* previous = NULL;
+	free_run* next = arena->free_runs;
+	while (next != NULL && (addr_t)next < address) {
+		previous = next;
+		next = next->next;
+	}
+
+	free_run* run = (free_run*)address;
+	run->chunk_count = count;
+	run->next = next;
+	arena->free_chunk_count += count;
+
+	if (next != NULL && address + count * kChunkSize == (addr_t)next) {
+		run->chunk_count += next->chunk_count;
+		run->next = next->next;
+	}
+
+	if (previous != NULL
+		&& (addr_t)previous + previous->chunk_count * kChunkSize == address) {
+		previous->chunk_count += run->chunk_count;
+		previous->next = run->next;
+		run = previous;
+	} else if (previous != NULL)
+		previous->next = run;
+	else
+		arena->free_runs = run;
+
+	if ((addr_t)run + run->chunk_count * kChunkSize == arena->top) {
+		// the run is at the top of the arena, just lower the top
+		arena->top = (addr_t)run;
+		arena->free_chunk_count -= run->chunk_count;
+
+		if (previous == run) {
+			// find the new last run
+			previous = NULL;
+			for (free_run* other = arena->free_runs; other != run;
+					other = other->next) {
+				previous = other;
+			}
+		}
+		if (previous != NULL)
+			previous->next = NULL;
+		else
+			arena->free_runs = NULL;
+	}
+}
+
+
+//	#pragma mark - slabs
+
+
+static slab*
+slab_create(uint32 sizeClass)
+{
+	mutex_lock(&sArenaLock);
+	addr_t address = arena_allocate_chunks(1);
+	mutex_unlock(&sArenaLock);
+
+	if (address == 0)
+		return NULL;
+
+	slab* newSlab = (slab*)address;
+	newSlab->magic = kSlabMagic;
+	newSlab->size_class = sizeClass;
+	newSlab->object_size = kSizeClasses[sizeClass];
+	newSlab->object_count = (kChunkSize - kHeaderSize) / kSizeClasses[sizeClass];
+	newSlab->used_count = 0;
+	newSlab->in_list = false;
+	newSlab->free_list = NULL;
+	newSlab->next_unused = address + kHeaderSize;
+	newSlab->end = newSlab->next_unused
+		+ newSlab->object_count * newSlab->object_size;
+	newSlab->next = NULL;
+	newSlab->previous = NULL;
+
+	return newSlab;
+}
+
+
+static inline void
+slab_list_add(central_cache& central, slab* toAdd)
+{
+	toAdd->previous = NULL;
+	toAdd->next = central.partial_slabs;
+	if (toAdd->next != NULL)
+		toAdd->next->previous = toAdd;
+	central.partial_slabs = toAdd;
+	toAdd->in_list = true;
+}
+
+
+static inline void
+slab_list_remove(central_cache& central, slab* toRemove)
+{
+	if (toRemove->previous != NULL)
+		toRemove->previous->next = toRemove->next;
+	else
+		central.partial_slabs = toRemove->next;
+	if (toRemove->next != NULL)
+		toRemove->next->previous = toRemove->previous;
+
+	toRemove->next = NULL;
+	toRemove->previous = NULL;
+	toRemove->in_list = false;
+}
+
+
+/*!	Takes up to \a count objects from the slabs of the size class, and links
+	them into \a _list. The central cache must be locked.
+	Returns the number of objects in the list.
+*/
+static uint32
+central_fill(uint32 sizeClass, uint32 count, free_object*& _list)
+{
+	central_cache& central = sCentralCaches[sizeClass];
+	free_object* list = NULL;
+	uint32 filled = 0;
+
+	while (filled < count) {
+		slab* source = central.partial_slabs;
+		if (source == NULL) {
+			source = central.empty_slab;
+			if (source != NULL)
+				central.empty_slab = NULL;
+			else {
+				source = slab_create(sizeClass);
+				if (source == NULL)
+					break;
+
+				central.slab_count++;
+			}
+
+			slab_list_add(central, source);
+		}
+
+		while (filled < count) {
+			free_object* object = source->free_list;
+			if (object != NULL)
+				source->free_list = object->next;
+			else if (source->next_unused < source->end) {
+				object = (free_object*)source->next_unused;
+				source->next_unused += source->object_size;
+			} else
+				break;
+
+			object->next = list;
+			list = object;
+			source->used_count++;
+			filled++;
+		}
+
+		if (source->used_count == source->object_count)
+			slab_list_remove(central, source);
+	}
+
+	_list = list;
+	return filled;
+}
+
+
+/*!	Returns an object to its slab. The central cache must be locked.
+*/
+static void
+central_release_object(central_cache& central, free_object* object)
+{
+	slab* owner = (slab*)header_for(object);
+
+	object->next = owner->free_list;
+	owner->free_list = object;
+	owner->used_count--;
+
+	if (!owner->in_list)
+		slab_list_add(central, owner);
+
+	if (owner->used_count != 0)
+		return;
+
+	slab_list_remove(central, owner);
+
+	if (central.empty_slab == NULL) {
+		// keep it around, and start over with a fresh layout
+		owner->free_list = NULL;
+		owner->next_unused = (addr_t)owner + kHeaderSize;
+		central.empty_slab = owner;
+		return;
+	}
+
+	central.slab_count--;
+
+	mutex_lock(&sArenaLock);
+	arena_free_chunks((addr_t)owner, 1);
+	mutex_unlock(&sArenaLock);
+}
+
+
+/*!	Pops a full batch from the central list of the size class. Only a single
+	thread may pop at a time, hence the central cache must be locked; pushes
+	may happen concurrently. That rules out the ABA problem, as only the
+	popping thread could remove and re-add the head of the list.
+*/
+static free_object*
+central_pop_batch(central_cache& central)
+{
+	object_batch* batch;
+	while (true) {
+		batch = atomic_get_batch(&central.batches);
+		if (batch == NULL)
+			return NULL;
+
+		if (atomic_test_and_set_batch(&central.batches, batch->next_batch,
+				batch) == batch) {
+			break;
+		}
+	}
+
+	atomic_add(&central.batch_count, -1);
+	atomic_add64(&sBatchesPopped, 1);
+
+	free_object* list = (free_object*)batch;
+	list->next = batch->objects;
+	return list;
+}
+
+
+/*!	Returns all queued batches of the size class to their slabs, so that
+	completely unused slabs can be given back to the arena.
+*/
+static void
+central_drain(central_cache& central)
+{
+	mutex_lock(&central.lock);
+
+	object_batch* batch = atomic_get_and_set_batch(&central.batches, NULL);
+	while (batch != NULL) {
+		object_batch* nextBatch = batch->next_batch;
+		free_object* object = batch->objects;
+
+		central_release_object(central, (free_object*)batch);
+		while (object != NULL) {
+			free_object* next = object->next;
+			central_release_object(central, object);
+			object = next;
+		}
+
+		atomic_add(&central.batch_count, -1);
+		batch = nextBatch;
+	}
+
+	mutex_unlock(&central.lock);
+}
+
+
+/*!	Pushes a full batch of objects to the central list of the size class.
+	This does not need any lock.
+*/
+static void
+central_push_batch(central_cache& central, free_object* objects)
+{
+	object_batch* batch = (object_batch*)objects;
+	batch->objects = objects->next;
+
+	object_batch* head;
+	do {
+		head = atomic_get_batch(&central.batches);
+		batch->next_batch = head;
+	} while (atomic_test_and_set_batch(&central.batches, batch, head) != head);
+
+	atomic_add64(&sBatchesPushed, 1);
+
+	if (atomic_add(&central.batch_count, 1) + 1 > kMaxCentralBatches)
+		central_drain(central);
+}
+
+
+/*!	Returns a list of objects that is not a full batch to the slabs.
+*/
+static void
+central_release_list(central_cache& central, free_object* list)
+{
+	if (list == NULL)
+		return;
+
+	mutex_lock(&central.lock);
+
+	while (list != NULL) {
+		free_object* next = list->next;
+		central_release_object(central, list);
+		list = next;
+	}
+
+	mutex_unlock(&central.lock);
+}
+
+
+static void*
+central_allocate(uint32 sizeClass)
+{
+	central_cache& central = sCentralCaches[sizeClass];
+
+	mutex_lock(&central.lock);
+	free_object* object;
+	if (central_fill(sizeClass, 1, object) == 0)
+		object = NULL;
+	mutex_unlock(&central.lock);
+
+	return object;
+}
+
+
+//	#pragma mark - thread caches
+
+
+/*!	Detaches up to \a count objects from the front of the list of the given
+	size class.
+*/
+static free_object*
+thread_cache_detach(thread_cache* cache, uint32 sizeClass, uint32 count)
+{
+	free_object* list = cache->lists[sizeClass];
+	if (count == 0 || list == NULL)
+		return NULL;
+
+	free_object* last = list;
+	uint32 detached = 1;
+	while (detached < count && last->next != NULL) {
+		last = last->next;
+		detached++;
+	}
+
+	cache->lists[sizeClass] = last->next;
+	cache->counts[sizeClass] -= detached;
+	cache->cached_bytes -= detached * kSizeClasses[sizeClass];
+	last->next = NULL;
+
+	return list;
+}
+
+
+/*!	Returns objects of the size class to the central cache until only
+	\a keep objects are left in the thread cache.
+*/
+static void
+thread_cache_flush(thread_cache* cache, uint32 sizeClass, uint32 keep)
+{
+	central_cache& central = sCentralCaches[sizeClass];
+
+	while (cache->counts[sizeClass] >= keep + central.batch_size) {
+		central_push_batch(central,
+			thread_cache_detach(cache, sizeClass, central.batch_size));
+	}
+
+	if (cache->counts[sizeClass] > keep) {
+		central_release_list(central, thread_cache_detach(cache, sizeClass,
+			cache->counts[sizeClass] - keep));
+	}
+}
+
+
+static void
+thread_cache_scavenge(thread_cache* cache)
+{
+	for (uint32 i = 0; i < SIZE_CLASS_COUNT; i++) {
+		uint32 batchSize = sCentralCaches[i].batch_size;
+		if (cache->limits[i] > batchSize)
+			cache->limits[i] -= batchSize;
+
+		thread_cache_flush(cache, i, cache->counts[i] / 2);
+	}
+}
+
+
+static thread_cache*
+thread_cache_create()
+{
+	uint32 sizeClass = sClassForSize[(sizeof(thread_cache) + 15) / 16];
+	thread_cache* cache = (thread_cache*)central_allocate(sizeClass);
+	if (cache == NULL)
+		return NULL;
+
+	memset(cache, 0, sizeof(thread_cache));
+	for (uint32 i = 0; i < SIZE_CLASS_COUNT; i++)
+		cache->limits[i] = sCentralCaches[i].batch_size;
+
+	mutex_lock(&sThreadCacheLock);
+	cache->next = sThreadCaches;
+	if (cache->next != NULL)
+		cache->next->previous = cache;
+	sThreadCaches = cache;
+	sThreadCacheCount++;
+	mutex_unlock(&sThreadCacheLock);
+
+	tls_set(sThreadCacheSlot, cache);
+	return cache;
+}
+
+
+static void
+thread_cache_delete(thread_cache* cache)
+{
+	for (uint32 i = 0; i < SIZE_CLASS_COUNT; i++)
+		thread_cache_flush(cache, i, 0);
+
+	mutex_lock(&sThreadCacheLock);
+	if (cache->previous != NULL)
+		cache->previous->next = cache->next;
+	else
+		sThreadCaches = cache->next;
+	if (cache->next != NULL)
+		cache->next->previous = cache->previous;
+	sThreadCacheCount--;
+	mutex_unlock(&sThreadCacheLock);
+
+	slab* owner = (slab*)header_for(cache);
+	free_object* object = (free_object*)cache;
+	object->next = NULL;
+	central_release_list(sCentralCaches[owner->size_class], object);
+}
+
+
+// marks threads that have already freed their cache
+#define EXITED_THREAD_CACHE	((thread_cache*)1)
+
+
+static inline thread_cache*
+current_thread_cache()
+{
+	return (thread_cache*)tls_get(sThreadCacheSlot);
+}
+
+
+/*!	Fills the empty list of the size class, and returns its first object
+	without removing it.
+*/
+static free_object*
+thread_cache_refill(thread_cache* cache, uint32 sizeClass)
+{
+	central_cache& central = sCentralCaches[sizeClass];
+
+	// every miss allows the thread to cache more objects, up to a limit
+	if (cache->limits[sizeClass] < 4 * central.batch_size)
+		cache->limits[sizeClass] += central.batch_size / 2 + 1;
+
+	mutex_lock(&central.lock);
+
+	free_object* list = central_pop_batch(central);
+	uint32 count = central.batch_size;
+	if (list == NULL) {
+		count = central_fill(sizeClass, central.batch_size, list);
+		atomic_add64(&sSlabRefills, 1);
+	}
+
+	mutex_unlock(&central.lock);
+
+	if (count == 0)
+		return NULL;
+
+	cache->lists[sizeClass] = list;
+	cache->counts[sizeClass] = count;
+	cache->cached_bytes += count * kSizeClasses[sizeClass];
+	return list;
+}
+
+
+static inline void*
+small_allocate(uint32 sizeClass)
+{
+	thread_cache* cache = current_thread_cache();
+	if ((addr_t)cache <= (addr_t)EXITED_THREAD_CACHE) {
+		if (cache == EXITED_THREAD_CACHE
+			|| (cache = thread_cache_create()) == NULL) {
+			return central_allocate(sizeClass);
+		}
+	}
+
+	free_object* object = cache->lists[sizeClass];
+	if (object == NULL) {
+		object = thread_cache_refill(cache, sizeClass);
+		if (object == NULL)
+			return NULL;
+	}
+
+	cache->lists[sizeClass] = object->next;
+	cache->counts[sizeClass]--;
+	cache->cached_bytes -= kSizeClasses[sizeClass];
+	return object;
+}
+
+
+static inline void
+small_free(slab* owner, void* address)
+{
+	uint32 sizeClass = owner->size_class;
+	free_object* object = (free_object*)address;
+
+	thread_cache* cache = current_thread_cache();
+	if ((addr_t)cache <= (addr_t)EXITED_THREAD_CACHE) {
+		if (cache == EXITED_THREAD_CACHE
+			|| (cache = thread_cache_create()) == NULL) {
+			object->next = NULL;
+			central_release_list(sCentralCaches[sizeClass], object);
+			return;
+		}
+	}
+
+	object->next = cache->lists[sizeClass];
+	cache->lists[sizeClass] = object;
+	cache->cached_bytes += kSizeClasses[sizeClass];
+
+	if (++cache->counts[sizeClass] > cache->limits[sizeClass]) {
+		central_cache& central = sCentralCaches[sizeClass];
+		central_push_batch(central,
+			thread_cache_detach(cache, sizeClass, central.batch_size));
+	}
+
+	if (cache->cached_bytes > kMaxThreadCacheSize)
+		thread_cache_scavenge(cache);
+}
+
+
+//	#pragma mark - large allocations
+
+
+static void*
+large_allocate(size_t size, size_t alignment)
+{
+	// The returned address must lie within the first chunk behind the header;
+	// for very large alignments, we need to find a chunk in the run that
+	// is directly in front of a suitably aligned address.
+	size_t offset = kHeaderSize;
+	size_t extraChunks = 0;
+	if (alignment >= kChunkSize) {
+		offset = kChunkSize;
+		extraChunks = alignment / kChunkSize;
+	} else if (alignment > kHeaderSize)
+		offset = alignment;
+
+	if (size > ~(size_t)0 / 2)
+		return NULL;
+
+	size_t chunkCount = extraChunks
+		+ ((offset + size + kChunkSize - 1) >> kChunkShift);
+
+	mutex_lock(&sArenaLock);
+
+	addr_t run = arena_allocate_chunks(chunkCount);
+	if (run == 0) {
+		mutex_unlock(&sArenaLock);
+		return NULL;
+	}
+
+	sLargeCount++;
+	sLargeSize += chunkCount * kChunkSize;
+
+	mutex_unlock(&sArenaLock);
+
+	addr_t header = run;
+	if (alignment >= kChunkSize) {
+		header = ((run + kChunkSize + alignment - 1) & ~(addr_t)(alignment - 1))
+			- kChunkSize;
+	}
+
+	large_allocation* allocation = (large_allocation*)header;
+	allocation->magic = kLargeMagic;
+	allocation->chunk_offset = (header - run) >> kChunkShift;
+	allocation->chunk_count = chunkCount;
+	allocation->size = size;
+
+	return (void*)(header + offset);
+}
+
+
+static void
+large_free(large_allocation* allocation)
+{
+	addr_t run = (addr_t)allocation
+		- ((addr_t)allocation->chunk_offset << kChunkShift);
+	size_t chunkCount = allocation->chunk_count;
+	allocation->magic = 0;
+
+	mutex_lock(&sArenaLock);
+	sLargeCount--;
+	sLargeSize -= chunkCount * kChunkSize;
+	arena_free_chunks(run, chunkCount);
+	mutex_unlock(&sArenaLock);
+}
+
+
+static inline size_t
+large_usable_size(large_allocation* allocation, const void* address)
+{
+	addr_t end = (addr_t)allocation
+		+ ((addr_t)(allocation->chunk_count - allocation->chunk_offset)
+			<< kChunkShift);
+	return end - (addr_t)address;
+}
+
+
+//	#pragma mark - private API
+
+
+status_t
+slab_heap_init()
+{
+	if (sInitialized)
+		return B_OK;
+
+	uint32 sizeClass = 0;
+	for (uint32 i = 0; i <= kMaxSmallSize / 16; i++) {
+		while (kSizeClasses[sizeClass] < i * 16)
+			sizeClass++;
+		sClassForSize[i] = sizeClass;
+	}
+
+	for (uint32 i = 0; i < SIZE_CLASS_COUNT; i++) {
+		central_cache& central = sCentralCaches[i];
+		mutex_init_etc(&central.lock, "slab heap size class",
+			MUTEX_FLAG_ADAPTIVE);
+		central.partial_slabs = NULL;
+		central.empty_slab = NULL;
+		central.batches = NULL;
+		central.batch_count = 0;
+		central.object_size = kSizeClasses[i];
+		central.slab_count = 0;
+
+		uint32 batchSize = kMaxBatchBytes / kSizeClasses[i];
+		if (batchSize > kMaxBatchSize)
+			batchSize = kMaxBatchSize;
+		else if (batchSize < kMinBatchSize)
+			batchSize = kMinBatchSize;
+		central.batch_size = batchSize;
+	}
+
+	sThreadCacheSlot = tls_allocate();
+	if (sThreadCacheSlot < 0)
+		return sThreadCacheSlot;
+	tls_set(sThreadCacheSlot, NULL);
+
+	status_t status = arena_init();
+	if (status != B_OK)
+		return status;
+
+	sInitialized = true;
+	return B_OK;
+}
+
+
+void*
+slab_heap_allocate(size_t size)
+{
+	if (size > kMaxSmallSize)
+		return large_allocate(size, 0);
+
+	return small_allocate(sClassForSize[(size + 15) >> 4]);
+}
+
+
+/*!	\a alignment must be a power of two.
+*/
+void*
+slab_heap_allocate_aligned(size_t alignment, size_t size)
+{
+	if (alignment <= kHeaderSize && size <= kMaxSmallSize) {
+		// Slab objects start at kHeaderSize, so they are aligned to any
+		// alignment their size is a multiple of.
+		uint32 sizeClass = sClassForSize[(size + 15) >> 4];
+		while (sizeClass < SIZE_CLASS_COUNT
+			&& kSizeClasses[sizeClass] % alignment != 0) {
+			sizeClass++;
+		}
+		if (sizeClass < SIZE_CLASS_COUNT)
+			return small_allocate(sizeClass);
+	}
+
+	return large_allocate(size, alignment);
+}
+
+
+void
+slab_heap_free(void* address)
+{
+	if (address == NULL)
+		return;
+
+	addr_t header = header_for(address);
+	uint32 magic = *(uint32*)header;
+	if (magic == kSlabMagic)
+		small_free((slab*)header, address);
+	else if (magic == kLargeMagic)
+		large_free((large_allocation*)header);
+	else
+		debugger("slab heap: free(): invalid address");
+}
+
+
+size_t
+slab_heap_usable_size(void* address)
+{
+	if (address == NULL)
+		return 0;
+
+	addr_t header = header_for(address);
+	uint32 magic = *(uint32*)header;
+	if (magic == kSlabMagic)
+		return ((slab*)header)->object_size;
+	if (magic == kLargeMagic)
+		return large_usable_size((large_allocation*)header, address);
+
+	debugger("slab heap: malloc_usable_size(): invalid address");
+	return 0;
+}
+
+
+void*
+slab_heap_reallocate(void* address, size_t newSize)
+{
+	if (address == NULL)
+		return slab_heap_allocate(newSize);
+
+	size_t oldSize = slab_heap_usable_size(address);
+	if (newSize <= oldSize && newSize > oldSize / 4)
+		return address;
+
+	void* newAddress = slab_heap_allocate(newSize);
+	if (newAddress == NULL)
+		return NULL;
+
+	memcpy(newAddress, address, newSize < oldSize ? newSize : oldSize);
+	slab_heap_free(address);
+	return newAddress;
+}
+
+
+void
+slab_heap_thread_init()
+{
+	if (sThreadCacheSlot >= 0)
+		tls_set(sThreadCacheSlot, NULL);
+}
+
+
+void
+slab_heap_thread_exit()
+{
+	if (sThreadCacheSlot < 0)
+		return;
+
+	thread_cache* cache = current_thread_cache();
+	tls_set(sThreadCacheSlot, EXITED_THREAD_CACHE);
+
+	if ((addr_t)cache > (addr_t)EXITED_THREAD_CACHE)
+		thread_cache_delete(cache);
+}
+
+
+void
+slab_heap_before_fork()
+{
+	mutex_lock(&sThreadCacheLock);
+	for (uint32 i = 0; i < SIZE_CLASS_COUNT; i++)
+		mutex_lock(&sCentralCaches[i].lock);
+	mutex_lock(&sArenaLock);
+}
+
+
+void
+slab_heap_after_fork_parent()
+{
+	mutex_unlock(&sArenaLock);
+	for (uint32 i = SIZE_CLASS_COUNT; i-- > 0;)
+		mutex_unlock(&sCentralCaches[i].lock);
+	mutex_unlock(&sThreadCacheLock);
+}
+
+
+void
+slab_heap_after_fork_child()
+{
+	mutex_init(&sArenaLock, "slab heap arena");
+	for (uint32 i = 0; i < SIZE_CLASS_COUNT; i++) {
+		mutex_init_etc(&sCentralCaches[i].lock, "slab heap size class",
+			MUTEX_FLAG_ADAPTIVE);
+	}
+	mutex_init(&sThreadCacheLock, "slab heap thread caches");
+
+	// the areas have been copied, and got new IDs
+	for (int32 i = 0; i < sArenaCount; i++) {
+		sArenas[i].area = area_for((void*)sArenas[i].base);
+		if (sArenas[i].area < 0) {
+			debug_printf("slab heap: arena area not found after fork!\n");
+			exit(1);
+		}
+	}
+
+	// Only the forking thread survives, hand the objects in all other caches
+	// back to the central caches.
+	thread_cache* current = current_thread_cache();
+	thread_cache* cache = sThreadCaches;
+	while (cache != NULL) {
+		thread_cache* next = cache->next;
+		if (cache != current)
+			thread_cache_delete(cache);
+		cache = next;
+	}
+}
+
+
+void
+slab_heap_get_stats(slab_heap_stats* stats)
+{
+	memset(stats, 0, sizeof(slab_heap_stats));
+
+	mutex_lock(&sArenaLock);
+	for (int32 i = 0; i < sArenaCount; i++) {
+		const slab_arena& arena = sArenas[i];
+		stats->arena_size += arena.end - arena.base;
+		stats->arena_free += arena.free_chunk_count * kChunkSize
+			+ (arena.end - arena.top);
+	}
+	stats->large_count = sLargeCount;
+	stats->large_size = sLargeSize;
+	mutex_unlock(&sArenaLock);
+
+	for (uint32 i = 0; i < SIZE_CLASS_COUNT; i++)
+		stats->slab_count += sCentralCaches[i].slab_count;
+
+	mutex_lock(&sThreadCacheLock);
+	stats->thread_caches = sThreadCacheCount;
+	for (thread_cache* cache = sThreadCaches; cache != NULL;
+			cache = cache->next) {
+		stats->cached_bytes += cache->cached_bytes;
+	}
+	mutex_unlock(&sThreadCacheLock);
+
+	stats->batches_pushed = atomic_get64(&sBatchesPushed);
+	stats->batches_popped = atomic_get64(&sBatchesPopped);
+	stats->slab_refills = atomic_get64(&sSlabRefills);
+}
+
+
+}	// namespace BPrivate
@@ -0,0 +1,50 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef MALLOC_SLAB_HEAP_H
+#define MALLOC_SLAB_HEAP_H
+
+
+#include <OS.h>
+
+
+namespace BPrivate {
+
+
+struct slab_heap_stats {
+	size_t		arena_size;			// committed size of the arena
+	size_t		arena_free;			// free chunks within the arena
+	size_t		slab_count;			// slabs for small allocations
+	size_t		large_count;		// large allocations
+	size_t		large_size;			// bytes allocated for large allocations
+	size_t		thread_caches;		// thread caches in use
+	size_t		cached_bytes;		// bytes in all thread caches
+	int64		batches_pushed;		// batches returned by thread caches
+	int64		batches_popped;		// batches taken by thread caches
+	int64		slab_refills;		// thread cache refills served by slabs
+};
+
+
+status_t	slab_heap_init();
+
+void*		slab_heap_allocate(size_t size);
+void*		slab_heap_allocate_aligned(size_t alignment, size_t size);
+void		slab_heap_free(void* address);
+void*		slab_heap_reallocate(void* address, size_t newSize);
+size_t		slab_heap_usable_size(void* address);
+
+void		slab_heap_thread_init();
+void		slab_heap_thread_exit();
+
+void		slab_heap_before_fork();
+void		slab_heap_after_fork_parent();
+void		slab_heap_after_fork_child();
+
+void		slab_heap_get_stats(slab_heap_stats* stats);
+
+
+}	// namespace BPrivate
+
+
+#endif	// MALLOC_SLAB_HEAP_H
@@ -0,0 +1,254 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "heap.h"
+
+#include <errno.h>
+#include <string.h>
+
+#include <errno_private.h>
+#include <user_thread.h>
+
+#include "tracing_config.h"
+
+
+using namespace BPrivate;
+
+
+#if USER_MALLOC_TRACING
+#	define KTRACE(format...)	ktrace_printf(format)
+#else
+#	define KTRACE(format...)	do {} while (false)
+#endif
+
+
+extern "C" status_t
+__init_heap(void)
+{
+	return slab_heap_init();
+}
+
+
+extern "C" void
+__heap_terminate_after()
+{
+	// nothing to do
+}
+
+
+extern "C" void
+__heap_before_fork(void)
+{
+	slab_heap_before_fork();
+}
+
+
+extern "C" void
+__heap_after_fork_child(void)
+{
+	slab_heap_after_fork_child();
+}
+
+
+extern "C" void
+__heap_after_fork_parent(void)
+{
+	slab_heap_after_fork_parent();
+}
+
+
+extern "C" void
+__heap_thread_init(void)
+{
+	slab_heap_thread_init();
+}
+
+
+extern "C" void
+__heap_thread_exit(void)
+{
+	defer_signals();
+	slab_heap_thread_exit();
+	undefer_signals();
+}
+
+
+//	#pragma mark - public functions
+
+
+extern "C" void*
+malloc(size_t size)
+{
+	defer_signals();
+	void* address = slab_heap_allocate(size);
+	undefer_signals();
+
+	if (address == NULL)
+		__set_errno(B_NO_MEMORY);
+
+	KTRACE("malloc(%lu) -> %p", size, address);
+	return address;
+}
+
+
+extern "C" void*
+calloc(size_t numElements, size_t size)
+{
+	size_t totalSize = numElements * size;
+	if (numElements != 0 && totalSize / numElements != size) {
+		__set_errno(B_NO_MEMORY);
+		return NULL;
+	}
+
+	defer_signals();
+	void* address = slab_heap_allocate(totalSize);
+	undefer_signals();
+
+	if (address == NULL) {
+		__set_errno(B_NO_MEMORY);
+		KTRACE("calloc(%lu, %lu) -> NULL", numElements, size);
+		return NULL;
+	}
+
+	memset(address, 0, totalSize);
+	KTRACE("calloc(%lu, %lu) -> %p", numElements, size, address);
+	return address;
+}
+
+
+extern "C" void
+free(void* address)
+{
+	KTRACE("free(%p)", address);
+
+	defer_signals();
+	slab_heap_free(address);
+	undefer_signals();
+}
+
+
+extern "C" void*
+memalign(size_t alignment, size_t size)
+{
+	if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+		__set_errno(B_BAD_VALUE);
+		return NULL;
+	}
+
+	defer_signals();
+	void* address = slab_heap_allocate_aligned(alignment, size);
+	undefer_signals();
+
+	if (address == NULL)
+		__set_errno(B_NO_MEMORY);
+
+	KTRACE("memalign(%lu, %lu) -> %p", alignment, size, address);
+	return address;
+}
+
+
+extern "C" void*
+aligned_alloc(size_t alignment, size_t size)
+{
+	if (alignment == 0 || size % alignment != 0) {
+		__set_errno(B_BAD_VALUE);
+		return NULL;
+	}
+	return memalign(alignment, size);
+}
+
+
+extern "C" int
+posix_memalign(void** _pointer, size_t alignment, size_t size)
+{
+	if ((alignment & (sizeof(void*) - 1)) != 0
+		|| (alignment & (alignment - 1)) != 0 || _pointer == NULL) {
+		return B_BAD_VALUE;
+	}
+
+	defer_signals();
+	void* pointer = slab_heap_allocate_aligned(alignment, size);
+	undefer_signals();
+
+	KTRACE("posix_memalign(%p, %lu, %lu) -> %p", _pointer, alignment, size,
+		pointer);
+
+	if (pointer == NULL)
+		return B_NO_MEMORY;
+
+	*_pointer = pointer;
+	return 0;
+}
+
+
+extern "C" void*
+valloc(size_t size)
+{
+	return memalign(B_PAGE_SIZE, size);
+}
+
+
+extern "C" void*
+realloc(void* address, size_t newSize)
+{
+	if (newSize == 0 && address != NULL) {
+		free(address);
+		return NULL;
+	}
+
+	defer_signals();
+	void* newAddress = slab_heap_reallocate(address, newSize);
+	undefer_signals();
+
+	if (newAddress == NULL)
+		__set_errno(B_NO_MEMORY);
+
+	KTRACE("realloc(%p, %lu) -> %p", address, newSize, newAddress);
+	return newAddress;
+}
+
+
+extern "C" size_t
+malloc_usable_size(void* address)
+{
+	defer_signals();
+	size_t size = slab_heap_usable_size(address);
+	undefer_signals();
+
+	return size;
+}
+
+
+//	#pragma mark - BeOS specific extensions
+
+
+struct mstats {
+	size_t bytes_total;
+	size_t chunks_used;
+	size_t bytes_used;
+	size_t chunks_free;
+	size_t bytes_free;
+};
+
+
+extern "C" struct mstats mstats(void);
+
+extern "C" struct mstats
+mstats(void)
+{
+	slab_heap_stats heapStats;
+	slab_heap_get_stats(&heapStats);
+
+	static struct mstats stats;
+	stats.bytes_total = heapStats.arena_size;
+	stats.chunks_used = heapStats.slab_count + heapStats.large_count;
+	stats.bytes_used = heapStats.arena_size - heapStats.arena_free
+		- heapStats.cached_bytes;
+	stats.chunks_free = 0;
+	stats.bytes_free = heapStats.arena_free + heapStats.cached_bytes;
+
+	return stats;
+}
@@ -1527,7 +1527,9 @@ void _kern_read_fs_info() {}
 void _kern_read_index_stat() {}
 void _kern_read_kernel_image_symbols() {}
 void _kern_read_link() {}
+void _kern_read_port_area_etc() {}
 void _kern_read_port_etc() {}
+void _kern_read_port_multiple_etc() {}
 void _kern_read_stat() {}
 void _kern_readv() {}
 void _kern_realtime_sem_close() {}
@@ -1646,6 +1648,7 @@ void _kern_write() {}
 void _kern_write_attr() {}
 void _kern_write_fs_info() {}
 void _kern_write_port_etc() {}
+void _kern_write_port_multiple_etc() {}
 void _kern_write_stat() {}
 void _kern_writev() {}
 void _kern_writev_port_etc() {}
@@ -2581,7 +2584,9 @@ void re_set_registers() {}
 void re_set_syntax() {}
 void read() {}
 void read_port() {}
+void read_port_area_etc() {}
 void read_port_etc() {}
+void read_port_multiple_etc() {}
 void read_pos() {}
 void readdir() {}
 void readdir_r() {}
@@ -2950,6 +2955,7 @@ void wprintf() {}
 void write() {}
 void write_port() {}
 void write_port_etc() {}
+void write_port_multiple_etc() {}
 void write_pos() {}
 void writev() {}
 void writev_pos() {}
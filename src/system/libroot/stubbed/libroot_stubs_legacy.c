@@ -1407,7 +1407,9 @@ void _kern_read_fs_info() {}
 void _kern_read_index_stat() {}
 void _kern_read_kernel_image_symbols() {}
 void _kern_read_link() {}
+void _kern_read_port_area_etc() {}
 void _kern_read_port_etc() {}
+void _kern_read_port_multiple_etc() {}
 void _kern_read_stat() {}
 void _kern_readv() {}
 void _kern_realtime_sem_close() {}
@@ -1526,6 +1528,7 @@ void _kern_write() {}
 void _kern_write_attr() {}
 void _kern_write_fs_info() {}
 void _kern_write_port_etc() {}
+void _kern_write_port_multiple_etc() {}
 void _kern_write_stat() {}
 void _kern_writev() {}
 void _kern_writev_port_etc() {}
@@ -2513,7 +2516,9 @@ void re_set_registers() {}
 void re_set_syntax() {}
 void read() {}
 void read_port() {}
+void read_port_area_etc() {}
 void read_port_etc() {}
+void read_port_multiple_etc() {}
 void read_pos() {}
 void readdir() {}
 void readdir_r() {}
@@ -2901,6 +2906,7 @@ void wprintf() {}
 void write() {}
 void write_port() {}
 void write_port_etc() {}
+void write_port_multiple_etc() {}
 void write_pos() {}
 void writev() {}
 void writev_pos() {}
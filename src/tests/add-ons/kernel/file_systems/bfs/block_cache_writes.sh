@@ -0,0 +1,77 @@
+#!/bin/sh
+
+# Benchmarks the number of device write requests the block cache issues for a
+# metadata heavy workload on a BFS volume, using bfs_shell. Every phase creates
+# or removes a lot of inodes and directory entries, and is followed by a sync,
+# so that the journal has to write back all of the affected blocks.
+#
+# Usage: block_cache_writes.sh [ <bfs_shell> [ <directories> [ <entries> ] ] ]
+
+BFS_SHELL=${1:-bfs_shell}
+DIRECTORIES=${2:-32}
+ENTRIES=${3:-64}
+
+IMAGE=$(mktemp /tmp/block_cache_writes.XXXXXX)
+COMMANDS=$(mktemp /tmp/block_cache_writes_commands.XXXXXX)
+trap 'rm -f ${IMAGE} ${COMMANDS}' EXIT
+
+dd if=/dev/zero of=${IMAGE} bs=1M count=0 seek=256 2>/dev/null
+${BFS_SHELL} --initialize ${IMAGE} "block cache writes" "block_size 2048" \
+	> /dev/null || exit 1
+
+end_phase()
+{
+	echo "sync" >> ${COMMANDS}
+	echo "iostat" >> ${COMMANDS}
+}
+
+# reset the statistics after mounting
+echo "iostat" > ${COMMANDS}
+
+# create directories
+for d in $(seq 1 ${DIRECTORIES}); do
+	echo "mkdir /myfs/dir${d}" >> ${COMMANDS}
+done
+end_phase
+
+# create many small entries in each of them
+for d in $(seq 1 ${DIRECTORIES}); do
+	for e in $(seq 1 ${ENTRIES}); do
+		echo "ln -s target${e} /myfs/dir${d}/link${e}" >> ${COMMANDS}
+	done
+done
+end_phase
+
+# rename half of them
+for d in $(seq 1 ${DIRECTORIES}); do
+	for e in $(seq 1 2 ${ENTRIES}); do
+		echo "mv /myfs/dir${d}/link${e} /myfs/dir${d}/renamed${e}" \
+			>> ${COMMANDS}
+	done
+done
+end_phase
+
+# and remove everything again
+for d in $(seq 1 ${DIRECTORIES}); do
+	echo "rm -r /myfs/dir${d}" >> ${COMMANDS}
+done
+end_phase
+
+echo "quit" >> ${COMMANDS}
+
+echo "${DIRECTORIES} directories with ${ENTRIES} entries each"
+${BFS_SHELL} ${IMAGE} < ${COMMANDS} | awk '
+	BEGIN {
+		split("mount mkdir create rename remove", phases, " ")
+		phase = 1
+		printf("%-8s %16s %16s %16s\n", "phase", "write requests",
+			"blocks written", "blocks/request")
+	}
+	/write requests:/ { requests = $NF }
+	/blocks written:/ {
+		blocks = $NF
+		printf("%-8s %16d %16d %16.2f\n", phases[phase], requests, blocks,
+			requests > 0 ? blocks / requests : 0)
+		phase++
+	}
+'
@@ -0,0 +1,247 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Writes a number of files in parallel, as a download manager or a build
+	would, and reports how many extents each of them ends up with.
+
+	The test is run twice on the given BFS directory, first with block
+	reservations disabled, then with them enabled, so that the fragmentation
+	caused by interleaved allocations can be compared directly.
+*/
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <OS.h>
+
+#include "bfs_control.h"
+
+
+static const int32 kMaxFiles = 64;
+
+struct writer {
+	char		path[B_PATH_NAME_LENGTH];
+	off_t		size;
+	size_t		chunk_size;
+	sem_id		start;
+	status_t	status;
+	uint32		extents;
+};
+
+
+extern const char* __progname;
+static const char* kProgramName = __progname;
+
+
+static void
+usage(int exitCode)
+{
+	fprintf(stderr, "Usage: %s [--files <count>] [--size <KB>] "
+		"[--chunk <KB>] <directory>\n"
+		"Writes <count> files of <size> KB in chunks of <chunk> KB in "
+		"parallel into\n<directory>, which must be on a BFS volume, and "
+		"prints the resulting extents\nper file, once without and once with "
+		"block reservations.\n", kProgramName);
+	exit(exitCode);
+}
+
+
+static status_t
+set_reservations(const char* directory, bool enabled)
+{
+	int fd = open(directory, O_RDONLY);
+	if (fd < 0)
+		return errno;
+
+	uint32 value = enabled ? 1 : 0;
+	status_t status = B_OK;
+	if (ioctl(fd, BFS_IOCTL_ALLOCATION_RESERVATIONS, &value, sizeof(value))
+			!= 0)
+		status = errno;
+
+	close(fd);
+	return status;
+}
+
+
+static status_t
+writer_thread(void* _writer)
+{
+	writer* info = (writer*)_writer;
+
+	char* buffer = (char*)malloc(info->chunk_size);
+	if (buffer == NULL)
+		return info->status = B_NO_MEMORY;
+	memset(buffer, 0x55, info->chunk_size);
+
+	int fd = open(info->path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		free(buffer);
+		return info->status = errno;
+	}
+
+	acquire_sem(info->start);
+
+	info->status = B_OK;
+	for (off_t written = 0; written < info->size;) {
+		size_t size = info->chunk_size;
+		if ((off_t)size > info->size - written)
+			size = info->size - written;
+
+		ssize_t bytesWritten = write(fd, buffer, size);
+		if (bytesWritten < 0) {
+			info->status = errno;
+			break;
+		}
+
+		written += bytesWritten;
+
+		// give the other writers a chance to allocate in between
+		snooze(0);
+	}
+
+	fsync(fd);
+
+	if (info->status == B_OK
+		&& ioctl(fd, BFS_IOCTL_COUNT_EXTENTS, &info->extents,
+			sizeof(info->extents)) != 0) {
+		info->status = errno;
+	}
+
+	close(fd);
+	free(buffer);
+	return info->status;
+}
+
+
+static bool
+run(const char* directory, int32 fileCount, off_t size, size_t chunkSize,
+	bool reservations)
+{
+	status_t status = set_reservations(directory, reservations);
+	if (status != B_OK) {
+		fprintf(stderr, "%s: could not change reservations: %s\n",
+			kProgramName, strerror(status));
+		return false;
+	}
+
+	sem_id start = create_sem(0, "extents start");
+	if (start < 0)
+		return false;
+
+	writer writers[kMaxFiles];
+	thread_id threads[kMaxFiles];
+
+	for (int32 i = 0; i < fileCount; i++) {
+		snprintf(writers[i].path, sizeof(writers[i].path), "%s/extents-%"
+			B_PRId32, directory, i);
+		writers[i].size = size;
+		writers[i].chunk_size = chunkSize;
+		writers[i].start = start;
+		writers[i].status = B_OK;
+		writers[i].extents = 0;
+
+		threads[i] = spawn_thread(&writer_thread, "extents writer",
+			B_NORMAL_PRIORITY, &writers[i]);
+		resume_thread(threads[i]);
+	}
+
+	release_sem_etc(start, fileCount, 0);
+
+	bool success = true;
+	uint32 minimum = UINT32_MAX;
+	uint32 maximum = 0;
+	uint64 total = 0;
+
+	printf("reservations %s\n", reservations ? "enabled" : "disabled");
+
+	for (int32 i = 0; i < fileCount; i++) {
+		status_t result;
+		wait_for_thread(threads[i], &result);
+
+		if (writers[i].status != B_OK) {
+			fprintf(stderr, "%s: writing %s failed: %s\n", kProgramName,
+				writers[i].path, strerror(writers[i].status));
+			success = false;
+		} else {
+			printf("  %-24s %6" B_PRIu32 " extents\n", writers[i].path,
+				writers[i].extents);
+			minimum = min_c(minimum, writers[i].extents);
+			maximum = max_c(maximum, writers[i].extents);
+			total += writers[i].extents;
+		}
+
+		unlink(writers[i].path);
+	}
+
+	delete_sem(start);
+
+	if (success) {
+		printf("  extents per file: min %" B_PRIu32 ", avg %" B_PRIu64
+			", max %" B_PRIu32 "\n", minimum, total / fileCount, maximum);
+	}
+
+	return success;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int32 fileCount = 8;
+	off_t size = 16 * 1024 * 1024;
+	size_t chunkSize = 64 * 1024;
+
+	static struct option const kLongOptions[] = {
+		{"files", required_argument, 0, 'f'},
+		{"size", required_argument, 0, 's'},
+		{"chunk", required_argument, 0, 'c'},
+		{"help", no_argument, 0, 'h'},
+		{NULL}
+	};
+
+	int c;
+	while ((c = getopt_long(argc, argv, "f:s:c:h", kLongOptions, NULL))
+			!= -1) {
+		switch (c) {
+			case 'f':
+				fileCount = strtol(optarg, NULL, 0);
+				break;
+			case 's':
+				size = strtoll(optarg, NULL, 0) * 1024;
+				break;
+			case 'c':
+				chunkSize = strtoul(optarg, NULL, 0) * 1024;
+				break;
+			case 'h':
+				usage(0);
+				break;
+			default:
+				usage(1);
+				break;
+		}
+	}
+
+	if (optind + 1 != argc || fileCount <= 0 || fileCount > kMaxFiles
+		|| size <= 0 || chunkSize == 0)
+		usage(1);
+
+	const char* directory = argv[optind];
+
+	bool success = run(directory, fileCount, size, chunkSize, false)
+		&& run(directory, fileCount, size, chunkSize, true);
+
+	// leave the volume in its default state
+	set_reservations(directory, true);
+
+	return success ? 0 : 1;
+}
@@ -0,0 +1,256 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * This file may be used under the terms of the MIT License.
+ */
+
+
+/*!	Tests the building blocks of the BFS query planner: the candidate sets
+	that are intersected and united from the indices of a query, and the
+	selection of the index that drives the query and of those that filter it.
+*/
+
+
+#include "QueryPlan.h"
+
+
+struct TestTerm {
+	TestTerm(off_t estimate, off_t scanCost)
+		:
+		fEstimate(estimate),
+		fScanCost(scanCost)
+	{
+	}
+
+	off_t Estimate() const { return fEstimate; }
+	off_t ScanCost() const { return fScanCost; }
+
+private:
+	off_t	fEstimate;
+	off_t	fScanCost;
+};
+
+
+int32 gFailures;
+
+
+#define CHECK(condition)												\
+	do {																\
+		if (!(condition)) {												\
+			fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__,		\
+				__LINE__, #condition);									\
+			gFailures++;												\
+		}																\
+	} while (false)
+
+
+/*!	Adds the IDs start, start + step, ... below end to \a set, in reverse
+	order, and sorts it.
+*/
+status_t
+fill_set(CandidateSet& set, off_t start, off_t end, off_t step)
+{
+	off_t last = start + (end - 1 - start) / step * step;
+	for (off_t id = last; id >= start; id -= step) {
+		status_t status = set.Add(id);
+		if (status != B_OK)
+			return status;
+	}
+
+	set.Sort();
+	return B_OK;
+}
+
+
+void
+test_empty_sets()
+{
+	CandidateSet empty;
+	empty.Sort();
+	CHECK(empty.Count() == 0);
+	CHECK(!empty.Contains(0));
+
+	CandidateSet set;
+	CHECK(fill_set(set, 0, 100, 1) == B_OK);
+
+	// intersecting with an empty set empties the set, and vice versa
+	CandidateSet other;
+	other.Intersect(set);
+	CHECK(other.Count() == 0);
+
+	set.Intersect(empty);
+	CHECK(set.Count() == 0);
+	CHECK(!set.Contains(0));
+
+	// uniting with an empty set changes nothing
+	CHECK(fill_set(set, 0, 100, 1) == B_OK);
+	CHECK(set.Unite(empty) == B_OK);
+	CHECK(set.Count() == 100);
+
+	CHECK(empty.Unite(set) == B_OK);
+	CHECK(empty.Count() == 100);
+	CHECK(empty.Contains(0) && empty.Contains(99) && !empty.Contains(100));
+}
+
+
+void
+test_sort()
+{
+	CandidateSet set;
+	for (int32 i = 0; i < 3; i++)
+		CHECK(fill_set(set, 10, 20, 1) == B_OK);
+
+	// duplicates are removed
+	CHECK(set.Count() == 10);
+	for (off_t id = 0; id < 30; id++)
+		CHECK(set.Contains(id) == (id >= 10 && id < 20));
+}
+
+
+void
+test_intersect()
+{
+	CandidateSet even;
+	CandidateSet third;
+	CHECK(fill_set(even, 0, 1000, 2) == B_OK);
+	CHECK(fill_set(third, 0, 1000, 3) == B_OK);
+
+	even.Intersect(third);
+	CHECK(even.Count() == 167);
+	for (off_t id = 0; id < 1000; id++)
+		CHECK(even.Contains(id) == (id % 6 == 0));
+
+	// disjoint sets
+	CandidateSet low;
+	CandidateSet high;
+	CHECK(fill_set(low, 0, 100, 1) == B_OK);
+	CHECK(fill_set(high, 100, 200, 1) == B_OK);
+	low.Intersect(high);
+	CHECK(low.Count() == 0);
+}
+
+
+void
+test_unite()
+{
+	CandidateSet even;
+	CandidateSet odd;
+	CHECK(fill_set(even, 0, 1000, 2) == B_OK);
+	CHECK(fill_set(odd, 1, 1000, 2) == B_OK);
+
+	CHECK(even.Unite(odd) == B_OK);
+	CHECK(even.Count() == 1000);
+	for (off_t id = -1; id <= 1000; id++)
+		CHECK(even.Contains(id) == (id >= 0 && id < 1000));
+
+	// overlapping sets
+	CandidateSet low;
+	CandidateSet middle;
+	CHECK(fill_set(low, 0, 100, 1) == B_OK);
+	CHECK(fill_set(middle, 50, 150, 1) == B_OK);
+	CHECK(low.Unite(middle) == B_OK);
+	CHECK(low.Count() == 150);
+}
+
+
+void
+test_overflow()
+{
+	CandidateSet set;
+	CHECK(fill_set(set, 0, kMaxCandidates, 1) == B_OK);
+	CHECK(set.Count() == kMaxCandidates);
+	CHECK(set.Add(kMaxCandidates) == B_BUFFER_OVERFLOW);
+	CHECK(set.Count() == kMaxCandidates);
+
+	// a union that doesn't fit fails
+	CandidateSet other;
+	CHECK(fill_set(other, kMaxCandidates, kMaxCandidates + 10, 1) == B_OK);
+	CHECK(set.Unite(other) == B_BUFFER_OVERFLOW);
+
+	// the set still is at its limit, but overlapping unions do fit after
+	// removing the duplicates
+	CandidateSet full;
+	CandidateSet same;
+	CHECK(fill_set(full, 0, kMaxCandidates, 1) == B_OK);
+	CHECK(fill_set(same, 0, kMaxCandidates / 2, 1) == B_OK);
+	CHECK(same.Unite(full) == B_OK);
+	CHECK(same.Count() == kMaxCandidates);
+
+	// an intersection can always be computed
+	full.Intersect(other);
+	CHECK(full.Count() == 0);
+}
+
+
+void
+test_driving_term()
+{
+	// the term with the fewest matches drives the query
+	TestTerm a(1000, 10);
+	TestTerm b(20, 1);
+	TestTerm c(500, 5);
+	TestTerm* terms[] = { &a, &b, &c };
+	CHECK(find_driving_term(terms, 3) == 1);
+
+	// terms without an index can't drive the query
+	TestTerm noIndex(-1, -1);
+	TestTerm* unindexed[] = { &noIndex, &c, &noIndex };
+	CHECK(find_driving_term(unindexed, 3) == 1);
+
+	TestTerm* none[] = { &noIndex, &noIndex };
+	CHECK(find_driving_term(none, 2) == -1);
+	CHECK(find_driving_term(terms, 0) == -1);
+
+	// an empty index is the best choice
+	TestTerm empty(0, 1);
+	TestTerm* withEmpty[] = { &a, &empty, &b };
+	CHECK(find_driving_term(withEmpty, 3) == 1);
+
+	// on a tie, the first one is used
+	TestTerm b2(20, 1);
+	TestTerm* tie[] = { &a, &b, &b2 };
+	CHECK(find_driving_term(tie, 3) == 1);
+}
+
+
+void
+test_filter_order()
+{
+	TestTerm a(1000, 10);
+	TestTerm b(20, 1);
+	TestTerm c(500, 5);
+	TestTerm noIndex(-1, -1);
+	TestTerm* terms[] = { &a, &noIndex, &b, &c };
+
+	// the filters are used cheapest first; the ones already used are removed
+	// from the array by the planner
+	CHECK(find_cheapest_filter(terms, 4) == 2);
+	terms[2] = NULL;
+	CHECK(find_cheapest_filter(terms, 4) == 3);
+	terms[3] = NULL;
+	CHECK(find_cheapest_filter(terms, 4) == 0);
+	terms[0] = NULL;
+
+	// terms without an index can't be used as filter
+	CHECK(find_cheapest_filter(terms, 4) == -1);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	test_empty_sets();
+	test_sort();
+	test_intersect();
+	test_unite();
+	test_overflow();
+	test_driving_term();
+	test_filter_order();
+
+	if (gFailures > 0) {
+		fprintf(stderr, "%" B_PRId32 " checks failed\n", gFailures);
+		return 1;
+	}
+
+	printf("All tests passed.\n");
+	return 0;
+}
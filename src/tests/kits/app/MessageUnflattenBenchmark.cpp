@@ -0,0 +1,146 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Measures the latency of receiving a flattened message and looking up one
+	of its fields, as a message handler typically does.
+
+	Every iteration copies the flattened message into a fresh heap buffer, as
+	reading it from a port would, and then either unflattens it the standard
+	way, which copies all fields and data, or in place, which uses the buffer
+	as is. This is done for a small message with a few fields, and a large one
+	with many fields and some bulk data.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <Message.h>
+#include <OS.h>
+
+#include <MessagePrivate.h>
+
+
+static const int32 kDefaultIterations = 200000;
+
+
+static void
+fill_small_message(BMessage& message)
+{
+	message.what = 'smal';
+	message.AddInt32("index", 42);
+	message.AddPoint("where", BPoint(10, 20));
+	message.AddInt32("buttons", 1);
+	message.AddInt64("when", system_time());
+	message.AddString("name", "small message");
+}
+
+
+static void
+fill_large_message(BMessage& message)
+{
+	message.what = 'larg';
+
+	char name[32];
+	for (int32 i = 0; i < 200; i++) {
+		snprintf(name, sizeof(name), "field %" B_PRId32, i);
+		message.AddInt32(name, i);
+	}
+
+	char* data = (char*)malloc(256 * 1024);
+	if (data != NULL) {
+		memset(data, 0xaa, 256 * 1024);
+		message.AddData("bulk", B_RAW_TYPE, data, 256 * 1024);
+		free(data);
+	}
+
+	message.AddInt32("index", 42);
+}
+
+
+/*!	Returns the average time in microseconds it takes to unflatten \a flat and
+	to find its "index" field.
+*/
+static double
+run_benchmark(const char* flat, ssize_t size, int32 iterations, bool inPlace)
+{
+	bigtime_t startTime = system_time();
+
+	for (int32 i = 0; i < iterations; i++) {
+		char* buffer = (char*)malloc(size);
+		if (buffer == NULL) {
+			fprintf(stderr, "out of memory\n");
+			exit(1);
+		}
+		memcpy(buffer, flat, size);
+
+		BMessage message;
+		status_t status;
+		if (inPlace) {
+			// the message takes over the buffer
+			status = BMessage::Private(message).UnflattenInPlace(buffer, size);
+		} else {
+			status = message.Unflatten(buffer);
+			free(buffer);
+		}
+
+		int32 index;
+		if (status != B_OK || message.FindInt32("index", &index) != B_OK
+			|| index != 42) {
+			fprintf(stderr, "unflattening the message failed!\n");
+			exit(1);
+		}
+	}
+
+	return double(system_time() - startTime) / iterations;
+}
+
+
+static void
+run(const char* name, const BMessage& message, int32 iterations)
+{
+	ssize_t size = message.FlattenedSize();
+	char* flat = (char*)malloc(size);
+	if (flat == NULL || message.Flatten(flat, size) != B_OK) {
+		fprintf(stderr, "flattening the message failed!\n");
+		exit(1);
+	}
+
+	double copied = run_benchmark(flat, size, iterations, false);
+	double inPlace = run_benchmark(flat, size, iterations, true);
+
+	printf("%-8s %10" B_PRIdSSIZE " %7" B_PRId32 " %12.3f %14.3f %8.2fx\n",
+		name, size, message.CountNames(B_ANY_TYPE), copied, inPlace,
+		copied / inPlace);
+
+	free(flat);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int32 iterations = argc > 1 ? atol(argv[1]) : kDefaultIterations;
+	if (iterations <= 0) {
+		fprintf(stderr, "usage: %s [<iterations>]\n", argv[0]);
+		return 1;
+	}
+
+	BMessage small;
+	fill_small_message(small);
+
+	BMessage large;
+	fill_large_message(large);
+
+	printf("%-8s %10s %7s %12s %14s %9s\n", "message", "bytes", "fields",
+		"copy (us)", "in place (us)", "speedup");
+
+	run("small", small, iterations);
+	run("large", large, iterations / 100 + 1);
+
+	return 0;
+}
@@ -13,6 +13,7 @@
 //#include "bwidthbuffer/WidthBufferTest.h"
 #include "GraphicsDefsTest.h"
 #include "OutlineListViewTest.h"
+#include "StringWidthCacheTest.h"
 
 
 BTestSuite *
@@ -32,6 +33,7 @@ getTestSuite()
 	suite->addTest("BTextView", TextViewTestSuite());
 	//suite->addTest("_BWidthBuffer_", WidthBufferTestSuite());
 	suite->addTest("GraphicsDefs", GraphicsDefsTestSuite());
+	suite->addTest("StringWidthCache", StringWidthCacheTestSuite());
 
 	return suite;
 }
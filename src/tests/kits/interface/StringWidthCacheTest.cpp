@@ -0,0 +1,278 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "common.h"
+#include "StringWidthCacheTest.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <Font.h>
+#include <TestUtils.h>
+
+#include <StringWidthCache.h>
+
+
+// The keys BFont uses: family and style in the upper, the bits of the size in
+// the lower 32 bits.
+static uint64
+font_key(uint32 familyAndStyle, float size)
+{
+	uint32 sizeBits;
+	memcpy(&sizeBits, &size, sizeof(uint32));
+
+	return ((uint64)familyAndStyle << 32) | sizeBits;
+}
+
+
+static const uint64 kPlainFont = font_key(0x00010002, 12.0f);
+
+
+static bool
+get(StringWidthCache& cache, uint64 font, const char* string, float& _width,
+	uint8 spacing = B_BITMAP_SPACING)
+{
+	return cache.Get(font, spacing, string, strlen(string), _width);
+}
+
+
+static void
+put(StringWidthCache& cache, uint64 font, const char* string, float width,
+	uint8 spacing = B_BITMAP_SPACING)
+{
+	cache.Put(font, spacing, string, strlen(string), width);
+}
+
+
+class StringWidthCacheTest : public TestCase {
+public:
+								StringWidthCacheTest() {}
+								StringWidthCacheTest(std::string name)
+									: TestCase(name) {}
+
+			void				Hits();
+			void				FontChange();
+			void				SizeChange();
+			void				MakeEmpty();
+			void				Eviction();
+			void				LongStrings();
+
+	static	Test*				Suite();
+};
+
+
+void
+StringWidthCacheTest::Hits()
+{
+	StringWidthCache cache(16);
+	CHK(cache.InitCheck() == B_OK);
+
+	float width = -1;
+	CHK(!get(cache, kPlainFont, "OK", width));
+	CHK(width == -1);
+
+	put(cache, kPlainFont, "OK", 17.5f);
+	put(cache, kPlainFont, "Cancel", 42.0f);
+
+	CHK(get(cache, kPlainFont, "OK", width));
+	CHK(width == 17.5f);
+	CHK(get(cache, kPlainFont, "Cancel", width));
+	CHK(width == 42.0f);
+
+	// the whole string must match, not just its beginning
+	CHK(!get(cache, kPlainFont, "O", width));
+	CHK(!get(cache, kPlainFont, "OK ", width));
+	CHK(!cache.Get(kPlainFont, B_BITMAP_SPACING, "Cancel", 3, width));
+
+	// the empty string can be cached, too
+	put(cache, kPlainFont, "", 0.0f);
+	width = -1;
+	CHK(get(cache, kPlainFont, "", width));
+	CHK(width == 0.0f);
+
+	// putting a string again replaces its width
+	put(cache, kPlainFont, "OK", 18.0f);
+	CHK(get(cache, kPlainFont, "OK", width));
+	CHK(width == 18.0f);
+
+	// invalid arguments never hit
+	CHK(!cache.Get(kPlainFont, B_BITMAP_SPACING, NULL, 0, width));
+	CHK(!cache.Get(kPlainFont, B_BITMAP_SPACING, "OK", -1, width));
+}
+
+
+void
+StringWidthCacheTest::FontChange()
+{
+	StringWidthCache cache(16);
+	put(cache, kPlainFont, "Label", 30.0f);
+
+	// another family or style, or another spacing mode, must not see the
+	// width of the plain font
+	float width;
+	CHK(!get(cache, font_key(0x00010003, 12.0f), "Label", width));
+	CHK(!get(cache, font_key(0x00020002, 12.0f), "Label", width));
+	CHK(!get(cache, kPlainFont, "Label", width, B_CHAR_SPACING));
+
+	put(cache, font_key(0x00010003, 12.0f), "Label", 33.0f);
+	put(cache, kPlainFont, "Label", 31.0f, B_CHAR_SPACING);
+
+	CHK(get(cache, kPlainFont, "Label", width));
+	CHK(width == 30.0f);
+	CHK(get(cache, font_key(0x00010003, 12.0f), "Label", width));
+	CHK(width == 33.0f);
+	CHK(get(cache, kPlainFont, "Label", width, B_CHAR_SPACING));
+	CHK(width == 31.0f);
+}
+
+
+void
+StringWidthCacheTest::SizeChange()
+{
+	StringWidthCache cache(16);
+	put(cache, kPlainFont, "Label", 30.0f);
+
+	float width;
+	CHK(!get(cache, font_key(0x00010002, 12.5f), "Label", width));
+	CHK(!get(cache, font_key(0x00010002, 24.0f), "Label", width));
+
+	put(cache, font_key(0x00010002, 24.0f), "Label", 60.0f);
+	CHK(get(cache, font_key(0x00010002, 24.0f), "Label", width));
+	CHK(width == 60.0f);
+	CHK(get(cache, kPlainFont, "Label", width));
+	CHK(width == 30.0f);
+}
+
+
+void
+StringWidthCacheTest::MakeEmpty()
+{
+	// this is what happens when the fonts or the rendering settings change
+	StringWidthCache cache(16);
+	put(cache, kPlainFont, "OK", 17.5f);
+	put(cache, font_key(0x00010002, 24.0f), "OK", 35.0f);
+
+	cache.MakeEmpty();
+
+	float width;
+	CHK(!get(cache, kPlainFont, "OK", width));
+	CHK(!get(cache, font_key(0x00010002, 24.0f), "OK", width));
+
+	// the cache can be used again afterwards
+	put(cache, kPlainFont, "OK", 18.0f);
+	CHK(get(cache, kPlainFont, "OK", width));
+	CHK(width == 18.0f);
+}
+
+
+void
+StringWidthCacheTest::Eviction()
+{
+	StringWidthCache cache(4);
+	put(cache, kPlainFont, "one", 1.0f);
+	put(cache, kPlainFont, "two", 2.0f);
+	put(cache, kPlainFont, "three", 3.0f);
+	put(cache, kPlainFont, "four", 4.0f);
+
+	// the least recently used string is forgotten first
+	put(cache, kPlainFont, "five", 5.0f);
+
+	float width;
+	CHK(!get(cache, kPlainFont, "one", width));
+	CHK(get(cache, kPlainFont, "two", width));
+	CHK(width == 2.0f);
+
+	// "two" was just used, so "three" goes next
+	put(cache, kPlainFont, "six", 6.0f);
+	CHK(!get(cache, kPlainFont, "three", width));
+	CHK(get(cache, kPlainFont, "two", width));
+
+	// replacing a width does not evict anything
+	put(cache, kPlainFont, "four", 4.5f);
+	CHK(get(cache, kPlainFont, "two", width));
+	CHK(get(cache, kPlainFont, "four", width));
+	CHK(width == 4.5f);
+	CHK(get(cache, kPlainFont, "five", width));
+	CHK(get(cache, kPlainFont, "six", width));
+
+	// the cache never holds more than its maximum
+	for (int32 i = 0; i < 100; i++) {
+		char string[16];
+		snprintf(string, sizeof(string), "%" B_PRId32, i);
+		put(cache, kPlainFont, string, (float)i);
+	}
+
+	int32 count = 0;
+	for (int32 i = 0; i < 100; i++) {
+		char string[16];
+		snprintf(string, sizeof(string), "%" B_PRId32, i);
+		if (get(cache, kPlainFont, string, width)) {
+			CHK(width == (float)i);
+			count++;
+		}
+	}
+	CHK(count == 4);
+	CHK(get(cache, kPlainFont, "99", width));
+	CHK(!get(cache, kPlainFont, "six", width));
+}
+
+
+void
+StringWidthCacheTest::LongStrings()
+{
+	StringWidthCache cache(4, 8);
+
+	// strings longer than the maximum length are not cached
+	float width;
+	put(cache, kPlainFont, "too long to cache", 100.0f);
+	CHK(!get(cache, kPlainFont, "too long to cache", width));
+
+	put(cache, kPlainFont, "12345678", 8.0f);
+	CHK(get(cache, kPlainFont, "12345678", width));
+	CHK(width == 8.0f);
+
+	// and don't push out any of the cached strings
+	put(cache, kPlainFont, "a", 1.0f);
+	put(cache, kPlainFont, "b", 2.0f);
+	put(cache, kPlainFont, "c", 3.0f);
+	for (int32 i = 0; i < 10; i++)
+		put(cache, kPlainFont, "too long to cache", 100.0f);
+
+	CHK(get(cache, kPlainFont, "12345678", width));
+	CHK(get(cache, kPlainFont, "a", width));
+	CHK(get(cache, kPlainFont, "b", width));
+	CHK(get(cache, kPlainFont, "c", width));
+}
+
+
+/*static*/ Test*
+StringWidthCacheTest::Suite()
+{
+	TestSuite* suite = new TestSuite;
+
+	ADD_TEST4(StringWidthCache, suite, StringWidthCacheTest, Hits);
+	ADD_TEST4(StringWidthCache, suite, StringWidthCacheTest, FontChange);
+	ADD_TEST4(StringWidthCache, suite, StringWidthCacheTest, SizeChange);
+	ADD_TEST4(StringWidthCache, suite, StringWidthCacheTest, MakeEmpty);
+	ADD_TEST4(StringWidthCache, suite, StringWidthCacheTest, Eviction);
+	ADD_TEST4(StringWidthCache, suite, StringWidthCacheTest, LongStrings);
+
+	return suite;
+}
+
+
+//	#pragma mark -
+
+
+CppUnit::Test*
+StringWidthCacheTestSuite()
+{
+	CppUnit::TestSuite* testSuite = new CppUnit::TestSuite();
+
+	testSuite->addTest(StringWidthCacheTest::Suite());
+
+	return testSuite;
+}
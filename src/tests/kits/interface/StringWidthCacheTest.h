@@ -0,0 +1,14 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef STRING_WIDTH_CACHE_TEST_H
+#define STRING_WIDTH_CACHE_TEST_H
+
+
+class CppUnit::Test;
+
+CppUnit::Test* StringWidthCacheTestSuite();
+
+
+#endif	// STRING_WIDTH_CACHE_TEST_H
@@ -0,0 +1,425 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Replays a trace of page-ins against the heap of a package, the way
+	packagefs serves them: through a page cache of limited size, which reads
+	a whole 64 KiB cache line on a miss. Runs the trace with and without a
+	cache for decompressed heap chunks and compares the number of chunks
+	that had to be decompressed.
+*/
+
+
+#include <errno.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <list>
+#include <map>
+
+#include <DataIO.h>
+#include <OS.h>
+
+#include <package/hpkg/PackageFileHeapReader.h>
+#include <package/hpkg/PackageReaderImpl.h>
+#include <package/hpkg/StandardErrorOutput.h>
+
+
+using namespace BPackageKit::BHPKG;
+using BPackageKit::BHPKG::BPrivate::PackageFileHeapReader;
+using BPackageKit::BHPKG::BPrivate::PackageReaderImpl;
+
+
+static const char* kUsage =
+	"Usage: %s [ <options> ] <package> [ <trace> ]\n"
+	"Replays the page-ins of <trace> against the heap of <package>, with and\n"
+	"without a cache for decompressed chunks.\n"
+	"Each line of <trace> contains the offset and size of a read from the\n"
+	"uncompressed heap. Without <trace> random page-ins are generated, 90%%\n"
+	"of them in 10%% of the heap.\n"
+	"\n"
+	"Options:\n"
+	"  -c <size>   - The chunk cache size in KiB. Default is 4096.\n"
+	"  -h, --help  - Print this usage info.\n"
+	"  -n <count>  - The number of generated page-ins. Default is 100000.\n"
+	"  -p <size>   - The page cache size in KiB. Default is 4096.\n"
+;
+
+static const size_t kPageSize = 4096;
+static const size_t kCacheLineSize = 64 * 1024;
+
+
+struct PageIn {
+	uint64	offset;
+	uint64	size;
+};
+
+typedef std::list<PageIn> PageInList;
+
+
+class NullOutput : public BDataIO {
+public:
+	virtual ssize_t Write(const void* buffer, size_t size)
+	{
+		return size;
+	}
+};
+
+
+class ChunkCache : public PackageFileHeapReader::ChunkCache {
+public:
+	ChunkCache(size_t maxSize)
+		:
+		fMaxSize(maxSize),
+		fSize(0),
+		fHits(0),
+		fMisses(0),
+		fReadTime(0)
+	{
+	}
+
+	~ChunkCache()
+	{
+		while (!fChunks.empty()) {
+			free(fChunks.back().data);
+			fChunks.pop_back();
+		}
+	}
+
+	virtual bool GetChunk(size_t chunkIndex, void* buffer, size_t size)
+	{
+		ChunkMap::iterator it = fChunkMap.find(chunkIndex);
+		if (it == fChunkMap.end() || it->second->size != size) {
+			fMisses++;
+			return false;
+		}
+
+		memcpy(buffer, it->second->data, size);
+		fChunks.splice(fChunks.end(), fChunks, it->second);
+		fHits++;
+		return true;
+	}
+
+	virtual void PutChunk(size_t chunkIndex, const void* data, size_t size,
+		bigtime_t readTime)
+	{
+		fReadTime += readTime;
+
+		Chunk chunk;
+		chunk.index = chunkIndex;
+		chunk.size = size;
+		chunk.data = malloc(size);
+		if (chunk.data == NULL)
+			return;
+		memcpy(chunk.data, data, size);
+
+		fChunkMap[chunkIndex] = fChunks.insert(fChunks.end(), chunk);
+		fSize += size;
+
+		while (fSize > fMaxSize) {
+			Chunk& oldest = fChunks.front();
+			fChunkMap.erase(oldest.index);
+			fSize -= oldest.size;
+			free(oldest.data);
+			fChunks.pop_front();
+		}
+	}
+
+	uint64 Hits() const
+	{
+		return fHits;
+	}
+
+	uint64 Misses() const
+	{
+		return fMisses;
+	}
+
+	bigtime_t ReadTime() const
+	{
+		return fReadTime;
+	}
+
+private:
+	struct Chunk {
+		size_t	index;
+		size_t	size;
+		void*	data;
+	};
+
+	typedef std::list<Chunk> ChunkList;
+	typedef std::map<size_t, ChunkList::iterator> ChunkMap;
+
+private:
+	size_t		fMaxSize;
+	size_t		fSize;
+	ChunkList	fChunks;
+	ChunkMap	fChunkMap;
+	uint64		fHits;
+	uint64		fMisses;
+	bigtime_t	fReadTime;
+};
+
+
+/*!	A page cache of limited size with LRU replacement. Like packagefs'
+	CachedDataReader, it reads the whole cache line when a page is missing.
+*/
+class PageCache {
+public:
+	PageCache(PackageFileHeapReader* heapReader, size_t maxPages)
+		:
+		fHeapReader(heapReader),
+		fMaxPages(maxPages),
+		fLineReads(0)
+	{
+	}
+
+	status_t PageIn(uint64 offset, uint64 size)
+	{
+		uint64 end = std::min(offset + size, fHeapReader->UncompressedHeapSize());
+		for (uint64 page = offset / kPageSize; page * kPageSize < end; page++) {
+			PageMap::iterator it = fPageMap.find(page);
+			if (it != fPageMap.end()) {
+				fPages.splice(fPages.end(), fPages, it->second);
+				continue;
+			}
+
+			status_t error = _ReadCacheLine(page * kPageSize / kCacheLineSize);
+			if (error != B_OK)
+				return error;
+		}
+
+		return B_OK;
+	}
+
+	uint64 LineReads() const
+	{
+		return fLineReads;
+	}
+
+private:
+	typedef std::list<uint64> PageList;
+	typedef std::map<uint64, PageList::iterator> PageMap;
+
+private:
+	status_t _ReadCacheLine(uint64 line)
+	{
+		uint64 lineOffset = line * kCacheLineSize;
+		uint64 lineSize = std::min((uint64)kCacheLineSize,
+			fHeapReader->UncompressedHeapSize() - lineOffset);
+
+		NullOutput output;
+		status_t error = fHeapReader->ReadDataToOutput(lineOffset, lineSize,
+			&output);
+		if (error != B_OK)
+			return error;
+		fLineReads++;
+
+		// add the line's pages
+		for (uint64 page = lineOffset / kPageSize;
+				page * kPageSize < lineOffset + lineSize; page++) {
+			PageMap::iterator it = fPageMap.find(page);
+			if (it != fPageMap.end())
+				fPages.splice(fPages.end(), fPages, it->second);
+			else
+				fPageMap[page] = fPages.insert(fPages.end(), page);
+		}
+
+		while (fPages.size() > fMaxPages) {
+			fPageMap.erase(fPages.front());
+			fPages.pop_front();
+		}
+
+		return B_OK;
+	}
+
+private:
+	PackageFileHeapReader*	fHeapReader;
+	size_t					fMaxPages;
+	PageList				fPages;
+	PageMap					fPageMap;
+	uint64					fLineReads;
+};
+
+
+static void
+print_usage_and_exit(bool error)
+{
+	fprintf(error ? stderr : stdout, kUsage, "heap_chunk_cache_replay");
+	exit(error ? 1 : 0);
+}
+
+
+static bool
+read_trace(const char* path, PageInList& _pageIns)
+{
+	FILE* file = fopen(path, "r");
+	if (file == NULL) {
+		fprintf(stderr, "Error: Failed to open \"%s\": %s\n", path,
+			strerror(errno));
+		return false;
+	}
+
+	char line[256];
+	while (fgets(line, sizeof(line), file) != NULL) {
+		char* end;
+		PageIn pageIn;
+		pageIn.offset = strtoull(line, &end, 0);
+		if (end == line)
+			continue;
+		pageIn.size = strtoull(end, NULL, 0);
+		if (pageIn.size == 0)
+			pageIn.size = kPageSize;
+		_pageIns.push_back(pageIn);
+	}
+
+	fclose(file);
+	return true;
+}
+
+
+static void
+generate_trace(uint64 heapSize, int32 count, PageInList& _pageIns)
+{
+	uint64 pageCount = (heapSize + kPageSize - 1) / kPageSize;
+	uint64 hotPageCount = std::max(pageCount / 10, (uint64)1);
+
+	srand(42);
+	for (int32 i = 0; i < count; i++) {
+		uint64 random = ((uint64)rand() << 31) | rand();
+		PageIn pageIn;
+		pageIn.offset = (rand() % 10 != 0
+			? random % hotPageCount : random % pageCount) * kPageSize;
+		pageIn.size = kPageSize;
+		_pageIns.push_back(pageIn);
+	}
+}
+
+
+static bool
+replay(PackageFileHeapReader* heapReader, const PageInList& pageIns,
+	size_t pageCacheSize, ChunkCache* chunkCache)
+{
+	heapReader->SetChunkCache(chunkCache);
+
+	PageCache pageCache(heapReader, pageCacheSize / kPageSize);
+	bigtime_t startTime = system_time();
+	for (PageInList::const_iterator it = pageIns.begin(); it != pageIns.end();
+			++it) {
+		status_t error = pageCache.PageIn(it->offset, it->size);
+		if (error != B_OK) {
+			fprintf(stderr, "Error: Failed to read heap at %" B_PRIu64 ": "
+				"%s\n", it->offset, strerror(error));
+			return false;
+		}
+	}
+	bigtime_t time = system_time() - startTime;
+
+	heapReader->SetChunkCache(NULL);
+
+	printf("%s:\n", chunkCache != NULL ? "with chunk cache" : "uncached");
+	printf("  cache line reads:    %10" B_PRIu64 "\n", pageCache.LineReads());
+	if (chunkCache != NULL) {
+		uint64 lookups = chunkCache->Hits() + chunkCache->Misses();
+		printf("  chunk cache hits:    %10" B_PRIu64 " (%" B_PRIu64 "%%)\n",
+			chunkCache->Hits(),
+			lookups > 0 ? chunkCache->Hits() * 100 / lookups : 0);
+		printf("  decompressed chunks: %10" B_PRIu64 "\n",
+			chunkCache->Misses());
+		printf("  decompression time:  %10" B_PRIdBIGTIME " us\n",
+			chunkCache->ReadTime());
+	}
+	printf("  total time:          %10" B_PRIdBIGTIME " us\n", time);
+	return true;
+}
+
+
+int
+main(int argc, const char* const* argv)
+{
+	size_t chunkCacheSize = 4096 * 1024;
+	size_t pageCacheSize = 4096 * 1024;
+	int32 pageInCount = 100000;
+
+	while (true) {
+		static struct option sLongOptions[] = {
+			{ "help", no_argument, 0, 'h' },
+			{ 0, 0, 0, 0 }
+		};
+
+		opterr = 0; // don't print errors
+		int c = getopt_long(argc, (char**)argv, "+c:hn:p:", sLongOptions,
+			NULL);
+		if (c == -1)
+			break;
+
+		switch (c) {
+			case 'c':
+				chunkCacheSize = strtoul(optarg, NULL, 0) * 1024;
+				break;
+
+			case 'h':
+				print_usage_and_exit(false);
+				break;
+
+			case 'n':
+				pageInCount = atoi(optarg);
+				break;
+
+			case 'p':
+				pageCacheSize = strtoul(optarg, NULL, 0) * 1024;
+				break;
+
+			default:
+				print_usage_and_exit(true);
+				break;
+		}
+	}
+
+	if (optind >= argc || argc - optind > 2)
+		print_usage_and_exit(true);
+
+	const char* packagePath = argv[optind];
+	const char* tracePath = optind + 1 < argc ? argv[optind + 1] : NULL;
+
+	BStandardErrorOutput errorOutput;
+	PackageReaderImpl packageReader(&errorOutput);
+	status_t error = packageReader.Init(packagePath, 0);
+	if (error != B_OK) {
+		fprintf(stderr, "Error: Failed to open package \"%s\": %s\n",
+			packagePath, strerror(error));
+		return 1;
+	}
+
+	PackageFileHeapReader* heapReader = packageReader.RawHeapReader();
+	if (heapReader == NULL || heapReader->UncompressedHeapSize() == 0) {
+		fprintf(stderr, "Error: The package has no heap.\n");
+		return 1;
+	}
+
+	PageInList pageIns;
+	if (tracePath != NULL) {
+		if (!read_trace(tracePath, pageIns))
+			return 1;
+	} else
+		generate_trace(heapReader->UncompressedHeapSize(), pageInCount,
+			pageIns);
+
+	printf("heap:                  %10" B_PRIu64 " bytes\n",
+		heapReader->UncompressedHeapSize());
+	printf("page-ins:              %10" B_PRIuSIZE "\n", pageIns.size());
+
+	if (!replay(heapReader, pageIns, pageCacheSize, NULL))
+		return 1;
+
+	ChunkCache chunkCache(chunkCacheSize);
+	if (!replay(heapReader, pageIns, pageCacheSize, &chunkCache))
+		return 1;
+
+	return 0;
+}
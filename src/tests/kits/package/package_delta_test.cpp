@@ -0,0 +1,412 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Creates two versions of a package, writes a delta between them and
+	applies it to the old version. The result must be identical to the new
+	version. Also checks that the delta is rejected when applied to the
+	wrong base, and when it has been truncated or corrupted.
+*/
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <package/hpkg/ErrorOutput.h>
+#include <package/hpkg/HPKGDefs.h>
+#include <package/hpkg/PackageDeltaReader.h>
+#include <package/hpkg/PackageDeltaWriter.h>
+#include <package/hpkg/PackageWriter.h>
+
+
+using namespace BPackageKit::BHPKG;
+using BPackageKit::BHPKG::BPrivate::PackageDeltaReader;
+using BPackageKit::BHPKG::BPrivate::PackageDeltaWriter;
+
+
+static const size_t kFileSize = 256 * 1024;
+static const int kFileCount = 8;
+static const char* kDataDirectory = "data";
+
+static const char* kPackageInfo =
+	"name			package_delta_test\n"
+	"version		%d-1\n"
+	"architecture	any\n"
+	"summary		\"Package delta test data\"\n"
+	"description	\"Generated data for the package delta test.\"\n"
+	"packager		\"Nobody <nobody@example.com>\"\n"
+	"vendor			\"Haiku Project\"\n"
+	"licenses		\"MIT\"\n"
+	"copyrights		\"2026 Haiku, Inc.\"\n"
+	"provides {\n"
+	"	package_delta_test = %d-1\n"
+	"}\n";
+
+
+class Listener : public BPackageWriterListener {
+public:
+	virtual void PrintErrorVarArgs(const char* format, va_list args)
+	{
+		vfprintf(stderr, format, args);
+	}
+
+	virtual void OnEntryAdded(const char* path)
+	{
+	}
+
+	virtual void OnTOCSizeInfo(uint64 uncompressedStringsSize,
+		uint64 uncompressedMainSize, uint64 uncompressedTOCSize)
+	{
+	}
+
+	virtual void OnPackageAttributesSizeInfo(uint32 stringCount,
+		uint32 uncompressedSize)
+	{
+	}
+
+	virtual void OnPackageSizeInfo(uint32 headerSize, uint64 heapSize,
+		uint64 tocSize, uint32 packageAttributesSize, uint64 totalSize)
+	{
+	}
+};
+
+
+class ErrorOutput : public BErrorOutput {
+public:
+	ErrorOutput(bool quiet)
+		:
+		fQuiet(quiet)
+	{
+	}
+
+	virtual void PrintErrorVarArgs(const char* format, va_list args)
+	{
+		if (!fQuiet)
+			vfprintf(stderr, format, args);
+	}
+
+private:
+	bool	fQuiet;
+};
+
+
+static int sFailures = 0;
+
+
+#define CHECK(condition)												\
+	do {																\
+		if (!(condition)) {												\
+			fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__,		\
+				__LINE__, #condition);									\
+			sFailures++;												\
+		}																\
+	} while (false)
+
+
+/*!	Fills the buffer with something that compresses roughly like a mix of
+	code and text: words from a small vocabulary, sprinkled with random bytes.
+*/
+static void
+generate_data(uint8* buffer, size_t size, uint32 random)
+{
+	static const char* const kWords[] = {
+		"return ", "status_t ", "error", " = ", "B_OK;\n", "if (", ") {\n",
+		"\t", "}\n", "fBuffer", "->", "size", ", ", "NULL", "0x7f454c46 "
+	};
+	static const uint32 kWordCount = sizeof(kWords) / sizeof(kWords[0]);
+
+	size_t i = 0;
+	while (i < size) {
+		// xorshift32
+		random ^= random << 13;
+		random ^= random >> 17;
+		random ^= random << 5;
+
+		if ((random & 0xff) < 40) {
+			buffer[i++] = (uint8)(random >> 8);
+			continue;
+		}
+
+		for (const char* word = kWords[(random >> 8) % kWordCount];
+				*word != '\0' && i < size; word++) {
+			buffer[i++] = *word;
+		}
+	}
+}
+
+
+static bool
+write_file(const char* path, const void* data, size_t size)
+{
+	int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		fprintf(stderr, "Error: Failed to create \"%s\": %s\n", path,
+			strerror(errno));
+		return false;
+	}
+
+	bool success = write(fd, data, size) == (ssize_t)size;
+	if (!success) {
+		fprintf(stderr, "Error: Failed to write \"%s\": %s\n", path,
+			strerror(errno));
+	}
+
+	close(fd);
+	return success;
+}
+
+
+static bool
+copy_file(const char* source, const char* target, off_t size)
+{
+	FILE* input = fopen(source, "rb");
+	FILE* output = fopen(target, "wb");
+	bool success = input != NULL && output != NULL;
+
+	while (success && size > 0) {
+		int c = fgetc(input);
+		if (c == EOF)
+			break;
+		success = fputc(c, output) != EOF;
+		size--;
+	}
+
+	if (input != NULL)
+		fclose(input);
+	if (output != NULL && fclose(output) != 0)
+		success = false;
+
+	return success;
+}
+
+
+static bool
+files_equal(const char* path1, const char* path2)
+{
+	FILE* file1 = fopen(path1, "rb");
+	FILE* file2 = fopen(path2, "rb");
+	bool equal = file1 != NULL && file2 != NULL;
+
+	while (equal) {
+		int c = fgetc(file1);
+		equal = c == fgetc(file2);
+		if (c == EOF)
+			break;
+	}
+
+	if (file1 != NULL)
+		fclose(file1);
+	if (file2 != NULL)
+		fclose(file2);
+
+	return equal;
+}
+
+
+static off_t
+file_size(const char* path)
+{
+	struct stat st;
+	if (stat(path, &st) != 0)
+		return -1;
+	return st.st_size;
+}
+
+
+/*!	Creates a package from the files "data/file<n>". Version 1 contains the
+	files seeded with \a seed; version 2 changes one of them and adds another
+	one in the middle, so that the delta has to both copy from the base and
+	carry new data.
+*/
+static bool
+create_package(const char* fileName, int version, uint32 seed)
+{
+	if (mkdir(kDataDirectory, 0755) != 0 && errno != EEXIST) {
+		fprintf(stderr, "Error: Failed to create the data directory: %s\n",
+			strerror(errno));
+		return false;
+	}
+
+	uint8* buffer = (uint8*)malloc(kFileSize);
+	if (buffer == NULL)
+		return false;
+
+	bool success = true;
+	for (int i = 0; success && i < kFileCount; i++) {
+		uint32 random = seed + i;
+		if (version > 1 && i == kFileCount / 2)
+			random += 1000;
+		generate_data(buffer, kFileSize, random);
+
+		char path[64];
+		snprintf(path, sizeof(path), "%s/file%d", kDataDirectory, i);
+		success = write_file(path, buffer, kFileSize);
+
+		if (success && i == kFileCount / 2) {
+			snprintf(path, sizeof(path), "%s/file%d-new", kDataDirectory, i);
+			if (version > 1) {
+				generate_data(buffer, kFileSize / 3, seed + 2000);
+				success = write_file(path, buffer, kFileSize / 3);
+			} else
+				unlink(path);
+		}
+	}
+
+	free(buffer);
+
+	char packageInfo[1024];
+	snprintf(packageInfo, sizeof(packageInfo), kPackageInfo, version,
+		version);
+	if (!success
+		|| !write_file(".PackageInfo", packageInfo, strlen(packageInfo))) {
+		return false;
+	}
+
+	BPackageWriterParameters parameters;
+	parameters.SetCompression(B_HPKG_COMPRESSION_ZLIB);
+
+	Listener listener;
+	BPackageWriter packageWriter(&listener);
+	packageWriter.SetCheckLicenses(false);
+
+	return packageWriter.Init(fileName, &parameters) == B_OK
+		&& packageWriter.AddEntry(".PackageInfo") == B_OK
+		&& packageWriter.AddEntry(kDataDirectory) == B_OK
+		&& packageWriter.Finish() == B_OK;
+}
+
+
+static status_t
+write_delta(const char* base, const char* target, const char* delta)
+{
+	int baseFD = open(base, O_RDONLY);
+	int targetFD = open(target, O_RDONLY);
+	int deltaFD = open(delta, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+	status_t error = B_ERROR;
+	if (baseFD >= 0 && targetFD >= 0 && deltaFD >= 0) {
+		ErrorOutput errorOutput(false);
+		PackageDeltaWriter writer(&errorOutput);
+		error = writer.Init(baseFD, targetFD);
+		if (error == B_OK) {
+			printf("delta: %" B_PRIu64 " bytes copied from the base, %"
+				B_PRIu64 " bytes of data\n", writer.CopiedSize(),
+				writer.DataSize());
+			CHECK(writer.CopiedSize() > 0);
+			CHECK(writer.DataSize() > 0);
+			error = writer.Finish(deltaFD);
+		}
+	}
+
+	if (baseFD >= 0)
+		close(baseFD);
+	if (targetFD >= 0)
+		close(targetFD);
+	if (deltaFD >= 0)
+		close(deltaFD);
+
+	return error;
+}
+
+
+static status_t
+apply_delta(const char* base, const char* delta, const char* target,
+	bool expectFailure)
+{
+	int baseFD = open(base, O_RDONLY);
+	int deltaFD = open(delta, O_RDONLY);
+	int targetFD = open(target, O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+	status_t error = B_ERROR;
+	if (baseFD >= 0 && deltaFD >= 0 && targetFD >= 0) {
+		ErrorOutput errorOutput(expectFailure);
+		PackageDeltaReader reader(&errorOutput);
+		error = reader.Init(deltaFD);
+		if (error == B_OK)
+			error = reader.Apply(baseFD, targetFD);
+	}
+
+	if (baseFD >= 0)
+		close(baseFD);
+	if (deltaFD >= 0)
+		close(deltaFD);
+	if (targetFD >= 0)
+		close(targetFD);
+
+	return error;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	char directory[] = "/tmp/package_delta_test-XXXXXX";
+	if (mkdtemp(directory) == NULL || chdir(directory) != 0) {
+		fprintf(stderr, "Error: Failed to create a directory: %s\n",
+			strerror(errno));
+		return 1;
+	}
+
+	if (!create_package("base.hpkg", 1, 1)
+		|| !create_package("target.hpkg", 2, 1)
+		|| !create_package("other.hpkg", 1, 100)) {
+		fprintf(stderr, "Error: Failed to create the packages\n");
+		return 1;
+	}
+
+	// round trip
+	CHECK(write_delta("base.hpkg", "target.hpkg", "delta") == B_OK);
+	CHECK(apply_delta("base.hpkg", "delta", "result.hpkg", false) == B_OK);
+	CHECK(files_equal("target.hpkg", "result.hpkg"));
+	CHECK(file_size("delta") < file_size("target.hpkg"));
+
+	// wrong base
+	CHECK(apply_delta("other.hpkg", "delta", "result.hpkg", true)
+		== B_BAD_DATA);
+	CHECK(apply_delta("target.hpkg", "delta", "result.hpkg", true)
+		== B_BAD_DATA);
+
+	// truncated delta
+	off_t deltaSize = file_size("delta");
+	CHECK(copy_file("delta", "truncated", deltaSize - 1));
+	CHECK(apply_delta("base.hpkg", "truncated", "result.hpkg", true) != B_OK);
+	CHECK(copy_file("delta", "truncated", deltaSize / 2));
+	CHECK(apply_delta("base.hpkg", "truncated", "result.hpkg", true) != B_OK);
+
+	// corrupted delta: in the header and in the data
+	const off_t corruptOffsets[] = { 4, deltaSize / 2, deltaSize - 1 };
+	for (size_t i = 0; i < sizeof(corruptOffsets) / sizeof(off_t); i++) {
+		CHECK(copy_file("delta", "corrupted", deltaSize));
+		int fd = open("corrupted", O_RDWR);
+		uint8 byte = 0;
+		CHECK(fd >= 0 && pread(fd, &byte, 1, corruptOffsets[i]) == 1);
+		byte ^= 0x5a;
+		CHECK(fd >= 0 && pwrite(fd, &byte, 1, corruptOffsets[i]) == 1);
+		if (fd >= 0)
+			close(fd);
+
+		CHECK(apply_delta("base.hpkg", "corrupted", "result.hpkg", true)
+			!= B_OK);
+	}
+
+	char command[PATH_MAX + 16];
+	snprintf(command, sizeof(command), "rm -rf \"%s\"", directory);
+	if (system(command) != 0)
+		fprintf(stderr, "Warning: Failed to remove \"%s\"\n", directory);
+
+	if (sFailures > 0) {
+		fprintf(stderr, "%d checks failed\n", sFailures);
+		return 1;
+	}
+
+	printf("all checks passed\n");
+	return 0;
+}
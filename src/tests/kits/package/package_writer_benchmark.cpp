@@ -0,0 +1,365 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Creates the same large package with different numbers of compression
+	threads, and prints the throughput. The packages must be identical.
+*/
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <OS.h>
+
+#include <package/hpkg/HPKGDefs.h>
+#include <package/hpkg/PackageWriter.h>
+
+
+using namespace BPackageKit::BHPKG;
+
+
+static const char* kUsage =
+	"Usage: %s [ <options> ]\n"
+	"Creates a package from generated data with 1, 2, 4, ... compression\n"
+	"threads, and prints the throughput.\n"
+	"\n"
+	"Options:\n"
+	"  -d <directory>  - Where to put the data and the packages. They are\n"
+	"                    kept. Default is a new directory in /tmp.\n"
+	"  -h, --help      - Print this usage info.\n"
+	"  -j <threads>    - The maximum number of threads. Default is the\n"
+	"                    number of CPUs.\n"
+	"  -k              - Keep the data and the packages.\n"
+	"  -l <level>      - The compression level.\n"
+	"  -s <size>       - The size of the package contents in MiB. Default\n"
+	"                    is 256.\n"
+	"  -z              - Use zstd compression.\n"
+;
+
+static const size_t kFileSize = 4 * 1024 * 1024;
+static const char* kDataDirectory = "data";
+
+static const char* kPackageInfo =
+	"name			package_writer_benchmark\n"
+	"version		1-1\n"
+	"architecture	any\n"
+	"summary		\"Package writer benchmark data\"\n"
+	"description	\"Generated data for the package writer benchmark.\"\n"
+	"packager		\"Nobody <nobody@example.com>\"\n"
+	"vendor			\"Haiku Project\"\n"
+	"licenses		\"MIT\"\n"
+	"copyrights		\"2026 Haiku, Inc.\"\n"
+	"provides {\n"
+	"	package_writer_benchmark = 1-1\n"
+	"}\n";
+
+
+class Listener : public BPackageWriterListener {
+public:
+	virtual void PrintErrorVarArgs(const char* format, va_list args)
+	{
+		vfprintf(stderr, format, args);
+	}
+
+	virtual void OnEntryAdded(const char* path)
+	{
+	}
+
+	virtual void OnTOCSizeInfo(uint64 uncompressedStringsSize,
+		uint64 uncompressedMainSize, uint64 uncompressedTOCSize)
+	{
+	}
+
+	virtual void OnPackageAttributesSizeInfo(uint32 stringCount,
+		uint32 uncompressedSize)
+	{
+	}
+
+	virtual void OnPackageSizeInfo(uint32 headerSize, uint64 heapSize,
+		uint64 tocSize, uint32 packageAttributesSize, uint64 totalSize)
+	{
+	}
+};
+
+
+static void
+print_usage_and_exit(const char* programName, bool error)
+{
+	fprintf(error ? stderr : stdout, kUsage, programName);
+	exit(error ? 1 : 0);
+}
+
+
+/*!	Fills the buffer with something that compresses roughly like a mix of
+	code and text: words from a small vocabulary, sprinkled with random bytes.
+*/
+static void
+generate_data(uint8* buffer, size_t size, uint32& random)
+{
+	static const char* const kWords[] = {
+		"return ", "status_t ", "error", " = ", "B_OK;\n", "if (", ") {\n",
+		"\t", "}\n", "fBuffer", "->", "size", ", ", "NULL", "0x7f454c46 "
+	};
+	static const uint32 kWordCount = sizeof(kWords) / sizeof(kWords[0]);
+
+	size_t i = 0;
+	while (i < size) {
+		// xorshift32
+		random ^= random << 13;
+		random ^= random >> 17;
+		random ^= random << 5;
+
+		if ((random & 0xff) < 40) {
+			buffer[i++] = (uint8)(random >> 8);
+			continue;
+		}
+
+		for (const char* word = kWords[(random >> 8) % kWordCount];
+				*word != '\0' && i < size; word++) {
+			buffer[i++] = *word;
+		}
+	}
+}
+
+
+static bool
+write_file(const char* path, const void* data, size_t size)
+{
+	int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		fprintf(stderr, "Error: Failed to create \"%s\": %s\n", path,
+			strerror(errno));
+		return false;
+	}
+
+	bool success = write(fd, data, size) == (ssize_t)size;
+	if (!success) {
+		fprintf(stderr, "Error: Failed to write \"%s\": %s\n", path,
+			strerror(errno));
+	}
+
+	close(fd);
+	return success;
+}
+
+
+static bool
+create_data(size_t totalSize)
+{
+	if (mkdir(kDataDirectory, 0755) != 0 && errno != EEXIST) {
+		fprintf(stderr, "Error: Failed to create the data directory: %s\n",
+			strerror(errno));
+		return false;
+	}
+
+	if (!write_file(".PackageInfo", kPackageInfo, strlen(kPackageInfo)))
+		return false;
+
+	uint8* buffer = (uint8*)malloc(kFileSize);
+	if (buffer == NULL)
+		return false;
+
+	uint32 random = 1;
+	bool success = true;
+	for (size_t offset = 0, index = 0; success && offset < totalSize;
+			offset += kFileSize, index++) {
+		size_t size = totalSize - offset < kFileSize
+			? totalSize - offset : kFileSize;
+		generate_data(buffer, size, random);
+
+		char path[64];
+		snprintf(path, sizeof(path), "%s/file%04zu", kDataDirectory, index);
+		success = write_file(path, buffer, size);
+	}
+
+	free(buffer);
+	return success;
+}
+
+
+static bool
+create_package(const char* fileName, const BPackageWriterParameters& parameters)
+{
+	Listener listener;
+	BPackageWriter packageWriter(&listener);
+	packageWriter.SetCheckLicenses(false);
+
+	return packageWriter.Init(fileName, &parameters) == B_OK
+		&& packageWriter.AddEntry(".PackageInfo") == B_OK
+		&& packageWriter.AddEntry(kDataDirectory) == B_OK
+		&& packageWriter.Finish() == B_OK;
+}
+
+
+static bool
+files_equal(const char* path1, const char* path2)
+{
+	FILE* file1 = fopen(path1, "rb");
+	FILE* file2 = fopen(path2, "rb");
+	bool equal = file1 != NULL && file2 != NULL;
+
+	while (equal) {
+		int c = fgetc(file1);
+		equal = c == fgetc(file2);
+		if (c == EOF)
+			break;
+	}
+
+	if (file1 != NULL)
+		fclose(file1);
+	if (file2 != NULL)
+		fclose(file2);
+
+	return equal;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	const char* directory = NULL;
+	bool keepFiles = false;
+	int32 maxThreads = (int32)sysconf(_SC_NPROCESSORS_ONLN);
+	int32 compression = B_HPKG_COMPRESSION_ZLIB;
+	int32 compressionLevel = -1;
+	size_t size = 256;
+
+	while (true) {
+		static struct option sLongOptions[] = {
+			{ "help", no_argument, 0, 'h' },
+			{ 0, 0, 0, 0 }
+		};
+
+		opterr = 0; // don't print errors
+		int c = getopt_long(argc, (char**)argv, "+d:hj:kl:s:z", sLongOptions,
+			NULL);
+		if (c == -1)
+			break;
+
+		switch (c) {
+			case 'd':
+				directory = optarg;
+				break;
+
+			case 'h':
+				print_usage_and_exit(argv[0], false);
+				break;
+
+			case 'j':
+				maxThreads = atoi(optarg);
+				break;
+
+			case 'k':
+				keepFiles = true;
+				break;
+
+			case 'l':
+				compressionLevel = atoi(optarg);
+				break;
+
+			case 's':
+				size = strtoul(optarg, NULL, 0);
+				break;
+
+			case 'z':
+				compression = B_HPKG_COMPRESSION_ZSTD;
+				break;
+
+			default:
+				print_usage_and_exit(argv[0], true);
+				break;
+		}
+	}
+
+	if (optind != argc || maxThreads < 1 || size == 0)
+		print_usage_and_exit(argv[0], true);
+
+	size *= 1024 * 1024;
+
+	char directoryBuffer[] = "/tmp/package_writer_benchmark-XXXXXX";
+	if (directory == NULL) {
+		directory = mkdtemp(directoryBuffer);
+		if (directory == NULL) {
+			fprintf(stderr, "Error: Failed to create a directory: %s\n",
+				strerror(errno));
+			return 1;
+		}
+	}
+
+	if (chdir(directory) != 0) {
+		fprintf(stderr, "Error: Failed to change to \"%s\": %s\n", directory,
+			strerror(errno));
+		return 1;
+	}
+
+	printf("generating %zu MiB of data in %s\n", size / 1024 / 1024,
+		directory);
+	if (!create_data(size))
+		return 1;
+
+	BPackageWriterParameters parameters;
+	parameters.SetCompression(compression);
+	if (compressionLevel >= 0)
+		parameters.SetCompressionLevel(compressionLevel);
+
+	printf("threads       time       MiB/s  speedup  package size\n");
+
+	bigtime_t singleThreadTime = 0;
+	bool success = true;
+	for (int32 threads = 1; success; threads *= 2) {
+		if (threads > maxThreads)
+			threads = maxThreads;
+
+		char fileName[64];
+		snprintf(fileName, sizeof(fileName), "benchmark-%" B_PRId32 ".hpkg",
+			threads);
+		parameters.SetThreadCount(threads);
+
+		bigtime_t startTime = system_time();
+		if (!create_package(fileName, parameters)) {
+			fprintf(stderr, "Error: Failed to create the package with %"
+				B_PRId32 " threads\n", threads);
+			return 1;
+		}
+		bigtime_t time = system_time() - startTime;
+		if (threads == 1)
+			singleThreadTime = time;
+
+		struct stat st;
+		if (stat(fileName, &st) != 0)
+			st.st_size = 0;
+
+		printf("%7" B_PRId32 " %8.2f s %11.1f %7.2fx %13lld\n", threads,
+			time / 1000000.0, size / 1024.0 / 1024 / (time / 1000000.0),
+			(double)singleThreadTime / time, (long long)st.st_size);
+
+		if (threads > 1 && !files_equal(fileName, "benchmark-1.hpkg")) {
+			fprintf(stderr, "Error: The package created with %" B_PRId32
+				" threads differs from the one created with 1 thread!\n",
+				threads);
+			success = false;
+		}
+
+		if (threads == maxThreads)
+			break;
+	}
+
+	if (!keepFiles && directory == directoryBuffer) {
+		char command[PATH_MAX + 16];
+		snprintf(command, sizeof(command), "rm -rf \"%s\"", directory);
+		if (system(command) != 0)
+			fprintf(stderr, "Warning: Failed to remove \"%s\"\n", directory);
+	}
+
+	return success ? 0 : 1;
+}
@@ -0,0 +1,235 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Measures how long the solver takes to build its pool from local repository
+	cache files and how long it takes to solve, over a number of runs. The
+	first run creates the solver's pool caches, if they don't exist yet, the
+	following ones use them. Each run finally changes the installed packages
+	and measures how long updating the pool takes.
+*/
+
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <Entry.h>
+#include <OS.h>
+#include <package/RepositoryCache.h>
+#include <package/solver/Solver.h>
+#include <package/solver/SolverPackage.h>
+#include <package/solver/SolverPackageSpecifierList.h>
+#include <package/solver/SolverRepository.h>
+
+#include <AutoDeleter.h>
+
+
+using namespace BPackageKit;
+
+
+static const char* kUsage =
+	"Usage: %s [ <options> ] <repository> ...\n"
+	"Adds the given repository cache files to a solver and prints how long\n"
+	"building the pool and solving take.\n"
+	"\n"
+	"Options:\n"
+	"  -d <level>      - Set the solver's debug level.\n"
+	"  -h, --help      - Print this usage info.\n"
+	"  -i <repository> - Use the packages of the given repository cache file\n"
+	"                    as the installed packages.\n"
+	"  -p <package>    - Solve installing the given package. Can be given\n"
+	"                    multiple times.\n"
+	"  -r <runs>       - The number of runs. Default is 3.\n"
+;
+
+
+static void
+print_usage_and_exit(bool error)
+{
+	fprintf(error ? stderr : stdout, kUsage, "solver_benchmark");
+	exit(error ? 1 : 0);
+}
+
+
+static BSolverRepository*
+create_repository(const char* path)
+{
+	BRepositoryCache cache;
+	status_t error = cache.SetTo(BEntry(path));
+	if (error != B_OK) {
+		fprintf(stderr, "Error: Failed to read repository \"%s\": %s\n", path,
+			strerror(error));
+		return NULL;
+	}
+
+	BSolverRepository* repository = new BSolverRepository;
+	error = repository->SetTo(cache);
+	if (error != B_OK) {
+		fprintf(stderr, "Error: Failed to init repository \"%s\": %s\n", path,
+			strerror(error));
+		delete repository;
+		return NULL;
+	}
+
+	return repository;
+}
+
+
+static bool
+run(const char* installedPath, const char* const* repositoryPaths,
+	int repositoryCount, const BSolverPackageSpecifierList& packages,
+	int32 debugLevel, int32 runIndex)
+{
+	BSolver* solver;
+	status_t error = BSolver::Create(solver);
+	if (error != B_OK) {
+		fprintf(stderr, "Error: Failed to create solver: %s\n",
+			strerror(error));
+		return false;
+	}
+	ObjectDeleter<BSolver> solverDeleter(solver);
+
+	solver->SetDebugLevel(debugLevel);
+
+	// add the repositories
+	bigtime_t startTime = system_time();
+
+	BObjectList<BSolverRepository> repositories(10, true);
+	BSolverRepository* installedRepository = NULL;
+	if (installedPath != NULL) {
+		installedRepository = create_repository(installedPath);
+		if (installedRepository == NULL)
+			return false;
+		repositories.AddItem(installedRepository);
+		installedRepository->SetInstalled(true);
+	}
+
+	for (int i = 0; i < repositoryCount; i++) {
+		BSolverRepository* repository = create_repository(repositoryPaths[i]);
+		if (repository == NULL)
+			return false;
+		repositories.AddItem(repository);
+	}
+
+	for (int32 i = 0; BSolverRepository* repository = repositories.ItemAt(i);
+			i++) {
+		error = solver->AddRepository(repository);
+		if (error != B_OK) {
+			fprintf(stderr, "Error: Failed to add repository: %s\n",
+				strerror(error));
+			return false;
+		}
+	}
+
+	bigtime_t readTime = system_time() - startTime;
+
+	// Finding packages without any search flags builds the pool and does
+	// nothing else.
+	BObjectList<BSolverPackage> foundPackages;
+	startTime = system_time();
+	error = solver->FindPackages("", 0, foundPackages);
+	bigtime_t poolTime = system_time() - startTime;
+	if (error != B_OK) {
+		fprintf(stderr, "Error: Failed to build the pool: %s\n",
+			strerror(error));
+		return false;
+	}
+
+	bigtime_t solveTime = 0;
+	if (!packages.IsEmpty()) {
+		startTime = system_time();
+		error = solver->Install(packages);
+		solveTime = system_time() - startTime;
+		if (error != B_OK) {
+			fprintf(stderr, "Error: Failed to solve: %s\n", strerror(error));
+			return false;
+		}
+	}
+
+	// change the installed packages and update the pool
+	bigtime_t updateTime = 0;
+	if (installedRepository != NULL && !installedRepository->IsEmpty()) {
+		installedRepository->DeletePackage(installedRepository->PackageAt(
+			installedRepository->CountPackages() - 1));
+
+		startTime = system_time();
+		error = solver->FindPackages("", 0, foundPackages);
+		updateTime = system_time() - startTime;
+		if (error != B_OK) {
+			fprintf(stderr, "Error: Failed to update the pool: %s\n",
+				strerror(error));
+			return false;
+		}
+	}
+
+	printf("run %2" B_PRId32 ": read %8" B_PRIdBIGTIME " us, pool %8"
+		B_PRIdBIGTIME " us, solve %8" B_PRIdBIGTIME " us (%" B_PRId32
+		" problems), pool update %8" B_PRIdBIGTIME " us\n", runIndex,
+		readTime, poolTime, solveTime, solver->CountProblems(), updateTime);
+	return true;
+}
+
+
+int
+main(int argc, const char* const* argv)
+{
+	const char* installedPath = NULL;
+	BSolverPackageSpecifierList packages;
+	int32 debugLevel = 0;
+	int32 runCount = 3;
+
+	while (true) {
+		static struct option sLongOptions[] = {
+			{ "help", no_argument, 0, 'h' },
+			{ 0, 0, 0, 0 }
+		};
+
+		opterr = 0; // don't print errors
+		int c = getopt_long(argc, (char**)argv, "+d:hi:p:r:", sLongOptions,
+			NULL);
+		if (c == -1)
+			break;
+
+		switch (c) {
+			case 'd':
+				debugLevel = atoi(optarg);
+				break;
+
+			case 'h':
+				print_usage_and_exit(false);
+				break;
+
+			case 'i':
+				installedPath = optarg;
+				break;
+
+			case 'p':
+				packages.AppendSpecifier(BString(optarg));
+				break;
+
+			case 'r':
+				runCount = atoi(optarg);
+				break;
+
+			default:
+				print_usage_and_exit(true);
+				break;
+		}
+	}
+
+	if (optind >= argc || runCount < 1)
+		print_usage_and_exit(true);
+
+	for (int32 i = 0; i < runCount; i++) {
+		if (!run(installedPath, argv + optind, argc - optind, packages,
+				debugLevel, i)) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
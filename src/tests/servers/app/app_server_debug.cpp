@@ -15,7 +15,7 @@ extern const char* __progname;
 
 
 status_t
-send_debug_message(team_id team, int32 code)
+send_debug_message(team_id team, int32 code, bool attachTeam = true)
 {
 	BPrivate::DesktopLink link;
 
@@ -28,9 +28,11 @@ send_debug_message(team_id team, int32 code)
 	if (status != B_OK)
 		return status;
 
-	status = link.Attach(team);
-	if (status != B_OK)
-		return status;
+	if (attachTeam) {
+		status = link.Attach(team);
+		if (status != B_OK)
+			return status;
+	}
 
 	// send it
 	return link.Flush();
@@ -40,7 +42,7 @@ send_debug_message(team_id team, int32 code)
 void
 usage()
 {
-	fprintf(stderr, "usage: %s -[ab] <team-id> [...]\n", __progname);
+	fprintf(stderr, "usage: %s -[abf] [<team-id> ...]\n", __progname);
 	exit(1);
 }
 
@@ -53,15 +55,18 @@ main(int argc, char** argv)
 
 	bool dumpAllocator = false;
 	bool dumpBitmaps = false;
+	bool dumpFrameStatistics = false;
 
 	int32 i = 1;
-	while (argv[i][0] == '-') {
+	while (i < argc && argv[i][0] == '-') {
 		const char* arg = &argv[i][1];
 		while (arg[0]) {
 			if (arg[0] == 'a')
 				dumpAllocator = true;
 			else if (arg[0] == 'b')
 				dumpBitmaps = true;
+			else if (arg[0] == 'f')
+				dumpFrameStatistics = true;
 			else
 				usage();
 
@@ -70,6 +75,9 @@ main(int argc, char** argv)
 		i++;
 	}
 
+	if (dumpFrameStatistics)
+		send_debug_message(-1, AS_DUMP_FRAME_STATISTICS, false);
+
 	for (int32 i = 1; i < argc; i++) {
 		team_id team = atoi(argv[i]);
 		if (team <= 0)
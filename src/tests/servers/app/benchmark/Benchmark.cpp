@@ -16,6 +16,7 @@
 
 // tests
 #include "HorizontalLineTest.h"
+#include "LabelTest.h"
 #include "RandomLineTest.h"
 #include "StringTest.h"
 #include "VerticalLineTest.h"
@@ -28,6 +29,7 @@ struct test_info {
 
 const test_info kTestInfos[] = {
 	{ "HorizontalLines",	HorizontalLineTest::CreateTest },
+	{ "Labels",				LabelTest::CreateTest },
 	{ "RandomLines",		RandomLineTest::CreateTest },
 	{ "Strings",			StringTest::CreateTest },
 	{ "VerticalLines",		VerticalLineTest::CreateTest },
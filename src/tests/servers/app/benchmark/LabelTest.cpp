@@ -0,0 +1,130 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#include "LabelTest.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#include <View.h>
+
+
+// The kind of strings controls measure and draw over and over again.
+static const char* kLabels[] = {
+	"OK",
+	"Cancel",
+	"Apply",
+	"Revert",
+	"Defaults",
+	"File",
+	"Edit",
+	"View",
+	"Window",
+	"Help",
+	"Open" B_UTF8_ELLIPSIS,
+	"Save as" B_UTF8_ELLIPSIS,
+	"Close",
+	"Quit",
+	"Name:",
+	"Size:",
+	"Modified:",
+	"Show hidden files",
+	"Use system default",
+	"Font size: 12"
+};
+static const int32 kLabelCount = sizeof(kLabels) / sizeof(kLabels[0]);
+
+
+LabelTest::LabelTest()
+	: Test(),
+	  fWidthDuration(0),
+	  fDrawDuration(0),
+	  fWidthCalls(0),
+	  fDrawCalls(0),
+	  fIterations(0),
+	  fMaxIterations(1500),
+
+	  fLineHeight(15.0)
+{
+}
+
+
+LabelTest::~LabelTest()
+{
+}
+
+
+void
+LabelTest::Prepare(BView* view)
+{
+	font_height fh;
+	view->GetFontHeight(&fh);
+	fLineHeight = ceilf(fh.ascent) + ceilf(fh.descent)
+		+ ceilf(fh.leading);
+	fViewBounds = view->Bounds();
+
+	fWidthDuration = 0;
+	fDrawDuration = 0;
+	fWidthCalls = 0;
+	fDrawCalls = 0;
+	fIterations = 0;
+}
+
+
+bool
+LabelTest::RunIteration(BView* view)
+{
+	// measure all labels, like a layout pass does
+	bigtime_t now = system_time();
+	float widths[kLabelCount];
+	for (int32 i = 0; i < kLabelCount; i++)
+		widths[i] = view->StringWidth(kLabels[i]);
+
+	fWidthDuration += system_time() - now;
+	fWidthCalls += kLabelCount;
+
+	// draw them centered in rows, like buttons do
+	now = system_time();
+	float y = fLineHeight;
+	while (y < fViewBounds.bottom) {
+		for (int32 i = 0; i < kLabelCount && y < fViewBounds.bottom; i++) {
+			BPoint location((fViewBounds.Width() - widths[i]) / 2, y);
+			view->DrawString(kLabels[i], location);
+			fDrawCalls++;
+			y += fLineHeight;
+		}
+	}
+	view->Sync();
+
+	fDrawDuration += system_time() - now;
+	fIterations++;
+
+	return fIterations < fMaxIterations;
+}
+
+
+void
+LabelTest::PrintResults(BView* view)
+{
+	if (fWidthDuration == 0 || fDrawDuration == 0) {
+		printf("Test was not run.\n");
+		return;
+	}
+
+	Test::PrintResults(view);
+
+	printf("Labels: %" B_PRId32 "\n", kLabelCount);
+	printf("StringWidth() calls per second: %.3f\n",
+		fWidthCalls * 1000000.0 / fWidthDuration);
+	printf("DrawString() calls per second: %.3f\n",
+		fDrawCalls * 1000000.0 / fDrawDuration);
+}
+
+
+Test*
+LabelTest::CreateTest()
+{
+	return new LabelTest();
+}
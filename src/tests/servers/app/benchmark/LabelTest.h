@@ -0,0 +1,35 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef LABEL_TEST_H
+#define LABEL_TEST_H
+
+#include <Rect.h>
+
+#include "Test.h"
+
+class LabelTest : public Test {
+public:
+								LabelTest();
+	virtual						~LabelTest();
+
+	virtual	void				Prepare(BView* view);
+	virtual	bool				RunIteration(BView* view);
+	virtual	void				PrintResults(BView* view);
+
+	static	Test*				CreateTest();
+
+private:
+	bigtime_t					fWidthDuration;
+	bigtime_t					fDrawDuration;
+	uint64						fWidthCalls;
+	uint64						fDrawCalls;
+	uint32						fIterations;
+	uint32						fMaxIterations;
+
+	float						fLineHeight;
+	BRect						fViewBounds;
+};
+
+#endif // LABEL_TEST_H
@@ -0,0 +1,184 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ *
+ * Renders shapes and gradients through the app_server PixelFormat into a
+ * MallocBuffer, once with each set of span blenders the CPU supports. The
+ * time needed is printed, and the results are compared with those of the
+ * portable blenders, which they must match exactly.
+ *
+ * This is built for the host, too, so that it can be run on other systems.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <agg_ellipse.h>
+#include <agg_rasterizer_scanline_aa.h>
+#include <agg_renderer_base.h>
+#include <agg_renderer_scanline.h>
+#include <agg_scanline_u.h>
+#include <agg_span_allocator.h>
+#include <agg_span_gradient.h>
+#include <agg_span_interpolator_linear.h>
+
+#include "MallocBuffer.h"
+#include "PatternHandler.h"
+#include "PixelFormat.h"
+#include "SpanBlend.h"
+
+
+typedef agg::renderer_base<PixelFormat> renderer_base;
+typedef agg::rasterizer_scanline_aa<> rasterizer;
+typedef agg::span_interpolator_linear<> interpolator;
+typedef agg::pod_auto_array<agg::rgba8, 256> color_array;
+typedef agg::span_gradient<agg::rgba8, interpolator, agg::gradient_x,
+	color_array> gradient_generator;
+
+
+static const uint32 kWidth = 1024;
+static const uint32 kHeight = 768;
+static const int32 kIterations = 20;
+
+
+struct test_case {
+	const char*		name;
+	drawing_mode	mode;
+	uint8			alpha;
+	bool			gradient;
+};
+
+static const test_case kTestCases[] = {
+	{ "B_OP_COPY",					B_OP_COPY,	255, false },
+	{ "B_OP_OVER",					B_OP_OVER,	255, false },
+	{ "B_OP_ALPHA",					B_OP_ALPHA,	128, false },
+	{ "B_OP_COPY gradient",			B_OP_COPY,	255, true },
+	{ "B_OP_OVER gradient",			B_OP_OVER,	255, true },
+	{ "B_OP_ALPHA gradient",		B_OP_ALPHA,	128, true },
+};
+
+
+static bigtime_t
+current_time()
+{
+	timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return (bigtime_t)time.tv_sec * 1000000 + time.tv_nsec / 1000;
+}
+
+
+static void
+render(MallocBuffer& buffer, const test_case& test)
+{
+	agg::rendering_buffer renderingBuffer((uint8*)buffer.Bits(),
+		buffer.Width(), buffer.Height(), buffer.BytesPerRow());
+
+	PatternHandler pattern;
+	pattern.SetHighColor((rgb_color){ 30, 90, 200, test.alpha });
+	pattern.SetLowColor((rgb_color){ 255, 255, 255, 255 });
+
+	PixelFormat pixelFormat(renderingBuffer, &pattern);
+	pixelFormat.SetDrawingMode(test.mode, B_PIXEL_ALPHA, B_ALPHA_OVERLAY,
+		false);
+
+	renderer_base base(pixelFormat);
+
+	// start with an opaque white background
+	memset(buffer.Bits(), 255, buffer.BytesPerRow() * buffer.Height());
+
+	rasterizer rasterizer;
+	agg::scanline_u8 scanline;
+
+	agg::span_allocator<agg::rgba8> allocator;
+	agg::trans_affine matrix;
+	interpolator gradientInterpolator(matrix);
+	color_array colors;
+	for (int32 i = 0; i < 256; i++) {
+		colors[i] = agg::rgba8(i, 255 - i, 128,
+			i < 64 ? 0 : test.alpha);
+	}
+	gradient_generator generator(gradientInterpolator, agg::gradient_x(),
+		colors, 0, kWidth);
+
+	// overlapping, anti-aliased circles of all sizes cover both the
+	// opaque insides and the partially covered edges
+	srand(42);
+	for (int32 i = 0; i < 200; i++) {
+		double x = rand() % kWidth;
+		double y = rand() % kHeight;
+		double radius = 5 + rand() % 200;
+		agg::ellipse ellipse(x, y, radius, radius * 0.7, 64);
+
+		rasterizer.reset();
+		rasterizer.add_path(ellipse);
+
+		if (test.gradient) {
+			agg::render_scanlines_aa(rasterizer, scanline, base, allocator,
+				generator);
+		} else {
+			agg::render_scanlines_aa_solid(rasterizer, scanline, base,
+				agg::rgba8(30, 90, 200, test.alpha));
+		}
+	}
+}
+
+
+static bool
+run_benchmark(const span_blenders& blenders)
+{
+	MallocBuffer buffer(kWidth, kHeight);
+	MallocBuffer expected(kWidth, kHeight);
+	if (buffer.InitCheck() != B_OK || expected.InitCheck() != B_OK) {
+		fprintf(stderr, "Could not allocate the buffers!\n");
+		return false;
+	}
+
+	bool identical = true;
+
+	for (size_t i = 0; i < sizeof(kTestCases) / sizeof(kTestCases[0]); i++) {
+		const test_case& test = kTestCases[i];
+
+		gSpanBlenders = blenders;
+
+		bigtime_t start = current_time();
+		for (int32 iteration = 0; iteration < kIterations; iteration++)
+			render(buffer, test);
+		bigtime_t time = (current_time() - start) / kIterations;
+
+		// compare with the result of the portable blenders
+		gSpanBlenders = kPortableSpanBlenders;
+		render(expected, test);
+
+		bool same = memcmp(buffer.Bits(), expected.Bits(),
+			buffer.BytesPerRow() * buffer.Height()) == 0;
+		if (!same)
+			identical = false;
+
+		printf("%-10s %-22s %8" B_PRId64 " usecs%s\n", blenders.name,
+			test.name, time, same ? "" : "  DIFFERENT RESULT");
+	}
+
+	return identical;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	bool identical = run_benchmark(kPortableSpanBlenders);
+
+#ifdef SPAN_BLEND_X86_SIMD
+	if (__builtin_cpu_supports("sse2"))
+		identical &= run_benchmark(kSSE2SpanBlenders);
+	if (__builtin_cpu_supports("avx2"))
+		identical &= run_benchmark(kAVX2SpanBlenders);
+#endif
+#ifdef SPAN_BLEND_NEON
+	identical &= run_benchmark(kNEONSpanBlenders);
+#endif
+
+	return identical ? 0 : 1;
+}
@@ -0,0 +1,277 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ *
+ * Measures how many large primitives per second the Painter renders into a
+ * 4K MallocBuffer, with one thread, and with the ParallelRenderer using an
+ * increasing number of threads. The results of the parallel renderer are
+ * also compared with the single threaded ones.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <GradientLinear.h>
+#include <InterfaceDefs.h>
+#include <OS.h>
+#include <Region.h>
+
+#include "FontManager.h"
+#include "MallocBuffer.h"
+#include "Painter.h"
+#include "ParallelRenderer.h"
+#include "ServerBitmap.h"
+
+
+static const uint32 kWidth = 3840;
+static const uint32 kHeight = 2160;
+static const bigtime_t kTestDuration = 1000000;
+
+
+class Primitive : public ParallelRenderer::Job {
+public:
+	Primitive(const char* name)
+		:
+		fName(name)
+	{
+	}
+
+	const char* Name() const
+	{
+		return fName;
+	}
+
+	virtual void SetUp(Painter& painter)
+	{
+		painter.SetDrawingMode(B_OP_COPY);
+		painter.SetBlendingMode(B_PIXEL_ALPHA, B_ALPHA_OVERLAY);
+		painter.SetPattern(B_SOLID_HIGH);
+		painter.SetHighColor((rgb_color){ 40, 90, 160, 255 });
+		painter.SetLowColor((rgb_color){ 255, 255, 255, 255 });
+	}
+
+	BRect Area() const
+	{
+		return BRect(0, 0, kWidth - 1, kHeight - 1);
+	}
+
+private:
+	const char* fName;
+};
+
+
+class FillRectPrimitive : public Primitive {
+public:
+	FillRectPrimitive()
+		:
+		Primitive("FillRect, B_OP_COPY")
+	{
+	}
+
+	virtual void Render(Painter* painter)
+	{
+		painter->FillRect(Area());
+	}
+};
+
+
+class BlendRectPrimitive : public Primitive {
+public:
+	BlendRectPrimitive()
+		:
+		Primitive("FillRect, B_OP_ALPHA")
+	{
+	}
+
+	virtual void SetUp(Painter& painter)
+	{
+		Primitive::SetUp(painter);
+		painter.SetDrawingMode(B_OP_ALPHA);
+		painter.SetHighColor((rgb_color){ 200, 20, 60, 128 });
+	}
+
+	virtual void Render(Painter* painter)
+	{
+		painter->FillRect(Area());
+	}
+};
+
+
+class GradientPrimitive : public Primitive {
+public:
+	GradientPrimitive()
+		:
+		Primitive("FillRect, diagonal gradient"),
+		fGradient(0, 0, kWidth, kHeight)
+	{
+		fGradient.AddColor((rgb_color){ 255, 0, 0, 255 }, 0);
+		fGradient.AddColor((rgb_color){ 0, 255, 0, 255 }, 128);
+		fGradient.AddColor((rgb_color){ 0, 0, 255, 255 }, 255);
+	}
+
+	virtual void Render(Painter* painter)
+	{
+		painter->FillRect(Area(), fGradient);
+	}
+
+private:
+	BGradientLinear fGradient;
+};
+
+
+class BitmapPrimitive : public Primitive {
+public:
+	BitmapPrimitive()
+		:
+		Primitive("DrawBitmap, scaled bilinear"),
+		fBitmap(new UtilityBitmap(BRect(0, 0, 1023, 767), B_RGBA32, 0))
+	{
+		uint32* bits = (uint32*)fBitmap->Bits();
+		for (int32 i = 0; i < fBitmap->Width() * fBitmap->Height(); i++)
+			bits[i] = 0xff000000 | (i * 2654435761UL >> 8);
+	}
+
+	~BitmapPrimitive()
+	{
+		fBitmap->ReleaseReference();
+	}
+
+	virtual void Render(Painter* painter)
+	{
+		painter->DrawBitmap(fBitmap, fBitmap->Bounds(), Area(),
+			B_FILTER_BITMAP_BILINEAR);
+	}
+
+private:
+	UtilityBitmap* fBitmap;
+};
+
+
+static void
+draw(Painter& painter, ParallelRenderer* renderer, Primitive& primitive)
+{
+	if (renderer == NULL
+		|| !renderer->Render(painter, primitive.Area(), primitive))
+		primitive.Render(&painter);
+}
+
+
+static double
+run_test(Painter& painter, ParallelRenderer* renderer, Primitive& primitive)
+{
+	primitive.SetUp(painter);
+
+	int32 count = 0;
+	bigtime_t start = system_time();
+	bigtime_t elapsed;
+	do {
+		draw(painter, renderer, primitive);
+		count++;
+		elapsed = system_time() - start;
+	} while (elapsed < kTestDuration);
+
+	return count * 1000000.0 / elapsed;
+}
+
+
+static bool
+compare(Painter& painter, MallocBuffer& buffer, ParallelRenderer* renderer,
+	Primitive& primitive, void* expected)
+{
+	size_t size = buffer.BytesPerRow() * buffer.Height();
+
+	memset(buffer.Bits(), 0, size);
+	primitive.SetUp(painter);
+	draw(painter, renderer, primitive);
+
+	return memcmp(buffer.Bits(), expected, size) == 0;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	gFontManager = new FontManager;
+	if (gFontManager->InitCheck() != B_OK) {
+		fprintf(stderr, "Could not initialize the font manager!\n");
+		return 1;
+	}
+
+	system_info info;
+	get_system_info(&info);
+	int32 maxThreads = info.cpu_count;
+	if (argc > 1)
+		maxThreads = atoi(argv[1]);
+
+	MallocBuffer buffer(kWidth, kHeight);
+	if (buffer.InitCheck() != B_OK) {
+		fprintf(stderr, "Could not allocate the buffer!\n");
+		return 1;
+	}
+	size_t size = buffer.BytesPerRow() * buffer.Height();
+	void* expected = malloc(size);
+	if (expected == NULL) {
+		fprintf(stderr, "Could not allocate the buffer!\n");
+		return 1;
+	}
+
+	BRegion clipping(BRect(0, 0, kWidth - 1, kHeight - 1));
+	Painter painter;
+	painter.AttachToBuffer(&buffer);
+	painter.ConstrainClipping(&clipping);
+
+	FillRectPrimitive fillRect;
+	BlendRectPrimitive blendRect;
+	GradientPrimitive gradient;
+	BitmapPrimitive bitmap;
+	Primitive* primitives[] = { &fillRect, &blendRect, &gradient, &bitmap };
+	const int32 primitiveCount = sizeof(primitives) / sizeof(primitives[0]);
+
+	double singleThreaded[primitiveCount];
+	bool identical = true;
+
+	printf("%-30s %8s %12s %8s\n", "primitive", "threads", "per second",
+		"speedup");
+
+	for (int32 threads = 1; threads <= maxThreads; threads++) {
+		ParallelRenderer* renderer = NULL;
+		if (threads > 1) {
+			renderer = new ParallelRenderer(threads - 1);
+			if (renderer->InitCheck() != B_OK) {
+				fprintf(stderr, "Could not start %" B_PRId32 " threads!\n",
+					threads);
+				delete renderer;
+				break;
+			}
+		}
+
+		for (int32 i = 0; i < primitiveCount; i++) {
+			Primitive& primitive = *primitives[i];
+			double perSecond = run_test(painter, renderer, primitive);
+
+			const char* result = "";
+			if (threads == 1) {
+				singleThreaded[i] = perSecond;
+
+				memset(buffer.Bits(), 0, size);
+				primitive.SetUp(painter);
+				primitive.Render(&painter);
+				memcpy(expected, buffer.Bits(), size);
+			} else if (!compare(painter, buffer, renderer, primitive,
+					expected)) {
+				result = "  DIFFERENT RESULT";
+				identical = false;
+			}
+
+			printf("%-30s %8" B_PRId32 " %12.1f %7.2fx%s\n", primitive.Name(),
+				threads, perSecond, perSecond / singleThreaded[i], result);
+		}
+
+		delete renderer;
+	}
+
+	free(expected);
+	return identical ? 0 : 1;
+}
@@ -0,0 +1,337 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ *
+ * Replays drawing commands, as recorded with "RemoteDesktop -r", through the
+ * NetSender and NetReceiver of the remote app_server over a local
+ * connection, and reports how many bytes it took to send each frame. A
+ * frame ends with an invalidate message, as sent after each update.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <File.h>
+#include <NetAddress.h>
+#include <NetEndpoint.h>
+
+#include "NetReceiver.h"
+#include "NetSender.h"
+#include "RemoteMessage.h"
+#include "StreamingRingBuffer.h"
+
+
+static const size_t kBufferSize = 1024 * 1024;
+static const size_t kHeaderSize = sizeof(uint16) + sizeof(uint32);
+
+
+struct frame {
+	size_t		offset;
+	size_t		size;
+	bigtime_t	start;
+};
+
+struct replay {
+	uint8*		stream;
+	size_t		size;
+	frame*		frames;
+	int32		frameCount;
+	int32		messageCount;
+
+	StreamingRingBuffer* target;
+	sem_id		frameDone;
+};
+
+
+static void
+print_usage(const char* app)
+{
+	printf("usage:\t%s [-u] [-v] <recording>\n\n", app);
+	printf("\t-u\t\tdo not compress the stream\n");
+	printf("\t-v\t\tprint the numbers of every frame\n");
+}
+
+
+/*!	Splits the recording into frames, dropping the compression markers of
+	the recorded session, as the sender adds its own.
+*/
+static status_t
+split_frames(replay& data)
+{
+	RemoteMessageScanner scanner;
+	size_t position = 0;
+	size_t messageStart = 0;
+	size_t size = 0;
+	int32 frameCapacity = 0;
+
+	data.frames = NULL;
+	data.frameCount = 0;
+	data.messageCount = 0;
+
+	while (position < data.size) {
+		position += scanner.Scan(data.stream + position,
+			data.size - position);
+		if (!scanner.AtBoundary())
+			break;
+
+		size_t messageSize = position - messageStart;
+		uint16 code = scanner.LastCode();
+		if (code != RP_ENABLE_COMPRESSION) {
+			memmove(data.stream + size, data.stream + messageStart,
+				messageSize);
+			size += messageSize;
+			data.messageCount++;
+		}
+		messageStart = position;
+
+		bool frameEnd = code == RP_INVALIDATE_RECT
+			|| code == RP_INVALIDATE_REGION || position == data.size;
+		size_t frameStart = data.frameCount == 0 ? 0
+			: data.frames[data.frameCount - 1].offset
+				+ data.frames[data.frameCount - 1].size;
+		if (!frameEnd || size == frameStart)
+			continue;
+
+		if (data.frameCount == frameCapacity) {
+			frameCapacity = max_c(64, frameCapacity * 2);
+			frame* frames = (frame*)realloc(data.frames,
+				frameCapacity * sizeof(frame));
+			if (frames == NULL)
+				return B_NO_MEMORY;
+
+			data.frames = frames;
+		}
+
+		data.frames[data.frameCount].offset = frameStart;
+		data.frames[data.frameCount].size = size - frameStart;
+		data.frameCount++;
+	}
+
+	if (position != data.size) {
+		fprintf(stderr, "Ignoring %" B_PRIuSIZE " bytes of an incomplete "
+			"message at the end.\n", data.size - messageStart);
+	}
+
+	data.size = size;
+	return B_OK;
+}
+
+
+static status_t
+feed_frames(void* _data)
+{
+	replay& data = *(replay*)_data;
+
+	for (int32 i = 0; i < data.frameCount; i++) {
+		frame& current = data.frames[i];
+		current.start = system_time();
+
+		status_t result = data.target->Write(data.stream + current.offset,
+			current.size);
+		if (result != B_OK)
+			return result;
+
+		// Only send the next frame once this one arrived, so that the bytes
+		// sent can be attributed to it.
+		while (acquire_sem(data.frameDone) == B_INTERRUPTED)
+			;
+	}
+
+	return B_OK;
+}
+
+
+static status_t
+receive_frame(StreamingRingBuffer& source, const uint8* expected, size_t size)
+{
+	uint8 buffer[4096];
+
+	while (size > 0) {
+		int32 readSize = source.Read(buffer, kHeaderSize);
+		if (readSize < 0)
+			return readSize;
+
+		uint16 code;
+		uint32 length;
+		memcpy(&code, buffer, sizeof(uint16));
+		memcpy(&length, buffer + sizeof(uint16), sizeof(uint32));
+		if (code == RP_ENABLE_COMPRESSION)
+			continue;
+
+		if (length < kHeaderSize || length > size
+			|| memcmp(buffer, expected, kHeaderSize) != 0) {
+			return B_BAD_DATA;
+		}
+
+		expected += kHeaderSize;
+		size -= kHeaderSize;
+		length -= kHeaderSize;
+
+		while (length > 0) {
+			readSize = source.Read(buffer, min_c(length, sizeof(buffer)));
+			if (readSize < 0)
+				return readSize;
+
+			if (memcmp(buffer, expected, readSize) != 0)
+				return B_BAD_DATA;
+
+			expected += readSize;
+			size -= readSize;
+			length -= readSize;
+		}
+	}
+
+	return B_OK;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	bool compress = true;
+	bool verbose = false;
+	const char* path = NULL;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-u") == 0)
+			compress = false;
+		else if (strcmp(argv[i], "-v") == 0)
+			verbose = true;
+		else if (path == NULL && argv[i][0] != '-')
+			path = argv[i];
+		else {
+			print_usage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (path == NULL) {
+		print_usage(argv[0]);
+		return 1;
+	}
+
+	if (compress && !NetSender::SupportsCompression()) {
+		fprintf(stderr, "Compression is not supported.\n");
+		return 1;
+	}
+
+	replay data;
+
+	BFile file;
+	off_t fileSize;
+	status_t result = file.SetTo(path, B_READ_ONLY);
+	if (result == B_OK)
+		result = file.GetSize(&fileSize);
+	if (result == B_OK) {
+		data.size = fileSize;
+		data.stream = (uint8*)malloc(data.size);
+		if (data.stream == NULL)
+			result = B_NO_MEMORY;
+	}
+	if (result == B_OK)
+		result = file.ReadExactly(data.stream, data.size);
+	if (result == B_OK)
+		result = split_frames(data);
+	if (result != B_OK) {
+		fprintf(stderr, "Could not read %s: %s\n", path, strerror(result));
+		return 1;
+	}
+
+	// set up a connection to ourselves
+	BNetEndpoint listener;
+	unsigned short port;
+	result = listener.Bind();
+	if (result == B_OK)
+		result = listener.Listen();
+	if (result == B_OK)
+		result = listener.LocalAddr().GetAddr(NULL, &port);
+
+	BNetEndpoint* client = new BNetEndpoint();
+	if (result == B_OK)
+		result = client->Connect("localhost", port);
+
+	BNetEndpoint* server = result == B_OK ? listener.Accept(5000) : NULL;
+	if (server == NULL) {
+		fprintf(stderr, "Could not connect: %s\n", strerror(result));
+		return 1;
+	}
+
+	// The sender and receiver threads end with the team, there is no
+	// point in cleaning up after them.
+	StreamingRingBuffer* sendBuffer = new StreamingRingBuffer(kBufferSize);
+	StreamingRingBuffer* receiveBuffer = new StreamingRingBuffer(kBufferSize);
+	if (sendBuffer->InitCheck() != B_OK || receiveBuffer->InitCheck() != B_OK) {
+		fprintf(stderr, "Could not create the buffers.\n");
+		return 1;
+	}
+
+	NetSender* sender = new NetSender(server, sendBuffer);
+	if (compress)
+		sender->EnableCompression();
+	new NetReceiver(client, receiveBuffer);
+
+	data.target = sendBuffer;
+	data.frameDone = create_sem(0, "frame done");
+	thread_id feeder = spawn_thread(&feed_frames, "feeder", B_NORMAL_PRIORITY,
+		&data);
+	if (data.frameDone < 0 || feeder < 0) {
+		fprintf(stderr, "Could not start feeding the frames.\n");
+		return 1;
+	}
+
+	resume_thread(feeder);
+
+	uint64 lastSent = 0;
+	uint64 largestFrame = 0;
+	bigtime_t totalLatency = 0;
+	bigtime_t maxLatency = 0;
+
+	for (int32 i = 0; i < data.frameCount; i++) {
+		const frame& current = data.frames[i];
+		result = receive_frame(*receiveBuffer, data.stream + current.offset,
+			current.size);
+		if (result != B_OK) {
+			fprintf(stderr, "Frame %" B_PRId32 " did not arrive intact: %s\n",
+				i, strerror(result));
+			return 1;
+		}
+
+		bigtime_t latency = system_time() - current.start;
+		uint64 sent = sender->BytesSent();
+		uint64 frameSent = sent - lastSent;
+		lastSent = sent;
+
+		largestFrame = max_c(largestFrame, frameSent);
+		totalLatency += latency;
+		maxLatency = max_c(maxLatency, latency);
+
+		if (verbose) {
+			printf("frame %6" B_PRId32 ": %10" B_PRIuSIZE " bytes, sent %10"
+				B_PRIu64 " in %6.2f ms\n", i, current.size, frameSent,
+				latency / 1000.0);
+		}
+
+		release_sem(data.frameDone);
+	}
+
+	if (data.frameCount == 0) {
+		fprintf(stderr, "The recording does not contain any messages.\n");
+		return 1;
+	}
+
+	printf("%" B_PRId32 " frames, %" B_PRId32 " messages, %s\n",
+		data.frameCount, data.messageCount,
+		compress ? "compressed" : "uncompressed");
+	printf("recorded: %12.1f bytes per frame, %12" B_PRIuSIZE " in total\n",
+		(double)data.size / data.frameCount, data.size);
+	printf("sent:     %12.1f bytes per frame, %12" B_PRIu64 " in total, "
+		"%" B_PRIu64 " at most\n", (double)lastSent / data.frameCount,
+		lastSent, largestFrame);
+	printf("ratio:    %12.2f\n", (double)data.size / lastSent);
+	printf("latency:  %12.2f ms per frame, %.2f ms at most\n",
+		totalLatency / 1000.0 / data.frameCount, maxLatency / 1000.0);
+
+	return 0;
+}
@@ -0,0 +1,218 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ *
+ * Measures how many glyphs per second the AGGTextRenderer draws when an
+ * increasing number of threads render text at the same time, each into its
+ * own buffer with its own Painter, like the ServerWindow threads do. All
+ * threads share the font cache, which is what this is meant to stress.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <InterfaceDefs.h>
+#include <OS.h>
+#include <Region.h>
+
+#include "FontManager.h"
+#include "MallocBuffer.h"
+#include "Painter.h"
+#include "ServerFont.h"
+
+
+static const uint32 kWidth = 800;
+static const uint32 kHeight = 600;
+static const bigtime_t kTestDuration = 1000000;
+static const int32 kMaxThreads = 64;
+
+
+struct text_test {
+	const char*	name;
+	const char*	text;
+	float		minSize;
+	float		maxSize;
+};
+
+static const text_test kTests[] = {
+	{ "ASCII, 12 pt", "The quick brown fox jumps over the lazy dog. 0123456789",
+		12, 12 },
+	{ "ASCII, 9 - 14 pt",
+		"The quick brown fox jumps over the lazy dog. 0123456789", 9, 14 },
+	{ "Latin-1 and Greek, 12 pt",
+		"Fünf Äpfel für Jürgen, ça coûte 3 € · Ξεσκεπάζω την ψυχοφθόρα",
+		12, 12 },
+	{ "ASCII, 48 pt (outlines)", "The quick brown fox jumps", 48, 48 }
+};
+static const int32 kTestCount = sizeof(kTests) / sizeof(kTests[0]);
+
+
+struct render_thread {
+	const text_test*	test;
+	const ServerFont*	font;
+	sem_id				start;
+	bigtime_t			elapsed;
+	uint64				glyphs;
+};
+
+
+static int32
+count_glyphs(const char* text)
+{
+	int32 count = 0;
+	for (; *text != '\0'; text++) {
+		if ((*text & 0xc0) != 0x80)
+			count++;
+	}
+	return count;
+}
+
+
+/*!	Draws the text of the test into a fresh buffer until the test duration
+	is over. When there are several sizes, each line uses the next one.
+*/
+static status_t
+render_text(void* _data)
+{
+	render_thread& data = *(render_thread*)_data;
+	const text_test& test = *data.test;
+
+	MallocBuffer buffer(kWidth, kHeight);
+	if (buffer.InitCheck() != B_OK)
+		return B_NO_MEMORY;
+
+	BRegion clipping(BRect(0, 0, kWidth - 1, kHeight - 1));
+	Painter painter;
+	painter.AttachToBuffer(&buffer);
+	painter.ConstrainClipping(&clipping);
+	painter.SetDrawingMode(B_OP_OVER);
+	painter.SetHighColor((rgb_color){ 0, 0, 0, 255 });
+
+	ServerFont font(*data.font);
+	uint32 length = strlen(test.text);
+	int32 glyphCount = count_glyphs(test.text);
+	float size = test.minSize;
+	float y = 0;
+
+	while (acquire_sem(data.start) == B_INTERRUPTED)
+		;
+
+	data.glyphs = 0;
+	bigtime_t start = system_time();
+	do {
+		font.SetSize(size);
+		painter.SetFont(font);
+
+		y += size * 1.2f;
+		if (y >= kHeight)
+			y = size;
+
+		painter.DrawString(test.text, length, BPoint(10, y), NULL);
+		data.glyphs += glyphCount;
+
+		size += 1;
+		if (size > test.maxSize)
+			size = test.minSize;
+
+		data.elapsed = system_time() - start;
+	} while (data.elapsed < kTestDuration);
+
+	return B_OK;
+}
+
+
+static double
+run_test(const text_test& test, const ServerFont& font, int32 threadCount)
+{
+	render_thread data[kMaxThreads];
+	thread_id threads[kMaxThreads];
+
+	sem_id start = create_sem(0, "start rendering");
+	if (start < 0)
+		return -1;
+
+	for (int32 i = 0; i < threadCount; i++) {
+		data[i].test = &test;
+		data[i].font = &font;
+		data[i].start = start;
+		threads[i] = spawn_thread(&render_text, "render text",
+			B_NORMAL_PRIORITY, &data[i]);
+		if (threads[i] >= 0)
+			resume_thread(threads[i]);
+	}
+
+	// let all threads set up their buffers before starting them at once
+	snooze(100000);
+	release_sem_etc(start, threadCount, 0);
+
+	double perSecond = 0;
+	for (int32 i = 0; i < threadCount; i++) {
+		status_t result;
+		if (threads[i] < 0 || wait_for_thread(threads[i], &result) != B_OK
+			|| result != B_OK) {
+			perSecond = -1;
+			continue;
+		}
+
+		if (perSecond >= 0)
+			perSecond += data[i].glyphs * 1000000.0 / data[i].elapsed;
+	}
+
+	delete_sem(start);
+	return perSecond;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	gFontManager = new FontManager;
+	if (gFontManager->InitCheck() != B_OK) {
+		fprintf(stderr, "Could not initialize the font manager!\n");
+		return 1;
+	}
+
+	system_info info;
+	get_system_info(&info);
+	int32 maxThreads = info.cpu_count;
+	if (argc > 1)
+		maxThreads = atoi(argv[1]);
+	maxThreads = min_c(maxThreads, kMaxThreads);
+
+	if (!gFontManager->Lock()) {
+		fprintf(stderr, "Could not lock the font manager!\n");
+		return 1;
+	}
+	ServerFont font(*gFontManager->DefaultPlainFont());
+	gFontManager->Unlock();
+
+	printf("%-30s %8s %14s %8s\n", "text", "threads", "glyphs/second",
+		"speedup");
+
+	for (int32 i = 0; i < kTestCount; i++) {
+		const text_test& test = kTests[i];
+
+		// The first run creates the glyphs, only the following ones are
+		// measured, so that the cache lookups dominate.
+		run_test(test, font, 1);
+
+		double singleThreaded = 0;
+		for (int32 threads = 1; threads <= maxThreads; threads++) {
+			double perSecond = run_test(test, font, threads);
+			if (perSecond < 0) {
+				fprintf(stderr, "Could not render with %" B_PRId32
+					" threads!\n", threads);
+				return 1;
+			}
+			if (threads == 1)
+				singleThreaded = perSecond;
+
+			printf("%-30s %8" B_PRId32 " %14.1f %7.2fx\n", test.name, threads,
+				perSecond, perSecond / singleThreaded);
+		}
+	}
+
+	return 0;
+}
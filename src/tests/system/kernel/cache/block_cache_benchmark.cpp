@@ -0,0 +1,173 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Measures how well block_cache_get() and block_cache_put() scale with the
+	number of threads reading the same blocks, as happens with parallel stat()
+	calls or directory traversals on a single volume.
+
+	The benchmark runs an increasing number of threads (up to one per CPU)
+	that look up a small set of hot blocks over and over. In the "pinned" runs,
+	every block is additionally kept referenced by the main thread, as is the
+	case for blocks that are in use by several readers at a time.
+*/
+
+
+#define read_pos	block_cache_read_pos
+
+#include "block_cache.cpp"
+
+#undef read_pos
+
+
+static const int32 kDefaultBlockCount = 64;
+static const int32 kDefaultIterations = 500000;
+static const size_t kBlockSize = 2048;
+static const int32 kMaxThreads = 64;
+
+struct benchmark_thread {
+	block_cache*	cache;
+	int32			block_count;
+	int32			iterations;
+	int32			seed;
+	sem_id			start;
+	bigtime_t		time;
+};
+
+
+ssize_t
+block_cache_read_pos(int fd, off_t offset, void* buffer, size_t size)
+{
+	memset(buffer, 0, size);
+	*(off_t*)buffer = offset / kBlockSize;
+	return size;
+}
+
+
+static status_t
+benchmark_thread_entry(void* _thread)
+{
+	benchmark_thread* thread = (benchmark_thread*)_thread;
+	uint32 random = thread->seed;
+
+	acquire_sem(thread->start);
+	bigtime_t startTime = system_time();
+
+	for (int32 i = 0; i < thread->iterations; i++) {
+		random = random * 1103515245 + 12345;
+		off_t blockNumber = (random >> 16) % thread->block_count;
+
+		const off_t* data = (const off_t*)block_cache_get(thread->cache,
+			blockNumber);
+		if (data == NULL || *data != blockNumber) {
+			fprintf(stderr, "block %" B_PRIdOFF " has wrong contents!\n",
+				blockNumber);
+			exit(1);
+		}
+
+		block_cache_put(thread->cache, blockNumber);
+	}
+
+	thread->time = system_time() - startTime;
+	return B_OK;
+}
+
+
+/*!	Runs \a threadCount threads reading from \a cache, and returns the
+	achieved number of lookups per second.
+*/
+static uint64
+run_benchmark(block_cache* cache, int32 threadCount, int32 blockCount,
+	int32 iterations)
+{
+	benchmark_thread threads[kMaxThreads];
+	thread_id threadIDs[kMaxThreads];
+
+	sem_id start = create_sem(0, "block cache benchmark start");
+	if (start < 0)
+		return 0;
+
+	for (int32 i = 0; i < threadCount; i++) {
+		threads[i].cache = cache;
+		threads[i].block_count = blockCount;
+		threads[i].iterations = iterations;
+		threads[i].seed = i + 1;
+		threads[i].start = start;
+		threads[i].time = 0;
+
+		threadIDs[i] = spawn_thread(&benchmark_thread_entry,
+			"block cache benchmark", B_NORMAL_PRIORITY, &threads[i]);
+		resume_thread(threadIDs[i]);
+	}
+
+	release_sem_etc(start, threadCount, 0);
+
+	bigtime_t maxTime = 1;
+	for (int32 i = 0; i < threadCount; i++) {
+		status_t result;
+		wait_for_thread(threadIDs[i], &result);
+		maxTime = max_c(maxTime, threads[i].time);
+	}
+
+	delete_sem(start);
+
+	return (uint64)threadCount * iterations * 1000000 / maxTime;
+}
+
+
+static void
+run(block_cache* cache, int32 blockCount, int32 iterations, bool pinned)
+{
+	if (pinned) {
+		for (int32 i = 0; i < blockCount; i++)
+			block_cache_get(cache, i);
+	}
+
+	system_info info;
+	get_system_info(&info);
+	int32 maxThreads = min_c((int32)info.cpu_count, kMaxThreads);
+
+	printf("%s, %" B_PRId32 " blocks\n", pinned ? "pinned" : "unpinned",
+		blockCount);
+	printf("%-8s %14s %14s\n", "threads", "lookups/sec", "per thread");
+
+	for (int32 threads = 1; threads <= maxThreads; threads++) {
+		uint64 rate = run_benchmark(cache, threads, blockCount, iterations);
+		printf("%-8" B_PRId32 " %14" B_PRIu64 " %14" B_PRIu64 "\n", threads,
+			rate, rate / threads);
+	}
+
+	if (pinned) {
+		for (int32 i = 0; i < blockCount; i++)
+			block_cache_put(cache, i);
+	}
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int32 blockCount = argc > 1 ? atol(argv[1]) : kDefaultBlockCount;
+	int32 iterations = argc > 2 ? atol(argv[2]) : kDefaultIterations;
+	if (blockCount <= 0 || iterations <= 0) {
+		fprintf(stderr, "usage: %s [<blocks> [<iterations>]]\n", argv[0]);
+		return 1;
+	}
+
+	block_cache_init();
+
+	block_cache* cache = (block_cache*)block_cache_create(-1, blockCount,
+		kBlockSize, true);
+	if (cache == NULL) {
+		fprintf(stderr, "could not create block cache\n");
+		return 1;
+	}
+
+	run(cache, blockCount, iterations, false);
+	run(cache, blockCount, iterations, true);
+
+	block_cache_delete(cache, false);
+	return 0;
+}
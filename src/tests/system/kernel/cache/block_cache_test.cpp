@@ -5,11 +5,13 @@
 
 
 #define write_pos	block_cache_write_pos
+#define writev_pos	block_cache_writev_pos
 #define read_pos	block_cache_read_pos
 
 #include "block_cache.cpp"
 
 #undef write_pos
+#undef writev_pos
 #undef read_pos
 
 
@@ -63,6 +65,11 @@ int32 gTest;
 int32 gSubTest;
 const char* gTestName;
 
+int32 gWriteRequests;
+int32 gVectoredRequests;
+int32 gVectoredBlocks[MAX_BLOCKS];
+	// the number of blocks of each vectored write request
+
 
 void
 dump_cache()
@@ -129,6 +136,31 @@ block_cache_write_pos(int fd, off_t offset, const void* buffer, size_t size)
 	if (!gBlocks[index].write)
 		error(__LINE__, "Block %ld should not be written!\n", index);
 
+	gWriteRequests++;
+	return size;
+}
+
+
+ssize_t
+block_cache_writev_pos(int fd, off_t offset, const iovec* vecs, int count)
+{
+	int32 index = offset / gBlockSize;
+	size_t size = 0;
+
+	for (int i = 0; i < count; i++, index++) {
+		if (vecs[i].iov_len != gBlockSize)
+			error(__LINE__, "Block %ld: vector has wrong size!\n", index);
+
+		gBlocks[index].written = true;
+		if (!gBlocks[index].write)
+			error(__LINE__, "Block %ld should not be written!\n", index);
+
+		size += vecs[i].iov_len;
+	}
+
+	if (gVectoredRequests < MAX_BLOCKS)
+		gVectoredBlocks[gVectoredRequests] = count;
+	gVectoredRequests++;
 	return size;
 }
 
@@ -189,7 +221,7 @@ test_blocks(off_t number, int32 count, int32 line)
 	for (int32 i = 0; i < count; i++, number++) {
 		MutexLocker locker(&gCache->lock);
 
-		cached_block* block = (cached_block*)hash_lookup(gCache->hash, &number);
+		cached_block* block = gCache->hash.Lookup(number);
 		if (block == NULL) {
 			if (gBlocks[number].present)
 				error(line, "Block %Ld not found!", number);
@@ -231,6 +263,7 @@ stop_test(void)
 
 //	dump_cache();
 	block_cache_delete(gCache, true);
+	gCache = NULL;
 }
 
 
@@ -247,6 +280,9 @@ start_test(const char* name, bool init = true)
 		init_test_blocks();
 	}
 
+	gWriteRequests = 0;
+	gVectoredRequests = 0;
+
 	gTest++;
 	gTestName = name;
 	gSubTest = 1;
@@ -321,6 +357,31 @@ basic_test_discard_in_sub(int32 id, bool touchedInMain)
 }
 
 
+/*!	Changes the \a count blocks starting at \a first in the transaction
+	\a id. The blocks are expected to be written back when the transaction
+	is synced.
+*/
+void
+change_blocks(int32 id, off_t first, int32 count)
+{
+	for (off_t number = first; number < first + count; number++) {
+		gBlocks[number].present = true;
+		gBlocks[number].is_dirty = true;
+
+		void* block = block_cache_get_empty(gCache, number, id);
+		reset_block(block, number);
+		block_cache_put(gCache, number);
+	}
+
+	TEST_BLOCKS(first, count);
+
+	for (off_t number = first; number < first + count; number++) {
+		gBlocks[number].is_dirty = false;
+		gBlocks[number].write = true;
+	}
+}
+
+
 // #pragma mark - Tests
 
 
@@ -628,6 +689,51 @@ test_block_cache_discard()
 }
 
 
+void
+test_write_back_runs()
+{
+	start_test("Write back contiguous blocks");
+
+	int32 id = cache_start_transaction(gCache);
+	change_blocks(id, 10, 10);
+	cache_end_transaction(gCache, id, NULL, NULL);
+	cache_sync_transaction(gCache, id);
+
+	TEST_ASSERT(gWriteRequests == 0);
+	TEST_ASSERT(gVectoredRequests == 1);
+	TEST_ASSERT(gVectoredBlocks[0] == 10);
+
+	start_test("Write back non-contiguous blocks");
+
+	// the blocks are changed out of order, but written back sorted
+	id = cache_start_transaction(gCache);
+	change_blocks(id, 50, 2);
+	change_blocks(id, 30, 4);
+	change_blocks(id, 40, 1);
+	cache_end_transaction(gCache, id, NULL, NULL);
+	cache_sync_transaction(gCache, id);
+
+	TEST_ASSERT(gWriteRequests == 1);
+	TEST_ASSERT(gVectoredRequests == 2);
+	TEST_ASSERT(gVectoredBlocks[0] == 4);
+	TEST_ASSERT(gVectoredBlocks[1] == 2);
+
+	start_test("Write back a run longer than a single request");
+
+	id = cache_start_transaction(gCache);
+	change_blocks(id, 0, kMaxRunBlocks + 6);
+	cache_end_transaction(gCache, id, NULL, NULL);
+	cache_sync_transaction(gCache, id);
+
+	TEST_ASSERT(gWriteRequests == 0);
+	TEST_ASSERT(gVectoredRequests == 2);
+	TEST_ASSERT(gVectoredBlocks[0] == (int32)kMaxRunBlocks);
+	TEST_ASSERT(gVectoredBlocks[1] == 6);
+
+	stop_test();
+}
+
+
 // #pragma mark -
 
 
@@ -641,5 +747,6 @@ main(int argc, char** argv)
 	test_abort_transaction();
 	test_abort_sub_transaction();
 	test_block_cache_discard();
+	test_write_back_runs();
 	return 0;
 }
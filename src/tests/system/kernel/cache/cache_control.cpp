@@ -11,6 +11,7 @@
 #include <file_cache.h>
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 
@@ -20,7 +21,8 @@ extern const char *__progname;
 void
 usage()
 {
-	fprintf(stderr, "usage: %s [clear | unset | set <module-name>]\n", __progname);
+	fprintf(stderr, "usage: %s [clear | unset | set <module-name> | stats "
+		"| reset-stats | read-ahead <kB>]\n", __progname);
 	exit(0);
 }
 
@@ -50,6 +52,35 @@ main(int argc, char **argv)
 		status = _kern_generic_syscall(CACHE_SYSCALLS, CACHE_SET_MODULE, argv[2], strlen(argv[2]));
 		if (status != B_OK)
 			fprintf(stderr, "%s: setting the module failed: %s\n", __progname, strerror(status));
+	} else if (!strcmp(argv[1], "stats")) {
+		file_cache_read_ahead_stats stats;
+		status = _kern_generic_syscall(CACHE_SYSCALLS, CACHE_GET_READ_AHEAD_STATS, &stats, sizeof(stats));
+		if (status != B_OK) {
+			fprintf(stderr, "%s: getting the read-ahead statistics failed: %s\n", __progname, strerror(status));
+			return 1;
+		}
+
+		printf("maximum window:     %" B_PRIu32 " kB\n", stats.max_window / 1024);
+		printf("sequential streams: %" B_PRId64 "\n", stats.sequential_streams);
+		printf("strided streams:    %" B_PRId64 "\n", stats.strided_streams);
+		printf("random accesses:    %" B_PRId64 "\n", stats.random_accesses);
+		printf("requests issued:    %" B_PRId64 "\n", stats.issued_requests);
+		printf("pages issued:       %" B_PRId64 "\n", stats.issued_pages);
+		printf("pages hit:          %" B_PRId64 "\n", stats.hit_pages);
+		printf("pages wasted:       %" B_PRId64 "\n", stats.wasted_pages);
+		if (stats.issued_pages > 0) {
+			printf("hit rate:           %.1f%%\n",
+				100.0 * stats.hit_pages / stats.issued_pages);
+		}
+	} else if (!strcmp(argv[1], "reset-stats")) {
+		status = _kern_generic_syscall(CACHE_SYSCALLS, CACHE_RESET_READ_AHEAD_STATS, NULL, 0);
+		if (status != B_OK)
+			fprintf(stderr, "%s: resetting the statistics failed: %s\n", __progname, strerror(status));
+	} else if (!strcmp(argv[1], "read-ahead") && argc > 2) {
+		uint32 maxWindow = strtoul(argv[2], NULL, 0) * 1024;
+		status = _kern_generic_syscall(CACHE_SYSCALLS, CACHE_SET_MAX_READ_AHEAD, &maxWindow, sizeof(maxWindow));
+		if (status != B_OK)
+			fprintf(stderr, "%s: setting the read-ahead window failed: %s\n", __progname, strerror(status));
 	} else
 		usage();
 
@@ -0,0 +1,272 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Compares the message throughput of single message port reads and writes
+	with read_port_multiple_etc() and write_port_multiple_etc().
+
+	ping-pong: two threads send bursts of messages back and forth, like an
+		application and the app_server do.
+	fan-in: several threads send messages to a single port, which is drained
+		by one reader, like the registrar or a busy BLooper.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <OS.h>
+
+
+static const int32 kBurstSize = 32;
+static const int32 kBursts = 20000;
+static const int32 kWriters = 4;
+static const size_t kMessageSize = 64;
+static const size_t kBufferSize
+	= kBurstSize * (sizeof(port_message_header) + kMessageSize);
+
+struct benchmark {
+	port_id		ports[2];
+	bool		multiple;
+	int32		messages;
+	status_t	status;
+};
+
+
+static size_t
+pack_burst(uint8* buffer, int32 count, int32 code)
+{
+	port_message_header* header = (port_message_header*)buffer;
+	for (int32 i = 0; i < count; i++) {
+		header->code = code + i;
+		header->size = kMessageSize;
+		memset(header + 1, 0x55, kMessageSize);
+		header = PORT_MESSAGE_NEXT(header);
+	}
+
+	return (uint8*)header - buffer;
+}
+
+
+/*!	Sends \a count messages, either one by one, or all at once. */
+static status_t
+send_burst(port_id port, bool multiple, int32 count, int32 code)
+{
+	uint8 buffer[kBufferSize];
+
+	if (multiple) {
+		size_t size = pack_burst(buffer, count, code);
+		ssize_t written = write_port_multiple_etc(port, buffer, size, 0, 0);
+		if (written < 0)
+			return written;
+		return written == count ? B_OK : B_ERROR;
+	}
+
+	memset(buffer, 0x55, kMessageSize);
+	for (int32 i = 0; i < count; i++) {
+		status_t status = write_port(port, code + i, buffer, kMessageSize);
+		if (status != B_OK)
+			return status;
+	}
+
+	return B_OK;
+}
+
+
+/*!	Receives \a count messages, and makes sure they arrive in order. */
+static status_t
+receive_burst(port_id port, bool multiple, int32 count, int32& code)
+{
+	uint8 buffer[kBufferSize];
+
+	for (int32 received = 0; received < count;) {
+		if (!multiple) {
+			int32 messageCode;
+			ssize_t bytesRead = read_port(port, &messageCode, buffer,
+				sizeof(buffer));
+			if (bytesRead < 0)
+				return bytesRead;
+			if (code >= 0 && messageCode != code++)
+				return B_BAD_DATA;
+
+			received++;
+			continue;
+		}
+
+		ssize_t messages = read_port_multiple_etc(port, buffer,
+			sizeof(buffer), 0, 0);
+		if (messages < 0)
+			return messages;
+
+		port_message_header* header = (port_message_header*)buffer;
+		for (int32 i = 0; i < messages; i++) {
+			if (header->size != kMessageSize
+				|| (code >= 0 && header->code != code++))
+				return B_BAD_DATA;
+			header = PORT_MESSAGE_NEXT(header);
+		}
+
+		received += messages;
+	}
+
+	return B_OK;
+}
+
+
+static status_t
+pong_thread(void* _benchmark)
+{
+	benchmark* info = (benchmark*)_benchmark;
+	int32 code = 0;
+
+	for (int32 i = 0; i < kBursts; i++) {
+		info->status = receive_burst(info->ports[0], info->multiple,
+			kBurstSize, code);
+		if (info->status == B_OK) {
+			info->status = send_burst(info->ports[1], info->multiple,
+				kBurstSize, i * kBurstSize);
+		}
+		if (info->status != B_OK)
+			break;
+	}
+
+	return info->status;
+}
+
+
+static status_t
+fan_in_writer(void* _benchmark)
+{
+	benchmark* info = (benchmark*)_benchmark;
+
+	for (int32 i = 0; i < kBursts / kWriters; i++) {
+		status_t status = send_burst(info->ports[0], info->multiple,
+			kBurstSize, 0);
+		if (status != B_OK)
+			return status;
+	}
+
+	return B_OK;
+}
+
+
+static status_t
+ping_pong(bool multiple, int32& _messages, bigtime_t& _time)
+{
+	benchmark info;
+	info.ports[0] = create_port(kBurstSize, "ping");
+	info.ports[1] = create_port(kBurstSize, "pong");
+	info.multiple = multiple;
+	info.status = B_OK;
+
+	thread_id thread = spawn_thread(&pong_thread, "pong", B_NORMAL_PRIORITY,
+		&info);
+	resume_thread(thread);
+
+	bigtime_t startTime = system_time();
+	status_t status = B_OK;
+	int32 code = 0;
+
+	for (int32 i = 0; i < kBursts && status == B_OK; i++) {
+		status = send_burst(info.ports[0], multiple, kBurstSize,
+			i * kBurstSize);
+		if (status == B_OK) {
+			status = receive_burst(info.ports[1], multiple, kBurstSize,
+				code);
+		}
+	}
+
+	_time = system_time() - startTime;
+
+	delete_port(info.ports[0]);
+	delete_port(info.ports[1]);
+
+	status_t result;
+	wait_for_thread(thread, &result);
+
+	if (status == B_OK)
+		status = info.status;
+
+	_messages = 2 * kBursts * kBurstSize;
+	return status;
+}
+
+
+static status_t
+fan_in(bool multiple, int32& _messages, bigtime_t& _time)
+{
+	benchmark info;
+	info.ports[0] = create_port(kBurstSize * kWriters, "fan-in");
+	info.multiple = multiple;
+
+	thread_id threads[kWriters];
+	for (int32 i = 0; i < kWriters; i++) {
+		threads[i] = spawn_thread(&fan_in_writer, "fan-in writer",
+			B_NORMAL_PRIORITY, &info);
+	}
+
+	bigtime_t startTime = system_time();
+	for (int32 i = 0; i < kWriters; i++)
+		resume_thread(threads[i]);
+
+	// the messages of the writers are interleaved, so we can't check their
+	// order here
+	int32 code = -1;
+	int32 messages = kWriters * (kBursts / kWriters) * kBurstSize;
+	status_t status = receive_burst(info.ports[0], multiple, messages, code);
+
+	_time = system_time() - startTime;
+
+	delete_port(info.ports[0]);
+
+	for (int32 i = 0; i < kWriters; i++) {
+		status_t result;
+		wait_for_thread(threads[i], &result);
+		if (status == B_OK && result != B_OK)
+			status = result;
+	}
+
+	_messages = messages;
+	return status;
+}
+
+
+static bool
+run(const char* name, status_t (*function)(bool, int32&, bigtime_t&))
+{
+	printf("%-10s", name);
+
+	bool success = true;
+	for (int32 multiple = 0; multiple < 2; multiple++) {
+		int32 messages;
+		bigtime_t time;
+		status_t status = function(multiple != 0, messages, time);
+		if (status != B_OK) {
+			printf(" %20s", strerror(status));
+			success = false;
+			continue;
+		}
+
+		printf(" %20" B_PRId64, (int64)messages * 1000000 / time);
+	}
+
+	printf("\n");
+	return success;
+}
+
+
+int
+main()
+{
+	printf("messages/sec, bursts of %" B_PRId32 " messages of %" B_PRIuSIZE
+		" bytes\n", kBurstSize, kMessageSize);
+	printf("%-10s %20s %20s\n", "", "single", "multiple");
+
+	bool success = run("ping-pong", &ping_pong);
+	success &= run("fan-in", &fan_in);
+
+	return success ? 0 : 1;
+}
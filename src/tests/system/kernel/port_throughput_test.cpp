@@ -0,0 +1,217 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Measures the throughput of ports for message sizes from 4 KB to 16 MB.
+
+	Every size is transferred three ways: with read_port() from a heap
+	buffer, with read_port_area_etc() from a heap buffer, and with
+	read_port_area_etc() from a buffer that spans a complete area, which
+	allows the kernel to share the sender's pages instead of copying them.
+	The contents of every message are verified on the receiving side.
+*/
+
+
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <OS.h>
+
+
+static const size_t kMinMessageSize = 4 * 1024;
+static const size_t kMaxMessageSize = 16 * 1024 * 1024;
+static const size_t kBytesPerRun = 256 * 1024 * 1024;
+
+enum transfer_mode {
+	COPY_MODE,
+	AREA_MODE,
+	SHARED_AREA_MODE
+};
+
+static const char* kModeNames[] = {
+	"read_port",
+	"read_port_area",
+	"read_port_area (shared)"
+};
+
+struct receiver {
+	port_id			port;
+	transfer_mode	mode;
+	size_t			size;
+	int32			count;
+	status_t		status;
+};
+
+
+static void
+fill_message(uint8* buffer, size_t size, int32 code)
+{
+	// only mark the start of every page, to keep the sender cheap
+	for (size_t offset = 0; offset < size; offset += B_PAGE_SIZE)
+		*(int32*)(buffer + offset) = code;
+}
+
+
+static bool
+check_message(const uint8* buffer, size_t size, int32 code)
+{
+	for (size_t offset = 0; offset < size; offset += B_PAGE_SIZE) {
+		if (*(const int32*)(buffer + offset) != code)
+			return false;
+	}
+
+	return true;
+}
+
+
+static status_t
+receiver_thread(void* _receiver)
+{
+	receiver* info = (receiver*)_receiver;
+
+	uint8* buffer = NULL;
+	if (info->mode == COPY_MODE) {
+		buffer = (uint8*)malloc(info->size);
+		if (buffer == NULL)
+			return info->status = B_NO_MEMORY;
+	}
+
+	info->status = B_OK;
+
+	for (int32 i = 0; i < info->count; i++) {
+		int32 code;
+		bool valid;
+
+		if (info->mode == COPY_MODE) {
+			ssize_t bytesRead = read_port(info->port, &code, buffer,
+				info->size);
+			if (bytesRead < 0) {
+				info->status = bytesRead;
+				break;
+			}
+
+			valid = (size_t)bytesRead == info->size
+				&& check_message(buffer, info->size, code);
+		} else {
+			void* address;
+			size_t size;
+			area_id area = read_port_area_etc(info->port, &code, &address,
+				&size, 0, 0);
+			if (area < 0) {
+				info->status = area;
+				break;
+			}
+
+			valid = size == info->size
+				&& check_message((uint8*)address, size, code);
+			delete_area(area);
+		}
+
+		if (!valid || code != i) {
+			info->status = B_BAD_DATA;
+			break;
+		}
+	}
+
+	free(buffer);
+	return info->status;
+}
+
+
+static status_t
+run(transfer_mode mode, size_t size, double& _megabytesPerSecond)
+{
+	int32 count = std::max(kBytesPerRun / size, (size_t)4);
+	size_t areaSize = (size + B_PAGE_SIZE - 1) & ~(B_PAGE_SIZE - 1);
+
+	// the sender's buffer
+	uint8* buffer;
+	area_id area = -1;
+	if (mode == SHARED_AREA_MODE) {
+		area = create_area("port throughput", (void**)&buffer, B_ANY_ADDRESS,
+			areaSize, B_NO_LOCK, B_READ_AREA | B_WRITE_AREA);
+		if (area < 0)
+			return area;
+	} else {
+		buffer = (uint8*)malloc(size);
+		if (buffer == NULL)
+			return B_NO_MEMORY;
+	}
+
+	receiver info;
+	info.port = create_port(4, "port throughput");
+	info.mode = mode;
+	info.size = size;
+	info.count = count;
+	info.status = B_OK;
+
+	thread_id thread = spawn_thread(&receiver_thread, "port receiver",
+		B_NORMAL_PRIORITY, &info);
+	resume_thread(thread);
+
+	bigtime_t startTime = system_time();
+	status_t status = B_OK;
+
+	for (int32 i = 0; i < count; i++) {
+		// writing to the buffer also breaks up the copy-on-write sharing
+		// with the previous message
+		fill_message(buffer, size, i);
+
+		status = write_port(info.port, i, buffer, size);
+		if (status != B_OK)
+			break;
+	}
+
+	status_t result;
+	wait_for_thread(thread, &result);
+	bigtime_t time = system_time() - startTime;
+
+	delete_port(info.port);
+	if (area >= 0)
+		delete_area(area);
+	else
+		free(buffer);
+
+	if (status == B_OK)
+		status = info.status;
+	if (status != B_OK)
+		return status;
+
+	_megabytesPerSecond = (double)size * count / time;
+	return B_OK;
+}
+
+
+int
+main()
+{
+	printf("%-10s", "size");
+	for (int32 mode = COPY_MODE; mode <= SHARED_AREA_MODE; mode++)
+		printf(" %24s", kModeNames[mode]);
+	printf("\n");
+
+	bool failed = false;
+
+	for (size_t size = kMinMessageSize; size <= kMaxMessageSize; size *= 2) {
+		printf("%7lu KB", size / 1024);
+
+		for (int32 mode = COPY_MODE; mode <= SHARED_AREA_MODE; mode++) {
+			double megabytesPerSecond;
+			status_t status = run((transfer_mode)mode, size,
+				megabytesPerSecond);
+			if (status != B_OK) {
+				printf(" %24s", strerror(status));
+				failed = true;
+			} else
+				printf(" %19.1f MB/s", megabytesPerSecond);
+		}
+
+		printf("\n");
+	}
+
+	return failed ? 1 : 0;
+}
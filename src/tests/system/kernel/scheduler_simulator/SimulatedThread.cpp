@@ -0,0 +1,154 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "SimulatedThread.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+
+
+SimulatedThread::SimulatedThread(thread_id id, const char* name,
+	int32 priority, uint32 seed)
+	:
+	burstLeft(0),
+	runningSince(0),
+	wakeUpTime(-1),
+	readySince(-1),
+	lastCPU(-1),
+	runTime(0),
+	wakeUps(0),
+	switches(0),
+	migrations(0),
+	totalLatency(0),
+	maxLatency(0),
+	fRandomState(seed != 0 ? seed : 1)
+{
+	memset(&fThread, 0, sizeof(fThread));
+
+	fThread.id = id;
+	snprintf(fThread.name, sizeof(fThread.name), "%s %" B_PRId32, name, id);
+	fThread.priority = priority;
+	fThread.state = B_THREAD_SUSPENDED;
+	fThread.simulated = this;
+}
+
+
+SimulatedThread::~SimulatedThread()
+{
+}
+
+
+uint32
+SimulatedThread::_Random()
+{
+	// xorshift32
+	uint32 x = fRandomState;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	fRandomState = x;
+	return x;
+}
+
+
+bigtime_t
+SimulatedThread::_RandomExponential(bigtime_t mean)
+{
+	double uniform = (_Random() + 1.0) / 4294967297.0;
+	return std::max((bigtime_t)(-log(uniform) * mean), (bigtime_t)1);
+}
+
+
+//	#pragma mark - CPUBoundThread
+
+
+CPUBoundThread::CPUBoundThread(thread_id id, int32 priority, uint32 seed)
+	:
+	SimulatedThread(id, "cpu bound", priority, seed)
+{
+}
+
+
+bigtime_t
+CPUBoundThread::NextBurst(bigtime_t /* now */)
+{
+	return B_INFINITE_TIMEOUT;
+}
+
+
+bigtime_t
+CPUBoundThread::NextSleep(bigtime_t /* now */)
+{
+	return 0;
+}
+
+
+//	#pragma mark - PeriodicThread
+
+
+PeriodicThread::PeriodicThread(thread_id id, int32 priority, uint32 seed,
+	bigtime_t period, bigtime_t burst)
+	:
+	SimulatedThread(id, "periodic", priority, seed),
+	fPeriod(period),
+	fBurst(burst),
+	fNextActivation(-1),
+	fMisses(0)
+{
+}
+
+
+bigtime_t
+PeriodicThread::NextBurst(bigtime_t now)
+{
+	if (fNextActivation < 0)
+		fNextActivation = now;
+
+	return fBurst;
+}
+
+
+bigtime_t
+PeriodicThread::NextSleep(bigtime_t now)
+{
+	fNextActivation += fPeriod;
+	while (fNextActivation <= now) {
+		fNextActivation += fPeriod;
+		fMisses++;
+	}
+
+	return fNextActivation - now;
+}
+
+
+//	#pragma mark - BurstyThread
+
+
+BurstyThread::BurstyThread(thread_id id, int32 priority, uint32 seed,
+	bigtime_t burst, bigtime_t sleep)
+	:
+	SimulatedThread(id, "bursty", priority, seed),
+	fBurst(burst),
+	fSleep(sleep)
+{
+}
+
+
+bigtime_t
+BurstyThread::NextBurst(bigtime_t /* now */)
+{
+	return _RandomExponential(fBurst);
+}
+
+
+bigtime_t
+BurstyThread::NextSleep(bigtime_t /* now */)
+{
+	return _RandomExponential(fSleep);
+}
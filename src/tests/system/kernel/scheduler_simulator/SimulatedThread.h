@@ -0,0 +1,120 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef SIMULATED_THREAD_H
+#define SIMULATED_THREAD_H
+
+
+#include <thread.h>
+
+
+/*!	A thread of the synthetic workload. It alternates between running for
+	NextBurst() and sleeping for NextSleep(), the lengths are chosen by the
+	subclasses.
+	All random decisions are taken from a generator that is seeded per thread,
+	so that a run can be replayed exactly.
+*/
+class SimulatedThread {
+public:
+								SimulatedThread(thread_id id, const char* name,
+									int32 priority, uint32 seed);
+	virtual						~SimulatedThread();
+
+			Thread*				GetThread()	{ return &fThread; }
+			const char*			Name() const	{ return fThread.name; }
+			int32				Priority() const
+									{ return fThread.priority; }
+
+	// The CPU time the thread needs until it blocks the next time, or
+	// B_INFINITE_TIMEOUT if it never blocks.
+	virtual	bigtime_t			NextBurst(bigtime_t now) = 0;
+	// How long the thread sleeps after a burst.
+	virtual	bigtime_t			NextSleep(bigtime_t now) = 0;
+
+	virtual	const char*			Kind() const = 0;
+	virtual	int64				Misses() const	{ return 0; }
+
+			// simulation state
+			bigtime_t			burstLeft;
+			bigtime_t			runningSince;
+			bigtime_t			wakeUpTime;
+			bigtime_t			readySince;
+			int32				lastCPU;
+
+			// results
+			bigtime_t			runTime;
+			int64				wakeUps;
+			int64				switches;
+			int64				migrations;
+			bigtime_t			totalLatency;
+			bigtime_t			maxLatency;
+
+protected:
+			uint32				_Random();
+			bigtime_t			_RandomExponential(bigtime_t mean);
+
+private:
+			Thread				fThread;
+			uint32				fRandomState;
+};
+
+
+/*!	Never blocks. */
+class CPUBoundThread : public SimulatedThread {
+public:
+								CPUBoundThread(thread_id id, int32 priority,
+									uint32 seed);
+
+	virtual	bigtime_t			NextBurst(bigtime_t now);
+	virtual	bigtime_t			NextSleep(bigtime_t now);
+
+	virtual	const char*			Kind() const	{ return "cpu"; }
+};
+
+
+/*!	Wakes up every \a period and runs for \a burst, like a media or an input
+	thread. A period in which it could not finish its burst is counted as a
+	miss.
+*/
+class PeriodicThread : public SimulatedThread {
+public:
+								PeriodicThread(thread_id id, int32 priority,
+									uint32 seed, bigtime_t period,
+									bigtime_t burst);
+
+	virtual	bigtime_t			NextBurst(bigtime_t now);
+	virtual	bigtime_t			NextSleep(bigtime_t now);
+
+	virtual	const char*			Kind() const	{ return "periodic"; }
+	virtual	int64				Misses() const	{ return fMisses; }
+
+private:
+			bigtime_t			fPeriod;
+			bigtime_t			fBurst;
+			bigtime_t			fNextActivation;
+			int64				fMisses;
+};
+
+
+/*!	Runs and sleeps for exponentially distributed times, like an interactive
+	or a server thread.
+*/
+class BurstyThread : public SimulatedThread {
+public:
+								BurstyThread(thread_id id, int32 priority,
+									uint32 seed, bigtime_t burst,
+									bigtime_t sleep);
+
+	virtual	bigtime_t			NextBurst(bigtime_t now);
+	virtual	bigtime_t			NextSleep(bigtime_t now);
+
+	virtual	const char*			Kind() const	{ return "bursty"; }
+
+private:
+			bigtime_t			fBurst;
+			bigtime_t			fSleep;
+};
+
+
+#endif	// SIMULATED_THREAD_H
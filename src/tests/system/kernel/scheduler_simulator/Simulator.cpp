@@ -0,0 +1,785 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "Simulator.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <new>
+
+#include "scheduler_common.h"
+#include "scheduler_cpu.h"
+#include "scheduler_locking.h"
+#include "scheduler_modes.h"
+#include "scheduler_statistics.h"
+#include "scheduler_thread.h"
+
+#include "SimulatedThread.h"
+
+
+namespace Scheduler {
+
+
+scheduler_mode gCurrentModeID;
+scheduler_mode_operations* gCurrentMode;
+
+bool gSingleCore;
+bool gTrackCoreLoad;
+bool gTrackCPULoad;
+
+
+}	// namespace Scheduler
+
+using namespace Scheduler;
+
+
+cpu_ent gCPU[SMP_MAX_CPUS];
+
+Simulator* Simulator::sDefault;
+
+static scheduler_mode_operations* sSchedulerModes[] = {
+	&gSchedulerLowLatencyMode,
+	&gSchedulerPowerSavingMode,
+};
+
+
+//	#pragma mark - scheduler.cpp
+//
+// The functions below follow their counterparts in
+// src/system/kernel/scheduler/scheduler.cpp, without tracing, listeners,
+// user timers and the actual context switch. Changes to the dispatching there
+// have to be repeated here.
+
+
+static void
+enqueue(Thread* thread, bool newOne)
+{
+	ThreadData* threadData = thread->scheduler_data;
+
+	int32 threadPriority = threadData->GetEffectivePriority();
+
+	CoreEntry* previousCore = threadData->Core();
+	CPUEntry* targetCPU = NULL;
+	CoreEntry* targetCore = NULL;
+	if (thread->pinned_to_cpu > 0) {
+		ASSERT(thread->previous_cpu != NULL);
+		ASSERT(threadData->Core() != NULL);
+		targetCPU = &gCPUEntries[thread->previous_cpu->cpu_num];
+	} else if (gSingleCore)
+		targetCore = &gCoreEntries[0];
+	else if (threadData->Core() != NULL
+		&& (!newOne || !threadData->HasCacheExpired())) {
+		targetCore = threadData->Rebalance();
+	}
+
+	bool rescheduleNeeded = threadData->ChooseCoreAndCPU(targetCore, targetCPU);
+
+	if (previousCore != NULL && previousCore != targetCore)
+		Statistics::ThreadMigrated(threadData, previousCore, targetCPU);
+	if (newOne)
+		Statistics::ThreadWokenUp(threadData, targetCPU);
+
+	threadData->Enqueue();
+
+	int32 heapPriority = CPUPriorityHeap::GetKey(targetCPU);
+	if (threadPriority > heapPriority
+		|| (threadPriority == heapPriority && rescheduleNeeded)) {
+
+		if (targetCPU->ID() == smp_get_current_cpu())
+			gCPU[targetCPU->ID()].invoke_scheduler = true;
+		else {
+			smp_send_ici(targetCPU->ID(), SMP_MSG_RESCHEDULE, 0, 0, 0,
+				NULL, SMP_MSG_FLAG_ASYNC);
+		}
+	}
+}
+
+
+static void
+scheduler_enqueue_in_run_queue(Thread* thread)
+{
+	SchedulerModeLocker _;
+
+	ThreadData* threadData = thread->scheduler_data;
+
+	if (threadData->ShouldCancelPenalty())
+		threadData->CancelPenalty();
+
+	enqueue(thread, true);
+}
+
+
+static void
+switch_thread(Thread* fromThread, Thread* toThread)
+{
+	cpu_ent* cpu = fromThread->cpu;
+	toThread->previous_cpu = toThread->cpu = cpu;
+	fromThread->cpu = NULL;
+	cpu->running_thread = toThread;
+	cpu->previous_thread = fromThread;
+}
+
+
+static void
+reschedule(int32 nextState)
+{
+	int32 thisCPU = smp_get_current_cpu();
+
+	CPUEntry* cpu = CPUEntry::GetCPU(thisCPU);
+	CoreEntry* core = CoreEntry::GetCore(thisCPU);
+
+	Thread* oldThread = thread_get_current_thread();
+	ThreadData* oldThreadData = oldThread->scheduler_data;
+
+	oldThreadData->StopCPUTime();
+
+	SchedulerModeLocker modeLocker;
+
+	oldThread->state = nextState;
+
+	// return time spent in interrupts
+	oldThreadData->SetStolenInterruptTime(gCPU[thisCPU].interrupt_time);
+
+	bool enqueueOldThread = false;
+	bool putOldThreadAtBack = false;
+	switch (nextState) {
+		case B_THREAD_RUNNING:
+		case B_THREAD_READY:
+			enqueueOldThread = true;
+
+			if (!oldThreadData->IsIdle()) {
+				oldThreadData->Continues();
+				putOldThreadAtBack = oldThreadData->HasQuantumEnded(
+					oldThread->cpu->preempted, oldThread->has_yielded);
+			}
+			break;
+		case THREAD_STATE_FREE_ON_RESCHED:
+			oldThreadData->Dies();
+			break;
+		default:
+			oldThreadData->GoesAway();
+			break;
+	}
+
+	oldThread->has_yielded = false;
+
+	// select thread with the biggest priority and enqueue back the old thread
+	ThreadData* nextThreadData;
+	if (gCPU[thisCPU].disabled) {
+		if (!oldThreadData->IsIdle()) {
+			putOldThreadAtBack = oldThread->pinned_to_cpu == 0;
+			oldThreadData->UnassignCore(true);
+
+			CPURunQueueLocker cpuLocker(cpu);
+			nextThreadData = cpu->PeekIdleThread();
+			cpu->Remove(nextThreadData);
+		} else
+			nextThreadData = oldThreadData;
+	} else {
+		nextThreadData
+			= cpu->ChooseNextThread(enqueueOldThread ? oldThreadData : NULL,
+				putOldThreadAtBack);
+
+		// update CPU heap
+		CoreCPUHeapLocker cpuLocker(core);
+		cpu->UpdatePriority(nextThreadData->GetEffectivePriority());
+	}
+
+	Thread* nextThread = nextThreadData->GetThread();
+	ASSERT(!gCPU[thisCPU].disabled || nextThreadData->IsIdle());
+
+	if (nextThread != oldThread) {
+		Statistics::ThreadScheduled(nextThreadData, cpu);
+
+		if (enqueueOldThread) {
+			if (putOldThreadAtBack)
+				enqueue(oldThread, false);
+			else
+				oldThreadData->PutBack();
+		}
+	}
+
+	ASSERT(nextThreadData->Core() == core);
+	nextThread->state = B_THREAD_RUNNING;
+	nextThreadData->StartCPUTime();
+
+	// track CPU activity
+	cpu->TrackActivity(oldThreadData, nextThreadData);
+
+	if (nextThread != oldThread || oldThread->cpu->preempted) {
+		cpu->StartQuantumTimer(nextThreadData, oldThread->cpu->preempted);
+
+		oldThread->cpu->preempted = false;
+		if (!nextThreadData->IsIdle())
+			nextThreadData->Continues();
+		else
+			gCurrentMode->rebalance_irqs(true);
+		nextThreadData->StartQuantum();
+
+		modeLocker.Unlock();
+
+		if (nextThread != oldThread)
+			switch_thread(oldThread, nextThread);
+	}
+}
+
+
+static void
+scheduler_update_policy()
+{
+	gTrackCPULoad = increase_cpu_performance(0) == B_OK;
+	gTrackCoreLoad = !gSingleCore || gTrackCPULoad;
+}
+
+
+//	#pragma mark - kernel emulation
+
+
+bigtime_t
+system_time()
+{
+	return Simulator::Default()->Now();
+}
+
+
+int32
+smp_get_num_cpus()
+{
+	return Simulator::Default()->CPUCount();
+}
+
+
+int32
+smp_get_current_cpu()
+{
+	return Simulator::Default()->CurrentCPU();
+}
+
+
+void
+smp_send_ici(int32 targetCPU, int32 message, addr_t /* data */,
+	addr_t /* data2 */, addr_t /* data3 */, void* /* dataPointer */,
+	uint32 /* flags */)
+{
+	if (message == SMP_MSG_RESCHEDULE)
+		gCPU[targetCPU].invoke_scheduler = true;
+}
+
+
+cpu_ent*
+get_cpu_struct()
+{
+	return &gCPU[smp_get_current_cpu()];
+}
+
+
+status_t
+increase_cpu_performance(int /* delta */)
+{
+	return B_NOT_SUPPORTED;
+}
+
+
+status_t
+decrease_cpu_performance(int /* delta */)
+{
+	return B_NOT_SUPPORTED;
+}
+
+
+Thread*
+thread_get_current_thread()
+{
+	return Simulator::Default()->CurrentThread();
+}
+
+
+void
+thread_map(void (*function)(Thread* thread, void* data), void* data)
+{
+	Simulator::Default()->MapThreads(function, data);
+}
+
+
+status_t
+add_timer(timer* timer, timer_hook hook, bigtime_t period, int32 flags)
+{
+	timer->hook = hook;
+	timer->schedule_time = period;
+	if (flags == B_ONE_SHOT_RELATIVE_TIMER)
+		timer->schedule_time += system_time();
+	timer->cpu = smp_get_current_cpu();
+	timer->active = true;
+	return B_OK;
+}
+
+
+bool
+cancel_timer(timer* timer)
+{
+	bool wasActive = timer->active;
+	timer->active = false;
+	return wasActive;
+}
+
+
+void
+dprintf(const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	vfprintf(stderr, format, args);
+	va_end(args);
+}
+
+
+void
+kprintf(const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	vprintf(format, args);
+	va_end(args);
+}
+
+
+void
+panic(const char* format, ...)
+{
+	fprintf(stderr, "PANIC at %" B_PRIdBIGTIME " us on CPU %" B_PRId32 ": ",
+		system_time(), smp_get_current_cpu());
+
+	va_list args;
+	va_start(args, format);
+	vfprintf(stderr, format, args);
+	va_end(args);
+
+	fprintf(stderr, "\n");
+	abort();
+}
+
+
+//	#pragma mark - Simulator
+
+
+Simulator::Simulator(const simulator_topology& topology, scheduler_mode mode)
+	:
+	fTopology(topology),
+	fMode(mode),
+	fNow(0),
+	fCurrentCPU(0),
+	fIdleThreads(NULL),
+	fThreads(NULL),
+	fThreadCount(0),
+	fThreadCapacity(0)
+{
+	B_INITIALIZE_SPINLOCK(&fKernelTeam.time_lock);
+	sDefault = this;
+}
+
+
+Simulator::~Simulator()
+{
+	for (int32 i = 0; i < fThreadCount; i++) {
+		delete fThreads[i]->GetThread()->scheduler_data;
+		delete fThreads[i];
+	}
+	free(fThreads);
+
+	if (fIdleThreads != NULL) {
+		for (int32 i = 0; i < CPUCount(); i++)
+			delete fIdleThreads[i].scheduler_data;
+		delete[] fIdleThreads;
+	}
+
+	sDefault = NULL;
+}
+
+
+status_t
+Simulator::Init()
+{
+	if (fTopology.cpu_count < 1 || fTopology.cpu_count > SMP_MAX_CPUS
+		|| fTopology.threads_per_core < 1
+		|| fTopology.cores_per_package < 1) {
+		return B_BAD_VALUE;
+	}
+
+	status_t status = _InitTopology();
+	if (status != B_OK)
+		return status;
+
+	gCurrentModeID = fMode;
+	gCurrentMode = sSchedulerModes[fMode];
+	gCurrentMode->switch_to_mode();
+
+	ThreadData::ComputeQuantumLengths();
+
+	status = _InitIdleThreads();
+	if (status != B_OK)
+		return status;
+
+	return Statistics::Init();
+}
+
+
+status_t
+Simulator::AddThread(SimulatedThread* thread, bigtime_t startTime)
+{
+	if (fThreadCount == fThreadCapacity) {
+		int32 capacity = std::max(fThreadCapacity * 2, (int32)16);
+		SimulatedThread** threads = (SimulatedThread**)realloc(fThreads,
+			capacity * sizeof(SimulatedThread*));
+		if (threads == NULL)
+			return B_NO_MEMORY;
+
+		fThreads = threads;
+		fThreadCapacity = capacity;
+	}
+
+	Thread* kernelThread = thread->GetThread();
+	kernelThread->team = &fKernelTeam;
+	B_INITIALIZE_SPINLOCK(&kernelThread->scheduler_lock);
+	B_INITIALIZE_SPINLOCK(&kernelThread->time_lock);
+
+	kernelThread->scheduler_data
+		= new(std::nothrow) ThreadData(kernelThread);
+	if (kernelThread->scheduler_data == NULL)
+		return B_NO_MEMORY;
+
+	// the thread is created by the idle thread of the first CPU
+	fCurrentCPU = 0;
+	kernelThread->scheduler_data->Init();
+
+	thread->wakeUpTime = fNow + startTime;
+	fThreads[fThreadCount++] = thread;
+	return B_OK;
+}
+
+
+void
+Simulator::Run(bigtime_t duration)
+{
+	bigtime_t end = fNow + duration;
+	while (_NextEvent(end))
+		;
+
+	fNow = end;
+
+	// account for the threads that are still running
+	for (int32 i = 0; i < CPUCount(); i++) {
+		SimulatedThread* thread = gCPU[i].running_thread->simulated;
+		if (thread != NULL) {
+			thread->runTime += fNow - thread->runningSince;
+			thread->runningSince = fNow;
+		}
+	}
+}
+
+
+bigtime_t
+Simulator::CPUActiveTime(int32 cpu) const
+{
+	const cpu_ent& entry = gCPU[cpu];
+	bigtime_t activeTime = entry.active_time;
+
+	// add the time of the current thread that has not been accounted yet
+	Thread* thread = entry.running_thread;
+	if (!thread_is_idle_thread(thread)) {
+		activeTime += thread->kernel_time - entry.last_kernel_time
+			+ thread->user_time - entry.last_user_time;
+		if (thread->last_time != 0)
+			activeTime += fNow - thread->last_time;
+	}
+
+	return activeTime;
+}
+
+
+int32
+Simulator::CoreOf(int32 cpu) const
+{
+	return cpu / fTopology.threads_per_core;
+}
+
+
+Thread*
+Simulator::CurrentThread() const
+{
+	return gCPU[fCurrentCPU].running_thread;
+}
+
+
+void
+Simulator::MapThreads(void (*function)(Thread*, void*), void* data)
+{
+	for (int32 i = 0; i < CPUCount(); i++)
+		function(&fIdleThreads[i], data);
+	for (int32 i = 0; i < fThreadCount; i++)
+		function(fThreads[i]->GetThread(), data);
+}
+
+
+/*!	Sets up the CPU, core and package entries the same way the scheduler's
+	init() does for the real topology.
+*/
+status_t
+Simulator::_InitTopology()
+{
+	int32 cpuCount = fTopology.cpu_count;
+	int32 coreCount = (cpuCount + fTopology.threads_per_core - 1)
+		/ fTopology.threads_per_core;
+	int32 packageCount = (coreCount + fTopology.cores_per_package - 1)
+		/ fTopology.cores_per_package;
+
+	for (int32 i = 0; i < cpuCount; i++) {
+		memset(&gCPU[i], 0, sizeof(cpu_ent));
+		gCPU[i].cpu_num = i;
+		B_INITIALIZE_SEQLOCK(&gCPU[i].active_time_lock);
+		B_INITIALIZE_SPINLOCK(&gCPU[i].irqs_lock);
+	}
+
+	gSingleCore = coreCount == 1;
+	scheduler_update_policy();
+
+	gCoreCount = coreCount;
+	gPackageCount = packageCount;
+
+	gCPUEntries = new(std::nothrow) CPUEntry[cpuCount];
+	gCoreEntries = new(std::nothrow) CoreEntry[coreCount];
+	gPackageEntries = new(std::nothrow) PackageEntry[packageCount];
+	if (gCPUEntries == NULL || gCoreEntries == NULL
+		|| gPackageEntries == NULL) {
+		return B_NO_MEMORY;
+	}
+
+	new(&gCoreLoadHeap) CoreLoadHeap(coreCount);
+	new(&gCoreHighLoadHeap) CoreLoadHeap(coreCount);
+
+	new(&gIdlePackageList) IdlePackageList;
+
+	for (int32 i = 0; i < cpuCount; i++) {
+		int32 coreID = CoreOf(i);
+		int32 packageID = coreID / fTopology.cores_per_package;
+
+		CoreEntry* core = &gCoreEntries[coreID];
+		PackageEntry* package = &gPackageEntries[packageID];
+
+		package->Init(packageID);
+		core->Init(coreID, package);
+		gCPUEntries[i].Init(i, core);
+
+		core->AddCPU(&gCPUEntries[i]);
+	}
+
+	return B_OK;
+}
+
+
+status_t
+Simulator::_InitIdleThreads()
+{
+	fIdleThreads = new(std::nothrow) Thread[CPUCount()];
+	if (fIdleThreads == NULL)
+		return B_NO_MEMORY;
+
+	memset(fIdleThreads, 0, sizeof(Thread) * CPUCount());
+
+	for (int32 i = 0; i < CPUCount(); i++) {
+		Thread* thread = &fIdleThreads[i];
+		thread->id = i + 1;
+		snprintf(thread->name, sizeof(thread->name), "idle thread %" B_PRId32,
+			i + 1);
+		thread->priority = B_IDLE_PRIORITY;
+		thread->state = B_THREAD_RUNNING;
+		thread->team = &fKernelTeam;
+		thread->cpu = thread->previous_cpu = &gCPU[i];
+		thread->pinned_to_cpu = 1;
+
+		thread->scheduler_data = new(std::nothrow) ThreadData(thread);
+		if (thread->scheduler_data == NULL)
+			return B_NO_MEMORY;
+		thread->scheduler_data->Init(CoreEntry::GetCore(i));
+
+		gCPU[i].running_thread = thread;
+	}
+
+	// scheduler_start() on each CPU
+	for (int32 i = 0; i < CPUCount(); i++) {
+		fCurrentCPU = i;
+		reschedule(B_THREAD_READY);
+	}
+
+	return B_OK;
+}
+
+
+/*!	Advances the time to the earliest event before \a end and processes it.
+	Returns \c false if there is none.
+*/
+bool
+Simulator::_NextEvent(bigtime_t end)
+{
+	enum {
+		NO_EVENT,
+		TIMER_EVENT,
+		BURST_EVENT,
+		WAKE_UP_EVENT
+	};
+
+	bigtime_t next = end;
+	int32 type = NO_EVENT;
+	int32 cpu = -1;
+	SimulatedThread* thread = NULL;
+
+	for (int32 i = 0; i < CPUCount(); i++) {
+		const timer& quantumTimer = gCPU[i].quantum_timer;
+		if (quantumTimer.active && quantumTimer.schedule_time < next) {
+			next = quantumTimer.schedule_time;
+			type = TIMER_EVENT;
+			cpu = i;
+		}
+
+		SimulatedThread* running = gCPU[i].running_thread->simulated;
+		if (running != NULL && running->burstLeft != B_INFINITE_TIMEOUT
+			&& running->runningSince + running->burstLeft < next) {
+			next = running->runningSince + running->burstLeft;
+			type = BURST_EVENT;
+			cpu = i;
+		}
+	}
+
+	for (int32 i = 0; i < fThreadCount; i++) {
+		SimulatedThread* sleeping = fThreads[i];
+		if (sleeping->wakeUpTime >= 0 && sleeping->wakeUpTime < next) {
+			next = sleeping->wakeUpTime;
+			type = WAKE_UP_EVENT;
+			thread = sleeping;
+		}
+	}
+
+	if (type == NO_EVENT)
+		return false;
+
+	ASSERT(next >= fNow);
+	fNow = next;
+
+	switch (type) {
+		case TIMER_EVENT:
+			_FireTimer(cpu);
+			break;
+		case BURST_EVENT:
+			_FinishBurst(cpu);
+			break;
+		case WAKE_UP_EVENT:
+			_WakeUp(thread);
+			break;
+	}
+
+	_HandleReschedules();
+	return true;
+}
+
+
+void
+Simulator::_FireTimer(int32 cpu)
+{
+	fCurrentCPU = cpu;
+
+	timer& quantumTimer = gCPU[cpu].quantum_timer;
+	quantumTimer.active = false;
+	quantumTimer.hook(&quantumTimer);
+}
+
+
+void
+Simulator::_FinishBurst(int32 cpu)
+{
+	SimulatedThread* thread = gCPU[cpu].running_thread->simulated;
+
+	thread->wakeUpTime = fNow + thread->NextSleep(fNow);
+	_Reschedule(cpu, B_THREAD_WAITING);
+
+	ASSERT(thread->burstLeft == 0);
+}
+
+
+void
+Simulator::_WakeUp(SimulatedThread* thread)
+{
+	// the wake up happens on the CPU the thread last ran on
+	Thread* kernelThread = thread->GetThread();
+	fCurrentCPU = kernelThread->previous_cpu != NULL
+		? kernelThread->previous_cpu->cpu_num : 0;
+
+	thread->wakeUpTime = -1;
+	thread->burstLeft = thread->NextBurst(fNow);
+	thread->readySince = fNow;
+	thread->wakeUps++;
+
+	scheduler_enqueue_in_run_queue(kernelThread);
+}
+
+
+/*!	Runs the scheduler on all CPUs that have been asked to, which the kernel
+	would do when returning from the timer interrupt or the ICI.
+*/
+void
+Simulator::_HandleReschedules()
+{
+	bool rescheduled;
+	do {
+		rescheduled = false;
+		for (int32 i = 0; i < CPUCount(); i++) {
+			if (gCPU[i].invoke_scheduler) {
+				_Reschedule(i, B_THREAD_READY);
+				rescheduled = true;
+			}
+		}
+	} while (rescheduled);
+}
+
+
+void
+Simulator::_Reschedule(int32 cpu, int32 nextState)
+{
+	fCurrentCPU = cpu;
+	gCPU[cpu].invoke_scheduler = false;
+
+	Thread* oldThread = gCPU[cpu].running_thread;
+	SimulatedThread* previous = oldThread->simulated;
+	if (previous != NULL) {
+		bigtime_t ran = fNow - previous->runningSince;
+		previous->runTime += ran;
+		if (previous->burstLeft != B_INFINITE_TIMEOUT)
+			previous->burstLeft -= ran;
+		previous->runningSince = fNow;
+	}
+
+	reschedule(nextState);
+
+	Thread* nextThread = gCPU[cpu].running_thread;
+	SimulatedThread* next = nextThread->simulated;
+	if (nextThread == oldThread || next == NULL)
+		return;
+
+	next->runningSince = fNow;
+	next->switches++;
+
+	if (next->lastCPU >= 0 && CoreOf(next->lastCPU) != CoreOf(cpu))
+		next->migrations++;
+	next->lastCPU = cpu;
+
+	if (next->readySince >= 0) {
+		bigtime_t latency = fNow - next->readySince;
+		next->totalLatency += latency;
+		next->maxLatency = std::max(next->maxLatency, latency);
+		next->readySince = -1;
+	}
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+
+#include <kscheduler.h>
+#include <thread.h>
+
+
+class SimulatedThread;
+
+
+struct simulator_topology {
+	int32	cpu_count;
+	int32	threads_per_core;
+	int32	cores_per_package;
+};
+
+
+/*!	Runs the scheduler's CPU, core and thread management and its modes on
+	simulated CPUs, with virtual time.
+	There is no concurrency: the CPUs take turns, always the one with the
+	earliest event. Context switches take no time, and ICIs are delivered
+	immediately.
+*/
+class Simulator {
+public:
+								Simulator(const simulator_topology& topology,
+									scheduler_mode mode);
+								~Simulator();
+
+			status_t			Init();
+
+			status_t			AddThread(SimulatedThread* thread,
+									bigtime_t startTime);
+
+			void				Run(bigtime_t duration);
+
+			int32				CountThreads() const
+									{ return fThreadCount; }
+			SimulatedThread*	ThreadAt(int32 index) const
+									{ return fThreads[index]; }
+
+			int32				CPUCount() const
+									{ return fTopology.cpu_count; }
+			bigtime_t			CPUActiveTime(int32 cpu) const;
+			int32				CoreOf(int32 cpu) const;
+
+	static	Simulator*			Default()	{ return sDefault; }
+
+			// kernel emulation
+			bigtime_t			Now() const	{ return fNow; }
+			int32				CurrentCPU() const	{ return fCurrentCPU; }
+			Thread*				CurrentThread() const;
+			void				MapThreads(
+									void (*function)(Thread*, void*),
+									void* data);
+
+private:
+			status_t			_InitTopology();
+			status_t			_InitIdleThreads();
+
+			bool				_NextEvent(bigtime_t end);
+			void				_FireTimer(int32 cpu);
+			void				_FinishBurst(int32 cpu);
+			void				_WakeUp(SimulatedThread* thread);
+			void				_HandleReschedules();
+			void				_Reschedule(int32 cpu, int32 nextState);
+
+private:
+			simulator_topology	fTopology;
+			scheduler_mode		fMode;
+
+			bigtime_t			fNow;
+			int32				fCurrentCPU;
+
+			Team				fKernelTeam;
+			Thread*				fIdleThreads;
+
+			SimulatedThread**	fThreads;
+			int32				fThreadCount;
+			int32				fThreadCapacity;
+
+	static	Simulator*			sDefault;
+};
+
+
+#endif	// SIMULATOR_H
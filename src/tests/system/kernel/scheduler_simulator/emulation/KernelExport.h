@@ -0,0 +1,96 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef SCHEDULER_SIMULATOR_KERNEL_EXPORT_H
+#define SCHEDULER_SIMULATOR_KERNEL_EXPORT_H
+
+
+#include <OS.h>
+
+
+// The simulated CPUs are all driven from a single host thread, so locks and
+// interrupts don't need to do anything.
+
+typedef ulong cpu_status;
+
+typedef struct {
+	int32	lock;
+} spinlock;
+
+#define B_SPINLOCK_INITIALIZER			{ 0 }
+#define B_INITIALIZE_SPINLOCK(spinlock)	do { (spinlock)->lock = 0; } while (false)
+
+typedef struct {
+	spinlock	lock;
+	uint32		count;
+} seqlock;
+
+#define B_SEQLOCK_INITIALIZER			{ B_SPINLOCK_INITIALIZER, 0 }
+#define B_INITIALIZE_SEQLOCK(seqlock)	do {	\
+		B_INITIALIZE_SPINLOCK(&(seqlock)->lock);	\
+		(seqlock)->count = 0;	\
+	} while (false)
+
+#define B_HANDLED_INTERRUPT			1
+#define B_INVOKE_SCHEDULER			2
+
+typedef struct timer timer;
+typedef int32 (*timer_hook)(timer*);
+
+struct timer {
+	timer_hook	hook;
+	bigtime_t	schedule_time;
+	int32		cpu;
+	bool		active;
+};
+
+#define B_ONE_SHOT_ABSOLUTE_TIMER	1
+#define B_ONE_SHOT_RELATIVE_TIMER	2
+
+
+static inline cpu_status
+disable_interrupts()
+{
+	return 0;
+}
+
+
+static inline void
+restore_interrupts(cpu_status /* status */)
+{
+}
+
+
+static inline bool
+are_interrupts_enabled()
+{
+	return false;
+}
+
+
+static inline void
+acquire_spinlock(spinlock* /* lock */)
+{
+}
+
+
+static inline void
+release_spinlock(spinlock* /* lock */)
+{
+}
+
+
+status_t	add_timer(timer* timer, timer_hook hook, bigtime_t period,
+				int32 flags);
+bool		cancel_timer(timer* timer);
+
+void		dprintf(const char* format, ...)
+				__attribute__((format(printf, 1, 2)));
+void		kprintf(const char* format, ...)
+				__attribute__((format(printf, 1, 2)));
+void		panic(const char* format, ...)
+				__attribute__((format(printf, 1, 2), noreturn));
+
+
+#endif	// SCHEDULER_SIMULATOR_KERNEL_EXPORT_H
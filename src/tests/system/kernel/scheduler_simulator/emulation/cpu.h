@@ -0,0 +1,48 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef SCHEDULER_SIMULATOR_CPU_H
+#define SCHEDULER_SIMULATOR_CPU_H
+
+
+#include <int.h>
+#include <smp.h>
+#include <timer.h>
+
+
+struct Thread;
+
+
+typedef struct cpu_ent {
+	int				cpu_num;
+
+	bool			preempted;
+	timer			quantum_timer;
+
+	seqlock			active_time_lock;
+	bigtime_t		active_time;
+	bigtime_t		interrupt_time;
+	bigtime_t		last_kernel_time;
+	bigtime_t		last_user_time;
+
+	Thread*			running_thread;
+	Thread*			previous_thread;
+	bool			invoke_scheduler;
+	bool			disabled;
+
+	struct list		irqs;
+	spinlock		irqs_lock;
+} cpu_ent;
+
+
+extern cpu_ent gCPU[];
+
+
+cpu_ent*	get_cpu_struct();
+
+status_t	increase_cpu_performance(int delta);
+status_t	decrease_cpu_performance(int delta);
+
+
+#endif	// SCHEDULER_SIMULATOR_CPU_H
@@ -0,0 +1,46 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef SCHEDULER_SIMULATOR_DEBUG_H
+#define SCHEDULER_SIMULATOR_DEBUG_H
+
+
+#include <stdlib.h>
+
+#include <KernelExport.h>
+
+
+// Assertions are always enabled: the simulator is meant to catch scheduler
+// bugs, too.
+#define KDEBUG 1
+
+#define SCHEDULER_STATISTICS 1
+
+#define ASSERT(x)	\
+	do {	\
+		if (!(x))	\
+			panic("ASSERT FAILED (%s:%d): %s", __FILE__, __LINE__, #x);	\
+	} while (false)
+
+#define ASSERT_PRINT(x, format, args...)	\
+	do {	\
+		if (!(x)) {	\
+			panic("ASSERT FAILED (%s:%d): %s; " format, __FILE__,	\
+				__LINE__, #x, args);	\
+		}	\
+	} while (false)
+
+#define dprintf_no_syslog	dprintf
+
+
+static inline int
+add_debugger_command_etc(const char* /* name */,
+	int (* /* function */)(int, char**), const char* /* description */,
+	const char* /* usage */, uint32 /* flags */)
+{
+	return B_OK;
+}
+
+
+#endif	// SCHEDULER_SIMULATOR_DEBUG_H
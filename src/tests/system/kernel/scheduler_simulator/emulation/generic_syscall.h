@@ -0,0 +1,24 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef SCHEDULER_SIMULATOR_GENERIC_SYSCALL_H
+#define SCHEDULER_SIMULATOR_GENERIC_SYSCALL_H
+
+
+#include <OS.h>
+
+
+typedef status_t (*syscall_hook)(const char* subsystem, uint32 function,
+	void* buffer, size_t bufferSize);
+
+
+static inline status_t
+register_generic_syscall(const char* /* subsystem */, syscall_hook /* hook */,
+	uint32 /* version */, uint32 /* flags */)
+{
+	return B_OK;
+}
+
+
+#endif	// SCHEDULER_SIMULATOR_GENERIC_SYSCALL_H
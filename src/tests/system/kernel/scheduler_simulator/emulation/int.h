@@ -0,0 +1,46 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef SCHEDULER_SIMULATOR_INT_H
+#define SCHEDULER_SIMULATOR_INT_H
+
+
+#include <KernelExport.h>
+
+
+// Interrupts are not simulated, the lists of assigned IRQs stay empty.
+
+struct list {
+	void*	first;
+};
+
+typedef struct irq_assignment {
+	int32	irq;
+	int32	count;
+	int32	load;
+	int32	cpu;
+} irq_assignment;
+
+
+static inline void*
+list_get_first_item(struct list* list)
+{
+	return list->first;
+}
+
+
+static inline void*
+list_get_next_item(struct list* /* list */, void* /* item */)
+{
+	return NULL;
+}
+
+
+static inline void
+assign_io_interrupt_to_cpu(int32 /* irq */, int32 /* cpu */)
+{
+}
+
+
+#endif	// SCHEDULER_SIMULATOR_INT_H
@@ -0,0 +1,27 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef SCHEDULER_SIMULATOR_KERNEL_H
+#define SCHEDULER_SIMULATOR_KERNEL_H
+
+
+#include <string.h>
+
+#include <OS.h>
+
+
+// There is no userland in the simulator, all buffers are local.
+
+#define IS_USER_ADDRESS(x)	true
+
+
+static inline status_t
+user_memcpy(void* to, const void* from, size_t size)
+{
+	memcpy(to, from, size);
+	return B_OK;
+}
+
+
+#endif	// SCHEDULER_SIMULATOR_KERNEL_H
@@ -0,0 +1,21 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef SCHEDULER_SIMULATOR_KSCHEDULER_H
+#define SCHEDULER_SIMULATOR_KSCHEDULER_H
+
+
+#include <cpu.h>
+#include <int.h>
+#include <smp.h>
+#include <thread_types.h>
+
+
+enum scheduler_mode {
+	SCHEDULER_MODE_LOW_LATENCY,
+	SCHEDULER_MODE_POWER_SAVING,
+};
+
+
+#endif	// SCHEDULER_SIMULATOR_KSCHEDULER_H
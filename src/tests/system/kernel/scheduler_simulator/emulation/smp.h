@@ -0,0 +1,100 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef SCHEDULER_SIMULATOR_SMP_H
+#define SCHEDULER_SIMULATOR_SMP_H
+
+
+#include <KernelExport.h>
+
+
+#define SMP_MAX_CPUS		64
+
+#define CACHE_LINE_ALIGN
+
+enum {
+	SMP_MSG_INVALIDATE_PAGE_RANGE = 0,
+	SMP_MSG_INVALIDATE_PAGE_LIST,
+	SMP_MSG_USER_INVALIDATE_PAGES,
+	SMP_MSG_GLOBAL_INVALIDATE_PAGES,
+	SMP_MSG_CPU_HALT,
+	SMP_MSG_CALL_FUNCTION,
+	SMP_MSG_RESCHEDULE
+};
+
+enum {
+	SMP_MSG_FLAG_ASYNC		= 0x0,
+	SMP_MSG_FLAG_SYNC		= 0x1,
+	SMP_MSG_FLAG_FREE_ARG	= 0x2,
+};
+
+typedef struct {
+	int32	lock;
+} rw_spinlock;
+
+#define B_RW_SPINLOCK_INITIALIZER	{ 0 }
+#define B_INITIALIZE_RW_SPINLOCK(rwspinlock)	\
+	do { (rwspinlock)->lock = 0; } while (false)
+
+
+int32	smp_get_num_cpus();
+int32	smp_get_current_cpu();
+
+void	smp_send_ici(int32 targetCPU, int32 message, addr_t data, addr_t data2,
+			addr_t data3, void* dataPointer, uint32 flags);
+
+
+static inline void
+acquire_read_spinlock(rw_spinlock* /* lock */)
+{
+}
+
+
+static inline void
+release_read_spinlock(rw_spinlock* /* lock */)
+{
+}
+
+
+static inline void
+acquire_write_spinlock(rw_spinlock* /* lock */)
+{
+}
+
+
+static inline void
+release_write_spinlock(rw_spinlock* /* lock */)
+{
+}
+
+
+static inline void
+acquire_write_seqlock(seqlock* lock)
+{
+	lock->count++;
+}
+
+
+static inline void
+release_write_seqlock(seqlock* lock)
+{
+	lock->count++;
+}
+
+
+static inline uint32
+acquire_read_seqlock(seqlock* lock)
+{
+	return lock->count;
+}
+
+
+static inline bool
+release_read_seqlock(seqlock* lock, uint32 count)
+{
+	return lock->count == count;
+}
+
+
+#endif	// SCHEDULER_SIMULATOR_SMP_H
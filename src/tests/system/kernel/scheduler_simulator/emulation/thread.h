@@ -0,0 +1,30 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef SCHEDULER_SIMULATOR_THREAD_H
+#define SCHEDULER_SIMULATOR_THREAD_H
+
+
+#include <cpu.h>
+#include <thread_types.h>
+
+
+Thread*	thread_get_current_thread();
+void	thread_map(void (*function)(Thread* thread, void* data), void* data);
+
+
+static inline bool
+thread_is_idle_thread(Thread* thread)
+{
+	return thread->priority == B_IDLE_PRIORITY;
+}
+
+
+static inline void
+user_timer_check_team_user_timers(Team* /* team */)
+{
+}
+
+
+#endif	// SCHEDULER_SIMULATOR_THREAD_H
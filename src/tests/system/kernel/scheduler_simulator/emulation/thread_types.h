@@ -0,0 +1,66 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef SCHEDULER_SIMULATOR_THREAD_TYPES_H
+#define SCHEDULER_SIMULATOR_THREAD_TYPES_H
+
+
+#include <smp.h>
+#include <util/DoublyLinkedList.h>
+
+
+#define THREAD_MIN_SET_PRIORITY				B_LOWEST_ACTIVE_PRIORITY
+#define THREAD_MAX_SET_PRIORITY				B_REAL_TIME_PRIORITY
+
+enum additional_thread_state {
+	THREAD_STATE_FREE_ON_RESCHED = 7
+};
+
+
+namespace Scheduler {
+	struct ThreadData;
+}
+
+class SimulatedThread;
+struct cpu_ent;
+
+
+/*!	The parts of the kernel's Team that the scheduler uses. */
+struct Team {
+	spinlock				time_lock;
+
+	bool HasActiveUserTimeUserTimers() const
+	{
+		return false;
+	}
+};
+
+
+/*!	The parts of the kernel's Thread that the scheduler uses. */
+struct Thread {
+	thread_id				id;
+	char					name[B_OS_NAME_LENGTH];
+	int32					priority;
+	int32					state;
+
+	cpu_ent*				cpu;
+	cpu_ent*				previous_cpu;
+	int32					pinned_to_cpu;
+	bool					has_yielded;
+
+	spinlock				scheduler_lock;
+	Scheduler::ThreadData*	scheduler_data;
+
+	Team*					team;
+
+	spinlock				time_lock;
+	bigtime_t				kernel_time;
+	bigtime_t				user_time;
+	bigtime_t				last_time;
+
+	SimulatedThread*		simulated;
+};
+
+
+#endif	// SCHEDULER_SIMULATOR_THREAD_TYPES_H
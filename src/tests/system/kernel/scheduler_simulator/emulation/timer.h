@@ -0,0 +1,12 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef SCHEDULER_SIMULATOR_TIMER_H
+#define SCHEDULER_SIMULATOR_TIMER_H
+
+
+#include <KernelExport.h>
+
+
+#endif	// SCHEDULER_SIMULATOR_TIMER_H
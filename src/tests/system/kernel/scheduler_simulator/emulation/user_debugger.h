@@ -0,0 +1,9 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef SCHEDULER_SIMULATOR_USER_DEBUGGER_H
+#define SCHEDULER_SIMULATOR_USER_DEBUGGER_H
+
+
+#endif	// SCHEDULER_SIMULATOR_USER_DEBUGGER_H
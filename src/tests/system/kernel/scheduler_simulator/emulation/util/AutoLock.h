@@ -0,0 +1,87 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef SCHEDULER_SIMULATOR_UTIL_AUTO_LOCK_H
+#define SCHEDULER_SIMULATOR_UTIL_AUTO_LOCK_H
+
+
+#include <KernelExport.h>
+#include <shared/AutoLocker.h>
+
+#include <smp.h>
+
+
+// The subset of the kernel's lockers that the scheduler uses.
+
+
+class SpinLocking {
+public:
+	inline bool Lock(spinlock* lockable)
+	{
+		acquire_spinlock(lockable);
+		return true;
+	}
+
+	inline void Unlock(spinlock* lockable)
+	{
+		release_spinlock(lockable);
+	}
+};
+
+typedef AutoLocker<spinlock, SpinLocking> SpinLocker;
+typedef AutoLocker<spinlock, SpinLocking> InterruptsSpinLocker;
+
+
+class ReadSpinLocking {
+public:
+	inline bool Lock(rw_spinlock* lockable)
+	{
+		acquire_read_spinlock(lockable);
+		return true;
+	}
+
+	inline void Unlock(rw_spinlock* lockable)
+	{
+		release_read_spinlock(lockable);
+	}
+};
+
+typedef AutoLocker<rw_spinlock, ReadSpinLocking> ReadSpinLocker;
+
+
+class WriteSpinLocking {
+public:
+	inline bool Lock(rw_spinlock* lockable)
+	{
+		acquire_write_spinlock(lockable);
+		return true;
+	}
+
+	inline void Unlock(rw_spinlock* lockable)
+	{
+		release_write_spinlock(lockable);
+	}
+};
+
+typedef AutoLocker<rw_spinlock, WriteSpinLocking> WriteSpinLocker;
+
+
+class WriteSequentialLocking {
+public:
+	inline bool Lock(seqlock* lockable)
+	{
+		acquire_write_seqlock(lockable);
+		return true;
+	}
+
+	inline void Unlock(seqlock* lockable)
+	{
+		release_write_seqlock(lockable);
+	}
+};
+
+typedef AutoLocker<seqlock, WriteSequentialLocking> WriteSequentialLocker;
+
+
+#endif	// SCHEDULER_SIMULATOR_UTIL_AUTO_LOCK_H
@@ -0,0 +1,452 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <new>
+
+#include <scheduler_defs.h>
+
+#include "scheduler_statistics.h"
+
+#include "SimulatedThread.h"
+#include "Simulator.h"
+
+
+using namespace Scheduler;
+
+
+static const char* kUsage =
+	"Usage: %s [ <options> ]\n"
+	"Runs the kernel scheduler on simulated CPUs with a synthetic workload,\n"
+	"and prints the scheduler statistics. The same seed gives the same run.\n"
+	"\n"
+	"Options:\n"
+	"  -c, --cpus <count>       - The number of logical CPUs (default: 4).\n"
+	"  -s, --smt <count>        - The number of logical CPUs per core\n"
+	"                             (default: 1).\n"
+	"  -k, --cores-per-package <count>\n"
+	"                           - The number of cores per package (default:\n"
+	"                             all in one package).\n"
+	"  -m, --mode <mode>        - \"low_latency\" (default) or \"power_saving\".\n"
+	"  -t, --time <ms>          - The simulated time (default: 10000 ms).\n"
+	"  -r, --seed <seed>        - The seed of the workload (default: 1).\n"
+	"  -C, --cpu-bound <count>[:<priority>]\n"
+	"                           - Adds threads that never block.\n"
+	"  -P, --periodic <count>:<period>:<burst>[:<priority>]\n"
+	"                           - Adds threads that run <burst> us every\n"
+	"                             <period> us.\n"
+	"  -B, --bursty <count>:<burst>:<sleep>[:<priority>]\n"
+	"                           - Adds threads that alternately run and sleep\n"
+	"                             for exponentially distributed times with the\n"
+	"                             given means in us.\n"
+	"  -T, --trace <cpu>        - Prints the scheduler trace of the CPU.\n"
+	"  -h, --help               - Prints this usage info.\n"
+	"\n"
+	"Without any threads given, a mix of 2 CPU bound, 4 periodic (60 Hz,\n"
+	"2 ms, display priority) and 8 bursty (0.5 ms, 5 ms) threads is used.\n";
+
+
+struct workload {
+	char		kind;
+	int32		count;
+	bigtime_t	first;
+	bigtime_t	second;
+	int32		priority;
+};
+
+static const int32 kMaxWorkloads = 32;
+static const uint32 kTraceEntryCount = 512;
+	// the size of the kernel's trace ring
+
+
+static void
+print_usage_and_exit(const char* programName, bool error)
+{
+	fprintf(error ? stderr : stdout, kUsage, programName);
+	exit(error ? 1 : 0);
+}
+
+
+static uint32
+next_random(uint32& state)
+{
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+
+static bool
+parse_workload(char kind, const char* argument, workload& _workload)
+{
+	_workload.kind = kind;
+	_workload.first = 0;
+	_workload.second = 0;
+	_workload.priority = B_NORMAL_PRIORITY;
+
+	long count;
+	long long first;
+	long long second;
+	long priority;
+	int fields;
+
+	if (kind == 'C') {
+		fields = sscanf(argument, "%ld:%ld", &count, &priority);
+		if (fields < 1)
+			return false;
+		if (fields == 2)
+			_workload.priority = priority;
+	} else {
+		fields = sscanf(argument, "%ld:%lld:%lld:%ld", &count, &first, &second,
+			&priority);
+		if (fields < 3 || first <= 0 || second <= 0)
+			return false;
+		if (kind == 'P' && second > first)
+			return false;
+
+		_workload.first = first;
+		_workload.second = second;
+		if (fields == 4)
+			_workload.priority = priority;
+	}
+
+	_workload.count = count;
+	return count > 0 && _workload.priority > B_IDLE_PRIORITY
+		&& _workload.priority <= B_REAL_TIME_PRIORITY;
+}
+
+
+static status_t
+add_threads(Simulator& simulator, const workload& workload, uint32 seed,
+	thread_id& nextID)
+{
+	uint32 random = seed ^ (workload.kind * 2654435761UL);
+
+	for (int32 i = 0; i < workload.count; i++) {
+		thread_id id = nextID++;
+		uint32 threadSeed = seed * 2654435761UL + id;
+
+		SimulatedThread* thread;
+		bigtime_t startTime = 0;
+		switch (workload.kind) {
+			case 'C':
+				thread = new(std::nothrow) CPUBoundThread(id,
+					workload.priority, threadSeed);
+				break;
+			case 'P':
+				thread = new(std::nothrow) PeriodicThread(id,
+					workload.priority, threadSeed, workload.first,
+					workload.second);
+				startTime = next_random(random) % workload.first;
+				break;
+			default:
+				thread = new(std::nothrow) BurstyThread(id,
+					workload.priority, threadSeed, workload.first,
+					workload.second);
+				startTime = next_random(random) % workload.second;
+				break;
+		}
+
+		if (thread == NULL)
+			return B_NO_MEMORY;
+
+		status_t status = simulator.AddThread(thread, startTime);
+		if (status != B_OK) {
+			delete thread;
+			return status;
+		}
+	}
+
+	return B_OK;
+}
+
+
+static void
+print_cpu_statistics(Simulator& simulator, bigtime_t duration)
+{
+	printf("cpu core  busy   load  switches  migrations  wake ups  "
+		"run queue      latency (us)\n");
+	printf("                                                      "
+		"avg   max      avg      max\n");
+
+	uint64 histogram[SCHEDULER_LATENCY_BUCKETS] = {};
+
+	for (int32 i = 0; i < simulator.CPUCount(); i++) {
+		scheduler_cpu_statistics statistics;
+		if (Statistics::GetCPUStatistics(i, statistics) != B_OK)
+			continue;
+
+		double runQueue = statistics.run_queue_samples > 0
+			? (double)statistics.run_queue_length_sum
+				/ statistics.run_queue_samples : 0;
+		double latency = statistics.wake_ups > 0
+			? (double)statistics.total_wake_up_latency / statistics.wake_ups
+			: 0;
+
+		printf("%3" B_PRId32 " %4" B_PRId32 " %4.0f%% %5.1f%% %9" B_PRIu64
+			" %11" B_PRIu64 " %9" B_PRIu64 " %5.2f %5" B_PRId32 " %8.1f %8"
+			B_PRIdBIGTIME "\n", statistics.cpu, statistics.core,
+			100.0 * simulator.CPUActiveTime(i) / duration,
+			statistics.core_load / 10.0, statistics.context_switches,
+			statistics.migrations, statistics.wake_ups, runQueue,
+			statistics.max_run_queue_length, latency,
+			statistics.max_wake_up_latency);
+
+		for (int32 j = 0; j < SCHEDULER_LATENCY_BUCKETS; j++)
+			histogram[j] += statistics.wake_up_latencies[j];
+	}
+
+	printf("\nwake up latency histogram:\n");
+	for (int32 i = 0; i < SCHEDULER_LATENCY_BUCKETS; i++) {
+		if (histogram[i] == 0)
+			continue;
+
+		if (i == SCHEDULER_LATENCY_BUCKETS - 1)
+			printf("  >= %8ld us", 1L << (i - 1));
+		else
+			printf("  < %9ld us", 1L << i);
+		printf(" %10" B_PRIu64 "\n", histogram[i]);
+	}
+}
+
+
+static void
+print_thread_statistics(Simulator& simulator, bigtime_t duration)
+{
+	printf("\nkind      priority threads   cpu time   wake ups  latency (us)"
+		"       migrations  misses\n");
+	printf("                                                  avg      max\n");
+
+	int32 threadCount = simulator.CountThreads();
+	bool* printed = new(std::nothrow) bool[threadCount];
+	if (printed == NULL)
+		return;
+	memset(printed, 0, threadCount);
+
+	// group the threads by kind and priority
+	for (int32 i = 0; i < threadCount; i++) {
+		if (printed[i])
+			continue;
+
+		SimulatedThread* first = simulator.ThreadAt(i);
+		int32 count = 0;
+		bigtime_t runTime = 0;
+		int64 wakeUps = 0;
+		bigtime_t totalLatency = 0;
+		bigtime_t maxLatency = 0;
+		int64 migrations = 0;
+		int64 misses = 0;
+
+		for (int32 j = i; j < threadCount; j++) {
+			SimulatedThread* thread = simulator.ThreadAt(j);
+			if (printed[j] || thread->Priority() != first->Priority()
+				|| strcmp(thread->Kind(), first->Kind()) != 0) {
+				continue;
+			}
+
+			printed[j] = true;
+			count++;
+			runTime += thread->runTime;
+			wakeUps += thread->wakeUps;
+			totalLatency += thread->totalLatency;
+			maxLatency = std::max(maxLatency, thread->maxLatency);
+			migrations += thread->migrations;
+			misses += thread->Misses();
+		}
+
+		printf("%-9s %8" B_PRId32 " %7" B_PRId32 " %9.1f%% %10" B_PRId64
+			" %8.1f %8" B_PRIdBIGTIME " %10" B_PRId64 " %7" B_PRId64 "\n",
+			first->Kind(), first->Priority(), count,
+			100.0 * runTime / duration / simulator.CPUCount(), wakeUps,
+			wakeUps > 0 ? (double)totalLatency / wakeUps : 0, maxLatency,
+			migrations, misses);
+	}
+
+	delete[] printed;
+}
+
+
+static void
+print_trace(int32 cpu)
+{
+	scheduler_trace_entry* entries
+		= new(std::nothrow) scheduler_trace_entry[kTraceEntryCount];
+	if (entries == NULL)
+		return;
+
+	uint32 count = kTraceEntryCount;
+	uint64 first;
+	if (Statistics::GetTrace(cpu, entries, count, first) != B_OK) {
+		fprintf(stderr, "Error: Failed to get the trace of CPU %" B_PRId32
+			"\n", cpu);
+		delete[] entries;
+		return;
+	}
+
+	static const char* const kTypes[] = { "wake up", "migrate", "schedule" };
+
+	printf("\ntrace of CPU %" B_PRId32 ":\n", cpu);
+	printf("       entry       time  thread  event     core  run queue  load"
+		"  value\n");
+	for (uint32 i = 0; i < count; i++) {
+		const scheduler_trace_entry& entry = entries[i];
+		printf("%12" B_PRIu64 " %10" B_PRIdBIGTIME " %7" B_PRId32 "  %-8s "
+			"%5d %10d %4d.%d %6" B_PRId32 "\n", first + i, entry.time,
+			entry.thread, entry.type < 3 ? kTypes[entry.type] : "?",
+			entry.core, entry.run_queue_length, entry.core_load / 10,
+			entry.core_load % 10, entry.value);
+	}
+
+	delete[] entries;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	simulator_topology topology;
+	topology.cpu_count = 4;
+	topology.threads_per_core = 1;
+	topology.cores_per_package = 0;
+
+	scheduler_mode mode = SCHEDULER_MODE_LOW_LATENCY;
+	bigtime_t duration = 10000000;
+	uint32 seed = 1;
+	int32 traceCPU = -1;
+
+	workload workloads[kMaxWorkloads];
+	int32 workloadCount = 0;
+
+	const char* programName = argv[0];
+
+	while (true) {
+		static struct option sLongOptions[] = {
+			{ "cpus", required_argument, 0, 'c' },
+			{ "smt", required_argument, 0, 's' },
+			{ "cores-per-package", required_argument, 0, 'k' },
+			{ "mode", required_argument, 0, 'm' },
+			{ "time", required_argument, 0, 't' },
+			{ "seed", required_argument, 0, 'r' },
+			{ "cpu-bound", required_argument, 0, 'C' },
+			{ "periodic", required_argument, 0, 'P' },
+			{ "bursty", required_argument, 0, 'B' },
+			{ "trace", required_argument, 0, 'T' },
+			{ "help", no_argument, 0, 'h' },
+			{ 0, 0, 0, 0 }
+		};
+
+		opterr = 0; // don't print errors
+		int c = getopt_long(argc, argv, "+c:s:k:m:t:r:C:P:B:T:h",
+			sLongOptions, NULL);
+		if (c == -1)
+			break;
+
+		switch (c) {
+			case 'c':
+				topology.cpu_count = atoi(optarg);
+				break;
+			case 's':
+				topology.threads_per_core = atoi(optarg);
+				break;
+			case 'k':
+				topology.cores_per_package = atoi(optarg);
+				break;
+			case 'm':
+				if (strcmp(optarg, "low_latency") == 0)
+					mode = SCHEDULER_MODE_LOW_LATENCY;
+				else if (strcmp(optarg, "power_saving") == 0)
+					mode = SCHEDULER_MODE_POWER_SAVING;
+				else
+					print_usage_and_exit(programName, true);
+				break;
+			case 't':
+				duration = atoll(optarg) * 1000;
+				break;
+			case 'r':
+				seed = strtoul(optarg, NULL, 0);
+				break;
+			case 'C':
+			case 'P':
+			case 'B':
+				if (workloadCount == kMaxWorkloads
+					|| !parse_workload(c, optarg, workloads[workloadCount])) {
+					print_usage_and_exit(programName, true);
+				}
+				workloadCount++;
+				break;
+			case 'T':
+				traceCPU = atoi(optarg);
+				break;
+			case 'h':
+				print_usage_and_exit(programName, false);
+				break;
+			default:
+				print_usage_and_exit(programName, true);
+				break;
+		}
+	}
+
+	if (optind != argc || duration <= 0)
+		print_usage_and_exit(programName, true);
+
+	if (workloadCount == 0) {
+		parse_workload('C', "2", workloads[workloadCount++]);
+		parse_workload('P', "4:16666:2000:15", workloads[workloadCount++]);
+		parse_workload('B', "8:500:5000", workloads[workloadCount++]);
+	}
+
+	int32 coreCount = (topology.cpu_count + topology.threads_per_core - 1)
+		/ std::max(topology.threads_per_core, (int32)1);
+	if (topology.cores_per_package <= 0)
+		topology.cores_per_package = coreCount;
+
+	Simulator simulator(topology, mode);
+	status_t status = simulator.Init();
+	if (status != B_OK) {
+		fprintf(stderr, "Error: Failed to initialize the simulator: %s\n",
+			strerror(status));
+		return 1;
+	}
+
+	thread_id nextID = topology.cpu_count + 1;
+	for (int32 i = 0; i < workloadCount; i++) {
+		status = add_threads(simulator, workloads[i], seed, nextID);
+		if (status != B_OK) {
+			fprintf(stderr, "Error: Failed to add threads: %s\n",
+				strerror(status));
+			return 1;
+		}
+	}
+
+	if (traceCPU >= topology.cpu_count) {
+		fprintf(stderr, "Error: There is no CPU %" B_PRId32 "\n", traceCPU);
+		return 1;
+	}
+
+	simulator.Run(duration);
+
+	int32 packageCount = (coreCount + topology.cores_per_package - 1)
+		/ topology.cores_per_package;
+	printf("%" B_PRId32 " CPUs, %" B_PRId32 " cores, %" B_PRId32 " packages, "
+		"%s mode, %" B_PRIdBIGTIME " ms, seed %" B_PRIu32 "\n\n",
+		topology.cpu_count, coreCount, packageCount,
+		mode == SCHEDULER_MODE_LOW_LATENCY ? "low latency" : "power saving",
+		duration / 1000, seed);
+
+	print_cpu_statistics(simulator, duration);
+	print_thread_statistics(simulator, duration);
+
+	if (traceCPU >= 0)
+		print_trace(traceCPU);
+
+	return 0;
+}
@@ -0,0 +1,150 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include <OS.h>
+#include <syscalls.h>
+#include <generic_syscall.h>
+
+#include <scheduler_defs.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+extern const char *__progname;
+
+
+static const uint32 kTraceEntryCount = 512;
+
+
+static void
+usage()
+{
+	fprintf(stderr, "usage: %s [ -t <cpu> ]\n"
+		"Prints the scheduler statistics of all CPUs, or with -t the last "
+		"scheduler\nevents of the given CPU.\n", __progname);
+	exit(1);
+}
+
+
+static int
+print_cpu_statistics()
+{
+	system_info info;
+	get_system_info(&info);
+
+	scheduler_cpu_statistics* statistics
+		= new scheduler_cpu_statistics[info.cpu_count];
+	status_t status = _kern_generic_syscall(SCHEDULER_STATISTICS_SYSCALLS,
+		GET_SCHEDULER_CPU_STATISTICS, statistics,
+		sizeof(scheduler_cpu_statistics) * info.cpu_count);
+	if (status != B_OK) {
+		fprintf(stderr, "%s: getting the statistics failed: %s\n",
+			__progname, strerror(status));
+		delete[] statistics;
+		return 1;
+	}
+
+	printf("cpu core   load  switches  migrations  wake ups  run queue      "
+		"latency (us)\n");
+	printf("                                                 avg   max      "
+		"avg      max\n");
+
+	uint64 histogram[SCHEDULER_LATENCY_BUCKETS] = {};
+
+	for (uint32 i = 0; i < info.cpu_count; i++) {
+		const scheduler_cpu_statistics& cpu = statistics[i];
+
+		double runQueue = cpu.run_queue_samples > 0
+			? (double)cpu.run_queue_length_sum / cpu.run_queue_samples : 0;
+		double latency = cpu.wake_ups > 0
+			? (double)cpu.total_wake_up_latency / cpu.wake_ups : 0;
+
+		printf("%3" B_PRId32 " %4" B_PRId32 " %5.1f%% %9" B_PRIu64 " %11"
+			B_PRIu64 " %9" B_PRIu64 " %5.2f %5" B_PRId32 " %8.1f %8"
+			B_PRIdBIGTIME "\n", cpu.cpu, cpu.core, cpu.load / 10.0,
+			cpu.context_switches, cpu.migrations, cpu.wake_ups, runQueue,
+			cpu.max_run_queue_length, latency, cpu.max_wake_up_latency);
+
+		for (int32 j = 0; j < SCHEDULER_LATENCY_BUCKETS; j++)
+			histogram[j] += cpu.wake_up_latencies[j];
+	}
+
+	printf("\nwake up latency histogram:\n");
+	for (int32 i = 0; i < SCHEDULER_LATENCY_BUCKETS; i++) {
+		if (histogram[i] == 0)
+			continue;
+
+		if (i == SCHEDULER_LATENCY_BUCKETS - 1)
+			printf("  >= %8ld us", 1L << (i - 1));
+		else
+			printf("  < %9ld us", 1L << i);
+		printf(" %10" B_PRIu64 "\n", histogram[i]);
+	}
+
+	delete[] statistics;
+	return 0;
+}
+
+
+static int
+print_trace(int32 cpu)
+{
+	scheduler_trace_request request;
+	request.cpu = cpu;
+	request.count = kTraceEntryCount;
+	request.entries = new scheduler_trace_entry[kTraceEntryCount];
+
+	status_t status = _kern_generic_syscall(SCHEDULER_STATISTICS_SYSCALLS,
+		GET_SCHEDULER_TRACE, &request, sizeof(request));
+	if (status != B_OK) {
+		fprintf(stderr, "%s: getting the trace of CPU %" B_PRId32
+			" failed: %s\n", __progname, cpu, strerror(status));
+		delete[] request.entries;
+		return 1;
+	}
+
+	static const char* const kTypes[] = { "wake up", "migrate", "schedule" };
+
+	printf("       entry         time  thread  event     core  run queue  load"
+		"  value\n");
+	for (uint32 i = 0; i < request.count; i++) {
+		const scheduler_trace_entry& entry = request.entries[i];
+		printf("%12" B_PRIu64 " %12" B_PRIdBIGTIME " %7" B_PRId32 "  %-8s "
+			"%5d %10d %4d.%d %6" B_PRId32 "\n", request.first + i,
+			entry.time, entry.thread,
+			entry.type < 3 ? kTypes[entry.type] : "?", entry.core,
+			entry.run_queue_length, entry.core_load / 10,
+			entry.core_load % 10, entry.value);
+	}
+
+	delete[] request.entries;
+	return 0;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	uint32 version = 0;
+	status_t status = _kern_generic_syscall(SCHEDULER_STATISTICS_SYSCALLS,
+		B_SYSCALL_INFO, &version, sizeof(version));
+	if (status != B_OK) {
+		fprintf(stderr, "%s: The scheduler statistics are not available on "
+			"this system.\n", __progname);
+		return 1;
+	}
+
+	if (argc == 1)
+		return print_cpu_statistics();
+
+	if (argc == 3 && !strcmp(argv[1], "-t"))
+		return print_trace(atoi(argv[2]));
+
+	usage();
+	return 1;
+}
@@ -0,0 +1,283 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Kernel slab allocator stress benchmark.
+
+	Writing "run [<iterations> [<object size>]]" to /dev/slab_benchmark runs
+	an increasing number of kernel threads (up to one per CPU) that allocate
+	and free objects of a shared object cache in bursts, so that both the
+	per-CPU magazines and the depot exchanges are exercised. Reading the
+	device returns the report of the last run, which is also written to the
+	syslog.
+*/
+
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include <Drivers.h>
+#include <KernelExport.h>
+
+#include <kernel.h>
+#include <slab/Slab.h>
+#include <smp.h>
+#include <thread.h>
+#include <util/AutoLock.h>
+
+
+int32 api_version = B_CUR_DRIVER_API_VERSION;
+
+static const char* sDeviceNames[] = {
+	"slab_benchmark",
+	NULL
+};
+
+static const int32 kBurstSize = 64;
+static const int32 kDefaultIterations = 1000000;
+static const size_t kDefaultObjectSize = 128;
+
+struct benchmark_thread {
+	object_cache*	cache;
+	int32			iterations;
+	sem_id			start;
+	bigtime_t		time;
+};
+
+static char sReport[4096];
+static size_t sReportLength;
+static mutex sLock = MUTEX_INITIALIZER("slab benchmark");
+
+
+static void
+report(const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	char line[256];
+	vsnprintf(line, sizeof(line), format, args);
+	va_end(args);
+
+	dprintf("slab_benchmark: %s", line);
+
+	size_t length = strlcpy(sReport + sReportLength, line,
+		sizeof(sReport) - sReportLength);
+	sReportLength = std::min(sReportLength + length, sizeof(sReport) - 1);
+}
+
+
+static status_t
+benchmark_thread_entry(void* _thread)
+{
+	benchmark_thread* thread = (benchmark_thread*)_thread;
+	void* objects[kBurstSize];
+
+	acquire_sem(thread->start);
+	bigtime_t startTime = system_time();
+
+	for (int32 i = 0; i < thread->iterations; i += kBurstSize) {
+		for (int32 j = 0; j < kBurstSize; j++) {
+			objects[j] = object_cache_alloc(thread->cache, 0);
+			if (objects[j] == NULL)
+				panic("slab_benchmark: out of memory");
+		}
+
+		for (int32 j = 0; j < kBurstSize; j++)
+			object_cache_free(thread->cache, objects[j], 0);
+	}
+
+	thread->time = system_time() - startTime;
+	return B_OK;
+}
+
+
+/*!	Runs \a threadCount threads allocating from \a cache, and returns the
+	achieved number of allocations per second.
+*/
+static uint64
+run_benchmark(object_cache* cache, int32 threadCount, int32 iterations)
+{
+	benchmark_thread threads[SMP_MAX_CPUS];
+	thread_id threadIDs[SMP_MAX_CPUS];
+
+	sem_id start = create_sem(0, "slab benchmark start");
+	if (start < 0)
+		return 0;
+
+	for (int32 i = 0; i < threadCount; i++) {
+		threads[i].cache = cache;
+		threads[i].iterations = iterations;
+		threads[i].start = start;
+		threads[i].time = 0;
+
+		threadIDs[i] = spawn_kernel_thread(&benchmark_thread_entry,
+			"slab benchmark", B_NORMAL_PRIORITY, &threads[i]);
+		resume_thread(threadIDs[i]);
+	}
+
+	release_sem_etc(start, threadCount, 0);
+
+	bigtime_t maxTime = 1;
+	for (int32 i = 0; i < threadCount; i++) {
+		status_t result;
+		wait_for_thread(threadIDs[i], &result);
+		maxTime = std::max(maxTime, threads[i].time);
+	}
+
+	delete_sem(start);
+
+	return (uint64)threadCount * iterations * 1000000 / maxTime;
+}
+
+
+static status_t
+run(int32 iterations, size_t objectSize)
+{
+	object_cache* cache = create_object_cache("slab benchmark", objectSize,
+		0, NULL, NULL, NULL);
+	if (cache == NULL)
+		return B_NO_MEMORY;
+
+	sReportLength = 0;
+	sReport[0] = '\0';
+
+	int32 cpuCount = smp_get_num_cpus();
+	report("%" B_PRId32 " CPUs, %" B_PRIuSIZE " byte objects, %" B_PRId32
+		" allocations per thread\n", cpuCount, objectSize, iterations);
+	report("%-8s %14s %14s\n", "threads", "allocs/sec", "per thread");
+
+	for (int32 threads = 1; threads <= cpuCount; threads++) {
+		uint64 rate = run_benchmark(cache, threads, iterations);
+		report("%-8" B_PRId32 " %14" B_PRIu64 " %14" B_PRIu64 "\n", threads,
+			rate, rate / threads);
+	}
+
+	delete_object_cache(cache);
+	return B_OK;
+}
+
+
+// #pragma mark - device hooks
+
+
+static status_t
+device_open(const char* name, uint32 openMode, void** _cookie)
+{
+	*_cookie = NULL;
+	return B_OK;
+}
+
+
+static status_t
+device_close(void* cookie)
+{
+	return B_OK;
+}
+
+
+static status_t
+device_free(void* cookie)
+{
+	return B_OK;
+}
+
+
+static status_t
+device_control(void* cookie, uint32 op, void* arg, size_t length)
+{
+	return B_BAD_VALUE;
+}
+
+
+static status_t
+device_read(void* cookie, off_t position, void* data, size_t* numBytes)
+{
+	MutexLocker locker(sLock);
+
+	if (position < 0 || (size_t)position >= sReportLength) {
+		*numBytes = 0;
+		return B_OK;
+	}
+
+	size_t length = std::min(*numBytes, sReportLength - (size_t)position);
+	if (user_memcpy(data, sReport + position, length) != B_OK)
+		return B_BAD_ADDRESS;
+
+	*numBytes = length;
+	return B_OK;
+}
+
+
+static status_t
+device_write(void* cookie, off_t position, const void* data, size_t* numBytes)
+{
+	char buffer[64];
+	size_t length = std::min(*numBytes, sizeof(buffer) - 1);
+	if (user_memcpy(buffer, data, length) != B_OK)
+		return B_BAD_ADDRESS;
+	buffer[length] = '\0';
+
+	char command[16];
+	int iterations = kDefaultIterations;
+	unsigned long objectSize = kDefaultObjectSize;
+	if (sscanf(buffer, "%15s %d %lu", command, &iterations, &objectSize) < 1
+		|| strcmp(command, "run") != 0 || iterations < kBurstSize
+		|| objectSize == 0) {
+		return B_BAD_VALUE;
+	}
+
+	MutexLocker locker(sLock);
+	return run(iterations, objectSize);
+}
+
+
+// #pragma mark - driver interface
+
+
+static device_hooks sDeviceHooks = {
+	device_open,
+	device_close,
+	device_free,
+	device_control,
+	device_read,
+	device_write
+};
+
+
+status_t
+init_hardware(void)
+{
+	return B_OK;
+}
+
+
+status_t
+init_driver(void)
+{
+	return B_OK;
+}
+
+
+void
+uninit_driver(void)
+{
+}
+
+
+const char**
+publish_devices(void)
+{
+	return sDeviceNames;
+}
+
+
+device_hooks*
+find_device(const char* name)
+{
+	return strcmp(name, sDeviceNames[0]) == 0 ? &sDeviceHooks : NULL;
+}
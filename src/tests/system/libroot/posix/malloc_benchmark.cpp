@@ -0,0 +1,350 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Compares the system allocator (the one libroot has been built with, or
+	malloc_debug when run with LD_PRELOAD=libroot_debug.so) against the slab
+	allocator under multi-threaded load.
+
+	Two workloads are measured for an increasing number of threads:
+	  local		every thread frees and allocates random sizes in a window of
+				live allocations
+	  handoff	pairs of threads pass allocations from a producer to a
+				consumer that frees them, like BMessages sent between loopers
+*/
+
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <OS.h>
+
+#include "heap.h"
+
+
+using namespace BPrivate;
+
+
+struct allocator {
+	const char*	name;
+	void*		(*allocate)(size_t size);
+	void		(*free)(void* address);
+	void		(*thread_init)();
+	void		(*thread_exit)();
+};
+
+struct thread_arguments {
+	const allocator* heap;
+	int32		index;
+	int32		iterations;
+	struct handoff_ring* ring;
+	sem_id		start;
+	bigtime_t	time;
+};
+
+static const int32 kRingSize = 1024;
+
+struct handoff_ring {
+	void*		slots[kRingSize];
+	int32		head;
+	int32		tail;
+};
+
+
+static const int32 kWindowSize = 256;
+
+
+static void*
+system_allocate(size_t size)
+{
+	return malloc(size);
+}
+
+
+static void
+system_free(void* address)
+{
+	free(address);
+}
+
+
+static void
+no_thread_hook()
+{
+}
+
+
+static const allocator kAllocators[] = {
+	{ "system", system_allocate, system_free, no_thread_hook,
+		no_thread_hook },
+	{ "slab", slab_heap_allocate, slab_heap_free, slab_heap_thread_init,
+		slab_heap_thread_exit },
+};
+static const int32 kAllocatorCount = sizeof(kAllocators) / sizeof(allocator);
+
+
+static inline uint32
+next_random(uint32& state)
+{
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+
+static inline size_t
+random_size(uint32& state)
+{
+	// mostly small allocations, with a tail of larger ones
+	uint32 value = next_random(state);
+	switch (value & 7) {
+		case 0:
+			return 1 + (value >> 8) % 4096;
+		case 1:
+		case 2:
+			return 1 + (value >> 8) % 512;
+		default:
+			return 1 + (value >> 8) % 128;
+	}
+}
+
+
+static status_t
+local_thread(void* _arguments)
+{
+	thread_arguments* arguments = (thread_arguments*)_arguments;
+	const allocator* heap = arguments->heap;
+	uint32 random = 0x9e3779b9 * (arguments->index + 1);
+
+	heap->thread_init();
+
+	void* window[kWindowSize];
+	memset(window, 0, sizeof(window));
+
+	acquire_sem(arguments->start);
+	bigtime_t startTime = system_time();
+
+	for (int32 i = 0; i < arguments->iterations; i++) {
+		uint32 slot = next_random(random) % kWindowSize;
+		heap->free(window[slot]);
+
+		size_t size = random_size(random);
+		window[slot] = heap->allocate(size);
+		if (window[slot] == NULL) {
+			fprintf(stderr, "%s: out of memory\n", heap->name);
+			exit(1);
+		}
+		*(uint8*)window[slot] = (uint8)size;
+	}
+
+	for (int32 i = 0; i < kWindowSize; i++)
+		heap->free(window[i]);
+
+	arguments->time = system_time() - startTime;
+	heap->thread_exit();
+	return B_OK;
+}
+
+
+static status_t
+producer_thread(void* _arguments)
+{
+	thread_arguments* arguments = (thread_arguments*)_arguments;
+	const allocator* heap = arguments->heap;
+	handoff_ring* ring = arguments->ring;
+	uint32 random = 0x9e3779b9 * (arguments->index + 1);
+
+	heap->thread_init();
+	acquire_sem(arguments->start);
+	bigtime_t startTime = system_time();
+
+	for (int32 i = 0; i < arguments->iterations; i++) {
+		size_t size = random_size(random);
+		void* message = heap->allocate(size);
+		if (message == NULL) {
+			fprintf(stderr, "%s: out of memory\n", heap->name);
+			exit(1);
+		}
+		*(uint8*)message = (uint8)size;
+
+		int32 head = ring->head;
+		while (head - atomic_get(&ring->tail) >= kRingSize)
+			snooze(10);
+		ring->slots[head % kRingSize] = message;
+		atomic_set(&ring->head, head + 1);
+	}
+
+	arguments->time = system_time() - startTime;
+	heap->thread_exit();
+	return B_OK;
+}
+
+
+static status_t
+consumer_thread(void* _arguments)
+{
+	thread_arguments* arguments = (thread_arguments*)_arguments;
+	const allocator* heap = arguments->heap;
+	handoff_ring* ring = arguments->ring;
+
+	heap->thread_init();
+	acquire_sem(arguments->start);
+	bigtime_t startTime = system_time();
+
+	for (int32 i = 0; i < arguments->iterations; i++) {
+		int32 tail = ring->tail;
+		while (atomic_get(&ring->head) == tail)
+			snooze(10);
+		heap->free(ring->slots[tail % kRingSize]);
+		atomic_set(&ring->tail, tail + 1);
+	}
+
+	arguments->time = system_time() - startTime;
+	heap->thread_exit();
+	return B_OK;
+}
+
+
+/*!	Runs the workload with \a threadCount threads, and returns the achieved
+	number of operations (an allocation and a free each) per second.
+*/
+static double
+run_workload(const allocator* heap, bool handoff, int32 threadCount,
+	int32 iterations)
+{
+	thread_arguments arguments[threadCount];
+	thread_id threads[threadCount];
+	handoff_ring* rings = NULL;
+	if (handoff) {
+		rings = (handoff_ring*)calloc(threadCount / 2, sizeof(handoff_ring));
+		if (rings == NULL)
+			return 0;
+	}
+
+	sem_id start = create_sem(0, "start benchmark");
+
+	for (int32 i = 0; i < threadCount; i++) {
+		arguments[i].heap = heap;
+		arguments[i].index = i;
+		arguments[i].iterations = iterations;
+		arguments[i].ring = handoff ? &rings[i / 2] : NULL;
+		arguments[i].start = start;
+		arguments[i].time = 0;
+
+		thread_func function = local_thread;
+		if (handoff)
+			function = (i & 1) == 0 ? producer_thread : consumer_thread;
+
+		threads[i] = spawn_thread(function, "malloc benchmark",
+			B_NORMAL_PRIORITY, &arguments[i]);
+		resume_thread(threads[i]);
+	}
+
+	release_sem_etc(start, threadCount, 0);
+
+	bigtime_t maxTime = 1;
+	for (int32 i = 0; i < threadCount; i++) {
+		status_t result;
+		wait_for_thread(threads[i], &result);
+		if (arguments[i].time > maxTime)
+			maxTime = arguments[i].time;
+	}
+
+	delete_sem(start);
+	free(rings);
+
+	int32 operations = handoff ? threadCount / 2 : threadCount;
+	return 1000000.0 * operations * iterations / maxTime;
+}
+
+
+static void
+usage()
+{
+	fprintf(stderr, "usage: malloc_benchmark [-t <max-threads>] "
+		"[-i <iterations>] [-a system|slab]\n");
+	exit(1);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	system_info info;
+	get_system_info(&info);
+
+	int32 maxThreads = info.cpu_count * 2;
+	int32 iterations = 1000000;
+	const char* only = NULL;
+
+	int option;
+	while ((option = getopt(argc, argv, "t:i:a:h")) != -1) {
+		switch (option) {
+			case 't':
+				maxThreads = atoi(optarg);
+				break;
+			case 'i':
+				iterations = atoi(optarg);
+				break;
+			case 'a':
+				only = optarg;
+				break;
+			default:
+				usage();
+		}
+	}
+
+	if (maxThreads < 1 || iterations < 1)
+		usage();
+
+	status_t status = slab_heap_init();
+	if (status != B_OK) {
+		fprintf(stderr, "Could not initialize the slab heap: %s\n",
+			strerror(status));
+		return 1;
+	}
+
+	printf("%" B_PRIu32 " CPUs, %" B_PRId32 " iterations per thread, "
+		"million operations per second\n\n", info.cpu_count, iterations);
+	printf("%-8s %-8s", "threads", "workload");
+	for (int32 i = 0; i < kAllocatorCount; i++) {
+		if (only == NULL || strcmp(only, kAllocators[i].name) == 0)
+			printf(" %10s", kAllocators[i].name);
+	}
+	putchar('\n');
+
+	for (int32 threads = 1; threads <= maxThreads; threads *= 2) {
+		for (int32 handoff = 0; handoff < 2; handoff++) {
+			int32 threadCount = handoff ? threads * 2 : threads;
+			printf("%-8" B_PRId32 " %-8s", threadCount,
+				handoff ? "handoff" : "local");
+			fflush(stdout);
+
+			for (int32 i = 0; i < kAllocatorCount; i++) {
+				if (only != NULL && strcmp(only, kAllocators[i].name) != 0)
+					continue;
+
+				double rate = run_workload(&kAllocators[i], handoff != 0,
+					threadCount, iterations);
+				printf(" %10.2f", rate / 1000000);
+				fflush(stdout);
+			}
+			putchar('\n');
+		}
+	}
+
+	slab_heap_stats stats;
+	slab_heap_get_stats(&stats);
+	printf("\nslab heap: arena %" B_PRIuSIZE " kB (%" B_PRIuSIZE " kB free), "
+		"%" B_PRIuSIZE " slabs, %" B_PRId64 " batches pushed, %" B_PRId64
+		" popped, %" B_PRId64 " slab refills\n", stats.arena_size / 1024,
+		stats.arena_free / 1024, stats.slab_count, stats.batches_pushed,
+		stats.batches_popped, stats.slab_refills);
+
+	return 0;
+}
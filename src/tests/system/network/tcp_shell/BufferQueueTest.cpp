@@ -140,6 +140,27 @@ main()
 	add(500, 1000);
 	dump("added data covered by next");
 
+	// SACK blocks: the block containing the most recently added data comes
+	// first, followed by the others from the highest sequence on down
+	BufferQueue sackQueue(32768);
+	sackQueue.SetInitialSequence(5000);
+	sackQueue.Add(create_filled_buffer(100), 5200);
+	sackQueue.Add(create_filled_buffer(100), 5400);
+	sackQueue.Add(create_filled_buffer(100), 5300);
+	sackQueue.Add(create_filled_buffer(100), 5700);
+	sackQueue.Add(create_filled_buffer(50), 5250);
+
+	tcp_sack sacks[MAX_SACK_BLKS];
+	int sackCount = sackQueue.PopulateSackInfo(5000, MAX_SACK_BLKS, sacks);
+	ASSERT(sackCount == 2);
+	ASSERT(ntohl(sacks[0].left_edge) == 5200
+		&& ntohl(sacks[0].right_edge) == 5500);
+	ASSERT(ntohl(sacks[1].left_edge) == 5700
+		&& ntohl(sacks[1].right_edge) == 5800);
+
+	sackCount = sackQueue.PopulateSackInfo(5000, 1, sacks);
+	ASSERT(sackCount == 1 && ntohl(sacks[0].left_edge) == 5200);
+
 	put_module(NET_BUFFER_MODULE_NAME);
 	return 0;
 }
@@ -11,6 +11,7 @@
 	// avoid including the private kernel debug.h header
 
 #include "argv.h"
+#include "CongestionControl.h"
 #include "tcp.h"
 #include "utility.h"
 
@@ -30,6 +31,8 @@
 
 #include <ctype.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <deque>
 #include <new>
 #include <set>
 #include <stdio.h>
@@ -41,6 +44,9 @@ struct context {
 	BLocker		lock;
 	sem_id		wait_sem;
 	struct list list;
+	deque<bigtime_t> due;
+		// delivery times of the buffers in the list
+	bigtime_t	link_busy_until;
 	net_route	route;
 	bool		server;
 	thread_id	thread;
@@ -89,6 +95,8 @@ static vint32 sPacketNumber = 1;
 static double sRandomDrop = 0.0;
 static set<uint32> sDropList;
 static bigtime_t sRoundTripTime = 0;
+static uint32 sBandwidth = 0;
+	// in bytes per second, 0 means unlimited
 static bool sIncreasingRoundTrip = false;
 static bool sRandomRoundTrip = false;
 static bool sTCPDump = true;
@@ -98,6 +106,9 @@ static set<uint32> sReorderList;
 static bool sSimultaneousConnect = false;
 static bool sSimultaneousClose = false;
 static bool sServerActiveClose = false;
+static bool sServerQuiet = false;
+static vint32 sServerReceived = 0;
+static vint32 sPacketsDropped = 0;
 
 static struct net_domain sDomain = {
 	"ipv4",
@@ -720,8 +731,33 @@ datalink_send_data(struct net_route *route, net_buffer *buffer)
 
 	buffer->interface = &gInterface;
 
+	// Emulate the link: a packet has to wait until the ones before it have
+	// been transmitted, and then takes half the round trip time to arrive.
+	bigtime_t delay = 0;
+	if (sRoundTripTime > 0 || sRandomRoundTrip || sIncreasingRoundTrip) {
+		if (sRandomRoundTrip)
+			delay = (bigtime_t)(1.0 * rand() / RAND_MAX * 500000) - 250000;
+		if (sIncreasingRoundTrip)
+			sRoundTripTime += (bigtime_t)(1.0 * rand() / RAND_MAX * 150000);
+
+		delay = max_c(sRoundTripTime / 2 + delay, 0);
+	}
+
 	context->lock.Lock();
+
+	bigtime_t now = system_time();
+	bigtime_t sent = max_c(now, context->link_busy_until);
+	if (sBandwidth > 0)
+		sent += 1000000LL * buffer->size / sBandwidth;
+	context->link_busy_until = sent;
+
+	// packets on a link don't overtake each other
+	bigtime_t due = sent + delay;
+	if (!context->due.empty() && due < context->due.back())
+		due = context->due.back();
+
 	list_add_item(&context->list, buffer);
+	context->due.push_back(due);
 	context->lock.Unlock();
 
 	release_sem(context->wait_sem);
@@ -919,17 +955,9 @@ domain_receive_data(net_buffer *buffer)
 
 	bool drop = false;
 	if (sDropList.find(packetNumber) != sDropList.end()
-		|| (sRandomDrop > 0.0 && (1.0 * rand() / RAND_MAX) > sRandomDrop))
+		|| (sRandomDrop > 0.0 && (1.0 * rand() / RAND_MAX) < sRandomDrop)) {
 		drop = true;
-
-	if (!drop && (sRoundTripTime > 0 || sRandomRoundTrip || sIncreasingRoundTrip)) {
-		bigtime_t add = 0;
-		if (sRandomRoundTrip)
-			add = (bigtime_t)(1.0 * rand() / RAND_MAX * 500000) - 250000;
-		if (sIncreasingRoundTrip)
-			sRoundTripTime += (bigtime_t)(1.0 * rand() / RAND_MAX * 150000);
-
-		snooze(sRoundTripTime / 2 + add);
+		atomic_add(&sPacketsDropped, 1);
 	}
 
 	if (sTCPDump) {
@@ -1006,6 +1034,23 @@ domain_receive_data(net_buffer *buffer)
 						printf(" <ts %lu:%lu>", option->timestamp.value, option->timestamp.reply);
 						length = 10;
 						break;
+					case TCP_OPTION_SACK_PERMITTED:
+						printf(" <sackOK>");
+						length = 2;
+						break;
+					case TCP_OPTION_SACK:
+					{
+						length = option->length;
+						int32 count = (length - 2) / sizeof(tcp_sack);
+						for (int32 i = 0; i < count; i++) {
+							printf(" <sack %lu-%lu>",
+								ntohl(option->sack[i].left_edge),
+								ntohl(option->sack[i].right_edge));
+						}
+						if (length == 0)
+							size = 0;
+						break;
+					}
 
 					default:
 						length = option->length;
@@ -1096,20 +1141,30 @@ receiving_thread(void* _data)
 {
 	struct context* context = (struct context*)_data;
 	struct net_buffer* reorderBuffer = NULL;
+	bigtime_t nextDue = B_INFINITE_TIMEOUT;
 
 	while (true) {
 		status_t status;
 		do {
-			status = acquire_sem(context->wait_sem);
+			status = acquire_sem_etc(context->wait_sem, 1, B_ABSOLUTE_TIMEOUT,
+				nextDue);
 		} while (status == B_INTERRUPTED);
 
-		if (status < B_OK)
+		if (status < B_OK && status != B_TIMED_OUT)
 			break;
 
 		while (true) {
+			// only deliver the packets that have crossed the link already
 			context->lock.Lock();
-			net_buffer* buffer = (net_buffer*)list_remove_head_item(
-				&context->list);
+			net_buffer* buffer = NULL;
+			nextDue = B_INFINITE_TIMEOUT;
+			if (!context->due.empty()) {
+				if (context->due.front() <= system_time()) {
+					buffer = (net_buffer*)list_remove_head_item(&context->list);
+					context->due.pop_front();
+				} else
+					nextDue = context->due.front();
+			}
 			context->lock.Unlock();
 
 			if (buffer == NULL)
@@ -1134,10 +1189,10 @@ receiving_thread(void* _data)
 				close_protocol(gClientSocket->first_protocol);
 				sSimultaneousClose = false;
 			}
-			if ((sRandomReorder > 0.0
-					|| sReorderList.find(sPacketNumber) != sReorderList.end())
-				&& reorderBuffer == NULL
-				&& (1.0 * rand() / RAND_MAX) > sRandomReorder) {
+			if (reorderBuffer == NULL
+				&& (sReorderList.find(sPacketNumber) != sReorderList.end()
+					|| (sRandomReorder > 0.0
+						&& (1.0 * rand() / RAND_MAX) < sRandomReorder))) {
 				reorderBuffer = buffer;
 			} else {
 				if (sDomain.module->receive_data(buffer) < B_OK)
@@ -1177,6 +1232,11 @@ server_thread(void*)
 		ssize_t bytesRead;
 		while ((bytesRead = socket_recv(connectionSocket, buffer,
 				sizeof(buffer), 0)) > 0) {
+			if (sServerQuiet) {
+				atomic_add(&sServerReceived, bytesRead);
+				continue;
+			}
+
 			printf("server: received %ld bytes\n", bytesRead);
 
 			if (sServerActiveClose) {
@@ -1237,6 +1297,7 @@ void
 setup_context(struct context& context, bool server)
 {
 	list_init(&context.list);
+	context.link_busy_until = 0;
 	context.route.interface = &gInterface;
 	context.route.gateway = (sockaddr *)&context;
 		// backpointer to the context
@@ -1362,6 +1423,169 @@ do_send(int argc, char** argv)
 }
 
 
+static size_t
+parse_size(const char* string, size_t defaultSize)
+{
+	if (string == NULL)
+		return defaultSize;
+
+	char *unit;
+	size_t size = strtoul(string, &unit, 0);
+	if (unit != NULL && (unit[0] == 'k' || unit[0] == 'K'))
+		size *= 1024;
+	else if (unit != NULL && (unit[0] == 'm' || unit[0] == 'M'))
+		size *= 1024 * 1024;
+
+	return size;
+}
+
+
+/*!	Sends \a size bytes from the client to the server with packet dumping
+	turned off, and measures how long it takes until the server received all
+	of it. Returns the number of bytes that arrived.
+*/
+static size_t
+measure_goodput(size_t size, bigtime_t& _elapsed, int32& _packets)
+{
+	const size_t kChunkSize = 65536;
+	char *buffer = (char *)malloc(kChunkSize);
+	if (buffer == NULL) {
+		fprintf(stderr, "not enough memory!\n");
+		return 0;
+	}
+	for (uint32 i = 0; i < kChunkSize; i++)
+		buffer[i] = (char)(i & 0xff);
+
+	bool tcpDump = sTCPDump;
+	sTCPDump = false;
+	sServerQuiet = true;
+	sServerReceived = 0;
+	sPacketsDropped = 0;
+	int32 firstPacket = sPacketNumber;
+	bigtime_t start = system_time();
+
+	for (size_t sent = 0; sent < size;) {
+		size_t chunk = min_c(kChunkSize, size - sent);
+		ssize_t bytesWritten = socket_send(gClientSocket, buffer, chunk, 0);
+		if (bytesWritten < B_OK) {
+			fprintf(stderr, "failed sending buffer: %s\n",
+				strerror(bytesWritten));
+			break;
+		}
+		sent += bytesWritten;
+	}
+
+	// wait for the server to receive everything, but give up when nothing
+	// arrives for a while
+	int32 received = 0;
+	bigtime_t lastProgress = system_time();
+	while ((size_t)(received = atomic_get(&sServerReceived)) < size) {
+		snooze(10000);
+		if (atomic_get(&sServerReceived) != received)
+			lastProgress = system_time();
+		else if (system_time() - lastProgress > 10000000LL)
+			break;
+	}
+
+	_elapsed = max_c(system_time() - start, 1);
+	_packets = sPacketNumber - firstPacket;
+
+	sServerQuiet = false;
+	sTCPDump = tcpDump;
+	free(buffer);
+
+	return received;
+}
+
+
+/*!	Measures the goodput of a bulk transfer from the client to the server.
+	Use together with "drop -r", "reorder -r", "rtt", and "bandwidth" to see
+	how well loss recovery and congestion control cope.
+*/
+static void
+do_goodput(int argc, char** argv)
+{
+	size_t size = parse_size(argc > 1 ? argv[1] : NULL, 4 * 1024 * 1024);
+	if (size == 0) {
+		fprintf(stderr, "invalid size!\n");
+		return;
+	}
+
+	bigtime_t elapsed;
+	int32 packets;
+	size_t received = measure_goodput(size, elapsed, packets);
+
+	printf("%lu of %lu bytes in %g s: %g KB/s, %ld packets, %ld dropped\n",
+		received, size, elapsed / 1000000.0,
+		received * 1000000.0 / elapsed / 1024, packets,
+		(int32)sPacketsDropped);
+}
+
+
+static void
+do_congestion_control(int argc, char** argv)
+{
+	if (argc > 1) {
+		status_t status = gTCPModule->setsockopt(gClientSocket->first_protocol,
+			IPPROTO_TCP, TCP_CONGESTION, argv[1], strlen(argv[1]));
+		if (status != B_OK) {
+			fprintf(stderr, "cannot use \"%s\": %s\n", argv[1],
+				strerror(status));
+		}
+	}
+
+	char name[TCP_CA_NAME_MAX];
+	int length = sizeof(name);
+	if (gTCPModule->getsockopt(gClientSocket->first_protocol, IPPROTO_TCP,
+			TCP_CONGESTION, name, &length) == B_OK)
+		printf("client congestion control: %s\n", name);
+
+	printf("available:");
+	for (int32 i = 0; CongestionControl::NameAt(i) != NULL; i++)
+		printf(" %s", CongestionControl::NameAt(i));
+	putchar('\n');
+}
+
+
+/*!	Runs the same bulk transfer with every congestion control algorithm over
+	the current link settings, and reports the goodput of each.
+*/
+static void
+do_compare(int argc, char** argv)
+{
+	size_t size = parse_size(argc > 1 ? argv[1] : NULL, 4 * 1024 * 1024);
+	if (size == 0) {
+		fprintf(stderr, "invalid size!\n");
+		return;
+	}
+
+	printf("rtt %g ms, bandwidth %lu KB/s, drop %g, reorder %g\n",
+		sRoundTripTime / 1000.0, sBandwidth / 1024, sRandomDrop,
+		sRandomReorder);
+	printf("%-10s %10s %12s %10s %10s\n", "algorithm", "time (s)", "KB/s",
+		"packets", "dropped");
+
+	for (int32 i = 0; CongestionControl::NameAt(i) != NULL; i++) {
+		const char* name = CongestionControl::NameAt(i);
+		status_t status = gTCPModule->setsockopt(gClientSocket->first_protocol,
+			IPPROTO_TCP, TCP_CONGESTION, name, strlen(name));
+		if (status != B_OK) {
+			fprintf(stderr, "cannot use \"%s\": %s\n", name, strerror(status));
+			continue;
+		}
+
+		bigtime_t elapsed;
+		int32 packets;
+		size_t received = measure_goodput(size, elapsed, packets);
+
+		printf("%-10s %10.3f %12.1f %10ld %10ld%s\n", name,
+			elapsed / 1000000.0, received * 1000000.0 / elapsed / 1024,
+			packets, (int32)sPacketsDropped,
+			received < size ? " (incomplete)" : "");
+	}
+}
+
+
 static void
 do_close(int argc, char** argv)
 {
@@ -1529,6 +1753,25 @@ do_round_trip_time(int argc, char** argv)
 }
 
 
+static void
+do_bandwidth(int argc, char** argv)
+{
+	if (argc > 1 && isdigit(argv[1][0]))
+		sBandwidth = parse_size(argv[1], 0);
+	else if (argc > 1) {
+		puts("usage: bandwidth [<bytes per second>[k|m]]\n\n"
+			"A bandwidth of 0 means unlimited; without any arguments, the\n"
+			"current bandwidth is printed.");
+		return;
+	}
+
+	if (sBandwidth == 0)
+		puts("Bandwidth is unlimited.");
+	else
+		printf("Bandwidth is %lu KB/s.\n", sBandwidth / 1024);
+}
+
+
 static void
 do_dprintf(int argc, char** argv)
 {
@@ -1544,6 +1787,10 @@ do_dprintf(int argc, char** argv)
 static cmd_entry sBuiltinCommands[] = {
 	{"connect", do_connect, "Connects the client"},
 	{"send", do_send, "Sends data from the client to the server"},
+	{"goodput", do_goodput, "Measures the goodput of a bulk transfer"},
+	{"cc", do_congestion_control, "Selects the client's congestion control"},
+	{"compare", do_compare, "Compares the congestion control algorithms"},
+	{"bandwidth", do_bandwidth, "Limits the bandwidth of the link"},
 	{"close", do_close, "Performs an active or simultaneous close"},
 	{"dprintf", do_dprintf, "Toggles debug output"},
 	{"drop", do_drop, "Lets you drop packets during transfer"},
@@ -14,13 +14,14 @@
 #include "fssh_kernel_export.h"
 #include "fssh_lock.h"
 #include "fssh_string.h"
+#include "fssh_uio.h"
 #include "fssh_unistd.h"
 #include "hash.h"
 #include "vfs.h"
 
 // TODO: this is a naive but growing implementation to test the API:
-//	1) block reading/writing is not at all optimized for speed, it will
-//	   just read and write single blocks.
+//	1) block reading is not at all optimized for speed, it will just read
+//	   single blocks.
 //	2) the locking could be improved; getting a block should not need to
 //	   wait for blocks to be written
 // TODO: the retrieval/copy of the original data could be delayed until the
@@ -163,11 +164,35 @@ struct cache_transaction {
 };
 
 
+class BlockWriter {
+public:
+								BlockWriter(block_cache* cache);
+								~BlockWriter();
+
+			bool				Add(cached_block* block);
+			fssh_status_t		Write(bool deleteTransaction = true);
+
+private:
+	static	int					_CompareBlocks(const void* _blockA,
+									const void* _blockB);
+
+private:
+	static	const int32_t		kMaxRunBlocks = 64;
+
+			block_cache*		fCache;
+			cached_block**		fBlocks;
+			int32_t				fCount;
+			int32_t				fCapacity;
+};
+
+
 static fssh_status_t write_cached_block(block_cache* cache, cached_block* block,
 	bool deleteTransaction = true);
 
 
 static fssh_mutex sNotificationsLock;
+static uint64_t sWriteRequests;
+static uint64_t sWrittenBlocks;
 
 
 //	#pragma mark - notifications/listener
@@ -885,29 +910,24 @@ get_writable_cached_block(block_cache* cache, fssh_off_t blockNumber, fssh_off_t
 	delete transactions when they are no longer used, and \a deleteTransaction
 	is \c true.
 */
-static fssh_status_t
-write_cached_block(block_cache* cache, cached_block* block,
-	bool deleteTransaction)
+static void*
+written_data(cached_block* block)
 {
-	cache_transaction* previous = block->previous_transaction;
-	int32_t blockSize = cache->block_size;
-
-	void* data = previous && block->original_data
+	return block->previous_transaction && block->original_data
 		? block->original_data : block->current_data;
 		// we first need to write back changes from previous transactions
+}
 
-	TRACE(("write_cached_block(block %Ld)\n", block->block_number));
-
-	fssh_ssize_t written = fssh_write_pos(cache->fd, block->block_number * blockSize,
-		data, blockSize);
 
-	if (written < blockSize) {
-		FATAL(("could not write back block %" FSSH_B_PRIdOFF " (%s)\n",
-			block->block_number, fssh_strerror(fssh_get_errno())));
-		return FSSH_B_IO_ERROR;
-	}
+/*!	Updates the state of \a block after its data has been written back, see
+	write_cached_block().
+*/
+static void
+block_written(block_cache* cache, cached_block* block, bool deleteTransaction)
+{
+	cache_transaction* previous = block->previous_transaction;
 
-	if (data == block->current_data)
+	if (written_data(block) == block->current_data)
 		block->is_dirty = false;
 
 	if (previous != NULL) {
@@ -938,11 +958,144 @@ write_cached_block(block_cache* cache, cached_block* block,
 		block->unused = true;
 		cache->unused_blocks.Add(block);
 	}
+}
+
 
+static fssh_status_t
+write_cached_block(block_cache* cache, cached_block* block,
+	bool deleteTransaction)
+{
+	int32_t blockSize = cache->block_size;
+
+	TRACE(("write_cached_block(block %Ld)\n", block->block_number));
+
+	fssh_ssize_t written = fssh_write_pos(cache->fd,
+		block->block_number * blockSize, written_data(block), blockSize);
+	sWriteRequests++;
+
+	if (written < blockSize) {
+		FATAL(("could not write back block %" FSSH_B_PRIdOFF " (%s)\n",
+			block->block_number, fssh_strerror(fssh_get_errno())));
+		return FSSH_B_IO_ERROR;
+	}
+
+	sWrittenBlocks++;
+	block_written(cache, block, deleteTransaction);
 	return FSSH_B_OK;
 }
 
 
+//	#pragma mark - BlockWriter
+
+
+BlockWriter::BlockWriter(block_cache* cache)
+	:
+	fCache(cache),
+	fBlocks(NULL),
+	fCount(0),
+	fCapacity(0)
+{
+}
+
+
+BlockWriter::~BlockWriter()
+{
+	free(fBlocks);
+}
+
+
+/*!	Adds the specified block to the to be written array. Returns false if
+	the array could not be enlarged.
+*/
+bool
+BlockWriter::Add(cached_block* block)
+{
+	if (fCount == fCapacity) {
+		int32_t newCapacity = fCapacity > 0 ? fCapacity * 2 : 256;
+		cached_block** newBlocks = (cached_block**)realloc(fBlocks,
+			newCapacity * sizeof(cached_block*));
+		if (newBlocks == NULL)
+			return false;
+
+		fBlocks = newBlocks;
+		fCapacity = newCapacity;
+	}
+
+	fBlocks[fCount++] = block;
+	return true;
+}
+
+
+/*!	Writes back all blocks that have been added, in their on-disk order.
+	Contiguous blocks are combined into a single write request.
+*/
+fssh_status_t
+BlockWriter::Write(bool deleteTransaction)
+{
+	qsort(fBlocks, fCount, sizeof(cached_block*), &_CompareBlocks);
+
+	fssh_size_t blockSize = fCache->block_size;
+	fssh_iovec vecs[kMaxRunBlocks];
+
+	for (int32_t first = 0; first < fCount;) {
+		int32_t count = 1;
+		while (first + count < fCount && count < kMaxRunBlocks
+			&& fBlocks[first + count]->block_number
+				== fBlocks[first + count - 1]->block_number + 1) {
+			count++;
+		}
+
+		for (int32_t i = 0; i < count; i++) {
+			vecs[i].iov_base = written_data(fBlocks[first + i]);
+			vecs[i].iov_len = blockSize;
+		}
+
+		TRACE(("BlockWriter::Write(blocks %Ld - %Ld)\n",
+			fBlocks[first]->block_number,
+			fBlocks[first + count - 1]->block_number));
+
+		fssh_ssize_t written = fssh_writev_pos(fCache->fd,
+			fBlocks[first]->block_number * blockSize, vecs, count);
+		sWriteRequests++;
+
+		if (written < (fssh_ssize_t)(count * blockSize)) {
+			FATAL(("could not write back blocks %" FSSH_B_PRIdOFF " - %"
+				FSSH_B_PRIdOFF " (%s)\n", fBlocks[first]->block_number,
+				fBlocks[first + count - 1]->block_number,
+				fssh_strerror(fssh_get_errno())));
+			fCount = 0;
+			return FSSH_B_IO_ERROR;
+		}
+
+		sWrittenBlocks += count;
+		for (int32_t i = 0; i < count; i++)
+			block_written(fCache, fBlocks[first + i], deleteTransaction);
+
+		first += count;
+	}
+
+	fCount = 0;
+	return FSSH_B_OK;
+}
+
+
+/*static*/ int
+BlockWriter::_CompareBlocks(const void* _blockA, const void* _blockB)
+{
+	cached_block* blockA = *(cached_block**)_blockA;
+	cached_block* blockB = *(cached_block**)_blockB;
+
+	fssh_off_t diff = blockA->block_number - blockB->block_number;
+	if (diff > 0)
+		return 1;
+
+	return diff < 0 ? -1 : 0;
+}
+
+
+//	#pragma mark -
+
+
 /*!	Waits until all pending notifications are carried out.
 	Safe to be called from the block writer/notifier thread.
 	You must not hold the \a cache lock when calling this function.
@@ -962,6 +1115,20 @@ block_cache_init()
 }
 
 
+/*!	Returns the number of write requests the block caches issued to their
+	devices, and the number of blocks written with them, since the last call.
+*/
+void
+block_cache_get_write_statistics(uint64_t* _requests, uint64_t* _blocks)
+{
+	*_requests = sWriteRequests;
+	*_blocks = sWrittenBlocks;
+
+	sWriteRequests = 0;
+	sWrittenBlocks = 0;
+}
+
+
 }	// namespace FSShell
 
 
@@ -1002,10 +1169,10 @@ fssh_cache_sync_transaction(void* _cache, int32_t id)
 {
 	block_cache* cache = (block_cache*)_cache;
 	MutexLocker locker(&cache->lock);
-	fssh_status_t status = FSSH_B_ENTRY_NOT_FOUND;
 
 	TRACE(("cache_sync_transaction(id %d)\n", id));
 
+	BlockWriter writer(cache);
 	hash_iterator iterator;
 	hash_open(cache->transaction_hash, &iterator);
 
@@ -1016,13 +1183,28 @@ fssh_cache_sync_transaction(void* _cache, int32_t id)
 
 		if (transaction->id <= id && !transaction->open) {
 			// write back all of their remaining dirty blocks
-			while (transaction->num_blocks > 0) {
-				status = write_cached_block(cache, transaction->blocks.Head(),
-					false);
-				if (status != FSSH_B_OK)
-					return status;
+			block_list::Iterator blockIterator
+				= transaction->blocks.GetIterator();
+			while (cached_block* block = blockIterator.Next()) {
+				if (!writer.Add(block)) {
+					hash_close(cache->transaction_hash, &iterator, false);
+					return FSSH_B_NO_MEMORY;
+				}
 			}
+		}
+	}
 
+	hash_close(cache->transaction_hash, &iterator, false);
+
+	fssh_status_t status = writer.Write(false);
+	if (status != FSSH_B_OK)
+		return status;
+
+	hash_open(cache->transaction_hash, &iterator);
+
+	while ((transaction = (cache_transaction*)hash_next(
+			cache->transaction_hash, &iterator)) != NULL) {
+		if (transaction->id <= id && !transaction->open) {
 			hash_remove_current(cache->transaction_hash, &iterator);
 			delete_transaction(cache, transaction);
 		}
@@ -1542,21 +1724,22 @@ fssh_block_cache_sync(void* _cache)
 	// transaction or no transaction only
 
 	MutexLocker locker(&cache->lock);
+	BlockWriter writer(cache);
 	hash_iterator iterator;
 	hash_open(cache->hash, &iterator);
 
 	cached_block* block;
 	while ((block = (cached_block*)hash_next(cache->hash, &iterator)) != NULL) {
-		if (block->previous_transaction != NULL
-			|| (block->transaction == NULL && block->is_dirty)) {
-			fssh_status_t status = write_cached_block(cache, block);
-			if (status != FSSH_B_OK)
-				return status;
+		if ((block->previous_transaction != NULL
+				|| (block->transaction == NULL && block->is_dirty))
+			&& !writer.Add(block)) {
+			hash_close(cache->hash, &iterator, false);
+			return FSSH_B_NO_MEMORY;
 		}
 	}
 
 	hash_close(cache->hash, &iterator, false);
-	return FSSH_B_OK;
+	return writer.Write();
 }
 
 
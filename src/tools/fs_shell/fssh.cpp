@@ -25,6 +25,7 @@
 #include "fssh_errno.h"
 #include "fssh_errors.h"
 #include "fssh_fs_info.h"
+#include "fssh_fs_query.h"
 #include "fssh_fcntl.h"
 #include "fssh_module.h"
 #include "fssh_node_monitor.h"
@@ -1139,12 +1140,20 @@ command_mv(int argc, const char* const* argv)
 static fssh_status_t
 command_query(int argc, const char* const* argv)
 {
-	if (argc != 2) {
-		fprintf(stderr, "Usage: %s <query string>\n", argv[0]);
+	uint32_t flags = 0;
+	int argi = 1;
+	if (argc == 3 && strcmp(argv[1], "-e") == 0) {
+		flags |= FSSH_B_QUERY_EXPLAIN;
+		argi++;
+	}
+
+	if (argi != argc - 1) {
+		fprintf(stderr, "Usage: %s [ -e ] <query string>\n"
+			"  -e  - print the query plan of the file system\n", argv[0]);
 		return FSSH_B_BAD_VALUE;
 	}
 
-	const char* query = argv[1];
+	const char* query = argv[argi];
 
 	// get the volume ID
 	fssh_dev_t volumeID = get_volume_id();
@@ -1152,7 +1161,8 @@ command_query(int argc, const char* const* argv)
 		return volumeID;
 
 	// open query
-	int fd = _kern_open_query(volumeID, query, strlen(query), 0, -1, -1);
+	int fd = _kern_open_query(volumeID, query, strlen(query), flags, -1,
+		-1);
 	if (fd < 0) {
 		fprintf(stderr, "Error: Failed to open query: %s\n", fssh_strerror(fd));
 		return fd;
@@ -1261,6 +1271,30 @@ command_sync(int argc, const char* const* argv)
 }
 
 
+static fssh_status_t
+command_iostat(int argc, const char* const* argv)
+{
+	if (argc != 1) {
+		fprintf(stderr, "Usage: %s\n", argv[0]);
+		return FSSH_B_BAD_VALUE;
+	}
+
+	uint64_t requests;
+	uint64_t blocks;
+	block_cache_get_write_statistics(&requests, &blocks);
+
+	printf("block cache writes since last call:\n");
+	printf("  write requests: %" FSSH_B_PRIu64 "\n", requests);
+	printf("  blocks written: %" FSSH_B_PRIu64 "\n", blocks);
+	if (requests > 0) {
+		printf("  blocks/request: %" FSSH_B_PRIu64 ".%02" FSSH_B_PRIu64 "\n",
+			blocks / requests, blocks * 100 / requests % 100);
+	}
+
+	return FSSH_B_OK;
+}
+
+
 static fssh_status_t
 command_ioctl(int argc, const char* const* argv)
 {
@@ -1297,6 +1331,7 @@ register_commands()
 		command_help,		"help",			"list supported commands",
 		command_info,		"info",			"prints volume informations",
 		command_ioctl,		"ioctl",		"ioctl() on root, for FS debugging only",
+		command_iostat,		"iostat",		"prints block cache write statistics",
 		command_ln,			"ln",			"create a hard or symbolic link",
 		command_ls,			"ls",			"list files or directories",
 		command_mkdir,		"mkdir",		"create directories",
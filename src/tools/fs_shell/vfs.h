@@ -113,6 +113,9 @@ fssh_status_t	resolve_mount_point_to_volume_root(fssh_mount_id mountID,
 extern fssh_status_t block_cache_init();
 extern fssh_status_t file_cache_init();
 
+extern void block_cache_get_write_statistics(uint64_t* _requests,
+	uint64_t* _blocks);
+
 }	// namespace FSShell
 
 
@@ -0,0 +1,612 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <package/hpkg/PackageContentHandler.h>
+#include <package/hpkg/PackageReaderImpl.h>
+#include <package/hpkg/PackageTOCCacheReader.h>
+#include <package/hpkg/PackageTOCCacheWriter.h>
+#include <package/hpkg/StandardErrorOutput.h>
+#include <package/PackagesDirectoryDefs.h>
+
+
+using namespace BPackageKit::BHPKG;
+using BPackageKit::BHPKG::BPrivate::PackageReaderImpl;
+using BPackageKit::BHPKG::BPrivate::PackageTOCCacheReader;
+using BPackageKit::BHPKG::BPrivate::PackageTOCCacheWriter;
+using BPackageKit::BHPKG::BPrivate::package_toc_cache_package;
+
+
+extern const char* __progname;
+const char* kCommandName = __progname;
+
+
+static const char* kUsage =
+	"Usage: %s <command> <command args>\n"
+	"Creates or inspects the package TOC cache packagefs uses to mount a\n"
+	"packages directory without parsing every package file.\n"
+	"If <cache> is omitted, the cache file in the packages directory's\n"
+	"administrative directory is used.\n"
+	"\n"
+	"Commands:\n"
+	"  build [ <options> ] <packages-dir> [ <cache> ]\n"
+	"    Creates the cache for all packages in <packages-dir>.\n"
+	"\n"
+	"    -n         - Don't record node IDs. Allows copying the packages\n"
+	"                 (e.g. onto an image) without invalidating the cache.\n"
+	"    -u         - Update: Take the content of unchanged packages from\n"
+	"                 the existing cache instead of parsing them.\n"
+	"\n"
+	"  verify <packages-dir> [ <cache> ]\n"
+	"    Checks that the cache is up to date and that its content matches\n"
+	"    the content of the package files.\n"
+	"\n"
+	"  time [ <options> ] <packages-dir> [ <cache> ]\n"
+	"    Compares the time needed to read the packages' content from the\n"
+	"    package files and from the cache.\n"
+	"\n"
+	"    -r <count> - Repeat the measurement <count> times (default: 5).\n"
+	"\n"
+	"Common Options:\n"
+	"  -h, --help   - Print this usage info.\n"
+;
+
+
+typedef std::vector<std::string> StringList;
+
+
+class NullContentHandler : public BPackageContentHandler {
+public:
+	virtual status_t HandleEntry(BPackageEntry* entry)
+	{
+		return B_OK;
+	}
+
+	virtual status_t HandleEntryAttribute(BPackageEntry* entry,
+		BPackageEntryAttribute* attribute)
+	{
+		return B_OK;
+	}
+
+	virtual status_t HandleEntryDone(BPackageEntry* entry)
+	{
+		return B_OK;
+	}
+
+	virtual status_t HandlePackageAttribute(
+		const BPackageInfoAttributeValue& value)
+	{
+		return B_OK;
+	}
+
+	virtual void HandleErrorOccurred()
+	{
+	}
+};
+
+
+static void
+print_usage_and_exit(bool error)
+{
+	fprintf(error ? stderr : stdout, kUsage, kCommandName);
+	exit(error ? 1 : 0);
+}
+
+
+static bigtime_t
+current_time()
+{
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return (bigtime_t)time.tv_sec * 1000000 + time.tv_nsec / 1000;
+}
+
+
+static std::string
+default_cache_path(const char* packagesDirectory)
+{
+	return std::string(packagesDirectory) + "/"
+		PACKAGES_DIRECTORY_ADMIN_DIRECTORY "/"
+		PACKAGES_DIRECTORY_TOC_CACHE_FILE;
+}
+
+
+static void
+parse_common_arguments(int argc, const char* const* argv,
+	const char*& _packagesDirectory, std::string& _cachePath)
+{
+	// optind is the index of the first non-option argument
+	if (optind >= argc || argc - optind > 2)
+		print_usage_and_exit(true);
+
+	_packagesDirectory = argv[optind];
+	_cachePath = optind + 1 < argc
+		? std::string(argv[optind + 1])
+		: default_cache_path(_packagesDirectory);
+}
+
+
+static int
+open_packages_directory(const char* path)
+{
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		fprintf(stderr, "Error: Failed to open packages directory \"%s\": "
+			"%s\n", path, strerror(errno));
+		exit(1);
+	}
+	return fd;
+}
+
+
+static void
+get_package_file_names(const char* path, StringList& _names)
+{
+	DIR* dir = opendir(path);
+	if (dir == NULL) {
+		fprintf(stderr, "Error: Failed to open packages directory \"%s\": "
+			"%s\n", path, strerror(errno));
+		exit(1);
+	}
+
+	while (dirent* entry = readdir(dir)) {
+		size_t length = strlen(entry->d_name);
+		if (length > 5
+			&& strcmp(entry->d_name + length - 5, ".hpkg") == 0) {
+			_names.push_back(entry->d_name);
+		}
+	}
+
+	closedir(dir);
+	std::sort(_names.begin(), _names.end());
+}
+
+
+static status_t
+read_file(int fd, std::string& _data)
+{
+	struct stat st;
+	if (fstat(fd, &st) != 0)
+		return errno;
+
+	_data.resize(st.st_size);
+	if (st.st_size > 0) {
+		ssize_t bytesRead = pread(fd, &_data[0], st.st_size, 0);
+		if (bytesRead < 0)
+			return errno;
+		if (bytesRead != st.st_size)
+			return B_ERROR;
+	}
+	return B_OK;
+}
+
+
+static status_t
+finish_to_string(PackageTOCCacheWriter& writer, std::string& _data)
+{
+	FILE* file = tmpfile();
+	if (file == NULL)
+		return errno;
+
+	status_t error = writer.Finish(fileno(file));
+	if (error == B_OK)
+		error = read_file(fileno(file), _data);
+
+	fclose(file);
+	return error;
+}
+
+
+static int
+command_build(int argc, const char* const* argv)
+{
+	bool recordNodeIDs = true;
+	bool update = false;
+
+	while (true) {
+		static struct option sLongOptions[] = {
+			{ "help", no_argument, 0, 'h' },
+			{ 0, 0, 0, 0 }
+		};
+
+		opterr = 0; // don't print errors
+		int c = getopt_long(argc, (char**)argv, "+hnu", sLongOptions, NULL);
+		if (c == -1)
+			break;
+
+		switch (c) {
+			case 'h':
+				print_usage_and_exit(false);
+				break;
+
+			case 'n':
+				recordNodeIDs = false;
+				break;
+
+			case 'u':
+				update = true;
+				break;
+
+			default:
+				print_usage_and_exit(true);
+				break;
+		}
+	}
+
+	const char* packagesDirectory;
+	std::string cachePath;
+	parse_common_arguments(argc, argv, packagesDirectory, cachePath);
+
+	BStandardErrorOutput errorOutput;
+
+	// read the previous cache, if requested and possible
+	PackageTOCCacheReader previousCache(&errorOutput);
+	bool havePreviousCache = false;
+	if (update) {
+		int fd = open(cachePath.c_str(), O_RDONLY);
+		if (fd >= 0) {
+			status_t error = previousCache.Init(fd);
+			if (error == B_OK) {
+				havePreviousCache = true;
+			} else {
+				fprintf(stderr, "Warning: Ignoring the existing cache: %s\n",
+					strerror(error));
+			}
+			close(fd);
+		}
+	}
+
+	PackageTOCCacheWriter writer(&errorOutput);
+	writer.SetRecordNodeIDs(recordNodeIDs);
+	status_t error = writer.Init(havePreviousCache ? &previousCache : NULL);
+	if (error != B_OK) {
+		fprintf(stderr, "Error: Failed to init the cache writer: %s\n",
+			strerror(error));
+		return 1;
+	}
+
+	// add the packages
+	StringList fileNames;
+	get_package_file_names(packagesDirectory, fileNames);
+
+	int directoryFD = open_packages_directory(packagesDirectory);
+	for (size_t i = 0; i < fileNames.size(); i++) {
+		error = writer.AddPackage(directoryFD, fileNames[i].c_str());
+		if (error != B_OK) {
+			fprintf(stderr, "Error: Failed to add package \"%s\": %s\n",
+				fileNames[i].c_str(), strerror(error));
+			return 1;
+		}
+	}
+	close(directoryFD);
+
+	if (havePreviousCache && !writer.HasChanges()) {
+		printf("The cache is up to date.\n");
+		return 0;
+	}
+
+	// write the cache to a temporary file and move it into place
+	std::string tempPath = cachePath + ".tmp";
+	int fd = open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		fprintf(stderr, "Error: Failed to create \"%s\": %s\n",
+			tempPath.c_str(), strerror(errno));
+		return 1;
+	}
+
+	error = writer.Finish(fd);
+	close(fd);
+	if (error == B_OK && rename(tempPath.c_str(), cachePath.c_str()) != 0)
+		error = errno;
+	if (error != B_OK) {
+		fprintf(stderr, "Error: Failed to write \"%s\": %s\n",
+			cachePath.c_str(), strerror(error));
+		unlink(tempPath.c_str());
+		return 1;
+	}
+
+	printf("Wrote the cache for %" B_PRId32 " packages (%" B_PRId32
+		" reused).\n", writer.CountPackages(), writer.CountReusedPackages());
+	return 0;
+}
+
+
+static int
+command_verify(int argc, const char* const* argv)
+{
+	while (true) {
+		static struct option sLongOptions[] = {
+			{ "help", no_argument, 0, 'h' },
+			{ 0, 0, 0, 0 }
+		};
+
+		opterr = 0; // don't print errors
+		int c = getopt_long(argc, (char**)argv, "+h", sLongOptions, NULL);
+		if (c == -1)
+			break;
+
+		switch (c) {
+			case 'h':
+				print_usage_and_exit(false);
+				break;
+
+			default:
+				print_usage_and_exit(true);
+				break;
+		}
+	}
+
+	const char* packagesDirectory;
+	std::string cachePath;
+	parse_common_arguments(argc, argv, packagesDirectory, cachePath);
+
+	BStandardErrorOutput errorOutput;
+
+	int fd = open(cachePath.c_str(), O_RDONLY);
+	if (fd < 0) {
+		fprintf(stderr, "Error: Failed to open \"%s\": %s\n",
+			cachePath.c_str(), strerror(errno));
+		return 1;
+	}
+
+	PackageTOCCacheReader cache(&errorOutput);
+	status_t error = cache.Init(fd);
+	close(fd);
+	if (error != B_OK) {
+		fprintf(stderr, "Error: Invalid cache \"%s\": %s\n",
+			cachePath.c_str(), strerror(error));
+		return 1;
+	}
+
+	int directoryFD = open_packages_directory(packagesDirectory);
+	int problemCount = 0;
+
+	// Check each cached package: Its content, when replayed from the cache,
+	// must be recorded exactly as when parsed from the package file.
+	for (uint32 i = 0; i < cache.CountPackages(); i++) {
+		const package_toc_cache_package* package = cache.PackageAt(i);
+		const char* fileName = cache.FileName(package);
+
+		struct stat st;
+		if (fstatat(directoryFD, fileName, &st, 0) != 0) {
+			printf("%s: removed\n", fileName);
+			problemCount++;
+			continue;
+		}
+
+		if (!cache.IsUpToDate(package, st)) {
+			printf("%s: changed\n", fileName);
+			problemCount++;
+			continue;
+		}
+
+		PackageTOCCacheWriter cachedWriter(&errorOutput);
+		PackageTOCCacheWriter parsedWriter(&errorOutput);
+		error = cachedWriter.Init(&cache);
+		if (error == B_OK)
+			error = parsedWriter.Init();
+		if (error == B_OK)
+			error = cachedWriter.AddPackage(directoryFD, fileName);
+		if (error == B_OK)
+			error = parsedWriter.AddPackage(directoryFD, fileName);
+
+		std::string cachedData;
+		std::string parsedData;
+		if (error == B_OK)
+			error = finish_to_string(cachedWriter, cachedData);
+		if (error == B_OK)
+			error = finish_to_string(parsedWriter, parsedData);
+
+		if (error != B_OK) {
+			printf("%s: error: %s\n", fileName, strerror(error));
+			problemCount++;
+		} else if (cachedWriter.CountReusedPackages() != 1) {
+			printf("%s: invalid cached content\n", fileName);
+			problemCount++;
+		} else if (cachedData != parsedData) {
+			printf("%s: content mismatch\n", fileName);
+			problemCount++;
+		}
+	}
+
+	close(directoryFD);
+
+	// check for packages missing in the cache
+	StringList fileNames;
+	get_package_file_names(packagesDirectory, fileNames);
+	for (size_t i = 0; i < fileNames.size(); i++) {
+		if (cache.FindPackage(fileNames[i].c_str()) == NULL) {
+			printf("%s: not cached\n", fileNames[i].c_str());
+			problemCount++;
+		}
+	}
+
+	if (problemCount > 0) {
+		printf("%d problem(s) found.\n", problemCount);
+		return 1;
+	}
+
+	printf("The cache for %" B_PRIu32 " packages is up to date.\n",
+		cache.CountPackages());
+	return 0;
+}
+
+
+static int
+command_time(int argc, const char* const* argv)
+{
+	int rounds = 5;
+
+	while (true) {
+		static struct option sLongOptions[] = {
+			{ "help", no_argument, 0, 'h' },
+			{ 0, 0, 0, 0 }
+		};
+
+		opterr = 0; // don't print errors
+		int c = getopt_long(argc, (char**)argv, "+hr:", sLongOptions, NULL);
+		if (c == -1)
+			break;
+
+		switch (c) {
+			case 'h':
+				print_usage_and_exit(false);
+				break;
+
+			case 'r':
+				rounds = atoi(optarg);
+				if (rounds < 1)
+					print_usage_and_exit(true);
+				break;
+
+			default:
+				print_usage_and_exit(true);
+				break;
+		}
+	}
+
+	const char* packagesDirectory;
+	std::string cachePath;
+	parse_common_arguments(argc, argv, packagesDirectory, cachePath);
+
+	BStandardErrorOutput errorOutput;
+	NullContentHandler handler;
+
+	StringList fileNames;
+	get_package_file_names(packagesDirectory, fileNames);
+	int directoryFD = open_packages_directory(packagesDirectory);
+
+	bigtime_t bestParseTime = -1;
+	bigtime_t bestCacheTime = -1;
+	int32 cacheMissCount = 0;
+
+	for (int round = 0; round < rounds; round++) {
+		// parse all package files
+		bigtime_t startTime = current_time();
+		for (size_t i = 0; i < fileNames.size(); i++) {
+			PackageReaderImpl packageReader(&errorOutput);
+			status_t error = packageReader.Init(
+				openat(directoryFD, fileNames[i].c_str(), O_RDONLY), true, 0);
+			if (error == B_OK)
+				error = packageReader.ParseContent(&handler);
+			if (error != B_OK) {
+				fprintf(stderr, "Error: Failed to read package \"%s\": %s\n",
+					fileNames[i].c_str(), strerror(error));
+				return 1;
+			}
+		}
+		bigtime_t parseTime = current_time() - startTime;
+
+		// Read the cache and replay the packages from it. Like packagefs,
+		// read the package file headers nonetheless.
+		startTime = current_time();
+		int fd = open(cachePath.c_str(), O_RDONLY);
+		if (fd < 0) {
+			fprintf(stderr, "Error: Failed to open \"%s\": %s\n",
+				cachePath.c_str(), strerror(errno));
+			return 1;
+		}
+
+		PackageTOCCacheReader cache(&errorOutput);
+		status_t error = cache.Init(fd);
+		close(fd);
+		if (error != B_OK) {
+			fprintf(stderr, "Error: Invalid cache \"%s\": %s\n",
+				cachePath.c_str(), strerror(error));
+			return 1;
+		}
+
+		cacheMissCount = 0;
+		for (size_t i = 0; i < fileNames.size(); i++) {
+			const char* fileName = fileNames[i].c_str();
+			int packageFD = openat(directoryFD, fileName, O_RDONLY);
+			struct stat st;
+			if (packageFD < 0 || fstat(packageFD, &st) != 0) {
+				fprintf(stderr, "Error: Failed to open package \"%s\": %s\n",
+					fileName, strerror(errno));
+				return 1;
+			}
+
+			PackageReaderImpl packageReader(&errorOutput);
+			error = packageReader.Init(packageFD, true, 0);
+			if (error == B_OK) {
+				const package_toc_cache_package* package
+					= cache.FindPackage(fileName);
+				if (package != NULL && cache.IsUpToDate(package, st)) {
+					error = cache.ParseContent(package,
+						packageReader.HeapSize(), &handler);
+				} else {
+					cacheMissCount++;
+					error = packageReader.ParseContent(&handler);
+				}
+			}
+			if (error != B_OK) {
+				fprintf(stderr, "Error: Failed to read package \"%s\": %s\n",
+					fileName, strerror(error));
+				return 1;
+			}
+		}
+		bigtime_t cacheTime = current_time() - startTime;
+
+		if (bestParseTime < 0 || parseTime < bestParseTime)
+			bestParseTime = parseTime;
+		if (bestCacheTime < 0 || cacheTime < bestCacheTime)
+			bestCacheTime = cacheTime;
+	}
+
+	close(directoryFD);
+
+	printf("packages:     %" B_PRIuSIZE " (%" B_PRId32 " not cached)\n",
+		fileNames.size(), cacheMissCount);
+	printf("parsed:       %10" B_PRIdBIGTIME " us\n", bestParseTime);
+	printf("from cache:   %10" B_PRIdBIGTIME " us\n", bestCacheTime);
+	if (bestCacheTime > 0) {
+		printf("speedup:      %10.2f\n",
+			(double)bestParseTime / bestCacheTime);
+	}
+	return 0;
+}
+
+
+int
+main(int argc, const char* const* argv)
+{
+	if (argc < 2)
+		print_usage_and_exit(true);
+
+	const char* command = argv[1];
+	if (strcmp(command, "build") == 0)
+		return command_build(argc - 1, argv + 1);
+
+	if (strcmp(command, "verify") == 0)
+		return command_verify(argc - 1, argv + 1);
+
+	if (strcmp(command, "time") == 0)
+		return command_time(argc - 1, argv + 1);
+
+	if (strcmp(command, "help") == 0 || strcmp(command, "-h") == 0
+		|| strcmp(command, "--help") == 0) {
+		print_usage_and_exit(false);
+	} else
+		print_usage_and_exit(true);
+
+	// never gets here
+	return 0;
+}